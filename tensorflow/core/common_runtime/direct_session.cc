@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <list>
 #include <string>
 #include <vector>
 
@@ -364,6 +365,19 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.message();
   }
+  const Status slots_status = ReadBoolFromEnvVar(
+      "TF_RENDEZVOUS_SLOTS", false, &use_rendezvous_slots_);
+  if (!slots_status.ok()) {
+    LOG(ERROR) << slots_status.message();
+  }
+  // The number of Run() signatures whose executors are cached, the least
+  // recently used ones being evicted beyond it. 0 means unbounded.
+  const Status capacity_status =
+      ReadInt64FromEnvVar("TF_SESSION_EXECUTOR_CACHE_CAPACITY", 1024,
+                          &executor_cache_capacity_);
+  if (!capacity_status.ok()) {
+    LOG(ERROR) << capacity_status.message();
+  }
   session_handle_ =
       strings::StrCat("direct", strings::FpToString(random::New64()));
   if (options.config.log_device_placement()) {
@@ -392,14 +406,18 @@ DirectSession::~DirectSession() {
   for (auto& it : partial_runs_) {
     it.second.reset(nullptr);
   }
-  for (auto& it : executors_) {
-    it.second.reset();
-  }
+  executors_lru_.clear();
+  executors_.clear();
   callables_.clear();
   for (auto d : device_mgr_->ListDevices()) {
     d->op_segment()->RemoveHold(session_handle_);
   }
-  functions_.clear();
+  // The function libraries of the cached executors are released after the
+  // kernels held for the session by the devices, see FunctionInfo.
+  {
+    mutex_lock l(evicted_functions_lock_);
+    evicted_functions_.clear();
+  }
   delete cancellation_manager_;
   for (const auto& p_and_owned : thread_pools_) {
     if (p_and_owned.second) delete p_and_owned.first;
@@ -619,11 +637,18 @@ Status DirectSession::RunInternal(
 
   std::unique_ptr<RunHandler> handler;
   if (ShouldUseRunHandlerPool(run_options) &&
-      run_options.experimental().use_run_handler_pool()) {
+      (run_options.experimental().use_run_handler_pool() ||
+       options_.config.experimental().use_run_handler_pool())) {
     VLOG(1) << "Using RunHandler to scheduler inter-op closures.";
-    handler = GetOrCreateRunHandlerPool(options_)->Get(
-        step_id, call_timeout,
-        run_options.experimental().run_handler_pool_options());
+    RunOptions::Experimental::RunHandlerPoolOptions handler_options =
+        run_options.experimental().run_handler_pool_options();
+    // Without an explicit deadline, the steps with a timeout are scheduled
+    // earliest deadline first among the steps of the same priority.
+    if (handler_options.deadline_micros() == 0 && deadline.has_value()) {
+      handler_options.set_deadline_micros(absl::ToUnixMicros(*deadline));
+    }
+    handler = GetOrCreateRunHandlerPool(options_)->Get(step_id, call_timeout,
+                                                       handler_options);
     if (!handler) {
       return errors::DeadlineExceeded(
           "Could not obtain RunHandler for request after waiting for ",
@@ -872,7 +897,7 @@ Status DirectSession::Run(const RunOptions& run_options,
   metrics::RecordGraphInputTensors(input_size);
 
   // Check if we already have an executor for these arguments.
-  ExecutorsAndKeys* executors_and_keys;
+  std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
   RunStateArgs run_state_args(run_options.debug_options());
   run_state_args.collective_graph_key =
       run_options.experimental().collective_graph_key();
@@ -915,7 +940,7 @@ Status DirectSession::Run(const RunOptions& run_options,
   }
 
   TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, &call_frame,
-                                 executors_and_keys, run_metadata,
+                                 executors_and_keys.get(), run_metadata,
                                  threadpool_options));
 
   // Receive outputs.
@@ -972,7 +997,7 @@ Status DirectSession::PRunSetup(const std::vector<string>& input_names,
   thread::ThreadPool* pool = thread_pools_[0].first;
 
   // Check if we already have an executor for these arguments.
-  ExecutorsAndKeys* executors_and_keys;
+  std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
   // TODO(cais): TFDBG support for partial runs.
   DebugOptions debug_options;
   RunStateArgs run_state_args(debug_options);
@@ -987,6 +1012,7 @@ Status DirectSession::PRunSetup(const std::vector<string>& input_names,
   PartialRunState* run_state =
       new PartialRunState(input_names, output_names, args.step_id, &devices_);
   run_state->rendez.reset(new IntraProcessRendezvous(device_mgr_.get()));
+  run_state->executors_and_keys = executors_and_keys;
   {
     mutex_lock l(executor_lock_);
     if (!partial_runs_
@@ -1045,26 +1071,18 @@ Status DirectSession::PRun(const string& handle, const NamedTensorList& inputs,
                            const std::vector<string>& output_names,
                            std::vector<Tensor>* outputs) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
-  std::vector<string> parts = str_util::Split(handle, ';');
-  const string& key = parts[0];
   // Get the executors for this partial run.
   ExecutorsAndKeys* executors_and_keys;
   PartialRunState* run_state;
   {
     mutex_lock l(executor_lock_);  // could use reader lock
-    auto exc_it = executors_.find(key);
-    if (exc_it == executors_.end()) {
-      return errors::InvalidArgument(
-          "Must run 'setup' before performing partial runs!");
-    }
-    executors_and_keys = exc_it->second.get();
-
     auto prun_it = partial_runs_.find(handle);
     if (prun_it == partial_runs_.end()) {
       return errors::InvalidArgument(
           "Must run 'setup' before performing partial runs!");
     }
     run_state = prun_it->second.get();
+    executors_and_keys = run_state->executors_and_keys.get();
 
     // Make sure that this is a new set of feeds that are still pending.
     for (const auto& input : inputs) {
@@ -1399,9 +1417,11 @@ Status DirectSession::CreateExecutors(
     params.session_metadata = session_metadata;
     params.function_library = lib;
     auto opseg = device->op_segment();
+    FunctionInfo* function_info = func_info.get();
     params.create_kernel =
-        [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
-                           OpKernel** kernel) {
+        [this, lib, opseg, function_info](
+            const std::shared_ptr<const NodeProperties>& props,
+            OpKernel** kernel) {
           // NOTE(mrry): We must not share function kernels (implemented
           // using `CallOp`) between subgraphs, because `CallOp::handle_`
           // is tied to a particular subgraph. Even if the function itself
@@ -1409,7 +1429,8 @@ Status DirectSession::CreateExecutors(
           if (!OpSegment::ShouldOwnKernel(lib, props->node_def.op())) {
             return lib->CreateKernel(props, kernel);
           }
-          auto create_fn = [lib, &props](OpKernel** kernel) {
+          auto create_fn = [lib, function_info, &props](OpKernel** kernel) {
+            function_info->created_session_kernels = true;
             return lib->CreateKernel(props, kernel);
           };
           // Kernels created for subgraph nodes need to be cached.  On
@@ -1490,7 +1511,8 @@ Status DirectSession::CreateExecutors(
 Status DirectSession::GetOrCreateExecutors(
     absl::Span<const string> inputs, absl::Span<const string> outputs,
     absl::Span<const string> target_nodes,
-    ExecutorsAndKeys** executors_and_keys, RunStateArgs* run_state_args) {
+    std::shared_ptr<ExecutorsAndKeys>* executors_and_keys,
+    RunStateArgs* run_state_args) {
   int64_t handle_name_counter_value = -1;
   if (LogMemory::IsEnabled() || run_state_args->is_partial_run) {
     handle_name_counter_value = handle_name_counter_.fetch_add(1);
@@ -1514,91 +1536,146 @@ Status DirectSession::GetOrCreateExecutors(
   }
 
   // See if we already have the executors for this run.
+  std::shared_ptr<ExecutorCacheEntry> entry;
+  std::vector<std::shared_ptr<ExecutorCacheEntry>> evicted;
   {
     mutex_lock l(executor_lock_);  // could use reader lock
     auto it = executors_.find(key);
     if (it != executors_.end()) {
-      *executors_and_keys = it->second.get();
-      return absl::OkStatus();
+      entry = it->second;
+      TouchExecutorCacheEntry(entry.get(), &evicted);
     }
   }
 
-  // Slow lookup path, the unsorted key missed the cache.
-  // Sort the inputs and outputs, and look up with the sorted key in case an
-  // earlier call used a different order of inputs and outputs.
-  //
-  // We could consider some other signature instead of sorting that
-  // preserves the same property to avoid the sort in the future.
-  std::vector<string> inputs_sorted(inputs.begin(), inputs.end());
-  std::sort(inputs_sorted.begin(), inputs_sorted.end());
-  std::vector<string> outputs_sorted(outputs.begin(), outputs.end());
-  std::sort(outputs_sorted.begin(), outputs_sorted.end());
-  std::vector<string> tn_sorted(target_nodes.begin(), target_nodes.end());
-  std::sort(tn_sorted.begin(), tn_sorted.end());
-
-  const string sorted_key = strings::StrCat(
-      absl::StrJoin(inputs_sorted, ","), "->",
-      absl::StrJoin(outputs_sorted, ","), "/", absl::StrJoin(tn_sorted, ","),
-      "/", run_state_args->is_partial_run, "/", debug_tensor_watches_summary);
-  // Set the handle, if its needed to log memory or for partial run.
-  if (handle_name_counter_value >= 0) {
-    run_state_args->handle =
-        strings::StrCat(sorted_key, ";", handle_name_counter_value);
-  }
+  bool create_executors = false;
+  std::vector<string> inputs_sorted;
+  std::vector<string> outputs_sorted;
+  std::vector<string> tn_sorted;
+  if (entry == nullptr) {
+    // Slow lookup path, the unsorted key missed the cache.
+    // Sort the inputs and outputs, and look up with the sorted key in case an
+    // earlier call used a different order of inputs and outputs.
+    //
+    // We could consider some other signature instead of sorting that
+    // preserves the same property to avoid the sort in the future.
+    inputs_sorted.assign(inputs.begin(), inputs.end());
+    std::sort(inputs_sorted.begin(), inputs_sorted.end());
+    outputs_sorted.assign(outputs.begin(), outputs.end());
+    std::sort(outputs_sorted.begin(), outputs_sorted.end());
+    tn_sorted.assign(target_nodes.begin(), target_nodes.end());
+    std::sort(tn_sorted.begin(), tn_sorted.end());
+
+    const string sorted_key = strings::StrCat(
+        absl::StrJoin(inputs_sorted, ","), "->",
+        absl::StrJoin(outputs_sorted, ","), "/", absl::StrJoin(tn_sorted, ","),
+        "/", run_state_args->is_partial_run, "/", debug_tensor_watches_summary);
+    // Set the handle, if its needed to log memory or for partial run.
+    if (handle_name_counter_value >= 0) {
+      run_state_args->handle =
+          strings::StrCat(sorted_key, ";", handle_name_counter_value);
+    }
 
-  // See if we already have the executors for this run.
-  {
     mutex_lock l(executor_lock_);
     auto it = executors_.find(sorted_key);
     if (it != executors_.end()) {
-      *executors_and_keys = it->second.get();
-      return absl::OkStatus();
-    }
-  }
-
-  // Nothing found, so create the executors and store in the cache.
-  // The executor_lock_ is intentionally released while executors are
-  // being created.
-  CallableOptions callable_options;
-  callable_options.mutable_feed()->Reserve(inputs_sorted.size());
-  for (const string& input : inputs_sorted) {
-    callable_options.add_feed(input);
-  }
-  callable_options.mutable_fetch()->Reserve(outputs_sorted.size());
-  for (const string& output : outputs_sorted) {
-    callable_options.add_fetch(output);
-  }
-  callable_options.mutable_target()->Reserve(tn_sorted.size());
-  for (const string& target : tn_sorted) {
-    callable_options.add_target(target);
+      entry = it->second;
+    } else {
+      // Nothing found, so create the executors and store them in the cache.
+      // The executor_lock_ is intentionally released while executors are
+      // being created, and the calls with the same signature in the meantime
+      // wait for them instead of creating them again.
+      entry = std::make_shared<ExecutorCacheEntry>(this);
+      entry->keys.push_back(sorted_key);
+      executors_.emplace(sorted_key, entry);
+      executors_lru_.push_front(entry.get());
+      entry->lru_position = executors_lru_.begin();
+      create_executors = true;
+    }
+    // Insert the entry under the original key, so the fast path lookup will
+    // work if the user uses the same order of inputs, outputs, and targets
+    // again.
+    if (executors_.emplace(key, entry).second) {
+      entry->keys.push_back(key);
+    }
+    TouchExecutorCacheEntry(entry.get(), &evicted);
+  }
+  // Delete the evicted executors that are not in use outside of the lock.
+  evicted.clear();
+  metrics::RecordSessionExecutorCacheQuery(/*cache_hit=*/!create_executors);
+
+  if (create_executors) {
+    const uint64 start_time_usecs = options_.env->NowMicros();
+    CallableOptions callable_options;
+    callable_options.mutable_feed()->Reserve(inputs_sorted.size());
+    for (const string& input : inputs_sorted) {
+      callable_options.add_feed(input);
+    }
+    callable_options.mutable_fetch()->Reserve(outputs_sorted.size());
+    for (const string& output : outputs_sorted) {
+      callable_options.add_fetch(output);
+    }
+    callable_options.mutable_target()->Reserve(tn_sorted.size());
+    for (const string& target : tn_sorted) {
+      callable_options.add_target(target);
+    }
+    *callable_options.mutable_run_options()->mutable_debug_options() =
+        run_state_args->debug_options;
+    callable_options.mutable_run_options()
+        ->mutable_experimental()
+        ->set_collective_graph_key(run_state_args->collective_graph_key);
+    entry->status =
+        CreateExecutors(callable_options, &entry->executors_and_keys,
+                        &entry->function_info, run_state_args);
+    metrics::UpdateSessionExecutorsCreationTime(options_.env->NowMicros() -
+                                                start_time_usecs);
+    if (!entry->status.ok()) {
+      // Remove the entry, so that the next call with this signature retries.
+      mutex_lock l(executor_lock_);
+      EraseExecutorCacheEntry(entry.get(), &evicted);
+    }
+    evicted.clear();
+    entry->created.Notify();
+  } else {
+    entry->created.WaitForNotification();
   }
-  *callable_options.mutable_run_options()->mutable_debug_options() =
-      run_state_args->debug_options;
-  callable_options.mutable_run_options()
-      ->mutable_experimental()
-      ->set_collective_graph_key(run_state_args->collective_graph_key);
-  std::unique_ptr<ExecutorsAndKeys> ek;
-  std::unique_ptr<FunctionInfo> func_info;
-  TF_RETURN_IF_ERROR(
-      CreateExecutors(callable_options, &ek, &func_info, run_state_args));
+  TF_RETURN_IF_ERROR(entry->status);
 
-  // Reacquire the lock, try to insert into the map.
-  mutex_lock l(executor_lock_);
+  // Share the ownership of the entry, which also owns the function library of
+  // the executors.
+  *executors_and_keys = std::shared_ptr<ExecutorsAndKeys>(
+      entry, entry->executors_and_keys.get());
+  return absl::OkStatus();
+}
 
-  // Another thread may have created the entry before us, in which case we will
-  // reuse the already created one.
-  auto insert_result = executors_.emplace(
-      sorted_key, std::shared_ptr<ExecutorsAndKeys>(std::move(ek)));
-  if (insert_result.second) {
-    functions_.push_back(std::move(func_info));
+void DirectSession::TouchExecutorCacheEntry(
+    ExecutorCacheEntry* entry,
+    std::vector<std::shared_ptr<ExecutorCacheEntry>>* evicted) {
+  if (entry->lru_position == executors_lru_.end()) return;
+  executors_lru_.splice(executors_lru_.begin(), executors_lru_,
+                        entry->lru_position);
+  while (executor_cache_capacity_ > 0 &&
+         static_cast<int64_t>(executors_lru_.size()) >
+             executor_cache_capacity_) {
+    EraseExecutorCacheEntry(executors_lru_.back(), evicted);
   }
+}
 
-  // Insert the value under the original key, so the fast path lookup will work
-  // if the user uses the same order of inputs, outputs, and targets again.
-  executors_.emplace(key, insert_result.first->second);
-  *executors_and_keys = insert_result.first->second.get();
-
-  return absl::OkStatus();
+void DirectSession::EraseExecutorCacheEntry(
+    ExecutorCacheEntry* entry,
+    std::vector<std::shared_ptr<ExecutorCacheEntry>>* erased) {
+  for (const string& key : entry->keys) {
+    auto it = executors_.find(key);
+    // The key may have been taken by another entry after an earlier eviction
+    // of this one.
+    if (it != executors_.end() && it->second.get() == entry) {
+      erased->push_back(std::move(it->second));
+      executors_.erase(it);
+    }
+  }
+  if (entry->lru_position != executors_lru_.end()) {
+    executors_lru_.erase(entry->lru_position);
+    entry->lru_position = executors_lru_.end();
+  }
 }
 
 Status DirectSession::CreateGraphs(
@@ -1694,6 +1771,7 @@ Status DirectSession::CreateGraphs(
   };
   popts.flib_def = flib_def->get();
   popts.control_flow_added = false;
+  popts.assign_rendezvous_slots = use_rendezvous_slots_;
 
   std::unordered_map<string, GraphDef> partitions;
   TF_RETURN_IF_ERROR(Partition(popts, &client_graph->graph, &partitions));
@@ -2053,6 +2131,18 @@ Status DirectSession::Finalize() {
   return absl::OkStatus();
 }
 
+DirectSession::ExecutorCacheEntry::~ExecutorCacheEntry() {
+  // As for a Callable, the executors must be deleted before the function
+  // library they call into. The library is kept by the session if the op
+  // segments of the devices hold kernels created with it.
+  executors_and_keys.reset();
+  if (function_info != nullptr && function_info->created_session_kernels) {
+    mutex_lock l(session->evicted_functions_lock_);
+    session->evicted_functions_.push_back(std::move(function_info));
+  }
+  function_info.reset();
+}
+
 DirectSession::Callable::~Callable() {
   // We must delete the fields in this order, because the destructor
   // of `executors_and_keys` will call into an object owned by
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_DIRECT_SESSION_H_
 
 #include <atomic>
+#include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -139,6 +140,8 @@ class DirectSession : public Session {
  private:
   // For access to collective_graph_key_.
   friend class DirectSessionCollectiveTest;
+  // For access to evicted_functions_.
+  friend class DirectSessionExecutorCacheTest;
 
   // We create one executor and its dependent library runtime for
   // every partition.
@@ -188,9 +191,13 @@ class DirectSession : public Session {
   // 'flib_def' is the function library used.
   // 'proc_flr' is the collection of FunctionLibraryRuntime objects, one per
   // device.
+  // 'created_session_kernels' is set when a kernel created with 'proc_flr'
+  // is cached in the op segment of a device, which keeps it until the
+  // session is destroyed.
   struct FunctionInfo {
     std::unique_ptr<FunctionLibraryDefinition> flib_def;
     std::unique_ptr<ProcessFunctionLibraryRuntime> proc_flr;
+    std::atomic<bool> created_session_kernels{false};
   };
 
   // For each live Run() call, the session maintains a RunState.
@@ -212,6 +219,7 @@ class DirectSession : public Session {
   // fetches.
   struct PartialRunState : public RunState {
     Notification executors_done;
+    std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
     std::unordered_map<string, bool> pending_inputs;   // true if fed
     std::unordered_map<string, bool> pending_outputs;  // true if fetched
     core::RefCountPtr<IntraProcessRendezvous> rendez = nullptr;
@@ -238,12 +246,13 @@ class DirectSession : public Session {
   };
 
   // Retrieves an already existing set of executors to run 'inputs' and
-  // 'outputs', or creates and caches them for future use.
-  absl::Status GetOrCreateExecutors(absl::Span<const string> inputs,
-                                    absl::Span<const string> outputs,
-                                    absl::Span<const string> target_nodes,
-                                    ExecutorsAndKeys** executors_and_keys,
-                                    RunStateArgs* run_state_args);
+  // 'outputs', or creates and caches them for future use. The returned
+  // pointer keeps the executors alive if they are evicted from the cache.
+  absl::Status GetOrCreateExecutors(
+      absl::Span<const string> inputs, absl::Span<const string> outputs,
+      absl::Span<const string> target_nodes,
+      std::shared_ptr<ExecutorsAndKeys>* executors_and_keys,
+      RunStateArgs* run_state_args);
 
   // Creates a set of executors to run the subgraph defined by
   // `callable_options`.
@@ -353,17 +362,61 @@ class DirectSession : public Session {
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
 
-  std::vector<std::unique_ptr<FunctionInfo>> functions_
-      TF_GUARDED_BY(executor_lock_);
+  // If true, the Send/Recv pairs of the partitioned graphs are matched through
+  // dense rendezvous slots instead of hashed keys.
+  bool use_rendezvous_slots_ = false;
+
+  // The executors of a Run() signature in the executor cache. The executors
+  // are created by the first Run() of the signature, outside of
+  // `executor_lock_`, and the concurrent Run() calls of the signature wait
+  // for `created` instead of creating them again.
+  struct ExecutorCacheEntry {
+    explicit ExecutorCacheEntry(DirectSession* session) : session(session) {}
+    // The session, which keeps `function_info` when the entry is deleted.
+    DirectSession* const session;
+    Notification created;
+    absl::Status status;
+    std::unique_ptr<ExecutorsAndKeys> executors_and_keys;
+    std::unique_ptr<FunctionInfo> function_info;
+    // The keys of the entry in `executors_`, the first one being the sorted
+    // signature.
+    std::vector<string> keys;
+    // The position of the entry in `executors_lru_`.
+    std::list<ExecutorCacheEntry*>::iterator lru_position;
+    ~ExecutorCacheEntry();
+  };
+
+  // Marks `entry` as the most recently used entry of the executor cache, and
+  // evicts the least recently used entries beyond the capacity of the cache.
+  // The entries removed from `executors_` are moved to `evicted`, so that the
+  // executors are deleted outside of `executor_lock_`.
+  void TouchExecutorCacheEntry(
+      ExecutorCacheEntry* entry,
+      std::vector<std::shared_ptr<ExecutorCacheEntry>>* evicted)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(executor_lock_);
+  void EraseExecutorCacheEntry(
+      ExecutorCacheEntry* entry,
+      std::vector<std::shared_ptr<ExecutorCacheEntry>>* erased)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(executor_lock_);
 
   mutex executor_lock_;  // protects executors_
-  // Holds mappings from signature to the executors that process
-  // it. The reason for a level of indirection around mapped_type is
-  // to guarantee address stability.
-  // The map value is a shared_ptr since multiple map keys can point to the
-  // same ExecutorsAndKey object.
-  std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
+  // Holds mappings from signature to the executors that process it. Both the
+  // signature as given by the caller and the sorted signature map to the
+  // same entry, so that permutations of the feeds, fetches and targets share
+  // the executors.
+  std::unordered_map<string, std::shared_ptr<ExecutorCacheEntry>> executors_
       TF_GUARDED_BY(executor_lock_);
+  // The entries of `executors_`, from the most to the least recently used.
+  std::list<ExecutorCacheEntry*> executors_lru_ TF_GUARDED_BY(executor_lock_);
+  // The maximum number of entries in `executors_lru_`, or 0 if unbounded.
+  int64_t executor_cache_capacity_ = 0;
+  // The function libraries of the deleted executor cache entries that created
+  // stateful kernels, which the devices keep in their op segments, so they
+  // are only released when the session is destroyed. Since each kernel is
+  // created once per session, there are at most as many as stateful nodes.
+  mutex evicted_functions_lock_;
+  std::vector<std::unique_ptr<FunctionInfo>> evicted_functions_
+      TF_GUARDED_BY(evicted_functions_lock_);
 
   class RunCallableCallFrame;
   struct Callable {
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/device_factory.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -581,6 +582,66 @@ TEST_F(DirectSessionMinusAXTest, TestConcurrency) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, ExecutorCacheSharesPermutedSignatures) {
+  Initialize({1, 2, 3, 4});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  const int64_t hits = metrics::GetSessionExecutorCacheQueryCount(true);
+  const int64_t misses = metrics::GetSessionExecutorCacheQueryCount(false);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0", y_neg_ + ":0"}, {}, &outputs));
+  TF_ASSERT_OK(session->Run({}, {y_neg_ + ":0", y_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(2, outputs.size());
+  EXPECT_FLOAT_EQ(-3.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(3.0, outputs[1].matrix<float>()(0, 0));
+  EXPECT_EQ(misses + 1, metrics::GetSessionExecutorCacheQueryCount(false));
+  EXPECT_EQ(hits + 1, metrics::GetSessionExecutorCacheQueryCount(true));
+
+  // The concurrent first calls of a signature create its executors once.
+  const int64_t misses_before_concurrent_runs =
+      metrics::GetSessionExecutorCacheQueryCount(false);
+  {
+    thread::ThreadPool tp(Env::Default(), "test", 4);
+    for (int i = 0; i < 4; ++i) {
+      tp.Schedule([this, &session]() {
+        std::vector<Tensor> outputs;
+        TF_ASSERT_OK(session->Run({}, {z_ + ":0"}, {}, &outputs));
+        ASSERT_EQ(1, outputs.size());
+        EXPECT_FLOAT_EQ(-3.0, outputs[0].matrix<float>()(0, 0));
+      });
+    }
+  }
+  EXPECT_EQ(misses_before_concurrent_runs + 1,
+            metrics::GetSessionExecutorCacheQueryCount(false));
+}
+
+TEST_F(DirectSessionMinusAXTest, ExecutorCacheEvictsLeastRecentlyUsed) {
+  Initialize({1, 2, 3, 4});
+  setenv("TF_SESSION_EXECUTOR_CACHE_CAPACITY", "2", /*overwrite=*/1);
+  auto session = CreateSession();
+  unsetenv("TF_SESSION_EXECUTOR_CACHE_CAPACITY");
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  const int64_t misses = metrics::GetSessionExecutorCacheQueryCount(false);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+  TF_ASSERT_OK(session->Run({}, {y_neg_ + ":0"}, {}, &outputs));
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+  EXPECT_EQ(misses + 2, metrics::GetSessionExecutorCacheQueryCount(false));
+
+  // Evicts the executors of `y_neg_`, the least recently used.
+  TF_ASSERT_OK(session->Run({}, {z_ + ":0"}, {}, &outputs));
+  TF_ASSERT_OK(session->Run({}, {y_ + ":0"}, {}, &outputs));
+  EXPECT_EQ(misses + 3, metrics::GetSessionExecutorCacheQueryCount(false));
+  TF_ASSERT_OK(session->Run({}, {y_neg_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(-3.0, outputs[0].matrix<float>()(0, 0));
+  EXPECT_EQ(misses + 4, metrics::GetSessionExecutorCacheQueryCount(false));
+}
+
 TEST_F(DirectSessionMinusAXTest, TestConcurrency_Callable) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -799,6 +860,27 @@ TEST_F(DirectSessionMinusAXTest, UseRunHandlerPool) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, UseRunHandlerPoolForSession) {
+  Initialize({3, 2, -1, 0});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_use_run_handler_pool(true);
+  auto session = absl::WrapUnique(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // The steps use the run handler pool without asking for it.
+  RunOptions run_options;
+  run_options.set_timeout_in_ms(60000);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run(run_options, {}, {y_ + ":0"}, {y_neg_}, &outputs,
+                            nullptr));
+
+  ASSERT_EQ(1, outputs.size());
+  auto mat = outputs[0].matrix<float>();
+  ASSERT_TRUE(outputs[0].IsInitialized());
+  EXPECT_FLOAT_EQ(5.0, mat(0, 0));
+}
+
 TEST(DirectSessionTest, KeepsStateAcrossRunsOfSession) {
   GraphDef def;
   Graph g(OpRegistry::Global());
@@ -838,6 +920,46 @@ TEST(DirectSessionTest, KeepsStateAcrossRunsOfSession) {
   EXPECT_EQ(20.0, outputs[0].flat<float>()(0));
 }
 
+// The stateful kernels cached by the devices outlive the evicted executors
+// that created them.
+TEST(DirectSessionTest, KeepsStateAcrossExecutorCacheEvictions) {
+  GraphDef def;
+  Graph g(OpRegistry::Global());
+  Node* var = test::graph::Var(&g, DT_FLOAT, TensorShape({10}));
+  var->set_assigned_device_name("/job:localhost/replica:0/task:0/cpu:0");
+
+  Tensor twenty(DT_FLOAT, TensorShape({10}));
+  for (int i = 0; i < 10; ++i) {
+    twenty.flat<float>()(i) = 20.0;
+  }
+
+  Node* twenty_node = test::graph::Constant(&g, twenty);
+  twenty_node->set_assigned_device_name(
+      "/job:localhost/replica:0/task:0/cpu:0");
+
+  Node* init = test::graph::Assign(&g, var, twenty_node);
+  init->set_assigned_device_name("/job:localhost/replica:0/task:0/cpu:0");
+
+  g.ToGraphDef(&def);
+
+  setenv("TF_SESSION_EXECUTOR_CACHE_CAPACITY", "1", /*overwrite=*/1);
+  auto session = CreateSession();
+  unsetenv("TF_SESSION_EXECUTOR_CACHE_CAPACITY");
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {init->name()}, {}, &outputs));
+  // Each run evicts the executors of the previous one.
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(session->Run({}, {var->name() + ":0"}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ(20.0, outputs[0].flat<float>()(0));
+    TF_ASSERT_OK(session->Run({}, {twenty_node->name() + ":0"}, {}, &outputs));
+  }
+  TF_ASSERT_OK(session->Close());
+}
+
 TEST(DirectSessionTest, MultipleFeedTest) {
   GraphDef def;
   Graph g(OpRegistry::Global());
@@ -2981,4 +3103,49 @@ TEST(DirectSessionTest, TestStatefulOutputRequiredOp) {
   TF_ASSERT_OK(session->Close());
 }
 
+class DirectSessionExecutorCacheTest : public ::testing::Test {
+ public:
+  // Returns the number of function libraries of evicted executors that the
+  // session keeps for its stateful kernels.
+  static size_t NumEvictedFunctions(Session* session) {
+    DirectSession* direct_session = static_cast<DirectSession*>(session);
+    mutex_lock l(direct_session->evicted_functions_lock_);
+    return direct_session->evicted_functions_.size();
+  }
+};
+
+// Only the evicted executors that created the stateful kernels of the session
+// keep their function library.
+TEST_F(DirectSessionExecutorCacheTest, BoundsEvictedFunctions) {
+  GraphDef def;
+  Graph g(OpRegistry::Global());
+  Node* var = test::graph::Var(&g, DT_FLOAT, TensorShape({}));
+  Node* twenty_node = test::graph::Constant(&g, test::AsScalar<float>(20.0));
+  Node* init = test::graph::Assign(&g, var, twenty_node);
+  constexpr int kNumSignatures = 8;
+  std::vector<Node*> constants;
+  for (int i = 0; i < kNumSignatures; ++i) {
+    constants.push_back(test::graph::Constant(&g, test::AsScalar<float>(i)));
+  }
+  g.ToGraphDef(&def);
+
+  setenv("TF_SESSION_EXECUTOR_CACHE_CAPACITY", "2", /*overwrite=*/1);
+  auto session = CreateSession();
+  unsetenv("TF_SESSION_EXECUTOR_CACHE_CAPACITY");
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {}, {init->name()}, &outputs));
+  for (Node* constant : constants) {
+    TF_ASSERT_OK(session->Run(
+        {}, {var->name() + ":0", constant->name() + ":0"}, {}, &outputs));
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_EQ(20.0, outputs[0].scalar<float>()());
+  }
+  // The variable kernel was created by the executors of the first run.
+  EXPECT_LE(NumEvictedFunctions(session.get()), 1);
+  TF_ASSERT_OK(session->Close());
+}
+
 }  // namespace tensorflow
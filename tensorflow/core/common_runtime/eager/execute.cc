@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstddef>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <queue>
@@ -32,6 +33,7 @@ limitations under the License.
 // Required for IS_MOBILE_PLATFORM
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_replace.h"
 #include "tensorflow/core/common_runtime/arg_ret_placement.h"
 #include "tensorflow/core/common_runtime/eager/eager_operation.h"
@@ -1689,6 +1691,42 @@ absl::Status AddOrExecuteNode(core::RefCountPtr<KernelAndDevice> kernel,
   }
 }
 
+// Selects the kernel and the device of the local operation `*op` and
+// validates its inputs. The post-placement rewrites may replace `*op` by an
+// operation owned by `out_op`.
+absl::Status GetLocalKernelAndDevice(
+    EagerOperation** op, std::unique_ptr<EagerOperation>* out_op,
+    TensorHandle** retvals, int* num_retvals,
+    core::RefCountPtr<KernelAndDevice>* kernel) {
+  auto status = GetOrCreateKernelAndDevice(*op, retvals, num_retvals, kernel);
+
+#ifdef INTEL_MKL
+  if (IsMKLEnabled() && *kernel != nullptr &&
+      (*op)->Device() == kVariantDeviceNull) {
+    // oneDNN optimization pass relies on the op's assigned device to determine
+    // whether it can be rewritten.
+    (*op)->SetDevice((*kernel)->device());
+  }
+#endif  // INTEL_MKL
+
+  // Run all the registered rewrite pass after the placement, regardless whether
+  // the placement is successful or not. The passes can either create new ops
+  // (without placement) or update some fields of the input op.
+  TF_RETURN_IF_ERROR(EagerOpRewriteRegistry::Global()->RunRewrite(
+      EagerOpRewriteRegistry::POST_PLACEMENT, *op, out_op));
+  if (*out_op) {
+    *op = out_op->get();
+    // If the out op doesn't have device, either because it is a new op or
+    // the op wasn't placed successfully, then we do the placement again.
+    if ((*op)->Device() == kVariantDeviceNull) {
+      status = GetOrCreateKernelAndDevice(*op, retvals, num_retvals, kernel);
+    }
+  }
+  if (!status.ok()) return status;
+
+  return ValidateInputTypeAndPlacement(&(*op)->EagerContext(), *op, *kernel);
+}
+
 // There are a lot of references to devices in this function and around.
 // Here is what they mean:
 //  EagerOperation::Device(): The device on which the user requested the op
@@ -1717,35 +1755,10 @@ absl::Status EagerLocalExecute(EagerOperation* op, TensorHandle** retvals,
   TF_RETURN_IF_ERROR(executor.status());
 
   core::RefCountPtr<KernelAndDevice> kernel;
-  auto status = GetOrCreateKernelAndDevice(op, retvals, num_retvals, &kernel);
-
-#ifdef INTEL_MKL
-  if (IsMKLEnabled() && kernel != nullptr &&
-      op->Device() == kVariantDeviceNull) {
-    // oneDNN optimization pass relies on the op's assigned device to determine
-    // whether it can be rewritten.
-    op->SetDevice(kernel->device());
-  }
-#endif  // INTEL_MKL
-
-  // Run all the registered rewrite pass after the placement, regardless whether
-  // the placement is successful or not. The passes can either create new ops
-  // (without placement) or update some fields of the input op.
   std::unique_ptr<tensorflow::EagerOperation> out_op;
-  TF_RETURN_IF_ERROR(EagerOpRewriteRegistry::Global()->RunRewrite(
-      EagerOpRewriteRegistry::POST_PLACEMENT, op, &out_op));
-  if (out_op) {
-    op = out_op.get();
-    // If the out op doesn't have device, either because it is a new op or
-    // the op wasn't placed successfully, then we do the placement again.
-    if (op->Device() == kVariantDeviceNull) {
-      status = GetOrCreateKernelAndDevice(op, retvals, num_retvals, &kernel);
-    }
-  }
-  if (!status.ok()) return status;
-
+  TF_RETURN_IF_ERROR(
+      GetLocalKernelAndDevice(&op, &out_op, retvals, num_retvals, &kernel));
   int num_outputs = kernel->num_outputs();
-  TF_RETURN_IF_ERROR(ValidateInputTypeAndPlacement(&ctx, op, kernel));
 
   if (ctx.LogDevicePlacement() || VLOG_IS_ON(1)) {
     string msg = strings::StrCat("Executing op ", op->Name(), " in device ",
@@ -2245,6 +2258,115 @@ absl::Status EagerExecute(EagerOperation* op, TensorHandle** retvals,
   return DoEagerExecute(op, retvals, num_retvals);
 }
 
+absl::StatusOr<std::unique_ptr<PreparedEagerOperation>>
+PreparedEagerOperation::Create(EagerOperation* op) {
+  if (!op->IsLocal()) {
+    return errors::Unimplemented("Cannot prepare the remote operation ",
+                                 op->Name());
+  }
+  std::unique_ptr<EagerOperation> pre_execution_op;
+  TF_RETURN_IF_ERROR(EagerOpRewriteRegistry::Global()->RunRewrite(
+      EagerOpRewriteRegistry::PRE_EXECUTION, op, &pre_execution_op));
+  if (pre_execution_op) {
+    op = pre_execution_op.get();
+  }
+  TF_RETURN_IF_ERROR(MaybePackInputTensor(op));
+
+  // No outputs are allocated here, so their number is not bounded.
+  int num_retvals = std::numeric_limits<int>::max();
+  core::RefCountPtr<KernelAndDevice> kernel;
+  std::unique_ptr<EagerOperation> post_placement_op;
+  TF_RETURN_IF_ERROR(GetLocalKernelAndDevice(
+      &op, &post_placement_op, /*retvals=*/nullptr, &num_retvals, &kernel));
+  if (kernel->IsCrossProcess()) {
+    return errors::Unimplemented(
+        "Cannot prepare the multi-process function ", op->Name());
+  }
+  return absl::WrapUnique(new PreparedEagerOperation(
+      &op->EagerContext(), op->Name(), std::move(kernel)));
+}
+
+absl::Status PreparedEagerOperation::Run(
+    absl::Span<TensorHandle* const> inputs, absl::Span<TensorHandle*> retvals,
+    CancellationManager* cancellation_manager) const {
+  tsl::profiler::TraceMe activity(
+      [&] { return absl::StrCat("PreparedEagerOperation::Run: ", name_); },
+      tsl::profiler::TraceMeLevel::kInfo);
+  EagerExecutor& executor = ctx_->Executor();
+  TF_RETURN_IF_ERROR(executor.status());
+
+  if (inputs.size() != static_cast<size_t>(kernel_->num_inputs())) {
+    return errors::InvalidArgument("Operation ", name_, " expects ",
+                                   kernel_->num_inputs(), " inputs but got ",
+                                   inputs.size());
+  }
+  if (retvals.size() != static_cast<size_t>(kernel_->num_outputs())) {
+    return errors::InvalidArgument("Operation ", name_, " has ",
+                                   kernel_->num_outputs(), " outputs but ",
+                                   retvals.size(), " were requested");
+  }
+  // The inputs are only checked against the prepared kernel: unlike
+  // EagerExecute, they are never copied to the device of the kernel.
+  const DataTypeVector& input_dtypes = kernel_->input_dtypes();
+  for (int i = 0, end = inputs.size(); i < end; ++i) {
+    TensorHandle* handle = inputs[i];
+    if (handle->dtype != input_dtypes[i]) {
+      return errors::InvalidArgument(
+          "cannot compute ", name_, " as input #", i,
+          "(zero-based) was expected to be a ",
+          DataTypeString(input_dtypes[i]), " tensor but is a ",
+          DataTypeString(handle->dtype), " tensor");
+    }
+    Device* expected_device = kernel_->InputDevice(i);
+    Device* handle_device = handle->DeviceOrHostCPU(*ctx_);
+    if (expected_device != nullptr && expected_device != handle_device) {
+      return errors::InvalidArgument(
+          "cannot compute ", name_, " as input #", i,
+          "(zero-based) was expected to be on ", expected_device->name(),
+          " but is actually on ", handle_device->name(),
+          ". Copy the input or prepare the operation again.");
+    }
+  }
+
+  GraphCollector* graph_collector = nullptr;
+  if (ctx_->ShouldStoreGraphs()) {
+    graph_collector = ctx_->GetGraphCollector();
+  }
+  const absl::InlinedVector<TensorHandle*, 4> op_inputs(inputs.begin(),
+                                                        inputs.end());
+  absl::Status s;
+  if (executor.Async()) {
+    const DataTypeVector& output_dtypes = kernel_->output_dtypes();
+    for (int i = 0, end = retvals.size(); i < end; ++i) {
+      retvals[i] = TensorHandle::CreateEmptyLocalHandle(
+          /* d= */ ctx_->CanonicalDevice(kernel_->OutputDevice(i)),
+          /* op_device= */ kernel_->device(),
+          /* resource_device= */ kernel_->OutputResourceDevice(i),
+          output_dtypes[i], ctx_);
+    }
+    auto node = std::make_unique<AsyncExecuteNode>(
+        ctx_, op_inputs, /*eager_func_params=*/std::nullopt,
+        tsl::core::GetNewRef(kernel_.get()), graph_collector,
+        cancellation_manager, retvals, /*stack_trace=*/std::nullopt);
+    s = executor.AddOrExecute(std::move(node));
+  } else {
+    std::fill(retvals.begin(), retvals.end(), nullptr);
+    ExecuteNode node(ctx_, op_inputs, /*eager_func_params=*/std::nullopt,
+                     kernel_, graph_collector, cancellation_manager, retvals,
+                     /*stack_trace=*/std::nullopt);
+    s = executor.SyncExecute(&node);
+  }
+  if (!s.ok()) {
+    for (TensorHandle*& retval : retvals) {
+      if (retval != nullptr) {
+        retval->Unref();
+        retval = nullptr;
+      }
+    }
+  }
+  return s;
+}
+
 namespace {
 
 absl::Status LocalEagerCopyToDevice(TensorHandle* h, EagerContext* ctx,
@@ -15,7 +15,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EXECUTE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EXECUTE_H_
 
+#include <memory>
+#include <string>
+#include <utility>
+
 #include "absl/container/inlined_vector.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/eager/context.h"
@@ -85,6 +91,41 @@ absl::Status EagerCopyToDevice(TensorHandle* h, EagerContext* ctx,
 void EagerLocalExecuteAsync(EagerOperation* op, TensorHandle** retvals,
                             int* num_retvals, StatusCallback done);
 
+// An operation whose kernel and device have been selected once, to be run
+// repeatedly with new inputs. Running it skips the canonicalization and the
+// fingerprinting of the attributes, the kernel cache lookup and the placement
+// done by each EagerExecute, which dominate the dispatch of small ops.
+//
+// The inputs of each run must have the dtypes of the inputs the operation was
+// prepared with, and be on the same devices: unlike EagerExecute, a prepared
+// operation never copies its inputs. It only supports local execution.
+class PreparedEagerOperation {
+ public:
+  // Selects the kernel and device of the fully constructed local operation
+  // `op`, including its inputs, without executing it.
+  static absl::StatusOr<std::unique_ptr<PreparedEagerOperation>> Create(
+      EagerOperation* op);
+
+  // Runs the prepared kernel on `inputs`, on the executor of the calling
+  // thread. `retvals` must have num_outputs() elements, and is set to new
+  // handles owned by the caller on success.
+  absl::Status Run(absl::Span<TensorHandle* const> inputs,
+                   absl::Span<TensorHandle*> retvals,
+                   CancellationManager* cancellation_manager = nullptr) const;
+
+  int num_outputs() const { return kernel_->num_outputs(); }
+  const KernelAndDevice& kernel() const { return *kernel_; }
+
+ private:
+  PreparedEagerOperation(EagerContext* ctx, std::string name,
+                         core::RefCountPtr<KernelAndDevice> kernel)
+      : ctx_(ctx), name_(std::move(name)), kernel_(std::move(kernel)) {}
+
+  EagerContext* const ctx_;
+  const std::string name_;
+  const core::RefCountPtr<KernelAndDevice> kernel_;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_EXECUTE_H_
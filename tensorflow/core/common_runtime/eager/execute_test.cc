@@ -22,7 +22,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -428,5 +430,110 @@ TEST(ExecuteTest, MultipleNestedCompiledFunction) {
   ctx->Unref();
 }
 
+EagerContext* CreateCpuContext(StaticDeviceMgr* device_mgr) {
+  return new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      false, device_mgr, false, nullptr, nullptr);
+}
+
+// Returns the Mul of `x` and `y` on the CPU.
+std::unique_ptr<EagerOperation> CreateMul(EagerContext* ctx, TensorHandle* x,
+                                          TensorHandle* y) {
+  auto op = std::make_unique<EagerOperation>(ctx);
+  TF_CHECK_OK(op->Reset(
+      /*op=*/"Mul",
+      /*raw_device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0"));
+  TF_CHECK_OK(op->AddInput(x));
+  TF_CHECK_OK(op->AddInput(y));
+  return op;
+}
+
+TEST(ExecuteTest, PreparedOperationRunsWithNewInputs) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  EagerContext* ctx = CreateCpuContext(&device_mgr);
+
+  core::RefCountPtr<TensorHandle> x(
+      TensorHandle::CreateLocalHandle(test::AsScalar<int64_t>(3)));
+  core::RefCountPtr<TensorHandle> y(
+      TensorHandle::CreateLocalHandle(test::AsScalar<int64_t>(2)));
+  std::unique_ptr<EagerOperation> op = CreateMul(ctx, x.get(), y.get());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PreparedEagerOperation> prepared,
+                          PreparedEagerOperation::Create(op.get()));
+  ASSERT_EQ(prepared->num_outputs(), 1);
+
+  for (int64_t value : {5, 7}) {
+    core::RefCountPtr<TensorHandle> z(
+        TensorHandle::CreateLocalHandle(test::AsScalar<int64_t>(value)));
+    TensorHandle* retval = nullptr;
+    TF_ASSERT_OK(prepared->Run({x.get(), z.get()}, {&retval, 1}));
+    const Tensor* result;
+    TF_ASSERT_OK(retval->Tensor(&result));
+    test::ExpectTensorEqual<int64_t>(*result,
+                                     test::AsScalar<int64_t>(3 * value));
+    retval->Unref();
+  }
+  ctx->Unref();
+}
+
+TEST(ExecuteTest, PreparedOperationRejectsMismatchedInputs) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  EagerContext* ctx = CreateCpuContext(&device_mgr);
+
+  core::RefCountPtr<TensorHandle> x(
+      TensorHandle::CreateLocalHandle(test::AsScalar<int64_t>(3)));
+  core::RefCountPtr<TensorHandle> f(
+      TensorHandle::CreateLocalHandle(test::AsScalar<float>(3.0f)));
+  std::unique_ptr<EagerOperation> op = CreateMul(ctx, x.get(), x.get());
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<PreparedEagerOperation> prepared,
+                          PreparedEagerOperation::Create(op.get()));
+
+  TensorHandle* retval = nullptr;
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      prepared->Run({x.get(), f.get()}, {&retval, 1})));
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(prepared->Run({x.get()}, {&retval, 1})));
+  EXPECT_TRUE(absl::IsInvalidArgument(prepared->Run({x.get(), x.get()}, {})));
+  EXPECT_EQ(retval, nullptr);
+  ctx->Unref();
+}
+
+void BM_EagerExecuteMul(::testing::benchmark::State& state) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  EagerContext* ctx = CreateCpuContext(&device_mgr);
+  core::RefCountPtr<TensorHandle> x(
+      TensorHandle::CreateLocalHandle(test::AsScalar<float>(3.0f)));
+  for (auto s : state) {
+    std::unique_ptr<EagerOperation> op = CreateMul(ctx, x.get(), x.get());
+    TensorHandle* retval = nullptr;
+    int num_retvals = 1;
+    TF_CHECK_OK(EagerExecute(op.get(), &retval, &num_retvals));
+    retval->Unref();
+  }
+  ctx->Unref();
+}
+BENCHMARK(BM_EagerExecuteMul);
+
+void BM_PreparedEagerOperationMul(::testing::benchmark::State& state) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  EagerContext* ctx = CreateCpuContext(&device_mgr);
+  core::RefCountPtr<TensorHandle> x(
+      TensorHandle::CreateLocalHandle(test::AsScalar<float>(3.0f)));
+  std::unique_ptr<EagerOperation> op = CreateMul(ctx, x.get(), x.get());
+  std::unique_ptr<PreparedEagerOperation> prepared =
+      PreparedEagerOperation::Create(op.get()).value();
+  for (auto s : state) {
+    TensorHandle* retval = nullptr;
+    TF_CHECK_OK(prepared->Run({x.get(), x.get()}, {&retval, 1}));
+    retval->Unref();
+  }
+  ctx->Unref();
+}
+BENCHMARK(BM_PreparedEagerOperationMul);
+
 }  // namespace
 }  // namespace tensorflow
@@ -14,9 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/rendezvous_util.h"
 
+#include <vector>
+
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -121,5 +127,144 @@ TEST(RendezvousUtilCallerThreadTest, RecvBeforeSend) {
   EXPECT_EQ("hello2", V(received_keys[1]));
 }
 
+std::vector<Rendezvous::ParsedKey> MakeStepKeys(int num_edges,
+                                                bool use_slots) {
+  std::vector<Rendezvous::ParsedKey> keys(num_edges);
+  for (int i = 0; i < num_edges; ++i) {
+    TF_CHECK_OK(Rendezvous::ParseKey(
+        MakeStringKey(strings::StrCat("edge_", i)), &keys[i]));
+    if (use_slots) keys[i].slot = i;
+  }
+  return keys;
+}
+
+TEST(RendezvousUtilSlotTest, SendRecvThroughSlots) {
+  const std::vector<Rendezvous::ParsedKey> keys = MakeStepKeys(3, true);
+  Rendezvous* rendez = NewLocalRendezvous();
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez->Send(keys[0], args, V("edge_0"), false));
+
+  // The recv of `keys[1]` waits for its send.
+  Notification n;
+  Tensor val;
+  rendez->RecvAsync(keys[1], args,
+                    [&n, &val](const absl::Status& s,
+                               const Rendezvous::Args& send_args,
+                               const Rendezvous::Args& recv_args,
+                               const Tensor& v, bool is_dead) {
+                      TF_EXPECT_OK(s);
+                      val = v;
+                      n.Notify();
+                    });
+  TF_ASSERT_OK(rendez->Send(keys[1], args, V("edge_1"), false));
+  n.WaitForNotification();
+  EXPECT_EQ("edge_1", V(val));
+
+  bool is_dead = true;
+  TF_ASSERT_OK(rendez->Recv(keys[0], args, &val, &is_dead));
+  EXPECT_EQ("edge_0", V(val));
+  EXPECT_FALSE(is_dead);
+
+  // The keys with a slot are matched by slot, not by key string.
+  Rendezvous::ParsedKey renamed = keys[0];
+  renamed.slot = 2;
+  TF_ASSERT_OK(rendez->Send(renamed, args, V("edge_2"), false));
+  TF_ASSERT_OK(rendez->Recv(keys[2], args, &val, &is_dead));
+  EXPECT_EQ("edge_2", V(val));
+
+  // Each slot is used by a single Send and a single Recv per step.
+  EXPECT_FALSE(rendez->Recv(keys[2], args, &val, &is_dead).ok());
+  rendez->Unref();
+}
+
+TEST(RendezvousUtilSlotTest, AbortPendingSlots) {
+  const std::vector<Rendezvous::ParsedKey> keys = MakeStepKeys(2, true);
+  Rendezvous* rendez = NewLocalRendezvous();
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez->Send(keys[0], args, V("edge_0"), false));
+  Notification n;
+  rendez->RecvAsync(keys[1], args,
+                    [&n](const absl::Status& s,
+                         const Rendezvous::Args& send_args,
+                         const Rendezvous::Args& recv_args, const Tensor& v,
+                         bool is_dead) {
+                      EXPECT_TRUE(absl::IsAborted(s));
+                      n.Notify();
+                    });
+  rendez->StartAbort(errors::Aborted(""));
+  n.WaitForNotification();
+
+  Tensor val;
+  bool is_dead = false;
+  EXPECT_TRUE(absl::IsAborted(rendez->Recv(keys[0], args, &val, &is_dead)));
+  EXPECT_TRUE(absl::IsAborted(rendez->Send(keys[1], args, val, false)));
+  rendez->Unref();
+}
+
+TEST(RendezvousUtilSlotTest, CancelPendingSlot) {
+  const std::vector<Rendezvous::ParsedKey> keys = MakeStepKeys(1, true);
+  Rendezvous* rendez = NewLocalRendezvous();
+  CancellationManager cm;
+  Rendezvous::Args args;
+  args.cancellation_manager = &cm;
+  Notification n;
+  rendez->RecvAsync(keys[0], args,
+                    [&n](const absl::Status& s,
+                         const Rendezvous::Args& send_args,
+                         const Rendezvous::Args& recv_args, const Tensor& v,
+                         bool is_dead) {
+                      EXPECT_TRUE(absl::IsCancelled(s));
+                      n.Notify();
+                    });
+  cm.StartCancel();
+  n.WaitForNotification();
+  TF_EXPECT_OK(rendez->Send(keys[0], Rendezvous::Args(), V("edge_0"), false));
+  rendez->Unref();
+}
+
+// Measures the rendezvous overhead of a step that passes a tensor over each of
+// `state.range(0)` edges, with hashed keys if `state.range(1)` is 0 and with
+// slots otherwise.
+void BM_StepRendezvous(::testing::benchmark::State& state) {
+  const int num_edges = state.range(0);
+  const std::vector<Rendezvous::ParsedKey> keys =
+      MakeStepKeys(num_edges, state.range(1) != 0);
+  const Tensor val = V("val");
+  Rendezvous::Args args;
+  int num_received = 0;
+  auto done = [&num_received](const absl::Status& s,
+                              const Rendezvous::Args& send_args,
+                              const Rendezvous::Args& recv_args,
+                              const Tensor& v, bool is_dead) {
+    TF_CHECK_OK(s);
+    ++num_received;
+  };
+
+  for (auto s : state) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    // Half of the edges are received before they are sent, as the consumers
+    // of a step may be scheduled before their producers.
+    for (int i = 0; i < num_edges; i += 2) {
+      rendez->RecvAsync(keys[i], args, done);
+    }
+    for (int i = 0; i < num_edges; ++i) {
+      TF_CHECK_OK(rendez->Send(keys[i], args, val, false));
+    }
+    for (int i = 1; i < num_edges; i += 2) {
+      rendez->RecvAsync(keys[i], args, done);
+    }
+    rendez->Unref();
+  }
+  CHECK_EQ(num_received, num_edges * state.iterations());
+  state.SetItemsProcessed(num_edges * state.iterations());
+}
+BENCHMARK(BM_StepRendezvous)
+    ->ArgPair(8, 0)
+    ->ArgPair(8, 1)
+    ->ArgPair(64, 0)
+    ->ArgPair(64, 1)
+    ->ArgPair(512, 0)
+    ->ArgPair(512, 1);
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,117 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/autotune_simulator.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/model.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using model::AutotuneAlgorithm;
+using model::Model;
+using model::ModelProto;
+using model::Node;
+
+absl::StatusOr<AutotuneSimulationResult> SimulateAlgorithm(
+    const ModelProto& model_proto, AutotuneAlgorithm algorithm) {
+  std::unique_ptr<Model> model;
+  TF_RETURN_IF_ERROR(Model::FromProto(model_proto, &model));
+  if (model->output() == nullptr) {
+    return errors::InvalidArgument("The recorded model has no output node.");
+  }
+  const Model::OptimizationParams& params = model_proto.optimization_params();
+  const int64_t cpu_budget = params.cpu_budget();
+  CancellationManager cancellation_manager;
+  model::RamBudgetManager ram_budget_manager(params.ram_budget());
+
+  AutotuneSimulationResult result;
+  result.algorithm = algorithm;
+  const absl::Time start = absl::Now();
+  model->Optimize(algorithm, [cpu_budget]() { return cpu_budget; },
+                  /*ram_budget_share=*/1.0,
+                  /*fixed_ram_budget=*/params.ram_budget(),
+                  params.model_input_time(), ram_budget_manager,
+                  &cancellation_manager);
+  result.optimization_time = absl::Now() - start;
+  result.processing_time_nsec = model->ComputeSnapshotProcessingTimeNsec();
+
+  // The optimization updates the state values of the parameters. Copy them to
+  // the parameter values of the model so that the buffered bytes reflect the
+  // tuned pipeline.
+  Node::NodeVector nodes = model->output()->CollectNodes(
+      model::TraversalOrder::BFS,
+      [](const std::shared_ptr<Node>) { return true; });
+  nodes.push_back(model->output());
+  for (const auto& node : nodes) {
+    node->SyncStateValuesToParameterValues(model::kParallelism);
+    node->SyncStateValuesToParameterValues(model::kBufferSize);
+    absl::StatusOr<double> parallelism =
+        node->ParameterValue(model::kParallelism);
+    if (parallelism.ok()) {
+      result.total_parallelism += *parallelism;
+    }
+  }
+  result.maximum_buffered_bytes = model->output()->TotalMaximumBufferedBytes();
+  return result;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<AutotuneSimulationResult>> SimulateAutotune(
+    const ModelProto& model_proto,
+    absl::Span<const AutotuneAlgorithm> algorithms) {
+  std::vector<AutotuneSimulationResult> results;
+  results.reserve(algorithms.size());
+  for (AutotuneAlgorithm algorithm : algorithms) {
+    TF_ASSIGN_OR_RETURN(AutotuneSimulationResult result,
+                        SimulateAlgorithm(model_proto, algorithm));
+    results.push_back(result);
+  }
+  return results;
+}
+
+absl::StatusOr<std::vector<std::vector<AutotuneSimulationResult>>>
+ReplayAutotuneSnapshots(const std::vector<std::string>& filenames,
+                        absl::Span<const AutotuneAlgorithm> algorithms) {
+  std::vector<std::vector<AutotuneSimulationResult>> results;
+  results.reserve(filenames.size());
+  for (const std::string& filename : filenames) {
+    ModelProto model_proto;
+    TF_RETURN_IF_ERROR(
+        ReadTextOrBinaryProto(Env::Default(), filename, &model_proto));
+    TF_ASSIGN_OR_RETURN(std::vector<AutotuneSimulationResult> file_results,
+                        SimulateAutotune(model_proto, algorithms));
+    results.push_back(std::move(file_results));
+  }
+  return results;
+}
+
+}  // namespace data
+}  // namespace tensorflow
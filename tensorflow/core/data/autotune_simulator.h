@@ -0,0 +1,61 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_AUTOTUNE_SIMULATOR_H_
+#define TENSORFLOW_CORE_DATA_AUTOTUNE_SIMULATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/model.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+// Outcome of replaying a recorded model with one autotuning algorithm.
+struct AutotuneSimulationResult {
+  model::AutotuneAlgorithm algorithm = model::AutotuneAlgorithm::DEFAULT;
+  // Time in nanoseconds it takes the tuned pipeline to produce an element, as
+  // estimated by `ModelTiming`.
+  double processing_time_nsec = 0.0;
+  // Number of bytes the tuned pipeline buffers when all buffers are full.
+  double maximum_buffered_bytes = 0.0;
+  // Sum of the tuned `parallelism` parameters.
+  double total_parallelism = 0.0;
+  // Time spent running the optimization.
+  absl::Duration optimization_time;
+};
+
+// Replays the recorded model in `model_proto` once per algorithm in
+// `algorithms` and returns the results in the same order. Each algorithm starts
+// from a fresh copy of the model and uses the CPU and RAM budgets stored in the
+// `optimization_params` of `model_proto`. This allows comparing the autotuning
+// algorithms offline on snapshots collected from production pipelines.
+absl::StatusOr<std::vector<AutotuneSimulationResult>> SimulateAutotune(
+    const model::ModelProto& model_proto,
+    absl::Span<const model::AutotuneAlgorithm> algorithms);
+
+// Loads the model snapshots saved by `Model::Save` from `filenames` and replays
+// each of them with `algorithms`. The outer vector is indexed by file.
+absl::StatusOr<std::vector<std::vector<AutotuneSimulationResult>>>
+ReplayAutotuneSnapshots(const std::vector<std::string>& filenames,
+                        absl::Span<const model::AutotuneAlgorithm> algorithms);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_AUTOTUNE_SIMULATOR_H_
@@ -0,0 +1,144 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/autotune_simulator.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/model.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tsl/platform/protobuf.h"
+#include "tsl/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using model::AutotuneAlgorithm;
+using model::ModelProto;
+using ::tsl::testing::StatusIs;
+
+constexpr char kTwoStagesModel[] = R"pb(
+  nodes: {
+    key: 1
+    value: {
+      id: 1
+      name: "ParallelMapV2"
+      autotune: true
+      num_elements: 100
+      processing_time: 25000
+      bytes_produced: 10000
+      node_class: ASYNC_KNOWN_RATIO
+      ratio: 1
+      inputs: 2
+      parameters: { name: "parallelism" value: 1 min: 1 max: 16 tunable: true }
+    }
+  }
+  nodes: {
+    key: 2
+    value: {
+      id: 2
+      name: "ParallelMapV2"
+      autotune: true
+      num_elements: 100
+      processing_time: 20000
+      bytes_produced: 10000
+      node_class: ASYNC_KNOWN_RATIO
+      ratio: 1
+      inputs: 3
+      parameters: { name: "parallelism" value: 1 min: 1 max: 16 tunable: true }
+    }
+  }
+  nodes: {
+    key: 3
+    value: {
+      id: 3
+      name: "SSTable"
+      autotune: true
+      num_elements: 100
+      processing_time: 1000
+      node_class: KNOWN_RATIO
+      ratio: 2
+    }
+  }
+  output: 1
+  optimization_params: {
+    cpu_budget: 6
+    ram_budget: 1000
+    model_input_time: 50
+  }
+)pb";
+
+ModelProto TwoStagesModel() {
+  ModelProto model_proto;
+  CHECK(tsl::protobuf::TextFormat::ParseFromString(kTwoStagesModel,
+                                                   &model_proto));
+  return model_proto;
+}
+
+TEST(AutotuneSimulatorTest, SimulateAlgorithms) {
+  std::vector<AutotuneAlgorithm> algorithms = {
+      AutotuneAlgorithm::STAGE_BASED, AutotuneAlgorithm::LEARNED_COST};
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<AutotuneSimulationResult> results,
+                          SimulateAutotune(TwoStagesModel(), algorithms));
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].algorithm, AutotuneAlgorithm::STAGE_BASED);
+  EXPECT_EQ(results[1].algorithm, AutotuneAlgorithm::LEARNED_COST);
+  for (const AutotuneSimulationResult& result : results) {
+    EXPECT_GT(result.processing_time_nsec, 0);
+    EXPECT_GE(result.total_parallelism, 2);
+    EXPECT_LE(result.maximum_buffered_bytes, 1000);
+  }
+  // The learned cost optimization respects the CPU budget.
+  EXPECT_LE(results[1].total_parallelism, 6);
+}
+
+TEST(AutotuneSimulatorTest, AlgorithmsStartFromTheSameModel) {
+  std::vector<AutotuneAlgorithm> algorithms = {
+      AutotuneAlgorithm::STAGE_BASED, AutotuneAlgorithm::STAGE_BASED};
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<AutotuneSimulationResult> results,
+                          SimulateAutotune(TwoStagesModel(), algorithms));
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].processing_time_nsec, results[1].processing_time_nsec);
+  EXPECT_EQ(results[0].total_parallelism, results[1].total_parallelism);
+}
+
+TEST(AutotuneSimulatorTest, ReplaySnapshots) {
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "autotune_simulator_test_model");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), filename, TwoStagesModel()));
+  std::vector<AutotuneAlgorithm> algorithms = {AutotuneAlgorithm::HILL_CLIMB,
+                                               AutotuneAlgorithm::LEARNED_COST};
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto results, ReplayAutotuneSnapshots({filename, filename}, algorithms));
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].size(), 2);
+  EXPECT_EQ(results[1].size(), 2);
+}
+
+TEST(AutotuneSimulatorTest, ReplayMissingSnapshot) {
+  std::vector<AutotuneAlgorithm> algorithms = {AutotuneAlgorithm::STAGE_BASED};
+  EXPECT_THAT(
+      ReplayAutotuneSnapshots(
+          {io::JoinPath(testing::TmpDir(), "does_not_exist")}, algorithms),
+      StatusIs(error::NOT_FOUND));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
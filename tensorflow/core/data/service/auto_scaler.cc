@@ -27,6 +27,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -205,8 +206,9 @@ absl::Status MultipleIterationsAutoScaler::UnregisterIteration(
   return absl::OkStatus();
 }
 
-absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
-    int64_t current_number_of_workers) TF_LOCKS_EXCLUDED(mu_) {
+absl::StatusOr<int64_t>
+MultipleIterationsAutoScaler::GetBoundOptimalNumberOfWorkers(
+    int64_t current_number_of_workers) const TF_LOCKS_EXCLUDED(mu_) {
   if (current_number_of_workers <= 0)
     return absl::InvalidArgumentError(
         "The current number of workers must be positive");
@@ -215,8 +217,8 @@ absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
       GetOptimalNumberOfWorkers();
   if (!optimal_number_of_workers)
     return absl::UnavailableError(
-        "Cannot update the optimal number of workers metric because there are "
-        "no reported processing and target processing times for at least one "
+        "Cannot estimate the optimal number of workers because there are no "
+        "reported processing and target processing times for at least one "
         "iteration");
 
   VLOG(3) << "Estimated optimal number of workers: "
@@ -236,13 +238,38 @@ absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
       std::min(bound_optimal_number_of_workers, int64_t{100000});
   VLOG(3) << "Bound optimal number of workers: "
           << bound_optimal_number_of_workers;
+  return bound_optimal_number_of_workers;
+}
 
+absl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
+    int64_t current_number_of_workers) TF_LOCKS_EXCLUDED(mu_) {
+  absl::StatusOr<int64_t> bound_optimal_number_of_workers =
+      GetBoundOptimalNumberOfWorkers(current_number_of_workers);
+  if (!bound_optimal_number_of_workers.ok()) {
+    return bound_optimal_number_of_workers.status();
+  }
   metrics::RecordTFDataServiceOptimalNumberOfWorkers(
-      bound_optimal_number_of_workers);
-
+      *bound_optimal_number_of_workers);
   return absl::OkStatus();
 }
 
+absl::StatusOr<int64_t>
+MultipleIterationsAutoScaler::GetRecommendedNumberOfWorkers(
+    int64_t current_number_of_workers) const TF_LOCKS_EXCLUDED(mu_) {
+  absl::StatusOr<int64_t> bound_optimal_number_of_workers =
+      GetBoundOptimalNumberOfWorkers(current_number_of_workers);
+  if (!bound_optimal_number_of_workers.ok()) {
+    return bound_optimal_number_of_workers.status();
+  }
+  const double difference = std::abs(static_cast<double>(
+      *bound_optimal_number_of_workers - current_number_of_workers));
+  if (difference <=
+      kScalingTolerance * static_cast<double>(current_number_of_workers)) {
+    return current_number_of_workers;
+  }
+  return *bound_optimal_number_of_workers;
+}
+
 std::optional<int64_t> MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers()
     const TF_LOCKS_EXCLUDED(mu_) {
   int64_t optimal_number_of_workers = 0;
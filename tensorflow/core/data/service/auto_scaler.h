@@ -23,6 +23,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
@@ -132,6 +133,16 @@ class MultipleIterationsAutoScaler {
   // target processing times for at least one iteration, returns nullopt.
   std::optional<int64_t> GetOptimalNumberOfWorkers() const
       TF_LOCKS_EXCLUDED(mu_);
+  // Returns the number of workers the cluster should be scaled to. The estimate
+  // is bounded the same way as in `UpdateOptimalNumberOfWorkersMetric`. If it
+  // differs from `current_number_of_workers` by no more than
+  // `kScalingTolerance`, returns `current_number_of_workers` so that the
+  // cluster is not resized in response to noise in the reported times. Returns
+  // an error if there are no previously reported processing and target
+  // processing times for at least one iteration, or `current_number_of_workers`
+  // is not positive.
+  absl::StatusOr<int64_t> GetRecommendedNumberOfWorkers(
+      int64_t current_number_of_workers) const TF_LOCKS_EXCLUDED(mu_);
   // Reports the latest observed processing time from the worker with
   // `worker_address` for iteration with `iteration_id`. Returns an error if
   // `processing_time` is ZeroDuration or negative.
@@ -163,6 +174,15 @@ class MultipleIterationsAutoScaler {
       TF_LOCKS_EXCLUDED(mu_);
 
  private:
+  // Fraction of the current number of workers within which the recommended
+  // number of workers is not changed.
+  static constexpr double kScalingTolerance = 0.1;
+
+  // Returns the bounded estimate of the optimal number of workers. Returns an
+  // error if there is no estimate or `current_number_of_workers` is not
+  // positive.
+  absl::StatusOr<int64_t> GetBoundOptimalNumberOfWorkers(
+      int64_t current_number_of_workers) const TF_LOCKS_EXCLUDED(mu_);
   // Registers iteration with `iteration_id` if it does not exist already,
   // allowing its future reported times to be considered for the current
   // workload estimation.
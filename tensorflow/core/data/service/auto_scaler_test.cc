@@ -30,6 +30,7 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+using ::tsl::testing::IsOkAndHolds;
 using ::tsl::testing::StatusIs;
 
 TEST(AutoScalerTest, GetOptimalNumberOfWorkersInitialState) {
@@ -537,6 +538,62 @@ TEST(MultipleIterationsAutoScalerTest,
   EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 20);
 }
 
+TEST(MultipleIterationsAutoScalerTest,
+     GetRecommendedNumberOfWorkersInvalidCurrentWorkers) {
+  MultipleIterationsAutoScaler auto_scaler;
+  EXPECT_THAT(auto_scaler.GetRecommendedNumberOfWorkers(0),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(MultipleIterationsAutoScalerTest,
+     GetRecommendedNumberOfWorkersNoReportedTimes) {
+  MultipleIterationsAutoScaler auto_scaler;
+  EXPECT_THAT(auto_scaler.GetRecommendedNumberOfWorkers(1),
+              StatusIs(absl::StatusCode::kUnavailable));
+}
+
+TEST(MultipleIterationsAutoScalerTest, GetRecommendedNumberOfWorkersScaleUp) {
+  MultipleIterationsAutoScaler auto_scaler;
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Microseconds(10)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(500)));
+  // Estimated workers = 50. Current workers = 15.
+  EXPECT_THAT(auto_scaler.GetRecommendedNumberOfWorkers(15),
+              IsOkAndHolds(50));
+  // The estimate is limited to 4x the current number of workers.
+  EXPECT_THAT(auto_scaler.GetRecommendedNumberOfWorkers(5), IsOkAndHolds(20));
+}
+
+TEST(MultipleIterationsAutoScalerTest,
+     GetRecommendedNumberOfWorkersScaleDown) {
+  MultipleIterationsAutoScaler auto_scaler;
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Microseconds(10)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(100)));
+  // Estimated workers = 10. Current workers = 40.
+  EXPECT_THAT(auto_scaler.GetRecommendedNumberOfWorkers(40),
+              IsOkAndHolds(10));
+}
+
+TEST(MultipleIterationsAutoScalerTest,
+     GetRecommendedNumberOfWorkersWithinTolerance) {
+  MultipleIterationsAutoScaler auto_scaler;
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Microseconds(10)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(500)));
+  // Estimated workers = 50. The difference to the current number of workers is
+  // within 10%, so the cluster is not resized.
+  EXPECT_THAT(auto_scaler.GetRecommendedNumberOfWorkers(48),
+              IsOkAndHolds(48));
+  EXPECT_THAT(auto_scaler.GetRecommendedNumberOfWorkers(54),
+              IsOkAndHolds(54));
+  EXPECT_THAT(auto_scaler.GetRecommendedNumberOfWorkers(60),
+              IsOkAndHolds(50));
+}
+
 TEST(MultipleIterationsAutoScalerTest, ReportProcessingTimeNewIteration) {
   MultipleIterationsAutoScaler auto_scaler;
   TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
@@ -15,19 +15,30 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -46,6 +57,12 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// Optionally, the cache has a second tier on local disk. Elements evicted from
+// memory are serialized, compressed, and written to disk, where they are kept
+// within a separate byte budget. Trainers which fall behind the in-memory
+// window read these elements from disk instead of skipping them. New trainers
+// still start from the in-memory window.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -78,7 +95,8 @@ namespace data {
 // To use the cache, the user needs to define a `CachableSequence` to generate
 // an infinite sequence of data. It should implement a `GetNext` method to
 // produce elements, and a `GetElementSizeBytes` method to estimate the element
-// size in bytes.
+// size in bytes. To use the disk tier, it should also implement
+// `SerializeElement` and `DeserializeElement`.
 template <class ElementType>
 class CachableSequence {
  public:
@@ -89,6 +107,37 @@ class CachableSequence {
 
   // Returns the estimated size of the element in bytes.
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
+
+  // Serializes an element to be written to the disk tier. May be called
+  // concurrently with `DeserializeElement`.
+  virtual absl::StatusOr<std::string> SerializeElement(
+      const ElementType&) const {
+    return absl::UnimplementedError(
+        "The cachable sequence does not support serializing elements.");
+  }
+
+  // Deserializes an element read from the disk tier. Must be thread-safe.
+  virtual absl::StatusOr<ElementType> DeserializeElement(
+      absl::string_view) const {
+    return absl::UnimplementedError(
+        "The cachable sequence does not support deserializing elements.");
+  }
+};
+
+// Options of the disk tier of a `CrossTrainerCache`.
+struct CrossTrainerCacheDiskOptions {
+  // Local directory to write the elements evicted from memory. It should not be
+  // shared with other caches. The disk tier is disabled if it is empty.
+  std::string directory;
+
+  // Maximum size of the disk tier in bytes, after compression. The disk tier is
+  // disabled if it is 0.
+  size_t max_size_bytes = 0;
+
+  // If true, elements are compressed with Snappy before they are written.
+  bool compress = true;
+
+  Env* env = Env::Default();
 };
 
 // Sliding-window cache shared across concurrent trainers.
@@ -101,7 +150,16 @@ class CrossTrainerCache {
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
       std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
-  virtual ~CrossTrainerCache() = default;
+
+  // Creates a `CrossTrainerCache` with `max_cache_size_bytes` of memory budget
+  // and a disk tier configured by `disk_options`.
+  explicit CrossTrainerCache(
+      size_t max_cache_size_bytes,
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      CrossTrainerCacheDiskOptions disk_options);
+
+  // Deletes the files of the disk tier.
+  virtual ~CrossTrainerCache();
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
 
@@ -124,18 +182,39 @@ class CrossTrainerCache {
   struct CacheQueryResult {
     std::shared_ptr<const ElementType> element;
     bool cache_hit;
+    bool from_disk;
+  };
+
+  // An element evicted from memory and written to the disk tier.
+  struct DiskElement {
+    std::string filename;
+    // Size of the file in bytes.
+    size_t size_bytes;
   };
 
   // Returns the next element and metrics about this query.
   StatusOr<CacheQueryResult> GetCacheQueryResult(const std::string& trainer_id);
 
+  // Returns true if the disk tier is enabled.
+  bool IsDiskTierEnabled() const;
+
+  // Returns the absolute index of the first element in the disk tier. The disk
+  // tier holds elements [DiskStartIndex(), cache_start_index_).
+  size_t DiskStartIndex() const;
+
+  // If the next element for `trainer_id` is in the disk tier, returns its file
+  // and moves the trainer to the following element. Otherwise, returns
+  // `std::nullopt`.
+  std::optional<DiskElement> GetDiskElement(const std::string& trainer_id);
+
   // Returns true if element is ready for `trainer_id`. An element is ready if
   // other trainers have read the data and the data remains in the cache. If the
   // data is not ready, one of the trainers need to extend the cache.
   bool IsElementReady(const std::string& trainer_id);
 
   // Returns the absolute element index relative to the dataset (not relative to
-  // the cached elements).
+  // the cached elements). New trainers start from the in-memory window. Other
+  // trainers skip elements that have been evicted from both tiers.
   size_t GetElementIndex(const std::string& trainer_id);
 
   // Returns the next element for `trainer_id`.
@@ -145,9 +224,34 @@ class CrossTrainerCache {
   // Reads a new element and writes it into the cache.
   absl::Status ExtendCache();
 
-  // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
-  // `new_element_size_bytes` is the size of the new element being inserted.
-  void FreeSpace(size_t new_element_size_bytes);
+  // Returns the oldest elements to free to keep the cache size below
+  // `max_cache_size_bytes_`. `new_element_size_bytes` is the size of the new
+  // element being inserted.
+  std::vector<std::shared_ptr<const ElementType>> GetElementsToFree(
+      size_t new_element_size_bytes);
+
+  // Frees the `num_elements` oldest elements from memory. `disk_elements` are
+  // their copies in the disk tier, or empty if they have not been written to
+  // disk. Returns the files evicted from the disk tier, which the caller
+  // should delete without holding `mu_`.
+  std::vector<std::string> FreeSpace(size_t num_elements,
+                                     std::vector<DiskElement> disk_elements);
+
+  // Writes `elements`, starting at absolute index `first_element_index`, to
+  // the disk tier.
+  absl::StatusOr<std::vector<DiskElement>> WriteToDisk(
+      size_t first_element_index,
+      const std::vector<std::shared_ptr<const ElementType>>& elements) const;
+  absl::StatusOr<DiskElement> WriteElement(size_t element_index,
+                                           const ElementType& element) const;
+
+  // Reads an element from the disk tier. Returns NotFound if it has been
+  // evicted concurrently.
+  absl::StatusOr<std::shared_ptr<const ElementType>> ReadFromDisk(
+      const DiskElement& disk_element) const;
+
+  // Deletes files of the disk tier. Errors are logged and ignored.
+  void DeleteFiles(const std::vector<std::string>& filenames) const;
 
   // Records the cache hit rate and cache size.
   void RecordMetrics(const CacheQueryResult& result);
@@ -158,6 +262,8 @@ class CrossTrainerCache {
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
+  const CrossTrainerCacheDiskOptions disk_options_;
+
   mutable mutex mu_;
   mutable condition_variable cv_;
 
@@ -170,12 +276,20 @@ class CrossTrainerCache {
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
 
+  // `disk_cache_` stores the elements evicted from `cache_` that remain in the
+  // disk tier. They precede the in-memory elements, i.e., the last element of
+  // `disk_cache_` has index `cache_start_index_ - 1`.
+  std::deque<DiskElement> disk_cache_ TF_GUARDED_BY(mu_);
+  size_t disk_cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
 
   // Maps trainer IDs to element indices. The indices are absolute indices
   // within the dataset. The actual index to use with `cache_` would be
-  // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`.
+  // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`, or
+  // `trainer_to_element_index_map_[trainer_id] - DiskStartIndex()` to use with
+  // `disk_cache_`.
   absl::flat_hash_map<std::string, size_t> trainer_to_element_index_map_
       TF_GUARDED_BY(mu_);
 };
@@ -184,12 +298,38 @@ template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
     std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    : CrossTrainerCache(max_cache_size_bytes, std::move(cachable_sequence),
+                        CrossTrainerCacheDiskOptions()) {}
+
+template <class ElementType>
+CrossTrainerCache<ElementType>::CrossTrainerCache(
+    size_t max_cache_size_bytes,
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    CrossTrainerCacheDiskOptions disk_options)
     : max_cache_size_bytes_(max_cache_size_bytes),
-      cachable_sequence_(std::move(cachable_sequence)) {
+      cachable_sequence_(std::move(cachable_sequence)),
+      disk_options_(std::move(disk_options)) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
           << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
+  if (IsDiskTierEnabled()) {
+    VLOG(2) << "Initialized tf.data service cross-trainer cache disk tier "
+            << "with " << ByteSize::Bytes(disk_options_.max_size_bytes)
+            << " at " << disk_options_.directory << ".";
+  }
+}
+
+template <class ElementType>
+CrossTrainerCache<ElementType>::~CrossTrainerCache() {
+  std::vector<std::string> filenames;
+  {
+    mutex_lock l(mu_);
+    for (const DiskElement& disk_element : disk_cache_) {
+      filenames.push_back(disk_element.filename);
+    }
+  }
+  DeleteFiles(filenames);
 }
 
 template <class ElementType>
@@ -212,20 +352,23 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    std::optional<DiskElement> disk_element;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
-      if (IsElementReady(trainer_id)) {
+      disk_element = GetDiskElement(trainer_id);
+      if (disk_element.has_value()) {
+        should_extend_cache = false;
+      } else if (IsElementReady(trainer_id)) {
         TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
                             GetElement(trainer_id));
         return CacheQueryResult{element,
-                                /*is_cache_hit=*/!should_extend_cache};
-      }
-
-      // Extends the cache or waits for another thread to extend the cache. When
-      // concurrent trainers wait for the next element, only one of them should
-      // extend the cache.
-      if (extending_cache_) {
+                                /*is_cache_hit=*/!should_extend_cache,
+                                /*from_disk=*/false};
+      } else if (extending_cache_) {
+        // Extends the cache or waits for another thread to extend the cache.
+        // When concurrent trainers wait for the next element, only one of them
+        // should extend the cache.
         should_extend_cache = false;
         cv_.wait(l);
       } else {
@@ -234,6 +377,20 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    // Reads the element from disk without holding the lock.
+    if (disk_element.has_value()) {
+      absl::StatusOr<std::shared_ptr<const ElementType>> element =
+          ReadFromDisk(*disk_element);
+      if (absl::IsNotFound(element.status())) {
+        // The element has been evicted from disk after the lookup. Retries
+        // with the next element.
+        continue;
+      }
+      TF_RETURN_IF_ERROR(element.status());
+      return CacheQueryResult{*std::move(element), /*is_cache_hit=*/true,
+                              /*from_disk=*/true};
+    }
+
     if (should_extend_cache) {
       absl::Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -270,11 +427,35 @@ CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
 template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+  auto it = trainer_to_element_index_map_.find(trainer_id);
+  if (it == trainer_to_element_index_map_.end()) {
+    return cache_start_index_;
   }
-  return element_index;
+  return std::max(it->second, DiskStartIndex());
+}
+
+template <class ElementType>
+bool CrossTrainerCache<ElementType>::IsDiskTierEnabled() const {
+  return !disk_options_.directory.empty() && disk_options_.max_size_bytes > 0;
+}
+
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::DiskStartIndex() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  return cache_start_index_ - disk_cache_.size();
+}
+
+template <class ElementType>
+std::optional<typename CrossTrainerCache<ElementType>::DiskElement>
+CrossTrainerCache<ElementType>::GetDiskElement(const std::string& trainer_id)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  size_t element_index = GetElementIndex(trainer_id);
+  if (element_index >= cache_start_index_) {
+    return std::nullopt;
+  }
+  DiskElement disk_element = disk_cache_[element_index - DiskStartIndex()];
+  trainer_to_element_index_map_[trainer_id] = element_index + 1;
+  return disk_element;
 }
 
 template <class ElementType>
@@ -290,31 +471,189 @@ absl::Status CrossTrainerCache<ElementType>::ExtendCache()
         " and cache size: ", max_cache_size_bytes_);
   }
 
-  mutex_lock l(mu_);
-  TF_RETURN_IF_ERROR(status_);
-  FreeSpace(new_element_size_bytes);
-  cache_.push_back(std::make_shared<ElementType>(std::move(element)));
-  cache_size_bytes_ += new_element_size_bytes;
-  return absl::OkStatus();
+  // Only one thread extends the cache at a time, so the elements to free stay
+  // at the front of `cache_` while they are written to disk without holding
+  // the lock. In the meantime, trainers can still read them from memory.
+  std::vector<std::shared_ptr<const ElementType>> elements_to_free;
+  size_t first_element_index = 0;
+  {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(status_);
+    elements_to_free = GetElementsToFree(new_element_size_bytes);
+    first_element_index = cache_start_index_;
+  }
+
+  std::vector<DiskElement> disk_elements;
+  if (IsDiskTierEnabled() && !elements_to_free.empty()) {
+    absl::StatusOr<std::vector<DiskElement>> written =
+        WriteToDisk(first_element_index, elements_to_free);
+    if (written.ok()) {
+      disk_elements = *std::move(written);
+    } else {
+      LOG_EVERY_N_SEC(WARNING, 60)
+          << "Failed to write evicted elements to the tf.data service "
+          << "cross-trainer cache disk tier at " << disk_options_.directory
+          << ": " << written.status() << ". The elements are discarded.";
+    }
+  }
+
+  std::vector<std::string> files_to_delete;
+  absl::Status status;
+  {
+    mutex_lock l(mu_);
+    files_to_delete =
+        FreeSpace(elements_to_free.size(), std::move(disk_elements));
+    cache_.push_back(std::make_shared<ElementType>(std::move(element)));
+    cache_size_bytes_ += new_element_size_bytes;
+    status = status_;
+  }
+  DeleteFiles(files_to_delete);
+  return status;
+}
+
+template <class ElementType>
+std::vector<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::GetElementsToFree(
+    size_t new_element_size_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const ElementType>> elements_to_free;
+  size_t cache_size_bytes = cache_size_bytes_;
+  for (const std::shared_ptr<const ElementType>& element : cache_) {
+    if (cache_size_bytes + new_element_size_bytes <= max_cache_size_bytes_) {
+      break;
+    }
+    cache_size_bytes -= cachable_sequence_->GetElementSizeBytes(*element);
+    elements_to_free.push_back(element);
+  }
+  return elements_to_free;
 }
 
 template <class ElementType>
-void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
+std::vector<std::string> CrossTrainerCache<ElementType>::FreeSpace(
+    size_t num_elements, std::vector<DiskElement> disk_elements)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  size_t num_elements_discarded = 0;
-  while (!cache_.empty() &&
-         cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
+  for (size_t i = 0; i < num_elements; ++i) {
     size_t free_bytes =
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
     ++cache_start_index_;
-    ++num_elements_discarded;
   }
 
-  VLOG(3) << "Freed " << num_elements_discarded << " element(s) from "
+  // The disk tier holds consecutive elements preceding the in-memory window.
+  // If the freed elements have not been written to disk, it is discarded.
+  std::vector<std::string> files_to_delete;
+  if (disk_elements.size() != num_elements) {
+    for (const DiskElement& disk_element : disk_cache_) {
+      files_to_delete.push_back(disk_element.filename);
+    }
+    disk_cache_.clear();
+    disk_cache_size_bytes_ = 0;
+    disk_elements.clear();
+  }
+  for (DiskElement& disk_element : disk_elements) {
+    disk_cache_size_bytes_ += disk_element.size_bytes;
+    disk_cache_.push_back(std::move(disk_element));
+  }
+  while (!disk_cache_.empty() &&
+         disk_cache_size_bytes_ > disk_options_.max_size_bytes) {
+    disk_cache_size_bytes_ -= disk_cache_.front().size_bytes;
+    files_to_delete.push_back(std::move(disk_cache_.front().filename));
+    disk_cache_.pop_front();
+  }
+
+  VLOG(3) << "Freed " << num_elements << " element(s) from "
           << "tf.data service cross-trainer cache. Memory usage: "
-          << ByteSize::Bytes(cache_size_bytes_) << ".";
+          << ByteSize::Bytes(cache_size_bytes_)
+          << ". Disk usage: " << ByteSize::Bytes(disk_cache_size_bytes_)
+          << ".";
+  return files_to_delete;
+}
+
+template <class ElementType>
+absl::StatusOr<
+    std::vector<typename CrossTrainerCache<ElementType>::DiskElement>>
+CrossTrainerCache<ElementType>::WriteToDisk(
+    size_t first_element_index,
+    const std::vector<std::shared_ptr<const ElementType>>& elements) const {
+  TF_RETURN_IF_ERROR(
+      disk_options_.env->RecursivelyCreateDir(disk_options_.directory));
+  std::vector<DiskElement> disk_elements;
+  for (size_t i = 0; i < elements.size(); ++i) {
+    absl::StatusOr<DiskElement> disk_element =
+        WriteElement(first_element_index + i, *elements[i]);
+    if (!disk_element.ok()) {
+      std::vector<std::string> filenames;
+      for (const DiskElement& written : disk_elements) {
+        filenames.push_back(written.filename);
+      }
+      DeleteFiles(filenames);
+      return disk_element.status();
+    }
+    disk_elements.push_back(*std::move(disk_element));
+  }
+  return disk_elements;
+}
+
+template <class ElementType>
+absl::StatusOr<typename CrossTrainerCache<ElementType>::DiskElement>
+CrossTrainerCache<ElementType>::WriteElement(size_t element_index,
+                                             const ElementType& element) const {
+  TF_ASSIGN_OR_RETURN(std::string contents,
+                      cachable_sequence_->SerializeElement(element));
+  if (disk_options_.compress) {
+    std::string compressed;
+    if (!port::Snappy_Compress(contents.data(), contents.size(),
+                               &compressed)) {
+      return absl::UnimplementedError(
+          "Snappy compression is not supported on this platform.");
+    }
+    contents = std::move(compressed);
+  }
+  const std::string filename = io::JoinPath(
+      disk_options_.directory, absl::StrCat("element_", element_index));
+  TF_RETURN_IF_ERROR(WriteStringToFile(disk_options_.env, filename, contents));
+  return DiskElement{filename, contents.size()};
+}
+
+template <class ElementType>
+absl::StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::ReadFromDisk(
+    const DiskElement& disk_element) const {
+  std::string contents;
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(disk_options_.env, disk_element.filename, &contents));
+  if (disk_options_.compress) {
+    size_t uncompressed_size = 0;
+    if (!port::Snappy_GetUncompressedLength(contents.data(), contents.size(),
+                                            &uncompressed_size)) {
+      return absl::DataLossError(absl::StrCat(
+          "Failed to read tf.data service cross-trainer cache file ",
+          disk_element.filename, ": Invalid Snappy-compressed data."));
+    }
+    std::string uncompressed(uncompressed_size, '\0');
+    if (!port::Snappy_Uncompress(contents.data(), contents.size(),
+                                 uncompressed.data())) {
+      return absl::DataLossError(absl::StrCat(
+          "Failed to read tf.data service cross-trainer cache file ",
+          disk_element.filename, ": Invalid Snappy-compressed data."));
+    }
+    contents = std::move(uncompressed);
+  }
+  TF_ASSIGN_OR_RETURN(ElementType element,
+                      cachable_sequence_->DeserializeElement(contents));
+  return std::make_shared<const ElementType>(std::move(element));
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::DeleteFiles(
+    const std::vector<std::string>& filenames) const {
+  for (const std::string& filename : filenames) {
+    absl::Status status = disk_options_.env->DeleteFile(filename);
+    if (!status.ok() && !absl::IsNotFound(status)) {
+      LOG(WARNING) << "Failed to delete tf.data service cross-trainer cache "
+                   << "file " << filename << ": " << status;
+    }
+  }
 }
 
 template <class ElementType>
@@ -341,12 +680,20 @@ template <class ElementType>
 void CrossTrainerCache<ElementType>::RecordMetrics(
     const CacheQueryResult& result) {
   metrics::RecordTFDataServiceCrossTrainerCacheQuery(result.cache_hit);
+  metrics::RecordTFDataServiceCrossTrainerCacheTierQuery(
+      result.from_disk ? "disk" : "memory");
   size_t cache_size_bytes = 0;
+  size_t disk_cache_size_bytes = 0;
   {
     mutex_lock l(mu_);
     cache_size_bytes = cache_size_bytes_;
+    disk_cache_size_bytes = disk_cache_size_bytes_;
   }
   metrics::RecordTFDataServiceCrossTrainerCacheSizeBytes(cache_size_bytes);
+  if (IsDiskTierEnabled()) {
+    metrics::RecordTFDataServiceCrossTrainerCacheDiskSizeBytes(
+        disk_cache_size_bytes);
+  }
 }
 
 }  // namespace data
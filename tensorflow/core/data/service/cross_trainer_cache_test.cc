@@ -22,14 +22,19 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -46,7 +51,9 @@ using ::tensorflow::testing::IsOkAndHolds;
 using ::tensorflow::testing::StatusIs;
 using ::testing::Gt;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 using ::testing::Pointee;
+using ::testing::SizeIs;
 using ::testing::UnorderedElementsAreArray;
 
 class InfiniteRange : public CachableSequence<int64_t> {
@@ -61,6 +68,25 @@ class InfiniteRange : public CachableSequence<int64_t> {
   int64_t next_ = 0;
 };
 
+// An `InfiniteRange` which supports the disk tier. Elements are serialized as
+// decimal strings.
+class SerializableInfiniteRange : public InfiniteRange {
+ public:
+  absl::StatusOr<std::string> SerializeElement(
+      const int64_t& element) const override {
+    return absl::StrCat(element);
+  }
+
+  absl::StatusOr<int64_t> DeserializeElement(
+      absl::string_view serialized) const override {
+    int64_t element = 0;
+    if (!absl::SimpleAtoi(serialized, &element)) {
+      return errors::DataLoss("Invalid element: ", serialized);
+    }
+    return element;
+  }
+};
+
 class TensorDataset : public CachableSequence<Tensor> {
  public:
   absl::StatusOr<Tensor> GetNext() override { return Tensor("Test Tensor"); }
@@ -129,6 +155,16 @@ std::vector<int64_t> GetRange(const size_t range) {
   return result;
 }
 
+CrossTrainerCacheDiskOptions GetDiskOptions(size_t max_size_bytes,
+                                            bool compress = true) {
+  CrossTrainerCacheDiskOptions disk_options;
+  disk_options.directory = io::JoinPath(
+      testing::TmpDir(), absl::StrCat("cross_trainer_cache_", random::New64()));
+  disk_options.max_size_bytes = max_size_bytes;
+  disk_options.compress = compress;
+  return disk_options;
+}
+
 bool SequenceIsIncreasing(const std::vector<int64_t> sequence) {
   for (int i = 1; i < sequence.size(); ++i) {
     if (sequence[i - 1] > sequence[i - 1]) {
@@ -443,6 +479,109 @@ TEST(CrossTrainerCacheTest, TrainerIDMustBeNonEmpty) {
                                       "requires a non-empty trainer ID."));
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadFromDisk) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SerializableInfiniteRange>(),
+      GetDiskOptions(/*max_size_bytes=*/1 << 20));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // The slow trainer reads the elements evicted from memory from disk.
+  for (int i = 1; i < 200; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, SkewedTrainerSpeeds) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SerializableInfiniteRange>(),
+      GetDiskOptions(/*max_size_bytes=*/1 << 20));
+  const std::vector<int64_t> speeds = {1, 3, 10};
+  std::vector<int64_t> next_elements(speeds.size(), 0);
+  for (int step = 0; step < 50; ++step) {
+    for (size_t j = 0; j < speeds.size(); ++j) {
+      for (int64_t k = 0; k < speeds[j]; ++k) {
+        EXPECT_THAT(cache.Get(absl::StrCat("Trainer ", j)),
+                    IsOkAndHolds(Pointee(next_elements[j]++)));
+      }
+    }
+  }
+}
+
+TEST(CrossTrainerCacheTest, DiskSizeLimit) {
+  // Elements 10 to 99 take 2 bytes on disk, so the disk tier holds 5 elements.
+  CrossTrainerCacheDiskOptions disk_options =
+      GetDiskOptions(/*max_size_bytes=*/10, /*compress=*/false);
+  const std::string directory = disk_options.directory;
+  auto cache = std::make_unique<CrossTrainerCache<int64_t>>(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SerializableInfiniteRange>(), std::move(disk_options));
+  EXPECT_THAT(cache->Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache->Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // 95 to 99 are in memory, 90 to 94 are on disk, and 0 to 89 are discarded.
+  std::vector<std::string> files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &files));
+  EXPECT_THAT(files, SizeIs(5));
+  for (int i = 90; i < 100; ++i) {
+    EXPECT_THAT(cache->Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // New trainers start from the in-memory window.
+  EXPECT_THAT(cache->Get("New trainer"), IsOkAndHolds(Pointee(95)));
+
+  // The files are deleted with the cache.
+  cache.reset();
+  TF_ASSERT_OK(Env::Default()->GetChildren(directory, &files));
+  EXPECT_THAT(files, IsEmpty());
+}
+
+TEST(CrossTrainerCacheTest, DiskTierMetrics) {
+  CellReader<int64_t> tier_reader(
+      "/tensorflow/data/service/cross_trainer_cache_tier_queries");
+  CellReader<int64_t> disk_size_reader(
+      "/tensorflow/data/service/cross_trainer_cache_disk_size_bytes");
+
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<SerializableInfiniteRange>(),
+      GetDiskOptions(/*max_size_bytes=*/10, /*compress=*/false));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_EQ(tier_reader.Delta("memory"), 101);
+  EXPECT_EQ(tier_reader.Delta("disk"), 0);
+  EXPECT_EQ(disk_size_reader.Read(), 10);
+
+  for (int i = 90; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_EQ(tier_reader.Delta("memory"), 5);
+  EXPECT_EQ(tier_reader.Delta("disk"), 5);
+}
+
+TEST(CrossTrainerCacheTest, UnserializableElementsAreDiscarded) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      GetDiskOptions(/*max_size_bytes=*/1 << 20));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // `InfiniteRange` does not support serialization, so the slow trainer skips
+  // the evicted elements.
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(Gt(94))));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -333,6 +333,35 @@ absl::Status DataServiceDispatcherClient::GetWorkers(
   return absl::OkStatus();
 }
 
+absl::Status DataServiceDispatcherClient::GetScalingRecommendations(
+    int64_t after_sequence_number,
+    GetScalingRecommendationsResponse& response) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetScalingRecommendationsRequest req;
+  req.set_after_sequence_number(after_sequence_number);
+  grpc::ClientContext ctx;
+  grpc::Status s = stub_->GetScalingRecommendations(&ctx, req, &response);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get scaling recommendations", s);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DataServiceDispatcherClient::DrainWorker(
+    const std::string& worker_address) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  DrainWorkerRequest req;
+  req.set_worker_address(worker_address);
+  DrainWorkerResponse resp;
+  grpc::ClientContext ctx;
+  grpc::Status s = stub_->DrainWorker(&ctx, req, &resp);
+  if (!s.ok()) {
+    return grpc_util::WrapError(
+        absl::StrCat("Failed to drain worker ", worker_address), s);
+  }
+  return absl::OkStatus();
+}
+
 absl::Status DataServiceDispatcherClient::GetDataServiceMetadata(
     const std::string& dataset_id, DataServiceMetadata& metadata) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
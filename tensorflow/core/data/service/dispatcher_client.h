@@ -124,6 +124,17 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
   // stored in `workers`.
   absl::Status GetWorkers(std::vector<WorkerInfo>& workers);
 
+  // Returns the scaling recommendations with sequence numbers greater than
+  // `after_sequence_number`, together with the draining and drained workers.
+  absl::Status GetScalingRecommendations(
+      int64_t after_sequence_number,
+      GetScalingRecommendationsResponse& response);
+
+  // Stops assigning tasks for new iterations to the worker at
+  // `worker_address`. The worker keeps serving its existing tasks, and is
+  // still assigned tasks of statically sharded iterations.
+  absl::Status DrainWorker(const std::string& worker_address);
+
   // Returns data service metadata for the registered dataset.
   absl::Status GetDataServiceMetadata(const std::string& dataset_id,
                                       DataServiceMetadata& metadata);
@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dataset_store.h"
+#include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/test_cluster.h"
 #include "tensorflow/core/data/service/test_util.h"
@@ -53,10 +55,15 @@ using ::tensorflow::data::testing::EqualsProto;
 using ::tensorflow::data::testing::InfiniteDataset;
 using ::tensorflow::data::testing::LocalTempFilename;
 using ::tensorflow::data::testing::RangeDataset;
+using ::tensorflow::testing::IsOkAndHolds;
 using ::tensorflow::testing::StatusIs;
 using ::testing::AllOf;
 using ::testing::ContainsRegex;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
 
 constexpr const char kProtocol[] = "grpc";
 
@@ -388,6 +395,114 @@ TEST_F(DispatcherClientTest, NamedJobsDoNotMatch) {
                      HasSubstr("Existing cross-trainer cache: <disabled>"))));
 }
 
+TEST_F(DispatcherClientTest, DrainedWorkerIsNotAssignedNewTasks) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/2));
+  TF_ASSERT_OK(
+      dispatcher_client_->DrainWorker(test_cluster_->WorkerAddress(0)));
+
+  DatasetClient<int64_t> dataset_client(*test_cluster_);
+  EXPECT_THAT(dataset_client.Read(RangeDataset(5), ProcessingModeDef::OFF,
+                                  TARGET_WORKERS_AUTO),
+              IsOkAndHolds(UnorderedElementsAre(
+                  Pair(test_cluster_->WorkerAddress(1),
+                       ElementsAre(0, 1, 2, 3, 4)))));
+}
+
+TEST_F(DispatcherClientTest, DrainingWorkerKeepsExistingTasks) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/2));
+  DatasetClient<int64_t> dataset_client(*test_cluster_);
+  TF_ASSERT_OK_AND_ASSIGN(int64_t iteration_client_id,
+                          dataset_client.CreateIteration(InfiniteDataset()));
+  TF_ASSERT_OK(
+      dispatcher_client_->DrainWorker(test_cluster_->WorkerAddress(0)));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<TaskInfo> tasks,
+                          dataset_client.GetTasks(iteration_client_id));
+  EXPECT_EQ(tasks.size(), 2);
+  GetScalingRecommendationsResponse response;
+  TF_ASSERT_OK(dispatcher_client_->GetScalingRecommendations(
+      /*after_sequence_number=*/0, response));
+  EXPECT_THAT(response.draining_workers(),
+              ElementsAre(test_cluster_->WorkerAddress(0)));
+  EXPECT_THAT(response.drained_workers(), IsEmpty());
+}
+
+TEST_F(DispatcherClientTest, IdleDrainingWorkerIsDrained) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/2));
+  TF_ASSERT_OK(
+      dispatcher_client_->DrainWorker(test_cluster_->WorkerAddress(1)));
+
+  GetScalingRecommendationsResponse response;
+  TF_ASSERT_OK(dispatcher_client_->GetScalingRecommendations(
+      /*after_sequence_number=*/0, response));
+  EXPECT_THAT(response.draining_workers(), IsEmpty());
+  EXPECT_THAT(response.drained_workers(),
+              ElementsAre(test_cluster_->WorkerAddress(1)));
+}
+
+TEST_F(DispatcherClientTest, AddedWorkerIsAssignedNewTasks) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
+  TF_ASSERT_OK(
+      dispatcher_client_->DrainWorker(test_cluster_->WorkerAddress(0)));
+  TF_ASSERT_OK(test_cluster_->AddWorker());
+
+  DatasetClient<int64_t> dataset_client(*test_cluster_);
+  EXPECT_THAT(dataset_client.Read(RangeDataset(5), ProcessingModeDef::OFF,
+                                  TARGET_WORKERS_AUTO),
+              IsOkAndHolds(UnorderedElementsAre(
+                  Pair(test_cluster_->WorkerAddress(1),
+                       ElementsAre(0, 1, 2, 3, 4)))));
+}
+
+TEST_F(DispatcherClientTest, DrainingWorkerKeepsStaticShard) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/2));
+  TF_ASSERT_OK(test_cluster_->DrainWorker(0));
+
+  DatasetClient<int64_t> dataset_client(*test_cluster_);
+  EXPECT_THAT(
+      dataset_client.Read(RangeDataset(4), ProcessingModeDef::DATA,
+                          TARGET_WORKERS_LOCAL),
+      IsOkAndHolds(UnorderedElementsAre(
+          Pair(test_cluster_->WorkerAddress(0), ElementsAre(0, 2)),
+          Pair(test_cluster_->WorkerAddress(1), ElementsAre(1, 3)))));
+}
+
+TEST_F(DispatcherClientTest, ElasticWorkerPool) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/2));
+  absl::flat_hash_set<std::string> active_workers = {
+      test_cluster_->WorkerAddress(0), test_cluster_->WorkerAddress(1)};
+  // Alternately scales the pool up and down. Every epoch should read the full
+  // dataset from each active worker, so throughput per worker stays constant
+  // while workers join and leave.
+  for (int step = 0; step < 4; ++step) {
+    if (step % 2 == 0) {
+      TF_ASSERT_OK(test_cluster_->AddWorker());
+      active_workers.insert(
+          test_cluster_->WorkerAddress(test_cluster_->NumWorkers() - 1));
+    } else {
+      TF_ASSERT_OK(test_cluster_->DrainWorker(step / 2));
+      active_workers.erase(test_cluster_->WorkerAddress(step / 2));
+    }
+
+    DatasetClient<int64_t> dataset_client(*test_cluster_);
+    TF_ASSERT_OK_AND_ASSIGN(
+        DatasetClient<int64_t>::WorkerResultMap result,
+        dataset_client.Read(RangeDataset(10), ProcessingModeDef::OFF,
+                            TARGET_WORKERS_AUTO));
+    EXPECT_EQ(result.size(), active_workers.size());
+    for (const auto& [worker_address, elements] : result) {
+      EXPECT_TRUE(active_workers.contains(worker_address)) << worker_address;
+      EXPECT_EQ(elements.size(), 10) << worker_address;
+    }
+  }
+}
+
+TEST_F(DispatcherClientTest, DrainUnknownWorker) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
+  EXPECT_THAT(dispatcher_client_->DrainWorker("unknown_worker:1234"),
+              StatusIs(error::NOT_FOUND));
+}
+
 class DispatcherClientTest_DatasetId
     : public DispatcherClientTest,
       public ::testing::WithParamInterface<std::optional<std::string>> {};
@@ -105,6 +105,9 @@ constexpr absl::Duration kDefaultIterationGcTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultClientTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultWorkerTimeout = absl::Minutes(10);
 
+// The maximum number of scaling recommendations kept by the dispatcher.
+constexpr size_t kMaxScalingRecommendations = 100;
+
 constexpr std::array<const char*, 8> kNodeNameSharingOps = {
     "HashTable",
     "HashTableV2",
@@ -376,7 +379,8 @@ absl::Status DataServiceDispatcherImpl::FindNewTasks(
   }
   for (const auto& iteration : state_.ListIterations()) {
     if (!assigned_iteration_ids.contains(iteration->iteration_id) &&
-        iteration->IsRoundRobin() && !iteration->finished) {
+        iteration->IsRoundRobin() && !iteration->finished &&
+        !SkipDrainingWorker(*iteration, worker_address)) {
       VLOG(1) << "Creating pending task for reconnected worker "
               << worker_address;
       TF_RETURN_IF_ERROR(CreatePendingTask(iteration, worker_address));
@@ -946,6 +950,12 @@ absl::Status DataServiceDispatcherImpl::CreateTasksForIteration(
   tasks.clear();
   tasks.reserve(workers.size());
   for (const auto& worker : workers) {
+    if (SkipDrainingWorker(*iteration, worker->address)) {
+      VLOG(1) << "Not creating a task for iteration "
+              << iteration->iteration_id << " on draining worker "
+              << worker->address;
+      continue;
+    }
     std::shared_ptr<const Task> task;
     TF_RETURN_IF_ERROR(CreateTask(iteration, worker->address, task));
     tasks.push_back(task);
@@ -1186,6 +1196,51 @@ absl::Status DataServiceDispatcherImpl::GetWorkers(
   return absl::OkStatus();
 }
 
+absl::Status DataServiceDispatcherImpl::GetScalingRecommendations(
+    const GetScalingRecommendationsRequest* request,
+    GetScalingRecommendationsResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  mutex_lock l(mu_);
+  VLOG(3) << "Enter GetScalingRecommendations";
+  for (const ScalingRecommendation& recommendation :
+       scaling_recommendations_) {
+    if (recommendation.sequence_number() > request->after_sequence_number()) {
+      *response->add_recommendations() = recommendation;
+    }
+  }
+  for (const std::string& worker_address : draining_workers_) {
+    if (IsWorkerDrained(worker_address)) {
+      response->add_drained_workers(worker_address);
+    } else {
+      response->add_draining_workers(worker_address);
+    }
+  }
+  return absl::OkStatus();
+}
+
+bool DataServiceDispatcherImpl::SkipDrainingWorker(
+    const Iteration& iteration, const std::string& worker_address) const {
+  if (!draining_workers_.contains(worker_address)) {
+    return false;
+  }
+  // Under static sharding, each worker produces its own shard of the dataset,
+  // so skipping the worker would drop the shard.
+  return !IsStaticShard(iteration.job->processing_mode);
+}
+
+absl::Status DataServiceDispatcherImpl::DrainWorker(
+    const DrainWorkerRequest* request, DrainWorkerResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  mutex_lock l(mu_);
+  std::shared_ptr<const Worker> worker;
+  TF_RETURN_IF_ERROR(
+      state_.WorkerFromAddress(request->worker_address(), worker));
+  if (draining_workers_.insert(worker->address).second) {
+    LOG(INFO) << "Draining tf.data service worker " << worker->address;
+  }
+  return absl::OkStatus();
+}
+
 absl::Status DataServiceDispatcherImpl::Snapshot(const SnapshotRequest* request,
                                                  SnapshotResponse* response) {
   if (!config_.fault_tolerant_mode()) {
@@ -1411,6 +1466,7 @@ void DataServiceDispatcherImpl::MaintenanceThread() {
                 << s;
       }
     }
+    UpdateScalingRecommendations();
     {
       absl::Status s = GcOldIterations();
       if (!s.ok()) {
@@ -1484,6 +1540,49 @@ void DataServiceDispatcherImpl::RemoveWorkerFromAutoScaler(
   }
 }
 
+void DataServiceDispatcherImpl::UpdateScalingRecommendations()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const int64_t num_workers =
+      state_.GetNumberOfRegisteredWorkers() -
+      static_cast<int64_t>(draining_workers_.size());
+  absl::StatusOr<int64_t> recommended_num_workers =
+      auto_scaler_.GetRecommendedNumberOfWorkers(num_workers);
+  if (!recommended_num_workers.ok()) {
+    VLOG(1) << "Error getting the recommended number of workers from "
+               "tf.data service AutoScaler: "
+            << recommended_num_workers.status();
+    return;
+  }
+  if (!scaling_recommendations_.empty() &&
+      scaling_recommendations_.back().recommended_number_of_workers() ==
+          *recommended_num_workers) {
+    return;
+  }
+  ScalingRecommendation recommendation;
+  recommendation.set_sequence_number(
+      ++next_scaling_recommendation_sequence_number_);
+  recommendation.set_current_number_of_workers(num_workers);
+  recommendation.set_recommended_number_of_workers(*recommended_num_workers);
+  recommendation.set_time_micros(env_->NowMicros());
+  VLOG(1) << "Recommending to scale the tf.data service from " << num_workers
+          << " to " << *recommended_num_workers << " workers";
+  scaling_recommendations_.push_back(std::move(recommendation));
+  if (scaling_recommendations_.size() > kMaxScalingRecommendations) {
+    scaling_recommendations_.pop_front();
+  }
+}
+
+bool DataServiceDispatcherImpl::IsWorkerDrained(
+    const std::string& worker_address) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const Task>> tasks;
+  if (!state_.TasksForWorker(worker_address, tasks).ok()) {
+    return true;
+  }
+  return absl::c_all_of(tasks, [](const std::shared_ptr<const Task>& task) {
+    return task->iteration->finished;
+  });
+}
+
 // TODO(b/250921378): Once snapshots have leases, inform snapshot managers.
 void DataServiceDispatcherImpl::DetectMissingWorkers()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1494,6 +1593,7 @@ void DataServiceDispatcherImpl::DetectMissingWorkers()
         it->second + absl::Milliseconds(config_.worker_timeout_ms())) {
       LOG(INFO) << "Lost worker " << it->first << " due to timeout";
       RemoveWorkerFromAutoScaler(it->first);
+      draining_workers_.erase(it->first);
 
       latest_worker_heartbeats_time_.erase(it++);
     } else {
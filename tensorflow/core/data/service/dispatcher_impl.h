@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_DISPATCHER_IMPL_H_
 
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -183,6 +184,11 @@ class DataServiceDispatcherImpl {
                                ClientHeartbeatResponse* response);
   absl::Status GetWorkers(const GetWorkersRequest* request,
                           GetWorkersResponse* response);
+  absl::Status GetScalingRecommendations(
+      const GetScalingRecommendationsRequest* request,
+      GetScalingRecommendationsResponse* response);
+  absl::Status DrainWorker(const DrainWorkerRequest* request,
+                           DrainWorkerResponse* response);
   absl::Status Snapshot(const SnapshotRequest* request,
                         SnapshotResponse* response);
   absl::Status GetSnapshotSplit(const GetSnapshotSplitRequest* request,
@@ -334,6 +340,19 @@ class DataServiceDispatcherImpl {
   // potentially associated with multiple iterations.
   void RemoveWorkerFromAutoScaler(const std::string& worker_address)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Records a new scaling recommendation if the number of workers recommended
+  // by `auto_scaler_` differs from the previously recorded one.
+  void UpdateScalingRecommendations() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns true if no task should be created for `iteration` on the worker
+  // with `worker_address` because the worker is draining. Draining workers are
+  // still assigned tasks of statically sharded iterations.
+  bool SkipDrainingWorker(const DispatcherState::Iteration& iteration,
+                          const std::string& worker_address) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns true if all tasks assigned to the worker with `worker_address`
+  // belong to finished iterations.
+  bool IsWorkerDrained(const std::string& worker_address) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Checks for workers that haven't heartbeated recently and alerts the
   // snapshot managers.
   void DetectMissingWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -384,6 +403,14 @@ class DataServiceDispatcherImpl {
   // Map from worker address to the time of the worker's last heartbeat.
   absl::flat_hash_map<std::string, absl::Time> latest_worker_heartbeats_time_
       TF_GUARDED_BY(mu_);
+  // Addresses of workers being drained. Draining workers keep serving their
+  // current tasks, but are not assigned tasks for new iterations unless the
+  // iteration is statically sharded. Draining state is not journaled, so it is
+  // lost on dispatcher restart.
+  absl::flat_hash_set<std::string> draining_workers_ TF_GUARDED_BY(mu_);
+  // The most recent scaling recommendations, oldest first.
+  std::deque<ScalingRecommendation> scaling_recommendations_ TF_GUARDED_BY(mu_);
+  int64_t next_scaling_recommendation_sequence_number_ TF_GUARDED_BY(mu_) = 0;
 
   // TODO(mpcallanan): Don't recover completed snapshots.
   // TODO(mpcallanan): Garbage collect completed snapshots.
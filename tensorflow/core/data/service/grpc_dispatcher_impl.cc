@@ -63,6 +63,8 @@ HANDLER(GetOrCreateJob);
 HANDLER(GetOrCreateIteration);
 HANDLER(ClientHeartbeat);
 HANDLER(GetWorkers);
+HANDLER(GetScalingRecommendations);
+HANDLER(DrainWorker);
 HANDLER(GetDataServiceMetadata);
 HANDLER(GetDataServiceConfig);
 HANDLER(Snapshot);
@@ -57,6 +57,8 @@ class GrpcDispatcherImpl : public DispatcherService::Service {
   HANDLER(GetOrCreateIteration);
   HANDLER(ClientHeartbeat);
   HANDLER(GetWorkers);
+  HANDLER(GetScalingRecommendations);
+  HANDLER(DrainWorker);
   HANDLER(GetDataServiceMetadata);
   HANDLER(GetDataServiceConfig);
   HANDLER(Snapshot);
@@ -0,0 +1,349 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/compacted_chunk.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/raw_coding.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
+#include "xla/tsl/lib/io/compression.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::data::experimental::CompactedChunkBlockHandle;
+using ::tensorflow::data::experimental::CompactedChunkIndex;
+using ::tensorflow::data::experimental::SnapshotRecord;
+
+constexpr uint64_t kCompactedChunkMagic = 0x6b6e756863666474;  // "tdfchunk"
+constexpr size_t kFooterSize = 2 * sizeof(uint64_t);
+constexpr const char kTempFileSuffix[] = ".tmp";
+
+absl::StatusOr<std::string> UncompressBlock(absl::string_view block,
+                                            absl::string_view compression) {
+  if (compression == tsl::io::compression::kNone) {
+    return std::string(block);
+  }
+  size_t uncompressed_size = 0;
+  if (!port::Snappy_GetUncompressedLength(block.data(), block.size(),
+                                          &uncompressed_size)) {
+    return absl::DataLossError(
+        "Failed to get the uncompressed size of a compacted chunk block.");
+  }
+  std::string uncompressed(uncompressed_size, '\0');
+  if (!port::Snappy_Uncompress(block.data(), block.size(),
+                               uncompressed.data())) {
+    return absl::DataLossError("Failed to uncompress a compacted chunk block.");
+  }
+  return uncompressed;
+}
+
+}  // namespace
+
+CompactedChunkWriter::CompactedChunkWriter(const std::string& filename,
+                                           const std::string& compression,
+                                           tsl::Env* env, ByteSize block_size)
+    : filename_(filename),
+      compression_(compression.empty() ? tsl::io::compression::kNone
+                                       : tsl::io::compression::kSnappy),
+      env_(env),
+      block_size_(block_size) {}
+
+absl::Status CompactedChunkWriter::Initialize() {
+  tmp_filename_ = absl::StrCat(filename_, "__");
+  if (!env_->CreateUniqueFileName(&tmp_filename_, kTempFileSuffix)) {
+    return absl::InternalError(
+        absl::StrCat("Failed to write compacted chunk ", filename_,
+                     ": Unable to create temporary files."));
+  }
+  index_.set_compression(compression_);
+  return env_->NewWritableFile(tmp_filename_, &file_);
+}
+
+absl::Status CompactedChunkWriter::Write(const std::vector<Tensor>& element) {
+  if (file_ == nullptr) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Compacted chunk writer for ", filename_, " is not initialized."));
+  }
+  SnapshotRecord record;
+  for (const Tensor& tensor : element) {
+    tensor.AsProtoTensorContent(record.add_tensor());
+  }
+  std::string serialized_record;
+  if (!record.SerializeToString(&serialized_record)) {
+    return absl::InternalError(
+        absl::StrCat("Failed to serialize an element for ", filename_, "."));
+  }
+  core::PutVarint64(&block_, serialized_record.size());
+  block_.append(serialized_record);
+  ++block_num_elements_;
+  ++num_elements_;
+  if (block_.size() >= block_size_.ToUnsignedBytes()) {
+    TF_RETURN_IF_ERROR(FlushBlock());
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CompactedChunkWriter::FlushBlock() {
+  if (block_num_elements_ == 0) {
+    return absl::OkStatus();
+  }
+  std::string compressed_block;
+  absl::string_view block = block_;
+  if (compression_ != tsl::io::compression::kNone) {
+    if (!port::Snappy_Compress(block_.data(), block_.size(),
+                               &compressed_block)) {
+      return absl::InternalError(absl::StrCat(
+          "Failed to compress a compacted chunk block for ", filename_, "."));
+    }
+    block = compressed_block;
+  }
+  TF_RETURN_IF_ERROR(file_->Append(block));
+
+  CompactedChunkBlockHandle* handle = index_.add_blocks();
+  handle->set_offset(offset_);
+  handle->set_size(block.size());
+  handle->set_num_elements(block_num_elements_);
+  offset_ += block.size();
+  block_.clear();
+  block_num_elements_ = 0;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int64_t> CompactedChunkWriter::Finalize(
+    const std::vector<std::string>& source_chunks) {
+  if (file_ == nullptr) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Compacted chunk writer for ", filename_, " is not initialized."));
+  }
+  TF_RETURN_IF_ERROR(FlushBlock());
+  for (const std::string& source_chunk : source_chunks) {
+    index_.add_source_chunks(source_chunk);
+  }
+  std::string footer;
+  if (!index_.SerializeToString(&footer)) {
+    return absl::InternalError(absl::StrCat(
+        "Failed to serialize the compacted chunk index for ", filename_, "."));
+  }
+  const uint64_t index_size = footer.size();
+  core::PutFixed64(&footer, index_size);
+  core::PutFixed64(&footer, kCompactedChunkMagic);
+  TF_RETURN_IF_ERROR(file_->Append(footer));
+  TF_RETURN_IF_ERROR(file_->Close());
+  file_.reset();
+
+  absl::Status status = env_->RenameFile(tmp_filename_, filename_);
+  if (!status.ok()) {
+    return absl::InternalError(absl::StrCat(
+        "Failed to rename file: ", status.ToString(),
+        ". Source: ", tmp_filename_, ", destination: ", filename_));
+  }
+  return num_elements_;
+}
+
+CompactedChunkReader::CompactedChunkReader(const std::string& filename,
+                                           tsl::Env* env)
+    : filename_(filename), env_(env) {}
+
+absl::Status CompactedChunkReader::Initialize() {
+  uint64_t file_size = 0;
+  TF_RETURN_IF_ERROR(env_->GetFileSize(filename_, &file_size));
+  if (file_size < kFooterSize) {
+    return absl::DataLossError(absl::StrCat(
+        filename_, " is too small to be a tf.data compacted snapshot chunk."));
+  }
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(filename_, &file_));
+
+  char footer_scratch[kFooterSize];
+  absl::string_view footer;
+  TF_RETURN_IF_ERROR(file_->Read(file_size - kFooterSize, kFooterSize, &footer,
+                                 footer_scratch));
+  const uint64_t index_size = tsl::core::DecodeFixed64(footer.data());
+  if (tsl::core::DecodeFixed64(footer.data() + sizeof(uint64_t)) !=
+          kCompactedChunkMagic ||
+      index_size > file_size - kFooterSize) {
+    return absl::DataLossError(absl::StrCat(
+        filename_, " is not a valid tf.data compacted snapshot chunk."));
+  }
+
+  std::string index_scratch(index_size, '\0');
+  absl::string_view serialized_index;
+  TF_RETURN_IF_ERROR(file_->Read(file_size - kFooterSize - index_size,
+                                 index_size, &serialized_index,
+                                 index_scratch.data()));
+  if (!index_.ParseFromArray(serialized_index.data(),
+                             serialized_index.size())) {
+    return absl::DataLossError(absl::StrCat(
+        "Failed to parse the index of compacted snapshot chunk ", filename_,
+        "."));
+  }
+  block_start_elements_.reserve(index_.blocks_size() + 1);
+  for (const CompactedChunkBlockHandle& block : index_.blocks()) {
+    block_start_elements_.push_back(block_start_elements_.back() +
+                                    block.num_elements());
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::pair<int64_t, int64_t>> CompactedChunkReader::Locate(
+    int64_t element_index) const {
+  if (element_index < 0 || element_index >= num_elements()) {
+    return absl::OutOfRangeError(absl::StrCat(
+        "Element ", element_index, " is out of range for compacted chunk ",
+        filename_, " with ", num_elements(), " elements."));
+  }
+  auto it = std::upper_bound(block_start_elements_.begin(),
+                             block_start_elements_.end(), element_index);
+  const int64_t block_index = (it - block_start_elements_.begin()) - 1;
+  return std::make_pair(block_index,
+                        element_index - block_start_elements_[block_index]);
+}
+
+absl::StatusOr<std::vector<std::vector<Tensor>>>
+CompactedChunkReader::ReadBlock(int64_t block_index) const {
+  if (block_index < 0 || block_index >= num_blocks()) {
+    return absl::OutOfRangeError(
+        absl::StrCat("Block ", block_index, " is out of range for compacted ",
+                     "chunk ", filename_, " with ", num_blocks(), " blocks."));
+  }
+  const CompactedChunkBlockHandle& handle = index_.blocks(block_index);
+  std::string scratch(handle.size(), '\0');
+  absl::string_view compressed_block;
+  TF_RETURN_IF_ERROR(file_->Read(handle.offset(), handle.size(),
+                                 &compressed_block, scratch.data()));
+  TF_ASSIGN_OR_RETURN(std::string block,
+                      UncompressBlock(compressed_block, index_.compression()));
+
+  std::vector<std::vector<Tensor>> elements;
+  elements.reserve(handle.num_elements());
+  absl::string_view input = block;
+  for (int64_t i = 0; i < handle.num_elements(); ++i) {
+    uint64_t record_size = 0;
+    if (!core::GetVarint64(&input, &record_size) ||
+        record_size > input.size()) {
+      return absl::DataLossError(absl::StrCat(
+          "Corrupted block ", block_index, " in compacted chunk ", filename_));
+    }
+    SnapshotRecord record;
+    if (!record.ParseFromArray(input.data(), record_size)) {
+      return absl::DataLossError(
+          absl::StrCat("Failed to parse element ", i, " of block ",
+                       block_index, " in compacted chunk ", filename_));
+    }
+    input.remove_prefix(record_size);
+
+    std::vector<Tensor>& element = elements.emplace_back();
+    element.reserve(record.tensor_size());
+    for (const TensorProto& tensor_proto : record.tensor()) {
+      Tensor& tensor = element.emplace_back();
+      if (!tensor.FromProto(tensor_proto)) {
+        return absl::DataLossError(
+            absl::StrCat("Failed to parse a tensor of block ", block_index,
+                         " in compacted chunk ", filename_));
+      }
+    }
+  }
+  return elements;
+}
+
+CompactedChunkIterator::CompactedChunkIterator(
+    std::unique_ptr<CompactedChunkReader> reader, tsl::Env* env,
+    int64_t num_parallel_blocks)
+    : reader_(std::move(reader)),
+      num_parallel_blocks_(std::max<int64_t>(num_parallel_blocks, 1)) {
+  thread_pool_ = std::make_unique<tsl::thread::ThreadPool>(
+      env, tsl::ThreadOptions{}, "read_compacted_chunk_thread",
+      num_parallel_blocks_);
+}
+
+CompactedChunkIterator::~CompactedChunkIterator() { CancelPrefetchedBlocks(); }
+
+void CompactedChunkIterator::ScheduleBlocks() {
+  while (next_block_to_schedule_ < reader_->num_blocks() &&
+         static_cast<int64_t>(prefetched_blocks_.size()) <
+             num_parallel_blocks_) {
+    auto block = std::make_shared<PrefetchedBlock>();
+    thread_pool_->Schedule(
+        [this, block, block_index = next_block_to_schedule_]() {
+          block->elements = reader_->ReadBlock(block_index);
+          block->decoded.Notify();
+        });
+    prefetched_blocks_.push_back(std::move(block));
+    ++next_block_to_schedule_;
+  }
+}
+
+void CompactedChunkIterator::CancelPrefetchedBlocks() {
+  for (const std::shared_ptr<PrefetchedBlock>& block : prefetched_blocks_) {
+    block->decoded.WaitForNotification();
+  }
+  prefetched_blocks_.clear();
+}
+
+absl::Status CompactedChunkIterator::Seek(int64_t element_index) {
+  std::pair<int64_t, int64_t> location = {reader_->num_blocks(), 0};
+  if (element_index != reader_->num_elements()) {
+    TF_ASSIGN_OR_RETURN(location, reader_->Locate(element_index));
+  }
+  CancelPrefetchedBlocks();
+  current_block_.clear();
+  next_element_in_current_block_ = 0;
+  next_block_to_schedule_ = location.first;
+  num_elements_to_skip_ = location.second;
+  return absl::OkStatus();
+}
+
+absl::Status CompactedChunkIterator::GetNext(std::vector<Tensor>& element,
+                                             bool& end_of_sequence) {
+  while (next_element_in_current_block_ >= current_block_.size()) {
+    ScheduleBlocks();
+    if (prefetched_blocks_.empty()) {
+      end_of_sequence = true;
+      return absl::OkStatus();
+    }
+    std::shared_ptr<PrefetchedBlock> block = std::move(prefetched_blocks_[0]);
+    prefetched_blocks_.pop_front();
+    block->decoded.WaitForNotification();
+    TF_RETURN_IF_ERROR(block->elements.status());
+    current_block_ = *std::move(block->elements);
+    next_element_in_current_block_ = num_elements_to_skip_;
+    num_elements_to_skip_ = 0;
+  }
+  end_of_sequence = false;
+  element = std::move(current_block_[next_element_in_current_block_++]);
+  ScheduleBlocks();
+  return absl::OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,200 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COMPACTED_CHUNK_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COMPACTED_CHUNK_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/notification.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+
+constexpr ByteSize kDefaultCompactedChunkBlockSize = ByteSize::MB(16);
+
+// A compacted chunk stores the elements of many committed snapshot chunks in
+// one file, organized as following:
+//
+// [block 0][block 1]...[block n - 1][index][index size][magic]
+//
+// - Each block holds a sequence of length-prefixed `SnapshotRecord`s, one per
+//   element, and is compressed as a whole.
+// - The index is a serialized `CompactedChunkIndex` with the offset, size, and
+//   number of elements of each block.
+// - The index size and the magic number are fixed 64-bit integers.
+//
+// Since blocks are independently compressed and located through the index,
+// readers can seek to any element by decoding one block, and can decode
+// multiple blocks in parallel.
+
+// Writes elements to a compacted chunk. The file is written to a temporary
+// path and moved to `filename` when the writer is finalized, so readers never
+// observe a partially written compacted chunk. This class is not thread-safe.
+//
+// Usage example:
+//
+// CompactedChunkWriter writer(
+//     "/path/to/file", tsl::io::compression::kSnappy, Env::Default());
+// TF_RETURN_IF_ERROR(writer.Initialize());
+// for (const std::vector<Tensor>& element : elements) {
+//   TF_RETURN_IF_ERROR(writer.Write(element));
+// }
+// TF_ASSIGN_OR_RETURN(int64_t num_elements, writer.Finalize());
+class CompactedChunkWriter {
+ public:
+  // If `compression` is not empty, blocks are compressed with Snappy, which is
+  // cheap enough to decode in parallel on the read path.
+  CompactedChunkWriter(const std::string& filename,
+                       const std::string& compression, tsl::Env* env,
+                       ByteSize block_size = kDefaultCompactedChunkBlockSize);
+  virtual ~CompactedChunkWriter() = default;
+  CompactedChunkWriter(const CompactedChunkWriter&) = delete;
+  CompactedChunkWriter& operator=(const CompactedChunkWriter&) = delete;
+
+  // Creates the temporary file. Must be called before `Write`.
+  absl::Status Initialize();
+
+  // Appends `element` to the current block. Writes the block to the file if it
+  // exceeds the block size.
+  absl::Status Write(const std::vector<Tensor>& element);
+
+  // Writes the last block, the index, and the footer, and moves the file to
+  // its final path. `source_chunks` are recorded in the index for debugging.
+  // Returns the number of elements written.
+  absl::StatusOr<int64_t> Finalize(
+      const std::vector<std::string>& source_chunks = {});
+
+ private:
+  // Compresses and writes the current block to the file.
+  absl::Status FlushBlock();
+
+  const std::string filename_;
+  const std::string compression_;
+  tsl::Env* const env_;
+  const ByteSize block_size_;
+
+  std::string tmp_filename_;
+  std::unique_ptr<tsl::WritableFile> file_;
+  experimental::CompactedChunkIndex index_;
+  int64_t offset_ = 0;
+  int64_t num_elements_ = 0;
+
+  // Serialized elements of the block being built.
+  std::string block_;
+  int64_t block_num_elements_ = 0;
+};
+
+// Reads a compacted chunk. After initialization, `ReadBlock` may be called
+// concurrently from multiple threads.
+class CompactedChunkReader {
+ public:
+  CompactedChunkReader(const std::string& filename, tsl::Env* env);
+  virtual ~CompactedChunkReader() = default;
+  CompactedChunkReader(const CompactedChunkReader&) = delete;
+  CompactedChunkReader& operator=(const CompactedChunkReader&) = delete;
+
+  // Opens the file and reads its index.
+  absl::Status Initialize();
+
+  int64_t num_blocks() const { return index_.blocks_size(); }
+  int64_t num_elements() const { return block_start_elements_.back(); }
+  const experimental::CompactedChunkIndex& index() const { return index_; }
+
+  // Returns the pair {block_index, element index within the block} of the
+  // element at `element_index`. Returns OutOfRange if the chunk has fewer
+  // elements.
+  absl::StatusOr<std::pair<int64_t, int64_t>> Locate(
+      int64_t element_index) const;
+
+  // Reads and decodes the elements of the block at `block_index`.
+  absl::StatusOr<std::vector<std::vector<Tensor>>> ReadBlock(
+      int64_t block_index) const;
+
+ private:
+  const std::string filename_;
+  tsl::Env* const env_;
+
+  std::unique_ptr<tsl::RandomAccessFile> file_;
+  experimental::CompactedChunkIndex index_;
+  // `block_start_elements_[i]` is the index of the first element of block `i`.
+  // The last entry is the total number of elements.
+  std::vector<int64_t> block_start_elements_ = {0};
+};
+
+// Returns the elements of a compacted chunk in order. Keeps up to
+// `num_parallel_blocks` blocks ahead of the consumer being read and decoded on
+// a thread pool. This class is not thread-safe.
+class CompactedChunkIterator {
+ public:
+  // `reader` must be initialized.
+  CompactedChunkIterator(std::unique_ptr<CompactedChunkReader> reader,
+                         tsl::Env* env, int64_t num_parallel_blocks = 4);
+  virtual ~CompactedChunkIterator();
+  CompactedChunkIterator(const CompactedChunkIterator&) = delete;
+  CompactedChunkIterator& operator=(const CompactedChunkIterator&) = delete;
+
+  // Moves the iterator so the next call to `GetNext` returns the element at
+  // `element_index`. Only the block containing the element is decoded. Seeking
+  // to the number of elements moves the iterator to the end of the chunk.
+  absl::Status Seek(int64_t element_index);
+
+  // Returns the next element. Sets `end_of_sequence` to true after the last
+  // element.
+  absl::Status GetNext(std::vector<Tensor>& element, bool& end_of_sequence);
+
+ private:
+  struct PrefetchedBlock {
+    absl::Notification decoded;
+    absl::StatusOr<std::vector<std::vector<Tensor>>> elements;
+  };
+
+  // Schedules reads until `num_parallel_blocks_` blocks are in flight.
+  void ScheduleBlocks();
+
+  // Waits for the in-flight blocks and drops them.
+  void CancelPrefetchedBlocks();
+
+  const std::unique_ptr<CompactedChunkReader> reader_;
+  const int64_t num_parallel_blocks_;
+
+  int64_t next_block_to_schedule_ = 0;
+  std::deque<std::shared_ptr<PrefetchedBlock>> prefetched_blocks_;
+
+  std::vector<std::vector<Tensor>> current_block_;
+  size_t next_element_in_current_block_ = 0;
+  // Number of elements to skip in the next block after a `Seek`.
+  int64_t num_elements_to_skip_ = 0;
+
+  // Declared last so in-flight reads finish before the members they use are
+  // destroyed.
+  std::unique_ptr<tsl::thread::ThreadPool> thread_pool_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COMPACTED_CHUNK_H_
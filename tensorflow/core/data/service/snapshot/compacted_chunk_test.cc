@@ -0,0 +1,185 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/compacted_chunk.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/tsl/lib/io/compression.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::Gt;
+using ::testing::IsEmpty;
+using ::tsl::testing::IsOkAndHolds;
+using ::tsl::testing::StatusIs;
+
+absl::StatusOr<std::string> TestFile() {
+  std::string test_file;
+  if (!tsl::Env::Default()->LocalTempFilename(&test_file)) {
+    return absl::FailedPreconditionError("Failed to create local temp file.");
+  }
+  return test_file;
+}
+
+absl::StatusOr<std::string> WriteRange(int64_t range,
+                                       const std::string& compression,
+                                       ByteSize block_size) {
+  TF_ASSIGN_OR_RETURN(std::string filename, TestFile());
+  CompactedChunkWriter writer(filename, compression, tsl::Env::Default(),
+                              block_size);
+  TF_RETURN_IF_ERROR(writer.Initialize());
+  for (int64_t i = 0; i < range; ++i) {
+    TF_RETURN_IF_ERROR(writer.Write({Tensor{i}}));
+  }
+  TF_RETURN_IF_ERROR(writer.Finalize().status());
+  return filename;
+}
+
+absl::StatusOr<std::unique_ptr<CompactedChunkReader>> OpenReader(
+    const std::string& filename) {
+  auto reader =
+      std::make_unique<CompactedChunkReader>(filename, tsl::Env::Default());
+  TF_RETURN_IF_ERROR(reader->Initialize());
+  return reader;
+}
+
+absl::StatusOr<std::vector<int64_t>> ReadAll(CompactedChunkIterator& iterator) {
+  std::vector<int64_t> result;
+  while (true) {
+    std::vector<Tensor> element;
+    bool end_of_sequence = false;
+    TF_RETURN_IF_ERROR(iterator.GetNext(element, end_of_sequence));
+    if (end_of_sequence) {
+      return result;
+    }
+    result.push_back(element[0].scalar<int64_t>()());
+  }
+}
+
+std::vector<int64_t> Range(int64_t begin, int64_t end) {
+  std::vector<int64_t> result;
+  for (int64_t i = begin; i < end; ++i) {
+    result.push_back(i);
+  }
+  return result;
+}
+
+class CompactedChunkTest : public ::testing::TestWithParam<std::string> {
+ protected:
+  std::string Compression() const { return GetParam(); }
+};
+
+TEST_P(CompactedChunkTest, ReadAllElements) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string filename,
+      WriteRange(/*range=*/1000, Compression(), ByteSize::Bytes(256)));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompactedChunkReader> reader,
+                          OpenReader(filename));
+  EXPECT_EQ(reader->num_elements(), 1000);
+  EXPECT_THAT(reader->num_blocks(), Gt(1));
+
+  CompactedChunkIterator iterator(std::move(reader), tsl::Env::Default(),
+                                  /*num_parallel_blocks=*/3);
+  EXPECT_THAT(ReadAll(iterator),
+              IsOkAndHolds(ElementsAreArray(Range(0, 1000))));
+}
+
+TEST_P(CompactedChunkTest, Seek) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string filename,
+      WriteRange(/*range=*/1000, Compression(), ByteSize::Bytes(256)));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompactedChunkReader> reader,
+                          OpenReader(filename));
+  CompactedChunkIterator iterator(std::move(reader), tsl::Env::Default());
+
+  TF_ASSERT_OK(iterator.Seek(573));
+  EXPECT_THAT(ReadAll(iterator),
+              IsOkAndHolds(ElementsAreArray(Range(573, 1000))));
+  TF_ASSERT_OK(iterator.Seek(0));
+  EXPECT_THAT(ReadAll(iterator),
+              IsOkAndHolds(ElementsAreArray(Range(0, 1000))));
+  TF_ASSERT_OK(iterator.Seek(1000));
+  EXPECT_THAT(ReadAll(iterator), IsOkAndHolds(IsEmpty()));
+  EXPECT_THAT(iterator.Seek(1001), StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+TEST_P(CompactedChunkTest, LocateElements) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string filename,
+      WriteRange(/*range=*/100, Compression(), ByteSize::Bytes(1)));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompactedChunkReader> reader,
+                          OpenReader(filename));
+  // Each block has one element since the block size is one byte.
+  EXPECT_EQ(reader->num_blocks(), 100);
+  EXPECT_THAT(reader->Locate(42),
+              IsOkAndHolds(std::make_pair(int64_t{42}, int64_t{0})));
+  EXPECT_THAT(reader->Locate(-1), StatusIs(absl::StatusCode::kOutOfRange));
+  EXPECT_THAT(reader->Locate(100), StatusIs(absl::StatusCode::kOutOfRange));
+  EXPECT_THAT(reader->ReadBlock(100), StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+TEST_P(CompactedChunkTest, EmptyChunk) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string filename,
+      WriteRange(/*range=*/0, Compression(), kDefaultCompactedChunkBlockSize));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompactedChunkReader> reader,
+                          OpenReader(filename));
+  EXPECT_EQ(reader->num_elements(), 0);
+  CompactedChunkIterator iterator(std::move(reader), tsl::Env::Default());
+  EXPECT_THAT(ReadAll(iterator), IsOkAndHolds(IsEmpty()));
+}
+
+INSTANTIATE_TEST_SUITE_P(Compression, CompactedChunkTest,
+                         ::testing::ValuesIn<std::string>(
+                             {tsl::io::compression::kNone,
+                              tsl::io::compression::kSnappy,
+                              tsl::io::compression::kGzip}));
+
+TEST(CompactedChunkReaderTest, InvalidFile) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(tsl::WriteStringToFile(tsl::Env::Default(), filename,
+                                      "not a compacted chunk"));
+  CompactedChunkReader reader(filename, tsl::Env::Default());
+  EXPECT_THAT(reader.Initialize(), StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(CompactedChunkWriterTest, WriteBeforeInitialize) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  CompactedChunkWriter writer(filename, tsl::io::compression::kNone,
+                              tsl::Env::Default());
+  EXPECT_THAT(writer.Write({Tensor{int64_t{0}}}),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
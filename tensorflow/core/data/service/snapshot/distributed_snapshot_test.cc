@@ -16,13 +16,17 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "xla/tsl/lib/io/compression.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
+#include "tensorflow/core/data/service/snapshot/compacted_chunk.h"
+#include "tensorflow/core/data/service/snapshot/file_utils.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/snapshot/test_utils.h"
 #include "tensorflow/core/data/service/test_cluster.h"
@@ -91,6 +95,35 @@ absl::Status WaitForSnapshotComplete(const std::string& base_path) {
   return WaitForFileExists(SnapshotDoneFilePath(base_path));
 }
 
+// Reads the elements of the compacted chunks of the snapshot at `base_path`.
+absl::StatusOr<std::vector<int64_t>> ReadCompactedChunks(
+    const std::string& base_path) {
+  TF_ASSIGN_OR_RETURN(
+      std::vector<std::string> filenames,
+      GetChildren(CompactedChunksDirectory(base_path), Env::Default()));
+  std::vector<int64_t> result;
+  for (const std::string& filename : filenames) {
+    if (!ParseCompactedChunkFilename(filename).ok()) {
+      continue;
+    }
+    auto reader = std::make_unique<CompactedChunkReader>(
+        tsl::io::JoinPath(CompactedChunksDirectory(base_path), filename),
+        Env::Default());
+    TF_RETURN_IF_ERROR(reader->Initialize());
+    CompactedChunkIterator iterator(std::move(reader), Env::Default());
+    while (true) {
+      std::vector<Tensor> element;
+      bool end_of_sequence = false;
+      TF_RETURN_IF_ERROR(iterator.GetNext(element, end_of_sequence));
+      if (end_of_sequence) {
+        break;
+      }
+      result.push_back(element[0].unaligned_flat<int64_t>().data()[0]);
+    }
+  }
+  return result;
+}
+
 class DistributedSnapshotTest : public ::testing::TestWithParam<int64_t> {
  protected:
   int64_t NumWorkers() const { return GetParam(); }
@@ -174,6 +207,20 @@ TEST_P(DistributedSnapshotTest, EmptyDataset) {
               IsOkAndHolds(IsEmpty()));
 }
 
+TEST_P(DistributedSnapshotTest, CompactChunks) {
+  TestSnapshotCluster data_service(NumWorkers());
+  DatasetDef dataset = RangeDataset(10);
+  experimental::DistributedSnapshotMetadata metadata =
+      CreateDummyDistributedSnapshotMetadata();
+  metadata.set_compact_chunks(true);
+  std::string snapshot_path = LocalTempFilename();
+  TF_ASSERT_OK(
+      data_service.dispatcher().Snapshot(dataset, snapshot_path, metadata));
+  TF_ASSERT_OK(WaitForFileExists(CompactionDoneFilePath(snapshot_path)));
+  EXPECT_THAT(ReadCompactedChunks(snapshot_path),
+              IsOkAndHolds(UnorderedElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9)));
+}
+
 INSTANTIATE_TEST_SUITE_P(NumWorkers, DistributedSnapshotTest,
                          ::testing::Values(1, 5));
 
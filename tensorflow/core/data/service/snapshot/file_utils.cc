@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -143,6 +144,16 @@ int64_t SnapshotChunksCardinality(absl::string_view snapshot_path,
   if (!env->FileExists(SnapshotDoneFilePath(snapshot_path)).ok()) {
     return kUnknownCardinality;
   }
+  if (env->FileExists(CompactionDoneFilePath(snapshot_path)).ok()) {
+    absl::StatusOr<std::vector<std::string>> filenames =
+        GetChildren(CompactedChunksDirectory(snapshot_path), env);
+    if (!filenames.ok()) {
+      return kUnknownCardinality;
+    }
+    return absl::c_count_if(*filenames, [](const std::string& filename) {
+      return ParseCompactedChunkFilename(filename).ok();
+    });
+  }
   absl::StatusOr<std::vector<std::string>> chunks =
       GetChildren(CommittedChunksDirectory(snapshot_path), env);
   if (!chunks.ok()) {
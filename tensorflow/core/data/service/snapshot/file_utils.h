@@ -63,6 +63,7 @@ absl::StatusOr<std::vector<std::string>> GetChildren(
 bool IsTemporaryFile(absl::string_view filename);
 
 // Returns the total number of chunks for a distributed snapshot:
+// - If the snapshot is compacted, returns the number of compacted chunks.
 // - If the snapshot is finished, returns the number of committed chunks.
 // - If the snapshot is unfinished or has failed, returns kUnknownCardinality.
 int64_t SnapshotChunksCardinality(absl::string_view snapshot_path,
@@ -43,6 +43,7 @@ constexpr const char kSplitsDirectoryName[] = "splits";
 constexpr const char kCheckpointsDirectoryName[] = "checkpoints";
 constexpr const char kCommittedChunksDirectoryName[] = "chunks";
 constexpr const char kUncommittedChunksDirectoryName[] = "uncommitted_chunks";
+constexpr const char kCompactedChunksDirectoryName[] = "compacted_chunks";
 constexpr int64_t kUnknownNumElements = -1;
 
 }  // namespace
@@ -183,6 +184,21 @@ absl::StatusOr<std::tuple<int64_t, int64_t, int64_t>> ParseChunkFilename(
   return std::make_tuple(stream_index, stream_chunk_index, chunk_num_elements);
 }
 
+absl::StatusOr<int64_t> ParseCompactedChunkFilename(
+    absl::string_view compacted_chunk_filename) {
+  std::vector<std::string> tokens =
+      absl::StrSplit(compacted_chunk_filename, '_');
+  int64_t compacted_chunk_index = 0;
+  if (tokens.size() != 3 || tokens[0] != "compacted" || tokens[1] != "chunk" ||
+      !absl::SimpleAtoi(tokens[2], &compacted_chunk_index) ||
+      compacted_chunk_index < 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Invalid compacted chunk file name: ", compacted_chunk_filename,
+        ". Expected compacted_chunk_<compacted_chunk_index>."));
+  }
+  return compacted_chunk_index;
+}
+
 std::string SnapshotMetadataFilePath(absl::string_view snapshot_path_) {
   return tsl::io::JoinPath(snapshot_path_, kSnapshotMetadataFileName);
 }
@@ -233,5 +249,21 @@ std::string UncommittedChunksDirectory(absl::string_view snapshot_path,
   return tsl::io::JoinPath(StreamDirectory(snapshot_path, stream_index),
                            kUncommittedChunksDirectoryName);
 }
+
+std::string CompactedChunksDirectory(absl::string_view snapshot_path) {
+  return tsl::io::JoinPath(snapshot_path, kCompactedChunksDirectoryName);
+}
+
+std::string CompactedChunkFilePath(absl::string_view snapshot_path,
+                                   int64_t compacted_chunk_index) {
+  return tsl::io::JoinPath(CompactedChunksDirectory(snapshot_path),
+                           absl::StrCat("compacted_chunk_",
+                                        compacted_chunk_index));
+}
+
+std::string CompactionDoneFilePath(absl::string_view snapshot_path) {
+  return tsl::io::JoinPath(CompactedChunksDirectory(snapshot_path),
+                           kDoneFileName);
+}
 }  // namespace data
 }  // namespace tensorflow
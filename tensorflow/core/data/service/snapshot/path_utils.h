@@ -90,6 +90,11 @@ absl::StatusOr<std::pair<int64_t, int64_t>> ParseCheckpointFilename(
 absl::StatusOr<std::tuple<int64_t, int64_t, int64_t>> ParseChunkFilename(
     absl::string_view chunk_filename);
 
+// Returns the index of the compacted chunk. The expected format of
+// `compacted_chunk_filename` is: compacted_chunk_<compacted_chunk_index>
+absl::StatusOr<int64_t> ParseCompactedChunkFilename(
+    absl::string_view compacted_chunk_filename);
+
 // Returns the path of the DONE file of a snapshot stream.
 std::string StreamDoneFilePath(absl::string_view snapshot_path,
                                int64_t stream_index);
@@ -128,6 +133,17 @@ std::string CommittedChunksDirectory(absl::string_view snapshot_path);
 std::string UncommittedChunksDirectory(absl::string_view snapshot_path,
                                        int64_t stream_index);
 
+// Returns the directory path for compacted chunks.
+std::string CompactedChunksDirectory(absl::string_view snapshot_path);
+
+// Returns the path of the compacted chunk with `compacted_chunk_index`.
+std::string CompactedChunkFilePath(absl::string_view snapshot_path,
+                                   int64_t compacted_chunk_index);
+
+// Returns the path of the DONE file written after the committed chunks of a
+// snapshot have been compacted.
+std::string CompactionDoneFilePath(absl::string_view snapshot_path);
+
 }  // namespace data
 }  // namespace tensorflow
 
@@ -260,6 +260,48 @@ TEST(PathUtilsTest, UncommittedChunksDirectory) {
       MatchesRegex("/path/to/snapshot.streams.stream_0.uncommitted_chunks"));
 }
 
+TEST(PathUtilsTest, CompactedChunksDirectory) {
+  EXPECT_THAT(CompactedChunksDirectory("/path/to/snapshot"),
+              MatchesRegex("/path/to/snapshot.compacted_chunks"));
+}
+
+TEST(PathUtilsTest, CompactedChunkFilePath) {
+  EXPECT_THAT(
+      CompactedChunkFilePath("/path/to/snapshot", /*compacted_chunk_index=*/2),
+      MatchesRegex("/path/to/snapshot.compacted_chunks.compacted_chunk_2"));
+}
+
+TEST(PathUtilsTest, ParseCompactedChunkFilename) {
+  EXPECT_THAT(ParseCompactedChunkFilename("compacted_chunk_0"),
+              IsOkAndHolds(0));
+  EXPECT_THAT(ParseCompactedChunkFilename("compacted_chunk_12"),
+              IsOkAndHolds(12));
+}
+
+TEST(PathUtilsTest, InvalidCompactedChunkFilename) {
+  EXPECT_THAT(ParseCompactedChunkFilename(""),
+              StatusIs(error::INVALID_ARGUMENT,
+                       HasSubstr("Expected compacted_chunk_<compacted_chunk_"
+                                 "index>")));
+  EXPECT_THAT(ParseCompactedChunkFilename("compacted_chunk_1__1234.tmp"),
+              StatusIs(error::INVALID_ARGUMENT,
+                       HasSubstr("Expected compacted_chunk_<compacted_chunk_"
+                                 "index>")));
+  EXPECT_THAT(ParseCompactedChunkFilename("compacted_chunk_-1"),
+              StatusIs(error::INVALID_ARGUMENT,
+                       HasSubstr("Expected compacted_chunk_<compacted_chunk_"
+                                 "index>")));
+  EXPECT_THAT(ParseCompactedChunkFilename("chunk_0_1_2"),
+              StatusIs(error::INVALID_ARGUMENT,
+                       HasSubstr("Expected compacted_chunk_<compacted_chunk_"
+                                 "index>")));
+}
+
+TEST(PathUtilsTest, CompactionDoneFilePath) {
+  EXPECT_THAT(CompactionDoneFilePath("/path/to/snapshot"),
+              MatchesRegex("/path/to/snapshot.compacted_chunks.DONE"));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -21,6 +21,8 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/service/snapshot/compacted_chunk.h"
+#include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -52,7 +54,15 @@ absl::string_view GetSnapshotPath(absl::string_view chunk_file) {
   return tsl::io::Dirname(chunk_dir);
 }
 
+// Returns true if `chunk_file` is a compacted chunk written by
+// `CompactSnapshotChunks`.
+bool IsCompactedChunk(absl::string_view chunk_file) {
+  return ParseCompactedChunkFilename(tsl::io::Basename(chunk_file)).ok();
+}
+
 // A reader dataset is responsible for reading one chunk file of a snapshot.
+// Compacted chunks are read through a `CompactedChunkIterator`, which decodes
+// blocks in parallel and restores from checkpoints by seeking.
 // TODO(b/250921378): Merge this with `snapshot_util::Reader::Dataset`.
 class SnapshotChunkDatasetOp : public DatasetOpKernel {
  public:
@@ -128,6 +138,14 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     ~Iterator() override { RecordBytesRead(); }
 
     absl::Status Initialize(IteratorContext* ctx) override {
+      if (IsCompactedChunk(dataset()->chunk_file_)) {
+        auto reader = std::make_unique<CompactedChunkReader>(
+            TranslateFileName(dataset()->chunk_file_), ctx->env());
+        TF_RETURN_IF_ERROR(reader->Initialize());
+        compacted_chunk_iterator_ = std::make_unique<CompactedChunkIterator>(
+            std::move(reader), ctx->env());
+        return absl::OkStatus();
+      }
       reader_ = std::make_unique<snapshot_util::TFRecordReader>(
           TranslateFileName(dataset()->chunk_file_), dataset()->compression_,
           dataset()->dtypes_, kTFRecordReaderOutputBufferSize);
@@ -139,6 +157,15 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
                                  std::vector<Tensor>* out_tensors,
                                  bool* end_of_sequence) override {
       *end_of_sequence = false;
+      if (compacted_chunk_iterator_ != nullptr) {
+        TF_RETURN_WITH_CONTEXT_IF_ERROR(
+            compacted_chunk_iterator_->GetNext(*out_tensors, *end_of_sequence),
+            " Failed to read tf.data snapshot file: ", dataset()->chunk_file_);
+        if (!*end_of_sequence) {
+          ++start_index_;
+        }
+        return absl::OkStatus();
+      }
       absl::Status status = reader_->ReadTensors(out_tensors);
       if (absl::IsOutOfRange(status)) {
         *end_of_sequence = true;
@@ -171,6 +198,9 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     // may consider switching the data format to ArrayRecords so we can use the
     // index to jump straight to the starting record.
     absl::Status AdvanceToStartIndex(IteratorContext* ctx) {
+      if (compacted_chunk_iterator_ != nullptr) {
+        return compacted_chunk_iterator_->Seek(start_index_);
+      }
       for (int64_t i = 0; i < start_index_; ++i) {
         std::vector<Tensor> unused;
         TF_RETURN_IF_ERROR(reader_->ReadTensors(&unused));
@@ -179,12 +209,16 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     }
 
     void RecordBytesRead() {
+      if (reader_ == nullptr) {
+        return;
+      }
       uint64_t bytes_read = reader_->BytesRead();
       metrics::GetTFDataBytesReadCounter(kSnapshotChunkDataset)
           ->IncrementBy(bytes_read);
     }
 
     std::unique_ptr<snapshot_util::TFRecordReader> reader_;
+    std::unique_ptr<CompactedChunkIterator> compacted_chunk_iterator_;
     int64_t start_index_ = 0;
   };
 
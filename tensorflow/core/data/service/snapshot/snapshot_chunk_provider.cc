@@ -61,10 +61,6 @@ Tensor ConvertToTensor(absl::string_view s) {
   return tensor;
 }
 
-std::string AbsPath(absl::string_view snapshot_path, absl::string_view chunk) {
-  return tsl::io::JoinPath(CommittedChunksDirectory(snapshot_path), chunk);
-}
-
 // Waits for a short period of time before retrying.
 void Backoff(int num_retries, tsl::Env* env) {
   if (num_retries >= 1) {  // Does not backoff for the first try.
@@ -89,7 +85,7 @@ absl::Status SnapshotChunkProvider::GetNext(Tensor* split, bool* end_of_splits)
       std::string next_chunk = *chunks_unread_.begin();
       chunks_read_.insert(next_chunk);
       chunks_unread_.erase(next_chunk);
-      *split = ConvertToTensor(AbsPath(snapshot_path_, next_chunk));
+      *split = ConvertToTensor(AbsPath(next_chunk));
       *end_of_splits = false;
       return absl::OkStatus();
     }
@@ -108,6 +104,15 @@ absl::Status SnapshotChunkProvider::UpdateSnapshot()
   // we may see the DONE file but miss those final chunks.
   TF_ASSIGN_OR_RETURN(snapshot_state_, GetSnapshotState());
   TF_RETURN_IF_ERROR(snapshot_state_.status);
+  if (chunks_read_.empty()) {
+    const bool read_compacted_chunks =
+        snapshot_state_.snapshot_is_done &&
+        env_->FileExists(CompactionDoneFilePath(snapshot_path_)).ok();
+    if (read_compacted_chunks != read_compacted_chunks_) {
+      chunks_unread_.clear();
+      read_compacted_chunks_ = read_compacted_chunks;
+    }
+  }
   TF_ASSIGN_OR_RETURN(std::vector<std::string> chunks, GetAvailableChunks());
   for (const std::string& chunk : chunks) {
     if (!chunks_read_.contains(chunk)) {
@@ -137,6 +142,19 @@ SnapshotChunkProvider::GetSnapshotState() {
 
 absl::StatusOr<std::vector<std::string>>
 SnapshotChunkProvider::GetAvailableChunks() {
+  if (read_compacted_chunks_) {
+    TF_ASSIGN_OR_RETURN(
+        std::vector<std::string> filenames,
+        GetChildren(CompactedChunksDirectory(snapshot_path_), env_));
+    // Skips the DONE file and temporary files of failed compactions.
+    std::vector<std::string> compacted_chunks;
+    for (std::string& filename : filenames) {
+      if (ParseCompactedChunkFilename(filename).ok()) {
+        compacted_chunks.push_back(std::move(filename));
+      }
+    }
+    return compacted_chunks;
+  }
   absl::StatusOr<std::vector<std::string>> status_or_chunks =
       GetChildren(CommittedChunksDirectory(snapshot_path_), env_);
   if (status_or_chunks.ok()) {
@@ -147,6 +165,13 @@ SnapshotChunkProvider::GetAvailableChunks() {
   return status_or_chunks.status();
 }
 
+std::string SnapshotChunkProvider::AbsPath(absl::string_view chunk) const {
+  if (read_compacted_chunks_) {
+    return tsl::io::JoinPath(CompactedChunksDirectory(snapshot_path_), chunk);
+  }
+  return tsl::io::JoinPath(CommittedChunksDirectory(snapshot_path_), chunk);
+}
+
 absl::Status SnapshotChunkProvider::Reset() {
   absl::MutexLock l(&mu_);
   chunks_read_.clear();
@@ -170,6 +195,10 @@ absl::Status SnapshotChunkProvider::Restore(
   tsl::tstring chunks_read;
   TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kChunksRead), &chunks_read));
   chunks_read_ = SetFromString(chunks_read);
+  chunks_unread_.clear();
+  read_compacted_chunks_ =
+      !chunks_read_.empty() &&
+      ParseCompactedChunkFilename(*chunks_read_.begin()).ok();
   return UpdateSnapshot();
 }
 
@@ -203,6 +232,13 @@ SnapshotChunkProvider::OrderedChunkSet SnapshotChunkProvider::SetFromString(
 
 bool SnapshotChunkProvider::ChunkOrder::operator()(
     const std::string& chunk1, const std::string& chunk2) const {
+  absl::StatusOr<int64_t> compacted_chunk_index1 =
+      ParseCompactedChunkFilename(chunk1);
+  absl::StatusOr<int64_t> compacted_chunk_index2 =
+      ParseCompactedChunkFilename(chunk2);
+  if (compacted_chunk_index1.ok() && compacted_chunk_index2.ok()) {
+    return *compacted_chunk_index1 < *compacted_chunk_index2;
+  }
   absl::StatusOr<std::tuple<int64_t, int64_t, int64_t>> tokens1 =
       ParseChunkFilename(chunk1);
   absl::StatusOr<std::tuple<int64_t, int64_t, int64_t>> tokens2 =
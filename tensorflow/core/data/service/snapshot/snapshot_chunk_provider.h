@@ -36,7 +36,9 @@ namespace tensorflow {
 namespace data {
 
 // Provides the next chunk to read. Blocks until the next chunk is unavailable,
-// or all the chunks have been read. This class is thread-safe.
+// or all the chunks have been read. If the snapshot has been compacted before
+// any chunk is read, provides the compacted chunks instead of the committed
+// chunks. This class is thread-safe.
 class SnapshotChunkProvider : public SplitProvider {
  public:
   SnapshotChunkProvider(absl::string_view snapshot_path, tsl::Env* env);
@@ -57,8 +59,9 @@ class SnapshotChunkProvider : public SplitProvider {
   absl::Status Restore(std::function<std::string(std::string)> full_name,
                        IteratorStateReader* reader) override;
 
-  // If the snapshot is finished, returns the number of committed chunks.
-  // If the snapshot is unfinished or has failed, returns kUnknownCardinality.
+  // If the snapshot is finished, returns the number of compacted chunks if it
+  // has been compacted, or the number of committed chunks otherwise. If the
+  // snapshot is unfinished or has failed, returns kUnknownCardinality.
   int64_t Cardinality() const override;
 
   // Cancels the provider. After cancelling, if the snapshot is unfinished,
@@ -81,7 +84,8 @@ class SnapshotChunkProvider : public SplitProvider {
   };
 
   // Used to sort chunks by chunk indexes so that chunks are read evenly across
-  // streams and chunks of early repetitions are read first.
+  // streams and chunks of early repetitions are read first. Compacted chunks
+  // are sorted by their indexes.
   struct ChunkOrder {
     bool operator()(const std::string& chunk1, const std::string& chunk2) const;
   };
@@ -100,7 +104,12 @@ class SnapshotChunkProvider : public SplitProvider {
 
   // Reads the available chunks from disk and returns a vector of chunk file
   // names.
-  absl::StatusOr<std::vector<std::string>> GetAvailableChunks();
+  absl::StatusOr<std::vector<std::string>> GetAvailableChunks()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the absolute path of `chunk`.
+  std::string AbsPath(absl::string_view chunk) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   const std::string snapshot_path_;
   tsl::Env* const env_;
@@ -116,6 +125,11 @@ class SnapshotChunkProvider : public SplitProvider {
 
   // State of the snapshot.
   SnapshotState snapshot_state_ ABSL_GUARDED_BY(mu_);
+
+  // True if the compacted chunks are read instead of the committed chunks.
+  // Decided when the first chunk is read, so all chunks of an iteration come
+  // from the same set.
+  bool read_compacted_chunks_ ABSL_GUARDED_BY(mu_) = false;
 };
 
 }  // namespace data
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/snapshot/snapshot_chunk_provider.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -72,6 +73,20 @@ absl::Status WriteChunk(absl::string_view snapshot_path,
       "", tsl::Env::Default());
 }
 
+// Writes `num_compacted_chunks` empty compacted chunks and marks the
+// compaction as done.
+absl::Status WriteCompactedChunks(absl::string_view snapshot_path,
+                                  int64_t num_compacted_chunks) {
+  TF_RETURN_IF_ERROR(tsl::Env::Default()->RecursivelyCreateDir(
+      CompactedChunksDirectory(snapshot_path)));
+  for (int64_t i = 0; i < num_compacted_chunks; ++i) {
+    TF_RETURN_IF_ERROR(AtomicallyWriteStringToFile(
+        CompactedChunkFilePath(snapshot_path, i), "", tsl::Env::Default()));
+  }
+  return AtomicallyWriteStringToFile(CompactionDoneFilePath(snapshot_path), "",
+                                     tsl::Env::Default());
+}
+
 absl::Status SetDone(absl::string_view snapshot_path) {
   return AtomicallyWriteStringToFile(SnapshotDoneFilePath(snapshot_path), "",
                                      tsl::Env::Default());
@@ -183,6 +198,68 @@ TEST(SnapshotChunkProviderTest, Cardinality) {
   EXPECT_EQ(snapshot_chunk_provider.Cardinality(), 5);
 }
 
+TEST(SnapshotChunkProviderTest, ReadCompactedChunks) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  TF_ASSERT_OK(WriteChunk(snapshot_path, "chunk_0_0_0"));
+  TF_ASSERT_OK(SetDone(snapshot_path));
+  TF_ASSERT_OK(
+      WriteCompactedChunks(snapshot_path, /*num_compacted_chunks=*/12));
+  // Temporary file left by a failed compaction.
+  TF_ASSERT_OK(AtomicallyWriteStringToFile(
+      absl::StrCat(CompactedChunkFilePath(snapshot_path, 12), "__1234.tmp"), "",
+      tsl::Env::Default()));
+
+  SnapshotChunkProvider snapshot_chunk_provider(snapshot_path,
+                                                tsl::Env::Default());
+  EXPECT_EQ(snapshot_chunk_provider.Cardinality(), 12);
+  // Compacted chunks are ordered by their indexes.
+  std::vector<std::string> compacted_chunks;
+  for (int64_t i = 0; i < 12; ++i) {
+    compacted_chunks.push_back(CompactedChunkFilePath(snapshot_path, i));
+  }
+  EXPECT_THAT(GetAllChunks(snapshot_chunk_provider),
+              IsOkAndHolds(ElementsAreArray(compacted_chunks)));
+}
+
+TEST(SnapshotChunkProviderTest, SaveRestoreCompactedChunks) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  TF_ASSERT_OK(WriteChunk(snapshot_path, "chunk_0_0_0"));
+  TF_ASSERT_OK(SetDone(snapshot_path));
+  TF_ASSERT_OK(WriteCompactedChunks(snapshot_path, /*num_compacted_chunks=*/3));
+
+  SnapshotChunkProvider snapshot_chunk_provider(snapshot_path,
+                                                tsl::Env::Default());
+  EXPECT_THAT(GetChunk(snapshot_chunk_provider),
+              IsOkAndHolds(CompactedChunkFilePath(snapshot_path, 0)));
+  TF_ASSERT_OK(SaveAndRestore(snapshot_chunk_provider));
+  EXPECT_THAT(GetAllChunks(snapshot_chunk_provider),
+              IsOkAndHolds(ElementsAreArray(
+                  {CompactedChunkFilePath(snapshot_path, 1),
+                   CompactedChunkFilePath(snapshot_path, 2)})));
+}
+
+TEST(SnapshotChunkProviderTest, CompactionFinishesWhileReading) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  std::vector<std::string> chunks = {"chunk_0_0_0", "chunk_1_1_1",
+                                     "chunk_2_2_2"};
+  for (absl::string_view chunk : chunks) {
+    TF_ASSERT_OK(WriteChunk(snapshot_path, chunk));
+  }
+  TF_ASSERT_OK(SetDone(snapshot_path));
+
+  SnapshotChunkProvider snapshot_chunk_provider(snapshot_path,
+                                                tsl::Env::Default());
+  EXPECT_THAT(GetChunk(snapshot_chunk_provider),
+              IsOkAndHolds(tsl::io::JoinPath(
+                  CommittedChunksDirectory(snapshot_path), "chunk_0_0_0")));
+  // Chunks already being read from the committed chunks keep coming from there.
+  TF_ASSERT_OK(WriteCompactedChunks(snapshot_path, /*num_compacted_chunks=*/1));
+  TF_ASSERT_OK(SaveAndRestore(snapshot_chunk_provider));
+  EXPECT_THAT(GetAllChunks(snapshot_chunk_provider),
+              IsOkAndHolds(ElementsAreArray(
+                  JoinPaths(snapshot_path, {"chunk_1_1_1", "chunk_2_2_2"}))));
+}
+
 TEST(SnapshotChunkProviderTest, WaitForSnapshot) {
   std::string snapshot_path;
   ASSERT_TRUE(tsl::Env::Default()->LocalTempFilename(&snapshot_path));
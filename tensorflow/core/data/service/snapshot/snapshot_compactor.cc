@@ -0,0 +1,297 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/snapshot_compactor.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/service/snapshot/compacted_chunk.h"
+#include "tensorflow/core/data/service/snapshot/file_utils.h"
+#include "tensorflow/core/data/service/snapshot/path_utils.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr const char kTempFileSuffix[] = ".tmp";
+
+struct CommittedChunk {
+  std::string filename;
+  int64_t stream_index = 0;
+  int64_t chunk_index = 0;
+  int64_t num_elements = 0;
+  ByteSize size;
+};
+
+absl::Status CheckCancelled(const SnapshotCompactionParams& params) {
+  if (params.is_cancelled && params.is_cancelled()) {
+    return absl::CancelledError(absl::StrCat(
+        "Cancelled compacting tf.data snapshot ", params.snapshot_path, "."));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<CommittedChunk>> ListCommittedChunks(
+    const SnapshotCompactionParams& params) {
+  const std::string chunks_directory =
+      CommittedChunksDirectory(params.snapshot_path);
+  TF_ASSIGN_OR_RETURN(std::vector<std::string> filenames,
+                      GetChildren(chunks_directory, params.env));
+  std::vector<CommittedChunk> chunks;
+  chunks.reserve(filenames.size());
+  for (std::string& filename : filenames) {
+    TF_ASSIGN_OR_RETURN(auto chunk_info, ParseChunkFilename(filename));
+    uint64_t file_size = 0;
+    TF_RETURN_IF_ERROR(params.env->GetFileSize(
+        tsl::io::JoinPath(chunks_directory, filename), &file_size));
+    chunks.push_back(CommittedChunk{
+        std::move(filename), std::get<0>(chunk_info), std::get<1>(chunk_info),
+        std::get<2>(chunk_info), ByteSize::Bytes(file_size)});
+  }
+  std::sort(chunks.begin(), chunks.end(),
+            [](const CommittedChunk& chunk1, const CommittedChunk& chunk2) {
+              return std::tie(chunk1.stream_index, chunk1.chunk_index) <
+                     std::tie(chunk2.stream_index, chunk2.chunk_index);
+            });
+  return chunks;
+}
+
+// Returns the number of tensors in each element. Committed chunks store one
+// record per tensor, so this is the number of records of a non-empty chunk
+// divided by its number of elements. Returns 0 if all chunks are empty.
+absl::StatusOr<int64_t> GetNumComponents(
+    const SnapshotCompactionParams& params,
+    const std::vector<CommittedChunk>& chunks) {
+  for (const CommittedChunk& chunk : chunks) {
+    if (chunk.num_elements < 0) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "Cannot compact tf.data snapshot chunk ", chunk.filename,
+          " with an unknown number of elements."));
+    }
+    if (chunk.num_elements == 0) {
+      continue;
+    }
+    snapshot_util::TFRecordReaderImpl reader(
+        tsl::io::JoinPath(CommittedChunksDirectory(params.snapshot_path),
+                          chunk.filename),
+        params.compression);
+    TF_RETURN_IF_ERROR(reader.Initialize(params.env));
+    TF_ASSIGN_OR_RETURN(std::vector<Tensor> tensors, reader.GetTensors());
+    const int64_t num_tensors = tensors.size();
+    if (num_tensors == 0 || num_tensors % chunk.num_elements != 0) {
+      return absl::DataLossError(absl::StrCat(
+          "tf.data snapshot chunk ", chunk.filename, " has ", num_tensors,
+          " tensors, which is not a multiple of its ", chunk.num_elements,
+          " elements."));
+    }
+    return num_tensors / chunk.num_elements;
+  }
+  return 0;
+}
+
+// Deletes the temporary files of compacted chunks whose writing did not finish.
+absl::Status DeleteTemporaryFiles(const SnapshotCompactionParams& params) {
+  const std::string compacted_chunks_directory =
+      CompactedChunksDirectory(params.snapshot_path);
+  TF_ASSIGN_OR_RETURN(std::vector<std::string> filenames,
+                      GetChildren(compacted_chunks_directory, params.env));
+  for (const std::string& filename : filenames) {
+    if (absl::EndsWith(filename, kTempFileSuffix)) {
+      TF_RETURN_IF_ERROR(params.env->DeleteFile(
+          tsl::io::JoinPath(compacted_chunks_directory, filename)));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Groups consecutive chunks so each group is about `target_file_size`.
+std::vector<std::vector<CommittedChunk>> GroupChunks(
+    std::vector<CommittedChunk> chunks, ByteSize target_file_size) {
+  std::vector<std::vector<CommittedChunk>> groups;
+  ByteSize group_size;
+  for (CommittedChunk& chunk : chunks) {
+    if (groups.empty() || group_size >= target_file_size) {
+      groups.emplace_back();
+      group_size = ByteSize::Bytes(0);
+    }
+    group_size += chunk.size;
+    groups.back().push_back(std::move(chunk));
+  }
+  return groups;
+}
+
+absl::Status WriteCompactedChunk(const SnapshotCompactionParams& params,
+                                 int64_t num_components,
+                                 const std::vector<CommittedChunk>& chunks,
+                                 const std::string& filename) {
+  CompactedChunkWriter writer(filename, params.compression, params.env,
+                              params.block_size);
+  TF_RETURN_IF_ERROR(writer.Initialize());
+  std::vector<std::string> source_chunks;
+  source_chunks.reserve(chunks.size());
+  for (const CommittedChunk& chunk : chunks) {
+    TF_RETURN_IF_ERROR(CheckCancelled(params));
+    snapshot_util::TFRecordReaderImpl reader(
+        tsl::io::JoinPath(CommittedChunksDirectory(params.snapshot_path),
+                          chunk.filename),
+        params.compression);
+    TF_RETURN_IF_ERROR(reader.Initialize(params.env));
+    for (int64_t i = 0; i < chunk.num_elements; ++i) {
+      std::vector<Tensor> element;
+      element.reserve(num_components);
+      for (int64_t j = 0; j < num_components; ++j) {
+        TF_ASSIGN_OR_RETURN(Tensor tensor, reader.GetNext());
+        element.push_back(std::move(tensor));
+      }
+      TF_RETURN_IF_ERROR(writer.Write(element));
+    }
+    source_chunks.push_back(chunk.filename);
+  }
+  TF_ASSIGN_OR_RETURN(int64_t num_elements, writer.Finalize(source_chunks));
+  VLOG(1) << "Compacted " << chunks.size() << " tf.data snapshot chunks with "
+          << num_elements << " elements into " << filename;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<std::string>> ListCompactedChunks(
+    const SnapshotCompactionParams& params) {
+  const std::string compacted_chunks_directory =
+      CompactedChunksDirectory(params.snapshot_path);
+  TF_ASSIGN_OR_RETURN(std::vector<std::string> filenames,
+                      GetChildren(compacted_chunks_directory, params.env));
+  std::vector<std::pair<int64_t, std::string>> compacted_chunks;
+  for (const std::string& filename : filenames) {
+    // Skips the DONE file and temporary files left by failed compactions.
+    absl::StatusOr<int64_t> index = ParseCompactedChunkFilename(filename);
+    if (!index.ok()) {
+      continue;
+    }
+    compacted_chunks.emplace_back(
+        *index, tsl::io::JoinPath(compacted_chunks_directory, filename));
+  }
+  std::sort(compacted_chunks.begin(), compacted_chunks.end());
+  std::vector<std::string> result;
+  result.reserve(compacted_chunks.size());
+  for (auto& [index, path] : compacted_chunks) {
+    result.push_back(std::move(path));
+  }
+  return result;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<std::string>> CompactSnapshotChunks(
+    const SnapshotCompactionParams& params) {
+  if (!params.env->FileExists(SnapshotDoneFilePath(params.snapshot_path))
+           .ok()) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Cannot compact tf.data snapshot at ",
+                     params.snapshot_path, ": The snapshot is unfinished."));
+  }
+  if (params.env->FileExists(CompactionDoneFilePath(params.snapshot_path))
+          .ok()) {
+    return ListCompactedChunks(params);
+  }
+
+  const std::string compacted_chunks_directory =
+      CompactedChunksDirectory(params.snapshot_path);
+  TF_RETURN_IF_ERROR(
+      params.env->RecursivelyCreateDir(compacted_chunks_directory));
+  TF_RETURN_IF_ERROR(DeleteTemporaryFiles(params));
+  TF_ASSIGN_OR_RETURN(std::vector<CommittedChunk> chunks,
+                      ListCommittedChunks(params));
+  TF_ASSIGN_OR_RETURN(const int64_t num_components,
+                      GetNumComponents(params, chunks));
+  std::vector<std::vector<CommittedChunk>> groups =
+      GroupChunks(std::move(chunks), params.target_file_size);
+
+  std::vector<std::string> compacted_chunks;
+  compacted_chunks.reserve(groups.size());
+  for (size_t i = 0; i < groups.size(); ++i) {
+    compacted_chunks.push_back(
+        CompactedChunkFilePath(params.snapshot_path, i));
+  }
+  std::vector<absl::Status> statuses(groups.size());
+  {
+    const int64_t num_threads = std::max<int64_t>(
+        std::min<int64_t>(groups.size(), params.num_write_threads), 1);
+    tsl::thread::ThreadPool thread_pool(params.env, tsl::ThreadOptions{},
+                                        "compact_snapshot_thread", num_threads);
+    for (size_t i = 0; i < groups.size(); ++i) {
+      thread_pool.Schedule([&params, num_components, &groups,
+                            &compacted_chunks, &statuses, i]() {
+        statuses[i] = WriteCompactedChunk(params, num_components, groups[i],
+                                          compacted_chunks[i]);
+      });
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  TF_RETURN_IF_ERROR(AtomicallyWriteStringToFile(
+      CompactionDoneFilePath(params.snapshot_path), "", params.env));
+  LOG(INFO) << "Compacted tf.data snapshot " << params.snapshot_path << " into "
+            << compacted_chunks.size() << " files.";
+  return compacted_chunks;
+}
+
+SnapshotCompactor::SnapshotCompactor(const SnapshotCompactionParams& params)
+    : params_(params) {
+  params_.is_cancelled = [this, is_cancelled = params.is_cancelled]() {
+    return cancelled_ || (is_cancelled && is_cancelled());
+  };
+  compaction_thread_ = absl::WrapUnique(params_.env->StartThread(
+      /*thread_options=*/{}, /*name=*/"tf_data_service_snapshot_compaction",
+      [this]() {
+        absl::StatusOr<std::vector<std::string>> result =
+            CompactSnapshotChunks(params_);
+        if (!result.ok()) {
+          LOG(ERROR) << "Failed to compact tf.data snapshot "
+                     << params_.snapshot_path << ": " << result.status();
+        }
+        mutex_lock l(mu_);
+        result_ = std::move(result);
+      }));
+}
+
+void SnapshotCompactor::Cancel() { cancelled_ = true; }
+
+absl::StatusOr<std::vector<std::string>> SnapshotCompactor::Wait() {
+  compaction_thread_.reset();
+  mutex_lock l(mu_);
+  return result_;
+}
+
+}  // namespace data
+}  // namespace tensorflow
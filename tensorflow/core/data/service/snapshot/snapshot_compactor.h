@@ -0,0 +1,109 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_SNAPSHOT_COMPACTOR_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_SNAPSHOT_COMPACTOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/service/snapshot/compacted_chunk.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+struct SnapshotCompactionParams {
+  // The directory path of the snapshot.
+  std::string snapshot_path;
+
+  // Compression of the committed chunks, as defined in
+  // tsl/lib/io/compression.h. Compacted blocks are compressed with Snappy if
+  // this is not empty.
+  std::string compression;
+
+  // The Tensorflow environment.
+  tsl::Env* env = nullptr;
+
+  // Committed chunks are merged into compacted chunks of about this size.
+  ByteSize target_file_size = ByteSize::GB(1);
+
+  // The uncompressed size of each block in a compacted chunk.
+  ByteSize block_size = kDefaultCompactedChunkBlockSize;
+
+  // Number of compacted chunks written in parallel.
+  int64_t num_write_threads = 4;
+
+  // If set, the compaction stops with a Cancelled status once this returns
+  // true.
+  std::function<bool()> is_cancelled;
+};
+
+// Merges the committed chunks of a finished snapshot into compacted chunks,
+// stored as following:
+//
+// - snapshot
+//   - chunks
+//     - chunk_<stream_index>_<chunk_index>_<num_elements>
+//   - compacted_chunks
+//     - DONE
+//     - compacted_chunk_<index>
+//
+// Committed chunks are merged in (stream_index, chunk_index) order, so the
+// compacted chunks are deterministic and a failed compaction can be retried.
+// Temporary files left by a failed compaction are deleted. The committed chunks
+// are not deleted. Returns the paths of the compacted chunks. If the snapshot
+// has already been compacted, returns the existing compacted chunks. Returns
+// FailedPrecondition if the snapshot is unfinished.
+absl::StatusOr<std::vector<std::string>> CompactSnapshotChunks(
+    const SnapshotCompactionParams& params);
+
+// Runs `CompactSnapshotChunks` in a background thread. Users can call `Wait` to
+// wait for it to finish, or `Cancel` to stop it early.
+class SnapshotCompactor {
+ public:
+  explicit SnapshotCompactor(const SnapshotCompactionParams& params);
+  virtual ~SnapshotCompactor() = default;
+  SnapshotCompactor(const SnapshotCompactor&) = delete;
+  SnapshotCompactor& operator=(const SnapshotCompactor&) = delete;
+
+  // Waits for the compaction to finish and returns the compacted chunks.
+  absl::StatusOr<std::vector<std::string>> Wait();
+
+  // Stops the compaction. A later compaction of the same snapshot starts over.
+  void Cancel();
+
+ private:
+  SnapshotCompactionParams params_;
+  std::atomic<bool> cancelled_ = false;
+
+  mutable mutex mu_;
+  absl::StatusOr<std::vector<std::string>> result_ TF_GUARDED_BY(mu_);
+
+  std::unique_ptr<Thread> compaction_thread_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_SNAPSHOT_COMPACTOR_H_
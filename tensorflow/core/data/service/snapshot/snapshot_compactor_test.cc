@@ -0,0 +1,339 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/snapshot_compactor.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/tsl/lib/io/compression.h"
+#include "tensorflow/core/data/service/byte_size.h"
+#include "tensorflow/core/data/service/snapshot/compacted_chunk.h"
+#include "tensorflow/core/data/service/snapshot/file_utils.h"
+#include "tensorflow/core/data/service/snapshot/path_utils.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+using ::tsl::testing::IsOkAndHolds;
+using ::tsl::testing::StatusIs;
+
+absl::StatusOr<std::string> TestDir() {
+  std::string test_dir;
+  if (!tsl::Env::Default()->LocalTempFilename(&test_dir)) {
+    return absl::FailedPreconditionError("Failed to create local temp file.");
+  }
+  TF_RETURN_IF_ERROR(tsl::Env::Default()->RecursivelyCreateDir(test_dir));
+  return test_dir;
+}
+
+// Writes a finished snapshot with `num_streams` streams, each with
+// `num_chunks_per_stream` chunks of `num_elements_per_chunk` elements.
+// Elements are numbered in (stream_index, chunk_index) order.
+absl::StatusOr<std::string> WriteSnapshot(int64_t num_streams,
+                                          int64_t num_chunks_per_stream,
+                                          int64_t num_elements_per_chunk,
+                                          const std::string& compression) {
+  TF_ASSIGN_OR_RETURN(std::string snapshot_path, TestDir());
+  TF_RETURN_IF_ERROR(tsl::Env::Default()->RecursivelyCreateDir(
+      CommittedChunksDirectory(snapshot_path)));
+  int64_t next_element = 0;
+  for (int64_t stream_index = 0; stream_index < num_streams; ++stream_index) {
+    for (int64_t chunk_index = 0; chunk_index < num_chunks_per_stream;
+         ++chunk_index) {
+      std::vector<Tensor> tensors;
+      for (int64_t i = 0; i < num_elements_per_chunk; ++i) {
+        tensors.push_back(Tensor{next_element++});
+      }
+      const std::string chunk_path = tsl::io::JoinPath(
+          CommittedChunksDirectory(snapshot_path),
+          absl::StrCat("chunk_", stream_index, "_", chunk_index, "_",
+                       num_elements_per_chunk));
+      TF_RETURN_IF_ERROR(AtomicallyWriteTFRecords(
+          chunk_path, tensors, compression, tsl::Env::Default()));
+    }
+  }
+  TF_RETURN_IF_ERROR(AtomicallyWriteStringToFile(
+      SnapshotDoneFilePath(snapshot_path), "", tsl::Env::Default()));
+  return snapshot_path;
+}
+
+SnapshotCompactionParams CompactionParams(const std::string& snapshot_path,
+                                          const std::string& compression,
+                                          ByteSize target_file_size) {
+  SnapshotCompactionParams params;
+  params.snapshot_path = snapshot_path;
+  params.compression = compression;
+  params.env = tsl::Env::Default();
+  params.target_file_size = target_file_size;
+  params.block_size = ByteSize::KB(1);
+  return params;
+}
+
+absl::StatusOr<std::vector<int64_t>> ReadCompactedChunks(
+    const std::vector<std::string>& compacted_chunks) {
+  std::vector<int64_t> result;
+  for (const std::string& compacted_chunk : compacted_chunks) {
+    auto reader = std::make_unique<CompactedChunkReader>(compacted_chunk,
+                                                         tsl::Env::Default());
+    TF_RETURN_IF_ERROR(reader->Initialize());
+    CompactedChunkIterator iterator(std::move(reader), tsl::Env::Default());
+    while (true) {
+      std::vector<Tensor> element;
+      bool end_of_sequence = false;
+      TF_RETURN_IF_ERROR(iterator.GetNext(element, end_of_sequence));
+      if (end_of_sequence) {
+        break;
+      }
+      result.push_back(element[0].scalar<int64_t>()());
+    }
+  }
+  return result;
+}
+
+std::vector<int64_t> Range(int64_t range) {
+  std::vector<int64_t> result;
+  for (int64_t i = 0; i < range; ++i) {
+    result.push_back(i);
+  }
+  return result;
+}
+
+class SnapshotCompactorTest : public ::testing::TestWithParam<std::string> {
+ protected:
+  std::string Compression() const { return GetParam(); }
+};
+
+TEST_P(SnapshotCompactorTest, CompactIntoOneFile) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string snapshot_path,
+      WriteSnapshot(/*num_streams=*/3, /*num_chunks_per_stream=*/4,
+                    /*num_elements_per_chunk=*/10, Compression()));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> compacted_chunks,
+      CompactSnapshotChunks(
+          CompactionParams(snapshot_path, Compression(), ByteSize::GB(1))));
+  EXPECT_THAT(compacted_chunks, SizeIs(1));
+  EXPECT_THAT(ReadCompactedChunks(compacted_chunks),
+              IsOkAndHolds(ElementsAreArray(Range(120))));
+}
+
+TEST_P(SnapshotCompactorTest, CompactIntoMultipleFiles) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string snapshot_path,
+      WriteSnapshot(/*num_streams=*/3, /*num_chunks_per_stream=*/4,
+                    /*num_elements_per_chunk=*/10, Compression()));
+  // Each committed chunk exceeds the target size, so no chunks are merged.
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> compacted_chunks,
+      CompactSnapshotChunks(
+          CompactionParams(snapshot_path, Compression(), ByteSize::Bytes(1))));
+  EXPECT_THAT(compacted_chunks, SizeIs(12));
+  EXPECT_THAT(ReadCompactedChunks(compacted_chunks),
+              IsOkAndHolds(ElementsAreArray(Range(120))));
+}
+
+TEST_P(SnapshotCompactorTest, CompactionIsIdempotent) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string snapshot_path,
+      WriteSnapshot(/*num_streams=*/2, /*num_chunks_per_stream=*/3,
+                    /*num_elements_per_chunk=*/10, Compression()));
+  SnapshotCompactionParams params =
+      CompactionParams(snapshot_path, Compression(), ByteSize::Bytes(1));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::string> compacted_chunks,
+                          CompactSnapshotChunks(params));
+  EXPECT_THAT(CompactSnapshotChunks(params),
+              IsOkAndHolds(ElementsAreArray(compacted_chunks)));
+}
+
+TEST_P(SnapshotCompactorTest, CompactInBackground) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string snapshot_path,
+      WriteSnapshot(/*num_streams=*/2, /*num_chunks_per_stream=*/3,
+                    /*num_elements_per_chunk=*/10, Compression()));
+  SnapshotCompactor compactor(
+      CompactionParams(snapshot_path, Compression(), ByteSize::GB(1)));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::string> compacted_chunks,
+                          compactor.Wait());
+  EXPECT_THAT(ReadCompactedChunks(compacted_chunks),
+              IsOkAndHolds(ElementsAreArray(Range(60))));
+}
+
+TEST_P(SnapshotCompactorTest, DeletesTemporaryFiles) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string snapshot_path,
+      WriteSnapshot(/*num_streams=*/2, /*num_chunks_per_stream=*/3,
+                    /*num_elements_per_chunk=*/10, Compression()));
+  // A compaction failed while writing the first compacted chunk.
+  const std::string tmp_file =
+      absl::StrCat(CompactedChunkFilePath(snapshot_path, 0), "__1234.tmp");
+  TF_ASSERT_OK(tsl::Env::Default()->RecursivelyCreateDir(
+      CompactedChunksDirectory(snapshot_path)));
+  TF_ASSERT_OK(AtomicallyWriteStringToFile(tmp_file, "partial chunk",
+                                           tsl::Env::Default()));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::string> compacted_chunks,
+      CompactSnapshotChunks(
+          CompactionParams(snapshot_path, Compression(), ByteSize::GB(1))));
+  EXPECT_THAT(ReadCompactedChunks(compacted_chunks),
+              IsOkAndHolds(ElementsAreArray(Range(60))));
+  EXPECT_THAT(tsl::Env::Default()->FileExists(tmp_file),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_P(SnapshotCompactorTest, IgnoresTemporaryFilesOfFinishedCompaction) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string snapshot_path,
+      WriteSnapshot(/*num_streams=*/2, /*num_chunks_per_stream=*/3,
+                    /*num_elements_per_chunk=*/10, Compression()));
+  SnapshotCompactionParams params =
+      CompactionParams(snapshot_path, Compression(), ByteSize::Bytes(1));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::string> compacted_chunks,
+                          CompactSnapshotChunks(params));
+  TF_ASSERT_OK(AtomicallyWriteStringToFile(
+      absl::StrCat(CompactedChunkFilePath(snapshot_path, 0), "__1234.tmp"),
+      "partial chunk", tsl::Env::Default()));
+  EXPECT_THAT(CompactSnapshotChunks(params),
+              IsOkAndHolds(ElementsAreArray(compacted_chunks)));
+}
+
+TEST_P(SnapshotCompactorTest, Cancel) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string snapshot_path,
+      WriteSnapshot(/*num_streams=*/2, /*num_chunks_per_stream=*/3,
+                    /*num_elements_per_chunk=*/10, Compression()));
+  SnapshotCompactionParams params =
+      CompactionParams(snapshot_path, Compression(), ByteSize::GB(1));
+  params.is_cancelled = []() { return true; };
+  EXPECT_THAT(CompactSnapshotChunks(params),
+              StatusIs(absl::StatusCode::kCancelled));
+  EXPECT_THAT(
+      tsl::Env::Default()->FileExists(CompactionDoneFilePath(snapshot_path)),
+      StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_P(SnapshotCompactorTest, EmptySnapshot) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::string snapshot_path,
+      WriteSnapshot(/*num_streams=*/0, /*num_chunks_per_stream=*/0,
+                    /*num_elements_per_chunk=*/0, Compression()));
+  EXPECT_THAT(CompactSnapshotChunks(CompactionParams(
+                  snapshot_path, Compression(), ByteSize::GB(1))),
+              IsOkAndHolds(IsEmpty()));
+}
+
+INSTANTIATE_TEST_SUITE_P(Compression, SnapshotCompactorTest,
+                         ::testing::ValuesIn<std::string>(
+                             {tsl::io::compression::kNone,
+                              tsl::io::compression::kSnappy,
+                              tsl::io::compression::kGzip}));
+
+TEST(SnapshotCompactorTest, UnfinishedSnapshot) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, TestDir());
+  EXPECT_THAT(CompactSnapshotChunks(CompactionParams(
+                  snapshot_path, tsl::io::compression::kNone, ByteSize::GB(1))),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+// Measures end-to-end read throughput of a snapshot with many small chunks,
+// before and after compaction.
+constexpr int64_t kBenchmarkNumStreams = 8;
+constexpr int64_t kBenchmarkNumChunksPerStream = 64;
+constexpr int64_t kBenchmarkNumElementsPerChunk = 100;
+
+void BM_ReadCommittedChunks(::testing::benchmark::State& state) {
+  absl::StatusOr<std::string> snapshot_path = WriteSnapshot(
+      kBenchmarkNumStreams, kBenchmarkNumChunksPerStream,
+      kBenchmarkNumElementsPerChunk, tsl::io::compression::kSnappy);
+  TF_ASSERT_OK(snapshot_path.status());
+  absl::StatusOr<std::vector<std::string>> chunks =
+      GetChildren(CommittedChunksDirectory(*snapshot_path), Env::Default());
+  TF_ASSERT_OK(chunks.status());
+
+  int64_t num_elements = 0;
+  for (auto s : state) {
+    for (const std::string& chunk : *chunks) {
+      snapshot_util::TFRecordReader reader(
+          tsl::io::JoinPath(CommittedChunksDirectory(*snapshot_path), chunk),
+          tsl::io::compression::kSnappy, DataTypeVector{DT_INT64});
+      TF_ASSERT_OK(reader.Initialize(Env::Default()));
+      std::vector<Tensor> element;
+      while (reader.ReadTensors(&element).ok()) {
+        ++num_elements;
+        element.clear();
+      }
+    }
+  }
+  state.SetItemsProcessed(num_elements);
+}
+
+void BM_ReadCompactedChunks(::testing::benchmark::State& state) {
+  absl::StatusOr<std::string> snapshot_path = WriteSnapshot(
+      kBenchmarkNumStreams, kBenchmarkNumChunksPerStream,
+      kBenchmarkNumElementsPerChunk, tsl::io::compression::kSnappy);
+  TF_ASSERT_OK(snapshot_path.status());
+  SnapshotCompactionParams params = CompactionParams(
+      *snapshot_path, tsl::io::compression::kSnappy, ByteSize::GB(1));
+  params.block_size = ByteSize::KB(64);
+  absl::StatusOr<std::vector<std::string>> compacted_chunks =
+      CompactSnapshotChunks(params);
+  TF_ASSERT_OK(compacted_chunks.status());
+
+  const int64_t num_parallel_blocks = state.range(0);
+  int64_t num_elements = 0;
+  for (auto s : state) {
+    for (const std::string& compacted_chunk : *compacted_chunks) {
+      auto reader = std::make_unique<CompactedChunkReader>(compacted_chunk,
+                                                           Env::Default());
+      TF_ASSERT_OK(reader->Initialize());
+      CompactedChunkIterator iterator(std::move(reader), Env::Default(),
+                                      num_parallel_blocks);
+      std::vector<Tensor> element;
+      bool end_of_sequence = false;
+      while (iterator.GetNext(element, end_of_sequence).ok() &&
+             !end_of_sequence) {
+        ++num_elements;
+      }
+    }
+  }
+  state.SetItemsProcessed(num_elements);
+}
+
+BENCHMARK(BM_ReadCommittedChunks);
+BENCHMARK(BM_ReadCompactedChunks)->Arg(1)->Arg(4)->Arg(16);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
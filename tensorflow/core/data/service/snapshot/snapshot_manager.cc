@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/snapshot/file_utils.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/snapshot/prefetched_split_provider.h"
+#include "tensorflow/core/data/service/snapshot/snapshot_compactor.h"
 #include "tensorflow/core/data/service/split_provider.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -256,6 +257,8 @@ absl::Status SnapshotManager::Resume() TF_LOCKS_EXCLUDED(mu_) {
   if (env_->FileExists(SnapshotDoneFilePath(path_)).ok()) {
     mode_ = Mode::kDone;
     LOG(INFO) << "Recovered finished tf.data snapshot at " << path_;
+    TF_RETURN_IF_ERROR(ReadOnDiskMetadata());
+    MaybeStartCompaction();
     return absl::OkStatus();
   }
   if (env_->FileExists(SnapshotErrorFilePath(path_)).ok()) {
@@ -366,10 +369,7 @@ absl::Status SnapshotManager::ReadOnDiskStreams()
   if (!streams_.empty() && absl::c_all_of(streams_, [](const auto& stream) {
         return stream.second.state == Stream::State::kDone;
       })) {
-    mode_ = Mode::kDone;
-    TF_RETURN_IF_ERROR(AtomicallyWriteStringToFile(SnapshotDoneFilePath(path_),
-                                                   std::string(), env_));
-    LOG(INFO) << "Finished writing tf.data distributed snapshot at " << path_;
+    TF_RETURN_IF_ERROR(FinishSnapshot());
   }
   return absl::OkStatus();
 }
@@ -537,14 +537,33 @@ absl::Status SnapshotManager::HandleStreamCompletion(
   if (absl::c_all_of(streams_, [](const auto& stream) {
         return stream.second.state == Stream::State::kDone;
       })) {
-    mode_ = Mode::kDone;
-    TF_RETURN_IF_ERROR(AtomicallyWriteStringToFile(SnapshotDoneFilePath(path_),
-                                                   std::string(), env_));
-    LOG(INFO) << "Finished writing tf.data distributed snapshot at " << path_;
+    TF_RETURN_IF_ERROR(FinishSnapshot());
   }
   return absl::OkStatus();
 }
 
+absl::Status SnapshotManager::FinishSnapshot()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  mode_ = Mode::kDone;
+  TF_RETURN_IF_ERROR(AtomicallyWriteStringToFile(SnapshotDoneFilePath(path_),
+                                                 std::string(), env_));
+  LOG(INFO) << "Finished writing tf.data distributed snapshot at " << path_;
+  MaybeStartCompaction();
+  return absl::OkStatus();
+}
+
+void SnapshotManager::MaybeStartCompaction() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!metadata_.compact_chunks() || compactor_ != nullptr ||
+      env_->FileExists(CompactionDoneFilePath(path_)).ok()) {
+    return;
+  }
+  SnapshotCompactionParams params;
+  params.snapshot_path = path_;
+  params.compression = metadata_.compression();
+  params.env = env_;
+  compactor_ = std::make_unique<SnapshotCompactor>(params);
+}
+
 absl::Status SnapshotManager::HandleStreamError(
     absl::string_view worker_address, const StatusProto& status_proto)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -806,6 +825,10 @@ void SnapshotManager::Cancel() {
   for (PrefetchedSplitProvider* split_provider : split_providers_to_cancel) {
     split_provider->Cancel();
   }
+  tsl::mutex_lock l(mu_);
+  if (compactor_ != nullptr) {
+    compactor_->Cancel();
+  }
 }
 
 }  // namespace data
@@ -33,6 +33,7 @@ limitations under the License.
 #include "xla/tsl/protobuf/status.pb.h"
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/snapshot/prefetched_split_provider.h"
+#include "tensorflow/core/data/service/snapshot/snapshot_compactor.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tsl/platform/env.h"
@@ -129,6 +130,9 @@ class SnapshotAssignmentManager {
 //   - dataset_spec.pb
 //   - chunks
 //     - chunk_<stream_index>_<stream_chunk_index>_<num_elements>
+//   - compacted_chunks (if `compact_chunks` is set in the metadata)
+//     - DONE
+//     - compacted_chunk_<compacted_chunk_index>
 //   - streams
 //     - stream_0
 //       - DONE
@@ -208,6 +212,12 @@ class SnapshotManager {
   absl::Status HandleStreamError(absl::string_view worker_address,
                                  const StatusProto& status_proto);
 
+  // Marks the snapshot as done and starts compacting its chunks if requested.
+  absl::Status FinishSnapshot();
+  // Starts compacting the committed chunks in the background if the snapshot
+  // requests compaction and it has not been compacted yet.
+  void MaybeStartCompaction();
+
   mutable tsl::mutex mu_;
   // Uses a separate mutex for `GetSnapshotSplit` RPCs. `GetSnapshotSplit` uses
   // file IO and may be slow, which may slow down `WorkerHeartbeat` RPCs if they
@@ -222,6 +232,8 @@ class SnapshotManager {
   experimental::DistributedSnapshotMetadata metadata_ TF_GUARDED_BY(mu_);
   // The last time progress was logged.
   absl::Time last_progress_log_time_ TF_GUARDED_BY(mu_);
+  // Compacts the committed chunks after the snapshot is done.
+  std::unique_ptr<SnapshotCompactor> compactor_ TF_GUARDED_BY(mu_);
 
   // The addresses of all workers considered to be dead based on heartbeat
   // timeout.
@@ -17,9 +17,12 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
@@ -32,14 +35,17 @@ limitations under the License.
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
 
 namespace tensorflow {
 namespace data {
@@ -100,8 +106,16 @@ absl::Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    CrossTrainerCacheDiskOptions disk_options;
+    if (!worker_config.cross_trainer_cache_disk_directory().empty()) {
+      disk_options.directory =
+          io::JoinPath(worker_config.cross_trainer_cache_disk_directory(),
+                       absl::StrCat("task_", task_def.task_id()));
+      disk_options.max_size_bytes =
+          worker_config.cross_trainer_cache_disk_size_bytes();
+    }
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes, std::move(disk_options));
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -178,10 +192,12 @@ std::shared_ptr<model::Model> FirstComeFirstServedTaskRunner::model() const {
 }
 
 CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                                     size_t max_cache_size_bytes)
+                                     size_t max_cache_size_bytes,
+                                     CrossTrainerCacheDiskOptions disk_options)
     : fcfs_task_runner_(std::move(iterator)),
       cache_(max_cache_size_bytes,
-             std::make_unique<GetElementResultSequence>(fcfs_task_runner_)) {
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             std::move(disk_options)) {
   LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
             << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
 }
@@ -217,6 +233,49 @@ size_t CachingTaskRunner::GetElementResultSequence::GetElementSizeBytes(
   return element.EstimatedMemoryUsageBytes();
 }
 
+// Serialized elements consist of the varint64-encoded element index followed
+// by a `SnapshotRecord` of the components.
+absl::StatusOr<std::string>
+CachingTaskRunner::GetElementResultSequence::SerializeElement(
+    const GetElementResult& element) const {
+  SnapshotRecord record;
+  for (const Tensor& component : element.components) {
+    component.AsProtoTensorContent(record.add_tensor());
+  }
+  std::string serialized;
+  core::PutVarint64(&serialized, element.element_index);
+  if (!record.AppendToString(&serialized)) {
+    return errors::Internal(
+        "Failed to serialize tf.data service cross-trainer cache element ",
+        element.element_index, ".");
+  }
+  return serialized;
+}
+
+absl::StatusOr<GetElementResult>
+CachingTaskRunner::GetElementResultSequence::DeserializeElement(
+    absl::string_view serialized) const {
+  GetElementResult result;
+  uint64_t element_index = 0;
+  SnapshotRecord record;
+  if (!core::GetVarint64(&serialized, &element_index) ||
+      !record.ParseFromArray(serialized.data(), serialized.size())) {
+    return errors::DataLoss(
+        "Failed to parse tf.data service cross-trainer cache element.");
+  }
+  result.element_index = static_cast<int64_t>(element_index);
+  for (const TensorProto& tensor_proto : record.tensor()) {
+    Tensor component;
+    if (!component.FromProto(tensor_proto)) {
+      return errors::DataLoss(
+          "Failed to parse tf.data service cross-trainer cache element ",
+          element_index, ": Invalid tensor.");
+    }
+    result.components.push_back(std::move(component));
+  }
+  return result;
+}
+
 void CachingTaskRunner::Cancel() {
   VLOG(2) << "Cancelling tf.data service cross-trainer cache task.";
   if (!cache_.IsCancelled()) {
@@ -17,8 +17,10 @@ limitations under the License.
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -151,11 +153,14 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
 // and caches elements in a sliding-window `CrossTrainerCache`. The cache has a
 // bounded size and progresses when a trainer that has consumed all elements in
 // the cache. Trainers read from a sliding window of the dataset and may not
-// read the full dataset.
+// read the full dataset. If `disk_options` enables the disk tier, elements
+// evicted from memory remain available on local disk for slow trainers.
 class CachingTaskRunner : public TaskRunner {
  public:
-  explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                             size_t max_cache_size_bytes);
+  explicit CachingTaskRunner(
+      std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+      CrossTrainerCacheDiskOptions disk_options =
+          CrossTrainerCacheDiskOptions());
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -181,6 +186,10 @@ class CachingTaskRunner : public TaskRunner {
         FirstComeFirstServedTaskRunner& fcfs_task_runner);
     absl::StatusOr<GetElementResult> GetNext() override;
     size_t GetElementSizeBytes(const GetElementResult& element) const override;
+    absl::StatusOr<std::string> SerializeElement(
+        const GetElementResult& element) const override;
+    absl::StatusOr<GetElementResult> DeserializeElement(
+        absl::string_view serialized) const override;
 
    private:
     FirstComeFirstServedTaskRunner& fcfs_task_runner_;
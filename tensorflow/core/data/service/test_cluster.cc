@@ -21,9 +21,11 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/export.pb.h"
 #include "tensorflow/core/data/service/server_lib.h"
 #include "tensorflow/core/platform/errors.h"
@@ -123,6 +125,13 @@ std::string TestCluster::WorkerAddress(int index) const {
   return worker_addresses_[index];
 }
 
+absl::Status TestCluster::DrainWorker(size_t index) {
+  DCHECK_LT(index, worker_addresses_.size());
+  DataServiceDispatcherClient dispatcher_client(dispatcher_address_,
+                                                kProtocol);
+  return dispatcher_client.DrainWorker(worker_addresses_[index]);
+}
+
 void TestCluster::StopWorker(size_t index) {
   DCHECK_GE(index, 0);
   DCHECK_LT(index, worker_addresses_.size());
@@ -89,6 +89,9 @@ class TestCluster {
   // workers in the cluster.
   std::string WorkerAddress(int index) const;
 
+  // Asks the dispatcher to drain the worker at the specified index. Together
+  // with `AddWorker`, this simulates an elastic worker pool.
+  absl::Status DrainWorker(size_t index);
   // Stops one worker.
   void StopWorker(size_t index);
   // Stops all workers.
@@ -0,0 +1,217 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tf_record_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kTFRecordIndexSuffix[] = ".index";
+constexpr uint64_t kTFRecordIndexMagic = 0x7865646e69726674;  // "tfrindex"
+constexpr size_t kHeaderSize = 2 * sizeof(uint64_t);
+constexpr size_t kEntrySize = 2 * sizeof(uint64_t);
+
+// Size of a record of `length` bytes including its header and footer.
+uint64_t FramedRecordSize(uint64_t length) {
+  return io::RecordReader::kHeaderSize + length +
+         io::RecordReader::kFooterSize;
+}
+
+// Parses the framed record in `data`, verifying it has `length` bytes.
+absl::Status ParseRecord(absl::string_view data, uint64_t length,
+                         tstring& record) {
+  const char* header = data.data();
+  const uint64_t record_length = core::DecodeFixed64(header);
+  if (record_length != length ||
+      crc32c::Unmask(core::DecodeFixed32(header + sizeof(uint64_t))) !=
+          crc32c::Value(header, sizeof(uint64_t))) {
+    return absl::DataLossError(absl::StrCat(
+        "Corrupted record header: Expected record length ", length, "."));
+  }
+  const char* payload = header + io::RecordReader::kHeaderSize;
+  if (crc32c::Unmask(core::DecodeFixed32(payload + length)) !=
+      crc32c::Value(payload, length)) {
+    return absl::DataLossError("Corrupted record: Checksum mismatch.");
+  }
+  record.assign(payload, length);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+std::string TFRecordIndexFilename(absl::string_view filename) {
+  return absl::StrCat(filename, kTFRecordIndexSuffix);
+}
+
+void TFRecordIndexBuilder::AddRecord(uint64_t length) {
+  core::PutFixed64(&entries_, next_offset_);
+  core::PutFixed64(&entries_, length);
+  next_offset_ += FramedRecordSize(length);
+  ++num_records_;
+}
+
+absl::Status TFRecordIndexBuilder::Write(Env* env,
+                                         const std::string& filename) const {
+  std::string contents;
+  contents.reserve(kHeaderSize + entries_.size());
+  core::PutFixed64(&contents, kTFRecordIndexMagic);
+  core::PutFixed64(&contents, num_records_);
+  contents.append(entries_);
+
+  // Writes to a temporary file and renames it so readers never observe a
+  // partially written index.
+  const std::string tmp_filename = absl::StrCat(filename, ".tmp");
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename, contents));
+  return env->RenameFile(tmp_filename, filename);
+}
+
+absl::StatusOr<std::unique_ptr<TFRecordIndex>> TFRecordIndex::Load(
+    Env* env, const std::string& filename) {
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  std::string contents;
+  absl::Status status =
+      env->NewReadOnlyMemoryRegionFromFile(filename, &region);
+  if (absl::IsUnimplemented(status)) {
+    TF_RETURN_IF_ERROR(ReadFileToString(env, filename, &contents));
+  } else {
+    TF_RETURN_IF_ERROR(status);
+  }
+  std::unique_ptr<TFRecordIndex> index(
+      new TFRecordIndex(std::move(region), std::move(contents)));
+  TF_RETURN_IF_ERROR(index->Initialize(filename));
+  return index;
+}
+
+TFRecordIndex::TFRecordIndex(std::unique_ptr<ReadOnlyMemoryRegion> region,
+                             std::string contents)
+    : region_(std::move(region)), contents_(std::move(contents)) {
+  data_ = region_ ? absl::string_view(static_cast<const char*>(region_->data()),
+                                      region_->length())
+                  : absl::string_view(contents_);
+}
+
+absl::Status TFRecordIndex::Initialize(const std::string& filename) {
+  if (data_.size() < kHeaderSize ||
+      core::DecodeFixed64(data_.data()) != kTFRecordIndexMagic) {
+    return absl::DataLossError(
+        absl::StrCat("Invalid TFRecord index file ", filename, "."));
+  }
+  num_records_ = static_cast<int64_t>(
+      core::DecodeFixed64(data_.data() + sizeof(uint64_t)));
+  if (num_records_ < 0 ||
+      (data_.size() - kHeaderSize) / kEntrySize !=
+          static_cast<uint64_t>(num_records_) ||
+      (data_.size() - kHeaderSize) % kEntrySize != 0) {
+    return absl::DataLossError(absl::StrCat(
+        "Truncated TFRecord index file ", filename, ": Expected ",
+        num_records_, " records, got ", data_.size(), " bytes."));
+  }
+  return absl::OkStatus();
+}
+
+uint64_t TFRecordIndex::offset(int64_t i) const {
+  return core::DecodeFixed64(data_.data() + kHeaderSize + i * kEntrySize);
+}
+
+uint64_t TFRecordIndex::length(int64_t i) const {
+  return core::DecodeFixed64(data_.data() + kHeaderSize + i * kEntrySize +
+                             sizeof(uint64_t));
+}
+
+absl::StatusOr<std::vector<tstring>> ReadTFRecords(
+    RandomAccessFile* file, const TFRecordIndex& index,
+    absl::Span<const int64_t> indices, const TFRecordReadOptions& options) {
+  for (int64_t i : indices) {
+    if (i < 0 || i >= index.num_records()) {
+      return absl::OutOfRangeError(absl::StrCat(
+          "Record index out of range [0, ", index.num_records(), "): ", i));
+    }
+  }
+
+  // Visits the requested records in file order to coalesce nearby reads.
+  std::vector<size_t> order(indices.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return index.offset(indices[lhs]) < index.offset(indices[rhs]);
+  });
+
+  std::vector<tstring> records(indices.size());
+  std::string scratch;
+  size_t begin = 0;
+  while (begin < order.size()) {
+    const uint64_t read_offset = index.offset(indices[order[begin]]);
+    uint64_t read_end =
+        read_offset + FramedRecordSize(index.length(indices[order[begin]]));
+    size_t end = begin + 1;
+    for (; end < order.size(); ++end) {
+      const int64_t next = indices[order[end]];
+      const uint64_t next_end =
+          index.offset(next) + FramedRecordSize(index.length(next));
+      if (index.offset(next) > read_end + options.max_coalesced_gap ||
+          next_end - read_offset > options.max_coalesced_read_size) {
+        break;
+      }
+      read_end = std::max(read_end, next_end);
+    }
+
+    const size_t read_size = read_end - read_offset;
+    scratch.resize(read_size);
+    absl::string_view result;
+    absl::Status status =
+        file->Read(read_offset, read_size, &result, scratch.data());
+    if (!status.ok() && !absl::IsOutOfRange(status)) {
+      return status;
+    }
+    if (result.size() != read_size) {
+      return absl::DataLossError(absl::StrCat(
+          "Truncated TFRecord file: Expected ", read_size, " bytes at offset ",
+          read_offset, ", got ", result.size(), "."));
+    }
+    for (size_t i = begin; i < end; ++i) {
+      const int64_t record_index = indices[order[i]];
+      const uint64_t offset = index.offset(record_index) - read_offset;
+      TF_RETURN_IF_ERROR(ParseRecord(
+          result.substr(offset),
+          index.length(record_index), records[order[i]]));
+    }
+    begin = end;
+  }
+  return records;
+}
+
+}  // namespace data
+}  // namespace tensorflow
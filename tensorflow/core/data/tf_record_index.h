@@ -0,0 +1,138 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_TF_RECORD_INDEX_H_
+#define TENSORFLOW_CORE_DATA_TF_RECORD_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+
+// A TFRecord index is an optional sidecar file that stores the offset and
+// length of every record of an uncompressed TFRecord file. It enables O(1)
+// cardinality and random access, which is required by global shuffling.
+//
+// The index of `<filename>` is stored in `<filename>.index` as following:
+//
+//   fixed64 magic number
+//   fixed64 number of records
+//   for each record:
+//     fixed64 offset of the record header in the TFRecord file
+//     fixed64 length of the record data
+//
+// Fixed-width entries allow the index to be memory-mapped and searched without
+// parsing.
+
+// Returns the path of the index file of the TFRecord file `filename`.
+std::string TFRecordIndexFilename(absl::string_view filename);
+
+// Builds the index of an uncompressed TFRecord file while it is being written.
+//
+// Example usage:
+//
+// ```
+// TFRecordIndexBuilder index_builder;
+// for (const tstring& record : records) {
+//   TF_RETURN_IF_ERROR(writer->WriteRecord(record));
+//   index_builder.AddRecord(record.size());
+// }
+// TF_RETURN_IF_ERROR(writer->Close());
+// TF_RETURN_IF_ERROR(
+//     index_builder.Write(env, TFRecordIndexFilename(filename)));
+// ```
+class TFRecordIndexBuilder {
+ public:
+  // Records that a record of `length` bytes has been appended to the file.
+  void AddRecord(uint64_t length);
+
+  int64_t num_records() const { return num_records_; }
+
+  // Atomically writes the index to `filename`.
+  absl::Status Write(Env* env, const std::string& filename) const;
+
+ private:
+  int64_t num_records_ = 0;
+  uint64_t next_offset_ = 0;
+  std::string entries_;
+};
+
+// A read-only TFRecord index. The index file is memory-mapped if the file
+// system supports it. Otherwise, it is read into memory. Thread-safe.
+class TFRecordIndex {
+ public:
+  // Loads the index from `filename`. Returns NotFound if the index does not
+  // exist, or DataLoss if it is malformed.
+  static absl::StatusOr<std::unique_ptr<TFRecordIndex>> Load(
+      Env* env, const std::string& filename);
+
+  virtual ~TFRecordIndex() = default;
+  TFRecordIndex(const TFRecordIndex&) = delete;
+  TFRecordIndex& operator=(const TFRecordIndex&) = delete;
+
+  int64_t num_records() const { return num_records_; }
+
+  // Returns the offset of the header of record `i` in the TFRecord file.
+  // REQUIRES: 0 <= i < num_records().
+  uint64_t offset(int64_t i) const;
+
+  // Returns the length of the data of record `i`.
+  // REQUIRES: 0 <= i < num_records().
+  uint64_t length(int64_t i) const;
+
+ private:
+  TFRecordIndex(std::unique_ptr<ReadOnlyMemoryRegion> region,
+                std::string contents);
+  absl::Status Initialize(const std::string& filename);
+
+  // Exactly one of `region_` and `contents_` holds the index.
+  const std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  const std::string contents_;
+  absl::string_view data_;
+  int64_t num_records_ = 0;
+};
+
+struct TFRecordReadOptions {
+  // Records separated by at most this many bytes are fetched with one read.
+  uint64_t max_coalesced_gap = 64 << 10;  // 64KB
+
+  // Upper bound of the size of a coalesced read.
+  uint64_t max_coalesced_read_size = 16 << 20;  // 16MB
+};
+
+// Reads the records at `indices` of the uncompressed TFRecord file `file`
+// described by `index`. The records are returned in the order of `indices`.
+// Indices may repeat and need not be sorted: Records that are close in the file
+// are fetched with a single positional read. Returns OutOfRange if an index is
+// out of range, or DataLoss if a record is corrupted.
+absl::StatusOr<std::vector<tstring>> ReadTFRecords(
+    RandomAccessFile* file, const TFRecordIndex& index,
+    absl::Span<const int64_t> indices,
+    const TFRecordReadOptions& options = TFRecordReadOptions());
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_TF_RECORD_INDEX_H_
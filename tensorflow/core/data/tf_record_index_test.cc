@@ -0,0 +1,255 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/tf_record_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/tstring.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAre;
+using ::tsl::testing::IsOkAndHolds;
+using ::tsl::testing::StatusIs;
+
+// Counts the number of positional reads.
+class CountingRandomAccessFile : public RandomAccessFile {
+ public:
+  explicit CountingRandomAccessFile(std::unique_ptr<RandomAccessFile> file)
+      : file_(std::move(file)) {}
+
+  absl::Status Read(uint64 offset, size_t n, absl::string_view* result,
+                    char* scratch) const override {
+    ++num_reads_;
+    return file_->Read(offset, n, result, scratch);
+  }
+
+  int64_t num_reads() const { return num_reads_; }
+
+ private:
+  std::unique_ptr<RandomAccessFile> file_;
+  mutable int64_t num_reads_ = 0;
+};
+
+std::string TestFilename() {
+  std::string filename;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&filename));
+  return filename;
+}
+
+// Writes `records` to an uncompressed TFRecord file and its index.
+absl::Status WriteTFRecordFile(const std::string& filename,
+                               const std::vector<std::string>& records) {
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(filename, &file));
+  io::RecordWriter writer(file.get());
+  TFRecordIndexBuilder index_builder;
+  for (const std::string& record : records) {
+    TF_RETURN_IF_ERROR(writer.WriteRecord(record));
+    index_builder.AddRecord(record.size());
+  }
+  TF_RETURN_IF_ERROR(writer.Close());
+  TF_RETURN_IF_ERROR(file->Close());
+  return index_builder.Write(Env::Default(), TFRecordIndexFilename(filename));
+}
+
+absl::StatusOr<std::unique_ptr<CountingRandomAccessFile>> OpenFile(
+    const std::string& filename) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(filename, &file));
+  return std::make_unique<CountingRandomAccessFile>(std::move(file));
+}
+
+TEST(TFRecordIndexTest, LoadIndex) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTFRecordFile(filename, {"a", "bb", "", "dddd"}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::Load(Env::Default(), TFRecordIndexFilename(filename)));
+  ASSERT_EQ(index->num_records(), 4);
+  // Each record has a 12-byte header and a 4-byte footer.
+  EXPECT_EQ(index->offset(0), 0);
+  EXPECT_EQ(index->length(0), 1);
+  EXPECT_EQ(index->offset(1), 17);
+  EXPECT_EQ(index->length(1), 2);
+  EXPECT_EQ(index->offset(2), 35);
+  EXPECT_EQ(index->length(2), 0);
+  EXPECT_EQ(index->offset(3), 51);
+  EXPECT_EQ(index->length(3), 4);
+}
+
+TEST(TFRecordIndexTest, EmptyFile) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTFRecordFile(filename, {}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::Load(Env::Default(), TFRecordIndexFilename(filename)));
+  EXPECT_EQ(index->num_records(), 0);
+}
+
+TEST(TFRecordIndexTest, MissingIndex) {
+  EXPECT_THAT(TFRecordIndex::Load(Env::Default(),
+                                  TFRecordIndexFilename(TestFilename())),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(TFRecordIndexTest, InvalidIndex) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, "not an index"));
+  EXPECT_THAT(TFRecordIndex::Load(Env::Default(), filename),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(TFRecordIndexTest, TruncatedIndex) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTFRecordFile(filename, {"a", "bb", "ccc"}));
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), TFRecordIndexFilename(filename),
+                                &contents));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(),
+                                 TFRecordIndexFilename(filename),
+                                 contents.substr(0, contents.size() - 8)));
+  EXPECT_THAT(
+      TFRecordIndex::Load(Env::Default(), TFRecordIndexFilename(filename)),
+      StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(ReadTFRecordsTest, ReadInAnyOrder) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTFRecordFile(filename, {"a", "bb", "ccc", "dddd", "e"}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::Load(Env::Default(), TFRecordIndexFilename(filename)));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CountingRandomAccessFile> file,
+                          OpenFile(filename));
+  EXPECT_THAT(ReadTFRecords(file.get(), *index, {3, 0, 4, 0, 2}),
+              IsOkAndHolds(ElementsAre("dddd", "a", "e", "a", "ccc")));
+  EXPECT_THAT(ReadTFRecords(file.get(), *index, {}),
+              IsOkAndHolds(ElementsAre()));
+}
+
+TEST(ReadTFRecordsTest, CoalesceNearbyRecords) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTFRecordFile(filename, {"a", "bb", "ccc", "dddd", "e"}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::Load(Env::Default(), TFRecordIndexFilename(filename)));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CountingRandomAccessFile> file,
+                          OpenFile(filename));
+  EXPECT_THAT(ReadTFRecords(file.get(), *index, {4, 1, 0}),
+              IsOkAndHolds(ElementsAre("e", "bb", "a")));
+  EXPECT_EQ(file->num_reads(), 1);
+}
+
+TEST(ReadTFRecordsTest, DoNotCoalesceDistantRecords) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTFRecordFile(filename, {"a", "bb", "ccc", "dddd", "e"}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::Load(Env::Default(), TFRecordIndexFilename(filename)));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CountingRandomAccessFile> file,
+                          OpenFile(filename));
+  TFRecordReadOptions options;
+  options.max_coalesced_gap = 0;
+  // Records 0 and 1 are adjacent. Record 4 is separated by records 2 and 3.
+  EXPECT_THAT(ReadTFRecords(file.get(), *index, {4, 1, 0}, options),
+              IsOkAndHolds(ElementsAre("e", "bb", "a")));
+  EXPECT_EQ(file->num_reads(), 2);
+}
+
+TEST(ReadTFRecordsTest, LimitCoalescedReadSize) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTFRecordFile(filename, {"a", "bb", "ccc", "dddd", "e"}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::Load(Env::Default(), TFRecordIndexFilename(filename)));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CountingRandomAccessFile> file,
+                          OpenFile(filename));
+  TFRecordReadOptions options;
+  options.max_coalesced_read_size = 1;
+  EXPECT_THAT(ReadTFRecords(file.get(), *index, {0, 1, 2, 3, 4}, options),
+              IsOkAndHolds(ElementsAre("a", "bb", "ccc", "dddd", "e")));
+  EXPECT_EQ(file->num_reads(), 5);
+}
+
+TEST(ReadTFRecordsTest, IndexOutOfRange) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTFRecordFile(filename, {"a", "bb"}));
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::Load(Env::Default(), TFRecordIndexFilename(filename)));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CountingRandomAccessFile> file,
+                          OpenFile(filename));
+  EXPECT_THAT(ReadTFRecords(file.get(), *index, {2}),
+              StatusIs(absl::StatusCode::kOutOfRange));
+  EXPECT_THAT(ReadTFRecords(file.get(), *index, {-1}),
+              StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+TEST(ReadTFRecordsTest, CorruptedRecord) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTFRecordFile(filename, {"a", "bb"}));
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  // Flips a byte of the data of the second record.
+  contents[17 + 12] = 'x';
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::Load(Env::Default(), TFRecordIndexFilename(filename)));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CountingRandomAccessFile> file,
+                          OpenFile(filename));
+  EXPECT_THAT(ReadTFRecords(file.get(), *index, {0}),
+              IsOkAndHolds(ElementsAre("a")));
+  EXPECT_THAT(ReadTFRecords(file.get(), *index, {1}),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(ReadTFRecordsTest, TruncatedFile) {
+  const std::string filename = TestFilename();
+  TF_ASSERT_OK(WriteTFRecordFile(filename, {"a", "bb"}));
+  std::string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 contents.substr(0, contents.size() - 1)));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TFRecordIndex> index,
+      TFRecordIndex::Load(Env::Default(), TFRecordIndexFilename(filename)));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CountingRandomAccessFile> file,
+                          OpenFile(filename));
+  EXPECT_THAT(ReadTFRecords(file.get(), *index, {1}),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
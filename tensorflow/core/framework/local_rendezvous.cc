@@ -15,9 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/framework/local_rendezvous.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/str_format.h"
 #include "tensorflow/core/activity_watcher/activity.h"
@@ -106,6 +108,44 @@ struct LocalRendezvous::Item {
   }
 };
 
+// The handoff point of the Send() and Recv() of the key of one slot. The
+// producer and the consumer each fill in their half of the slot, then publish
+// it with a compare-and-swap from kEmpty. The side that loses the race
+// completes the handoff, and so do aborts and cancellations, with a
+// compare-and-swap to kDone, so that the fields of the slot are only ever
+// accessed by the side that owns them.
+struct LocalRendezvous::Slot {
+  enum State { kEmpty = 0, kSent = 1, kWaiting = 2, kDone = 3 };
+
+  // Releases the message of a slot that was not received, returning the
+  // reference to the owner held by the producer.
+  tsl::core::RefCountPtr<Rendezvous> ReleaseSend() {
+    if (send_args.device_context) {
+      send_args.device_context->Unref();
+    }
+    send_args = Rendezvous::Args();
+    value = Tensor();
+    return std::move(send_rc_owner);
+  }
+
+  std::atomic<int> state{kEmpty};
+
+  // Owned by the producer until the slot is kSent.
+  Rendezvous::Args send_args;
+  Tensor value;
+  bool is_dead = false;
+  tsl::core::RefCountPtr<Rendezvous> send_rc_owner;
+
+  // Owned by the consumer until the slot is kWaiting.
+  Rendezvous::Args recv_args;
+  Rendezvous::DoneCallback waiter;
+  tsl::core::RefCountPtr<Rendezvous> recv_rc_owner;
+};
+
+struct LocalRendezvous::SlotChunk {
+  Slot slots[kSlotsPerChunk];
+};
+
 void LocalRendezvous::ItemQueue::push_back(Item* item) {
   if (TF_PREDICT_TRUE(head == nullptr)) {
     // The queue is empty.
@@ -135,21 +175,53 @@ LocalRendezvous::~LocalRendezvous() {
       table_not_empty = true;
     }
   }
-  if (table_not_empty) {
+  bool slots_pending = false;
+  for (auto& chunk_ptr : slot_chunks_) {
+    SlotChunk* chunk = chunk_ptr.load(std::memory_order_acquire);
+    if (chunk == nullptr) continue;
+    for (const Slot& slot : chunk->slots) {
+      const int state = slot.state.load();
+      if (state == Slot::kSent || state == Slot::kWaiting) {
+        slots_pending = true;
+      }
+    }
+  }
+  if (table_not_empty || slots_pending) {
     DoAbort(absl::CancelledError("LocalRendezvous deleted"));
   }
+  for (auto& chunk_ptr : slot_chunks_) {
+    delete chunk_ptr.load(std::memory_order_acquire);
+  }
 }
 
 namespace {
 uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
 }  // namespace
 
+LocalRendezvous::Slot* LocalRendezvous::GetSlot(
+    const Rendezvous::ParsedKey& key) {
+  if (key.slot < 0 || key.slot >= kSlotsPerChunk * kNumSlotChunks) {
+    return nullptr;
+  }
+  std::atomic<SlotChunk*>& chunk_ptr = slot_chunks_[key.slot / kSlotsPerChunk];
+  SlotChunk* chunk = chunk_ptr.load(std::memory_order_acquire);
+  if (TF_PREDICT_FALSE(chunk == nullptr)) {
+    SlotChunk* new_chunk = new SlotChunk;
+    if (chunk_ptr.compare_exchange_strong(chunk, new_chunk,
+                                          std::memory_order_acq_rel)) {
+      chunk = new_chunk;
+    } else {
+      // Another thread allocated the chunk first, and `chunk` now points to
+      // it.
+      delete new_chunk;
+    }
+  }
+  return &chunk->slots[key.slot % kSlotsPerChunk];
+}
+
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
-  uint64 key_hash = KeyHash(key.FullKey());
-  DVLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
-
   if (is_dead) {
     static auto* rendezvous_dead_values_sent = monitoring::Counter<2>::New(
         "/tensorflow/core/rendezvous_dead_values_sent",
@@ -160,6 +232,16 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
         ->IncrementBy(1);
   }
 
+  Slot* slot = GetSlot(key);
+  if (slot != nullptr) {
+    DVLOG(2) << "Send " << this << " slot " << key.slot << " "
+             << key.FullKey();
+    return SendToSlot(slot, send_args, val, is_dead);
+  }
+
+  uint64 key_hash = KeyHash(key.FullKey());
+  DVLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
+
   TF_RETURN_IF_ERROR(status());
 
   int bucket_index = key_hash % num_buckets_;
@@ -224,9 +306,62 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
   return absl::OkStatus();
 }
 
+Status LocalRendezvous::SendToSlot(Slot* slot,
+                                   const Rendezvous::Args& send_args,
+                                   const Tensor& val, const bool is_dead) {
+  if (TF_PREDICT_FALSE(aborted_.load())) {
+    return status();
+  }
+
+  int state = slot->state.load();
+  if (state == Slot::kEmpty) {
+    // There is no waiter for this message yet. Publish the message, the waiter
+    // will pick it up when it arrives.
+    slot->send_args = send_args;
+    if (send_args.device_context) {
+      send_args.device_context->Ref();
+    }
+    slot->value = val;
+    slot->is_dead = is_dead;
+    slot->send_rc_owner = tsl::core::GetNewRef(rc_owner_);
+    if (slot->state.compare_exchange_strong(state, Slot::kSent)) {
+      AbortSlotIfAborted(slot);
+      return absl::OkStatus();
+    }
+    // The waiter arrived in the meantime, and `state` is now kWaiting.
+    slot->ReleaseSend();
+  }
+
+  if (state == Slot::kWaiting &&
+      slot->state.compare_exchange_strong(state, Slot::kDone)) {
+    // Invoke the waiter, then release its reference to the owner at last
+    // since it may destruct the rendezvous.
+    tsl::core::RefCountPtr<Rendezvous> rc_owner =
+        std::move(slot->recv_rc_owner);
+    Rendezvous::DoneCallback waiter = std::move(slot->waiter);
+    slot->waiter = nullptr;
+    waiter(absl::OkStatus(), send_args, slot->recv_args, val, is_dead);
+    return absl::OkStatus();
+  }
+
+  if (state == Slot::kSent) {
+    return errors::Internal("Send of an already sent rendezvous slot.");
+  }
+  // The waiter was cancelled or the rendezvous aborted.
+  return status();
+}
+
 void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                                 const Rendezvous::Args& recv_args,
                                 Rendezvous::DoneCallback done) {
+  Slot* slot = GetSlot(key);
+  if (slot != nullptr) {
+    DVLOG(2) << "Recv " << this << " slot " << key.slot << " "
+             << key.FullKey();
+    RecvFromSlot(slot, recv_args, std::move(done));
+    return;
+  }
+
   uint64 key_hash = KeyHash(key.FullKey());
   DVLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
   tsl::core::RefCountPtr<Rendezvous> rc_keep_alive;
@@ -381,6 +516,120 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   delete item;
 }
 
+void LocalRendezvous::RecvFromSlot(Slot* slot,
+                                   const Rendezvous::Args& recv_args,
+                                   Rendezvous::DoneCallback done) {
+  if (TF_PREDICT_FALSE(aborted_.load())) {
+    done(status(), Rendezvous::Args(), recv_args, Tensor(), false);
+    return;
+  }
+
+  int state = slot->state.load();
+  if (state == Slot::kEmpty) {
+    // There is no message to pick up yet. Publish the waiter, the message
+    // will be handed to it when it arrives.
+    CancellationManager* cm = recv_args.cancellation_manager;
+    auto cancel = [slot]() {
+      int expected = Slot::kWaiting;
+      if (slot->state.compare_exchange_strong(expected, Slot::kDone)) {
+        tsl::core::RefCountPtr<Rendezvous> rc_owner =
+            std::move(slot->recv_rc_owner);
+        Rendezvous::DoneCallback waiter = std::move(slot->waiter);
+        slot->waiter = nullptr;
+        waiter(StatusGroup::MakeDerived(
+                   errors::Cancelled("RecvAsync is cancelled.")),
+               Rendezvous::Args(), slot->recv_args, Tensor(),
+               /*is_dead=*/false);
+      }
+    };
+    if (cm != nullptr) {
+      CancellationToken token = cm->get_cancellation_token();
+      if (!cm->RegisterCallback(token, cancel)) {
+        done(StatusGroup::MakeDerived(
+                 errors::Cancelled("RecvAsync is cancelled.")),
+             Rendezvous::Args(), recv_args, Tensor(), /*is_dead=*/false);
+        return;
+      }
+      // As for the hashed keys, the cancellation callback must be
+      // deregistered before calling `done`.
+      slot->waiter = [cm, token, done = std::move(done)](
+                         const Status& s, const Rendezvous::Args& send_args,
+                         const Rendezvous::Args& recv_args, const Tensor& v,
+                         bool dead) {
+        if (cm->TryDeregisterCallback(token)) {
+          // Ignore the return value.
+        }
+        done(s, send_args, recv_args, v, dead);
+      };
+    } else {
+      slot->waiter = std::move(done);
+    }
+    slot->recv_args = recv_args;
+    slot->recv_rc_owner = tsl::core::GetNewRef(rc_owner_);
+    if (slot->state.compare_exchange_strong(state, Slot::kWaiting)) {
+      // The cancellation callback does nothing if it runs before the waiter
+      // is published, so check for a cancellation that raced with it.
+      if (cm != nullptr && cm->IsCancelled()) {
+        cancel();
+      }
+      AbortSlotIfAborted(slot);
+      return;
+    }
+    // The message arrived in the meantime, and `state` is now kSent.
+    done = std::move(slot->waiter);
+    slot->waiter = nullptr;
+    slot->recv_rc_owner.reset();
+  }
+
+  if (state == Slot::kSent &&
+      slot->state.compare_exchange_strong(state, Slot::kDone)) {
+    // Invoke the done-callback, then release the message and the reference
+    // of the producer to the owner at last since it may destruct the
+    // rendezvous.
+    const Rendezvous::Args send_args = slot->send_args;
+    slot->send_args = Rendezvous::Args();
+    const Tensor value = std::move(slot->value);
+    slot->value = Tensor();
+    tsl::core::RefCountPtr<Rendezvous> rc_owner =
+        std::move(slot->send_rc_owner);
+    done(absl::OkStatus(), send_args, recv_args, value, slot->is_dead);
+    if (send_args.device_context) {
+      send_args.device_context->Unref();
+    }
+    return;
+  }
+
+  absl::Status s = status();
+  if (s.ok()) {
+    s = errors::Internal("RecvAsync of an already received rendezvous slot.");
+  }
+  done(s, Rendezvous::Args(), recv_args, Tensor(), false);
+}
+
+void LocalRendezvous::AbortSlot(
+    Slot* slot, const absl::Status& status,
+    std::vector<tsl::core::RefCountPtr<Rendezvous>>* owners) {
+  int state = slot->state.load();
+  if (state == Slot::kWaiting &&
+      slot->state.compare_exchange_strong(state, Slot::kDone)) {
+    owners->push_back(std::move(slot->recv_rc_owner));
+    Rendezvous::DoneCallback waiter = std::move(slot->waiter);
+    slot->waiter = nullptr;
+    waiter(status, Rendezvous::Args(), Rendezvous::Args(), Tensor(), false);
+  } else if (state == Slot::kSent &&
+             slot->state.compare_exchange_strong(state, Slot::kDone)) {
+    owners->push_back(slot->ReleaseSend());
+  }
+}
+
+void LocalRendezvous::AbortSlotIfAborted(Slot* slot) {
+  // `aborted_` is set before DoAbort() scans the slots, so either the scan
+  // sees the published slot or this sees the abort.
+  if (TF_PREDICT_TRUE(!aborted_.load())) return;
+  std::vector<tsl::core::RefCountPtr<Rendezvous>> owners;
+  AbortSlot(slot, status(), &owners);
+}
+
 mutex& LocalRendezvous::aborted_rendezs_mu_ = *new mutex();
 
 std::vector<tsl::core::RefCountPtr<Rendezvous> >&
@@ -401,10 +650,22 @@ void LocalRendezvous::DoAbort(const Status& status) {
   {
     mutex_lock l(mu_);
     status_.Update(status);
+    aborted_.store(true);
   }
   LOG_EVERY_POW_2(INFO) << "Local rendezvous is aborting with status: "
                         << status;
 
+  // Keeps the references to the owner of the aborted slots to make sure the
+  // current rendezvous won't be destructed.
+  std::vector<tsl::core::RefCountPtr<Rendezvous>> owners;
+  for (auto& chunk_ptr : slot_chunks_) {
+    SlotChunk* chunk = chunk_ptr.load(std::memory_order_acquire);
+    if (chunk == nullptr) continue;
+    for (Slot& slot : chunk->slots) {
+      AbortSlot(&slot, status, &owners);
+    }
+  }
+
   // Keeps one Item to make sure the current rendezvous won't be destructed.
   std::unique_ptr<Item> to_delete;
   for (int i = 0; i < num_buckets_; ++i) {
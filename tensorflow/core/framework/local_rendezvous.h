@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -33,6 +35,10 @@ namespace tensorflow {
 // Implements the basic logic of matching Send and Recv operations. See
 // RendezvousInterface for more details.
 //
+// Keys with a non-negative `slot`, assigned by the graph partitioner, are
+// matched through an array of single-producer single-consumer slots with an
+// atomic handoff instead of the hashed table, so they do not take any lock.
+//
 // NOTE: Most users will use a class that wraps LocalRendezvous, such as
 // IntraProcessRendezvous or RemoteRendezvous. This class does not implement
 // RendezvousInterface because virtual dispatch to LocalRendezvous methods
@@ -70,6 +76,29 @@ class LocalRendezvous {
   tsl::core::RefCountPtr<Rendezvous> GetOwnerRefCountPtr();
 
   struct Item;
+  struct Slot;
+  struct SlotChunk;
+
+  // The slots are allocated lazily in chunks, so that a rendezvous only pays
+  // for the slots of the edges it is used for. Keys with a slot beyond
+  // `kSlotsPerChunk * kNumSlotChunks` fall back to the hashed table.
+  static constexpr int64_t kSlotsPerChunk = 64;
+  static constexpr int64_t kNumSlotChunks = 256;
+
+  // Returns the slot of `key`, or nullptr if it has none.
+  Slot* GetSlot(const Rendezvous::ParsedKey& key);
+  absl::Status SendToSlot(Slot* slot, const Rendezvous::Args& send_args,
+                          const Tensor& val, bool is_dead);
+  void RecvFromSlot(Slot* slot, const Rendezvous::Args& recv_args,
+                    Rendezvous::DoneCallback done);
+  // Completes the pending Send or Recv of `slot`, if any, with `status`. The
+  // references to the owner held by the slot are moved to `owners`, to be
+  // released by the caller when it is done with the rendezvous.
+  static void AbortSlot(
+      Slot* slot, const absl::Status& status,
+      std::vector<tsl::core::RefCountPtr<Rendezvous>>* owners);
+  // Aborts `slot` if the rendezvous was aborted after it was published.
+  void AbortSlotIfAborted(Slot* slot);
 
   // By invariant, the item queue under each key is of the form
   //   [item.type == kSend]* meaning each item is a sent message.
@@ -102,6 +131,11 @@ class LocalRendezvous {
   const std::unique_ptr<TableBucket[]> table_buckets_;
   mutex mu_;
   absl::Status status_ TF_GUARDED_BY(mu_);
+  // Set when `status_` becomes an error, so that the slots can check it
+  // without locking `mu_`.
+  std::atomic<bool> aborted_{false};
+
+  std::atomic<SlotChunk*> slot_chunks_[kNumSlotChunks] = {};
 
   // We deliberately leak one reference of the aborted rendezvous here, so that
   // they won't be destructed, and lose the status_.
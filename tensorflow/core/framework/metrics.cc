@@ -225,6 +225,18 @@ auto* tf_data_service_cross_trainer_cache_size_bytes =
         "/tensorflow/data/service/cross_trainer_cache_size_bytes",
         "tf.data service cross-trainer cache memory usage in bytes.");
 
+auto* tf_data_service_cross_trainer_cache_tier_queries_counter =
+    tsl::monitoring::Counter<1>::New(
+        "/tensorflow/data/service/cross_trainer_cache_tier_queries",
+        "tf.data service cross-trainer cache queries counter by the tier which "
+        "served the element. The tier can be memory or disk.",
+        "tier");
+
+auto* tf_data_service_cross_trainer_cache_disk_size_bytes =
+    tsl::monitoring::Gauge<int64_t, 0>::New(
+        "/tensorflow/data/service/cross_trainer_cache_disk_size_bytes",
+        "tf.data service cross-trainer cache disk usage in bytes.");
+
 auto* tf_data_service_snapshot_bytes_committed =
     tsl::monitoring::Counter<0>::New(
         "/tensorflow/data/service/snapshot_bytes_committed",
@@ -372,6 +384,19 @@ auto* build_graph_time_usecs = tsl::monitoring::Counter<0>::New(
     "spent optimizing the graph with Grappler, and time spent pruning the "
     "sub-graph.");
 
+auto* session_executor_cache_queries = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/session_executor_cache_queries",
+    "The number of lookups of the executors of a DirectSession::Run() "
+    "signature. The result can be hit or miss.",
+    "cache_hit");
+
+auto* session_executors_creation_time_usecs =
+    tsl::monitoring::Counter<0>::New(
+        "/tensorflow/core/session_executors_creation_time_usecs",
+        "The amount of time TensorFlow has spent creating the executors of "
+        "DirectSession::Run() signatures, in microseconds. It includes the "
+        "time spent building the client graph.");
+
 auto* function_graph_optimization_time_usecs = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/function_graph_optimization_time_usecs",
     "The amount of time TensorFlow has spent optimizing function graphs, in "
@@ -481,6 +506,8 @@ std::string GraphOptimizationSourceMapping(GraphOptimizationSource source) {
       return "jit";
     case GraphOptimizationSource::kAot:
       return "aot";
+    case GraphOptimizationSource::kGrappler:
+      return "grappler";
     case GraphOptimizationSource::kUnknown:
       return "unknown";
     default:
@@ -675,6 +702,16 @@ void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes) {
       static_cast<int64_t>(bytes));
 }
 
+void RecordTFDataServiceCrossTrainerCacheTierQuery(const std::string& tier) {
+  tf_data_service_cross_trainer_cache_tier_queries_counter->GetCell(tier)
+      ->IncrementBy(1);
+}
+
+void RecordTFDataServiceCrossTrainerCacheDiskSizeBytes(size_t bytes) {
+  tf_data_service_cross_trainer_cache_disk_size_bytes->GetCell()->Set(
+      static_cast<int64_t>(bytes));
+}
+
 void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes) {
   tf_data_service_snapshot_bytes_committed->GetCell()->IncrementBy(bytes);
 }
@@ -825,6 +862,25 @@ void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   }
 }
 
+void RecordSessionExecutorCacheQuery(bool cache_hit) {
+  session_executor_cache_queries->GetCell(cache_hit ? "true" : "false")
+      ->IncrementBy(1);
+}
+
+int64_t GetSessionExecutorCacheQueryCount(bool cache_hit) {
+  return session_executor_cache_queries->GetCell(cache_hit ? "true" : "false")
+      ->value();
+}
+
+void UpdateSessionExecutorsCreationTime(const uint64 running_time_usecs) {
+  if (running_time_usecs > 0) {
+    static auto* session_executors_creation_time_usecs_cell =
+        session_executors_creation_time_usecs->GetCell();
+    session_executors_creation_time_usecs_cell->IncrementBy(
+        running_time_usecs);
+  }
+}
+
 void UpdateFunctionGraphOptimizationTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* function_graph_optimization_time_usecs_cell =
@@ -838,10 +894,8 @@ void UpdateFunctionGraphOptimizationSavingTime(const uint64 saving_time_usecs,
                                                GraphOptimizationSource source) {
   if (saving_time_usecs > 0) {
     std::string mapped_source = GraphOptimizationSourceMapping(source);
-    static auto* function_graph_optimization_saving_time_usecs_cell =
-        graph_optimization_saving_time_usecs->GetCell(mapped_source);
-    function_graph_optimization_saving_time_usecs_cell->IncrementBy(
-        saving_time_usecs);
+    graph_optimization_saving_time_usecs->GetCell(mapped_source)
+        ->IncrementBy(saving_time_usecs);
   }
 }
 
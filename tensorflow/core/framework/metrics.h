@@ -34,6 +34,8 @@ enum class GraphOptimizationSource {
   kUnknown,
   kJit,
   kAot,
+  // The persistent cache of graphs optimized by Grappler.
+  kGrappler,
 };
 
 // Records when a data-fetching tf.data operation is executed.
@@ -182,6 +184,13 @@ void RecordTFDataServiceCrossTrainerCacheQuery(bool cache_hit);
 // Records tf.data service cross-trainer cache memory usage in bytes.
 void RecordTFDataServiceCrossTrainerCacheSizeBytes(size_t bytes);
 
+// Records the tier ("memory" or "disk") of the tf.data service cross-trainer
+// cache which served an element.
+void RecordTFDataServiceCrossTrainerCacheTierQuery(const std::string& tier);
+
+// Records tf.data service cross-trainer cache disk usage in bytes.
+void RecordTFDataServiceCrossTrainerCacheDiskSizeBytes(size_t bytes);
+
 // Records tf.data distributed snapshot bytes committed.
 void RecordTFDataServiceSnapshotBytesCommitted(int64_t bytes);
 
@@ -297,6 +306,18 @@ void UpdateAotBefMlirLoadCount();
 // TODO(jtkeeling): Should we record building/optimizing tf.functions?
 void UpdateGraphBuildTime(const uint64 running_time_usecs);
 
+// Records a lookup of the executors of a DirectSession::Run() signature in
+// the executor cache of the session.
+void RecordSessionExecutorCacheQuery(bool cache_hit);
+
+// Returns the number of lookups recorded by RecordSessionExecutorCacheQuery()
+// with `cache_hit`.
+int64_t GetSessionExecutorCacheQueryCount(bool cache_hit);
+
+// Updates the metric stored for time spent creating the executors of a
+// DirectSession::Run() signature after a miss of the executor cache.
+void UpdateSessionExecutorsCreationTime(uint64 running_time_usecs);
+
 // Updates the metric stored for time spent optimizing function graphs.
 void UpdateFunctionGraphOptimizationTime(const uint64 running_time_usecs);
 
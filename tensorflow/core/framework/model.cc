@@ -64,6 +64,19 @@ constexpr double kBufferDownsizeMultipliter = 0.9;
 // Threshold of low buffer watermark before a buffer is a candidate for
 // upsizing.
 constexpr int64_t kBufferLowWatermarkThreshold = 2;
+// Minimum number of elements a node needs to produce between two optimization
+// rounds for its processing time to be used as a learned cost observation.
+constexpr int64_t kLearnedCostMinElements = 10;
+// Learned cost optimization only takes a step if it improves the stage time by
+// at least this fraction.
+constexpr double kLearnedCostMinStepImprovement = 0.01;
+// Learned cost optimization only replaces the current parameter values if the
+// new values are predicted to improve the pipeline time by at least this
+// fraction. This avoids oscillating between similarly good configurations.
+constexpr double kLearnedCostMinImprovement = 0.05;
+// The predicted per-element processing time of a learned cost curve is never
+// less than this fraction of the mean observed processing time.
+constexpr double kLearnedCostMinElementTimeFraction = 0.1;
 
 constexpr char kDataService[] = "DataService";
 constexpr char kFlatMap[] = "FlatMap";
@@ -2255,6 +2268,47 @@ Status Node::FromProto(ModelProto::Node node_proto,
   return FromProtoHelper(node_proto, *node);
 }
 
+void ParallelismCostCurve::AddObservation(double parallelism,
+                                          double element_time_nsec) {
+  if (parallelism <= 0 || element_time_nsec < 0) {
+    return;
+  }
+  sum_weights_ = sum_weights_ * kDecay + 1.0;
+  sum_x_ = sum_x_ * kDecay + parallelism;
+  sum_y_ = sum_y_ * kDecay + element_time_nsec;
+  sum_xx_ = sum_xx_ * kDecay + parallelism * parallelism;
+  sum_xy_ = sum_xy_ * kDecay + parallelism * element_time_nsec;
+  min_parallelism_ = std::min(min_parallelism_, parallelism);
+  max_parallelism_ = std::max(max_parallelism_, parallelism);
+}
+
+double ParallelismCostCurve::ElementTimeNsec(double parallelism) const {
+  if (sum_weights_ <= 0) {
+    return 0.0;
+  }
+  const double mean_x = sum_x_ / sum_weights_;
+  const double mean_y = sum_y_ / sum_weights_;
+  const double variance_x = sum_xx_ / sum_weights_ - mean_x * mean_x;
+  if (!fitted() || variance_x <= 0) {
+    return mean_y;
+  }
+  const double slope = (sum_xy_ / sum_weights_ - mean_x * mean_y) / variance_x;
+  const double intercept = mean_y - slope * mean_x;
+  return std::max(intercept + slope * parallelism,
+                  mean_y * kLearnedCostMinElementTimeFraction);
+}
+
+double ParallelismCostCurve::Scale(double from, double to) const {
+  if (!fitted()) {
+    return 1.0;
+  }
+  const double from_time_nsec = ElementTimeNsec(from);
+  if (from_time_nsec <= 0) {
+    return 1.0;
+  }
+  return ElementTimeNsec(to) / from_time_nsec;
+}
+
 Model::Model(std::optional<std::string> dataset_name)
     : dataset_name_(std::move(dataset_name)),
       optimization_period_ms_(kOptimizationPeriodMinMs),
@@ -2403,6 +2457,10 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
       OptimizeStageBased(snapshot, optimization_params, cancellation_manager,
                          ram_budget_manager);
       break;
+    case AutotuneAlgorithm::LEARNED_COST:
+      OptimizeLearnedCost(snapshot, optimization_params, cancellation_manager,
+                          ram_budget_manager);
+      break;
     default:
       VLOG(2) << "Autotuning algorithm was not recognized. Aborting "
                  "optimization.";
@@ -2574,10 +2632,11 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm,
     int64_t start_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     double model_input_time = 0.0;
     // Model input time is set to 0 for all optimization algorithms except for
-    // stage-based optimization algorithm for historical reason. In stage-based
-    // optimization algorithm, the model input time is used as a target
+    // stage-based and learned cost optimization algorithms for historical
+    // reason. In these algorithms, the model input time is used as a target
     // optimization time of all stages in the pipeline.
-    if (algorithm == AutotuneAlgorithm::STAGE_BASED) {
+    if (algorithm == AutotuneAlgorithm::STAGE_BASED ||
+        algorithm == AutotuneAlgorithm::LEARNED_COST) {
       model_input_time = ComputeTargetTimeNsec();
     }
     Optimize(algorithm, cpu_budget_func, ram_budget_share, fixed_ram_budget,
@@ -3020,6 +3079,266 @@ void Model::OptimizeStageBasedNonAsyncInterleaveManyNodes(
   }
 }
 
+void Model::OptimizeLearnedCost(
+    std::shared_ptr<Node> snapshot,
+    const OptimizationParams& optimization_params,
+    CancellationManager* cancellation_manager,
+    RamBudgetManager& ram_budget_manager) {
+  VLOG(2) << "Starting optimization of tunable parameters with learned cost "
+             "optimization with a target time of "
+          << optimization_params.model_input_time() << " nanoseconds.";
+  UpdateLearnedCosts(snapshot);
+  Node::NodeVector all_nodes =
+      snapshot->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+  all_nodes.push_back(snapshot);
+  Node::ModelParameters tunable_parameters;
+  absl::flat_hash_map<const Node*, Parameter*> node_buffer_size;
+  for (const auto& node : all_nodes) {
+    Node::ModelParameters node_tunable_parameters =
+        node->CollectNodeTunableParameters();
+    for (const auto& pair : node_tunable_parameters) {
+      if (pair.second->name == kBufferSize) {
+        node_buffer_size[node.get()] = pair.second.get();
+      }
+    }
+    tunable_parameters.insert(tunable_parameters.end(),
+                              node_tunable_parameters.begin(),
+                              node_tunable_parameters.end());
+  }
+  if (tunable_parameters.empty()) {
+    VLOG(2) << "There are no tunable parameters.";
+    return;
+  }
+  NodeParallelismParameters node_parallelism;
+  auto pipeline_time_nsec = [this, &node_parallelism](
+                                const ModelTiming& model_timing) {
+    double result = 0.0;
+    for (const auto& root : model_timing.GetStageRoots()) {
+      result = std::max(
+          result, LearnedStageTimeNsec(model_timing, root.get(),
+                                       node_parallelism.Get(root.get())));
+    }
+    return result;
+  };
+  auto total_parallelism = [&tunable_parameters]() {
+    double result = 0.0;
+    for (const auto& pair : tunable_parameters) {
+      if (pair.second->name == kParallelism) {
+        result += pair.second->value;
+      }
+    }
+    return result;
+  };
+
+  // Start from the parameter values currently used by the input pipeline and
+  // remember them so that they can be kept if the new ones are not
+  // significantly better.
+  std::vector<double> current_values;
+  current_values.reserve(tunable_parameters.size());
+  for (auto& pair : tunable_parameters) {
+    Parameter* parameter = pair.second.get();
+    double state_value;
+    {
+      tf_shared_lock l(*parameter->state->mu);
+      state_value = parameter->state->value;
+    }
+    parameter->value = std::clamp(state_value, parameter->min, parameter->max);
+    current_values.push_back(parameter->value);
+  }
+  const double current_time_nsec = pipeline_time_nsec(ModelTiming(snapshot));
+  const double current_total_parallelism = total_parallelism();
+
+  // Initialize the parallelism and buffer size parameter values to minimal
+  // before tuning.
+  for (auto& pair : tunable_parameters) {
+    if (pair.second->name == kParallelism ||
+        pair.second->name == kBufferSize) {
+      pair.second->value = pair.second->min;
+    }
+  }
+  ModelTiming model_timing(snapshot);
+  double parallelism_used = total_parallelism();
+  const double target_time_nsec = optimization_params.model_input_time();
+  while (!cancellation_manager->IsCancelled()) {
+    Node* critical_root = nullptr;
+    double critical_time_nsec = -1.0;
+    for (const auto& root : model_timing.GetStageRoots()) {
+      const double stage_time_nsec = LearnedStageTimeNsec(
+          model_timing, root.get(), node_parallelism.Get(root.get()));
+      if (stage_time_nsec > critical_time_nsec) {
+        critical_time_nsec = stage_time_nsec;
+        critical_root = root.get();
+      }
+    }
+    if (critical_root == nullptr || critical_time_nsec <= target_time_nsec) {
+      break;
+    }
+    Parameter* parallelism = node_parallelism.Get(critical_root);
+    // Removes the `<index>` of `[<index>]` to reduce the number of labels.
+    const std::string critical_root_name =
+        RemoveArrayIndices(critical_root->long_name());
+    if (parallelism == nullptr) {
+      metrics::RecordTFDataAutotuneStoppingCriteria(
+          strings::StrCat("no_optimizable_parameter:", critical_root_name));
+      break;
+    }
+    if (parallelism->value >= parallelism->max) {
+      metrics::RecordTFDataAutotuneStoppingCriteria(
+          strings::StrCat("parameter_max_exceeded:", critical_root_name));
+      break;
+    }
+    if (parallelism_used + 1.0 > optimization_params.cpu_budget()) {
+      metrics::RecordTFDataAutotuneStoppingCriteria(
+          strings::StrCat("cpu_budget_exceeded:", critical_root_name));
+      break;
+    }
+    // Grow the buffer of the node together with its parallelism so that all
+    // parallel calls can make progress without waiting for the consumer.
+    Parameter* buffer_size = gtl::FindPtrOrNull(node_buffer_size, critical_root);
+    const double old_buffer_size =
+        buffer_size == nullptr ? 0.0 : buffer_size->value;
+    parallelism->value += 1.0;
+    if (buffer_size != nullptr && buffer_size->value < parallelism->value) {
+      buffer_size->value = std::min(buffer_size->max, parallelism->value);
+    }
+    auto take_step_back = [&]() {
+      parallelism->value -= 1.0;
+      if (buffer_size != nullptr) {
+        buffer_size->value = old_buffer_size;
+      }
+      model_timing.ComputeNodeTotalTime(*critical_root);
+    };
+    if (TotalMaximumBufferedBytes(snapshot) >
+        optimization_params.ram_budget()) {
+      take_step_back();
+      metrics::RecordTFDataAutotuneStoppingCriteria(
+          strings::StrCat("ram_budget_exceeded:", critical_root_name));
+      break;
+    }
+    model_timing.ComputeNodeTotalTime(*critical_root);
+    if (LearnedStageTimeNsec(model_timing, critical_root, parallelism) >
+        critical_time_nsec * (1.0 - kLearnedCostMinStepImprovement)) {
+      take_step_back();
+      metrics::RecordTFDataAutotuneStoppingCriteria(
+          strings::StrCat("total_time_not_improved:", critical_root_name));
+      break;
+    }
+    parallelism_used += 1.0;
+  }
+
+  const double new_time_nsec = pipeline_time_nsec(model_timing);
+  if (new_time_nsec > current_time_nsec * (1.0 - kLearnedCostMinImprovement)) {
+    std::vector<double> new_values;
+    new_values.reserve(tunable_parameters.size());
+    for (size_t i = 0; i < tunable_parameters.size(); ++i) {
+      new_values.push_back(tunable_parameters[i].second->value);
+      tunable_parameters[i].second->value = current_values[i];
+    }
+    if (current_total_parallelism <= optimization_params.cpu_budget() &&
+        TotalMaximumBufferedBytes(snapshot) <=
+            optimization_params.ram_budget()) {
+      VLOG(2) << "Keeping the current parameter values because the predicted "
+                 "time "
+              << new_time_nsec << " does not improve on " << current_time_nsec
+              << " nanoseconds.";
+      metrics::RecordTFDataAutotuneStoppingCriteria("learned_cost_no_gain");
+      return;
+    }
+    for (size_t i = 0; i < tunable_parameters.size(); ++i) {
+      tunable_parameters[i].second->value = new_values[i];
+    }
+  }
+  if (ram_budget_manager.RequestModelAllocation(
+          TotalMaximumBufferedBytes(snapshot))) {
+    UpdateStateValues(&tunable_parameters);
+  }
+}
+
+void Model::UpdateLearnedCosts(std::shared_ptr<Node> snapshot) {
+  Node::NodeVector nodes =
+      snapshot->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+  nodes.push_back(snapshot);
+  NodeParallelismParameters node_parallelism;
+  absl::flat_hash_set<int64_t> node_ids;
+  node_ids.reserve(nodes.size());
+  for (const auto& node : nodes) node_ids.insert(node->id());
+
+  mutex_lock l(learned_costs_mu_);
+  // Nodes are removed from the model when their iterators are destroyed, so
+  // their costs are dropped to keep the state bounded by the live pipeline.
+  absl::erase_if(learned_costs_, [&node_ids](const auto& entry) {
+    return !node_ids.contains(entry.first);
+  });
+  for (const auto& node : nodes) {
+    Parameter* parallelism = node_parallelism.Get(node.get());
+    if (parallelism == nullptr || parallelism->state == nullptr) {
+      continue;
+    }
+    double parallelism_value;
+    {
+      tf_shared_lock state_lock(*parallelism->state->mu);
+      parallelism_value = parallelism->state->value;
+    }
+    if (parallelism_value <= 0) {
+      continue;
+    }
+    const int64_t num_elements = node->num_elements();
+    const int64_t processing_time = node->processing_time();
+    LearnedNodeCost& cost = learned_costs_[node->id()];
+    const int64_t delta_elements = num_elements - cost.last_num_elements;
+    const int64_t delta_processing_time =
+        processing_time - cost.last_processing_time;
+    // Only use the interval as an observation if the node ran with the same
+    // parallelism during the whole interval.
+    if (delta_elements >= kLearnedCostMinElements &&
+        delta_processing_time >= 0 &&
+        parallelism_value == cost.last_parallelism) {
+      cost.curve.AddObservation(parallelism_value,
+                                static_cast<double>(delta_processing_time) /
+                                    static_cast<double>(delta_elements));
+    }
+    if (delta_elements >= kLearnedCostMinElements || delta_elements < 0 ||
+        parallelism_value != cost.last_parallelism) {
+      cost.last_num_elements = num_elements;
+      cost.last_processing_time = processing_time;
+      cost.last_parallelism = parallelism_value;
+    }
+  }
+}
+
+double Model::LearnedStageTimeNsec(const ModelTiming& model_timing,
+                                   const Node* stage_root,
+                                   const Parameter* parallelism) {
+  const ModelTiming::NodeTiming* timing = model_timing.GetTiming(stage_root);
+  if (timing == nullptr) {
+    return 0.0;
+  }
+  double total_time_nsec = timing->total_time_nsec;
+  if (parallelism != nullptr && parallelism->state != nullptr) {
+    // The self time of the node is derived from processing times measured at
+    // the parallelism currently in effect, so the curve is used to scale it to
+    // the parallelism being evaluated.
+    double observed_parallelism;
+    {
+      tf_shared_lock l(*parallelism->state->mu);
+      observed_parallelism = parallelism->state->value;
+    }
+    if (observed_parallelism > 0) {
+      double scale = 1.0;
+      {
+        tf_shared_lock l(learned_costs_mu_);
+        auto it = learned_costs_.find(stage_root->id());
+        if (it != learned_costs_.end()) {
+          scale = it->second.curve.Scale(observed_parallelism,
+                                         parallelism->value);
+        }
+      }
+      total_time_nsec += timing->self_time_nsec * (scale - 1.0);
+    }
+  }
+  return total_time_nsec * timing->pipeline_ratio;
+}
+
 void Model::OptimizeBuffers(std::shared_ptr<Node> snapshot,
                             int64_t ram_budget) {
   VLOG(2) << "Starting optimization of buffer_size parameters.";
@@ -915,6 +915,46 @@ std::shared_ptr<Node> MakeAsyncUnknownRatioNode(
 // as pass-through between inputs and output.
 std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 
+// Online estimate of how the per-element processing time of a node changes with
+// its parallelism. The analytic model assumes that the per-element processing
+// time is independent of parallelism, which does not hold when parallel calls
+// contend for shared resources (e.g. interleave and map nodes sharing the same
+// threads). The curve is fitted with exponentially decayed least squares to
+// `processing_time(p) = intercept + slope * p` from observations collected
+// between optimization rounds.
+class ParallelismCostCurve {
+ public:
+  // Records that the node spent `element_time_nsec` processing time per
+  // element while running with the given `parallelism`.
+  void AddObservation(double parallelism, double element_time_nsec);
+
+  // Returns true if the observations cover at least two distinct parallelism
+  // values, which is required to estimate the slope of the curve.
+  bool fitted() const { return min_parallelism_ < max_parallelism_; }
+
+  // Returns the ratio between the per-element processing time predicted at
+  // parallelism `to` and at parallelism `from`. Returns 1.0 if the curve has
+  // not been fitted yet.
+  double Scale(double from, double to) const;
+
+  // Returns the predicted per-element processing time at `parallelism`.
+  double ElementTimeNsec(double parallelism) const;
+
+ private:
+  // Weight of the older observations when a new observation is added.
+  static constexpr double kDecay = 0.9;
+
+  double sum_weights_ = 0.0;
+  double sum_x_ = 0.0;
+  double sum_y_ = 0.0;
+  double sum_xx_ = 0.0;
+  double sum_xy_ = 0.0;
+  double min_parallelism_ = std::numeric_limits<double>::max();
+  double max_parallelism_ = std::numeric_limits<double>::lowest();
+};
+
+class ModelTiming;
+
 // Abstract representation of a TensorFlow input pipeline that can be used
 // for collecting runtime information and optimizing performance. It collects
 // runtime information about execution of the input pipeline that is used to
@@ -1025,9 +1065,9 @@ class Model {
   // Records gap time between consecutive `GetNext()` calls.
   void RecordIteratorGapTime(uint64_t duration_usec);
 
-  // Computes the target time in nsecs to use for `STAGE_BASED` autotune
-  // algorithm. Returns 0 if there if there are not sufficient recorded iterator
-  // gap times to produce a good estimate.
+  // Computes the target time in nsecs to use for `STAGE_BASED` and
+  // `LEARNED_COST` autotune algorithms. Returns 0 if there are not sufficient
+  // recorded iterator gap times to produce a good estimate.
   double ComputeTargetTimeNsec();
 
   // Computes the target time in nsecs to use for estimating input bottlenecks.
@@ -1150,6 +1190,33 @@ class Model {
       CancellationManager* cancellation_manager,
       RamBudgetManager& ram_budget_manager);
 
+  // This optimization jointly tunes the parallelism and buffer sizes of async
+  // nodes. Similar to the stage-based optimization, it repeatedly increases the
+  // parallelism of the slowest stage, but the stage time is corrected by the
+  // `ParallelismCostCurve` learned from the metrics of previous rounds, the
+  // total parallelism is capped by the CPU budget, and the buffer size of the
+  // node is grown together with its parallelism as long as the RAM budget
+  // allows. New parameter values are only applied if they are predicted to
+  // improve on the current ones by a margin, which avoids oscillation.
+  void OptimizeLearnedCost(std::shared_ptr<Node> snapshot,
+                           const OptimizationParams& optimization_params,
+                           CancellationManager* cancellation_manager,
+                           RamBudgetManager& ram_budget_manager);
+
+  // Records the per-element processing time observed since the previous round
+  // for all nodes in `snapshot` that have a `parallelism` parameter, and drops
+  // the learned costs of the nodes that are no longer in the model.
+  void UpdateLearnedCosts(std::shared_ptr<Node> snapshot)
+      TF_LOCKS_EXCLUDED(learned_costs_mu_);
+
+  // Returns the time it takes the stage rooted at `stage_root` to produce an
+  // element at the root of the pipeline, corrected by the learned cost curve of
+  // the stage root.
+  double LearnedStageTimeNsec(const ModelTiming& model_timing,
+                              const Node* stage_root,
+                              const Parameter* parallelism)
+      TF_LOCKS_EXCLUDED(learned_costs_mu_);
+
   // Determines if we should stop the gradient descent optimization iterations
   // based on number of increasable parameters, CPU budget, RAM budget and
   // current resource usage.
@@ -1218,6 +1285,19 @@ class Model {
   OptimizationParams optimization_params_ TF_GUARDED_BY(mu_);
   // Stores the model id in the string format
   std::string model_id_;
+
+  // State of the `LEARNED_COST` optimization for a single node.
+  struct LearnedNodeCost {
+    ParallelismCostCurve curve;
+    int64_t last_num_elements = 0;
+    int64_t last_processing_time = 0;
+    double last_parallelism = 0.0;
+  };
+  // Guards the learned cost state which outlives individual snapshots.
+  mutable mutex learned_costs_mu_;
+  // Learned cost state of the nodes of the model, keyed by node id.
+  absl::flat_hash_map<int64_t, LearnedNodeCost> learned_costs_
+      TF_GUARDED_BY(learned_costs_mu_);
 };
 
 // Class to compute timing information for a model.
@@ -3531,6 +3531,187 @@ TEST_F(ModelTimingTest, SelfTime) {
   EXPECT_DOUBLE_EQ(910, node_2->ComputeSelfTime());
 }
 
+TEST(ParallelismCostCurveTest, NotFittedWithSingleParallelism) {
+  ParallelismCostCurve curve;
+  EXPECT_FALSE(curve.fitted());
+  EXPECT_DOUBLE_EQ(1.0, curve.Scale(1, 4));
+  curve.AddObservation(/*parallelism=*/4, /*element_time_nsec=*/100);
+  curve.AddObservation(/*parallelism=*/4, /*element_time_nsec=*/120);
+  EXPECT_FALSE(curve.fitted());
+  EXPECT_DOUBLE_EQ(1.0, curve.Scale(4, 8));
+}
+
+TEST(ParallelismCostCurveTest, FitsContention) {
+  ParallelismCostCurve curve;
+  // The per-element processing time grows by 50ns with every parallel call.
+  curve.AddObservation(/*parallelism=*/1, /*element_time_nsec=*/150);
+  curve.AddObservation(/*parallelism=*/2, /*element_time_nsec=*/200);
+  curve.AddObservation(/*parallelism=*/4, /*element_time_nsec=*/300);
+  EXPECT_TRUE(curve.fitted());
+  EXPECT_NEAR(500.0, curve.ElementTimeNsec(8), 1e-6);
+  EXPECT_NEAR(2.0, curve.Scale(1, 4), 1e-6);
+  EXPECT_NEAR(0.5, curve.Scale(4, 1), 1e-6);
+}
+
+TEST(ParallelismCostCurveTest, IgnoresInvalidObservations) {
+  ParallelismCostCurve curve;
+  curve.AddObservation(/*parallelism=*/0, /*element_time_nsec=*/100);
+  curve.AddObservation(/*parallelism=*/2, /*element_time_nsec=*/-1);
+  EXPECT_FALSE(curve.fitted());
+  EXPECT_DOUBLE_EQ(0.0, curve.ElementTimeNsec(2));
+}
+
+TEST_F(ModelTimingTest, OptimizeLearnedCost_OneStage) {
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 97
+        buffered_elements: 3
+        processing_time: 5000
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "parallelism"
+          value: 4
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "Map"
+        autotune: true
+        num_elements: 100
+        processing_time: 3000
+        node_class: KNOWN_RATIO
+        ratio: 1
+        inputs: 3
+      }
+    }
+    nodes: {
+      key: 3
+      value: {
+        id: 3
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 1000
+        node_class: KNOWN_RATIO
+      }
+    }
+    output: 1
+  )pb");
+
+  CellReader<int64_t> cell_reader(
+      "/tensorflow/data/autotune_stopping_criteria");
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(0);
+  model_->Optimize(AutotuneAlgorithm::LEARNED_COST, CpuBudgetFunc(20),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/1000,
+                   /*model_input_time=*/50, ram_budget_manager,
+                   &cancellation_manager);
+  // Without any learned costs, the result matches stage-based optimization.
+  EXPECT_EQ(5, GetNode(/*node_id=*/1)->parameter_value("parallelism"));
+
+  // Optimizing again with unchanged metrics keeps the current values.
+  model_->Optimize(AutotuneAlgorithm::LEARNED_COST, CpuBudgetFunc(20),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/1000,
+                   /*model_input_time=*/50, ram_budget_manager,
+                   &cancellation_manager);
+  EXPECT_EQ(5, GetNode(/*node_id=*/1)->parameter_value("parallelism"));
+  EXPECT_EQ(cell_reader.Delta("learned_cost_no_gain"), 1);
+}
+
+TEST_F(ModelTimingTest, OptimizeLearnedCost_CappedByCpuBudget) {
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 25000
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "parallelism"
+          value: 1
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 20000
+        bytes_produced: 10000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 3
+        parameters: {
+          name: "parallelism"
+          value: 1
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 3
+      value: {
+        id: 3
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 1000
+        node_class: KNOWN_RATIO
+        ratio: 2
+      }
+    }
+    output: 1
+  )pb");
+
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(0);
+  model_->Optimize(AutotuneAlgorithm::LEARNED_COST, CpuBudgetFunc(5),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/1000,
+                   /*model_input_time=*/50, ram_budget_manager,
+                   &cancellation_manager);
+
+  // Stage-based optimization sets both parallelism values to 5, but the
+  // learned cost optimization does not oversubscribe the CPU budget.
+  const double parallelism_1 =
+      GetNode(/*node_id=*/1)->parameter_value("parallelism");
+  const double parallelism_2 =
+      GetNode(/*node_id=*/2)->parameter_value("parallelism");
+  EXPECT_GE(parallelism_1, 2);
+  EXPECT_GE(parallelism_2, 2);
+  EXPECT_EQ(5, parallelism_1 + parallelism_2);
+}
+
 TEST(RamBudgetManagerTest, Ctor) {
   RamBudgetManager rbm(10);
   EXPECT_EQ(rbm.AvailableModelRam(), 10);
@@ -64,6 +64,11 @@ class RendezvousInterface {
     StringPiece dst_device;
     DeviceNameUtils::ParsedName dst;
     StringPiece edge_name;
+    // Index of the edge among the Send/Recv pairs of its partitioned graph,
+    // or -1 if the partitioner did not assign one. A LocalRendezvous matches
+    // keys with a slot through a lock-free array instead of its hash table.
+    // See `PartitionOptions::assign_rendezvous_slots`.
+    int64_t slot = -1;
 
     ParsedKey() {}
     ParsedKey(const ParsedKey& b) { *this = b; }
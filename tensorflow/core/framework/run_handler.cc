@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <list>
 #include <memory>
 
@@ -130,6 +131,7 @@ ThreadWorkSource::ThreadWorkSource()
       non_blocking_work_queues_(non_blocking_work_sharding_factor_),
       blocking_inflight_(0),
       non_blocking_inflight_(0),
+      max_blocking_inflight_(0),
       traceme_id_(0),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
@@ -298,6 +300,17 @@ void ThreadWorkSource::DecrementInflightTaskCount(bool is_blocking) {
   counter->fetch_sub(1, std::memory_order_relaxed);
 }
 
+void ThreadWorkSource::SetMaxBlockingInflight(int64_t value) {
+  max_blocking_inflight_.store(value, std::memory_order_relaxed);
+}
+
+bool ThreadWorkSource::MayRunBlockingTask(int64_t default_max_inflight) {
+  const int64_t max_inflight =
+      max_blocking_inflight_.load(std::memory_order_relaxed);
+  return GetInflightTaskCount(true) <
+         (max_inflight > 0 ? max_inflight : default_max_inflight);
+}
+
 unsigned ThreadWorkSource::NonBlockingWorkShardingFactor() {
   return non_blocking_work_sharding_factor_;
 }
@@ -506,7 +519,7 @@ Task RunHandlerThreadPool::FindTask(
 
     // For blocking thread, search for blocking tasks first.
     if (may_steal_blocking_work &&
-        (*tws)->GetInflightTaskCount(true) < max_blocking_inflight) {
+        (*tws)->MayRunBlockingTask(max_blocking_inflight)) {
       t = (*tws)->PopBlockingTask();
       if (t.f) {
         *task_from_blocking_queue = true;
@@ -595,7 +608,7 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
         // otherwise there will be contention in PropagateOutputs.
         // This is best effort policy.
         if (may_steal_blocking_work &&
-            tws->GetInflightTaskCount(true) < kMaxBlockingInflight) {
+            tws->MayRunBlockingTask(kMaxBlockingInflight)) {
           t = tws->PopBlockingTask();
           if (t.f) {
             break;
@@ -712,7 +725,7 @@ void RunHandlerThreadPool::WaitForWork(bool is_blocking, int thread_id,
     tws = (*thread_work_sources)[0];
   }
 
-  if (tws->GetInflightTaskCount(true) >= max_blocking_inflight) {
+  if (!tws->MayRunBlockingTask(max_blocking_inflight)) {
     // Sleep to reduce contention in PropagateOutputs
     Env::Default()->SleepForMicroseconds(kMaxSleepMicros);
   }
@@ -747,7 +760,15 @@ class RunHandler::Impl {
 
   internal::ThreadWorkSource* tws() { return &tws_; }
 
-  int64_t priority() { return options_.priority(); }
+  int64_t priority() const { return options_.priority(); }
+
+  // Returns whether the closures of this request are scheduled before those of
+  // `other`: higher priority first, then earliest deadline first. The requests
+  // without a deadline come last.
+  bool ScheduledBefore(const Impl& other) const {
+    if (priority() != other.priority()) return priority() > other.priority();
+    return deadline_micros_ < other.deadline_micros_;
+  }
 
  private:
   class ThreadPoolInterfaceWrapper : public thread::ThreadPoolInterface {
@@ -766,6 +787,8 @@ class RunHandler::Impl {
   RunHandlerPool::Impl* pool_impl_;  // NOT OWNED.
   uint64 start_time_us_;
   int64_t step_id_;
+  // The deadline of the request, or the maximum value if it has none.
+  int64_t deadline_micros_;
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
   internal::ThreadWorkSource tws_;
   RunOptions::Experimental::RunHandlerPoolOptions options_;
@@ -874,12 +897,12 @@ class RunHandlerPool::Impl {
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority();
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
-        if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
+        if (!new_handler_inserted &&
+            (it == sorted_active_handlers_.cend() ||
+             handler_impl->ScheduledBefore(**it))) {
           sorted_active_handlers_.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
@@ -935,6 +958,16 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting()
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    std::vector<int64_t> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->step_id());
+    }
+    return ret;
+  }
+
  private:
   void RecomputePoolStats(
       int num_active_requests, uint64 version,
@@ -954,8 +987,7 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by priority, then deadline, then start time.
   // TODO(chaox): Consider other data structure for maintaining the sorted
   // active handlers if the searching overhead(currently O(n)) becomes the
   // bottleneck.
@@ -1081,7 +1113,11 @@ void RunHandler::Impl::Reset(
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
   step_id_ = step_id;
   options_ = options;
+  deadline_micros_ = options.deadline_micros() > 0
+                         ? options.deadline_micros()
+                         : std::numeric_limits<int64_t>::max();
   tws_.SetTracemeId(step_id);
+  tws_.SetMaxBlockingInflight(options.max_inter_op_inflight());
 }
 
 RunHandlerPool::RunHandlerPool(int num_inter_op_threads)
@@ -1104,6 +1140,11 @@ std::vector<int64_t> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<int64_t> RunHandlerPool::GetActiveHandlerStepIdsForTesting()
+    const {
+  return impl_->GetActiveHandlerStepIdsForTesting();
+}
+
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
 
 void RunHandler::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -72,6 +72,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64_t> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the step ids of the active handlers, in the order of the active
+  // handler list.
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting() const;
+
  private:
   class Impl;
   friend class RunHandler;
@@ -82,7 +86,8 @@ class RunHandlerPool {
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
 // handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// (priority of the request, then earliest deadline first, then time of the
+// Get() call).
 //
 // It can only be created via RunHandlerPool::Get().
 //
@@ -182,6 +187,14 @@ class ThreadWorkSource {
 
   void DecrementInflightTaskCount(bool is_blocking);
 
+  // Sets the maximum number of blocking tasks of the request that may run
+  // concurrently. 0 uses the limit passed to MayRunBlockingTask().
+  void SetMaxBlockingInflight(int64_t value);
+
+  // Returns whether another blocking task may run, `default_max_inflight`
+  // being the limit of the thread pool.
+  bool MayRunBlockingTask(int64_t default_max_inflight);
+
   unsigned NonBlockingWorkShardingFactor();
 
   std::string ToString();
@@ -198,6 +211,7 @@ class ThreadWorkSource {
 
   std::atomic<int64_t> blocking_inflight_;
   std::atomic<int64_t> non_blocking_inflight_;
+  std::atomic<int64_t> max_blocking_inflight_;
 
   Queue blocking_work_queue_;
   mutex blocking_queue_op_mu_;
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/run_handler.h"
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -113,6 +115,53 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, DeadlineSchedulingTest) {
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  options.set_priority(1);
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  options.set_deadline_micros(2000);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  options.set_deadline_micros(1000);
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+  options.set_priority(2);
+  options.set_deadline_micros(3000);
+  auto handler4 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/0, options);
+
+  // The active requests should be ordered by priorities, then by deadlines,
+  // the request without a deadline coming last.
+  EXPECT_THAT(pool->GetActiveHandlerStepIdsForTesting(),
+              ::testing::ElementsAre(4, 3, 2, 1));
+
+  handler3.reset();
+  options.set_priority(1);
+  options.set_deadline_micros(1500);
+  auto handler5 = pool->Get(/*step_id=*/5, /*timeout_in_ms=*/0, options);
+  EXPECT_THAT(pool->GetActiveHandlerStepIdsForTesting(),
+              ::testing::ElementsAre(4, 5, 2, 1));
+}
+
+TEST(RunHandlerThreadPool, MaxBlockingInflight) {
+  internal::ThreadWorkSource tws;
+  EXPECT_TRUE(tws.MayRunBlockingTask(/*default_max_inflight=*/1));
+  tws.IncrementInflightTaskCount(/*is_blocking=*/true);
+  EXPECT_FALSE(tws.MayRunBlockingTask(/*default_max_inflight=*/1));
+
+  // The limit of the request overrides the one of the pool.
+  tws.SetMaxBlockingInflight(2);
+  EXPECT_TRUE(tws.MayRunBlockingTask(/*default_max_inflight=*/1));
+  tws.IncrementInflightTaskCount(/*is_blocking=*/true);
+  EXPECT_FALSE(tws.MayRunBlockingTask(/*default_max_inflight=*/10));
+
+  tws.SetMaxBlockingInflight(0);
+  EXPECT_TRUE(tws.MayRunBlockingTask(/*default_max_inflight=*/10));
+  tws.DecrementInflightTaskCount(/*is_blocking=*/true);
+  tws.DecrementInflightTaskCount(/*is_blocking=*/true);
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
@@ -811,5 +860,56 @@ TEST_F(RunHandlerTest, TestWaitTimeout) {
   EXPECT_NE(next_handle.get(), nullptr);
 }
 
+// Measures the latency of small interactive requests sharing the pool with a
+// large batch request. With deadlines, the interactive requests are scheduled
+// first and the batch request may only use half of the inter-op threads.
+void BM_MixedWorkloadLatency(::testing::benchmark::State& state) {
+  const bool use_deadlines = state.range(0);
+  const int kNumThreads = 4;
+  RunHandlerPool pool(kNumThreads, kNumThreads);
+
+  std::atomic<bool> stop(false);
+  auto batch_thread = absl::WrapUnique(Env::Default()->StartThread(
+      ThreadOptions(), "batch", [&pool, &stop, use_deadlines]() {
+        const int kNumBatchClosures = 64;
+        for (int64_t step_id = 1; !stop; ++step_id) {
+          RunOptions::Experimental::RunHandlerPoolOptions options;
+          if (use_deadlines) {
+            options.set_deadline_micros(EnvTime::NowMicros() + 1000000);
+            options.set_max_inter_op_inflight(kNumThreads / 2);
+          }
+          auto handler = pool.Get(step_id, /*timeout_in_ms=*/0, options);
+          BlockingCounter counter(kNumBatchClosures);
+          for (int i = 0; i < kNumBatchClosures; ++i) {
+            handler->ScheduleInterOpClosure([&counter]() {
+              Env::Default()->SleepForMicroseconds(200);
+              counter.DecrementCount();
+            });
+          }
+          counter.Wait();
+        }
+      }));
+
+  const int kNumInteractiveClosures = 4;
+  int64_t step_id = -1;
+  for (auto s : state) {
+    RunOptions::Experimental::RunHandlerPoolOptions options;
+    if (use_deadlines) {
+      options.set_deadline_micros(EnvTime::NowMicros() + 1000);
+    }
+    auto handler = pool.Get(step_id--, /*timeout_in_ms=*/0, options);
+    BlockingCounter counter(kNumInteractiveClosures);
+    for (int i = 0; i < kNumInteractiveClosures; ++i) {
+      handler->ScheduleInterOpClosure([&counter]() {
+        Env::Default()->SleepForMicroseconds(10);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  stop = true;
+}
+BENCHMARK(BM_MixedWorkloadLatency)->Arg(0)->Arg(1)->UseRealTime();
+
 }  // namespace
 }  // namespace tensorflow
@@ -995,6 +995,7 @@ absl::Status Partition(const PartitionOptions& opts, Graph* g,
   string dstp;
   std::vector<const Edge*> inputs;
   DupRecvTable dup_recv(3);
+  int64_t num_rendezvous_slots = 0;
   // For a node dst, 'ref_recvs' remembers the recvs introduced by a ref
   // edge to dst. 'ref_control_inputs' remembers the inputs by a non-ref
   // edge to dst. We will add a control edge for every pair in
@@ -1183,6 +1184,12 @@ absl::Status Partition(const PartitionOptions& opts, Graph* g,
                               tensor_name_attr, &status);
       if (!status.ok()) return status;
 
+      if (opts.assign_rendezvous_slots) {
+        AddNodeAttr("_rendezvous_slot", num_rendezvous_slots, send);
+        AddNodeAttr("_rendezvous_slot", num_rendezvous_slots, real_recv);
+        ++num_rendezvous_slots;
+      }
+
       // Fix up the control flow edge.
       // NOTE(yuanbyu): 'real_recv' must be the real recv node.
       if (src_graph == dst_graph) {
@@ -87,6 +87,13 @@ struct PartitionOptions {
   // TODO(b/327983931): Add wrapper functions for partitioning that clearly
   // signal this intent by taking a `Graph` or `Graph&&`.
   bool can_make_destructive_changes = false;
+
+  // If true, each Send/Recv pair added by `Partition()` is assigned a dense
+  // index in the "_rendezvous_slot" attr, which lets a LocalRendezvous match
+  // them without hashing or locking. The indices are only unique within one
+  // call, so the partitions must not share a rendezvous with the partitions
+  // of another call.
+  bool assign_rendezvous_slots = false;
 };
 
 // Partition "input" graph into a set of graphs, one per location.
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_partition.h"
 
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -83,7 +85,8 @@ string DeviceName(const Node* node) {
 }
 
 void Partition(const GraphDef& graph_def,
-               std::unordered_map<string, GraphDef>* partitions) {
+               std::unordered_map<string, GraphDef>* partitions,
+               bool assign_rendezvous_slots = false) {
   Graph g(OpRegistry::Global());
   GraphConstructorOptions opts;
   TF_CHECK_OK(ConvertGraphDefToGraph(opts, graph_def, &g));
@@ -103,6 +106,7 @@ void Partition(const GraphDef& graph_def,
   popts.get_incarnation = [](const string& name) {
     return (name[0] - 'A') + 100;
   };
+  popts.assign_rendezvous_slots = assign_rendezvous_slots;
   absl::Status s = Partition(popts, &g, partitions);
   CHECK(s.ok()) << s;
 
@@ -291,6 +295,37 @@ TEST_F(GraphPartitionTest, CrossDeviceData) {
   ExpectMatchB();
 }
 
+TEST_F(GraphPartitionTest, AssignRendezvousSlots) {
+  auto a1 = FloatInput(in_.WithOpName("A1"));
+  auto b1 = FloatInput(in_.WithOpName("B1"));
+  auto a2 = Combine(in_.WithOpName("A2"), a1, b1);
+  Combine(in_.WithOpName("B2"), a1, a2);
+
+  Partition(ToGraphDef(), &partitions_, /*assign_rendezvous_slots=*/true);
+  EXPECT_EQ(2, partitions_.size());
+
+  // The Send and the Recv of an edge share a slot, and the slots are dense.
+  std::map<string, std::pair<int64_t, int64_t>> slots;
+  for (const auto& kv : partitions_) {
+    for (const NodeDef& ndef : kv.second.node()) {
+      if (ndef.op() != "_Send" && ndef.op() != "_Recv") continue;
+      string tensor_name;
+      TF_ASSERT_OK(GetNodeAttr(ndef, "tensor_name", &tensor_name));
+      int64_t slot;
+      TF_ASSERT_OK(GetNodeAttr(ndef, "_rendezvous_slot", &slot));
+      auto& edge_slots = slots.try_emplace(tensor_name, -1, -1).first->second;
+      (ndef.op() == "_Send" ? edge_slots.first : edge_slots.second) = slot;
+    }
+  }
+  ASSERT_EQ(slots.size(), 3);
+  std::set<int64_t> distinct_slots;
+  for (const auto& kv : slots) {
+    EXPECT_EQ(kv.second.first, kv.second.second) << kv.first;
+    distinct_slots.insert(kv.second.first);
+  }
+  EXPECT_EQ(distinct_slots, std::set<int64_t>({0, 1, 2}));
+}
+
 TEST_F(GraphPartitionTest, CrossDeviceControl) {
   auto a1 = FloatInput(in_.WithOpName("A1"));
   auto b1 = FloatInput(in_.WithOpName("B1"));
@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "absl/hash/hash.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -37,7 +41,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/hash.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -491,6 +497,49 @@ uint64 NumElementsFromTensorProto(const TensorProto& tensor_proto) {
   return num_elements;
 }
 
+// Fingerprints `node` to find the nodes modified since the last inference.
+// The shape inference doesn't read the values of the large constants, so only
+// their shape is fingerprinted, along with their content if the tensor values
+// are included in the properties, but without serializing it.
+uint64 NodeFingerprint(const NodeDef& node, bool include_tensor_values) {
+  if (!IsConstant(node)) {
+    return DeterministicProtoHash64(node);
+  }
+  auto value = node.attr().find("value");
+  if (value == node.attr().end() ||
+      NumElementsFromTensorProto(value->second.tensor()) <=
+          kThresholdToSkipConstTensorInstantiation) {
+    return DeterministicProtoHash64(node);
+  }
+  uint64 fingerprint = Hash64(node.name());
+  fingerprint = Hash64Combine(fingerprint, Hash64(node.op()));
+  fingerprint = Hash64Combine(fingerprint, Hash64(node.device()));
+  for (const string& input : node.input()) {
+    fingerprint = Hash64Combine(fingerprint, Hash64(input));
+  }
+  std::vector<std::pair<string, const AttrValue*>> attrs;
+  for (const auto& attr : node.attr()) {
+    if (attr.first != "value") attrs.emplace_back(attr.first, &attr.second);
+  }
+  std::sort(attrs.begin(), attrs.end());
+  for (const auto& attr : attrs) {
+    fingerprint = Hash64Combine(fingerprint, Hash64(attr.first));
+    fingerprint =
+        Hash64Combine(fingerprint, DeterministicProtoHash64(*attr.second));
+  }
+  const TensorProto& tensor = value->second.tensor();
+  fingerprint = Hash64Combine(fingerprint, tensor.dtype());
+  fingerprint = Hash64Combine(fingerprint,
+                              DeterministicProtoHash64(tensor.tensor_shape()));
+  if (include_tensor_values) {
+    fingerprint = Hash64Combine(
+        fingerprint, tensor.tensor_content().empty()
+                         ? DeterministicProtoHash64(tensor)
+                         : Hash64(tensor.tensor_content()));
+  }
+  return fingerprint;
+}
+
 }  // namespace
 
 // Note that tensor_as_shape input should not include kUnknownDimFromConst.
@@ -936,38 +985,46 @@ class SymbolicShapeRefiner {
       output_node->mutable_attr()->erase("index");
     }
 
-    // Perform inference on function body.
-    GraphProperties gp(grappler_function_item);
-    TF_RETURN_IF_ERROR(gp.InferStatically(
-        /*assume_valid_feeds=*/true,
-        /*aggressive_shape_inference=*/aggressive_shape_inference_,
-        /*include_tensor_values=*/true));
+    // The function body is now specialized for the shapes and values of the
+    // inputs of the call: reuse the output properties inferred for the calls
+    // with the same specialized body, e.g. in other call sites or in previous
+    // iterations of the propagation.
+    string function_key = function.name();
+    for (const NodeDef& node : grappler_function_item.graph.node()) {
+      string serialized_node;
+      if (!SerializeToStringDeterministic(node, &serialized_node)) {
+        function_key.clear();
+        break;
+      }
+      absl::StrAppend(&function_key, ";", serialized_node.size(), ":",
+                      serialized_node);
+    }
+    std::vector<OpInfo::TensorProperties> inferred_output_properties;
+    const std::vector<OpInfo::TensorProperties>* function_output_properties;
+    auto cached = function_key.empty()
+                      ? function_output_properties_.end()
+                      : function_output_properties_.find(function_key);
+    if (cached != function_output_properties_.end()) {
+      function_output_properties = &cached->second;
+    } else {
+      TF_RETURN_IF_ERROR(InferFunctionOutputProperties(
+          *function_node, grappler_function_item, output_nodes,
+          &inferred_output_properties));
+      function_output_properties = &inferred_output_properties;
+      if (!function_key.empty()) {
+        function_output_properties =
+            &(function_output_properties_[function_key] =
+                  std::move(inferred_output_properties));
+      }
+    }
 
     // Add return nodes for output shapes.
     int output = 0;
     ctx->output_tensors_as_shapes.resize(grappler_function_item.output_size());
     ctx->output_tensor_protos.resize(grappler_function_item.output_size(),
                                      nullptr);
-    for (auto const& out_arg : grappler_function_item.outputs()) {
-      // It is guaranteed that output_tensors does not contain any control
-      // inputs, so port_id >= 0.
-      TensorId out_tensor = ParseTensorName(out_arg.node_name);
-
-      if (output_nodes.count(out_tensor.node()) <= 0) {
-        return errors::FailedPrecondition(
-            "Unable to find return function_node ", out_tensor.node(), " for ",
-            function_node->name());
-      }
-      const NodeDef* retnode = output_nodes[out_tensor.node()];
-
-      auto output_properties = gp.GetOutputProperties(retnode->name());
-      int output_properties_size = output_properties.size();
-      if (out_tensor.index() >= output_properties_size) {
-        return errors::InvalidArgument(
-            out_tensor.ToString(), " has invalid position ", out_tensor.index(),
-            " (output_properties.size() = ", output_properties.size(), ").");
-      }
-      auto& outprop = output_properties[out_tensor.index()];
+    for (const OpInfo::TensorProperties& outprop :
+         *function_output_properties) {
       TensorShapeProto shape = outprop.shape();
       NormalizeShapeForOutput(&shape);
       ShapeHandle out;
@@ -986,6 +1043,45 @@ class SymbolicShapeRefiner {
     return absl::OkStatus();
   }
 
+  // Infers the properties of the outputs of the specialized body of the
+  // function called by `function_node`.
+  absl::Status InferFunctionOutputProperties(
+      const NodeDef& function_node,
+      const GrapplerFunctionItem& grappler_function_item,
+      const absl::flat_hash_map<std::string, NodeDef*>& output_nodes,
+      std::vector<OpInfo::TensorProperties>* output_properties) {
+    // Perform inference on function body.
+    GraphProperties gp(grappler_function_item);
+    TF_RETURN_IF_ERROR(gp.InferStatically(
+        /*assume_valid_feeds=*/true,
+        /*aggressive_shape_inference=*/aggressive_shape_inference_,
+        /*include_tensor_values=*/true));
+
+    for (auto const& out_arg : grappler_function_item.outputs()) {
+      // It is guaranteed that output_tensors does not contain any control
+      // inputs, so port_id >= 0.
+      TensorId out_tensor = ParseTensorName(out_arg.node_name);
+
+      auto it = output_nodes.find(out_tensor.node());
+      if (it == output_nodes.end()) {
+        return errors::FailedPrecondition(
+            "Unable to find return function_node ", out_tensor.node(), " for ",
+            function_node.name());
+      }
+      const NodeDef* retnode = it->second;
+
+      const auto& retnode_properties = gp.GetOutputProperties(retnode->name());
+      int retnode_properties_size = retnode_properties.size();
+      if (out_tensor.index() >= retnode_properties_size) {
+        return errors::InvalidArgument(
+            out_tensor.ToString(), " has invalid position ", out_tensor.index(),
+            " (output_properties.size() = ", retnode_properties.size(), ").");
+      }
+      output_properties->push_back(retnode_properties[out_tensor.index()]);
+    }
+    return absl::OkStatus();
+  }
+
   // Prepares input shapes/values/handles, then runs shape inference, and
   // finally sets output shapes/values/handles.
   absl::Status UpdateNode(const NodeDef* node, bool* refined) {
@@ -2052,6 +2148,10 @@ class SymbolicShapeRefiner {
   // instantiation failed it will have an `absl::nullopt`.
   absl::flat_hash_map<string, absl::optional<GrapplerFunctionItem>>
       fun_to_grappler_function_item_;
+  // Output properties of the function bodies specialized for the inputs of
+  // their calls, keyed by the function name and the specialized body.
+  absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+      function_output_properties_;
   FunctionLibraryDefinition function_library_;
   const absl::flat_hash_map<string, absl::flat_hash_set<int>>& fed_ports_;
   // Store TensorProtos for tensor value propagation. Note that we use deque,
@@ -2758,6 +2858,302 @@ absl::Status GraphProperties::InferStatically(
   TF_RETURN_IF_ERROR(VerboseShapeInferenceLogging(item_.graph, refiner.get(),
                                                   shape_manager.get()));
 
+  static_inference_options_ = StaticInferenceOptions{
+      assume_valid_feeds, aggressive_shape_inference,
+      include_input_tensor_values, include_output_tensor_values};
+  if (incremental_updates_) {
+    node_fingerprints_.clear();
+    for (const NodeDef& node : item_.graph.node()) {
+      node_fingerprints_[node.name()] = NodeFingerprint(
+          node, include_input_tensor_values || include_output_tensor_values);
+    }
+    library_fingerprint_ = DeterministicProtoHash64(item_.graph.library());
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status GraphProperties::UpdateStatically() {
+  if (!incremental_updates_ || !static_inference_options_.has_value()) {
+    return errors::FailedPrecondition(
+        "UpdateStatically requires incremental updates to be enabled before "
+        "calling InferStatically");
+  }
+  const StaticInferenceOptions options = *static_inference_options_;
+  auto infer_graph = [this, &options]() {
+    Clear();
+    incompatible_shape_nodes_.clear();
+    return InferStatically(options.assume_valid_feeds,
+                           options.aggressive_shape_inference,
+                           options.include_input_tensor_values,
+                           options.include_output_tensor_values);
+  };
+
+  // The function calls are not fingerprinted with the bodies they infer.
+  if (DeterministicProtoHash64(item_.graph.library()) != library_fingerprint_) {
+    return infer_graph();
+  }
+
+  // Forget the removed nodes, and find the added or modified ones.
+  std::vector<const NodeDef*> modified_nodes;
+  absl::flat_hash_set<absl::string_view> node_names;
+  for (const NodeDef& node : item_.graph.node()) {
+    node_names.insert(node.name());
+    const uint64 fingerprint = NodeFingerprint(
+        node, options.include_input_tensor_values ||
+                  options.include_output_tensor_values);
+    auto it = node_fingerprints_.find(node.name());
+    if (it == node_fingerprints_.end() || it->second != fingerprint) {
+      modified_nodes.push_back(&node);
+      node_fingerprints_[node.name()] = fingerprint;
+    }
+  }
+  for (auto it = node_fingerprints_.begin(); it != node_fingerprints_.end();) {
+    if (!node_names.contains(it->first)) {
+      input_properties_.erase(it->first);
+      output_properties_.erase(it->first);
+      incompatible_shape_nodes_.erase(it->first);
+      node_fingerprints_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  if (modified_nodes.empty()) {
+    return absl::OkStatus();
+  }
+
+  GraphView graph_view(&item_.graph);
+  absl::flat_hash_set<const NodeDef*> updated_nodes;
+  std::vector<const NodeDef*> stack = std::move(modified_nodes);
+  while (!stack.empty()) {
+    const NodeDef* node = stack.back();
+    stack.pop_back();
+    if (!updated_nodes.insert(node).second) {
+      continue;
+    }
+    for (const GraphView::InputPort& fanout :
+         graph_view.GetFanouts(*node, /*include_controlled_nodes=*/false)) {
+      stack.push_back(fanout.node);
+    }
+  }
+  if (2 * static_cast<int>(updated_nodes.size()) > item_.graph.node_size()) {
+    return infer_graph();
+  }
+
+  // Infer the properties of the updated nodes in a graph of their own, in
+  // which their inputs from the rest of the graph are _Arg nodes with the
+  // shapes of these inputs, or constants if their values are known.
+  GrapplerItem update_item;
+  *update_item.graph.mutable_library() = item_.graph.library();
+  *update_item.graph.mutable_versions() = item_.graph.versions();
+  absl::flat_hash_map<string, string> boundary_nodes;
+  int num_args = 0;
+  for (const NodeDef& node : item_.graph.node()) {
+    if (!updated_nodes.contains(&node)) {
+      continue;
+    }
+    if (IsControlFlow(node) || IsQueue(node) || IsEnqueue(node) ||
+        IsDequeue(node)) {
+      return infer_graph();
+    }
+    NodeDef* update_node = update_item.graph.add_node();
+    *update_node = node;
+    update_node->clear_input();
+    for (const string& input : node.input()) {
+      const TensorId tensor = ParseTensorName(input);
+      const NodeDef* input_node = graph_view.GetNode(tensor.node());
+      if (input_node == nullptr || updated_nodes.contains(input_node)) {
+        update_node->add_input(input);
+        continue;
+      }
+      if (tensor.index() < 0) {
+        // Control dependencies don't carry shapes.
+        continue;
+      }
+      string& boundary_node_name = boundary_nodes[tensor.ToString()];
+      if (boundary_node_name.empty()) {
+        auto it = output_properties_.find(tensor.node());
+        if (it == output_properties_.end() ||
+            tensor.index() >= static_cast<int>(it->second.size())) {
+          return infer_graph();
+        }
+        const OpInfo::TensorProperties& input_properties =
+            it->second[tensor.index()];
+        if (input_properties.dtype() == DT_RESOURCE ||
+            input_properties.dtype() == DT_VARIANT) {
+          return infer_graph();
+        }
+        boundary_node_name = strings::StrCat(tensor.node(), "/_update_input_",
+                                             tensor.index());
+        if (graph_view.GetNode(boundary_node_name) != nullptr) {
+          return infer_graph();
+        }
+        NodeDef* boundary_node = update_item.graph.add_node();
+        if (IsConstant(*input_node)) {
+          *boundary_node = *input_node;
+          boundary_node->clear_input();
+        } else if (input_properties.has_value()) {
+          boundary_node->set_op("Const");
+          (*boundary_node->mutable_attr())["dtype"].set_type(
+              input_properties.dtype());
+          *(*boundary_node->mutable_attr())["value"].mutable_tensor() =
+              input_properties.value();
+        } else {
+          boundary_node->set_op("_Arg");
+          (*boundary_node->mutable_attr())["T"].set_type(
+              input_properties.dtype());
+          (*boundary_node->mutable_attr())["index"].set_i(num_args++);
+          TensorShapeProto shape = input_properties.shape();
+          NormalizeShapeForOutput(&shape);
+          *(*boundary_node->mutable_attr())["_output_shapes"]
+               .mutable_list()
+               ->add_shape() = shape;
+        }
+        boundary_node->set_name(boundary_node_name);
+      }
+      update_node->add_input(boundary_node_name);
+    }
+  }
+  for (const auto& feed : item_.feed) {
+    const NodeDef* fed_node = graph_view.GetNode(NodeName(feed.first));
+    if (fed_node != nullptr && updated_nodes.contains(fed_node)) {
+      update_item.feed.push_back(feed);
+    }
+  }
+
+  GraphProperties update_properties(update_item);
+  if (!update_properties
+           .InferStatically(options.assume_valid_feeds,
+                            options.aggressive_shape_inference,
+                            options.include_input_tensor_values,
+                            options.include_output_tensor_values)
+           .ok()) {
+    return infer_graph();
+  }
+
+  // Give the symbolic dimensions of the updated nodes ids that the other nodes
+  // don't use.
+  int64_t min_symbolic_dim = -1;
+  for (const auto* properties : {&input_properties_, &output_properties_}) {
+    for (const auto& node_properties : *properties) {
+      for (const OpInfo::TensorProperties& tensor : node_properties.second) {
+        for (const auto& dim : tensor.shape().dim()) {
+          min_symbolic_dim = std::min(min_symbolic_dim, dim.size());
+        }
+      }
+    }
+  }
+  auto copy_properties =
+      [min_symbolic_dim](const std::vector<OpInfo::TensorProperties>& from,
+                         std::vector<OpInfo::TensorProperties>* to) {
+        *to = from;
+        for (OpInfo::TensorProperties& tensor : *to) {
+          for (auto& dim : *tensor.mutable_shape()->mutable_dim()) {
+            if (dim.size() < -1) {
+              dim.set_size(dim.size() + min_symbolic_dim + 1);
+            }
+          }
+        }
+      };
+  for (const NodeDef* node : updated_nodes) {
+    input_properties_.erase(node->name());
+    output_properties_.erase(node->name());
+    incompatible_shape_nodes_.erase(node->name());
+    if (update_properties.HasInputProperties(node->name())) {
+      copy_properties(update_properties.GetInputProperties(node->name()),
+                      &input_properties_[node->name()]);
+    }
+    if (update_properties.HasOutputProperties(node->name())) {
+      copy_properties(update_properties.GetOutputProperties(node->name()),
+                      &output_properties_[node->name()]);
+    }
+    if (update_properties.CheckShapeIncompatible(node->name())) {
+      incompatible_shape_nodes_.insert(node->name());
+    }
+  }
+  VLOG(1) << "Updated the properties of " << updated_nodes.size() << " of "
+          << item_.graph.node_size() << " nodes";
+  return absl::OkStatus();
+}
+
+absl::Status GraphProperties::InferStaticallyFromShared(
+    GraphProperties* shared, bool assume_valid_feeds,
+    bool aggressive_shape_inference, bool include_input_tensor_values,
+    bool include_output_tensor_values) {
+  if (shared == nullptr ||
+      shared->item_.graph.node_size() != item_.graph.node_size()) {
+    return InferStatically(assume_valid_feeds, aggressive_shape_inference,
+                           include_input_tensor_values,
+                           include_output_tensor_values);
+  }
+  const std::optional<StaticInferenceOptions>& options =
+      shared->static_inference_options_;
+  if (options.has_value() &&
+      (options->assume_valid_feeds != assume_valid_feeds ||
+       options->aggressive_shape_inference != aggressive_shape_inference)) {
+    // Keep the properties shared for the other users of `shared`.
+    return InferStatically(assume_valid_feeds, aggressive_shape_inference,
+                           include_input_tensor_values,
+                           include_output_tensor_values);
+  }
+  shared->EnableIncrementalUpdates();
+  absl::Status status;
+  if (options.has_value() &&
+      (options->include_input_tensor_values || !include_input_tensor_values) &&
+      (options->include_output_tensor_values ||
+       !include_output_tensor_values)) {
+    status = shared->UpdateStatically();
+  } else {
+    // Include the tensor values requested so far, and no others.
+    const bool shared_input_tensor_values =
+        include_input_tensor_values ||
+        (options.has_value() && options->include_input_tensor_values);
+    const bool shared_output_tensor_values =
+        include_output_tensor_values ||
+        (options.has_value() && options->include_output_tensor_values);
+    shared->Clear();
+    shared->incompatible_shape_nodes_.clear();
+    status = shared->InferStatically(assume_valid_feeds,
+                                     aggressive_shape_inference,
+                                     shared_input_tensor_values,
+                                     shared_output_tensor_values);
+  }
+  if (!status.ok()) {
+    // Don't update partially inferred properties next time.
+    shared->Clear();
+    shared->incompatible_shape_nodes_.clear();
+    shared->static_inference_options_.reset();
+    return status;
+  }
+
+  // Copies the properties, with the tensor values only if requested.
+  auto copy_properties =
+      [](const absl::flat_hash_map<string,
+                                   std::vector<OpInfo::TensorProperties>>& from,
+         bool include_tensor_values,
+         absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>*
+             to) {
+        to->clear();
+        to->reserve(from.size());
+        for (const auto& node_properties : from) {
+          std::vector<OpInfo::TensorProperties>& tensors =
+              (*to)[node_properties.first];
+          if (include_tensor_values) {
+            tensors = node_properties.second;
+            continue;
+          }
+          tensors.resize(node_properties.second.size());
+          for (int i = 0, end = tensors.size(); i < end; ++i) {
+            tensors[i].set_dtype(node_properties.second[i].dtype());
+            *tensors[i].mutable_shape() = node_properties.second[i].shape();
+          }
+        }
+      };
+  copy_properties(shared->input_properties_, include_input_tensor_values,
+                  &input_properties_);
+  copy_properties(shared->output_properties_, include_output_tensor_values,
+                  &output_properties_);
+  incompatible_shape_nodes_ = shared->incompatible_shape_nodes_;
   return absl::OkStatus();
 }
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_GRAPH_PROPERTIES_H_
 #define TENSORFLOW_CORE_GRAPPLER_COSTS_GRAPH_PROPERTIES_H_
 
+#include <optional>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -114,6 +115,29 @@ class GraphProperties {
                            /*aggressive_shape_inference=*/false,
                            /*include_tensor_values=*/true);
   }
+  // Records the nodes of the graph when inferring the properties statically,
+  // to allow updating the properties with UpdateStatically.
+  void EnableIncrementalUpdates() { incremental_updates_ = true; }
+  // Updates the properties inferred by the last call to InferStatically after
+  // the graph of the item changed: only the added or modified nodes and their
+  // transitive fanout are inferred again, from the properties of their fanin.
+  // The updated nodes don't share symbolic dimensions with the other nodes.
+  // Falls back to inferring the properties of the whole graph when the function
+  // library changed, or when the updated nodes are most of the graph, contain
+  // control flow or queues, or read resources. Requires
+  // EnableIncrementalUpdates.
+  absl::Status UpdateStatically();
+  // Infers the properties statically like InferStatically, by copying those
+  // of `shared`, whose item must have a graph with the same nodes. `shared`
+  // has incremental updates enabled, and only includes the tensor values that
+  // were requested. Infers the properties of the graph directly if `shared` is
+  // null, or was inferred with another `assume_valid_feeds` or
+  // `aggressive_shape_inference`.
+  absl::Status InferStaticallyFromShared(GraphProperties* shared,
+                                         bool assume_valid_feeds,
+                                         bool aggressive_shape_inference,
+                                         bool include_input_tensor_values,
+                                         bool include_output_tensor_values);
   // Infer the shape by running the graph on the specified cluster and recording
   // the shapes of the processed tensors.
   absl::Status InferDynamically(Cluster* cluster);
@@ -156,6 +180,7 @@ class GraphProperties {
   void Clear() {
     input_properties_.clear();
     output_properties_.clear();
+    node_fingerprints_.clear();
   }
 
  private:
@@ -212,6 +237,20 @@ class GraphProperties {
   // Nodes with output shape incompatible between shape inference and
   // annotation.
   std::unordered_set<string> incompatible_shape_nodes_;
+
+  // Options of the last static inference, and fingerprints of the nodes it
+  // inferred the properties of and of the function library if incremental
+  // updates are enabled.
+  struct StaticInferenceOptions {
+    bool assume_valid_feeds;
+    bool aggressive_shape_inference;
+    bool include_input_tensor_values;
+    bool include_output_tensor_values;
+  };
+  bool incremental_updates_ = false;
+  std::optional<StaticInferenceOptions> static_inference_options_;
+  absl::flat_hash_map<string, uint64> node_fingerprints_;
+  uint64 library_fingerprint_ = 0;
 };
 
 // Helper function for GraphProperties.
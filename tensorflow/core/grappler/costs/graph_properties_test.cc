@@ -233,6 +233,144 @@ TEST_F(GraphPropertiesTest, Clear) {
   EXPECT_FALSE(properties.has_properties());
 }
 
+TEST_F(GraphPropertiesTest, UpdateStatically) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({2, 3}));
+  Output y = ops::Square(s.WithOpName("y"), x);
+  Output z = ops::Identity(s.WithOpName("z"), y);
+  Output w = ops::Const(s.WithOpName("w"), 1.0f, {4, 5});
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GraphProperties properties(item);
+  properties.EnableIncrementalUpdates();
+  TF_ASSERT_OK(properties.InferStatically(false));
+  EXPECT_EQ("float: [2,3]",
+            PropToString(properties.GetOutputProperties("z")[0]));
+
+  // Make "z" read "w", and add a node in its fanout.
+  for (NodeDef& node : *item.graph.mutable_node()) {
+    if (node.name() == "z") {
+      node.set_input(0, "w");
+    }
+  }
+  NodeDef* neg = item.graph.add_node();
+  neg->set_name("neg");
+  neg->set_op("Neg");
+  neg->add_input("z");
+  (*neg->mutable_attr())["T"].set_type(DT_FLOAT);
+
+  TF_ASSERT_OK(properties.UpdateStatically());
+  EXPECT_EQ("float: [2,3]",
+            PropToString(properties.GetOutputProperties("y")[0]));
+  EXPECT_EQ("float: [4,5]",
+            PropToString(properties.GetInputProperties("z")[0]));
+  EXPECT_EQ("float: [4,5]",
+            PropToString(properties.GetOutputProperties("z")[0]));
+  EXPECT_EQ("float: [4,5]",
+            PropToString(properties.GetOutputProperties("neg")[0]));
+}
+
+TEST_F(GraphPropertiesTest, InferStaticallyFromShared) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Const(s.WithOpName("x"), 1.0f, {2, 3});
+  Output y = ops::Square(s.WithOpName("y"), x);
+  Output w = ops::Const(s.WithOpName("w"), 1.0f, {4, 5});
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  GraphProperties shared(item);
+  GrapplerItem item_copy = item;
+  GraphProperties properties(item_copy);
+  TF_ASSERT_OK(properties.InferStaticallyFromShared(
+      &shared, /*assume_valid_feeds=*/false,
+      /*aggressive_shape_inference=*/false,
+      /*include_input_tensor_values=*/false,
+      /*include_output_tensor_values=*/true));
+  EXPECT_EQ("float: [2,3]",
+            PropToString(properties.GetOutputProperties("y")[0]));
+  EXPECT_TRUE(properties.GetOutputProperties("x")[0].has_value());
+  EXPECT_FALSE(properties.GetInputProperties("y")[0].has_value());
+  EXPECT_FALSE(shared.GetInputProperties("y")[0].has_value());
+
+  // Inferring with other options leaves the shared properties as they are.
+  GraphProperties feeds_properties(item_copy);
+  TF_ASSERT_OK(feeds_properties.InferStaticallyFromShared(
+      &shared, /*assume_valid_feeds=*/true,
+      /*aggressive_shape_inference=*/false,
+      /*include_input_tensor_values=*/true,
+      /*include_output_tensor_values=*/false));
+  EXPECT_TRUE(feeds_properties.GetInputProperties("y")[0].has_value());
+  EXPECT_FALSE(shared.GetInputProperties("y")[0].has_value());
+
+  // Make "y" read "w": the shared properties are updated.
+  for (NodeDef& node : *item.graph.mutable_node()) {
+    if (node.name() == "y") {
+      node.set_input(0, "w");
+    }
+  }
+  item_copy = item;
+  GraphProperties updated_properties(item_copy);
+  TF_ASSERT_OK(updated_properties.InferStaticallyFromShared(
+      &shared, /*assume_valid_feeds=*/false,
+      /*aggressive_shape_inference=*/false,
+      /*include_input_tensor_values=*/false,
+      /*include_output_tensor_values=*/false));
+  EXPECT_EQ("float: [4,5]",
+            PropToString(updated_properties.GetOutputProperties("y")[0]));
+  EXPECT_FALSE(updated_properties.GetOutputProperties("w")[0].has_value());
+  EXPECT_EQ("float: [4,5]", PropToString(shared.GetOutputProperties("y")[0]));
+}
+
+TEST_F(GraphPropertiesTest, InferStaticallyFromSharedLargeConst) {
+  // The content of the large constants is fingerprinted when their values
+  // are included in the properties.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Tensor w_value(DT_FLOAT, TensorShape({1000}));
+  w_value.flat<float>().setConstant(1.0f);
+  Output w = ops::Const(s.WithOpName("w"), Input::Initializer(w_value));
+  Output y = ops::Square(s.WithOpName("y"), w);
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  auto first_output_value = [](const GraphProperties& properties) {
+    Tensor value;
+    if (!value.FromProto(properties.GetOutputProperties("w")[0].value())) {
+      return -1.0f;
+    }
+    return value.flat<float>()(0);
+  };
+
+  GraphProperties shared(item);
+  GrapplerItem item_copy = item;
+  GraphProperties properties(item_copy);
+  TF_ASSERT_OK(properties.InferStaticallyFromShared(
+      &shared, /*assume_valid_feeds=*/false,
+      /*aggressive_shape_inference=*/false,
+      /*include_input_tensor_values=*/false,
+      /*include_output_tensor_values=*/true));
+  EXPECT_EQ(1.0f, first_output_value(properties));
+
+  w_value.flat<float>().setConstant(2.0f);
+  for (NodeDef& node : *item.graph.mutable_node()) {
+    if (node.name() == "w") {
+      w_value.AsProtoTensorContent(
+          (*node.mutable_attr())["value"].mutable_tensor());
+    }
+  }
+  item_copy = item;
+  GraphProperties updated_properties(item_copy);
+  TF_ASSERT_OK(updated_properties.InferStaticallyFromShared(
+      &shared, /*assume_valid_feeds=*/false,
+      /*aggressive_shape_inference=*/false,
+      /*include_input_tensor_values=*/false,
+      /*include_output_tensor_values=*/true));
+  EXPECT_EQ(2.0f, first_output_value(updated_properties));
+  EXPECT_EQ("float: [1000]",
+            PropToString(updated_properties.GetOutputProperties("y")[0]));
+}
+
 TEST_F(GraphPropertiesTest, DynamicProperties) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false,
                                           cluster_->GetDeviceNames());
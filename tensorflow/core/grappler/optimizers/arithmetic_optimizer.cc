@@ -4488,10 +4488,11 @@ absl::Status ArithmeticOptimizer::Optimize(Cluster* /*cluster*/,
 
   graph_properties_.reset(new GraphProperties(optimized_item));
   const bool assume_valid_feeds = opt_level_ == RewriterConfig::AGGRESSIVE;
-  const absl::Status status =
-      graph_properties_->InferStatically(assume_valid_feeds,
-                                         /*aggressive_shape_inference=*/false,
-                                         /*include_tensor_values=*/false);
+  const absl::Status status = graph_properties_->InferStaticallyFromShared(
+      shared_graph_properties(), assume_valid_feeds,
+      /*aggressive_shape_inference=*/false,
+      /*include_input_tensor_values=*/false,
+      /*include_output_tensor_values=*/false);
   const bool can_use_shapes = status.ok();
   if (!can_use_shapes) {
     VLOG(1) << "Shape inference failed." << status.message();
@@ -17,8 +17,11 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
 
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -38,6 +41,8 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/evaluation_utils.h"
@@ -193,21 +198,24 @@ float QuantizedTypeMaxAsFloat(DataType data_type) {
 ConstantFolding::ConstantFolding(RewriterConfig::Toggle opt_level,
                                  DeviceBase* cpu_device,
                                  bool disable_compressed_tensor_optimization,
-                                 bool fold_quantization_emulation)
+                                 bool fold_quantization_emulation,
+                                 int64_t folding_budget_bytes)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
       disable_compressed_tensor_optimization_(
           disable_compressed_tensor_optimization),
-      fold_quantization_emulation_(fold_quantization_emulation) {
+      fold_quantization_emulation_(fold_quantization_emulation),
+      folding_budget_bytes_(folding_budget_bytes) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
 ConstantFolding::ConstantFolding(DeviceBase* cpu_device,
                                  bool disable_compressed_tensor_optimization,
-                                 bool fold_quantization_ops)
+                                 bool fold_quantization_ops,
+                                 int64_t folding_budget_bytes)
     : ConstantFolding(RewriterConfig::ON, cpu_device,
                       disable_compressed_tensor_optimization,
-                      fold_quantization_ops) {}
+                      fold_quantization_ops, folding_budget_bytes) {}
 
 // static
 string ConstantFolding::AddControlDependency(const string& input_name,
@@ -1521,7 +1529,8 @@ absl::Status ConstantFolding::FoldMergeNode(NodeDef* node,
 }
 
 absl::Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
-                                       bool* result_too_large) {
+                                       bool* result_too_large,
+                                       std::optional<DeferredFold>* deferred) {
   *result_too_large = false;
   if (IsMerge(*node)) {
     return FoldMergeNode(node, output_graph);
@@ -1530,11 +1539,70 @@ absl::Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
   std::vector<NodeDef> const_nodes;
   TF_RETURN_IF_ERROR(
       EvaluateOneFoldable(*node, &const_nodes, result_too_large));
+
+  if (deferred != nullptr) {
+    std::vector<const TensorProto*> inputs;
+    int64_t input_bytes = 0;
+    for (const string& input : node->input()) {
+      if (IsControlInput(input)) break;
+      inputs.push_back(&node_map_->GetNode(input)->attr().at("value").tensor());
+      input_bytes += inputs.back()->ByteSizeLong();
+    }
+    std::vector<const TensorProto*> outputs;
+    int64_t output_bytes = 0;
+    for (const NodeDef& const_node : const_nodes) {
+      if (const_node.name().empty()) continue;
+      outputs.push_back(&const_node.attr().at("value").tensor());
+      output_bytes += outputs.back()->ByteSizeLong();
+    }
+    const int64_t added_bytes = output_bytes - input_bytes;
+    if (added_bytes > folding_budget_bytes_ - folding_budget_used_bytes_) {
+      // Don't hold on to constants that can't be folded anyway.
+      VLOG(1) << "Not folding node " << node->name() << ": its " << added_bytes
+              << " bytes do not fit in the remaining "
+              << folding_budget_bytes_ - folding_budget_used_bytes_
+              << " bytes of the constant folding budget";
+      nodes_over_budget_.insert(node->name());
+      return absl::OkStatus();
+    }
+    if (added_bytes > 0) {
+      OpContext op_context;
+      op_context.op_info.set_op(node->op());
+      *op_context.op_info.mutable_attr() = node->attr();
+      // A fixed device keeps the folding order independent of the host.
+      op_context.op_info.mutable_device()->set_type("CPU");
+      op_context.op_info.mutable_device()->set_num_cores(1);
+      op_context.op_info.mutable_device()->set_frequency(1000);
+      for (const TensorProto* tensor : inputs) {
+        OpInfo::TensorProperties* properties = op_context.op_info.add_inputs();
+        properties->set_dtype(tensor->dtype());
+        *properties->mutable_shape() = tensor->tensor_shape();
+      }
+      for (const TensorProto* tensor : outputs) {
+        OpInfo::TensorProperties* properties = op_context.op_info.add_outputs();
+        properties->set_dtype(tensor->dtype());
+        *properties->mutable_shape() = tensor->tensor_shape();
+      }
+      const int64_t execution_ns = std::max<int64_t>(
+          cost_estimator_->PredictCosts(op_context).execution_time.count(), 1);
+      VLOG(2) << "Deferred folding node " << node->name() << ", adding "
+              << added_bytes << " bytes to save " << execution_ns << " ns";
+      *deferred =
+          DeferredFold{node, std::move(const_nodes), added_bytes,
+                       static_cast<double>(execution_ns) / added_bytes};
+      return absl::OkStatus();
+    }
+  }
+  return ReplaceWithConstants(node, &const_nodes, output_graph);
+}
+
+absl::Status ConstantFolding::ReplaceWithConstants(
+    NodeDef* node, std::vector<NodeDef>* const_nodes, GraphDef* output_graph) {
   VLOG(2) << "Folded node: " << SummarizeNodeDef(*node);
 
   NodeDef* constant_output = nullptr;
-  for (int i = 0, end = const_nodes.size(); i < end; i++) {
-    NodeDef* const_node = &const_nodes[i];
+  for (int i = 0, end = const_nodes->size(); i < end; i++) {
+    NodeDef* const_node = &(*const_nodes)[i];
     VLOG(3) << "Generated constant node: " << SummarizeNodeDef(*const_node);
     if (const_node->name().empty()) {
       // Dead output: we can't create a constant to encode its value, so we'll
@@ -1572,7 +1640,7 @@ absl::Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
 
     // We rewrite the existing node if it only has a single output, and
     // create new nodes otherwise.
-    if (const_nodes.size() == 1) {
+    if (const_nodes->size() == 1) {
       node->set_op("Const");
       // Note we need to clear the inputs in NodeMap before we clear the inputs
       // in the node, otherwise NodeMap would see empty inputs and effectively
@@ -1605,7 +1673,7 @@ absl::Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
     }
   }
 
-  if (const_nodes.size() > 1) {
+  if (const_nodes->size() > 1) {
     // We make a copy because we mutate the nodes.
     auto outputs = node_map_->GetOutputs(node->name());
     for (NodeDef* output : outputs) {
@@ -1621,12 +1689,12 @@ absl::Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
                                      constant_output->name());
               *output->mutable_input(i) = AsControlDependency(*constant_output);
             }
-          } else if (port < static_cast<int>(const_nodes.size()) &&
-                     !const_nodes[port].name().empty()) {
+          } else if (port < static_cast<int>(const_nodes->size()) &&
+                     !(*const_nodes)[port].name().empty()) {
             // Replace alive outputs with the corresponding constant.
             node_map_->UpdateInput(output->name(), NodeName(output->input(i)),
-                                   const_nodes[port].name());
-            *output->mutable_input(i) = const_nodes[port].name();
+                                   (*const_nodes)[port].name());
+            *output->mutable_input(i) = (*const_nodes)[port].name();
           } else {
             // Leave this edge alone.
             VLOG(3) << "Preserving edge from " << node->name() << ":" << port
@@ -1646,6 +1714,58 @@ absl::Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
   return absl::OkStatus();
 }
 
+absl::Status ConstantFolding::FoldBestDeferred(
+    const GraphProperties& properties,
+    std::vector<DeferredFold>* deferred_folds, GraphDef* output_graph,
+    std::deque<NodeDef*>* queue) {
+  // The first of the best folds, to keep the output deterministic.
+  auto best = absl::c_max_element(
+      *deferred_folds, [](const DeferredFold& a, const DeferredFold& b) {
+        return a.score < b.score;
+      });
+  DeferredFold fold = std::move(*best);
+  deferred_folds->erase(best);
+  if (folding_budget_used_bytes_ + fold.added_bytes > folding_budget_bytes_) {
+    VLOG(1) << "Not folding node " << fold.node->name() << ": its "
+            << fold.added_bytes << " bytes do not fit in the remaining "
+            << folding_budget_bytes_ - folding_budget_used_bytes_
+            << " bytes of the constant folding budget";
+    nodes_over_budget_.insert(fold.node->name());
+    return absl::OkStatus();
+  }
+
+  std::vector<NodeDef*> fanout =
+      node_map_->GetOutputsOrderedByNodeName(fold.node->name());
+  absl::Status s =
+      ReplaceWithConstants(fold.node, &fold.const_nodes, output_graph);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to fold node " << fold.node->DebugString()
+            << "\nError message: " << s;
+    return absl::OkStatus();
+  }
+  folding_budget_used_bytes_ += fold.added_bytes;
+  const int64_t remaining_bytes =
+      folding_budget_bytes_ - folding_budget_used_bytes_;
+  for (const DeferredFold& deferred_fold : *deferred_folds) {
+    if (deferred_fold.added_bytes > remaining_bytes) {
+      nodes_over_budget_.insert(deferred_fold.node->name());
+    }
+  }
+  deferred_folds->erase(
+      std::remove_if(deferred_folds->begin(), deferred_folds->end(),
+                     [remaining_bytes](const DeferredFold& deferred_fold) {
+                       return deferred_fold.added_bytes > remaining_bytes;
+                     }),
+      deferred_folds->end());
+  for (NodeDef* fanout_node : fanout) {
+    if (IsFoldable(*fanout_node, &properties) &&
+        !nodes_over_budget_.contains(fanout_node->name())) {
+      queue->push_back(fanout_node);
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ConstantFolding::FoldGraph(
     const GraphProperties& properties, GraphDef* optimized_graph,
     absl::flat_hash_set<string>* nodes_to_not_simplify) {
@@ -1656,11 +1776,20 @@ absl::Status ConstantFolding::FoldGraph(
   for (int i = 0; i < graph_->node_size(); i++) {
     const NodeDef& node = graph_->node(i);
     if (IsFoldable(node, &properties) &&
-        !nodes_to_not_simplify->count(node.name())) {
+        !nodes_to_not_simplify->count(node.name()) &&
+        !nodes_over_budget_.contains(node.name())) {
       queue.push_back(graph_->mutable_node(i));
     }
   }
-  while (!queue.empty()) {
+  // When folding on a budget, the folds that add bytes to the graph are done
+  // once no other fold is left.
+  std::vector<DeferredFold> deferred_folds;
+  while (!queue.empty() || !deferred_folds.empty()) {
+    if (queue.empty()) {
+      TF_RETURN_IF_ERROR(FoldBestDeferred(properties, &deferred_folds,
+                                          optimized_graph, &queue));
+      continue;
+    }
     NodeDef* node = queue.front();
     queue.pop_front();
     if (processed_nodes.count(node->name())) {
@@ -1671,7 +1800,10 @@ absl::Status ConstantFolding::FoldGraph(
     std::vector<NodeDef*> fanout =
         node_map_->GetOutputsOrderedByNodeName(node->name());
     bool result_too_large = false;
-    absl::Status s = FoldNode(node, optimized_graph, &result_too_large);
+    std::optional<DeferredFold> deferred;
+    absl::Status s =
+        FoldNode(node, optimized_graph, &result_too_large,
+                 folding_budget_bytes_ > 0 ? &deferred : nullptr);
     processed_nodes.insert(node->name());
     if (!s.ok()) {
       VLOG(1) << "Failed to fold node " << node->DebugString()
@@ -1679,10 +1811,13 @@ absl::Status ConstantFolding::FoldGraph(
       if (result_too_large) {
         nodes_to_not_simplify->emplace(node->name());
       }
+    } else if (deferred.has_value()) {
+      deferred_folds.push_back(*std::move(deferred));
     } else {
       for (auto& fanout_node : fanout) {
         if (IsFoldable(*fanout_node, &properties) &&
-            !nodes_to_not_simplify->count(fanout_node->name())) {
+            !nodes_to_not_simplify->count(fanout_node->name()) &&
+            !nodes_over_budget_.contains(fanout_node->name())) {
           queue.push_back(fanout_node);
         }
       }
@@ -4080,6 +4215,10 @@ absl::Status ConstantFolding::Optimize(Cluster* cluster,
     cpu_device_ = owned_device_.get();
   }
 
+  if (folding_budget_bytes_ > 0 && cost_estimator_ == nullptr) {
+    cost_estimator_ = std::make_unique<OpLevelCostEstimator>();
+  }
+
   graph_contains_assign_or_inplace_op_ = false;
   for (const NodeDef& node : item.graph.node()) {
     if (ModifiesInputsInPlace(node) || HasRefInput(node)) {
@@ -4096,10 +4235,11 @@ absl::Status ConstantFolding::Optimize(Cluster* cluster,
   // aggressive mode.
   const bool assume_valid_feeds = opt_level_ == RewriterConfig::AGGRESSIVE;
   if (!properties
-           .InferStatically(assume_valid_feeds,
-                            /*aggressive_shape_inference=*/false,
-                            /*include_input_tensor_values=*/false,
-                            /*include_output_tensor_values=*/true)
+           .InferStaticallyFromShared(shared_graph_properties(),
+                                      assume_valid_feeds,
+                                      /*aggressive_shape_inference=*/false,
+                                      /*include_input_tensor_values=*/false,
+                                      /*include_output_tensor_values=*/true)
            .ok()) {
     properties.Clear();
   }
@@ -4119,6 +4259,15 @@ absl::Status ConstantFolding::Optimize(Cluster* cluster,
   *optimized_graph->mutable_library() = item.graph.library();
   *optimized_graph->mutable_versions() = item.graph.versions();
 
+  if (folding_budget_bytes_ > 0) {
+    VLOG(1) << "Constant folding used " << folding_budget_used_bytes_
+            << " bytes of its budget of " << folding_budget_bytes_
+            << " bytes, leaving " << nodes_over_budget_.size()
+            << " nodes to compute at runtime; the graph grew from "
+            << item.graph.ByteSizeLong() << " to "
+            << optimized_graph->ByteSizeLong() << " bytes";
+  }
+
   return absl::OkStatus();
 }
 
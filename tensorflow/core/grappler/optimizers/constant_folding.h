@@ -16,6 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_H_
 
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/types/span.h"
@@ -24,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
@@ -46,12 +53,20 @@ class ConstantFolding : public GraphOptimizer {
   static string AddControlDependency(const string& input_name, GraphDef* graph,
                                      NodeMap* node_map);
 
+  // If `folding_budget_bytes` is positive, the constants created by folding
+  // may add at most that many bytes to the graph. The folds that grow the graph
+  // are then done last, those with the most estimated compute time per added
+  // byte first, and the ones that do not fit are left to be computed at
+  // runtime. The budget is shared by all the calls to Optimize, so that
+  // running the optimizer again on its output does not fold more.
   explicit ConstantFolding(DeviceBase* cpu_device,
                            bool disable_compressed_tensor_optimization = false,
-                           bool fold_quantization_emulation = true);
+                           bool fold_quantization_emulation = true,
+                           int64_t folding_budget_bytes = 0);
   ConstantFolding(RewriterConfig::Toggle opt_level, DeviceBase* cpu_device,
                   bool disable_compressed_tensor_optimization = false,
-                  bool fold_quantization_emulation = true);
+                  bool fold_quantization_emulation = true,
+                  int64_t folding_budget_bytes = 0);
 
   ~ConstantFolding() override {}
 
@@ -97,9 +112,32 @@ class ConstantFolding : public GraphOptimizer {
                                    std::vector<NodeDef>* outputs,
                                    bool* result_too_large);
 
+  // A fold that adds bytes to the graph, deferred when folding on a budget.
+  struct DeferredFold {
+    NodeDef* node;
+    std::vector<NodeDef> const_nodes;
+    int64_t added_bytes;
+    // The estimated execution time of the folded kernel per added byte.
+    double score;
+  };
+
   absl::Status FoldMergeNode(NodeDef* node, GraphDef* output_graph);
+  // Folds `node`, unless `deferred` is not null and the fold adds bytes to the
+  // graph, in which case the fold is returned in `deferred` if it fits in the
+  // remaining budget, and dropped otherwise.
   absl::Status FoldNode(NodeDef* node, GraphDef* output_graph,
-                        bool* result_too_large);
+                        bool* result_too_large,
+                        std::optional<DeferredFold>* deferred = nullptr);
+  // Replaces `node` by the constants of its evaluated outputs `const_nodes`.
+  absl::Status ReplaceWithConstants(NodeDef* node,
+                                    std::vector<NodeDef>* const_nodes,
+                                    GraphDef* output_graph);
+  // Folds the deferred fold with the best score if it fits in the budget, and
+  // queues its foldable fanout. Drops the deferred folds that no longer fit.
+  absl::Status FoldBestDeferred(const GraphProperties& properties,
+                                std::vector<DeferredFold>* deferred_folds,
+                                GraphDef* output_graph,
+                                std::deque<NodeDef*>* queue);
 
   bool IsOnes(const NodeDef& node) const;
   bool IsZeros(const NodeDef& node) const;
@@ -352,6 +390,13 @@ class ConstantFolding : public GraphOptimizer {
   bool graph_contains_assign_or_inplace_op_;
   bool disable_compressed_tensor_optimization_;
   bool fold_quantization_emulation_;
+  const int64_t folding_budget_bytes_;
+  // Bytes added by the folds charged to the budget, across calls to Optimize.
+  int64_t folding_budget_used_bytes_ = 0;
+  // Nodes not folded because their result did not fit in the budget.
+  absl::flat_hash_set<string> nodes_over_budget_;
+  // Estimates the compute time saved by the folds that grow the graph.
+  std::unique_ptr<OpLevelCostEstimator> cost_estimator_;
 };
 
 }  // end namespace grappler
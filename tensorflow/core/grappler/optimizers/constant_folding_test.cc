@@ -2942,6 +2942,114 @@ TEST_F(ConstantFoldingTest, LargeConstantNoSizeIncrease) {
   EXPECT_LT(output.ByteSizeLong(), sizeof(float) * large_constant_size + 500);
 }
 
+TEST_F(ConstantFoldingTest, FoldingBudget) {
+  // The Diag grows the graph by about 4KB when folded, while folding the Add
+  // makes it smaller.
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  Tensor diagonal(DT_FLOAT, TensorShape({32}));
+  for (int i = 0; i < 32; ++i) {
+    diagonal.flat<float>()(i) = i;
+  }
+  Output v = ops::Const(scope.WithOpName("v"), Input::Initializer(diagonal));
+  Output diag = ops::Diag(scope.WithOpName("diag"), v);
+  Output x = ops::Const(scope.WithOpName("x"), 1.0f, {});
+  Output y = ops::Const(scope.WithOpName("y"), 2.0f, {});
+  Output add = ops::Add(scope.WithOpName("add"), x, y);
+  Output diag_out = ops::Identity(scope.WithOpName("diag_out"), diag);
+  Output add_out = ops::Identity(scope.WithOpName("add_out"), add);
+
+  GrapplerItem item;
+  item.fetch = {"diag_out", "add_out"};
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  auto node_op = [](const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return node.op();
+    }
+    return string();
+  };
+
+  ConstantFolding small_budget(RewriterConfig::ON, /*cpu_device=*/nullptr,
+                               /*disable_compressed_tensor_optimization=*/
+                               false, /*fold_quantization_emulation=*/true,
+                               /*folding_budget_bytes=*/1024);
+  GraphDef output;
+  TF_EXPECT_OK(small_budget.Optimize(/*cluster=*/nullptr, item, &output));
+  EXPECT_EQ("Diag", node_op(output, "diag"));
+  EXPECT_EQ("Const", node_op(output, "add"));
+
+  // Optimizing the output again does not fold the Diag either.
+  GrapplerItem output_item = item;
+  output_item.graph.Swap(&output);
+  TF_EXPECT_OK(
+      small_budget.Optimize(/*cluster=*/nullptr, output_item, &output));
+  EXPECT_EQ("Diag", node_op(output, "diag"));
+
+  ConstantFolding large_budget(RewriterConfig::ON, /*cpu_device=*/nullptr,
+                               /*disable_compressed_tensor_optimization=*/
+                               false, /*fold_quantization_emulation=*/true,
+                               /*folding_budget_bytes=*/1 << 20);
+  output.Clear();
+  TF_EXPECT_OK(large_budget.Optimize(/*cluster=*/nullptr, item, &output));
+  EXPECT_EQ("Const", node_op(output, "diag"));
+  EXPECT_EQ("Const", node_op(output, "add"));
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(2, tensors_expected.size());
+  ASSERT_EQ(2, tensors.size());
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+  test::ExpectTensorEqual<float>(tensors_expected[1], tensors[1]);
+}
+
+TEST_F(ConstantFoldingTest, FoldingBudgetAcrossIterations) {
+  // Each Diag grows the graph by about 4KB when folded, so only one of them
+  // fits in the budget, however many times the graph is optimized.
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  GrapplerItem item;
+  for (const string& name : {"a", "b"}) {
+    Tensor diagonal(DT_FLOAT, TensorShape({32}));
+    for (int i = 0; i < 32; ++i) {
+      diagonal.flat<float>()(i) = name == "a" ? i : -i;
+    }
+    Output v = ops::Const(scope.WithOpName(strings::StrCat("v_", name)),
+                          Input::Initializer(diagonal));
+    Output diag =
+        ops::Diag(scope.WithOpName(strings::StrCat("diag_", name)), v);
+    ops::Identity(scope.WithOpName(strings::StrCat("out_", name)), diag);
+    item.fetch.push_back(strings::StrCat("out_", name));
+  }
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  auto num_diags = [](const GraphDef& graph) {
+    int count = 0;
+    for (const NodeDef& node : graph.node()) {
+      if (node.op() == "Diag") ++count;
+    }
+    return count;
+  };
+
+  ConstantFolding optimizer(RewriterConfig::ON, /*cpu_device=*/nullptr,
+                            /*disable_compressed_tensor_optimization=*/false,
+                            /*fold_quantization_emulation=*/true,
+                            /*folding_budget_bytes=*/6000);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+  EXPECT_EQ(1, num_diags(output));
+
+  GrapplerItem output_item = item;
+  output_item.graph.Swap(&output);
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, output_item, &output));
+  EXPECT_EQ(1, num_diags(output));
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(2, tensors_expected.size());
+  ASSERT_EQ(2, tensors.size());
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+  test::ExpectTensorEqual<float>(tensors_expected[1], tensors[1]);
+}
+
 TEST_F(ConstantFoldingTest, MaterializeBroadcastGradientArgs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a =
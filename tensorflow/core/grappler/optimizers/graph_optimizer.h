@@ -29,13 +29,14 @@ namespace tensorflow {
 namespace grappler {
 
 class Cluster;
+class GraphProperties;
 struct GrapplerItem;
 
 // An abstract interface for an algorithm for generating a candidate
 // optimization of a GrapplerItem for running on a cluster.
 class GraphOptimizer {
  public:
-  GraphOptimizer() : deadline_usec_(0) {}
+  GraphOptimizer() : deadline_usec_(0), shared_graph_properties_(nullptr) {}
   virtual ~GraphOptimizer() {}
 
   virtual string name() const = 0;
@@ -75,8 +76,19 @@ class GraphOptimizer {
     return deadline_usec_ > 0 && Env::Default()->NowMicros() > deadline_usec_;
   }
 
+  // Set the properties of the graph of the item passed to Optimize, which the
+  // MetaOptimizer shares between the optimizers it runs on that graph. A null
+  // value means that the optimizer infers the properties on its own.
+  void set_shared_graph_properties(GraphProperties* properties) {
+    shared_graph_properties_ = properties;
+  }
+  GraphProperties* shared_graph_properties() const {
+    return shared_graph_properties_;
+  }
+
  private:
   uint64 deadline_usec_;
+  GraphProperties* shared_graph_properties_;
 };
 
 #define GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED()                \
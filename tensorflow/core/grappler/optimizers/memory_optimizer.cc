@@ -16,12 +16,15 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <functional>
+#include <map>
 #include <queue>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op.h"
@@ -1379,6 +1382,517 @@ absl::Status FindAssignNodesToRelax(const GraphDef& graph,
   return absl::OkStatus();
 }
 
+// Ops whose outputs the memory-aware schedule may compute again instead of
+// keeping them alive: they are cheap to compute from much smaller inputs.
+std::unordered_set<string> GetCheapToRematerializeOps() {
+  std::unordered_set<string> cheap_ops = {"BroadcastTo", "Fill", "OneHot",
+                                          "Range", "Tile"};
+  return cheap_ops;
+}
+
+// Prefix added to the nodes rematerialized by the memory-aware schedule.
+const char* kRematerializedNodePrefix = "Rematerialized";
+
+// Size of a tensor, assuming like GraphMemory that the unknown dimensions are
+// 1 and ignoring the tensors of unknown rank.
+int64_t EstimateTensorSize(const OpInfo::TensorProperties& tensor) {
+  if (tensor.shape().unknown_rank()) {
+    return 0;
+  }
+  int64_t num_elements = 1;
+  for (const auto& dim : tensor.shape().dim()) {
+    num_elements *= std::max<int64_t>(dim.size(), 1);
+  }
+  return num_elements * DataTypeSize(BaseType(tensor.dtype()));
+}
+
+// The data dependencies of a graph and the sizes of its tensors, to estimate
+// the peak memory of running its nodes one at a time in a given order. The
+// constants and variables, which live as long as the graph, are not counted.
+struct SequentialMemoryModel {
+  using NodeOutput = std::pair<int, int>;
+
+  // Builds the model of `item.graph`, in which the nodes named after a key of
+  // `copies` have the output sizes of the node named after the value.
+  absl::Status Initialize(
+      const GrapplerItem& item, const GraphProperties& properties,
+      const std::unordered_map<string, string>& copies = {}) {
+    const GraphDef& graph = item.graph;
+    const int num_nodes = graph.node_size();
+    std::unordered_map<string, int> node_ids;
+    for (int i = 0; i < num_nodes; ++i) {
+      node_ids[graph.node(i).name()] = i;
+    }
+    output_sizes.assign(num_nodes, {});
+    inputs.assign(num_nodes, {});
+    fanins.assign(num_nodes, {});
+    fanouts.assign(num_nodes, {});
+    consumers.assign(num_nodes, {});
+    for (int i = 0; i < num_nodes; ++i) {
+      const NodeDef& node = graph.node(i);
+      if (IsConstant(node) || IsVariable(node)) {
+        continue;
+      }
+      auto copy = copies.find(node.name());
+      for (const auto& output : properties.GetOutputProperties(
+               copy == copies.end() ? node.name() : copy->second)) {
+        output_sizes[i].push_back(EstimateTensorSize(output));
+      }
+    }
+    for (int i = 0; i < num_nodes; ++i) {
+      std::set<int> node_fanins;
+      std::set<NodeOutput> node_inputs;
+      for (const string& input : graph.node(i).input()) {
+        int port;
+        auto it = node_ids.find(ParseNodeName(input, &port));
+        if (it == node_ids.end()) {
+          return errors::InvalidArgument("Missing input ", input, " of node ",
+                                         graph.node(i).name());
+        }
+        node_fanins.insert(it->second);
+        if (port >= 0) {
+          node_inputs.emplace(it->second, port);
+        }
+      }
+      fanins[i].assign(node_fanins.begin(), node_fanins.end());
+      for (int fanin : fanins[i]) {
+        fanouts[fanin].push_back(i);
+      }
+      inputs[i].assign(node_inputs.begin(), node_inputs.end());
+      for (const NodeOutput& input : inputs[i]) {
+        std::vector<int64_t>& sizes = output_sizes[input.first];
+        if (input.second >= static_cast<int>(sizes.size())) {
+          sizes.resize(input.second + 1, 0);
+        }
+        std::vector<std::vector<int>>& ports = consumers[input.first];
+        if (input.second >= static_cast<int>(ports.size())) {
+          ports.resize(input.second + 1);
+        }
+        ports[input.second].push_back(i);
+      }
+    }
+    for (int i = 0; i < num_nodes; ++i) {
+      const int num_outputs =
+          std::max(output_sizes[i].size(), consumers[i].size());
+      output_sizes[i].resize(num_outputs, 0);
+      consumers[i].resize(num_outputs);
+    }
+    kept.clear();
+    for (const string& fetch : item.fetch) {
+      int port;
+      auto it = node_ids.find(ParseNodeName(fetch, &port));
+      if (it != node_ids.end()) {
+        kept.emplace(it->second, std::max(port, 0));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  int64_t Size(const NodeOutput& tensor) const {
+    const std::vector<int64_t>& sizes = output_sizes[tensor.first];
+    return tensor.second < static_cast<int>(sizes.size())
+               ? sizes[tensor.second]
+               : 0;
+  }
+
+  int NumConsumers(const NodeOutput& tensor) const {
+    const std::vector<std::vector<int>>& ports = consumers[tensor.first];
+    return tensor.second < static_cast<int>(ports.size())
+               ? ports[tensor.second].size()
+               : 0;
+  }
+
+  // Returns the memory allocated by running `node`, and the memory freed once
+  // it ran given the number of `remaining_consumers` of each tensor.
+  std::pair<int64_t, int64_t> MemoryDelta(
+      int node, const std::map<NodeOutput, int>& remaining_consumers) const {
+    int64_t allocated = 0;
+    for (int64_t size : output_sizes[node]) {
+      allocated += size;
+    }
+    int64_t freed = 0;
+    for (int port = 0, end = output_sizes[node].size(); port < end; ++port) {
+      const NodeOutput output(node, port);
+      if (NumConsumers(output) == 0 && !kept.count(output)) {
+        freed += output_sizes[node][port];
+      }
+    }
+    for (const NodeOutput& input : inputs[node]) {
+      auto it = remaining_consumers.find(input);
+      const int remaining =
+          it == remaining_consumers.end() ? NumConsumers(input) : it->second;
+      if (remaining == 1 && !kept.count(input)) {
+        freed += Size(input);
+      }
+    }
+    return {allocated, freed};
+  }
+
+  // Returns the peak memory of running the nodes in `order`, and the first
+  // position in `order` at which it is reached. If `live_at_peak` is not null,
+  // it is set to the tensors allocated at that point.
+  int64_t PeakMemory(const std::vector<int>& order, int* peak_position,
+                     std::set<NodeOutput>* live_at_peak = nullptr) const {
+    std::map<NodeOutput, int> remaining_consumers;
+    int64_t memory = 0;
+    int64_t peak = 0;
+    *peak_position = 0;
+    for (int position = 0, end = order.size(); position < end; ++position) {
+      const int node = order[position];
+      auto [allocated, freed] = MemoryDelta(node, remaining_consumers);
+      if (memory + allocated > peak) {
+        peak = memory + allocated;
+        *peak_position = position;
+      }
+      memory += allocated - freed;
+      for (const NodeOutput& input : inputs[node]) {
+        auto it = remaining_consumers.emplace(input, NumConsumers(input)).first;
+        --it->second;
+      }
+    }
+    if (live_at_peak != nullptr) {
+      live_at_peak->clear();
+      remaining_consumers.clear();
+      for (int position = 0; position <= *peak_position; ++position) {
+        const int node = order[position];
+        for (int port = 0, end = output_sizes[node].size(); port < end;
+             ++port) {
+          live_at_peak->emplace(node, port);
+        }
+        if (position == *peak_position) {
+          break;
+        }
+        for (int port = 0, end = output_sizes[node].size(); port < end;
+             ++port) {
+          const NodeOutput output(node, port);
+          if (NumConsumers(output) == 0 && !kept.count(output)) {
+            live_at_peak->erase(output);
+          }
+        }
+        for (const NodeOutput& input : inputs[node]) {
+          auto it =
+              remaining_consumers.emplace(input, NumConsumers(input)).first;
+          if (--it->second == 0 && !kept.count(input)) {
+            live_at_peak->erase(input);
+          }
+        }
+      }
+    }
+    return peak;
+  }
+
+  // Returns a topological order of the nodes that greedily runs first the node
+  // that increases the memory usage the least, the first one in the graph on
+  // ties. Running a node only changes the memory delta of its fanouts that
+  // become ready and of the last consumers of its inputs, so the ready nodes
+  // are kept in a priority queue in which only those are pushed again.
+  absl::Status GreedyOrder(std::vector<int>* order) const {
+    const int num_nodes = fanins.size();
+    std::vector<int> num_ready_fanins(num_nodes, 0);
+    std::vector<bool> scheduled(num_nodes, false);
+    // The current memory delta of each ready node. The entries of the queue
+    // with another delta are stale.
+    std::vector<int64_t> deltas(num_nodes, 0);
+    std::priority_queue<std::pair<int64_t, int>,
+                        std::vector<std::pair<int64_t, int>>,
+                        std::greater<std::pair<int64_t, int>>>
+        ready;
+    std::map<NodeOutput, int> remaining_consumers;
+    auto push = [&](int node) {
+      auto [allocated, freed] = MemoryDelta(node, remaining_consumers);
+      deltas[node] = allocated - freed;
+      ready.emplace(deltas[node], node);
+    };
+    auto is_ready = [&](int node) {
+      return !scheduled[node] &&
+             num_ready_fanins[node] == static_cast<int>(fanins[node].size());
+    };
+    for (int i = 0; i < num_nodes; ++i) {
+      if (fanins[i].empty()) {
+        push(i);
+      }
+    }
+    order->clear();
+    order->reserve(num_nodes);
+    while (!ready.empty()) {
+      const auto [delta, best] = ready.top();
+      ready.pop();
+      if (scheduled[best] || delta != deltas[best]) {
+        continue;
+      }
+      scheduled[best] = true;
+      order->push_back(best);
+      for (const NodeOutput& input : inputs[best]) {
+        auto it = remaining_consumers.emplace(input, NumConsumers(input)).first;
+        if (--it->second != 1) {
+          continue;
+        }
+        // The last consumer of the input now frees it.
+        for (int consumer : consumers[input.first][input.second]) {
+          if (is_ready(consumer)) {
+            push(consumer);
+          }
+        }
+      }
+      for (int fanout : fanouts[best]) {
+        if (++num_ready_fanins[fanout] ==
+            static_cast<int>(fanins[fanout].size())) {
+          push(fanout);
+        }
+      }
+    }
+    if (static_cast<int>(order->size()) != num_nodes) {
+      return errors::InvalidArgument("The graph has a cycle");
+    }
+    return absl::OkStatus();
+  }
+
+  std::vector<std::vector<int64_t>> output_sizes;
+  // The distinct data inputs of each node.
+  std::vector<std::vector<NodeOutput>> inputs;
+  // The distinct data and control fanins and fanouts of each node.
+  std::vector<std::vector<int>> fanins;
+  std::vector<std::vector<int>> fanouts;
+  // The nodes consuming each output of each node.
+  std::vector<std::vector<std::vector<int>>> consumers;
+  // The fetched tensors, which are never freed.
+  std::set<NodeOutput> kept;
+};
+
+bool IsOnCpu(const NodeDef& node) {
+  DeviceNameUtils::ParsedName parsed_name;
+  return node.device().empty() ||
+         (DeviceNameUtils::ParseFullName(node.device(), &parsed_name) &&
+          (!parsed_name.has_type || parsed_name.type == DEVICE_CPU));
+}
+
+// Rematerializes the outputs of cheap ops that are alive at the peak memory
+// usage of `order` but not used by it: the consumers that run after the peak
+// read a copy of the node that runs right before the first of them. Returns
+// the copies and the nodes they are copies of.
+std::unordered_map<string, string> RematerializeCheapOps(
+    const SequentialMemoryModel& model, const std::vector<int>& order,
+    const std::unordered_set<string>& nodes_to_preserve, GraphDef* graph) {
+  int peak_position;
+  std::set<SequentialMemoryModel::NodeOutput> live_at_peak;
+  model.PeakMemory(order, &peak_position, &live_at_peak);
+  std::vector<int> positions(order.size());
+  for (int position = 0, end = order.size(); position < end; ++position) {
+    positions[order[position]] = position;
+  }
+  const std::unordered_set<string> cheap_ops = GetCheapToRematerializeOps();
+  NodeMap node_map(graph);
+  std::unordered_map<string, string> copies;
+  for (const auto& [node_id, port] : live_at_peak) {
+    const NodeDef& node = graph->node(node_id);
+    // The copies made by a previous run of the pass are not copied again.
+    if (!cheap_ops.count(node.op()) || nodes_to_preserve.count(node.name()) ||
+        absl::StartsWith(node.name(),
+                         absl::StrCat(kRematerializedNodePrefix, "/")) ||
+        positions[node_id] == peak_position) {
+      continue;
+    }
+    int64_t input_size = 0;
+    for (const auto& input : model.inputs[node_id]) {
+      input_size += model.Size(input);
+    }
+    int64_t output_size = 0;
+    for (int64_t size : model.output_sizes[node_id]) {
+      output_size += size;
+    }
+    if (output_size == 0 || input_size * 4 > output_size) {
+      continue;
+    }
+    std::vector<int> late_consumers;
+    bool used_at_peak = false;
+    for (int consumer : model.consumers[node_id][port]) {
+      if (positions[consumer] > peak_position) {
+        late_consumers.push_back(consumer);
+      } else if (positions[consumer] == peak_position) {
+        used_at_peak = true;
+      }
+    }
+    const string copy_name =
+        AddPrefixToNodeName(node.name(), kRematerializedNodePrefix);
+    if (used_at_peak || late_consumers.empty() ||
+        node_map.GetNode(copy_name) != nullptr) {
+      continue;
+    }
+    int first_late_position = order.size();
+    for (int consumer : late_consumers) {
+      first_late_position = std::min(first_late_position, positions[consumer]);
+    }
+
+    NodeDef* copy = graph->add_node();
+    *copy = graph->node(node_id);
+    copy->set_name(copy_name);
+    const string& trigger = graph->node(order[first_late_position - 1]).name();
+    if (trigger != node.name()) {
+      copy->add_input(AsControlDependency(trigger));
+    }
+    node_map.AddNode(copy_name, copy);
+    for (int consumer : late_consumers) {
+      NodeDef* consumer_node = graph->mutable_node(consumer);
+      for (int i = 0; i < consumer_node->input_size(); ++i) {
+        int input_port;
+        const string input_node =
+            ParseNodeName(consumer_node->input(i), &input_port);
+        if (input_node == node.name() && input_port == port) {
+          *consumer_node->mutable_input(i) =
+              port == 0 ? copy_name : strings::StrCat(copy_name, ":", port);
+        }
+      }
+    }
+    copies[copy_name] = node.name();
+  }
+  return copies;
+}
+
+// Orders the nodes of a CPU graph to minimize its peak memory usage, as
+// estimated from the statically inferred shapes, and enforces that order with
+// control dependencies between the nodes that allocate or free a significant
+// amount of memory. With MEMORY_AWARE_REMATERIALIZATION, the cheap ops whose
+// outputs are alive at the peak are also computed again for their late
+// consumers. Returns whether the graph changed.
+bool MemoryAwareSchedulingPass(RewriterConfig::MemOptType optimization_level,
+                               Cluster* cluster, GrapplerItem* item) {
+  // Returns the peak memory usage of the simulation of the graph, which runs
+  // the ops in parallel, to report it along with the estimates of the pass.
+  auto simulated_peak_memory = [cluster](const GrapplerItem& item) {
+    GraphMemory memory(item);
+    if (cluster == nullptr ||
+        !memory.InferStatically(cluster->GetDevices()).ok()) {
+      return int64_t{-1};
+    }
+    return memory.GetWorstCaseMemoryUsage();
+  };
+  const int64_t initial_simulated_peak =
+      VLOG_IS_ON(1) ? simulated_peak_memory(*item) : -1;
+  for (const NodeDef& node : item->graph.node()) {
+    // Control dependencies would propagate the deadness of the tensors of
+    // control flow ops, and the model only accounts for a single device.
+    if (IsControlFlow(node) || !IsOnCpu(node)) {
+      VLOG(1) << "Not scheduling the graph for memory: node " << node.name()
+              << " is a control flow op or is not on CPU";
+      return false;
+    }
+  }
+  GraphProperties properties(*item);
+  absl::Status s =
+      properties.InferStatically(/*assume_valid_feeds=*/false,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer shapes: " << s.message();
+    return false;
+  }
+  SequentialMemoryModel model;
+  std::vector<const NodeDef*> topo_order;
+  std::vector<int> order;
+  s = model.Initialize(*item, properties);
+  if (s.ok()) s = ComputeTopologicalOrder(item->graph, &topo_order);
+  if (s.ok()) s = model.GreedyOrder(&order);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to schedule the graph for memory: " << s.message();
+    return false;
+  }
+  std::unordered_map<const NodeDef*, int> node_ids;
+  for (int i = 0; i < item->graph.node_size(); ++i) {
+    node_ids[&item->graph.node(i)] = i;
+  }
+  std::vector<int> initial_order;
+  initial_order.reserve(topo_order.size());
+  for (const NodeDef* node : topo_order) {
+    initial_order.push_back(node_ids[node]);
+  }
+  int peak_position;
+  const int64_t initial_peak = model.PeakMemory(initial_order, &peak_position);
+
+  std::unordered_map<string, string> copies;
+  if (optimization_level == RewriterConfig::MEMORY_AWARE_REMATERIALIZATION) {
+    const int num_nodes = item->graph.node_size();
+    copies = RematerializeCheapOps(model, order, item->NodesToPreserve(),
+                                   &item->graph);
+    if (!copies.empty()) {
+      // Run each copy right before its first consumer.
+      std::vector<int> positions(num_nodes);
+      for (int position = 0; position < num_nodes; ++position) {
+        positions[order[position]] = position;
+      }
+      std::vector<std::pair<int, int>> ranked_nodes;
+      for (int position = 0; position < num_nodes; ++position) {
+        ranked_nodes.emplace_back(2 * position + 1, order[position]);
+      }
+      s = model.Initialize(*item, properties, copies);
+      if (!s.ok()) {
+        VLOG(1) << "Failed to schedule the graph for memory: " << s.message();
+        return true;
+      }
+      for (int copy = num_nodes; copy < item->graph.node_size(); ++copy) {
+        int first_consumer = INT_MAX;
+        for (int consumer : model.fanouts[copy]) {
+          first_consumer = std::min(first_consumer, positions[consumer]);
+        }
+        ranked_nodes.emplace_back(2 * first_consumer, copy);
+      }
+      std::sort(ranked_nodes.begin(), ranked_nodes.end());
+      order.clear();
+      for (const auto& ranked_node : ranked_nodes) {
+        order.push_back(ranked_node.second);
+      }
+    }
+  }
+  const int64_t peak = model.PeakMemory(order, &peak_position);
+  if (peak >= initial_peak && copies.empty()) {
+    VLOG(1) << "The memory-aware schedule does not reduce the estimated peak "
+               "memory usage of "
+            << initial_peak << " bytes";
+    return false;
+  }
+
+  // Small allocations do not move the peak, so leave the nodes that make them
+  // free to run in parallel.
+  const int64_t min_significant_size = std::max<int64_t>(peak / 100, 1);
+  std::map<SequentialMemoryModel::NodeOutput, int> remaining_consumers;
+  std::unordered_set<string> feed_nodes;
+  for (const auto& feed : item->feed) {
+    feed_nodes.insert(NodeName(feed.first));
+  }
+  int num_control_dependencies = 0;
+  int previous = -1;
+  for (int node : order) {
+    auto [allocated, freed] = model.MemoryDelta(node, remaining_consumers);
+    for (const auto& input : model.inputs[node]) {
+      auto it =
+          remaining_consumers.emplace(input, model.NumConsumers(input)).first;
+      --it->second;
+    }
+    NodeDef* node_def = item->graph.mutable_node(node);
+    if (std::max(allocated, freed) < min_significant_size ||
+        model.fanins[node].empty() || feed_nodes.count(node_def->name())) {
+      continue;
+    }
+    if (previous >= 0 &&
+        !absl::c_binary_search(model.fanins[node], previous)) {
+      node_def->add_input(
+          AsControlDependency(item->graph.node(previous).name()));
+      ++num_control_dependencies;
+    }
+    previous = node;
+  }
+
+  VLOG(1) << "Memory-aware schedule: estimated peak memory usage reduced from "
+          << initial_peak << " to " << peak << " bytes with "
+          << num_control_dependencies << " control dependencies and "
+          << copies.size() << " rematerialized nodes";
+  if (VLOG_IS_ON(1) && cluster != nullptr) {
+    VLOG(1) << "Simulated peak memory usage reduced from "
+            << initial_simulated_peak << " to " << simulated_peak_memory(*item)
+            << " bytes";
+  }
+  return true;
+}
+
 }  // namespace
 
 absl::Status MemoryOptimizer::Optimize(Cluster* cluster,
@@ -1391,7 +1905,11 @@ absl::Status MemoryOptimizer::Optimize(Cluster* cluster,
       (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
        optimization_level_ == RewriterConfig::HEURISTICS ||
        optimization_level_ == RewriterConfig::MANUAL);
-  if (!run_recomputation_pass && nodes_to_relax.empty() && item.fetch.empty()) {
+  bool run_memory_aware_scheduling_pass =
+      (optimization_level_ == RewriterConfig::MEMORY_AWARE_SCHEDULING ||
+       optimization_level_ == RewriterConfig::MEMORY_AWARE_REMATERIALIZATION);
+  if (!run_recomputation_pass && !run_memory_aware_scheduling_pass &&
+      nodes_to_relax.empty() && item.fetch.empty()) {
     return errors::Aborted("Nothing to do.");
   }
 
@@ -1404,6 +1922,11 @@ absl::Status MemoryOptimizer::Optimize(Cluster* cluster,
                                &optimized_item.graph, item);
   }
 
+  if (run_memory_aware_scheduling_pass) {
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    MemoryAwareSchedulingPass(optimization_level_, cluster, &optimized_item);
+  }
+
   std::unordered_set<string> skip_list;
   // Bound the number of rewrite passes to avoid long processing times on graphs
   // that simply won't fit in memory.
@@ -448,6 +448,82 @@ TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   }
 }
 
+class MemoryAwareSchedulingTest : public GrapplerTest {};
+
+TEST_F(MemoryAwareSchedulingTest, ReducesBeforeAllocating) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Fill(s.WithOpName("a"), {256, 256}, 1.0f);
+  Output b = ops::Sum(s.WithOpName("b"), a, {0, 1});
+  Output c = ops::Fill(s.WithOpName("c"), {256, 256}, 2.0f);
+  Output d = ops::Sum(s.WithOpName("d"), c, {0, 1});
+  Output e = ops::Add(s.WithOpName("e"), b, d);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e"};
+
+  // A breadth-first order runs both fills before the reductions, while
+  // reducing the first fill before running the second halves the peak memory.
+  MemoryOptimizer optimizer(RewriterConfig::MEMORY_AWARE_SCHEDULING);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* second_fill = node_map.GetNode("c");
+  ASSERT_NE(second_fill, nullptr);
+  ASSERT_EQ(3, second_fill->input_size());
+  EXPECT_EQ("^b", second_fill->input(2));
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+}
+
+TEST_F(MemoryAwareSchedulingTest, RematerializesCheapOps) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Fill(s.WithOpName("a"), {256, 256}, 1.0f);
+  Output b = ops::Sum(s.WithOpName("b"), a, {0, 1});
+  Output c = ops::Fill(s.WithOpName("c"), {512, 256}, b);
+  Output d = ops::Sum(s.WithOpName("d"), c, {0, 1});
+  Output e = ops::Mul(s.WithOpName("e"), a, d);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e"};
+
+  // "a" is alive while "c" is, unless it is computed again for "e".
+  MemoryOptimizer optimizer(RewriterConfig::MEMORY_AWARE_REMATERIALIZATION);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* mul = node_map.GetNode("e");
+  ASSERT_NE(mul, nullptr);
+  EXPECT_EQ("Rematerialized/a", mul->input(0));
+  const NodeDef* copy = node_map.GetNode("Rematerialized/a");
+  ASSERT_NE(copy, nullptr);
+  EXPECT_EQ("Fill", copy->op());
+  ASSERT_EQ(3, copy->input_size());
+  EXPECT_EQ("^d", copy->input(2));
+  const NodeDef* sum = node_map.GetNode("b");
+  ASSERT_NE(sum, nullptr);
+  EXPECT_EQ("a", sum->input(0));
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+
+  // Another iteration of the meta optimizer does not copy the copy.
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  GraphDef reoptimized;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, optimized, &reoptimized));
+  NodeMap reoptimized_node_map(&reoptimized);
+  EXPECT_EQ(nullptr,
+            reoptimized_node_map.GetNode("Rematerialized/Rematerialized/a"));
+}
+
 class RelaxAllocatorConstraintsTest : public GrapplerTest {};
 
 TEST_F(RelaxAllocatorConstraintsTest, SameDevice) {
@@ -17,15 +17,18 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <string>
 #include <type_traits>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -36,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
@@ -49,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
@@ -61,9 +66,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
 
@@ -97,6 +107,29 @@ string PrintSizesBeforeAfter(const GraphDef& before, const GraphDef& after) {
                          NumEdges(after) - NumEdges(before), ")");
 }
 
+// Returns the number of threads optimizing the functions of a library
+// concurrently, from the TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS environment
+// variable, or the number of cores by default.
+int64_t NumFunctionOptimizationThreads() {
+  int64_t num_threads = 0;
+  absl::Status status = ReadInt64FromEnvVar(
+      "TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS", 0, &num_threads);
+  if (!status.ok()) {
+    LOG_FIRST_N(WARNING, 1) << status;
+  }
+  return num_threads > 0 ? num_threads : port::MaxParallelism();
+}
+
+// Returns the thread pool optimizing the functions of libraries. It is shared
+// by all meta optimizers, so that concurrent sessions or passes don't each
+// start their own threads. Its size is read when it is first used.
+thread::ThreadPool* FunctionOptimizationThreadPool() {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "grappler_function_optimization",
+      NumFunctionOptimizationThreads());
+  return thread_pool;
+}
+
 int NumIterations(const RewriterConfig& cfg) {
   return cfg.meta_optimizer_iterations() == RewriterConfig::DEFAULT_NUM_ITERS
              ? kDefaultNumberOfIterations
@@ -219,7 +252,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
          new ConstantFolding(
              cpu_device_,
              cfg_.experimental_disable_compressed_tensor_optimization(),
-             !cfg_.experimental_disable_folding_quantization_emulation()));
+             !cfg_.experimental_disable_folding_quantization_emulation(),
+             cfg_.experimental_constant_folding_budget_bytes()));
   MK_OPT("shape", "shape_optimization", new ShapeOptimizer());
   MK_OPT("remap", "remapping",
          new Remapper(cfg_.remapping(), cfg_.cpu_layout_conversion(),
@@ -808,6 +842,20 @@ absl::Status MetaOptimizer::OptimizeGraph(
   GraphOptimizer* sa_optimizer = nullptr;
 #endif
 
+  // The optimizers that infer the shapes share them through `item`, which
+  // holds the graph while each optimizer runs, and only infer again the nodes
+  // that changed since.
+  GraphProperties shared_properties(item);
+  shared_properties.EnableIncrementalUpdates();
+  for (const auto& optimizer : optimizers) {
+    optimizer->set_shared_graph_properties(&shared_properties);
+  }
+  auto unshare_properties = gtl::MakeCleanup([&optimizers]() {
+    for (const auto& optimizer : optimizers) {
+      optimizer->set_shared_graph_properties(nullptr);
+    }
+  });
+
   // Constants in the graph are normally compressed after model_pruner.
   // Do it here if model pruner is disabled.
   if (cfg_.disable_model_pruning()) {
@@ -889,7 +937,10 @@ absl::Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock lock(results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -1057,7 +1108,10 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
       {kGrapplerCategory, "*"});
 
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock lock(results_mu_);
+    optimization_results_.clear();
+  }
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -1166,11 +1220,78 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Optimizes the body of `func` into `optimized_func_graph`.
+  const auto optimize_function =
+      [&](const FunctionDef& func, Cluster* func_cluster,
+          GrapplerFunctionItem* func_item,
+          GraphDef* optimized_func_graph) -> absl::Status {
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    const string& func_name = func.signature().name();
+
+    // Make a GrapplerItem from a FunctionDef.
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(func, flib, producer, func_item));
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    func_item->optimization_options().allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item->devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item->optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    // Optimize function body graph.
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item->graph.release_library());
+      *func_item->graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      return implementation_selector.Optimize(func_cluster, *func_item,
+                                              optimized_func_graph);
+    }
+    GrapplerFunctionItem func_item_copy = *func_item;
+    return OptimizeGraph(func_cluster, std::move(func_item_copy),
+                         optimized_func_graph);
+  };
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
+    // The functions of a pass are optimized independently of each other, from
+    // the function library at the start of the pass, so that they can be
+    // optimized concurrently and the results do not depend on the number of
+    // threads.
+    std::vector<const FunctionDef*> funcs;
     int function_idx = 0;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -1202,67 +1323,76 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    std::vector<GrapplerFunctionItem> func_items(funcs.size());
+    std::vector<GraphDef> optimized_func_graphs(funcs.size());
+    std::vector<absl::Status> func_statuses(funcs.size());
+    size_t first_result;
+    {
+      mutex_lock lock(results_mu_);
+      first_result = optimization_results_.size();
+    }
+    // The functions are optimized on this thread if it is one of the pool, so
+    // that a nested meta optimizer doesn't wait for threads it occupies.
+    thread::ThreadPool* thread_pool =
+        funcs.size() > 1 && NumFunctionOptimizationThreads() > 1
+            ? FunctionOptimizationThreadPool()
+            : nullptr;
+    if (thread_pool != nullptr && thread_pool->NumThreads() > 1 &&
+        thread_pool->CurrentThreadId() == -1) {
+      BlockingCounter counter(funcs.size());
+      for (int i = 0; i < funcs.size(); ++i) {
+        thread_pool->Schedule([&, i]() {
+          // `Cluster::Initialize` and `Run` are not thread-safe, so each
+          // function gets a virtual cluster with the devices of `cluster`.
+          std::unique_ptr<VirtualCluster> func_cluster;
+          if (cluster != nullptr) {
+            func_cluster = std::make_unique<VirtualCluster>(
+                cluster->GetDevices());
+          }
+          func_statuses[i] =
+              optimize_function(*funcs[i], func_cluster.get(), &func_items[i],
+                                &optimized_func_graphs[i]);
+          counter.DecrementCount();
+        });
       }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+      counter.Wait();
+    } else {
+      for (int i = 0; i < funcs.size(); ++i) {
+        func_statuses[i] = optimize_function(
+            *funcs[i], cluster, &func_items[i], &optimized_func_graphs[i]);
+      }
+    }
+    // Order the results of the functions as if they were optimized one after
+    // another.
+    {
+      absl::flat_hash_map<string, int> func_indices;
+      for (int i = 0; i < funcs.size(); ++i) {
+        func_indices[funcs[i]->signature().name()] = i;
       }
+      const auto func_index = [&](const GraphOptimizationResult& result) {
+        const auto it = func_indices.find(result.id);
+        return it == func_indices.end() ? -1 : it->second;
+      };
+      mutex_lock lock(results_mu_);
+      std::stable_sort(optimization_results_.begin() + first_result,
+                       optimization_results_.end(),
+                       [&](const GraphOptimizationResult& a,
+                           const GraphOptimizationResult& b) {
+                         return func_index(a) < func_index(b);
+                       });
+    }
+
+    // Update the function library in the order of the functions.
+    for (int i = 0; i < funcs.size(); ++i) {
+      TF_RETURN_IF_ERROR(func_statuses[i]);
 
       // Function body optimization might have created new specialized
       // functions for each instantiation context. Add them to the library.
       for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
+           optimized_func_graphs[i].library().function()) {
         if (flib.Find(func_def.signature().name()) == nullptr) {
           TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
         }
@@ -1270,11 +1400,12 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
 
       // Convert optimized graph back to FunctionDef.
       FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+      func_items[i].SwapFunctionBody(std::move(optimized_func_graphs[i]));
+      TF_RETURN_IF_ERROR(MakeFunctionDef(func_items[i], flib, &optimized_func));
 
       // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+      TF_RETURN_IF_ERROR(
+          flib.ReplaceFunction(funcs[i]->signature().name(), optimized_func));
     }
 
     // If optimized at least one function, update the graph library.
@@ -1322,6 +1453,7 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
 }
 
 string MetaOptimizer::GetResultString() const {
+  tf_shared_lock lock(results_mu_);
   std::string result_string;
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     absl::StrAppend(&result_string,
@@ -1371,11 +1503,40 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
 absl::Status RunMetaOptimizer(GrapplerItem&& item, const ConfigProto& cfg,
                               DeviceBase* cpu_device, Cluster* cluster,
                               GraphDef* optimized_graph) {
+  std::unique_ptr<MetaOptimizerCache> cache =
+      MetaOptimizerCache::FromEnvironment(Env::Default());
+  if (cache != nullptr && !MetaOptimizerCache::IsCacheable(cfg)) {
+    cache = nullptr;
+  }
+  Fprint128 cache_key;
+  if (cache != nullptr) {
+    cache_key = MetaOptimizerCache::ComputeKey(item, cfg, cluster);
+    std::vector<string> required_nodes = item.fetch;
+    required_nodes.insert(required_nodes.end(), item.keep_ops.begin(),
+                          item.keep_ops.end());
+    if (cache->Lookup(cache_key, required_nodes, optimized_graph).ok()) {
+      return absl::OkStatus();
+    }
+  }
+
+  const absl::Time optimization_start_time = absl::Now();
   MetaOptimizer optimizer(cpu_device, cfg);
   optimizer.set_deadline_usec(
       DeadlineMicroSeconds(cfg.graph_options().rewrite_options()));
-  return optimizer.OptimizeConsumeItem(cluster, std::move(item),
-                                       optimized_graph);
+  TF_RETURN_IF_ERROR(optimizer.OptimizeConsumeItem(cluster, std::move(item),
+                                                   optimized_graph));
+
+  // Graphs optimized past the deadline may not be fully optimized, and are not
+  // worth reusing.
+  if (cache != nullptr && !optimizer.DeadlineExceeded()) {
+    const absl::Status status =
+        cache->Insert(cache_key, *optimized_graph,
+                      absl::Now() - optimization_start_time);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to cache the optimized graph: " << status;
+    }
+  }
+  return absl::OkStatus();
 }
 
 absl::Status OptimizeGraph(
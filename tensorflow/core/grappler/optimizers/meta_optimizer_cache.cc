@@ -0,0 +1,300 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/validate.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/raw_coding.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// An entry file is a header followed by the serialized optimized GraphDef.
+// The header holds, as fixed size little endian integers: the magic number and
+// the format version, the key of the entry, the optimization time it saves in
+// microseconds, and the masked CRC32C of the GraphDef.
+constexpr uint32_t kMagic = 0x63677466;  // "ftgc"
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kHeaderSize = 4 + 4 + 8 + 8 + 8 + 4;
+
+// Appends `piece` to `data`, prefixed with its size so that the concatenation
+// of the pieces is unambiguous.
+void AppendPiece(absl::string_view piece, std::string* data) {
+  core::PutVarint64(data, piece.size());
+  data->append(piece.data(), piece.size());
+}
+
+void AppendMessage(const protobuf::MessageLite& message, std::string* data) {
+  std::string serialized;
+  SerializeToStringDeterministic(message, &serialized);
+  AppendPiece(serialized, data);
+}
+
+void AppendPieces(std::vector<std::string> pieces, bool sort,
+                  std::string* data) {
+  if (sort) std::sort(pieces.begin(), pieces.end());
+  core::PutVarint64(data, pieces.size());
+  for (const std::string& piece : pieces) AppendPiece(piece, data);
+}
+
+}  // namespace
+
+std::unique_ptr<MetaOptimizerCache> MetaOptimizerCache::FromEnvironment(
+    Env* env) {
+  const std::string dir_name =
+      absl::StrCat(getenv(kGrapplerCachingEnvVariableName));
+  if (dir_name.empty()) return nullptr;
+  return std::make_unique<MetaOptimizerCache>(env, dir_name);
+}
+
+MetaOptimizerCache::MetaOptimizerCache(
+    Env* env, std::string dir_name, absl::Duration caching_threshold_duration,
+    const OpRegistryInterface* op_registry)
+    : env_(env),
+      dir_name_(std::move(dir_name)),
+      caching_threshold_duration_(caching_threshold_duration),
+      op_registry_(op_registry) {}
+
+bool MetaOptimizerCache::IsCacheable(const ConfigProto& cfg) {
+  const RewriterConfig& rewrite_cfg = cfg.graph_options().rewrite_options();
+  if (!rewrite_cfg.custom_optimizers().empty()) return false;
+  if (rewrite_cfg.optimizers().empty()) return true;
+  const std::vector<string> custom_optimizers =
+      CustomGraphOptimizerRegistry::GetRegisteredOptimizers();
+  for (const string& optimizer_name : rewrite_cfg.optimizers()) {
+    if (std::find(custom_optimizers.begin(), custom_optimizers.end(),
+                  optimizer_name) != custom_optimizers.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Fprint128 MetaOptimizerCache::ComputeKey(const GrapplerItem& item,
+                                         const ConfigProto& cfg,
+                                         const Cluster* cluster) {
+  std::string data;
+  // Optimizers change between releases, and so do their results.
+  AppendPiece(TF_VERSION_STRING, &data);
+  core::PutVarint64(&data, TF_GRAPH_DEF_VERSION);
+
+  AppendMessage(item.graph, &data);
+  AppendPieces(item.fetch, /*sort=*/false, &data);
+  std::vector<std::string> feed;
+  feed.reserve(item.feed.size());
+  for (const auto& [name, tensor] : item.feed) {
+    feed.push_back(absl::StrCat(name, ":", DataTypeString(tensor.dtype()), ":",
+                                tensor.shape().DebugString()));
+  }
+  AppendPieces(std::move(feed), /*sort=*/false, &data);
+  AppendPieces(item.init_ops, /*sort=*/false, &data);
+  AppendPieces(item.keep_ops, /*sort=*/true, &data);
+  AppendPieces({item.devices().begin(), item.devices().end()}, /*sort=*/true,
+               &data);
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  AppendPiece(absl::StrCat(options.allow_non_differentiable_rewrites,
+                           options.allow_pruning_stateful_and_dataset_ops,
+                           options.optimize_function_library,
+                           options.is_eager_mode, ":",
+                           options.intra_op_parallelism_threads),
+              &data);
+
+  // The meta optimizer only reads the graph and experimental options, and the
+  // session metadata names the session rather than changing its optimization.
+  ConfigProto key_cfg;
+  *key_cfg.mutable_graph_options() = cfg.graph_options();
+  *key_cfg.mutable_experimental() = cfg.experimental();
+  key_cfg.mutable_experimental()->clear_session_metadata();
+  AppendMessage(key_cfg, &data);
+
+  if (cluster != nullptr) {
+    std::vector<std::pair<string, DeviceProperties>> devices(
+        cluster->GetDevices().begin(), cluster->GetDevices().end());
+    std::sort(devices.begin(), devices.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    core::PutVarint64(&data, devices.size());
+    for (const auto& [name, properties] : devices) {
+      AppendPiece(name, &data);
+      AppendMessage(properties, &data);
+    }
+  }
+
+  return Fingerprint128(data);
+}
+
+std::string MetaOptimizerCache::FileName(const Fprint128& key) const {
+  return io::JoinPath(dir_name_, absl::StrFormat("grappler_%016x%016x.pb",
+                                                 key.high64, key.low64));
+}
+
+absl::Status MetaOptimizerCache::Lookup(
+    const Fprint128& key, const std::vector<std::string>& required_nodes,
+    GraphDef* optimized_graph) {
+  const std::string file_name = FileName(key);
+  if (!env_->FileExists(file_name).ok()) {
+    metrics::IncrementFunctionGraphOptimizationCacheMissCount(
+        1, metrics::GraphOptimizationSource::kGrappler);
+    return absl::NotFoundError(
+        absl::StrCat("No optimized graph cached in ", file_name));
+  }
+
+  int64_t optimization_usecs = 0;
+  const absl::Status status =
+      Read(key, required_nodes, optimized_graph, &optimization_usecs);
+  if (!status.ok()) {
+    metrics::IncrementFunctionGraphOptimizationCacheFailureCount(
+        1, metrics::GraphOptimizationSource::kGrappler);
+    LOG(WARNING) << "Ignoring the invalid optimized graph cached in "
+                 << file_name << ": " << status;
+    return status;
+  }
+
+  metrics::IncrementFunctionGraphOptimizationCacheHitCount(
+      1, metrics::GraphOptimizationSource::kGrappler);
+  metrics::UpdateFunctionGraphOptimizationSavingTime(
+      optimization_usecs, metrics::GraphOptimizationSource::kGrappler);
+  VLOG(1) << "Restored the optimized graph from " << file_name << ", saving "
+          << absl::ToInt64Milliseconds(absl::Microseconds(optimization_usecs))
+          << " msecs of optimization";
+  return absl::OkStatus();
+}
+
+absl::Status MetaOptimizerCache::Read(
+    const Fprint128& key, const std::vector<std::string>& required_nodes,
+    GraphDef* optimized_graph, int64_t* optimization_usecs) {
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env_, FileName(key), &contents));
+  if (contents.size() < kHeaderSize) {
+    return absl::DataLossError("Truncated header");
+  }
+  const char* header = contents.data();
+  if (core::DecodeFixed32(header) != kMagic ||
+      core::DecodeFixed32(header + 4) != kFormatVersion) {
+    return absl::DataLossError("Unknown format");
+  }
+  if (core::DecodeFixed64(header + 8) != key.low64 ||
+      core::DecodeFixed64(header + 16) != key.high64) {
+    return absl::DataLossError("Key mismatch");
+  }
+  *optimization_usecs = static_cast<int64_t>(core::DecodeFixed64(header + 24));
+  const absl::string_view payload =
+      absl::string_view(contents).substr(kHeaderSize);
+  if (crc32c::Unmask(core::DecodeFixed32(header + 32)) !=
+      crc32c::Value(payload.data(), payload.size())) {
+    return absl::DataLossError("Checksum mismatch");
+  }
+
+  GraphDef graph;
+  if (!graph.ParseFromArray(payload.data(), payload.size())) {
+    return absl::DataLossError("Failed to parse the optimized GraphDef");
+  }
+  // The ops may have changed since the entry was written, e.g. by loading a
+  // different set of custom op libraries.
+  const FunctionLibraryDefinition flib(op_registry_, graph.library());
+  TF_RETURN_IF_ERROR(ValidateGraphDef(graph, flib));
+  absl::flat_hash_set<absl::string_view> nodes;
+  for (const NodeDef& node : graph.node()) nodes.insert(node.name());
+  for (const std::string& required_node : required_nodes) {
+    if (!nodes.contains(NodeName(required_node))) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "The optimized graph lacks the node ", NodeName(required_node)));
+    }
+  }
+  *optimized_graph = std::move(graph);
+  return absl::OkStatus();
+}
+
+absl::Status MetaOptimizerCache::Insert(const Fprint128& key,
+                                        const GraphDef& optimized_graph,
+                                        absl::Duration optimization_duration) {
+  if (optimization_duration < caching_threshold_duration_) {
+    return absl::OkStatus();
+  }
+  std::string payload;
+  if (!SerializeToStringDeterministic(optimized_graph, &payload)) {
+    return absl::InternalError("Failed to serialize the optimized GraphDef");
+  }
+  std::string contents;
+  contents.reserve(kHeaderSize + payload.size());
+  core::PutFixed32(&contents, kMagic);
+  core::PutFixed32(&contents, kFormatVersion);
+  core::PutFixed64(&contents, key.low64);
+  core::PutFixed64(&contents, key.high64);
+  core::PutFixed64(&contents, absl::ToInt64Microseconds(optimization_duration));
+  core::PutFixed32(&contents,
+                   crc32c::Mask(crc32c::Value(payload.data(), payload.size())));
+  contents.append(payload);
+
+  if (!env_->FileExists(dir_name_).ok()) {
+    TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(dir_name_));
+  }
+  bool has_atomic_move = false;
+  TF_RETURN_IF_ERROR(env_->HasAtomicMove(dir_name_, &has_atomic_move));
+  if (!has_atomic_move) {
+    LOG_EVERY_POW_2(WARNING)
+        << "Filesystem of the Grappler cache at " << dir_name_
+        << " does not support atomic moves, so processes sharing it may read "
+           "partially written entries, which are then ignored.";
+  }
+  // Writes a unique temporary file first, so that concurrent readers and
+  // writers of the same entry only ever see complete files.
+  const std::string file_name = FileName(key);
+  std::string temp_file_name = file_name;
+  if (!env_->CreateUniqueFileName(&temp_file_name, ".tmp")) {
+    return absl::UnavailableError(
+        absl::StrCat("Could not create a unique file inside ", dir_name_));
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(env_, temp_file_name, contents));
+  const absl::Status status = env_->RenameFile(temp_file_name, file_name);
+  if (!status.ok()) {
+    env_->DeleteFile(temp_file_name).IgnoreError();
+    return status;
+  }
+  VLOG(1) << "Cached the optimized graph in " << file_name;
+  return absl::OkStatus();
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,106 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Environment variable holding the directory of the persistent cache of the
+// graphs optimized by the meta optimizer. The cache is disabled when it is
+// unset or empty.
+inline constexpr char kGrapplerCachingEnvVariableName[] =
+    "TF_GRAPPLER_CACHE_DIR";
+
+// Only the graphs that took at least this long to optimize are cached.
+inline constexpr absl::Duration kGrapplerCachingThresholdDuration =
+    absl::Seconds(1);
+
+// Persistent cache of the graphs optimized by the meta optimizer, e.g. to not
+// pay for the optimization of the same model every time a server starts.
+//
+// The entries are files named after a fingerprint of everything the
+// optimization depends on: the input graph and its fetch, feed and preserved
+// nodes, the optimization options, the graph and rewriter configs, the devices
+// and the TensorFlow version. The files are written atomically, so a directory
+// can be shared by processes, and are checksummed and validated against the op
+// registry when read, a corrupted or stale entry being a miss.
+class MetaOptimizerCache {
+ public:
+  // Returns the cache in the directory of `kGrapplerCachingEnvVariableName`, or
+  // nullptr if it is not set.
+  static std::unique_ptr<MetaOptimizerCache> FromEnvironment(Env* env);
+
+  MetaOptimizerCache(Env* env, std::string dir_name,
+                     absl::Duration caching_threshold_duration =
+                         kGrapplerCachingThresholdDuration,
+                     const OpRegistryInterface* op_registry =
+                         OpRegistry::Global());
+
+  // Returns whether the optimizations of `cfg` are deterministic functions of
+  // the key, which is not known for custom optimizers.
+  static bool IsCacheable(const ConfigProto& cfg);
+
+  // Returns the key of the optimization of `item` with `cfg` on the devices of
+  // `cluster`, which may be null.
+  static Fprint128 ComputeKey(const GrapplerItem& item, const ConfigProto& cfg,
+                              const Cluster* cluster);
+
+  // Reads the optimized graph of `key` into `optimized_graph`, checking that
+  // it contains the `required_nodes`. Returns a NotFound error on a miss, and
+  // another error if the entry is invalid.
+  absl::Status Lookup(const Fprint128& key,
+                      const std::vector<std::string>& required_nodes,
+                      GraphDef* optimized_graph);
+
+  // Writes the optimized graph of `key`, if `optimization_duration` is at
+  // least the caching threshold.
+  absl::Status Insert(const Fprint128& key, const GraphDef& optimized_graph,
+                      absl::Duration optimization_duration);
+
+  // Returns the path of the file of `key`.
+  std::string FileName(const Fprint128& key) const;
+
+ private:
+  absl::Status Read(const Fprint128& key,
+                    const std::vector<std::string>& required_nodes,
+                    GraphDef* optimized_graph, int64_t* optimization_usecs);
+
+  Env* const env_;
+  const std::string dir_name_;
+  const absl::Duration caching_threshold_duration_;
+  const OpRegistryInterface* const op_registry_;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
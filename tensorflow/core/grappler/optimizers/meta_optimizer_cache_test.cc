@@ -0,0 +1,176 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include <string>
+
+#include "absl/time/time.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using metrics::GraphOptimizationSource;
+
+bool operator==(const Fprint128& a, const Fprint128& b) {
+  return a.low64 == b.low64 && a.high64 == b.high64;
+}
+
+GrapplerItem MakeItem(float value) {
+  Scope s = Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), value, {2});
+  Output b = ops::Const(s.WithOpName("b"), 2.0f, {2});
+  Output c = ops::Mul(s.WithOpName("c"), a, b);
+  GrapplerItem item;
+  item.fetch.push_back("c");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  return item;
+}
+
+class MetaOptimizerCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_name_ = io::JoinPath(testing::TmpDir(), "meta_optimizer_cache_test",
+                             std::to_string(Env::Default()->NowMicros()));
+  }
+
+  MetaOptimizerCache MakeCache() {
+    return MetaOptimizerCache(Env::Default(), dir_name_, absl::ZeroDuration());
+  }
+
+  std::string dir_name_;
+};
+
+TEST_F(MetaOptimizerCacheTest, KeyDependsOnTheOptimizationInputs) {
+  const GrapplerItem item = MakeItem(1.0f);
+  ConfigProto cfg;
+  const Fprint128 key = MetaOptimizerCache::ComputeKey(item, cfg, nullptr);
+  EXPECT_TRUE(key == MetaOptimizerCache::ComputeKey(MakeItem(1.0f), cfg,
+                                                    nullptr));
+  EXPECT_FALSE(key == MetaOptimizerCache::ComputeKey(MakeItem(3.0f), cfg,
+                                                     nullptr));
+
+  GrapplerItem other_fetch = item;
+  other_fetch.fetch = {"a"};
+  EXPECT_FALSE(key ==
+               MetaOptimizerCache::ComputeKey(other_fetch, cfg, nullptr));
+
+  ConfigProto other_cfg;
+  other_cfg.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  EXPECT_FALSE(key ==
+               MetaOptimizerCache::ComputeKey(item, other_cfg, nullptr));
+
+  // The session metadata does not change the optimization.
+  ConfigProto named_cfg;
+  named_cfg.mutable_experimental()->mutable_session_metadata()->set_name("m");
+  EXPECT_TRUE(key == MetaOptimizerCache::ComputeKey(item, named_cfg, nullptr));
+}
+
+TEST_F(MetaOptimizerCacheTest, CustomOptimizersAreNotCacheable) {
+  ConfigProto cfg;
+  EXPECT_TRUE(MetaOptimizerCache::IsCacheable(cfg));
+  cfg.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->add_custom_optimizers()
+      ->set_name("Custom");
+  EXPECT_FALSE(MetaOptimizerCache::IsCacheable(cfg));
+}
+
+TEST_F(MetaOptimizerCacheTest, RestoresInsertedGraph) {
+  MetaOptimizerCache cache = MakeCache();
+  const GrapplerItem item = MakeItem(1.0f);
+  const Fprint128 key = MetaOptimizerCache::ComputeKey(item, {}, nullptr);
+
+  const int64_t misses = metrics::GetFunctionGraphOptimizationCacheMissCount(
+      GraphOptimizationSource::kGrappler);
+  GraphDef restored;
+  EXPECT_TRUE(absl::IsNotFound(cache.Lookup(key, item.fetch, &restored)));
+  EXPECT_EQ(metrics::GetFunctionGraphOptimizationCacheMissCount(
+                GraphOptimizationSource::kGrappler),
+            misses + 1);
+
+  TF_ASSERT_OK(cache.Insert(key, item.graph, absl::Milliseconds(5)));
+  const int64_t hits = metrics::GetFunctionGraphOptimizationCacheHitCount(
+      GraphOptimizationSource::kGrappler);
+  const uint64 saved_usecs =
+      metrics::GetFunctionGraphOptimizationSavingTimeUsecs(
+          GraphOptimizationSource::kGrappler);
+  TF_ASSERT_OK(cache.Lookup(key, item.fetch, &restored));
+  EXPECT_EQ(restored.SerializeAsString(), item.graph.SerializeAsString());
+  EXPECT_EQ(metrics::GetFunctionGraphOptimizationCacheHitCount(
+                GraphOptimizationSource::kGrappler),
+            hits + 1);
+  EXPECT_EQ(metrics::GetFunctionGraphOptimizationSavingTimeUsecs(
+                GraphOptimizationSource::kGrappler),
+            saved_usecs + 5000);
+}
+
+TEST_F(MetaOptimizerCacheTest, SkipsFastOptimizations) {
+  MetaOptimizerCache cache(Env::Default(), dir_name_, absl::Seconds(1));
+  const GrapplerItem item = MakeItem(1.0f);
+  const Fprint128 key = MetaOptimizerCache::ComputeKey(item, {}, nullptr);
+  TF_ASSERT_OK(cache.Insert(key, item.graph, absl::Milliseconds(5)));
+  EXPECT_FALSE(Env::Default()->FileExists(cache.FileName(key)).ok());
+}
+
+TEST_F(MetaOptimizerCacheTest, RejectsInvalidEntries) {
+  MetaOptimizerCache cache = MakeCache();
+  const GrapplerItem item = MakeItem(1.0f);
+  const Fprint128 key = MetaOptimizerCache::ComputeKey(item, {}, nullptr);
+  TF_ASSERT_OK(cache.Insert(key, item.graph, absl::Milliseconds(5)));
+
+  GraphDef restored;
+  EXPECT_FALSE(cache.Lookup(key, {"c", "missing"}, &restored).ok());
+
+  std::string contents;
+  TF_ASSERT_OK(
+      ReadFileToString(Env::Default(), cache.FileName(key), &contents));
+  contents.back() ^= 1;
+  TF_ASSERT_OK(
+      WriteStringToFile(Env::Default(), cache.FileName(key), contents));
+  const int64_t failures =
+      metrics::GetFunctionGraphOptimizationCacheFailureCount(
+          GraphOptimizationSource::kGrappler);
+  EXPECT_TRUE(absl::IsDataLoss(cache.Lookup(key, item.fetch, &restored)));
+  EXPECT_EQ(metrics::GetFunctionGraphOptimizationCacheFailureCount(
+                GraphOptimizationSource::kGrappler),
+            failures + 1);
+
+  // An entry of another key is not used either.
+  TF_ASSERT_OK(cache.Insert(key, item.graph, absl::Milliseconds(5)));
+  const Fprint128 other_key =
+      MetaOptimizerCache::ComputeKey(MakeItem(3.0f), {}, nullptr);
+  TF_ASSERT_OK(Env::Default()->CopyFile(cache.FileName(key),
+                                        cache.FileName(other_key)));
+  EXPECT_TRUE(
+      absl::IsDataLoss(cache.Lookup(other_key, item.fetch, &restored)));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
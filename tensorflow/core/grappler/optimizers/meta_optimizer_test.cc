@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
 #include <atomic>
+#include <cstdlib>
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -34,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
@@ -420,6 +423,72 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+// Returns a graph calling `num_functions` distinct non-inlined functions, whose
+// bodies have Identity nodes to remove.
+GrapplerItem MakeFunctionLibraryItem(int num_functions) {
+  using test::function::NDef;
+
+  std::vector<FunctionDef> functions;
+  std::vector<NodeDef> nodes = {
+      NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  GrapplerItem item;
+  item.id = "tf_graph";
+  for (int i = 0; i < num_functions; ++i) {
+    const string name = absl::StrCat("MyFunc", i);
+    FunctionDef func = FunctionDefHelper::Create(
+        name, {"x:float"}, {"z:float"}, {},
+        {{{"square"}, "Mul", {"x", "x"}, {{"T", DT_FLOAT}}},
+         {{"id0"}, "Identity", {"square:z:0"}, {{"T", DT_FLOAT}}},
+         {{"id1"}, "Identity", {"id0:output:0"}, {{"T", DT_FLOAT}}},
+         {{"sum"}, "AddN", {"id1:output:0", "id1:output:0"},
+          {{"T", DT_FLOAT}, {"N", 2}}},
+         {{"cube"}, "Mul", {"sum:sum:0", "x"}, {{"T", DT_FLOAT}}}},
+        /*ret_def=*/
+        {{"z", "cube:z:0"}});
+    (*func.mutable_attr())["_noinline"].set_b(true);
+    functions.push_back(std::move(func));
+    const string call = absl::StrCat("call", i);
+    nodes.push_back(NDef(call, name, {"x"}, {}, kDevice));
+    item.fetch.push_back(call);
+  }
+  item.graph = test::function::GDef(nodes, functions);
+  return item;
+}
+
+// Optimizes the function library of `item` with `num_threads` threads.
+GraphDef OptimizeFunctionLibrary(const GrapplerItem& item, int num_threads) {
+  setenv("TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS",
+         absl::StrCat(num_threads).c_str(), /*overwrite=*/1);
+  ConfigProto config_proto;
+  config_proto.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_min_graph_nodes(-1);
+  MetaOptimizer optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+  unsetenv("TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS");
+  return output;
+}
+
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryConcurrently) {
+  const GrapplerItem item = MakeFunctionLibraryItem(16);
+  const GraphDef sequential = OptimizeFunctionLibrary(item, 1);
+  const GraphDef concurrent = OptimizeFunctionLibrary(item, 4);
+
+  CompareGraphs(sequential, concurrent);
+  FunctionLibraryDefinition sequential_flib(OpRegistry::Global(),
+                                            sequential.library());
+  FunctionLibraryDefinition concurrent_flib(OpRegistry::Global(),
+                                            concurrent.library());
+  ASSERT_EQ(sequential_flib.num_functions(), concurrent_flib.num_functions());
+  for (const string& name : sequential_flib.ListFunctionNames()) {
+    const FunctionDef* sequential_func = sequential_flib.Find(name);
+    const FunctionDef* concurrent_func = concurrent_flib.Find(name);
+    ASSERT_NE(concurrent_func, nullptr) << name;
+    EXPECT_TRUE(FunctionDefsEqual(*sequential_func, *concurrent_func)) << name;
+  }
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
@@ -1412,6 +1481,22 @@ INSTANTIATE_TEST_SUITE_P(
       return test_name;
     });
 
+void BM_OptimizeFunctionLibrary(::testing::benchmark::State& state) {
+  const int num_functions = state.range(0);
+  const int num_threads = state.range(1);
+  const GrapplerItem item = MakeFunctionLibraryItem(num_functions);
+  for (auto s : state) {
+    OptimizeFunctionLibrary(item, num_threads);
+  }
+  state.SetItemsProcessed(state.iterations() * num_functions);
+}
+BENCHMARK(BM_OptimizeFunctionLibrary)
+    ->ArgPair(64, 1)
+    ->ArgPair(64, 8)
+    ->ArgPair(1024, 1)
+    ->ArgPair(1024, 8)
+    ->ArgPair(1024, 32);
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
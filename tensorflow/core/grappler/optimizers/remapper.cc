@@ -115,6 +115,7 @@ struct RemapperContext {
         graph_view(&item->graph, status),
         graph_properties(*item),
         inferred_graph_properties(false),
+        shared_graph_properties(nullptr),
         cpu_layout_conversion(cpu_layout_conversion),
         xla_auto_clustering_on(xla_auto_clustering_on),
         xla_cpu_jit_disable_fusion(xla_cpu_jit_disable_fusion) {}
@@ -123,11 +124,34 @@ struct RemapperContext {
   utils::MutableGraphView graph_view;
   GraphProperties graph_properties;
   bool inferred_graph_properties;
+  // The properties shared with the other optimizers, until a node is remapped.
+  GraphProperties* shared_graph_properties;
   RewriterConfig::CpuLayout cpu_layout_conversion;
   bool xla_auto_clustering_on;
   bool xla_cpu_jit_disable_fusion;
 };
 
+// Infers the graph properties with the given options, unless they were
+// inferred already.
+absl::Status InferGraphProperties(RemapperContext* ctx,
+                                  bool assume_valid_feeds,
+                                  bool include_input_tensor_values,
+                                  bool include_output_tensor_values) {
+  if (ctx->inferred_graph_properties) return absl::OkStatus();
+  TF_RETURN_IF_ERROR(ctx->graph_properties.InferStaticallyFromShared(
+      ctx->shared_graph_properties, assume_valid_feeds,
+      /*aggressive_shape_inference=*/false, include_input_tensor_values,
+      include_output_tensor_values));
+  ctx->inferred_graph_properties = true;
+  return absl::OkStatus();
+}
+
+// Applies `mutation` to the graph, which no longer has the shared properties.
+absl::Status ApplyMutation(RemapperContext* ctx, utils::Mutation* mutation) {
+  ctx->shared_graph_properties = nullptr;
+  return mutation->Apply();
+}
+
 // FusedBatchNorm that can be replaced with a cheaper set of primitives.
 struct FusedBatchNorm {
   FusedBatchNorm() = default;
@@ -279,6 +303,18 @@ struct ContractionWithBiasAddAndAdd {
   int bias_port = 1;
 };
 
+// FusedMatMul node followed by an Add of a residual, e.g. the skip connection
+// of a transformer block.
+struct FusedMatMulWithAdd {
+  FusedMatMulWithAdd() = default;
+  FusedMatMulWithAdd(int fused_matmul, int add, int port_id)
+      : fused_matmul(fused_matmul), add(add), port_id(port_id) {}
+
+  int fused_matmul = kMissingIndex;
+  int add = kMissingIndex;
+  int port_id = 0;
+};
+
 // Contraction node followed by a BiasAdd, Add and Relu.
 // Plus Tanh and Sigmoid for MatMul in MKL
 struct ContractionWithBiasAndAddActivation {
@@ -1185,6 +1221,60 @@ bool FindContractionWithBiasAddAndAdd(const RemapperContext& ctx,
   return FindContractionWithBiasAddAndAdd(ctx, *node_view, matched);
 }
 
+// Without oneDNN, only the Eigen `_FusedMatMul` kernel supports the residual
+// Add of a contraction.
+bool FindMatMulWithBiasAddAndAdd(const RemapperContext& ctx, int node_index,
+                                 ContractionWithBiasAddAndAdd* matched) {
+  if (IsMKLEnabled() || ctx.xla_cpu_jit_disable_fusion) return false;
+  if (!FindContractionWithBiasAddAndAdd(ctx, node_index, matched)) {
+    return false;
+  }
+  const NodeDef* contraction =
+      ctx.graph_view.GetNode(matched->contraction)->node();
+  return IsMatMul(*contraction) && IsCpuCompatibleMatMul(ctx, contraction);
+}
+
+// Finds the Add of a residual to a `_FusedMatMul` with a Gelu activation,
+// which is only fused once the Gelu subgraph has been remapped.
+bool FindFusedMatMulWithAdd(const RemapperContext& ctx, int node_index,
+                            FusedMatMulWithAdd* matched) {
+  if (IsMKLEnabled() || ctx.xla_cpu_jit_disable_fusion) return false;
+
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  // TODO(lyandy): Forward controls for patterns with control dependencies.
+  if (HasControlFaninOrFanout(*node_view) || node_view->NumRegularFanins() != 2)
+    return false;
+
+  // Root of the pattern must be a AddN or Add with same input shapes
+  // (no broadcasting).
+  const auto* node_def = node_view->node();
+  if (!IsAddN(*node_def) && !IsAddWithNoBroadcast(ctx, *node_def)) return false;
+  if (!NodeIsOnCpu(node_def) || !HasDataType(node_def, DT_FLOAT)) return false;
+
+  for (int port_id = 0; port_id < 2; ++port_id) {
+    const auto* fused_matmul_view =
+        node_view->GetRegularFanin(port_id).node_view();
+    const auto* fused_matmul = fused_matmul_view->node();
+    if (fused_matmul->op() != kFusedMatMul || !NodeIsOnCpu(fused_matmul) ||
+        HasControlFaninOrFanout(*fused_matmul_view) ||
+        fused_matmul_view->GetRegularFanout(0).size() != 1 ||
+        !HaveSameDataType(node_def, fused_matmul) ||
+        IsInPreserveSet(ctx, fused_matmul))
+      continue;
+
+    std::vector<string> fused_ops;
+    if (!TryGetNodeAttr(*fused_matmul, "fused_ops", &fused_ops) ||
+        fused_ops.size() != 2 || fused_ops[0] != "BiasAdd" ||
+        (fused_ops[1] != "GeluApproximate" && fused_ops[1] != "GeluExact"))
+      continue;
+
+    *matched = FusedMatMulWithAdd(fused_matmul_view->node_index(), node_index,
+                                  port_id);
+    return true;
+  }
+  return false;
+}
+
 bool FindContractionWithBiasAndAddActivation(
     const RemapperContext& ctx, int node_index,
     ContractionWithBiasAndAddActivation* matched) {
@@ -1626,9 +1716,11 @@ bool FindMatMulBiasAddAndGelu(RemapperContext* ctx, int node_index,
                               std::map<string, int>* matched_nodes_map,
                               std::set<int>* remove_node_indices,
                               bool* is_gelu_approximate) {
-  // Gelu fusion is enabled with oneDNN or cublasLt or cuDNN library.
+  // Gelu fusion is enabled with oneDNN or cublasLt or cuDNN library, and with
+  // the Eigen output kernels on CPU.
   if (!IsMKLEnabled() && !BlasLtMatmulEnabled() &&
-      !RuntimeFusionEnabled(cluster))
+      !RuntimeFusionEnabled(cluster) &&
+      !NodeIsOnCpu(ctx->graph_view.GetNode(node_index)->node()))
     return false;
 
   using utils::MatchingDirection;
@@ -1751,11 +1843,13 @@ bool FindMatMulBiasAddAndGelu(RemapperContext* ctx, int node_index,
 
     DataType matmul_dtype = GetDataTypeFromAttr(*matmul_node, "T");
 
-    bool cpu_ok = IsMKLEnabled() && IsCpuCompatibleMatMul(*ctx, matmul_node);
-    // Currently, the fusion is not supported on CPU for transpose_a in the
-    // MatMul op.
-    cpu_ok = cpu_ok && matmul_node->attr().contains("transpose_a") &&
-             !matmul_node->attr().at("transpose_a").b();
+    bool cpu_ok = IsCpuCompatibleMatMul(*ctx, matmul_node);
+    // Currently, the oneDNN fusion is not supported on CPU for transpose_a in
+    // the MatMul op.
+    if (IsMKLEnabled()) {
+      cpu_ok = cpu_ok && matmul_node->attr().contains("transpose_a") &&
+               !matmul_node->attr().at("transpose_a").b();
+    }
 
     bool gpu_ok = NodeIsOnGpu(matmul_node) && RuntimeFusionEnabled(cluster) &&
                   matmul_dtype == DT_HALF;
@@ -1797,11 +1891,11 @@ bool FindMatMulBiasAddAndGelu(RemapperContext* ctx, int node_index,
 
     // matmul_node is already the _FusedMatMul and we don't need to check its
     // data type again.
-    if (!IsMKLEnabled() && !NodeIsOnGpu(matmul_node)) return false;
+    if (!NodeIsOnCpu(matmul_node) && !NodeIsOnGpu(matmul_node)) return false;
 
-    // Currently, the fusion is not supported on CPU for transpose_a in the
-    // MatMul op.
-    if (NodeIsOnCpu(matmul_node) &&
+    // Currently, the oneDNN fusion is not supported on CPU for transpose_a in
+    // the MatMul op.
+    if (IsMKLEnabled() && NodeIsOnCpu(matmul_node) &&
         matmul_node->attr().contains("transpose_a") &&
         matmul_node->attr().at("transpose_a").b()) {
       return false;
@@ -2139,13 +2233,21 @@ bool IsCommonNormPattern(RemapperContext* ctx, int node_index,
 
 // Keras LayerNormalization api uses multiple TensorFlow ops. Current fusion
 // pattern is only for the case, when LayerNormalization uses FusedBatcNormV3.
-// We further restrict it to only 2D or 3D tensor inputs to keras
-// LayerNormalization api.
-bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
-                      std::map<string, int>* matched_nodes_map,
-                      std::set<int>* remove_node_indices,
-                      std::vector<string>* input_node_names, float* epsilon) {
-  if (!IsMKLEnabled()) return false;
+// With oneDNN, we further restrict it to only 2D or 3D tensor inputs to keras
+// LayerNormalization api. Without oneDNN, the pattern is fused into the Eigen
+// _FusedLayerNorm on CPU, which normalizes the innermost dimension of inputs
+// of any rank.
+bool FindLayerNorm(RemapperContext* ctx, int node_index,
+                   std::map<string, int>* matched_nodes_map,
+                   std::set<int>* remove_node_indices,
+                   std::vector<string>* input_node_names, float* epsilon) {
+  if (!IsMKLEnabled()) {
+    const NodeDef* node_def = ctx->graph_view.GetNode(node_index)->node();
+    if (!NodeIsOnCpu(node_def)) return false;
+    if (!(HasDataType(node_def, DT_FLOAT) || HasDataType(node_def, DT_HALF) ||
+          HasDataType(node_def, DT_BFLOAT16)))
+      return false;
+  }
 
   // The following pattern will be searched in the graph with additional
   // contraints. Here * means any type of op.
@@ -2235,14 +2337,11 @@ bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
 
   // Additional check for LayerNorm
   if (found_op_type_match) {
-    if (!ctx->inferred_graph_properties) {
-      absl::Status s = ctx->graph_properties.InferStatically(
-          /*assume_valid_feeds=*/true,
-          /*aggressive_shape_inference=*/false,
-          /*include_input_tensor_values=*/true,
-          /*include_output_tensor_values=*/true);
-      if (!s.ok()) return false;
-      ctx->inferred_graph_properties = true;
+    if (!InferGraphProperties(ctx, /*assume_valid_feeds=*/true,
+                              /*include_input_tensor_values=*/true,
+                              /*include_output_tensor_values=*/true)
+             .ok()) {
+      return false;
     }
     *epsilon = 0.001;  // default value
     // Keras layer-norm uses FusedBatchNorm in training mode. Check the
@@ -2318,13 +2417,10 @@ bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
       auto input_node_props =
           ctx->graph_properties.GetOutputProperties(input_node->name());
       int rank = Rank(input_node_props[0].shape());
-      if (dtype == DT_INT32) {
-        if (static_cast<int32>(rank - 1) != mean_axis_tensor.flat<int32>()(0))
-          return false;
-      } else {
-        if (static_cast<int64>(rank - 1) != mean_axis_tensor.flat<int64>()(0))
-          return false;
-      }
+      const int64_t axis = dtype == DT_INT32
+                               ? mean_axis_tensor.flat<int32>()(0)
+                               : mean_axis_tensor.flat<int64>()(0);
+      if (axis != rank - 1 && axis != -1) return false;
       auto* gamma_node =
           ctx->graph_view.GetNode(matched_nodes_map->at("gamma"))->node();
       auto* beta_node =
@@ -2349,14 +2445,148 @@ bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
     if (ShapesSymbolicallyEqual(input_props[0].shape(),
                                 output_props[0].shape())) {
       int rank = Rank(input_props[0].shape());
-      if (rank < 2 || rank > 3) return false;
+      if (IsMKLEnabled() && (rank < 2 || rank > 3)) return false;
+      if (rank < 1) return false;
     } else {
       return false;
     }
+
+    // _FusedLayerNorm requires a gamma and a beta of the innermost dimension,
+    // and not some other broadcastable shape.
+    if (!IsMKLEnabled()) {
+      const TensorShapeProto& input_shape = input_props[0].shape();
+      const auto& depth = input_shape.dim(input_shape.dim_size() - 1);
+      if (!IsKnown(depth)) return false;
+      for (const char* label : {"gamma", "beta"}) {
+        const NodeDef* node_def =
+            ctx->graph_view.GetNode(matched_nodes_map->at(label))->node();
+        const auto& props =
+            ctx->graph_properties.GetOutputProperties(node_def->name());
+        if (props.empty() || Rank(props[0].shape()) != 1 ||
+            props[0].shape().dim(0).size() != depth.size())
+          return false;
+      }
+    }
   }
   return found_op_type_match;
 }
 
+// Softmax written with the primitive ops, with the maximum subtracted for
+// numerical stability, is replaced with the Softmax op that computes it in a
+// single pass over the logits.
+bool FindSoftmax(RemapperContext* ctx, int node_index,
+                 std::map<string, int>* matched_nodes_map,
+                 std::set<int>* remove_node_indices) {
+  const NodeDef* node_def = ctx->graph_view.GetNode(node_index)->node();
+  if (!NodeIsOnCpu(node_def)) return false;
+  if (!(HasDataType(node_def, DT_FLOAT) || HasDataType(node_def, DT_HALF) ||
+        HasDataType(node_def, DT_BFLOAT16) || HasDataType(node_def, DT_DOUBLE)))
+    return false;
+
+  using utils::MatchingDirection;
+  using utils::NodeStatus;
+  // clang-format off
+  //              Subgraph for fusion
+  //              -------------------
+  //
+  //     *(input)  Const
+  //      |    \   /
+  //      |     Max
+  //       \   /
+  //        Sub
+  //         |
+  //        Exp   Const                               *(input)
+  //         |  \  /                                     |
+  //         |   Sum                                  Softmax
+  //          \  /
+  //       RealDiv(output)
+  utils::OpTypePattern softmax_pattern =
+    {"RealDiv|Div", "output", NodeStatus::kReplace,
+      {
+        {"Exp", "exp", NodeStatus::kRemove,
+          {
+            {"Sub", "sub", NodeStatus::kRemove,
+              {
+                {"*", "input", NodeStatus::kRemain},
+                {"Max", "max", NodeStatus::kRemove,
+                  {
+                    {"*", "input", NodeStatus::kRemain},
+                    {"Const", "max_axis", NodeStatus::kRemain}
+                  }
+                }
+              }
+            }
+          }
+        },
+        {"Sum", "sum", NodeStatus::kRemove,
+          {
+            {"Exp", "exp", NodeStatus::kRemove},
+            {"Const", "sum_axis", NodeStatus::kRemain}
+          }
+        }
+      }
+    };
+  // clang-format on
+
+  utils::SubGraphMatcher<MatchingDirection::kFollowInputs> graph_matcher(
+      &(ctx->graph_view));
+  matched_nodes_map->clear();
+  remove_node_indices->clear();
+  if (!graph_matcher.GetMatchedNodes(softmax_pattern, ctx->nodes_to_preserve,
+                                     ctx->graph_view.GetNode(node_index),
+                                     matched_nodes_map, remove_node_indices)) {
+    return false;
+  }
+
+  // Max and Sum must both reduce the innermost dimension only, and keep it
+  // so that their results broadcast against the logits.
+  const NodeDef* sub_node =
+      ctx->graph_view.GetNode(matched_nodes_map->at("sub"))->node();
+  int rank = -1;
+  for (const char* label : {"max", "sum"}) {
+    const NodeDef* reduction =
+        ctx->graph_view.GetNode(matched_nodes_map->at(label))->node();
+    bool keep_dims = false;
+    if (!TryGetNodeAttr(*reduction, "keep_dims", &keep_dims) || !keep_dims)
+      return false;
+
+    const NodeDef* axis_node =
+        ctx->graph_view
+            .GetNode(matched_nodes_map->at(absl::StrCat(label, "_axis")))
+            ->node();
+    Tensor axis_tensor;
+    if (!axis_tensor.FromProto(axis_node->attr().at("value").tensor()) ||
+        axis_tensor.NumElements() != 1)
+      return false;
+    int64_t axis;
+    if (axis_tensor.dtype() == DT_INT32) {
+      axis = axis_tensor.flat<int32>()(0);
+    } else if (axis_tensor.dtype() == DT_INT64) {
+      axis = axis_tensor.flat<int64_t>()(0);
+    } else {
+      return false;
+    }
+    if (axis == -1) continue;
+
+    // A non-negative axis must be the last one of the logits.
+    if (rank < 0) {
+      if (!InferGraphProperties(ctx, /*assume_valid_feeds=*/true,
+                                /*include_input_tensor_values=*/true,
+                                /*include_output_tensor_values=*/false)
+               .ok()) {
+        return false;
+      }
+      const auto& props =
+          ctx->graph_properties.GetInputProperties(sub_node->name());
+      if (props.empty()) return false;
+      rank = Rank(props[0].shape());
+      if (rank < 1) return false;
+    }
+    if (axis != rank - 1) return false;
+  }
+  return true;
+}
+
 bool FindFusedBatchNorm(const RemapperContext& ctx, int node_index,
                         FusedBatchNorm* matched) {
   const auto* node_view = ctx.graph_view.GetNode(node_index);
@@ -2948,14 +3178,11 @@ bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
   // multiplicand is scalar, (ii) BatchMatmulV2 output is 4D tensor, and (iii)
   // addend is 4D tensor with second dim_size = 1.
   if (!found_op_type_match) return false;
-  if (!ctx->inferred_graph_properties) {
-    absl::Status s = ctx->graph_properties.InferStatically(
-        /*assume_valid_feeds=*/true,
-        /*aggressive_shape_inference=*/false,
-        /*include_input_tensor_values=*/false,
-        /*include_output_tensor_values=*/true);
-    if (!s.ok()) return false;
-    ctx->inferred_graph_properties = true;
+  if (!InferGraphProperties(ctx, /*assume_valid_feeds=*/true,
+                            /*include_input_tensor_values=*/false,
+                            /*include_output_tensor_values=*/true)
+           .ok()) {
+    return false;
   }
   NodeDef* multiplicand_node_def =
       ctx->graph_view.GetNode(matched_nodes_map->at("multiplicand"))->node();
@@ -3040,14 +3267,11 @@ bool FindInstanceNorm(RemapperContext* ctx, int node_index,
   }
 
   // Additional checks for InstanceNorm
-  if (!ctx->inferred_graph_properties) {
-    absl::Status s = ctx->graph_properties.InferStatically(
-        /*assume_valid_feeds=*/true,
-        /*aggressive_shape_inference=*/false,
-        /*include_input_tensor_values=*/false,
-        /*include_output_tensor_values=*/true);
-    if (!s.ok()) return false;
-    ctx->inferred_graph_properties = true;
+  if (!InferGraphProperties(ctx, /*assume_valid_feeds=*/true,
+                            /*include_input_tensor_values=*/false,
+                            /*include_output_tensor_values=*/true)
+           .ok()) {
+    return false;
   }
 
   NodeDef* mean1_node =
@@ -3342,7 +3566,7 @@ absl::Status AddFusedContractionNode(RemapperContext* ctx,
   absl::Status status;
   mutation->AddNode(std::move(fused_op), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched.bias_add] = true;
   (*nodes_to_delete)[matched.contraction] = true;
@@ -3395,7 +3619,7 @@ absl::Status AddFusedContractionNode(RemapperContext* ctx,
   absl::Status status;
   mutation->AddNode(std::move(fused_op), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*nodes_to_delete)[matched.contraction] = true;
   (*invalidated_nodes)[matched.activation] = true;
@@ -3448,7 +3672,7 @@ absl::Status AddFusedContractionNode(
   absl::Status status;
   mutation->AddNode(std::move(fused_op), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*nodes_to_delete)[matched.contraction] = true;
   (*nodes_to_delete)[matched.bias_add] = true;
@@ -3503,7 +3727,7 @@ absl::Status AddFusedConvNode(RemapperContext* ctx,
   TF_RETURN_IF_ERROR(status);
   mutation->AddNode(std::move(remapped_squeeze), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched.contraction] = true;
   (*invalidated_nodes)[matched.bias_add] = true;
@@ -3543,7 +3767,7 @@ absl::Status AddFusedConv2DNode(RemapperContext* ctx,
   absl::Status status;
   mutation->AddNode(std::move(fused_conv2d), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched.fused_batch_norm] = true;
   (*nodes_to_delete)[matched.contraction] = true;
@@ -3586,7 +3810,7 @@ absl::Status AddFusedConv2DNode(
   absl::Status status;
   mutation->AddNode(std::move(fused_conv2d), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched.activation] = true;
   (*nodes_to_delete)[matched.contraction] = true;
@@ -3639,7 +3863,7 @@ absl::Status AddFusedContractionNode(
   absl::Status status;
   mutation->AddNode(std::move(contraction_node), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched.add] = true;
   (*nodes_to_delete)[matched.contraction] = true;
@@ -3648,6 +3872,39 @@ absl::Status AddFusedContractionNode(
   return absl::OkStatus();
 }
 
+absl::Status AddFusedMatMulWithAddNode(RemapperContext* ctx,
+                                       const FusedMatMulWithAdd& matched,
+                                       std::vector<bool>* invalidated_nodes,
+                                       std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& fused_matmul = graph->node(matched.fused_matmul);
+  const NodeDef& add = graph->node(matched.add);
+  VLOG(2) << "Fuse " << add.op() << " with " << fused_matmul.op() << ":"
+          << " add=" << add.name() << " fused_matmul=" << fused_matmul.name();
+
+  // Keeps the inputs and attributes of the fused matmul, and appends the
+  // residual to its arguments.
+  NodeDef fused_op = fused_matmul;
+  fused_op.set_name(add.name());
+  fused_op.add_input(add.input(1 - matched.port_id));
+
+  std::vector<string> fused_ops;
+  TF_RETURN_IF_ERROR(GetNodeAttr(fused_matmul, "fused_ops", &fused_ops));
+  SetFusedOpAttributes(&fused_op, {fused_ops[0], fused_ops[1], "Add"},
+                       /*num_args=*/2);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  absl::Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
+
+  (*invalidated_nodes)[matched.add] = true;
+  (*nodes_to_delete)[matched.fused_matmul] = true;
+
+  return absl::OkStatus();
+}
+
 absl::Status AddFusedConv3DNode(RemapperContext* ctx,
                                 const PadWithConv3D& matched,
                                 std::vector<bool>* invalidated_nodes,
@@ -3694,7 +3951,7 @@ absl::Status AddFusedConv3DNode(RemapperContext* ctx,
   absl::Status status;
   mutation->AddNode(std::move(fused_node), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched.contraction_idx] = true;
   (*nodes_to_delete)[matched.pad_idx] = true;
@@ -3738,7 +3995,7 @@ absl::Status AddFusedContractionNode(
   absl::Status status;
   mutation->AddNode(std::move(fused_conv), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched.activation] = true;
   (*nodes_to_delete)[matched.add] = true;
@@ -3780,7 +4037,7 @@ absl::Status FuseContractionWithBiasAddAndHardSwish(
   absl::Status status;
   mutation->AddNode(std::move(fused_node), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
   (*invalidated_nodes)[matched_nodes_map->at("output")] = true;
 
   for (const auto& node_idx : *remove_node_indices) {
@@ -3831,7 +4088,7 @@ absl::Status FuseConv2DSwish(RemapperContext* ctx,
   absl::Status status;
   mutation->AddNode(std::move(fused_op), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched_nodes_map.at("mulToswish")] = true;
 
@@ -3876,7 +4133,7 @@ absl::Status AddFusedMatMulBiasAddAndGelu(
   absl::Status status;
   mutation->AddNode(std::move(fused_node), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
   (*invalidated_nodes)[matched_nodes_map.at("output")] = true;
 
   for (const auto& node_idx : remove_node_indices) {
@@ -3885,19 +4142,19 @@ absl::Status AddFusedMatMulBiasAddAndGelu(
   return absl::OkStatus();
 }
 
-absl::Status AddMklLayerNorm(RemapperContext* ctx,
-                             const std::map<string, int>& matched_nodes_map,
-                             const std::set<int>& remove_node_indices,
-                             const std::vector<string>& input_node_names,
-                             std::vector<bool>* invalidated_nodes,
-                             std::vector<bool>* nodes_to_delete,
-                             const float epsilon) {
+absl::Status AddLayerNorm(RemapperContext* ctx,
+                          const std::map<string, int>& matched_nodes_map,
+                          const std::set<int>& remove_node_indices,
+                          const std::vector<string>& input_node_names,
+                          std::vector<bool>* invalidated_nodes,
+                          std::vector<bool>* nodes_to_delete,
+                          const float epsilon) {
   auto* output_node =
       ctx->graph_view.GetNode(matched_nodes_map.at("output"))->node();
 
   NodeDef fused_node;
   fused_node.set_name(output_node->name());
-  fused_node.set_op("_MklLayerNorm");
+  fused_node.set_op(IsMKLEnabled() ? "_MklLayerNorm" : "_FusedLayerNorm");
   fused_node.set_device(output_node->device());
   for (const auto& name : input_node_names) fused_node.add_input(name);
   auto* attr = fused_node.mutable_attr();
@@ -3909,7 +4166,39 @@ absl::Status AddMklLayerNorm(RemapperContext* ctx,
   absl::Status status;
   mutation->AddNode(std::move(fused_node), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
+  (*invalidated_nodes)[matched_nodes_map.at("output")] = true;
+
+  for (const auto& node_idx : remove_node_indices) {
+    (*nodes_to_delete)[node_idx] = true;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReplaceWithSoftmax(RemapperContext* ctx,
+                                const std::map<string, int>& matched_nodes_map,
+                                const std::set<int>& remove_node_indices,
+                                std::vector<bool>* invalidated_nodes,
+                                std::vector<bool>* nodes_to_delete) {
+  const NodeDef* output =
+      ctx->graph_view.GetNode(matched_nodes_map.at("output"))->node();
+  const NodeDef* sub =
+      ctx->graph_view.GetNode(matched_nodes_map.at("sub"))->node();
+  VLOG(2) << "Replace decomposed softmax with Softmax: output="
+          << output->name();
+
+  NodeDef softmax;
+  softmax.set_name(output->name());
+  softmax.set_op("Softmax");
+  softmax.set_device(output->device());
+  softmax.add_input(sub->input(0));  // logits
+  (*softmax.mutable_attr())["T"] = output->attr().at("T");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  absl::Status status;
+  mutation->AddNode(std::move(softmax), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
   (*invalidated_nodes)[matched_nodes_map.at("output")] = true;
 
   for (const auto& node_idx : remove_node_indices) {
@@ -3957,7 +4246,7 @@ absl::Status ReplaceMulMaximumWithLeakyRelu(
   absl::Status status;
   mutation->AddNode(std::move(fused_op), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched_nodes_map.at("max_to_leakyrelu")] = true;
 
@@ -3990,7 +4279,7 @@ absl::Status ReplaceSigmoidMulWithSwish(
   absl::Status status;
   mutation->AddNode(std::move(fused_op), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched_nodes_map.at("mul_to_swish")] = true;
 
@@ -4059,7 +4348,7 @@ absl::Status AddFusedBatchNormExNode(RemapperContext* ctx,
   TF_RETURN_IF_ERROR(status);
   mutation->AddNode(std::move(identity_op), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched.fused_batch_norm] = true;
   (*invalidated_nodes)[matched.activation] = true;
@@ -4131,7 +4420,7 @@ absl::Status AddFusedBatchNormGradExNode(RemapperContext* ctx,
     mutation->AddNode(std::move(identity_op), &status);
     TF_RETURN_IF_ERROR(status);
   }
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched.fused_batch_norm_grad] = true;
   if (matched.side_input_grad != kMissingIndex) {
@@ -4336,7 +4625,7 @@ absl::Status AddBatchNormNodes(RemapperContext* ctx,
   mutation->AddNode(std::move(r), &status);
   TF_RETURN_IF_ERROR(status);
 
-  return mutation->Apply();
+  return ApplyMutation(ctx, mutation);
 }
 
 absl::Status AddTensorToHashBucketNode(RemapperContext* ctx,
@@ -4369,7 +4658,7 @@ absl::Status AddTensorToHashBucketNode(RemapperContext* ctx,
   absl::Status status;
   mutation->AddNode(std::move(fused_op), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
 
   (*invalidated_nodes)[matched.string_to_hash_bucket] = true;
   (*nodes_to_delete)[matched.as_string] = true;
@@ -4401,7 +4690,7 @@ absl::Status AddFusedBatchMatMul(RemapperContext* ctx,
   absl::Status status;
   mutation->AddNode(std::move(fused_node), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
   (*invalidated_nodes)[matched_nodes_map.at("output")] = true;
 
   for (const auto& node_idx : remove_node_indices) {
@@ -4522,7 +4811,7 @@ absl::Status AddMklFusedInstanceNorm(RemapperContext* ctx,
   absl::Status status;
   mutation->AddNode(std::move(fused_node), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
   if (fuse_activation) {
     (*invalidated_nodes)[matched_nodes_map->at("activation")] = true;
   } else {
@@ -4696,7 +4985,7 @@ absl::Status ReplaceSoftplusTanhAndMulWithMish(
   absl::Status status;
   mutation->AddNode(std::move(fused_node), &status);
   TF_RETURN_IF_ERROR(status);
-  TF_RETURN_IF_ERROR(mutation->Apply());
+  TF_RETURN_IF_ERROR(ApplyMutation(ctx, mutation));
   (*invalidated_nodes)[matched_nodes_map->at("mul_to_mish")] = true;
 
   for (const auto& node_index : *remove_node_indices) {
@@ -4856,11 +5145,23 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
            is_act_biasadd_conv_candidate() || IsBiasAdd(*node_def) ||
            IsTranspose(*node_def);
 
+  // Candidate for the residual Add of a fused MatMul without oneDNN.
+  const auto is_matmul_add_fusion_candidate = [&]() -> bool {
+    if (!IsAdd(*node_def) || node_view->NumRegularFanins() != 2) return false;
+    if (IsContractionWithAdd(ctx, node_index)) return true;
+    for (int i = 0; i < 2; ++i) {
+      if (node_view->GetRegularFanin(i).node_view()->node()->op() ==
+          kFusedMatMul)
+        return true;
+    }
+    return false;
+  };
+
   return is_act_biasadd_conv_candidate() || is_batch_norm_candidate() ||
          is_batch_norm_fusion_candidate() ||
          is_batch_norm_grad_fusion_candidate() ||
          is_matmul_gelu_exact_fusion_candidate() ||
-         is_act_biasadd_matmul_candidate();
+         is_act_biasadd_matmul_candidate() || is_matmul_add_fusion_candidate();
 }
 
 inline bool IsXlaCpuGlobalJitOn() {
@@ -4890,6 +5191,8 @@ absl::Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   TF_RETURN_IF_ERROR(
       ctx.graph_view.SortTopologically(/*ignore_cycles=*/false, {}));
 
+  ctx.shared_graph_properties = shared_graph_properties();
+
   const int num_nodes = item.graph.node_size();
   // Skip nodes that were invalidated by a remapper, e.g. do not process BiasAdd
   // and Activation nodes that were fused into a Conv2D node.
@@ -4911,12 +5214,10 @@ absl::Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     if (!ctx.inferred_graph_properties &&
         RequiresInferredShapes(ctx, i, cluster)) {
       const bool assume_valid_feeds = opt_level_ == RewriterConfig::AGGRESSIVE;
-      TF_RETURN_IF_ERROR(ctx.graph_properties.InferStatically(
-          assume_valid_feeds,
-          /*aggressive_shape_inference=*/false,
+      TF_RETURN_IF_ERROR(InferGraphProperties(
+          &ctx, assume_valid_feeds,
           /*include_input_tensor_values=*/true,
           /*include_output_tensor_values=*/false));
-      ctx.inferred_graph_properties = true;
     }
 
     ContractionWithBiasAddAndAdd contract_with_bias_and_add;
@@ -5089,9 +5390,9 @@ absl::Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       remove_node_indices.clear();
       input_node_names.clear();
       float epsilon = 0.001;
-      if (FindMklLayerNorm(&ctx, i, &matched_nodes_map, &remove_node_indices,
-                           &input_node_names, &epsilon)) {
-        TF_RETURN_IF_ERROR(AddMklLayerNorm(
+      if (FindLayerNorm(&ctx, i, &matched_nodes_map, &remove_node_indices,
+                        &input_node_names, &epsilon)) {
+        TF_RETURN_IF_ERROR(AddLayerNorm(
             &ctx, matched_nodes_map, remove_node_indices, input_node_names,
             &invalidated_nodes, &nodes_to_delete, epsilon));
         continue;
@@ -5120,6 +5421,35 @@ absl::Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       }
     }
 
+    // Without oneDNN, remap the layer norm subgraphs into the Eigen
+    // _FusedLayerNorm.
+    if (!IsMKLEnabled() && allow_non_differentiable_rewrites &&
+        !ctx.xla_cpu_jit_disable_fusion) {
+      std::map<string, int> matched_nodes_map;
+      std::set<int> remove_node_indices;
+      std::vector<string> input_node_names;
+      float epsilon = 0.001;
+      if (FindLayerNorm(&ctx, i, &matched_nodes_map, &remove_node_indices,
+                        &input_node_names, &epsilon)) {
+        TF_RETURN_IF_ERROR(AddLayerNorm(
+            &ctx, matched_nodes_map, remove_node_indices, input_node_names,
+            &invalidated_nodes, &nodes_to_delete, epsilon));
+        continue;
+      }
+    }
+
+    // Remap the decomposed softmax into Softmax.
+    {
+      std::map<string, int> matched_nodes_map;
+      std::set<int> remove_node_indices;
+      if (FindSoftmax(&ctx, i, &matched_nodes_map, &remove_node_indices)) {
+        TF_RETURN_IF_ERROR(
+            ReplaceWithSoftmax(&ctx, matched_nodes_map, remove_node_indices,
+                               &invalidated_nodes, &nodes_to_delete));
+        continue;
+      }
+    }
+
     // Remap MatMul + BiasAdd + gelu-subgraph
     std::map<string, int> matched_nodes_map;
     std::set<int> remove_node_indices;
@@ -5132,6 +5462,26 @@ absl::Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap MatMul+BiasAdd+{Add,AddN} into the _FusedMatMul without oneDNN.
+    ContractionWithBiasAddAndAdd matmul_with_bias_and_add;
+    if (allow_non_differentiable_rewrites &&
+        FindMatMulWithBiasAddAndAdd(ctx, i, &matmul_with_bias_and_add)) {
+      TF_RETURN_IF_ERROR(AddFusedContractionNode(&ctx, matmul_with_bias_and_add,
+                                                 &invalidated_nodes,
+                                                 &nodes_to_delete));
+      continue;
+    }
+
+    // Remap _FusedMatMul(BiasAdd+Gelu)+{Add,AddN} into the _FusedMatMul
+    // without oneDNN.
+    FusedMatMulWithAdd fused_matmul_with_add;
+    if (allow_non_differentiable_rewrites &&
+        FindFusedMatMulWithAdd(ctx, i, &fused_matmul_with_add)) {
+      TF_RETURN_IF_ERROR(AddFusedMatMulWithAddNode(
+          &ctx, fused_matmul_with_add, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // Fusions are disabled on XLA CPU in IsCpuCompatible(...) invoked by the
     // following fusions.
     //
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/cc/ops/nn_ops_internal.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -1699,6 +1700,251 @@ class FuseMklLayerNormPattern : public RemapperTest {
 
 TEST_F(FuseMklLayerNormPattern, F32) { RunTest<DT_FLOAT>(); }
 
+TEST_F(RemapperTest, FuseLayerNorm) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "Test only applicable to Eigen.";
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input = Placeholder(s.WithOpName("input"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 3, 8}));
+  auto add_const = ops::Const(s.WithOpName("add_const"), 1.0f, {2, 3, 8});
+  auto add = ops::Add(s.WithOpName("b_add"), add_const, input);
+  auto r_indices = ops::Const(s.WithOpName("r_indices"), {-1}, {1});
+  ops::Mean::Attrs attrs;
+  attrs = attrs.KeepDims(true);
+  auto mean = ops::Mean(s.WithOpName("mean"), add, r_indices, attrs);
+  auto sub = ops::Sub(s.WithOpName("sub"), add, mean);
+  auto s_diff = ops::SquaredDifference(s.WithOpName("s_diff"), mean, add);
+  auto variance = ops::Mean(s.WithOpName("variance"), s_diff, r_indices, attrs);
+  auto e_const = ops::Const(s.WithOpName("e_const"), {0.001f}, {});
+  auto add_1 = ops::AddV2(s.WithOpName("add_1"), e_const, variance);
+  auto rsqrt = ops::Rsqrt(s.WithOpName("rsqrt"), add_1);
+  auto mul = ops::Mul(s.WithOpName("mul"), sub, rsqrt);
+  auto g_const = ops::Const(s.WithOpName("g_const"), 2.0f, {8});
+  auto mul_1 = ops::Mul(s.WithOpName("mul_1"), g_const, mul);
+  auto b_const = ops::Const(s.WithOpName("b_const"), 0.5f, {8});
+  auto add_2 = ops::AddV2(s.WithOpName("add_2"), mul_1, b_const);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), add_2);
+
+  auto input_t = GenerateTensorWithSetRandom<DT_FLOAT>({2, 3, 8});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"input", input_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "add_2") {
+      EXPECT_EQ(node.op(), "_FusedLayerNorm");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "b_add");
+      EXPECT_EQ(node.input(1), "g_const");
+      EXPECT_EQ(node.input(2), "b_const");
+      EXPECT_FLOAT_EQ(node.attr().at("epsilon").f(), 0.001f);
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-4);
+}
+
+TEST_F(RemapperTest, FuseSoftmax) {
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto logits = Placeholder(s.WithOpName("logits"), DT_FLOAT,
+                            ops::Placeholder::Shape({4, 16}));
+  auto axis = ops::Const(s.WithOpName("axis"), {-1}, {1});
+  auto max = ops::Max(s.WithOpName("max"), logits, axis,
+                      ops::Max::Attrs().KeepDims(true));
+  auto sub = ops::Sub(s.WithOpName("sub"), logits, max);
+  auto exp = ops::Exp(s.WithOpName("exp"), sub);
+  auto sum = ops::Sum(s.WithOpName("sum"), exp, axis,
+                      ops::Sum::Attrs().KeepDims(true));
+  auto softmax = ops::RealDiv(s.WithOpName("softmax"), exp, sum);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), softmax);
+
+  auto logits_t = GenerateRandomTensor<DT_FLOAT>({4, 16});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"logits", logits_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "exp");
+    if (node.name() == "softmax") {
+      EXPECT_EQ(node.op(), "Softmax");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "logits");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseMatMulWithBiasAndResidualAdd) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "Test only applicable to Eigen.";
+  using ::tensorflow::ops::Placeholder;
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto lhs = Placeholder(s.WithOpName("lhs"), DT_FLOAT,
+                         ops::Placeholder::Shape({8, 32}));
+  auto rhs = Placeholder(s.WithOpName("rhs"), DT_FLOAT,
+                         ops::Placeholder::Shape({32, 64}));
+  auto bias = Placeholder(s.WithOpName("bias"), DT_FLOAT,
+                          ops::Placeholder::Shape({64}));
+  auto residual = Placeholder(s.WithOpName("residual"), DT_FLOAT,
+                              ops::Placeholder::Shape({8, 64}));
+
+  auto matmul = ops::MatMul(s.WithOpName("matmul"), lhs, rhs);
+  auto bias_add = ops::BiasAdd(s.WithOpName("bias_add"), matmul, bias);
+  auto add = ops::AddV2(s.WithOpName("add"), residual, bias_add);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), add);
+
+  auto lhs_t = GenerateRandomTensor<DT_FLOAT>({8, 32});
+  auto rhs_t = GenerateRandomTensor<DT_FLOAT>({32, 64});
+  auto bias_t = GenerateRandomTensor<DT_FLOAT>({64});
+  auto residual_t = GenerateRandomTensor<DT_FLOAT>({8, 64});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"lhs", lhs_t},
+               {"rhs", rhs_t},
+               {"bias", bias_t},
+               {"residual", residual_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "add") {
+      EXPECT_EQ(node.op(), "_FusedMatMul");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "lhs");
+      EXPECT_EQ(node.input(1), "rhs");
+      EXPECT_EQ(node.input(2), "bias");
+      EXPECT_EQ(node.input(3), "residual");
+      EXPECT_EQ(node.attr().at("num_args").i(), 2);
+
+      const auto fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 2);
+      EXPECT_EQ(fused_ops[0], "BiasAdd");
+      EXPECT_EQ(fused_ops[1], "Add");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+}
+
+TEST_F(RemapperTest, FuseFusedMatMulWithGeluAndResidualAdd) {
+  if (IsMKLEnabled()) GTEST_SKIP() << "Test only applicable to Eigen.";
+  using test::function::NDef;
+  const string cpu = "/device:CPU:0";
+
+  auto placeholder = [&](const string& name, const TensorShape& shape) {
+    return NDef(name, "Placeholder", {},
+                {{"dtype", DT_FLOAT}, {"shape", shape}}, cpu);
+  };
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {placeholder("lhs", {8, 32}), placeholder("rhs", {32, 64}),
+       placeholder("bias", {64}), placeholder("residual", {8, 64}),
+       NDef("fused_matmul", "_FusedMatMul", {"lhs", "rhs", "bias"},
+            {{"T", DT_FLOAT},
+             {"transpose_a", false},
+             {"transpose_b", false},
+             {"num_args", 1},
+             {"fused_ops", std::vector<string>{"BiasAdd", "GeluExact"}},
+             {"epsilon", 0.0001f},
+             {"leakyrelu_alpha", 0.2f}},
+            cpu),
+       NDef("add", "AddV2", {"fused_matmul", "residual"}, {{"T", DT_FLOAT}},
+            cpu),
+       NDef("fetch", "Identity", {"add"}, {{"T", DT_FLOAT}}, cpu)},
+      {});
+  item.fetch = {"fetch"};
+  item.feed = {{"lhs", GenerateRandomTensor<DT_FLOAT>({8, 32})},
+               {"rhs", GenerateRandomTensor<DT_FLOAT>({32, 64})},
+               {"bias", GenerateRandomTensor<DT_FLOAT>({64})},
+               {"residual", GenerateRandomTensor<DT_FLOAT>({8, 64})}};
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "fused_matmul");
+    if (node.name() == "add") {
+      EXPECT_EQ(node.op(), "_FusedMatMul");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(2), "bias");
+      EXPECT_EQ(node.input(3), "residual");
+      EXPECT_EQ(node.attr().at("num_args").i(), 2);
+
+      const auto fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 3);
+      EXPECT_EQ(fused_ops[0], "BiasAdd");
+      EXPECT_EQ(fused_ops[1], "GeluExact");
+      EXPECT_EQ(fused_ops[2], "Add");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+}
+
 class RemapperTensorToHashBucketTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/root_dataset.h"
+#include "tensorflow/core/data/tf_record_index.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -34,7 +35,11 @@ class ToTFRecordOp : public AsyncOpKernel {
  public:
   explicit ToTFRecordOp(OpKernelConstruction* ctx)
       : AsyncOpKernel(ctx),
-        background_worker_(ctx->env(), "tf_data_to_tf_record") {}
+        background_worker_(ctx->env(), "tf_data_to_tf_record") {
+    if (ctx->HasAttr(kWriteIndex)) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr(kWriteIndex, &write_index_));
+    }
+  }
 
   template <typename T>
   absl::Status ParseScalarArgument(OpKernelContext* ctx,
@@ -69,6 +74,17 @@ class ToTFRecordOp : public AsyncOpKernel {
     tstring compression_type;
     TF_RETURN_IF_ERROR(ParseScalarArgument<tstring>(ctx, "compression_type",
                                                     &compression_type));
+    if (write_index_ && !compression_type.empty()) {
+      return errors::InvalidArgument(
+          "ToTFRecordOp can only write an index for uncompressed files, but "
+          "got compression type ",
+          compression_type);
+    }
+    // Removes the index of a previous version of the file, if any.
+    const std::string index_filename = TFRecordIndexFilename(filename);
+    if (ctx->env()->FileExists(index_filename).ok()) {
+      TF_RETURN_IF_ERROR(ctx->env()->DeleteFile(index_filename));
+    }
     std::unique_ptr<WritableFile> file;
     TF_RETURN_IF_ERROR(ctx->env()->NewWritableFile(filename, &file));
     auto writer = std::make_unique<io::RecordWriter>(
@@ -109,21 +125,36 @@ class ToTFRecordOp : public AsyncOpKernel {
     }
     std::vector<Tensor> components;
     components.reserve(num_output_dtypes);
+    TFRecordIndexBuilder index_builder;
     bool end_of_sequence;
     do {
       TF_RETURN_IF_ERROR(
           iterator->GetNext(&iter_ctx, &components, &end_of_sequence));
 
       if (!end_of_sequence) {
-        TF_RETURN_IF_ERROR(
-            writer->WriteRecord(components[0].scalar<tstring>()()));
+        const tstring& record = components[0].scalar<tstring>()();
+        TF_RETURN_IF_ERROR(writer->WriteRecord(record));
+        if (write_index_) {
+          index_builder.AddRecord(record.size());
+        }
       }
       components.clear();
     } while (!end_of_sequence);
+
+    if (write_index_) {
+      // The index is written after the records are persisted, so an existing
+      // index always describes a complete file.
+      TF_RETURN_IF_ERROR(writer->Close());
+      TF_RETURN_IF_ERROR(file->Close());
+      TF_RETURN_IF_ERROR(index_builder.Write(ctx->env(), index_filename));
+    }
     return absl::OkStatus();
   }
 
+  static constexpr const char* const kWriteIndex = "write_index";
+
   BackgroundWorker background_worker_;
+  bool write_index_ = false;
 };
 
 REGISTER_KERNEL_BUILDER(Name("DatasetToTFRecord").Device(DEVICE_CPU),
@@ -14,9 +14,19 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
 #include <cstdint>
-
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/tf_record_index.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -28,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tsl/platform/statusor.h"
 #include "tsl/profiler/lib/traceme.h"
 
 namespace tensorflow {
@@ -45,12 +56,16 @@ namespace data {
 constexpr char kTFRecordDataset[] = "TFRecordDataset";
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
+constexpr char kNextElementPosition[] = "next_element_position";
 constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kUnspecifiedBufferSize = -1;
 constexpr int64_t kDefaultBufferSize = 256LL << 10;  // 256KB
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// Number of records read ahead by a globally shuffled iterator. Records of the
+// same batch which are close in a file are fetched with one read.
+constexpr size_t kShuffledReadAheadSize = 32;
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -66,6 +81,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
                    const string& compression_type, int64_t buffer_size,
                    std::vector<int64_t> byte_offsets, int op_version)
       : DatasetBase(DatasetContext(ctx)),
+        env_(ctx->env()),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
@@ -109,6 +125,56 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   absl::Status CheckExternalState() const override { return absl::OkStatus(); }
 
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (options.compute_level() <
+            CardinalityOptions::CARDINALITY_COMPUTE_MODERATE ||
+        !RandomIndexingCompatible().ok()) {
+      return kUnknownCardinality;
+    }
+    absl::StatusOr<const RecordIndex*> record_index = GetRecordIndex();
+    if (!record_index.ok()) {
+      return kUnknownCardinality;
+    }
+    return (*record_index)->cumulative_num_records.empty()
+               ? 0
+               : (*record_index)->cumulative_num_records.back();
+  }
+
+  absl::Status Get(OpKernelContext* ctx, int64 index,
+                   std::vector<Tensor>* out_tensors) const override {
+    return Get(AnyContext(ctx), index, out_tensors);
+  }
+
+  absl::Status Get(AnyContext ctx, int64 index,
+                   std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(RandomIndexingCompatible());
+    TF_ASSIGN_OR_RETURN(std::vector<tstring> records, ReadRecords({index}));
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx.allocator, DT_STRING, TensorShape({}));
+    out_tensors->back().scalar<tstring>()() = std::move(records[0]);
+    return absl::OkStatus();
+  }
+
+  // Random access also requires each file to have a sidecar index, as written
+  // by `DatasetToTFRecord` with `write_index=true`. Input datasets check this
+  // when they are built, so the indices are only loaded by the first `Get` or
+  // globally shuffled iterator, which fail if they are missing.
+  absl::Status RandomIndexingCompatible() const override {
+    if (!compression_type_.empty()) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          DebugString(), " does not support random access of compressed "
+          "files. Got compression type ", compression_type_, "."));
+    }
+    for (int64_t byte_offset : byte_offsets_) {
+      if (byte_offset != 0) {
+        return absl::FailedPreconditionError(absl::StrCat(
+            DebugString(), " does not support random access with non-zero "
+            "`byte_offsets`."));
+      }
+    }
+    return absl::OkStatus();
+  }
+
  protected:
   absl::Status AsGraphDefInternal(SerializationContext* ctx,
                                   DatasetGraphDefBuilder* b,
@@ -134,11 +200,22 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
     bool SymbolicCheckpointCompatible() const override { return true; }
 
+    absl::Status Initialize(IteratorContext* ctx) override {
+      if (ctx->index_mapper() != nullptr) {
+        TF_RETURN_IF_ERROR(dataset()->RandomIndexingCompatible());
+        TF_RETURN_IF_ERROR(dataset()->GetRecordIndex().status());
+      }
+      return absl::OkStatus();
+    }
+
     absl::Status GetNextInternal(IteratorContext* ctx,
                                  std::vector<Tensor>* out_tensors,
                                  bool* end_of_sequence) override {
       out_tensors->reserve(1);
       mutex_lock l(mu_);
+      if (ctx->index_mapper() != nullptr) {
+        return GetNextShuffledLocked(ctx, out_tensors, end_of_sequence);
+      }
       do {
         // We are currently processing a file, so try to read the next record.
         if (reader_) {
@@ -233,6 +310,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCurrentFileIndex,
                                              current_file_index_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kNextElementPosition,
+          shuffled_records_.empty()
+              ? next_element_position_
+              : shuffled_records_.front().element_position));
 
       if (reader_) {
         TF_RETURN_IF_ERROR(
@@ -245,6 +327,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
                                  IteratorStateReader* reader) override {
       mutex_lock l(mu_);
       ResetStreamsLocked();
+      if (ctx->restored_element_count().has_value()) {
+        shuffled_records_.clear();
+        return reader->ReadScalar(prefix(), kNextElementPosition,
+                                  &next_element_position_);
+      }
       int64_t current_file_index;
       TF_RETURN_IF_ERROR(
           reader->ReadScalar(prefix(), kCurrentFileIndex, &current_file_index));
@@ -259,6 +346,67 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // A record read ahead in the globally shuffled mode, and the position of
+    // the element it was mapped from.
+    struct ShuffledRecord {
+      int64_t element_position = 0;
+      tstring record;
+    };
+
+    // Returns the next record in the order defined by the index mapper. Reads
+    // the records of the next `kShuffledReadAheadSize` elements at a time so
+    // that records which are close in a file are read together.
+    absl::Status GetNextShuffledLocked(IteratorContext* ctx,
+                                       std::vector<Tensor>* out_tensors,
+                                       bool* end_of_sequence)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (shuffled_records_.empty()) {
+        TF_RETURN_IF_ERROR(ReadAheadShuffledRecordsLocked(ctx));
+      }
+      if (shuffled_records_.empty()) {
+        *end_of_sequence = true;
+        return absl::OkStatus();
+      }
+      out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
+                                TensorShape({}));
+      out_tensors->back().scalar<tstring>()() =
+          std::move(shuffled_records_.front().record);
+      shuffled_records_.pop_front();
+      static monitoring::CounterCell* bytes_counter =
+          metrics::GetTFDataBytesReadCounter(kDatasetType);
+      bytes_counter->IncrementBy(
+          out_tensors->back().scalar<tstring>()().size());
+      *end_of_sequence = false;
+      return absl::OkStatus();
+    }
+
+    absl::Status ReadAheadShuffledRecordsLocked(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      std::vector<int64_t> element_positions;
+      std::vector<int64_t> indices;
+      while (indices.size() < kShuffledReadAheadSize) {
+        absl::StatusOr<int64_t> index =
+            ctx->index_mapper()(next_element_position_);
+        if (absl::IsOutOfRange(index.status())) {
+          break;
+        }
+        ++next_element_position_;
+        if (absl::IsNotFound(index.status())) {
+          continue;
+        }
+        TF_RETURN_IF_ERROR(index.status());
+        element_positions.push_back(next_element_position_ - 1);
+        indices.push_back(*index);
+      }
+      TF_ASSIGN_OR_RETURN(std::vector<tstring> records,
+                          dataset()->ReadRecords(indices));
+      for (size_t i = 0; i < records.size(); ++i) {
+        shuffled_records_.push_back(
+            ShuffledRecord{element_positions[i], std::move(records[i])});
+      }
+      return absl::OkStatus();
+    }
+
     // Sets up reader streams to read from the file at `current_file_index_`.
     absl::Status SetupStreamsLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (current_file_index_ >= dataset()->filenames_.size()) {
@@ -301,13 +449,131 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+
+    // State of the globally shuffled mode. `next_element_position_` is the
+    // next position passed to the index mapper.
+    int64_t next_element_position_ TF_GUARDED_BY(mu_) = 0;
+    std::deque<ShuffledRecord> shuffled_records_ TF_GUARDED_BY(mu_);
+  };
+
+  // The sidecar indices of all files. `TFRecordIndex` is thread-safe, so
+  // they are shared by `Get` and all iterators.
+  struct RecordIndex {
+    std::vector<std::unique_ptr<TFRecordIndex>> file_indices;
+    // `cumulative_num_records[i]` is the number of records in files [0, i].
+    std::vector<int64_t> cumulative_num_records;
   };
 
+  // Returns the sidecar indices, loading them on first use. A failed load is
+  // not cached, so that it is retried by the next random access.
+  absl::StatusOr<const RecordIndex*> GetRecordIndex() const
+      TF_LOCKS_EXCLUDED(record_index_mu_) {
+    mutex_lock l(record_index_mu_);
+    if (record_index_ == nullptr) {
+      absl::StatusOr<std::unique_ptr<const RecordIndex>> record_index =
+          LoadRecordIndex();
+      if (!record_index.ok()) {
+        return absl::FailedPreconditionError(absl::StrCat(
+            DebugString(), " requires a TFRecord index of every file for "
+            "random access: ", record_index.status().ToString()));
+      }
+      record_index_ = *std::move(record_index);
+    }
+    return record_index_.get();
+  }
+
+  absl::StatusOr<std::unique_ptr<const RecordIndex>> LoadRecordIndex() const {
+    auto record_index = std::make_unique<RecordIndex>();
+    record_index->file_indices.reserve(filenames_.size());
+    record_index->cumulative_num_records.reserve(filenames_.size());
+    int64_t num_records = 0;
+    for (const std::string& filename : filenames_) {
+      TF_ASSIGN_OR_RETURN(
+          std::unique_ptr<TFRecordIndex> file_index,
+          TFRecordIndex::Load(
+              env_, TFRecordIndexFilename(TranslateFileName(filename))));
+      num_records += file_index->num_records();
+      record_index->file_indices.push_back(std::move(file_index));
+      record_index->cumulative_num_records.push_back(num_records);
+    }
+    return record_index;
+  }
+
+  // Returns the file at `file_index` opened for positional reads, opening it
+  // on its first random access. `RandomAccessFile` is thread-safe, so it is
+  // shared by `Get` and all iterators.
+  absl::StatusOr<RandomAccessFile*> GetRandomAccessFile(size_t file_index) const
+      TF_LOCKS_EXCLUDED(files_mu_) {
+    mutex_lock l(files_mu_);
+    if (files_.empty()) {
+      files_.resize(filenames_.size());
+    }
+    if (files_[file_index] == nullptr) {
+      TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+          TranslateFileName(filenames_[file_index]), &files_[file_index]));
+    }
+    return files_[file_index].get();
+  }
+
+  // Reads the records at the dataset `indices`, in the same order. Records of
+  // the same file are read with coalesced positional reads.
+  absl::StatusOr<std::vector<tstring>> ReadRecords(
+      absl::Span<const int64_t> indices) const {
+    TF_ASSIGN_OR_RETURN(const RecordIndex* record_index, GetRecordIndex());
+    const std::vector<int64_t>& cumulative_num_records =
+        record_index->cumulative_num_records;
+    const int64_t num_records =
+        cumulative_num_records.empty() ? 0 : cumulative_num_records.back();
+
+    // Maps each file to the positions in `indices` of its records.
+    absl::flat_hash_map<size_t, std::vector<size_t>> positions_by_file;
+    for (size_t i = 0; i < indices.size(); ++i) {
+      if (indices[i] < 0 || indices[i] >= num_records) {
+        return absl::OutOfRangeError(absl::StrCat(
+            "Index out of range [0, ", num_records, "): ", indices[i]));
+      }
+      const size_t file_index =
+          std::upper_bound(cumulative_num_records.begin(),
+                           cumulative_num_records.end(), indices[i]) -
+          cumulative_num_records.begin();
+      positions_by_file[file_index].push_back(i);
+    }
+
+    std::vector<tstring> records(indices.size());
+    for (const auto& [file_index, positions] : positions_by_file) {
+      const int64_t first_record =
+          file_index == 0 ? 0 : cumulative_num_records[file_index - 1];
+      std::vector<int64_t> file_record_indices;
+      file_record_indices.reserve(positions.size());
+      for (size_t position : positions) {
+        file_record_indices.push_back(indices[position] - first_record);
+      }
+      TF_ASSIGN_OR_RETURN(RandomAccessFile * file,
+                          GetRandomAccessFile(file_index));
+      TF_ASSIGN_OR_RETURN(
+          std::vector<tstring> file_records,
+          ReadTFRecords(file, *record_index->file_indices[file_index],
+                        file_record_indices));
+      for (size_t i = 0; i < positions.size(); ++i) {
+        records[positions[i]] = std::move(file_records[i]);
+      }
+    }
+    return records;
+  }
+
+  Env* const env_;
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
   const int op_version_;
+
+  mutable mutex record_index_mu_;
+  mutable std::unique_ptr<const RecordIndex> record_index_
+      TF_GUARDED_BY(record_index_mu_);
+  mutable mutex files_mu_;
+  mutable std::vector<std::unique_ptr<RandomAccessFile>> files_
+      TF_GUARDED_BY(files_mu_);
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
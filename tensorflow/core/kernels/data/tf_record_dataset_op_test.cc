@@ -23,6 +23,7 @@ limitations under the License.
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/tf_record_index.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -133,6 +134,23 @@ absl::Status CreateTestFiles(const std::vector<tstring>& filenames,
   return absl::OkStatus();
 }
 
+// Creates uncompressed test files with sidecar indices.
+absl::Status CreateIndexedTestFiles(
+    const std::vector<tstring>& filenames,
+    const std::vector<std::vector<string>>& contents) {
+  TF_RETURN_IF_ERROR(
+      CreateTestFiles(filenames, contents, CompressionType::UNCOMPRESSED));
+  for (int i = 0; i < filenames.size(); ++i) {
+    TFRecordIndexBuilder index_builder;
+    for (const string& record : contents[i]) {
+      index_builder.AddRecord(record.size());
+    }
+    TF_RETURN_IF_ERROR(index_builder.Write(
+        Env::Default(), TFRecordIndexFilename(filenames[i])));
+  }
+  return absl::OkStatus();
+}
+
 // Test case 1: multiple text files with ZLIB compression.
 TFRecordDatasetParams TFRecordDatasetParams1() {
   std::vector<tstring> filenames = {
@@ -227,6 +245,24 @@ TFRecordDatasetParams InvalidByteOffsets() {
                                /*node_name=*/kNodeName);
 }
 
+// Test case 6: multiple indexed text files without compression.
+TFRecordDatasetParams IndexedTFRecordDatasetParams() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_INDEXED_2")};
+  std::vector<std::vector<string>> contents = {{"1", "22", "333"},
+                                               {"a", "bb", "ccc"}};
+  absl::Status status = CreateIndexedTestFiles(filenames, contents);
+  TF_CHECK_OK(status) << "Failed to create the test files: "
+                      << absl::StrJoin(filenames, ", ") << ": " << status;
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/
+                               CompressionType::UNCOMPRESSED,
+                               /*buffer_size=*/10,
+                               /*byte_offsets=*/{},
+                               /*node_name=*/kNodeName);
+}
+
 std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
   return {
       {/*dataset_params=*/TFRecordDatasetParams1(),
@@ -242,7 +278,10 @@ std::vector<GetNextTestCase<TFRecordDatasetParams>> GetNextTestCases() {
       {/*dataset_params=*/TFRecordDatasetParams4(),
        CreateTensors<tstring>(
            TensorShape({}),
-           {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}})}};
+           {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}})},
+      {/*dataset_params=*/IndexedTFRecordDatasetParams(),
+       CreateTensors<tstring>(
+           TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}})}};
 }
 
 ITERATOR_GET_NEXT_TEST_P(TFRecordDatasetOpTest, TFRecordDatasetParams,
@@ -319,6 +358,96 @@ TEST_F(TFRecordDatasetOpTest, Cardinality) {
   TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
 }
 
+TEST_F(TFRecordDatasetOpTest, IndexedCardinality) {
+  auto dataset_params = IndexedTFRecordDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  // Reading the indices is only allowed with a moderate compute level.
+  EXPECT_EQ(dataset_->Cardinality(), kUnknownCardinality);
+  CardinalityOptions options;
+  options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  EXPECT_EQ(dataset_->Cardinality(options), 6);
+}
+
+TEST_F(TFRecordDatasetOpTest, IndexedRandomAccess) {
+  auto dataset_params = IndexedTFRecordDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(dataset_->RandomIndexingCompatible());
+  std::vector<tstring> expected = {"1", "22", "333", "a", "bb", "ccc"};
+  for (int64_t i = expected.size() - 1; i >= 0; --i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(
+        dataset_->Get(AnyContext(iterator_ctx_.get()), i, &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[i]);
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      dataset_->Get(AnyContext(iterator_ctx_.get()), 6, &out_tensors).code(),
+      absl::StatusCode::kOutOfRange);
+}
+
+TEST_F(TFRecordDatasetOpTest, IndexedGlobalShuffle) {
+  auto dataset_params = IndexedTFRecordDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  IteratorContext::Params params(iterator_ctx_.get());
+  // Reverses the elements and skips the element at position 1.
+  params.index_mapper =
+      [](size_t element_position) -> absl::StatusOr<size_t> {
+    if (element_position >= 6) {
+      return absl::OutOfRangeError("Out of range");
+    }
+    if (element_position == 1) {
+      return absl::NotFoundError("Skipped");
+    }
+    return 5 - element_position;
+  };
+  IteratorContext ctx(params);
+  std::vector<tstring> records;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(iterator_->GetNext(&ctx, &out_tensors, &end_of_sequence));
+    if (!end_of_sequence) {
+      records.push_back(out_tensors[0].scalar<tstring>()());
+    }
+  }
+  EXPECT_EQ(records, std::vector<tstring>({"ccc", "a", "333", "22", "1"}));
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccessWithoutIndex) {
+  auto dataset_params = TFRecordDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  CardinalityOptions options;
+  options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  EXPECT_EQ(dataset_->Cardinality(options), kUnknownCardinality);
+  // The indices are only read on random access.
+  TF_EXPECT_OK(dataset_->RandomIndexingCompatible());
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      dataset_->Get(AnyContext(iterator_ctx_.get()), 0, &out_tensors).code(),
+      absl::StatusCode::kFailedPrecondition);
+
+  IteratorContext::Params params(iterator_ctx_.get());
+  params.index_mapper =
+      [](size_t element_position) -> absl::StatusOr<size_t> {
+    return element_position;
+  };
+  IteratorContext shuffled_ctx(params);
+  std::unique_ptr<IteratorBase> iterator;
+  EXPECT_EQ(dataset_
+                ->MakeIterator(&shuffled_ctx, /*parent=*/nullptr,
+                               dataset_params.iterator_prefix(), &iterator)
+                .code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccessOfCompressedFiles) {
+  auto dataset_params = TFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  EXPECT_EQ(dataset_->RandomIndexingCompatible().code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
 TEST_F(TFRecordDatasetOpTest, IteratorOutputDtypes) {
   auto dataset_params = TFRecordDatasetParams1();
   TF_ASSERT_OK(Initialize(dataset_params));
@@ -123,6 +123,18 @@ absl::Status InitializeFusedComputation(
     }
   }
 
+  if (*fused_computation == FusedComputationType::kBiasAddWithAdd ||
+      *fused_computation ==
+          FusedComputationType::kBiasAddWithGeluApproximateAndAdd ||
+      *fused_computation == FusedComputationType::kBiasAddWithGeluExactAndAdd) {
+    if (num_args != 2) {
+      return errors::InvalidArgument(
+          "Fused ", kernel_name,
+          " with BiasAdd and Add must have two extra arguments: bias and "
+          "residual.");
+    }
+  }
+
   if (*fused_computation == FusedComputationType::kFusedBatchNorm ||
       *fused_computation == FusedComputationType::kFusedBatchNormWithRelu ||
       *fused_computation == FusedComputationType::kFusedBatchNormWithRelu6 ||
@@ -46,6 +46,9 @@ enum class FusedComputationType {
   kBiasAddWithLeakyRelu,
   kBiasAddWithGeluApproximate,
   kBiasAddWithGeluExact,
+  kBiasAddWithAdd,
+  kBiasAddWithGeluApproximateAndAdd,
+  kBiasAddWithGeluExactAndAdd,
   kFusedBatchNorm,
   kFusedBatchNormWithRelu,
   kFusedBatchNormWithRelu6,
@@ -151,11 +154,43 @@ struct LeakyRelu {
   };
 };
 
+// Applies the tanh approximation of `Gelu` to the passed input expression:
+//   0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+struct GeluApproximate {
+  template <typename XprType>
+  static auto apply(XprType expr) {
+    using Scalar = typename XprType::Scalar;
+    const auto inner =
+        expr.constant(static_cast<Scalar>(0.7978845608028654)) *
+        (expr + expr.constant(static_cast<Scalar>(0.044715)) * expr.cube());
+    return expr.constant(static_cast<Scalar>(0.5)) * expr *
+           (inner.tanh() + expr.constant(static_cast<Scalar>(1)));
+  };
+};
+
+// Applies `Gelu` to the passed input expression:
+//   0.5 * x * (1 + erf(x / sqrt(2)))
+struct GeluExact {
+  template <typename XprType>
+  static auto apply(XprType expr) {
+    using Scalar = typename XprType::Scalar;
+    const auto scaled =
+        expr * expr.constant(static_cast<Scalar>(0.7071067811865476));
+    return expr.constant(static_cast<Scalar>(0.5)) * expr *
+           (scaled.erf() + expr.constant(static_cast<Scalar>(1)));
+  };
+};
+
 template <typename T>
 struct BiasAddArgs {
   const T* bias_add_data = nullptr;
   float leakyrelu_alpha;
 
+  // Residual added after the activation, of the same shape as the output.
+  const T* residual_data = nullptr;
+  // Size of the innermost dimension of the output and the residual.
+  Eigen::Index residual_row_size = 0;
+
   static bool IsSupported(FusedComputationType fusion) {
     return fusion == FusedComputationType::kBiasAdd ||
            fusion == FusedComputationType::kBiasAddWithRelu ||
@@ -163,7 +198,16 @@ struct BiasAddArgs {
            fusion == FusedComputationType::kBiasAddWithTanh ||
            fusion == FusedComputationType::kBiasAddWithSigmoid ||
            fusion == FusedComputationType::kBiasAddWithElu ||
-           fusion == FusedComputationType::kBiasAddWithLeakyRelu;
+           fusion == FusedComputationType::kBiasAddWithLeakyRelu ||
+           fusion == FusedComputationType::kBiasAddWithGeluApproximate ||
+           fusion == FusedComputationType::kBiasAddWithGeluExact ||
+           HasResidual(fusion);
+  }
+
+  static bool HasResidual(FusedComputationType fusion) {
+    return fusion == FusedComputationType::kBiasAddWithAdd ||
+           fusion == FusedComputationType::kBiasAddWithGeluApproximateAndAdd ||
+           fusion == FusedComputationType::kBiasAddWithGeluExactAndAdd;
   }
 };
 
@@ -292,6 +336,52 @@ struct BiasAddOutputKernel<T, LeakyRelu> {
   float leakyrelu_alpha;
 };
 
+// Output kernel that fuses BiasAdd operation into the output of tensor
+// contraction + activation function defined by Activation + Add of a residual
+// of the output shape, e.g. the skip connection of a transformer block.
+template <typename T, typename Activation = Identity>
+struct BiasAddWithResidualOutputKernel {
+  explicit BiasAddWithResidualOutputKernel(const BiasAddArgs<T>& args)
+      : bias_data(args.bias_add_data),
+        residual_data(args.residual_data),
+        residual_row_size(args.residual_row_size) {}
+
+  template <typename StorageIndex, typename Scalar>
+  EIGEN_ALWAYS_INLINE void operator()(
+      const ContractionOutputMapper<Scalar, StorageIndex>& output_mapper,
+      const Eigen::TensorContractionParams& params, StorageIndex i,
+      StorageIndex j, StorageIndex num_rows, StorageIndex num_cols) const {
+    DCHECK(params.swapped_arguments);
+
+    const T* bias_base = bias_data + i;
+    typename TTypes<T>::UnalignedConstTensor bias(bias_base, num_rows);
+
+    for (int col = 0; col < num_cols; ++col) {
+      Scalar* output_base = &output_mapper(0, col);
+      typename TTypes<Scalar>::UnalignedTensor output(output_base, num_rows);
+      // Output block column `col` is the row `j + col` of the output matrix.
+      const T* residual_base =
+          residual_data + (j + col) * residual_row_size + i;
+      typename TTypes<T>::UnalignedConstTensor residual(residual_base,
+                                                        num_rows);
+      if constexpr (std::is_same_v<Scalar, T>) {
+        const auto expr = output + bias;
+        output = Activation::template apply<decltype(expr)>(expr) + residual;
+      } else {
+        const auto bias_expr = bias.template cast<Scalar>();
+        const auto expr = output + bias_expr;
+        output = Activation::template apply<decltype(expr)>(expr) +
+                 residual.template cast<Scalar>();
+      }
+    }
+  }
+
+ private:
+  const T* bias_data;
+  const T* residual_data;
+  Eigen::Index residual_row_size;
+};
+
 // Output kernel that fuses FusedBatchNorm operation into the output of tensor
 // contraction + activation function defined by Activation.
 template <typename T, typename Activation = Identity>
@@ -398,6 +488,18 @@ using WithBiasAddAndElu = BiasAddOutputKernel<T, Elu>;
 template <typename T>
 using WithBiasAddAndLeakyRelu = BiasAddOutputKernel<T, LeakyRelu>;
 template <typename T>
+using WithBiasAddAndGeluApproximate = BiasAddOutputKernel<T, GeluApproximate>;
+template <typename T>
+using WithBiasAddAndGeluExact = BiasAddOutputKernel<T, GeluExact>;
+template <typename T>
+using WithBiasAddAndAdd = BiasAddWithResidualOutputKernel<T>;
+template <typename T>
+using WithBiasAddAndGeluApproximateAndAdd =
+    BiasAddWithResidualOutputKernel<T, GeluApproximate>;
+template <typename T>
+using WithBiasAddAndGeluExactAndAdd =
+    BiasAddWithResidualOutputKernel<T, GeluExact>;
+template <typename T>
 using WithFusedBatchNorm = FusedBatchNormOutputKernel<T>;
 template <typename T>
 using WithFusedBatchNormAndRelu = FusedBatchNormOutputKernel<T, Relu>;
@@ -431,6 +533,27 @@ absl::Status InitBiasAddArgs(OpKernelContext* context, BiasAddArgs<T>* args,
   return absl::OkStatus();
 }
 
+template <typename T>
+absl::Status InitBiasAddResidualArgs(OpKernelContext* context,
+                                     const TensorShape& output_shape,
+                                     BiasAddArgs<T>* args) {
+  // Residual of the output shape: [ ..., output_depth ]
+  const Tensor& residual = context->input(3);
+
+  if (residual.shape() != output_shape)
+    return errors::InvalidArgument(
+        "residual must have the output shape ", output_shape.DebugString(),
+        " but has shape ", residual.shape().DebugString());
+  if (output_shape.dims() == 0)
+    return errors::InvalidArgument("residual must be at least 1-dimensional");
+
+  args->residual_data =
+      reinterpret_cast<const T*>(residual.tensor_data().data());
+  args->residual_row_size = output_shape.dim_size(output_shape.dims() - 1);
+
+  return absl::OkStatus();
+}
+
 template <typename T>
 absl::Status InitFusedBatchNormArgs(OpKernelContext* context, float epsilon,
                                     FusedBatchNormArgs<T>* args,
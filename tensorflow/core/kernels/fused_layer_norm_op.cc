@@ -0,0 +1,122 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <cmath>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+// Layer normalization over the innermost dimension, created by the Grappler
+// remapper from the subgraphs of the Keras and the handwritten layer norms.
+//
+// Every row is normalized by a single thread: it is read once into a float
+// buffer to compute its moments, and the output is computed from the buffer
+// while it is still in cache. Half and bfloat16 inputs are accumulated in
+// float.
+template <typename T>
+class FusedLayerNormOp : public OpKernel {
+ public:
+  explicit FusedLayerNormOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("epsilon", &epsilon_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    const Tensor& scale = context->input(1);
+    const Tensor& offset = context->input(2);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(x.shape()),
+                errors::InvalidArgument("x must have >= 1 dimension, got ",
+                                        x.shape().DebugString()));
+    const int64_t depth = x.dim_size(x.dims() - 1);
+    OP_REQUIRES(
+        context,
+        TensorShapeUtils::IsVector(scale.shape()) && scale.dim_size(0) == depth,
+        errors::InvalidArgument("scale must have shape [", depth, "], got ",
+                                scale.shape().DebugString()));
+    OP_REQUIRES(
+        context,
+        TensorShapeUtils::IsVector(offset.shape()) &&
+            offset.dim_size(0) == depth,
+        errors::InvalidArgument("offset must have shape [", depth, "], got ",
+                                offset.shape().DebugString()));
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    if (x.NumElements() == 0) return;
+
+    using FloatVector = Eigen::Tensor<float, 1, Eigen::RowMajor>;
+    using FloatScalar = Eigen::Tensor<float, 0, Eigen::RowMajor>;
+
+    const FloatVector gamma = scale.vec<T>().template cast<float>();
+    const FloatVector beta = offset.vec<T>().template cast<float>();
+    const float epsilon = epsilon_;
+
+    auto x_rows = x.flat_inner_dims<T>();
+    auto y_rows = y->flat_inner_dims<T>();
+
+    auto normalize_rows = [&](Eigen::Index begin, Eigen::Index end) {
+      FloatVector row(depth);
+      for (Eigen::Index i = begin; i < end; ++i) {
+        typename TTypes<T>::UnalignedConstVec x_row(&x_rows(i, 0), depth);
+        typename TTypes<T>::UnalignedVec y_row(&y_rows(i, 0), depth);
+
+        row = x_row.template cast<float>();
+        const FloatScalar mean = row.mean();
+        row = row - row.constant(mean());
+        const FloatScalar variance = row.square().mean();
+        const float inv_stddev = 1.0f / std::sqrt(variance() + epsilon);
+        y_row = (row * row.constant(inv_stddev) * gamma + beta)
+                    .template cast<T>();
+      }
+    };
+
+    // Reads and writes a row, with two reductions and ~6 ops per element.
+    const Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * depth,
+                                   /*bytes_stored=*/sizeof(T) * depth,
+                                   /*compute_cycles=*/8 * depth);
+    context->eigen_device<CPUDevice>().parallelFor(x_rows.dimension(0), cost,
+                                                   normalize_rows);
+  }
+
+ private:
+  float epsilon_;
+};
+
+#define REGISTER_CPU(T)                                                  \
+  REGISTER_KERNEL_BUILDER(                                               \
+      Name("_FusedLayerNorm").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedLayerNormOp<T>);
+TF_CALL_float(REGISTER_CPU);
+TF_CALL_half(REGISTER_CPU);
+TF_CALL_bfloat16(REGISTER_CPU);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
@@ -0,0 +1,194 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+
+class FusedLayerNormOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(DataType dtype, float epsilon) {
+    TF_EXPECT_OK(NodeDefBuilder("layer_norm_op", "_FusedLayerNorm")
+                     .Input(FakeInput(dtype))
+                     .Input(FakeInput(dtype))
+                     .Input(FakeInput(dtype))
+                     .Attr("epsilon", epsilon)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedLayerNormOpTest, Float) {
+  MakeOp(DT_FLOAT, 0.001);
+  AddInputFromArray<float>(TensorShape({2, 4}), {1, 2, 3, 4, 2, 2, 2, 2});
+  AddInputFromArray<float>(TensorShape({4}), {1, 2, 1, 2});
+  AddInputFromArray<float>(TensorShape({4}), {0, 0, 1, 1});
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 4}));
+  test::FillValues<float>(&expected, {-1.3411, -0.89407, 1.44703, 3.68221, 0,
+                                      0, 1, 1});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+}
+
+TEST_F(FusedLayerNormOpTest, Half) {
+  MakeOp(DT_HALF, 0.001);
+  const std::vector<float> x = {1, 2, 3, 4, 2, 2, 2, 2};
+  const std::vector<float> scale = {1, 2, 1, 2};
+  const std::vector<float> offset = {0, 0, 1, 1};
+  AddInput<Eigen::half>(TensorShape({1, 2, 4}),
+                        [&](int i) { return static_cast<Eigen::half>(x[i]); });
+  AddInput<Eigen::half>(TensorShape({4}), [&](int i) {
+    return static_cast<Eigen::half>(scale[i]);
+  });
+  AddInput<Eigen::half>(TensorShape({4}), [&](int i) {
+    return static_cast<Eigen::half>(offset[i]);
+  });
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  const std::vector<float> expected_values = {
+      -1.3411, -0.89407, 1.44703, 3.68221, 0, 0, 1, 1};
+  Tensor expected(allocator(), DT_HALF, TensorShape({1, 2, 4}));
+  test::FillFn<Eigen::half>(&expected, [&](int i) {
+    return static_cast<Eigen::half>(expected_values[i]);
+  });
+  test::ExpectTensorNear<Eigen::half>(expected, *GetOutput(0), 1e-2);
+}
+
+TEST_F(FusedLayerNormOpTest, InvalidScale) {
+  MakeOp(DT_FLOAT, 0.001);
+  AddInputFromArray<float>(TensorShape({2, 4}), {1, 2, 3, 4, 2, 2, 2, 2});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({4}), {0, 0, 1, 1});
+
+  const absl::Status status = RunOpKernel();
+  EXPECT_TRUE(absl::IsInvalidArgument(status)) << status;
+}
+
+//----------------------------------------------------------------------------//
+// Performance benchmarks are below.                                          //
+//----------------------------------------------------------------------------//
+
+// Layer norm over the innermost dimension of a [rows, depth] tensor, either
+// as the primitive ops of the Keras/handwritten layer norm or as the
+// `_FusedLayerNorm` the remapper creates for them.
+static Graph* LayerNorm(int rows, int depth, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor x_t(DT_FLOAT, TensorShape({rows, depth}));
+  x_t.flat<float>().setRandom();
+  Tensor other_t(DT_FLOAT, TensorShape({depth}));
+  other_t.flat<float>().setRandom();
+
+  Node* x = test::graph::Constant(g, x_t, "x");
+  Node* other = test::graph::Constant(g, other_t, "other");
+
+  if (fused) {
+    Node* layer_norm;
+    TF_CHECK_OK(NodeBuilder(g->NewName("layer_norm"), "_FusedLayerNorm")
+                    .Input(x)
+                    .Input(other)  // scale
+                    .Input(other)  // offset
+                    .Attr("T", DT_FLOAT)
+                    .Attr("epsilon", 0.001f)
+                    .Finalize(g, &layer_norm));
+    return g;
+  }
+
+  Node* axis = test::graph::Constant(g, test::AsScalar<int32>(-1));
+  Node* epsilon = test::graph::Constant(g, test::AsScalar<float>(0.001f));
+  Node* mean = test::graph::Reduce(g, "Mean", x, axis, /*keep_dims=*/true);
+  Node* centered = test::graph::Binary(g, "Sub", x, mean);
+  Node* variance = test::graph::Reduce(
+      g, "Mean", test::graph::Binary(g, "SquaredDifference", x, mean), axis,
+      /*keep_dims=*/true);
+  Node* inv_stddev = test::graph::Unary(
+      g, "Rsqrt", test::graph::Binary(g, "AddV2", variance, epsilon));
+  Node* normalized = test::graph::Binary(g, "Mul", centered, inv_stddev);
+  test::graph::Binary(g, "AddV2",
+                      test::graph::Binary(g, "Mul", other, normalized), other);
+  return g;
+}
+
+// Softmax over the innermost dimension, either written with the primitive ops
+// or as the Softmax the remapper replaces them with.
+static Graph* Softmax(int rows, int depth, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor logits_t(DT_FLOAT, TensorShape({rows, depth}));
+  logits_t.flat<float>().setRandom();
+  Node* logits = test::graph::Constant(g, logits_t, "logits");
+
+  if (fused) {
+    test::graph::Unary(g, "Softmax", logits);
+    return g;
+  }
+
+  Node* axis = test::graph::Constant(g, test::AsScalar<int32>(-1));
+  Node* max = test::graph::Reduce(g, "Max", logits, axis, /*keep_dims=*/true);
+  Node* exp =
+      test::graph::Unary(g, "Exp", test::graph::Binary(g, "Sub", logits, max));
+  Node* sum = test::graph::Reduce(g, "Sum", exp, axis, /*keep_dims=*/true);
+  test::graph::Binary(g, "RealDiv", exp, sum);
+  return g;
+}
+
+#define BM_RowwiseOp(NAME, ROWS, DEPTH, FUSED, DEVICE)                  \
+  static void BM_##NAME##_##ROWS##_##DEPTH##_##FUSED##_##DEVICE(        \
+      ::testing::benchmark::State& state) {                             \
+    test::Benchmark(#DEVICE, NAME(ROWS, DEPTH, FUSED),                  \
+                    /*old_benchmark_api*/ false)                        \
+        .Run(state);                                                    \
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * \
+                            ROWS * DEPTH);                              \
+  }                                                                     \
+  BENCHMARK(BM_##NAME##_##ROWS##_##DEPTH##_##FUSED##_##DEVICE)          \
+      ->UseRealTime();
+
+#define BM_LayerNorm(ROWS, DEPTH)                   \
+  BM_RowwiseOp(LayerNorm, ROWS, DEPTH, false, cpu); \
+  BM_RowwiseOp(LayerNorm, ROWS, DEPTH, true, cpu);
+
+#define BM_Softmax(ROWS, DEPTH)                   \
+  BM_RowwiseOp(Softmax, ROWS, DEPTH, false, cpu); \
+  BM_RowwiseOp(Softmax, ROWS, DEPTH, true, cpu);
+
+// Hidden sizes of transformer encoders, for a batch of 128 tokens and for a
+// batch of 8 sequences of 512 tokens.
+BM_LayerNorm(128, 768);
+BM_LayerNorm(128, 1024);
+BM_LayerNorm(4096, 768);
+BM_LayerNorm(4096, 1024);
+
+// Attention scores of 12 heads, and classifier logits.
+BM_Softmax(1536, 128);
+BM_Softmax(6144, 512);
+BM_Softmax(128, 32000);
+
+}  // namespace tensorflow
@@ -136,6 +136,10 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
       } else {
         OP_REQUIRES_OK(context, InitBiasAddArgs(context, &bias_add_args));
       }
+      if (BiasAddArgs<T>::HasResidual(fusion)) {
+        OP_REQUIRES_OK(context, InitBiasAddResidualArgs(
+                                    context, output->shape(), &bias_add_args));
+      }
     }
 
     switch (fusion) {
@@ -160,6 +164,24 @@ struct LaunchFusedMatMulOp<CPUDevice, T> {
       case FusedComputationType::kBiasAddWithLeakyRelu:
         executeWithOutputKernel(WithBiasAddAndLeakyRelu<T>(bias_add_args));
         break;
+      case FusedComputationType::kBiasAddWithGeluApproximate:
+        executeWithOutputKernel(
+            WithBiasAddAndGeluApproximate<T>(bias_add_args));
+        break;
+      case FusedComputationType::kBiasAddWithGeluExact:
+        executeWithOutputKernel(WithBiasAddAndGeluExact<T>(bias_add_args));
+        break;
+      case FusedComputationType::kBiasAddWithAdd:
+        executeWithOutputKernel(WithBiasAddAndAdd<T>(bias_add_args));
+        break;
+      case FusedComputationType::kBiasAddWithGeluApproximateAndAdd:
+        executeWithOutputKernel(
+            WithBiasAddAndGeluApproximateAndAdd<T>(bias_add_args));
+        break;
+      case FusedComputationType::kBiasAddWithGeluExactAndAdd:
+        executeWithOutputKernel(
+            WithBiasAddAndGeluExactAndAdd<T>(bias_add_args));
+        break;
       case FusedComputationType::kUndefined:
         OP_REQUIRES_OK(context, errors::Internal("Fusion type is undefined"));
         break;
@@ -641,6 +663,12 @@ class FusedMatMulOp : public OpKernel {
           {FCT::kBiasAddWithSigmoid, {"BiasAdd", "Sigmoid"}},
           {FCT::kBiasAddWithElu, {"BiasAdd", "Elu"}},
           {FCT::kBiasAddWithLeakyRelu, {"BiasAdd", "LeakyRelu"}},
+          {FCT::kBiasAddWithGeluApproximate, {"BiasAdd", "GeluApproximate"}},
+          {FCT::kBiasAddWithGeluExact, {"BiasAdd", "GeluExact"}},
+          {FCT::kBiasAddWithAdd, {"BiasAdd", "Add"}},
+          {FCT::kBiasAddWithGeluApproximateAndAdd,
+           {"BiasAdd", "GeluApproximate", "Add"}},
+          {FCT::kBiasAddWithGeluExactAndAdd, {"BiasAdd", "GeluExact", "Add"}},
       };
     } else if (std::is_same<Device, GPUDevice>::value) {
       patterns = {
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/nn_ops_internal.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
@@ -420,6 +421,151 @@ using FusedBiasAddDataTypes = ::testing::Types<float, Eigen::half>;
 INSTANTIATE_TYPED_TEST_SUITE_P(Test, FusedMatMulWithBiasOpTest,
                                FusedBiasAddDataTypes);
 
+// -------------------------------------------------------------------------- //
+// MatMul + BiasAdd + {Gelu} + {Add}                                          //
+// -------------------------------------------------------------------------- //
+
+// Gelu and the residual Add are fused by the Eigen kernel on CPU only.
+class FusedMatMulWithGeluAndAddOpTest : public FusedMatMulOpTest<float> {
+ protected:
+  // Runs MatMul+BiasAdd+{activation}+{AddV2 of `residual_data`} as separate
+  // ops, with Gelu written with the primitive ops.
+  void RunMatMulWithBiasGeluAndAdd(const Tensor& lhs_data,
+                                   const Tensor& rhs_data,
+                                   const Tensor& bias_data,
+                                   const Tensor* residual_data,
+                                   bool transpose_a, const string& activation,
+                                   Tensor* output) {
+    Scope root = tensorflow::Scope::NewRootScope();
+
+    ops::MatMul matmul = ops::MatMul(
+        root.WithOpName("matmul"),
+        ops::Const(root.WithOpName("lhs"), Input::Initializer(lhs_data)),
+        ops::Const(root.WithOpName("rhs"), Input::Initializer(rhs_data)),
+        ops::MatMul::Attrs().TransposeA(transpose_a));
+
+    Output x = ops::BiasAdd(
+        root.WithOpName("with_bias"), matmul,
+        ops::Const(root.WithOpName("bias"), Input::Initializer(bias_data)));
+
+    auto half = ops::Const(root.WithOpName("half"), 0.5f);
+    auto one = ops::Const(root.WithOpName("one"), 1.0f);
+    if (activation == "GeluExact") {
+      // 0.5 * x * (1 + erf(x / sqrt(2)))
+      auto erf = ops::Erf(
+          root.WithOpName("erf"),
+          ops::Mul(root.WithOpName("scaled"), x,
+                   ops::Const(root.WithOpName("sqrt1_2"), 0.70710678f)));
+      x = ops::Mul(root.WithOpName("gelu"),
+                   ops::Mul(root.WithOpName("half_x"), half, x),
+                   ops::AddV2(root.WithOpName("one_plus"), one, erf));
+    } else if (activation == "GeluApproximate") {
+      // 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+      auto cube = ops::Mul(root.WithOpName("cube"), x,
+                           ops::Mul(root.WithOpName("square"), x, x));
+      auto inner = ops::AddV2(
+          root.WithOpName("inner"), x,
+          ops::Mul(root.WithOpName("scaled_cube"),
+                   ops::Const(root.WithOpName("coeff"), 0.044715f), cube));
+      auto tanh = ops::Tanh(
+          root.WithOpName("tanh"),
+          ops::Mul(root.WithOpName("scaled"),
+                   ops::Const(root.WithOpName("sqrt2_pi"), 0.7978845608f),
+                   inner));
+      x = ops::Mul(root.WithOpName("gelu"),
+                   ops::Mul(root.WithOpName("half_x"), half, x),
+                   ops::AddV2(root.WithOpName("one_plus"), one, tanh));
+    }
+
+    if (residual_data != nullptr) {
+      x = ops::AddV2(root.WithOpName("with_residual"), x,
+                     ops::Const(root.WithOpName("residual"),
+                                Input::Initializer(*residual_data)));
+    }
+    ops::Identity(root.WithOpName("output"), x);
+
+    RunAndFetch(root, "output", output, /*allow_gpu_device=*/false);
+  }
+
+  // Verifies that computing MatMul+BiasAdd+{activation}+{Add} in a graph is
+  // identical to FusedMatMul.
+  void VerifyMatMulWithBiasGeluAndAdd(int m, int k, int n, bool transpose_a,
+                                      const string& activation,
+                                      bool with_residual) {
+    Tensor lhs(DT_FLOAT, {transpose_a ? k : m, transpose_a ? m : k});
+    lhs.flat<float>().setRandom();
+    Tensor rhs(DT_FLOAT, {k, n});
+    rhs.flat<float>().setRandom();
+    rhs.flat<float>() -= rhs.flat<float>().constant(0.5f);
+    Tensor bias(DT_FLOAT, {n});
+    bias.flat<float>().setRandom();
+    bias.flat<float>() -= bias.flat<float>().constant(0.5f);
+    Tensor residual(DT_FLOAT, {m, n});
+    residual.flat<float>().setRandom();
+
+    std::vector<Tensor> args = {bias};
+    std::vector<string> fused_ops = {"BiasAdd"};
+    if (!activation.empty()) fused_ops.push_back(activation);
+    if (with_residual) {
+      args.push_back(residual);
+      fused_ops.push_back("Add");
+    }
+
+    Tensor expected;
+    RunMatMulWithBiasGeluAndAdd(lhs, rhs, bias,
+                                with_residual ? &residual : nullptr,
+                                transpose_a, activation, &expected);
+    Tensor fused_matmul;
+    RunFusedMatMulOp(lhs, rhs, args, fused_ops, transpose_a,
+                     /*transpose_b=*/false, &fused_matmul);
+
+    ASSERT_EQ(expected.shape(), fused_matmul.shape());
+    test::ExpectClose(expected, fused_matmul, /*atol=*/1e-4, /*rtol=*/1e-4);
+  }
+};
+
+TEST_F(FusedMatMulWithGeluAndAddOpTest, MatMulWithBiasAndGelu) {
+  for (const string activation : {"GeluExact", "GeluApproximate"}) {
+    VerifyMatMulWithBiasGeluAndAdd(256, 128, 64, false, activation, false);
+    VerifyMatMulWithBiasGeluAndAdd(256, 128, 64, true, activation, false);
+    VerifyMatMulWithBiasGeluAndAdd(1, 256, 256, false, activation, false);
+  }
+}
+
+TEST_F(FusedMatMulWithGeluAndAddOpTest, MatMulWithBiasAndAdd) {
+  VerifyMatMulWithBiasGeluAndAdd(256, 128, 64, false, "", true);
+  VerifyMatMulWithBiasGeluAndAdd(256, 128, 64, true, "", true);
+  VerifyMatMulWithBiasGeluAndAdd(256, 256, 1, false, "", true);
+}
+
+TEST_F(FusedMatMulWithGeluAndAddOpTest, MatMulWithBiasGeluAndAdd) {
+  for (const string activation : {"GeluExact", "GeluApproximate"}) {
+    VerifyMatMulWithBiasGeluAndAdd(256, 128, 64, false, activation, true);
+    VerifyMatMulWithBiasGeluAndAdd(256, 128, 64, true, activation, true);
+    VerifyMatMulWithBiasGeluAndAdd(1, 256, 256, false, activation, true);
+  }
+}
+
+TEST_F(FusedMatMulWithGeluAndAddOpTest, ResidualMustMatchOutputShape) {
+  TF_ASSERT_OK(NodeDefBuilder("fused_matmul", "_FusedMatMul")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Input(FakeInput(2, DT_FLOAT))
+                   .Attr("num_args", 2)
+                   .Attr("T", DT_FLOAT)
+                   .Attr("fused_ops", {"BiasAdd", "Add"})
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  const auto ones = [](int) { return 1.0f; };
+  AddInput<float>(TensorShape({8, 16}), ones);
+  AddInput<float>(TensorShape({16, 32}), ones);
+  AddInput<float>(TensorShape({32}), ones);
+  // The residual is broadcast by AddV2, which is not fused.
+  AddInput<float>(TensorShape({1, 32}), ones);
+  const absl::Status status = RunOpKernel();
+  EXPECT_TRUE(absl::IsInvalidArgument(status)) << status;
+}
+
 //----------------------------------------------------------------------------//
 // Performance benchmarks are below.                                          //
 //----------------------------------------------------------------------------//
@@ -545,6 +691,79 @@ BM_Matmul(2000, 1, 2000, true, true);
 
 // LINT.ThenChange(//tensorflow/core/kernels/mkl/mkl_matmul_op_benchmark.cc)
 
+// Benchmarks of MatMul+BiasAdd+GeluExact+AddV2, as separate ops or as the
+// _FusedMatMul the remapper creates for them on CPU.
+template <typename T>
+static Graph* MatmulWithBiasGeluAndAdd(int m, int k, int n, bool fused,
+                                       DataType type) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor lhs(type, TensorShape({m, k}));
+  lhs.flat<T>().setRandom();
+  Tensor rhs(type, TensorShape({k, n}));
+  rhs.flat<T>().setRandom();
+  Tensor bias(type, TensorShape({n}));
+  bias.flat<T>().setRandom();
+  Tensor residual(type, TensorShape({m, n}));
+  residual.flat<T>().setRandom();
+
+  Node* lhs_node = test::graph::Constant(g, lhs);
+  Node* rhs_node = test::graph::Constant(g, rhs);
+  Node* bias_node = test::graph::Constant(g, bias);
+  Node* residual_node = test::graph::Constant(g, residual);
+
+  if (fused) {
+    Node* ret;
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_FusedMatMul")
+                    .Input(lhs_node)
+                    .Input(rhs_node)
+                    .Input(std::vector<NodeBuilder::NodeOut>{bias_node,
+                                                             residual_node})
+                    .Attr("T", type)
+                    .Attr("num_args", 2)
+                    .Attr("fused_ops", {"BiasAdd", "GeluExact", "Add"})
+                    .Finalize(g, &ret));
+    return g;
+  }
+
+  auto scalar = [&](float value) {
+    Tensor t(type, TensorShape({}));
+    t.scalar<T>()() = static_cast<T>(value);
+    return test::graph::Constant(g, t);
+  };
+  Node* x = test::graph::Binary(
+      g, "BiasAdd", test::graph::Matmul(g, lhs_node, rhs_node, false, false),
+      bias_node);
+  // 0.5 * x * (1 + erf(x / sqrt(2)))
+  Node* erf = test::graph::Unary(
+      g, "Erf", test::graph::Binary(g, "Mul", x, scalar(0.70710678f)));
+  Node* gelu = test::graph::Binary(
+      g, "Mul", test::graph::Binary(g, "Mul", scalar(0.5f), x),
+      test::graph::Binary(g, "AddV2", scalar(1.0f), erf));
+  test::graph::Binary(g, "AddV2", gelu, residual_node);
+  return g;
+}
+
+#define BM_MatmulGeluAddDev(M, K, N, FUSED, T, TFTYPE, DEVICE)           \
+  static void BM_MatmulGeluAdd##_##M##_##K##_##N##_##FUSED##_##DEVICE(   \
+      ::testing::benchmark::State& state) {                              \
+    test::Benchmark(#DEVICE,                                             \
+                    MatmulWithBiasGeluAndAdd<T>(M, K, N, FUSED, TFTYPE)) \
+        .Run(state);                                                     \
+    state.SetItemsProcessed(state.iterations() * M * K * N * 2);         \
+  }                                                                      \
+  BENCHMARK(BM_MatmulGeluAdd##_##M##_##K##_##N##_##FUSED##_##DEVICE)     \
+      ->MeasureProcessCPUTime();
+
+#define BM_MatmulGeluAdd(M, K, N)                            \
+  BM_MatmulGeluAddDev(M, K, N, false, float, DT_FLOAT, cpu); \
+  BM_MatmulGeluAddDev(M, K, N, true, float, DT_FLOAT, cpu);
+
+// Transformer feed-forward layers.
+BM_MatmulGeluAdd(1, 768, 3072);
+BM_MatmulGeluAdd(128, 768, 3072);
+BM_MatmulGeluAdd(128, 3072, 768);
+BM_MatmulGeluAdd(512, 1024, 4096);
+
 // Benchmarks for batched matmul with broadcasting.
 Node* BroadcastTo(Graph* g, Node* input, Node* shape) {
   Node* ret;
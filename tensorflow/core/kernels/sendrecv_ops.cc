@@ -77,6 +77,11 @@ SendOp::SendOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
   if (!ctx->GetAttr("_hostmem_sendrecv", &hostmem_sendrecv_).ok()) {
     hostmem_sendrecv_ = false;
   }
+  // The slot assigned by the partitioner is only unique in the top-level
+  // frame, so it is only set on the cached key.
+  if (!ctx->GetAttr("_rendezvous_slot", &parsed_key_.slot).ok()) {
+    parsed_key_.slot = -1;
+  }
 }
 
 void SendOp::Compute(OpKernelContext* ctx) {
@@ -158,6 +163,11 @@ RecvOp::RecvOp(OpKernelConstruction* ctx) : AsyncOpKernel(ctx) {
   if (!ctx->GetAttr("_hostmem_sendrecv", &hostmem_sendrecv_).ok()) {
     hostmem_sendrecv_ = false;
   }
+  // The slot assigned by the partitioner is only unique in the top-level
+  // frame, so it is only set on the cached key.
+  if (!ctx->GetAttr("_rendezvous_slot", &parsed_key_.slot).ok()) {
+    parsed_key_.slot = -1;
+  }
 }
 
 string RecvOp::TraceString(const OpKernelContext& ctx, bool verbose) const {
@@ -348,6 +348,7 @@ REGISTER_OP("DatasetToTFRecord")
     .Input("input_dataset: variant")
     .Input("filename: string")
     .Input("compression_type: string")
+    .Attr("write_index: bool = false")
     .SetIsStateful()
     .SetShapeFn(shape_inference::NoOutputs);
 
@@ -932,6 +932,9 @@ input is specified by `args`.
 * If there is an op A specified, the output of the BiasAdd is the input to op A,
 and op A produces the _FusedConv2D output. Otherwise, the BiasAdd produces the
 _FusedConv2D output.
+* On CPU, ["BiasAdd","Add"] and ["BiasAdd",G,"Add"], where G is one of
+{"GeluApproximate","GeluExact"}, add a residual of the output shape, given as
+the second of `args`, to the result.
 
 *NOTE*: Do not invoke this operator directly in Python. Grappler is
 expected to create these operators.
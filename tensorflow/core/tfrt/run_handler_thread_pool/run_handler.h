@@ -51,6 +51,15 @@ struct RunHandlerOptions {
 
   // Request priority.
   int priority;
+
+  // Request deadline, in microseconds since the Unix epoch. Among the requests
+  // of the same priority, the one with the earliest deadline is scheduled
+  // first. The requests without a deadline (0) are scheduled last.
+  int64_t deadline_micros = 0;
+
+  // Maximum number of inter-op closures of the request that may run
+  // concurrently. 0 uses the default limit of the pool.
+  int max_inter_op_inflight = 0;
 };
 
 // RunHandlerPool is a fixed size pool of pre-allocated RunHandlers
@@ -131,6 +140,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64_t> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the step ids of the active handlers, in the order of the active
+  // handler list.
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting() const;
+
   // Block until the system is quiescent (no pending work and no inflight work).
   void Quiesce() const;
 
@@ -144,7 +157,8 @@ class RunHandlerPool {
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
 // handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// (priority of the request, then earliest deadline first, then time of the
+// Get() call).
 //
 // It can only be created via RunHandlerPool::Get().
 //
@@ -250,6 +264,14 @@ class ThreadWorkSource {
 
   void DecrementInflightTaskCount(bool is_blocking);
 
+  // Sets the maximum number of blocking tasks of the request that may run
+  // concurrently. 0 uses the limit passed to MayRunBlockingTask().
+  void SetMaxBlockingInflight(int64_t value);
+
+  // Returns whether another blocking task may run, `default_max_inflight`
+  // being the limit of the thread pool.
+  bool MayRunBlockingTask(int64_t default_max_inflight);
+
   int64_t GetPendingTaskCount();
 
   void IncrementPendingTaskCount();
@@ -273,6 +295,7 @@ class ThreadWorkSource {
   // The number of tasks that are executing now.
   std::atomic<int64_t> blocking_inflight_;
   std::atomic<int64_t> non_blocking_inflight_;
+  std::atomic<int64_t> max_blocking_inflight_;
 
   // The number of tasks that are enqueued and not finished.
   std::atomic<int64_t> pending_tasks_;
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/run_handler_thread_pool/run_handler_concurrent_work_queue.h"
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -65,7 +66,30 @@ RunHandlerThreadWorkQueue::RunHandlerThreadWorkQueue(const Options& options)
 
 absl::StatusOr<std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
 RunHandlerThreadWorkQueue::InitializeRequest(int64_t request_id) const {
+  return InitializeRequest(request_id, RunHandlerOptions());
+}
+
+absl::StatusOr<std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
+RunHandlerThreadWorkQueue::InitializeRequest(
+    int64_t request_id, int priority,
+    std::optional<std::chrono::system_clock::time_point> deadline) const {
   RunHandlerOptions options;
+  options.priority = priority;
+  if (deadline.has_value()) {
+    options.deadline_micros =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            deadline->time_since_epoch())
+            .count();
+  }
+  return InitializeRequest(request_id, options);
+}
+
+absl::StatusOr<std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
+RunHandlerThreadWorkQueue::InitializeRequest(int64_t request_id,
+                                             RunHandlerOptions options) const {
+  if (options.max_inter_op_inflight == 0) {
+    options.max_inter_op_inflight = options_.max_inter_op_inflight_per_request;
+  }
   std::unique_ptr<RunHandler> handler =
       handler_pool_->Get(request_id, options_.init_timeout_ms, options);
   if (!handler) {
@@ -130,7 +154,9 @@ std::ostream& operator<<(std::ostream& strm,
               << options.use_adaptive_waiting_time
               << ", wait_if_no_active_request = "
               << options.wait_if_no_active_request
-              << ", enable_wake_up = " << options.enable_wake_up << "}";
+              << ", enable_wake_up = " << options.enable_wake_up
+              << ", max_inter_op_inflight_per_request = "
+              << options.max_inter_op_inflight_per_request << "}";
 }
 
 }  // namespace tf
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_TFRT_RUN_HANDLER_THREAD_POOL_RUN_HANDLER_CONCURRENT_WORK_QUEUE_H_
 
 #include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -81,6 +82,11 @@ class RunHandlerThreadWorkQueue
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // Maximum number of inter-op closures of a request that may run
+    // concurrently, so that a large request does not occupy all the main
+    // threads. 0 uses the default limit of the pool.
+    int max_inter_op_inflight_per_request = 0;
   };
 
   explicit RunHandlerThreadWorkQueue(const Options& options);
@@ -96,6 +102,15 @@ class RunHandlerThreadWorkQueue
   absl::StatusOr<std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
   InitializeRequest(int64_t request_id) const override;
 
+  // Same as above, with the priority and deadline of the request in `options`.
+  absl::StatusOr<std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
+  InitializeRequest(int64_t request_id, RunHandlerOptions options) const;
+
+  absl::StatusOr<std::unique_ptr<tensorflow::tfrt_stub::WorkQueueInterface>>
+  InitializeRequest(int64_t request_id, int priority,
+                    std::optional<std::chrono::system_clock::time_point>
+                        deadline) const override;
+
   int GetParallelismLevel() const override {
     return options_.num_main_threads + options_.num_complementary_threads;
   }
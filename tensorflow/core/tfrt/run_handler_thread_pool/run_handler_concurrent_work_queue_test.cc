@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/tfrt/run_handler_thread_pool/run_handler_concurrent_work_queue.h"
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 #include <utility>
 
@@ -160,6 +161,25 @@ TEST_F(RunHandlerThreadWorkQueueTest, RunningMixedTask) {
   EXPECT_EQ(n, 20);
 }
 
+TEST_F(RunHandlerThreadWorkQueueTest, InitializeRequestWithDeadline) {
+  tensorflow::tfrt_stub::WorkQueueInterface* work_queue = pool_.get();
+  auto queue = work_queue->InitializeRequest(
+      /*request_id=*/101, /*priority=*/1,
+      std::chrono::system_clock::now() + std::chrono::seconds(10));
+  ASSERT_TRUE(queue.ok());
+  ASSERT_NE(*queue, nullptr);
+  int n = 0;
+  tensorflow::mutex m;
+  for (int i = 0; i < 10; ++i) {
+    (*queue)->AddTask(TaskFunction([&n, &m] {
+      tensorflow::mutex_lock lock(m);
+      ++n;
+    }));
+  }
+  pool_->Quiesce();
+  EXPECT_EQ(n, 10);
+}
+
 TEST_F(RunHandlerThreadWorkQueueTest, NameReturnsValidString) {
   EXPECT_TRUE(absl::StrContains(pool_->name(), "RunHandlerThreadWorkQueue"));
 }
@@ -119,6 +119,31 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, DeadlineSchedulingTest) {
+  int num_threads = 2;
+  RunHandlerPool::Options pool_options;
+  pool_options.num_intra_op_threads = num_threads;
+  pool_options.num_inter_op_threads = num_threads;
+  pool_options.num_threads_in_sub_thread_pool = {2};
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(pool_options));
+
+  RunHandlerOptions options = RunHandlerOptions();
+  options.priority = 1;
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  options.deadline_micros = 2000;
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  options.deadline_micros = 1000;
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+  options.priority = 2;
+  options.deadline_micros = 3000;
+  auto handler4 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/0, options);
+
+  // The active requests should be ordered by priorities, then by deadlines,
+  // the request without a deadline coming last.
+  EXPECT_THAT(pool->GetActiveHandlerStepIdsForTesting(),
+              ::testing::ElementsAre(4, 3, 2, 1));
+}
+
 TEST(RunHandlerUtilTest, IntraOpThreadPool) {
   int num_threads = 2;
   RunHandlerPool::Options pool_options;
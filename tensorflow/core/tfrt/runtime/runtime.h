@@ -15,9 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_RUNTIME_RUNTIME_H_
 #define TENSORFLOW_CORE_TFRT_RUNTIME_RUNTIME_H_
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -220,6 +222,18 @@ class Runtime {
     return work_queue_->InitializeRequest(request_id);
   }
 
+  // Same as above, for a request with `priority` and `deadline`, which the
+  // work queue may schedule by.
+  absl::StatusOr<std::unique_ptr<WorkQueueInterface>> CreateRequestQueue(
+      int64_t request_id, int priority,
+      std::optional<std::chrono::system_clock::time_point> deadline) const {
+    if (create_request_queue_fn_) {
+      return create_request_queue_fn_(request_id);
+    }
+
+    return work_queue_->InitializeRequest(request_id, priority, deadline);
+  }
+
  private:
   explicit Runtime(std::unique_ptr<tfrt::CoreRuntime> core_runtime,
                    WorkQueueInterface* work_queue);
@@ -15,8 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_RUNTIME_WORK_QUEUE_INTERFACE_H_
 #define TENSORFLOW_CORE_TFRT_RUNTIME_WORK_QUEUE_INTERFACE_H_
 
+#include <chrono>  // NOLINT(build/c++11)
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -65,6 +67,15 @@ class WorkQueueInterface : public tfrt::ConcurrentWorkQueue {
     return {nullptr};
   }
 
+  // Same as above, with the priority and the deadline of the request, for the
+  // implementations that schedule the requests by them. By default, they are
+  // ignored.
+  virtual absl::StatusOr<std::unique_ptr<WorkQueueInterface>> InitializeRequest(
+      int64_t request_id, int priority,
+      std::optional<std::chrono::system_clock::time_point> deadline) const {
+    return InitializeRequest(request_id);
+  }
+
  private:
   int64_t id_ = 0;
   thread::ThreadPoolInterface* intra_op_threadpool_ = nullptr;
@@ -0,0 +1,255 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/arena_plan_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/simple_memory_arena.h"
+
+namespace tflite {
+namespace {
+
+// Identifies the format of serialized plans.
+constexpr char kMagic[] = "TFLAPC01";
+constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+
+// Whether two allocations are of the same tensor, with the same size and usage
+// interval.
+bool SameRequest(const ArenaAllocWithUsageInterval& a,
+                 const ArenaAllocWithUsageInterval& b) {
+  return a.tensor == b.tensor && a.size == b.size &&
+         a.first_node == b.first_node && a.last_node == b.last_node;
+}
+
+bool SameRequests(const std::vector<ArenaAllocWithUsageInterval>& a,
+                  const std::vector<ArenaAllocWithUsageInterval>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), SameRequest);
+}
+
+// Values are serialized in little-endian order.
+void WriteUint(uint64_t value, int num_bytes, std::string* data) {
+  for (int i = 0; i < num_bytes; ++i) {
+    data->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+class Reader {
+ public:
+  explicit Reader(const std::string& data) : data_(data) {}
+
+  bool ReadUint(int num_bytes, uint64_t* value) {
+    if (data_.size() - position_ < static_cast<size_t>(num_bytes)) {
+      return false;
+    }
+    *value = 0;
+    for (int i = 0; i < num_bytes; ++i) {
+      *value |= static_cast<uint64_t>(
+                    static_cast<unsigned char>(data_[position_ + i]))
+                << (8 * i);
+    }
+    position_ += num_bytes;
+    return true;
+  }
+
+  bool ReadInt32(int32_t* value) {
+    uint64_t v;
+    if (!ReadUint(4, &v)) return false;
+    *value = static_cast<int32_t>(static_cast<uint32_t>(v));
+    return true;
+  }
+
+  bool ReadSize(size_t* value) {
+    uint64_t v;
+    if (!ReadUint(8, &v) || v > std::numeric_limits<size_t>::max()) {
+      return false;
+    }
+    *value = static_cast<size_t>(v);
+    return true;
+  }
+
+  bool ReadMagic() {
+    if (data_.compare(0, kMagicSize, kMagic) != 0) return false;
+    position_ = kMagicSize;
+    return true;
+  }
+
+  size_t remaining() const { return data_.size() - position_; }
+
+ private:
+  const std::string& data_;
+  size_t position_ = 0;
+};
+
+}  // namespace
+
+bool IsValidArenaPlan(const ArenaPlan& plan) {
+  const std::vector<ArenaAllocWithUsageInterval>& allocs = plan.allocs;
+  for (size_t i = 0; i < allocs.size(); ++i) {
+    const ArenaAllocWithUsageInterval& alloc = allocs[i];
+    if (alloc.tensor < 0 || (i > 0 && allocs[i - 1].tensor >= alloc.tensor) ||
+        alloc.first_node < 0 || alloc.first_node > alloc.last_node ||
+        alloc.size > plan.arena_size ||
+        alloc.offset > plan.arena_size - alloc.size) {
+      return false;
+    }
+  }
+  // Checks the allocations in order of their offsets against the following
+  // ones they overlap with.
+  std::vector<const ArenaAllocWithUsageInterval*> by_offset;
+  by_offset.reserve(allocs.size());
+  for (const ArenaAllocWithUsageInterval& alloc : allocs) {
+    if (alloc.size > 0) by_offset.push_back(&alloc);
+  }
+  std::sort(by_offset.begin(), by_offset.end(),
+            [](const ArenaAllocWithUsageInterval* a,
+               const ArenaAllocWithUsageInterval* b) { return *a < *b; });
+  for (size_t i = 0; i < by_offset.size(); ++i) {
+    const ArenaAllocWithUsageInterval& a = *by_offset[i];
+    for (size_t j = i + 1;
+         j < by_offset.size() && by_offset[j]->offset < a.offset + a.size;
+         ++j) {
+      const ArenaAllocWithUsageInterval& b = *by_offset[j];
+      if (a.first_node <= b.last_node && b.first_node <= a.last_node) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+ArenaPlanCache::ArenaPlanCache(int capacity)
+    : capacity_(std::max(capacity, 1)) {}
+
+bool ArenaPlanCache::Lookup(int subgraph_index,
+                            std::vector<ArenaAllocWithUsageInterval>* allocs,
+                            size_t* arena_size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = plans_.begin(); it != plans_.end(); ++it) {
+    if (it->subgraph_index != subgraph_index ||
+        !SameRequests(it->allocs, *allocs)) {
+      continue;
+    }
+    for (size_t i = 0; i < allocs->size(); ++i) {
+      (*allocs)[i].offset = it->allocs[i].offset;
+    }
+    *arena_size = it->arena_size;
+    plans_.splice(plans_.begin(), plans_, it);
+    ++num_hits_;
+    return true;
+  }
+  ++num_misses_;
+  return false;
+}
+
+void ArenaPlanCache::Insert(ArenaPlan plan) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = plans_.begin(); it != plans_.end(); ++it) {
+    if (it->subgraph_index == plan.subgraph_index &&
+        SameRequests(it->allocs, plan.allocs)) {
+      if (plan.arena_size < it->arena_size) *it = std::move(plan);
+      plans_.splice(plans_.begin(), plans_, it);
+      return;
+    }
+  }
+  plans_.push_front(std::move(plan));
+  if (plans_.size() > static_cast<size_t>(capacity_)) {
+    plans_.pop_back();
+  }
+}
+
+std::vector<ArenaPlan> ArenaPlanCache::GetPlans() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::vector<ArenaPlan>(plans_.begin(), plans_.end());
+}
+
+std::string ArenaPlanCache::Serialize() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::string data(kMagic, kMagicSize);
+  WriteUint(plans_.size(), 4, &data);
+  // Least recently used first, so that deserializing the plans into a cache
+  // restores their order.
+  for (auto it = plans_.rbegin(); it != plans_.rend(); ++it) {
+    WriteUint(static_cast<uint32_t>(it->subgraph_index), 4, &data);
+    WriteUint(it->arena_size, 8, &data);
+    WriteUint(it->allocs.size(), 4, &data);
+    for (const ArenaAllocWithUsageInterval& alloc : it->allocs) {
+      WriteUint(static_cast<uint32_t>(alloc.tensor), 4, &data);
+      WriteUint(static_cast<uint32_t>(alloc.first_node), 4, &data);
+      WriteUint(static_cast<uint32_t>(alloc.last_node), 4, &data);
+      WriteUint(alloc.offset, 8, &data);
+      WriteUint(alloc.size, 8, &data);
+    }
+  }
+  return data;
+}
+
+bool ArenaPlanCache::Deserialize(const std::string& data) {
+  // Size of a serialized allocation.
+  constexpr size_t kAllocSize = 3 * 4 + 2 * 8;
+  Reader reader(data);
+  uint64_t num_plans;
+  if (!reader.ReadMagic() || !reader.ReadUint(4, &num_plans)) return false;
+  std::vector<ArenaPlan> plans;
+  for (uint64_t p = 0; p < num_plans; ++p) {
+    ArenaPlan plan;
+    uint64_t num_allocs;
+    if (!reader.ReadInt32(&plan.subgraph_index) ||
+        !reader.ReadSize(&plan.arena_size) ||
+        !reader.ReadUint(4, &num_allocs) ||
+        reader.remaining() / kAllocSize < num_allocs) {
+      return false;
+    }
+    plan.allocs.resize(num_allocs);
+    for (ArenaAllocWithUsageInterval& alloc : plan.allocs) {
+      if (!reader.ReadInt32(&alloc.tensor) ||
+          !reader.ReadInt32(&alloc.first_node) ||
+          !reader.ReadInt32(&alloc.last_node) ||
+          !reader.ReadSize(&alloc.offset) || !reader.ReadSize(&alloc.size)) {
+        return false;
+      }
+    }
+    if (plan.subgraph_index < 0 || !IsValidArenaPlan(plan)) return false;
+    plans.push_back(std::move(plan));
+  }
+  if (reader.remaining() != 0) return false;
+  for (ArenaPlan& plan : plans) {
+    Insert(std::move(plan));
+  }
+  return true;
+}
+
+int ArenaPlanCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return plans_.size();
+}
+
+int64_t ArenaPlanCache::num_hits() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_hits_;
+}
+
+int64_t ArenaPlanCache::num_misses() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_misses_;
+}
+
+}  // namespace tflite
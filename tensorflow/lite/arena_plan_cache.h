@@ -0,0 +1,108 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_ARENA_PLAN_CACHE_H_
+#define TENSORFLOW_LITE_ARENA_PLAN_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/simple_memory_arena.h"
+
+namespace tflite {
+
+// WARNING: This is an experimental API and subject to change.
+
+// The layout of the non-persistent arena of one subgraph for one set of tensor
+// sizes, as computed by `ArenaPlanner` for the shapes of the subgraph inputs.
+struct ArenaPlan {
+  int subgraph_index = 0;
+  // One allocation for every tensor that owns a buffer in the arena, sorted by
+  // tensor index. `first_node` and `last_node` are the execution plan indices
+  // of the first and last node using the tensor.
+  std::vector<ArenaAllocWithUsageInterval> allocs;
+  // Size of the arena.
+  size_t arena_size = 0;
+};
+
+// Returns whether the allocations of `plan` are sorted by tensor index, fit in
+// the arena, and do not share memory while they are both in use.
+bool IsValidArenaPlan(const ArenaPlan& plan);
+
+// Plans of the non-persistent arenas of the subgraphs of a model, keyed by the
+// sizes and usage intervals of their tensors.
+//
+// `ArenaPlanner` looks up the plan of the whole subgraph every time tensors
+// are allocated from scratch, e.g. after inputs were resized, and only runs
+// its allocation algorithm on a miss, adding the result to the cache. A cache
+// can be serialized to a file next to the model, so that later processes
+// start without planning, and its plans can be replaced by tighter ones
+// computed offline, see tensorflow/lite/tools/arena_plan_optimizer.h.
+//
+// A cache can be shared by several interpreters of the same model, e.g. the
+// interpreters of an `InterpreterPool`. It is thread-safe.
+class ArenaPlanCache {
+ public:
+  // Keeps up to `capacity` plans, evicting the least recently used one.
+  explicit ArenaPlanCache(int capacity = 16);
+
+  ArenaPlanCache(const ArenaPlanCache&) = delete;
+  ArenaPlanCache& operator=(const ArenaPlanCache&) = delete;
+
+  // Looks up the plan of subgraph `subgraph_index` for `allocs`, which must be
+  // sorted by tensor index. If a plan has allocations of the same tensors with
+  // the same sizes and usage intervals, sets the offsets of `allocs` and
+  // `arena_size` from it and returns true.
+  bool Lookup(int subgraph_index,
+              std::vector<ArenaAllocWithUsageInterval>* allocs,
+              size_t* arena_size);
+
+  // Adds `plan`, which must be valid. If the cache has a plan for the same
+  // allocations, keeps the one with the smaller arena.
+  void Insert(ArenaPlan plan);
+
+  // Returns the plans, most recently used first.
+  std::vector<ArenaPlan> GetPlans() const;
+
+  // Serializes the plans. The format is independent of the platform, so plans
+  // can be computed on a host for a device.
+  std::string Serialize() const;
+
+  // Adds the plans serialized in `data`. Returns false, without adding any
+  // plan, if `data` is malformed or contains an invalid plan.
+  bool Deserialize(const std::string& data);
+
+  int capacity() const { return capacity_; }
+  int size() const;
+
+  // Number of lookups that found a plan, and that did not.
+  int64_t num_hits() const;
+  int64_t num_misses() const;
+
+ private:
+  const int capacity_;
+  mutable std::mutex mutex_;
+  // Most recently used first.
+  std::list<ArenaPlan> plans_;
+  int64_t num_hits_ = 0;
+  int64_t num_misses_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_ARENA_PLAN_CACHE_H_
@@ -0,0 +1,197 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/arena_plan_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/simple_memory_arena.h"
+
+namespace tflite {
+namespace {
+
+ArenaAllocWithUsageInterval Alloc(int32_t tensor, size_t offset, size_t size,
+                                  int32_t first_node, int32_t last_node) {
+  ArenaAllocWithUsageInterval alloc;
+  alloc.tensor = tensor;
+  alloc.offset = offset;
+  alloc.size = size;
+  alloc.first_node = first_node;
+  alloc.last_node = last_node;
+  return alloc;
+}
+
+// Tensor 1 is only used by node 0, so tensor 3 reuses its memory.
+ArenaPlan TestPlan(int subgraph_index = 0) {
+  ArenaPlan plan;
+  plan.subgraph_index = subgraph_index;
+  plan.allocs = {Alloc(0, 0, 64, 0, 2), Alloc(1, 64, 64, 0, 0),
+                 Alloc(2, 128, 32, 1, 2), Alloc(3, 64, 64, 1, 1)};
+  plan.arena_size = 160;
+  return plan;
+}
+
+// Returns the allocations of `plan` without their offsets.
+std::vector<ArenaAllocWithUsageInterval> Requests(const ArenaPlan& plan) {
+  std::vector<ArenaAllocWithUsageInterval> requests = plan.allocs;
+  for (ArenaAllocWithUsageInterval& alloc : requests) {
+    alloc.offset = 0;
+  }
+  return requests;
+}
+
+TEST(IsValidArenaPlanTest, ValidPlan) {
+  EXPECT_TRUE(IsValidArenaPlan(TestPlan()));
+  EXPECT_TRUE(IsValidArenaPlan(ArenaPlan()));
+}
+
+TEST(IsValidArenaPlanTest, OverlappingAllocations) {
+  ArenaPlan plan = TestPlan();
+  // Tensors 0 and 2 are both used by nodes 1 and 2.
+  plan.allocs[2].offset = 32;
+  EXPECT_FALSE(IsValidArenaPlan(plan));
+}
+
+TEST(IsValidArenaPlanTest, AllocationOutsideOfArena) {
+  ArenaPlan plan = TestPlan();
+  plan.arena_size = 150;
+  EXPECT_FALSE(IsValidArenaPlan(plan));
+}
+
+TEST(IsValidArenaPlanTest, UnsortedAllocations) {
+  ArenaPlan plan = TestPlan();
+  std::swap(plan.allocs[0], plan.allocs[1]);
+  EXPECT_FALSE(IsValidArenaPlan(plan));
+}
+
+TEST(ArenaPlanCacheTest, LookupSetsOffsets) {
+  ArenaPlanCache cache;
+  cache.Insert(TestPlan());
+  std::vector<ArenaAllocWithUsageInterval> allocs = Requests(TestPlan());
+  size_t arena_size = 0;
+  ASSERT_TRUE(cache.Lookup(/*subgraph_index=*/0, &allocs, &arena_size));
+  EXPECT_EQ(arena_size, 160);
+  for (size_t i = 0; i < allocs.size(); ++i) {
+    EXPECT_EQ(allocs[i].offset, TestPlan().allocs[i].offset);
+  }
+  EXPECT_EQ(cache.num_hits(), 1);
+  EXPECT_EQ(cache.num_misses(), 0);
+}
+
+TEST(ArenaPlanCacheTest, LookupMisses) {
+  ArenaPlanCache cache;
+  cache.Insert(TestPlan());
+  size_t arena_size = 0;
+
+  std::vector<ArenaAllocWithUsageInterval> allocs = Requests(TestPlan());
+  EXPECT_FALSE(cache.Lookup(/*subgraph_index=*/1, &allocs, &arena_size));
+
+  allocs[2].size = 48;
+  EXPECT_FALSE(cache.Lookup(/*subgraph_index=*/0, &allocs, &arena_size));
+
+  allocs = Requests(TestPlan());
+  allocs[3].last_node = 2;
+  EXPECT_FALSE(cache.Lookup(/*subgraph_index=*/0, &allocs, &arena_size));
+
+  allocs = Requests(TestPlan());
+  allocs.pop_back();
+  EXPECT_FALSE(cache.Lookup(/*subgraph_index=*/0, &allocs, &arena_size));
+  EXPECT_EQ(cache.num_misses(), 4);
+}
+
+TEST(ArenaPlanCacheTest, KeepsSmallerPlan) {
+  ArenaPlanCache cache;
+  ArenaPlan plan = TestPlan();
+  // Without memory reuse.
+  plan.allocs[3].offset = 160;
+  plan.arena_size = 224;
+  cache.Insert(plan);
+  cache.Insert(TestPlan());
+  cache.Insert(plan);
+  ASSERT_EQ(cache.size(), 1);
+  EXPECT_EQ(cache.GetPlans()[0].arena_size, 160);
+}
+
+TEST(ArenaPlanCacheTest, EvictsLeastRecentlyUsedPlan) {
+  ArenaPlanCache cache(/*capacity=*/2);
+  cache.Insert(TestPlan(/*subgraph_index=*/0));
+  cache.Insert(TestPlan(/*subgraph_index=*/1));
+  std::vector<ArenaAllocWithUsageInterval> allocs = Requests(TestPlan());
+  size_t arena_size;
+  ASSERT_TRUE(cache.Lookup(/*subgraph_index=*/0, &allocs, &arena_size));
+  cache.Insert(TestPlan(/*subgraph_index=*/2));
+
+  std::vector<ArenaPlan> plans = cache.GetPlans();
+  ASSERT_EQ(plans.size(), 2);
+  EXPECT_EQ(plans[0].subgraph_index, 2);
+  EXPECT_EQ(plans[1].subgraph_index, 0);
+}
+
+TEST(ArenaPlanCacheTest, SerializeAndDeserialize) {
+  ArenaPlanCache cache;
+  cache.Insert(TestPlan(/*subgraph_index=*/0));
+  ArenaPlan plan = TestPlan(/*subgraph_index=*/1);
+  plan.allocs[0].last_node = std::numeric_limits<int32_t>::max();
+  cache.Insert(plan);
+
+  ArenaPlanCache restored;
+  ASSERT_TRUE(restored.Deserialize(cache.Serialize()));
+  std::vector<ArenaPlan> plans = restored.GetPlans();
+  ASSERT_EQ(plans.size(), 2);
+  EXPECT_EQ(plans[0].subgraph_index, 1);
+  EXPECT_EQ(plans[1].subgraph_index, 0);
+  EXPECT_EQ(plans[0].arena_size, plan.arena_size);
+  ASSERT_EQ(plans[0].allocs.size(), plan.allocs.size());
+  for (size_t i = 0; i < plan.allocs.size(); ++i) {
+    EXPECT_EQ(plans[0].allocs[i].tensor, plan.allocs[i].tensor);
+    EXPECT_EQ(plans[0].allocs[i].offset, plan.allocs[i].offset);
+    EXPECT_EQ(plans[0].allocs[i].size, plan.allocs[i].size);
+    EXPECT_EQ(plans[0].allocs[i].first_node, plan.allocs[i].first_node);
+    EXPECT_EQ(plans[0].allocs[i].last_node, plan.allocs[i].last_node);
+  }
+}
+
+TEST(ArenaPlanCacheTest, RejectsMalformedData) {
+  ArenaPlanCache cache;
+  cache.Insert(TestPlan());
+  const std::string data = cache.Serialize();
+
+  ArenaPlanCache restored;
+  EXPECT_FALSE(restored.Deserialize(""));
+  EXPECT_FALSE(restored.Deserialize("not a plan"));
+  EXPECT_FALSE(restored.Deserialize(data.substr(0, data.size() - 1)));
+  EXPECT_FALSE(restored.Deserialize(data + "x"));
+  EXPECT_EQ(restored.size(), 0);
+}
+
+TEST(ArenaPlanCacheTest, RejectsInvalidPlan) {
+  ArenaPlanCache cache;
+  ArenaPlan plan = TestPlan();
+  plan.allocs[2].offset = 32;
+  // `Insert` does not check plans.
+  cache.Insert(plan);
+
+  ArenaPlanCache restored;
+  EXPECT_FALSE(restored.Deserialize(cache.Serialize()));
+  EXPECT_EQ(restored.size(), 0);
+}
+
+}  // namespace
+}  // namespace tflite
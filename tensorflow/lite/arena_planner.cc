@@ -23,6 +23,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/lite/arena_plan_cache.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/simple_memory_arena.h"
@@ -45,6 +46,8 @@ ArenaPlanner::ArenaPlanner(TfLiteContext* context,
       persistent_arena_(kDefaultArenaAlignment, subgraph_index),
       preserve_all_tensors_(preserve_all_tensors),
       tensor_alignment_(tensor_alignment),
+      subgraph_index_(subgraph_index),
+      allocations_reset_(true),
       last_active_node_(kLastActiveNodeUndefined) {}
 
 ArenaPlanner::~ArenaPlanner() {
@@ -71,6 +74,7 @@ TfLiteStatus ArenaPlanner::ResetAllocations() {
   // all allocs to be cleared. if this is not set, the slow path is taken
   // (Purge) which inspects each alloc. Both paths give the exact same result.
   last_active_node_ = kLastActiveNodeUndefined;
+  allocations_reset_ = true;
   return kTfLiteOk;
 }
 
@@ -486,6 +490,11 @@ std::vector<int32_t> ArenaPlanner::GetTensorsToAllocate(int first_node,
 
 TfLiteStatus ArenaPlanner::CalculateAllocations(
     int first_node, int last_node, std::vector<int32_t>* tensors_allocated) {
+  // Whether all tensors of the graph are allocated from scratch.
+  const bool allocates_all_tensors =
+      allocations_reset_ && first_node == 0 &&
+      static_cast<size_t>(last_node) + 1 >= graph_info_->num_execution_nodes();
+  allocations_reset_ = false;
   // Indices of tensors in order their allocation offsets will be calculated.
   const std::vector<int32_t> tensors_to_allocate =
       GetTensorsToAllocate(first_node, last_node);
@@ -518,6 +527,8 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     arena_.PurgeActiveAllocs(first_node);
   }
   CreateTensorAllocationVector(tensors_allocated);
+  // ArenaRw tensors allocated from the plan cache, in allocation order.
+  std::vector<int32_t> cached_tensors;
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : *tensors_allocated) {
     TfLiteTensor& tensor = tensors[tensor_index];
@@ -541,6 +552,10 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
+      if (plan_cache_ != nullptr && allocates_all_tensors) {
+        cached_tensors.push_back(tensor_index);
+        continue;
+      }
       TF_LITE_ENSURE_STATUS(
           arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
                           tensor_index, alloc_node_[tensor_index],
@@ -559,10 +574,60 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
   }
+  if (!cached_tensors.empty()) {
+    TF_LITE_ENSURE_STATUS(CalculateAllocationsWithPlanCache(cached_tensors));
+  }
   last_active_node_ = last_node;
   return kTfLiteOk;
 }
 
+TfLiteStatus ArenaPlanner::CalculateAllocationsWithPlanCache(
+    const std::vector<int32_t>& tensors) {
+  const TfLiteTensor* graph_tensors = graph_info_->tensors();
+  std::vector<ArenaAllocWithUsageInterval> allocs(tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const int32_t tensor_index = tensors[i];
+    allocs[i].tensor = tensor_index;
+    allocs[i].size = graph_tensors[tensor_index].bytes;
+    allocs[i].first_node = alloc_node_[tensor_index];
+    allocs[i].last_node = dealloc_node_[tensor_index];
+  }
+  std::sort(allocs.begin(), allocs.end(),
+            [](const ArenaAllocWithUsageInterval& a,
+               const ArenaAllocWithUsageInterval& b) {
+              return a.tensor < b.tensor;
+            });
+  size_t arena_size = 0;
+  if (plan_cache_->Lookup(subgraph_index_, &allocs, &arena_size) &&
+      std::all_of(allocs.begin(), allocs.end(),
+                  [this](const ArenaAllocWithUsageInterval& alloc) {
+                    return alloc.offset % tensor_alignment_ == 0;
+                  })) {
+    for (const auto& alloc : allocs) {
+      allocs_[alloc.tensor] = alloc;
+    }
+    arena_.AllocateAt(allocs);
+    return kTfLiteOk;
+  }
+
+  // Tensors are allocated in the order of `tensors`, as without a cache.
+  for (const int32_t tensor_index : tensors) {
+    TF_LITE_ENSURE_STATUS(arena_.Allocate(
+        context_, tensor_alignment_, graph_tensors[tensor_index].bytes,
+        tensor_index, alloc_node_[tensor_index], dealloc_node_[tensor_index],
+        &allocs_[tensor_index]));
+  }
+  ArenaPlan plan;
+  plan.subgraph_index = subgraph_index_;
+  for (auto& alloc : allocs) {
+    alloc.offset = allocs_[alloc.tensor].offset;
+    plan.arena_size = std::max(plan.arena_size, alloc.offset + alloc.size);
+  }
+  plan.allocs = std::move(allocs);
+  plan_cache_->Insert(std::move(plan));
+  return kTfLiteOk;
+}
+
 bool AreTensorsAllocatedInSameArena(int32_t root_tensor_index,
                                     int32_t tensor_index,
                                     const TfLiteTensor* tensors) {
@@ -20,8 +20,10 @@ limitations under the License.
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "tensorflow/lite/arena_plan_cache.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
@@ -72,6 +74,13 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Makes the planner look up the layout of the non-persistent arena in
+  // `plan_cache` whenever all tensors of the graph are allocated from scratch,
+  // and add the layouts it computes otherwise.
+  void SetPlanCache(std::shared_ptr<ArenaPlanCache> plan_cache) {
+    plan_cache_ = std::move(plan_cache);
+  }
+
  private:
   // Check whether the input tensor's memory may be shared the output tensor.
   // tensor_changed: true if the output tensor modifies the tensor data. For
@@ -104,6 +113,12 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus CalculateAllocations(int first_node, int last_node,
                                     std::vector<int32_t>* tensors_allocated);
 
+  // Reserve space in the non-persistent arena for `tensors`, which are all the
+  // tensors of the graph owning a buffer in it, using the layout of the plan
+  // cache if it has one for their sizes and usage intervals.
+  TfLiteStatus CalculateAllocationsWithPlanCache(
+      const std::vector<int32_t>& tensors);
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int32_t tensor_index,
@@ -156,6 +171,14 @@ class ArenaPlanner : public MemoryPlanner {
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
 
+  int subgraph_index_;
+
+  // Layouts of the non-persistent arena, may be null.
+  std::shared_ptr<ArenaPlanCache> plan_cache_;
+
+  // True when no tensor was allocated since the allocations were reset.
+  bool allocations_reset_;
+
   // Index of the last node whose tensors were allocated.
   int last_active_node_;
 
@@ -28,6 +28,7 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "tensorflow/lite/arena_plan_cache.h"
 #include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -1101,6 +1102,119 @@ TEST_F(ArenaPlannerTest, DebugTensorsInputReuse) {
   EXPECT_NE(GetOffset(4), GetOffset(5));
 }
 
+// A graph where the memory of tensors 1 to 4 is reused for tensors 6 to 8.
+TestGraph ComplexGraph() {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {}},
+                      {{1}, {2}, {}},
+                      {{1}, {3}, {}},
+                      {{1}, {4}, {}},
+                      {{2, 3, 4}, {5}, {}},
+                      {{5}, {6}, {}},
+                      {{5}, {7}, {}},
+                      {{6, 7}, {8}, {}},
+                  },
+                  {8});
+  const std::vector<size_t> bytes = {32, 28, 36, 16, 8, 64, 10, 40, 12};
+  for (int i = 0; i < bytes.size(); ++i) {
+    (*graph.tensors())[i].bytes = bytes[i];
+  }
+  return graph;
+}
+
+TEST_F(ArenaPlannerTest, PlanCacheReusesLayout) {
+  TestGraph graph = ComplexGraph();
+  SetGraph(&graph);
+  auto cache = std::make_shared<ArenaPlanCache>();
+  planner_->SetPlanCache(cache);
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(cache->size(), 1);
+  EXPECT_EQ(cache->num_misses(), 1);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i < graph.tensors()->size(); ++i) {
+    offsets.push_back(GetOffset(i));
+  }
+  EXPECT_EQ(offsets[5], 32);
+
+  ResetAllocations();
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(cache->num_hits(), 1);
+  for (int i = 0; i < graph.tensors()->size(); ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+
+  // As if the input was resized.
+  (*graph.tensors())[0].bytes = 64;
+  ResetAllocations();
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(cache->num_misses(), 2);
+  EXPECT_EQ(cache->size(), 2);
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(0));
+
+  (*graph.tensors())[0].bytes = 32;
+  ResetAllocations();
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(cache->num_hits(), 2);
+  for (int i = 0; i < graph.tensors()->size(); ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+
+  // Another planner of the same graph uses the plans of the cache.
+  SetGraph(&graph);
+  planner_->SetPlanCache(cache);
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(cache->num_hits(), 3);
+  for (int i = 0; i < graph.tensors()->size(); ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+}
+
+TEST_F(ArenaPlannerTest, PlanCacheUsesImportedPlan) {
+  TestGraph graph = ComplexGraph();
+  SetGraph(&graph);
+  auto cache = std::make_shared<ArenaPlanCache>();
+  planner_->SetPlanCache(cache);
+  Execute(0, graph.nodes().size() - 1);
+
+  // A plan placing every tensor after the previous one.
+  ArenaPlan plan = cache->GetPlans()[0];
+  plan.arena_size = 0;
+  for (auto& alloc : plan.allocs) {
+    alloc.offset = plan.arena_size;
+    plan.arena_size += 64;
+  }
+  ArenaPlanCache imported_cache;
+  imported_cache.Insert(plan);
+  cache = std::make_shared<ArenaPlanCache>();
+  ASSERT_TRUE(cache->Deserialize(imported_cache.Serialize()));
+
+  SetGraph(&graph);
+  planner_->SetPlanCache(cache);
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(cache->num_hits(), 1);
+  size_t end = 0;
+  for (const auto& alloc : plan.allocs) {
+    EXPECT_EQ(GetOffset(alloc.tensor), alloc.offset);
+    end = std::max(end, alloc.offset + alloc.size);
+  }
+  size_t arena_size, arena_persist_size;
+  planner_->GetAllocInfo(&arena_size, &arena_persist_size);
+  EXPECT_EQ(arena_size, end);
+}
+
+TEST_F(ArenaPlannerTest, PlanCacheIsNotUsedForIncrementalPlanning) {
+  TestGraph graph = ComplexGraph();
+  SetGraph(&graph);
+  auto cache = std::make_shared<ArenaPlanCache>();
+  planner_->SetPlanCache(cache);
+  Execute(0, 3);
+  Execute(4, graph.nodes().size() - 1);
+  EXPECT_EQ(cache->size(), 0);
+  EXPECT_EQ(cache->num_hits() + cache->num_misses(), 0);
+}
+
 TEST_F(ArenaPlannerTest, SimpleProfilerTest) {
   gNumAlloc = 0;
   gNumDealloc = 0;
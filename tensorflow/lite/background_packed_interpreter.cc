@@ -0,0 +1,158 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/background_packed_interpreter.h"
+
+#include <fstream>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/logger.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+
+struct BackgroundPackedInterpreter::Server {
+  // The delegate must outlive the interpreter it is applied to, so it is
+  // destroyed last.
+  std::unique_ptr<TfLiteDelegate, void (*)(TfLiteDelegate*)> delegate{
+      nullptr, nullptr};
+  std::unique_ptr<Interpreter> interpreter;
+};
+
+BackgroundPackedInterpreter::BackgroundPackedInterpreter(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const Options& options)
+    : model_(model), op_resolver_(op_resolver), options_(options) {}
+
+std::unique_ptr<BackgroundPackedInterpreter>
+BackgroundPackedInterpreter::Create(const FlatBufferModel& model,
+                                    const OpResolver& op_resolver,
+                                    const Options& options) {
+  if (options.weight_cache_file_path.empty() || options.num_threads < -1) {
+    TFLITE_LOG(TFLITE_LOG_ERROR,
+               "Invalid background packed interpreter options.");
+    return nullptr;
+  }
+  std::unique_ptr<BackgroundPackedInterpreter> packed(
+      new BackgroundPackedInterpreter(model, op_resolver, options));
+  // A missing file is packed by the XNNPACK delegate, unless another process
+  // is already packing it, in which case the delegate packs the weights in
+  // memory. Either way, it takes a while.
+  const bool cache_file_exists =
+      std::ifstream(options.weight_cache_file_path).good();
+  packed->server_ = packed->CreateServer(/*use_xnnpack=*/cache_file_exists);
+  if (packed->server_ == nullptr) {
+    return nullptr;
+  }
+  packed->packed_ = cache_file_exists;
+  if (!cache_file_exists) {
+    packed->packing_ = true;
+    packed->packing_thread_ = std::thread([p = packed.get()]() { p->Pack(); });
+  }
+  return packed;
+}
+
+BackgroundPackedInterpreter::~BackgroundPackedInterpreter() {
+  if (packing_thread_.joinable()) {
+    packing_thread_.join();
+  }
+}
+
+std::shared_ptr<Interpreter> BackgroundPackedInterpreter::Get() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // The returned pointer keeps the whole server alive, so that a request
+  // running on the builtin interpreter is not affected by the swap.
+  return std::shared_ptr<Interpreter>(server_, server_->interpreter.get());
+}
+
+bool BackgroundPackedInterpreter::IsPacked() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return packed_;
+}
+
+bool BackgroundPackedInterpreter::IsPacking() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return packing_;
+}
+
+TfLiteStatus BackgroundPackedInterpreter::WaitUntilPacked() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  packing_done_.wait(lock, [this]() { return !packing_; });
+  return packed_ ? kTfLiteOk : kTfLiteError;
+}
+
+std::shared_ptr<BackgroundPackedInterpreter::Server>
+BackgroundPackedInterpreter::CreateServer(bool use_xnnpack) const {
+  auto server = std::make_shared<Server>();
+  InterpreterBuilder builder(model_, op_resolver_);
+  if (builder.SetNumThreads(options_.num_threads) != kTfLiteOk) {
+    return nullptr;
+  }
+  if (use_xnnpack) {
+    TfLiteXNNPackDelegateOptions xnnpack_options =
+        TfLiteXNNPackDelegateOptionsDefault();
+    xnnpack_options.num_threads = options_.num_threads;
+    xnnpack_options.weight_cache_file_path =
+        options_.weight_cache_file_path.c_str();
+    server->delegate = {TfLiteXNNPackDelegateCreate(&xnnpack_options),
+                        TfLiteXNNPackDelegateDelete};
+    if (server->delegate == nullptr) {
+      TFLITE_LOG(TFLITE_LOG_ERROR, "Failed to create XNNPACK delegate.");
+      return nullptr;
+    }
+    builder.AddDelegate(server->delegate.get());
+  }
+  if (builder(&server->interpreter) != kTfLiteOk ||
+      server->interpreter == nullptr) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "Failed to build interpreter.");
+    return nullptr;
+  }
+  if (server->interpreter->AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "Failed to allocate tensors.");
+    return nullptr;
+  }
+  return server;
+}
+
+void BackgroundPackedInterpreter::Pack() {
+  // XNNPACK packs the weights when the delegate prepares its runtimes, while
+  // the interpreter is built.
+  std::shared_ptr<Server> server = CreateServer(/*use_xnnpack=*/true);
+  if (server != nullptr) {
+    // The file is complete, so other processes can map it.
+    TfLiteXNNPackDelegateFinishWeightCacheBuild(server->delegate.get());
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (server != nullptr) {
+      server_.swap(server);
+      packed_ = true;
+    }
+    packing_ = false;
+  }
+  packing_done_.notify_all();
+  // Destroys the builtin interpreter unless a request still uses it.
+  server.reset();
+}
+
+}  // namespace tflite
@@ -0,0 +1,133 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+/// \file
+///
+/// An interpreter that packs the XNNPACK weight cache file in the background.
+#ifndef TENSORFLOW_LITE_BACKGROUND_PACKED_INTERPRETER_H_
+#define TENSORFLOW_LITE_BACKGROUND_PACKED_INTERPRETER_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+
+/// WARNING: Experimental interface, subject to change.
+///
+/// Serves a model with the XNNPACK delegate and a weight cache file, without
+/// waiting for the weights to be packed when the file does not exist yet.
+///
+/// If the weight cache file exists, the XNNPACK interpreter maps it and is
+/// used right away. Otherwise, the requests are served by an interpreter
+/// without delegate, whose builtin kernels read the weights of the model as
+/// they are, while the XNNPACK interpreter is built on a background thread,
+/// which packs the weights into the file. The XNNPACK interpreter then
+/// replaces the builtin one: `Get` returns it for the next requests, while the
+/// requests that are still running keep the builtin interpreter alive.
+///
+/// Example:
+///
+/// <pre><code>
+///   ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+///   BackgroundPackedInterpreter::Options options;
+///   options.weight_cache_file_path = "/tmp/model.xnnpack_cache";
+///   std::unique_ptr<BackgroundPackedInterpreter> packed =
+///       BackgroundPackedInterpreter::Create(*model, resolver, options);
+///
+///   // For each request:
+///   std::shared_ptr<Interpreter> interpreter = packed->Get();
+///   interpreter->typed_input_tensor<float>(0)[0] = x;
+///   interpreter->Invoke();
+/// </code></pre>
+///
+/// The interpreters are not thread-safe: requests that may run concurrently
+/// need one `BackgroundPackedInterpreter` each, or an external lock. The model
+/// and the op resolver must outlive the `BackgroundPackedInterpreter`, and the
+/// op resolver should not apply default delegates.
+class BackgroundPackedInterpreter {
+  struct Server;
+
+ public:
+  struct Options {
+    /// Path of the XNNPACK weight cache file. Required.
+    std::string weight_cache_file_path;
+    /// Number of threads used by each invocation.
+    int num_threads = 1;
+  };
+
+  /// Creates the interpreter serving the first requests, with allocated
+  /// tensors, and starts packing the weights if the weight cache file is
+  /// missing. Returns nullptr on error.
+  static std::unique_ptr<BackgroundPackedInterpreter> Create(
+      const FlatBufferModel& model, const OpResolver& op_resolver,
+      const Options& options);
+
+  /// Waits for the weights to be packed.
+  ~BackgroundPackedInterpreter();
+
+  BackgroundPackedInterpreter(const BackgroundPackedInterpreter&) = delete;
+  BackgroundPackedInterpreter& operator=(const BackgroundPackedInterpreter&) =
+      delete;
+
+  /// Returns the interpreter to run the next request with: the XNNPACK one
+  /// once the weights are packed, and the builtin one until then. Call it for
+  /// every request to switch to the XNNPACK interpreter as soon as possible.
+  std::shared_ptr<Interpreter> Get() const;
+
+  /// Whether `Get` returns the XNNPACK interpreter.
+  bool IsPacked() const;
+
+  /// Whether the weights are still being packed in the background.
+  bool IsPacking() const;
+
+  /// Blocks until the weights are packed. Returns an error if building the
+  /// XNNPACK interpreter failed, in which case `Get` keeps returning the
+  /// builtin interpreter.
+  TfLiteStatus WaitUntilPacked();
+
+ private:
+  BackgroundPackedInterpreter(const FlatBufferModel& model,
+                              const OpResolver& op_resolver,
+                              const Options& options);
+
+  // Builds an interpreter with allocated tensors, with the XNNPACK delegate if
+  // `use_xnnpack` is true. Returns nullptr on error.
+  std::shared_ptr<Server> CreateServer(bool use_xnnpack) const;
+
+  // Builds the XNNPACK interpreter and swaps it in. Runs on `packing_thread_`.
+  void Pack();
+
+  const FlatBufferModel& model_;
+  const OpResolver& op_resolver_;
+  const Options options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable packing_done_;
+  std::shared_ptr<Server> server_;
+  bool packed_ = false;
+  bool packing_ = false;
+  std::thread packing_thread_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_BACKGROUND_PACKED_INTERPRETER_H_
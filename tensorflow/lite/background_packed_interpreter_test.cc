@@ -0,0 +1,95 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/background_packed_interpreter.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace {
+
+// The model computes `3 * input` for a [1, 8, 8, 3] float input.
+constexpr int kNumElements = 1 * 8 * 8 * 3;
+
+class BackgroundPackedInterpreterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ =
+        FlatBufferModel::BuildFromFile("tensorflow/lite/testdata/add.bin");
+    ASSERT_NE(model_, nullptr);
+    options_.weight_cache_file_path =
+        ::testing::TempDir() + "/background_packed_interpreter.xnnpack_cache";
+    std::remove(options_.weight_cache_file_path.c_str());
+  }
+
+  void TearDown() override {
+    std::remove(options_.weight_cache_file_path.c_str());
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver_;
+  BackgroundPackedInterpreter::Options options_;
+};
+
+// Runs the model on `input` and checks the output.
+void InvokeAndCheck(Interpreter& interpreter, float input) {
+  float* input_data = interpreter.typed_input_tensor<float>(0);
+  for (int i = 0; i < kNumElements; ++i) {
+    input_data[i] = input + i;
+  }
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  const float* output_data = interpreter.typed_output_tensor<float>(0);
+  for (int i = 0; i < kNumElements; ++i) {
+    ASSERT_EQ(output_data[i], 3 * (input + i));
+  }
+}
+
+TEST_F(BackgroundPackedInterpreterTest, SwapsInPackedInterpreter) {
+  std::unique_ptr<BackgroundPackedInterpreter> packed =
+      BackgroundPackedInterpreter::Create(*model_, resolver_, options_);
+  ASSERT_NE(packed, nullptr);
+
+  // Requests are served while the weights are packed.
+  std::shared_ptr<Interpreter> builtin_interpreter = packed->Get();
+  ASSERT_NE(builtin_interpreter, nullptr);
+  InvokeAndCheck(*builtin_interpreter, 1.0f);
+
+  ASSERT_EQ(packed->WaitUntilPacked(), kTfLiteOk);
+  EXPECT_TRUE(packed->IsPacked());
+  EXPECT_FALSE(packed->IsPacking());
+  std::shared_ptr<Interpreter> xnnpack_interpreter = packed->Get();
+  ASSERT_NE(xnnpack_interpreter, nullptr);
+  EXPECT_NE(xnnpack_interpreter, builtin_interpreter);
+  InvokeAndCheck(*xnnpack_interpreter, 2.0f);
+
+  // The request that started before the swap still has its interpreter.
+  InvokeAndCheck(*builtin_interpreter, 3.0f);
+}
+
+TEST_F(BackgroundPackedInterpreterTest, RequiresWeightCacheFilePath) {
+  options_.weight_cache_file_path.clear();
+  EXPECT_EQ(BackgroundPackedInterpreter::Create(*model_, resolver_, options_),
+            nullptr);
+}
+
+}  // namespace
+}  // namespace tflite
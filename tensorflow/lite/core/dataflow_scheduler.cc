@@ -0,0 +1,187 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/dataflow_scheduler.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+namespace {
+
+// The CPU backend context of the current worker thread, if any.
+thread_local ExternalCpuBackendContext* thread_cpu_backend_context = nullptr;
+
+bool Overlaps(const std::vector<MemoryRange>& a,
+              const std::vector<MemoryRange>& b) {
+  for (const MemoryRange& x : a) {
+    for (const MemoryRange& y : b) {
+      if (x.begin < y.end && y.begin < x.end) return true;
+    }
+  }
+  return false;
+}
+
+// Whether `later` must run after `earlier`.
+bool DependsOn(const NodeMemoryAccess& later, const NodeMemoryAccess& earlier) {
+  if (later.exclusive || earlier.exclusive) return true;
+  if (later.serialization_key != nullptr &&
+      later.serialization_key == earlier.serialization_key) {
+    return true;
+  }
+  return Overlaps(earlier.writes, later.reads) ||
+         Overlaps(earlier.writes, later.writes) ||
+         Overlaps(earlier.reads, later.writes);
+}
+
+}  // namespace
+
+DataflowGraph BuildDataflowGraph(const std::vector<NodeMemoryAccess>& nodes) {
+  const int num_nodes = nodes.size();
+  DataflowGraph graph;
+  graph.successors.resize(num_nodes);
+  graph.num_predecessors.resize(num_nodes, 0);
+  // Number of nodes on the longest dependency chain ending at each node.
+  std::vector<int> path_length(num_nodes, 1);
+  for (int j = 0; j < num_nodes; ++j) {
+    for (int i = 0; i < j; ++i) {
+      if (DependsOn(nodes[j], nodes[i])) {
+        graph.successors[i].push_back(j);
+        ++graph.num_predecessors[j];
+        path_length[j] = std::max(path_length[j], path_length[i] + 1);
+      }
+    }
+    graph.critical_path_length =
+        std::max(graph.critical_path_length, path_length[j]);
+  }
+  return graph;
+}
+
+DataflowScheduler::DataflowScheduler(int num_threads) {
+  for (int i = 1; i < num_threads; ++i) {
+    cpu_backend_contexts_.push_back(
+        std::make_unique<ExternalCpuBackendContext>());
+  }
+  for (int i = 1; i < num_threads; ++i) {
+    workers_.emplace_back([this, i]() { WorkerLoop(i); });
+  }
+}
+
+DataflowScheduler::~DataflowScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  cond_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+TfLiteExternalContext* DataflowScheduler::GetThreadCpuBackendContext() {
+  return thread_cpu_backend_context;
+}
+
+bool DataflowScheduler::TryRun(const DataflowGraph& graph,
+                               const RunNodeFn& run_node, TfLiteStatus* status,
+                               int* failed_node_index) {
+  std::unique_lock<std::mutex> run_lock(run_mutex_, std::try_to_lock);
+  if (!run_lock.owns_lock()) {
+    return false;
+  }
+
+  Run run;
+  run.graph = &graph;
+  run.run_node = &run_node;
+  run.num_pending_predecessors = graph.num_predecessors;
+  // Ready nodes are taken from the back, so the roots are pushed in reverse
+  // to start them in execution plan order.
+  for (int i = graph.num_nodes() - 1; i >= 0; --i) {
+    if (graph.num_predecessors[i] == 0) run.ready_nodes.push_back(i);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  run_ = &run;
+  cond_.notify_all();
+  while (true) {
+    RunReadyNodes(/*thread_index=*/0, lock);
+    if (run.num_running_nodes == 0 &&
+        (run.status != kTfLiteOk ||
+         run.num_finished_nodes == graph.num_nodes())) {
+      break;
+    }
+    cond_.wait(lock, [&run]() {
+      return run.num_running_nodes == 0 ||
+             (run.status == kTfLiteOk && !run.ready_nodes.empty());
+    });
+  }
+  run_ = nullptr;
+  *status = run.status;
+  *failed_node_index = run.failed_node_index;
+  return true;
+}
+
+void DataflowScheduler::WorkerLoop(int thread_index) {
+  thread_cpu_backend_context = cpu_backend_contexts_[thread_index - 1].get();
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cond_.wait(lock, [this]() {
+      return shutdown_ || (run_ != nullptr && run_->status == kTfLiteOk &&
+                           !run_->ready_nodes.empty());
+    });
+    if (shutdown_) return;
+    RunReadyNodes(thread_index, lock);
+  }
+}
+
+void DataflowScheduler::RunReadyNodes(int thread_index,
+                                      std::unique_lock<std::mutex>& lock) {
+  // `run_` is not reset while nodes of the run are running.
+  Run* run = run_;
+  while (run->status == kTfLiteOk && !run->ready_nodes.empty()) {
+    const int node_index = run->ready_nodes.back();
+    run->ready_nodes.pop_back();
+    ++run->num_running_nodes;
+    // Other threads may take the remaining ready nodes.
+    if (!run->ready_nodes.empty()) cond_.notify_all();
+    lock.unlock();
+    const TfLiteStatus status = (*run->run_node)(node_index, thread_index);
+    lock.lock();
+    --run->num_running_nodes;
+    ++run->num_finished_nodes;
+    if (status != kTfLiteOk) {
+      if (run->status == kTfLiteOk) {
+        run->status = status;
+        run->failed_node_index = node_index;
+      }
+      cond_.notify_all();
+      continue;
+    }
+    for (int successor : run->graph->successors[node_index]) {
+      if (--run->num_pending_predecessors[successor] == 0) {
+        run->ready_nodes.push_back(successor);
+      }
+    }
+    if (run->num_running_nodes == 0 || run->ready_nodes.size() > 1) {
+      cond_.notify_all();
+    }
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,149 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_DATAFLOW_SCHEDULER_H_
+#define TENSORFLOW_LITE_CORE_DATAFLOW_SCHEDULER_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+
+// WARNING: This is an experimental API and subject to change.
+
+// A range of memory [begin, end) that a node reads or writes.
+struct MemoryRange {
+  uintptr_t begin = 0;
+  uintptr_t end = 0;
+};
+
+// The memory accessed by one node of an execution plan.
+struct NodeMemoryAccess {
+  std::vector<MemoryRange> reads;
+  std::vector<MemoryRange> writes;
+  // Whether the node must run alone, after all the nodes that precede it in
+  // the execution plan and before all the nodes that follow it. This is the
+  // case of nodes with side effects that are not visible in their tensors.
+  bool exclusive = false;
+  // Nodes with the same non-null key run in execution plan order, e.g. the
+  // nodes of one delegate.
+  const void* serialization_key = nullptr;
+};
+
+// The dependencies between the nodes of an execution plan. Node `j` depends on
+// an earlier node `i` if one writes memory that the other reads or writes.
+// Since these dependencies are derived from the memory the nodes actually
+// access, they cover both the data flow between nodes and the memory that
+// the arena planner reuses for tensors whose lifetimes do not overlap in
+// execution plan order. Any order that respects them produces the same
+// results as running the nodes sequentially.
+struct DataflowGraph {
+  // Nodes that depend on each node.
+  std::vector<std::vector<int>> successors;
+  // Number of nodes each node depends on.
+  std::vector<int> num_predecessors;
+  // Number of nodes on the longest dependency chain.
+  int critical_path_length = 0;
+
+  int num_nodes() const { return num_predecessors.size(); }
+
+  // Whether some nodes can run concurrently.
+  bool HasParallelism() const { return critical_path_length < num_nodes(); }
+};
+
+// Builds the dependency graph of the nodes of an execution plan, in execution
+// plan order.
+DataflowGraph BuildDataflowGraph(const std::vector<NodeMemoryAccess>& nodes);
+
+// Runs the nodes of a `DataflowGraph` on a fixed set of threads, starting each
+// node as soon as the nodes it depends on are done.
+//
+// The thread calling `TryRun` runs nodes too, so `num_threads - 1` worker
+// threads are created. Kernels get their `CpuBackendContext` from the
+// interpreter, whose ruy context is not thread-safe, so every worker thread
+// has its own `ExternalCpuBackendContext`, which `Subgraph` returns for
+// `kTfLiteCpuBackendContext` while the worker runs nodes.
+class DataflowScheduler {
+ public:
+  // Runs the node at `node_index` on thread `thread_index`, where 0 is the
+  // thread calling `TryRun`.
+  using RunNodeFn =
+      std::function<TfLiteStatus(int node_index, int thread_index)>;
+
+  explicit DataflowScheduler(int num_threads);
+  ~DataflowScheduler();
+
+  DataflowScheduler(const DataflowScheduler&) = delete;
+  DataflowScheduler& operator=(const DataflowScheduler&) = delete;
+
+  int num_threads() const { return workers_.size() + 1; }
+
+  // Runs all nodes of `graph`. After the first node that fails, no further
+  // node is started, and `status` and `failed_node_index` are set to its
+  // status and index once the running nodes are done.
+  //
+  // Returns false without running anything if the scheduler is already
+  // running a graph, e.g. when a node invokes another subgraph. The caller
+  // should run the nodes sequentially then.
+  bool TryRun(const DataflowGraph& graph, const RunNodeFn& run_node,
+              TfLiteStatus* status, int* failed_node_index);
+
+  // Returns the CPU backend context of the worker thread calling this
+  // function, or nullptr if it is not a worker thread of a scheduler.
+  static TfLiteExternalContext* GetThreadCpuBackendContext();
+
+ private:
+  struct Run {
+    const DataflowGraph* graph;
+    const RunNodeFn* run_node;
+    std::vector<int> num_pending_predecessors;
+    std::vector<int> ready_nodes;
+    int num_running_nodes = 0;
+    int num_finished_nodes = 0;
+    TfLiteStatus status = kTfLiteOk;
+    int failed_node_index = -1;
+  };
+
+  void WorkerLoop(int thread_index);
+
+  // Runs ready nodes of the current run until there is none. Must be called
+  // with `lock` held, which is released while nodes run.
+  void RunReadyNodes(int thread_index, std::unique_lock<std::mutex>& lock);
+
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      cpu_backend_contexts_;
+  std::vector<std::thread> workers_;
+
+  // Held for the duration of `TryRun`.
+  std::mutex run_mutex_;
+
+  std::mutex mutex_;
+  // Signaled when nodes become ready, when the last running node of a failed
+  // run finishes, when a run finishes, and on shutdown.
+  std::condition_variable cond_;
+  Run* run_ = nullptr;
+  bool shutdown_ = false;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_DATAFLOW_SCHEDULER_H_
@@ -0,0 +1,273 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/dataflow_scheduler.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Returns the range of bytes [begin, end) of a fake arena.
+MemoryRange Bytes(uintptr_t begin, uintptr_t end) {
+  return {0x1000 + begin, 0x1000 + end};
+}
+
+NodeMemoryAccess Access(std::vector<MemoryRange> reads,
+                        std::vector<MemoryRange> writes) {
+  NodeMemoryAccess access;
+  access.reads = std::move(reads);
+  access.writes = std::move(writes);
+  return access;
+}
+
+TEST(BuildDataflowGraphTest, IndependentBranches) {
+  // 0 -> {1, 2} -> 3, where 1 and 2 read the output of 0.
+  DataflowGraph graph = BuildDataflowGraph({
+      Access({}, {Bytes(0, 16)}),
+      Access({Bytes(0, 16)}, {Bytes(16, 32)}),
+      Access({Bytes(0, 16)}, {Bytes(32, 48)}),
+      Access({Bytes(16, 32), Bytes(32, 48)}, {Bytes(48, 64)}),
+  });
+  EXPECT_THAT(graph.successors[0], ElementsAre(1, 2));
+  EXPECT_THAT(graph.successors[1], ElementsAre(3));
+  EXPECT_THAT(graph.successors[2], ElementsAre(3));
+  EXPECT_THAT(graph.successors[3], IsEmpty());
+  EXPECT_THAT(graph.num_predecessors, ElementsAre(0, 1, 1, 2));
+  EXPECT_EQ(graph.critical_path_length, 3);
+  EXPECT_TRUE(graph.HasParallelism());
+}
+
+TEST(BuildDataflowGraphTest, ReusedMemoryOrdersNodes) {
+  // Node 2 writes memory that node 1 reads, e.g. because the arena planner
+  // reused the memory of the input of node 1 for the output of node 2.
+  DataflowGraph graph = BuildDataflowGraph({
+      Access({}, {Bytes(0, 16)}),
+      Access({Bytes(0, 16)}, {Bytes(16, 32)}),
+      Access({}, {Bytes(8, 24)}),
+  });
+  EXPECT_THAT(graph.successors[0], ElementsAre(1, 2));
+  EXPECT_THAT(graph.successors[1], ElementsAre(2));
+  EXPECT_EQ(graph.critical_path_length, 3);
+  EXPECT_FALSE(graph.HasParallelism());
+}
+
+TEST(BuildDataflowGraphTest, ConcurrentReadsAreIndependent) {
+  DataflowGraph graph = BuildDataflowGraph({
+      Access({Bytes(0, 16)}, {Bytes(16, 32)}),
+      Access({Bytes(0, 16)}, {Bytes(32, 48)}),
+  });
+  EXPECT_THAT(graph.num_predecessors, ElementsAre(0, 0));
+  EXPECT_EQ(graph.critical_path_length, 1);
+}
+
+TEST(BuildDataflowGraphTest, ExclusiveNodeIsABarrier) {
+  std::vector<NodeMemoryAccess> nodes = {
+      Access({}, {Bytes(0, 16)}),
+      Access({}, {}),
+      Access({}, {Bytes(16, 32)}),
+  };
+  nodes[1].exclusive = true;
+  DataflowGraph graph = BuildDataflowGraph(nodes);
+  EXPECT_THAT(graph.successors[0], ElementsAre(1));
+  EXPECT_THAT(graph.successors[1], ElementsAre(2));
+  EXPECT_FALSE(graph.HasParallelism());
+}
+
+TEST(BuildDataflowGraphTest, SerializationKeyOrdersNodes) {
+  int delegate = 0;
+  std::vector<NodeMemoryAccess> nodes = {
+      Access({}, {Bytes(0, 16)}),
+      Access({}, {Bytes(16, 32)}),
+      Access({}, {Bytes(32, 48)}),
+  };
+  nodes[0].serialization_key = &delegate;
+  nodes[2].serialization_key = &delegate;
+  DataflowGraph graph = BuildDataflowGraph(nodes);
+  EXPECT_THAT(graph.successors[0], ElementsAre(2));
+  EXPECT_THAT(graph.num_predecessors, ElementsAre(0, 0, 1));
+}
+
+// A graph of `num_branches` independent chains of `branch_length` nodes.
+DataflowGraph Branches(int num_branches, int branch_length) {
+  std::vector<NodeMemoryAccess> nodes;
+  for (int b = 0; b < num_branches; ++b) {
+    for (int i = 0; i < branch_length; ++i) {
+      const uintptr_t offset = (b * branch_length + i) * 16;
+      nodes.push_back(Access(
+          i == 0 ? std::vector<MemoryRange>{}
+                 : std::vector<MemoryRange>{Bytes(offset - 16, offset)},
+          {Bytes(offset, offset + 16)}));
+    }
+  }
+  return BuildDataflowGraph(nodes);
+}
+
+TEST(DataflowSchedulerTest, RunsNodesAfterTheirDependencies) {
+  DataflowGraph graph = Branches(/*num_branches=*/4, /*branch_length=*/8);
+  DataflowScheduler scheduler(/*num_threads=*/4);
+  EXPECT_EQ(scheduler.num_threads(), 4);
+  for (int run = 0; run < 10; ++run) {
+    std::mutex mutex;
+    std::vector<int> order;
+    TfLiteStatus status = kTfLiteError;
+    int failed_node_index = 0;
+    ASSERT_TRUE(scheduler.TryRun(
+        graph,
+        [&](int node_index, int) {
+          std::lock_guard<std::mutex> lock(mutex);
+          order.push_back(node_index);
+          return kTfLiteOk;
+        },
+        &status, &failed_node_index));
+    EXPECT_EQ(status, kTfLiteOk);
+    EXPECT_EQ(failed_node_index, -1);
+    ASSERT_EQ(order.size(), graph.num_nodes());
+    std::vector<int> position(graph.num_nodes());
+    for (int i = 0; i < order.size(); ++i) position[order[i]] = i;
+    for (int i = 0; i < graph.num_nodes(); ++i) {
+      for (int successor : graph.successors[i]) {
+        EXPECT_LT(position[i], position[successor]);
+      }
+    }
+  }
+}
+
+TEST(DataflowSchedulerTest, RunsIndependentNodesConcurrently) {
+  DataflowGraph graph = Branches(/*num_branches=*/2, /*branch_length=*/1);
+  DataflowScheduler scheduler(/*num_threads=*/2);
+  // Each node waits for the other one to start, which only succeeds if they
+  // run concurrently.
+  std::atomic<int> num_started(0);
+  std::atomic<bool> saw_other_node(true);
+  std::vector<int> threads(2, -1);
+  TfLiteStatus status;
+  int failed_node_index;
+  ASSERT_TRUE(scheduler.TryRun(
+      graph,
+      [&](int node_index, int thread_index) {
+        threads[node_index] = thread_index;
+        ++num_started;
+        const auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (num_started < 2) {
+          if (std::chrono::steady_clock::now() > deadline) {
+            saw_other_node = false;
+            break;
+          }
+          std::this_thread::yield();
+        }
+        return kTfLiteOk;
+      },
+      &status, &failed_node_index));
+  EXPECT_EQ(status, kTfLiteOk);
+  EXPECT_TRUE(saw_other_node);
+  EXPECT_NE(threads[0], threads[1]);
+}
+
+TEST(DataflowSchedulerTest, WorkersHaveTheirOwnCpuBackendContext) {
+  EXPECT_EQ(DataflowScheduler::GetThreadCpuBackendContext(), nullptr);
+  DataflowGraph graph = Branches(/*num_branches=*/8, /*branch_length=*/1);
+  DataflowScheduler scheduler(/*num_threads=*/3);
+  std::mutex mutex;
+  std::vector<TfLiteExternalContext*> contexts(3, nullptr);
+  TfLiteStatus status;
+  int failed_node_index;
+  ASSERT_TRUE(scheduler.TryRun(
+      graph,
+      [&](int, int thread_index) {
+        TfLiteExternalContext* context =
+            DataflowScheduler::GetThreadCpuBackendContext();
+        std::lock_guard<std::mutex> lock(mutex);
+        contexts[thread_index] = context;
+        return kTfLiteOk;
+      },
+      &status, &failed_node_index));
+  EXPECT_EQ(contexts[0], nullptr);
+  for (TfLiteExternalContext* context : contexts) {
+    if (context != nullptr) {
+      EXPECT_EQ(context->type, kTfLiteCpuBackendContext);
+    }
+  }
+  if (contexts[1] != nullptr && contexts[2] != nullptr) {
+    EXPECT_NE(contexts[1], contexts[2]);
+  }
+}
+
+TEST(DataflowSchedulerTest, StopsAfterFailure) {
+  DataflowGraph graph = Branches(/*num_branches=*/1, /*branch_length=*/4);
+  DataflowScheduler scheduler(/*num_threads=*/2);
+  std::vector<int> order;
+  TfLiteStatus status;
+  int failed_node_index;
+  ASSERT_TRUE(scheduler.TryRun(
+      graph,
+      [&](int node_index, int) {
+        order.push_back(node_index);
+        return node_index == 1 ? kTfLiteError : kTfLiteOk;
+      },
+      &status, &failed_node_index));
+  EXPECT_EQ(status, kTfLiteError);
+  EXPECT_EQ(failed_node_index, 1);
+  EXPECT_THAT(order, ElementsAre(0, 1));
+
+  // The scheduler can run again after a failure.
+  order.clear();
+  ASSERT_TRUE(scheduler.TryRun(
+      graph,
+      [&](int node_index, int) {
+        order.push_back(node_index);
+        return kTfLiteOk;
+      },
+      &status, &failed_node_index));
+  EXPECT_EQ(status, kTfLiteOk);
+  EXPECT_THAT(order, ElementsAre(0, 1, 2, 3));
+}
+
+TEST(DataflowSchedulerTest, NestedRunIsRejected) {
+  DataflowGraph graph = Branches(/*num_branches=*/1, /*branch_length=*/1);
+  DataflowScheduler scheduler(/*num_threads=*/2);
+  bool nested_run = true;
+  TfLiteStatus status;
+  int failed_node_index;
+  ASSERT_TRUE(scheduler.TryRun(
+      graph,
+      [&](int, int) {
+        TfLiteStatus nested_status;
+        int nested_failed_node_index;
+        nested_run = scheduler.TryRun(
+            graph, [](int, int) { return kTfLiteOk; }, &nested_status,
+            &nested_failed_node_index);
+        return kTfLiteOk;
+      },
+      &status, &failed_node_index));
+  EXPECT_EQ(status, kTfLiteOk);
+  EXPECT_FALSE(nested_run);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/dataflow_scheduler.h"
 #include "tensorflow/lite/core/signature_runner.h"
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
@@ -497,9 +498,20 @@ TfLiteStatus Interpreter::ApplyOptionsImpl(InterpreterOptions* options) {
   }
   options_ = std::make_unique<InterpreterOptions>(*options);
 
+  // The scheduler of parallel node execution is shared by all subgraphs.
+  const int num_dataflow_threads = options_->GetParallelNodeExecutionThreads();
+  if (num_dataflow_threads < 2) {
+    dataflow_scheduler_.reset();
+  } else if (dataflow_scheduler_ == nullptr ||
+             dataflow_scheduler_->num_threads() != num_dataflow_threads) {
+    dataflow_scheduler_ =
+        std::make_unique<DataflowScheduler>(num_dataflow_threads);
+  }
+
   // Set InterpreterOptions object to SubGraph.
   for (auto& subgraph : subgraphs_) {
     subgraph->SetOptions(options_.get());
+    subgraph->SetDataflowScheduler(dataflow_scheduler_.get());
   }
   return kTfLiteOk;
 }
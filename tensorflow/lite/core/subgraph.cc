@@ -24,6 +24,7 @@ limitations under the License.
 #include <cstring>
 #include <iterator>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <string>
 #include <unordered_set>
 #include <utility>
@@ -40,6 +41,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/dataflow_scheduler.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/graph_info.h"
@@ -193,6 +195,26 @@ TfLiteStatus VerifyCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+// Whether the op may have side effects that are not visible in the tensors of
+// its node, so that it cannot run concurrently with other nodes. Control flow
+// ops invoke other subgraphs, and custom ops may share state through
+// resources.
+bool HasHiddenSideEffects(const TfLiteRegistration& registration) {
+  switch (registration.builtin_code) {
+    case kTfLiteBuiltinCustom:
+    case kTfLiteBuiltinIf:
+    case kTfLiteBuiltinWhile:
+    case kTfLiteBuiltinCallOnce:
+    case kTfLiteBuiltinStablehloCase:
+    case kTfLiteBuiltinStablehloComposite:
+    case kTfLiteBuiltinStablehloReduceWindow:
+    case kTfLiteBuiltinStablehloScatter:
+      return true;
+    default:
+      return false;
+  }
+}
+
 }  // namespace
 
 // A trivial implementation of GraphInfo around the Interpreter.
@@ -618,6 +640,14 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  // Worker threads of a dataflow scheduler run nodes concurrently with the
+  // thread calling Invoke(), so they use their own CPU backend context.
+  if (type == kTfLiteCpuBackendContext) {
+    if (TfLiteExternalContext* context =
+            DataflowScheduler::GetThreadCpuBackendContext()) {
+      return context;
+    }
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -1561,9 +1591,13 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
-    memory_planner_ = std::make_unique<ArenaPlanner>(
+    auto arena_planner = std::make_unique<ArenaPlanner>(
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
         kDefaultTensorAlignment, subgraph_index_);
+    if (options_ != nullptr) {
+      arena_planner->SetPlanCache(options_->GetArenaPlanCache());
+    }
+    memory_planner_ = std::move(arena_planner);
 #endif
     memory_planner_->PlanAllocations();
   }
@@ -1642,6 +1676,22 @@ TfLiteStatus Subgraph::InvokeImpl() {
       tflite::OnTfLiteSubgraphInvoke(name_.c_str(), subgraph_index_);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
 
+  // Independent nodes run concurrently once all nodes are prepared and the
+  // dataflow graph was built from their final tensor allocations. Profilers
+  // are not thread-safe, so profiled invocations run sequentially.
+  if (dataflow_scheduler_ != nullptr && profiler_ == nullptr &&
+      next_execution_plan_index_to_prepare_ == execution_plan_.size() &&
+      dataflow_graph_ != nullptr && IsDataflowGraphUpToDate()) {
+    bool invoked = false;
+    status = InvokeWithDataflowScheduler(&invoked);
+    if (invoked) {
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+      tflite::OnTfLiteSubgraphInvokeEnd(trace_subgraph);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+      return status;
+    }
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1757,12 +1807,148 @@ TfLiteStatus Subgraph::InvokeImpl() {
     tflite::OnTfLiteOpInvokeEnd(trace_op);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
   }
+  // The first invocation after the tensors are allocated runs sequentially,
+  // which also lets kernels lazily initialize shared state, such as thread
+  // pools, before they run concurrently.
+  if (dataflow_scheduler_ != nullptr && !IsDataflowGraphUpToDate()) {
+    UpdateDataflowGraph();
+  }
 #ifdef TF_LITE_TENSORFLOW_PROFILER
   tflite::OnTfLiteSubgraphInvokeEnd(trace_subgraph);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
   return status;
 }
 
+Subgraph::DataflowTensorState Subgraph::GetDataflowTensorState(
+    const TfLiteTensor& tensor) {
+  // The memory of dynamic tensors may move on every invocation, but these
+  // tensors disable the dataflow graph anyway.
+  if (tensor.allocation_type == kTfLiteDynamic) {
+    return {nullptr, 0, kTfLiteDynamic};
+  }
+  return {tensor.data.raw, tensor.bytes, tensor.allocation_type};
+}
+
+bool Subgraph::IsDataflowGraphUpToDate() const {
+  if (execution_plan_ != dataflow_graph_execution_plan_ ||
+      tensors_.size() != dataflow_graph_tensors_.size()) {
+    return false;
+  }
+  for (int i = 0; i < tensors_.size(); ++i) {
+    const DataflowTensorState state = GetDataflowTensorState(tensors_[i]);
+    const DataflowTensorState& graph_state = dataflow_graph_tensors_[i];
+    if (state.data != graph_state.data || state.bytes != graph_state.bytes ||
+        state.allocation_type != graph_state.allocation_type) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Subgraph::UpdateDataflowGraph() {
+  dataflow_graph_.reset();
+  dataflow_graph_execution_plan_ = execution_plan_;
+  dataflow_graph_tensors_.clear();
+  dataflow_graph_tensors_.reserve(tensors_.size());
+  for (const TfLiteTensor& tensor : tensors_) {
+    dataflow_graph_tensors_.push_back(GetDataflowTensorState(tensor));
+  }
+
+  std::vector<NodeMemoryAccess> nodes(execution_plan_.size());
+  for (int i = 0; i < execution_plan_.size(); ++i) {
+    const auto& node_and_registration =
+        nodes_and_registration_[execution_plan_[i]];
+    const TfLiteNode& node = node_and_registration.first;
+    NodeMemoryAccess& access = nodes[i];
+    access.exclusive = HasHiddenSideEffects(node_and_registration.second);
+    access.serialization_key = node.delegate;
+
+    // Records the memory of `tensor_indices`. Returns false if a tensor may
+    // still move or is not in CPU memory.
+    auto add_tensors = [&](const TfLiteIntArray* tensor_indices,
+                           bool written) {
+      if (tensor_indices == nullptr) return true;
+      for (int tensor_index : TfLiteIntArrayView(tensor_indices)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        const TfLiteTensor& tensor = tensors_[tensor_index];
+        if (tensor.allocation_type == kTfLiteDynamic ||
+            tensor.delegate != nullptr) {
+          return false;
+        }
+        if (tensor.type == kTfLiteResource || tensor.type == kTfLiteVariant) {
+          access.exclusive = true;
+        }
+        if (tensor.bytes == 0 || (!written && !tensor.is_variable &&
+                                  tensor.allocation_type == kTfLiteMmapRo)) {
+          continue;
+        }
+        if (tensor.data.raw == nullptr) return false;
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(tensor.data.raw);
+        // Kernels may update variable tensors in place.
+        (written || tensor.is_variable ? access.writes : access.reads)
+            .push_back({begin, begin + tensor.bytes});
+      }
+      return true;
+    };
+    if (!add_tensors(node.inputs, /*written=*/false) ||
+        !add_tensors(node.outputs, /*written=*/true) ||
+        !add_tensors(node.intermediates, /*written=*/true) ||
+        !add_tensors(node.temporaries, /*written=*/true)) {
+      return;
+    }
+  }
+
+  DataflowGraph graph = BuildDataflowGraph(nodes);
+  if (graph.HasParallelism()) {
+    dataflow_graph_ = std::make_unique<DataflowGraph>(std::move(graph));
+  }
+}
+
+TfLiteStatus Subgraph::InvokeWithDataflowScheduler(bool* invoked) {
+  // Kernels must not add tensors while other nodes are running, so the
+  // headroom is reserved once for all nodes.
+  EnsureTensorsVectorCapacity();
+
+  // The cancellation function of the client may not be thread-safe.
+  std::mutex cancellation_mutex;
+  std::atomic<TfLiteStatus> cancellation_status(kTfLiteOk);
+  auto run_node = [&](int execution_plan_index, int) -> TfLiteStatus {
+    if (check_cancelled_func_ != nullptr) {
+      std::lock_guard<std::mutex> lock(cancellation_mutex);
+      if (check_cancelled_func_(cancellation_data_)) {
+        cancellation_status = kTfLiteError;
+        return kTfLiteError;
+      }
+    }
+    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+      cancellation_status = kTfLiteCancelled;
+      return kTfLiteCancelled;
+    }
+    auto& node_and_registration =
+        nodes_and_registration_[execution_plan_[execution_plan_index]];
+    return OpInvoke(node_and_registration.second,
+                    &node_and_registration.first);
+  };
+
+  TfLiteStatus status = kTfLiteOk;
+  int failed_execution_plan_index = -1;
+  *invoked = dataflow_scheduler_->TryRun(*dataflow_graph_, run_node, &status,
+                                         &failed_execution_plan_index);
+  if (!*invoked || status == kTfLiteOk) {
+    return kTfLiteOk;
+  }
+  if (cancellation_status != kTfLiteOk) {
+    ReportError("Client requested cancel during Invoke()");
+    return cancellation_status;
+  }
+  const int node_index = execution_plan_[failed_execution_plan_index];
+  const auto& node_and_registration = nodes_and_registration_[node_index];
+  auto err = ReportOpError(&context_, node_and_registration.first,
+                           node_and_registration.second, node_index,
+                           "failed to invoke");
+  return status == kTfLiteCancelled ? status : err;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/dataflow_scheduler.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
@@ -453,6 +454,15 @@ class Subgraph {
   // WARNING: This is an experimental API and subject to change.
   const InterpreterOptions* GetOptions() const { return options_; }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Runs independent nodes concurrently on the threads of `scheduler`, which
+  // is owned by the Interpreter. nullptr runs all nodes sequentially.
+  void SetDataflowScheduler(DataflowScheduler* scheduler) {
+    dataflow_scheduler_ = scheduler;
+    dataflow_graph_.reset();
+    dataflow_graph_tensors_.clear();
+  }
+
   // WARNING: This is an experimental API and subject to change.
   // True if all intermediates tensors should be preserved for debugging.
   bool ShouldPreserveAllTensors() const {
@@ -948,6 +958,21 @@ class Subgraph {
   // tensors if configured.
   void MaybeReleaseDynamicTensors(const TfLiteNode& node, size_t node_index);
 
+  // Whether the last dataflow graph was built from the current execution plan
+  // and tensor allocations.
+  bool IsDataflowGraphUpToDate() const;
+
+  // Rebuilds the dataflow graph of the execution plan from the memory each
+  // node accesses, if it is not up to date. The graph is only kept if some
+  // nodes can run concurrently and all tensors have their final allocation,
+  // i.e. there are no dynamic tensors and no delegate buffer handles.
+  void UpdateDataflowGraph();
+
+  // Runs the execution plan on the dataflow scheduler. Sets `invoked` to false
+  // without running anything if the scheduler is busy, e.g. when this
+  // subgraph is invoked by a control flow op of another subgraph.
+  TfLiteStatus InvokeWithDataflowScheduler(bool* invoked);
+
   // Set the buffer handle to a tensor.
   // The method is used to implement Interpreter::SetBufferHandle and
   // SignatureRunner::SetInputBufferHandle/SetOutputBufferHandle APIs.
@@ -1157,6 +1182,26 @@ class Subgraph {
   // `InterpreterOptions` object which is being used and owned by Interpreter.
   InterpreterOptions* options_;
 
+  // Runs independent nodes concurrently; owned by the Interpreter. nullptr if
+  // parallel node execution is disabled.
+  DataflowScheduler* dataflow_scheduler_ = nullptr;
+
+  // Dependencies between the nodes of `execution_plan_`, indexed by execution
+  // plan index. nullptr if the nodes must run sequentially.
+  std::unique_ptr<DataflowGraph> dataflow_graph_;
+
+  // The state of the tensors that `dataflow_graph_` was built from. The graph
+  // is rebuilt when the memory of a tensor moves, e.g. after
+  // `AllocateTensors`.
+  struct DataflowTensorState {
+    const char* data;
+    size_t bytes;
+    TfLiteAllocationType allocation_type;
+  };
+  static DataflowTensorState GetDataflowTensorState(const TfLiteTensor& tensor);
+  std::vector<DataflowTensorState> dataflow_graph_tensors_;
+  std::vector<int> dataflow_graph_execution_plan_;
+
   // Control edges (i.e., dependencies between nodes in addition to their data
   // dependencies); can be nullptr. Will be initialized from metadata associated
   // with the owning interpreter; the pointee is owned by the owning
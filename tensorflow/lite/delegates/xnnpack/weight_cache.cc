@@ -21,12 +21,14 @@ limitations under the License.
 #include <io.h>
 #define F_OK 0
 #else
+#include <sys/file.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #endif
 
 #include <algorithm>
 #include <cerrno>  // IWYU pragma: keep
+#include <chrono>  // NOLINT(build/c++11)
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
@@ -34,8 +36,10 @@ limitations under the License.
 #include <cstring>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "xnnpack.h"  // from @XNNPACK
 #include "flatbuffers/flatbuffer_builder.h"  // from @flatbuffers
@@ -127,6 +131,90 @@ bool FileExists(const char* path) {
   return access(path, F_OK) != -1;
 }
 
+// Creates a file to write a new version of the file at `path` to and sets
+// `temporary_path` to its path.
+//
+// The file is created in the same directory so that it can replace `path`
+// with an atomic rename. On Windows, where a rename cannot replace an existing
+// file, this opens `path` and clears `temporary_path`.
+FileDescriptor CreateTemporaryFile(const std::string& path,
+                                   std::string& temporary_path) {
+#if defined(_MSC_VER)
+  temporary_path.clear();
+  return FileDescriptor::Open(path.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+#else
+  temporary_path = path + ".XXXXXX";
+  FileDescriptor fd(mkstemp(temporary_path.data()));
+  if (!fd.IsValid()) {
+    temporary_path.clear();
+    return fd;
+  }
+  // `mkstemp` makes the file only readable by its owner.
+  fchmod(fd.Value(), 0644);
+  return fd;
+#endif
+}
+
+// Number of attempts to take the lock of a cache file, and the delay between
+// them. The lock is held briefly by processes that load the file, and for the
+// whole build by the process that builds it.
+constexpr int kCacheFileLockAttempts = 20;
+constexpr std::chrono::milliseconds kCacheFileLockRetryDelay(5);
+
+// Takes an exclusive advisory lock on `<path>.lock`, retrying for a short
+// while if another process holds it.
+//
+// Returns false if another process still holds the lock. Returns true without
+// locking if locking isn't supported, e.g. when the directory is read only.
+bool LockCacheFile(const std::string& path, FileDescriptor& lock) {
+#if defined(_MSC_VER)
+  return true;
+#else
+  const std::string lock_path = path + ".lock";
+  for (int attempt = 0; attempt < kCacheFileLockAttempts; ++attempt) {
+    if (attempt > 0) {
+      std::this_thread::sleep_for(kCacheFileLockRetryDelay);
+    }
+    lock = FileDescriptor::Open(lock_path.c_str(), O_CREAT | O_RDWR, 0644);
+    if (!lock.IsValid()) {
+      return true;
+    }
+    if (flock(lock.Value(), LOCK_EX | LOCK_NB) == -1) {
+      const int error = errno;
+      lock.Close();
+      if (error != EWOULDBLOCK) {
+        return true;
+      }
+      continue;
+    }
+    // The previous holder may have removed the lock file between our open and
+    // flock calls, in which case we locked a file other processes can't see.
+    struct stat locked_file;
+    struct stat current_file;
+    if (fstat(lock.Value(), &locked_file) == 0 &&
+        stat(lock_path.c_str(), &current_file) == 0 &&
+        locked_file.st_dev == current_file.st_dev &&
+        locked_file.st_ino == current_file.st_ino) {
+      return true;
+    }
+    lock.Close();
+  }
+  return false;
+#endif
+}
+
+// Removes `<path>.lock` and releases the lock taken by `LockCacheFile`, if
+// any. The file is removed while the lock is held so that `LockCacheFile`
+// can detect it.
+void UnlockCacheFile(const std::string& path, FileDescriptor& lock) {
+#if !defined(_MSC_VER)
+  if (lock.IsValid()) {
+    unlink((path + ".lock").c_str());
+  }
+#endif
+  lock.Close();
+}
+
 }  // namespace
 
 void swap(MMapHandle& a, MMapHandle& b) {
@@ -227,10 +315,16 @@ WeightCacheBuilder::WeightCacheBuilder(WeightCacheBuilder&& other)
       XNN_MOVE_CONSTRUCT_MEMBER(build_segment_start_),
       XNN_MOVE_CONSTRUCT_MEMBER(first_write_done_),
       XNN_MOVE_CONSTRUCT_MEMBER(fd_),
-      XNN_MOVE_CONSTRUCT_MEMBER(file_path_) {}
+      XNN_MOVE_CONSTRUCT_MEMBER(file_path_),
+      XNN_MOVE_CONSTRUCT_MEMBER(temporary_path_),
+      XNN_MOVE_CONSTRUCT_MEMBER(published_),
+      XNN_MOVE_CONSTRUCT_MEMBER(last_build_step_copied_file_) {
+  other.temporary_path_.clear();
+}
 #undef XNN_MOVE_CONSTRUCT_MEMBER
 
 WeightCacheBuilder& WeightCacheBuilder::operator=(WeightCacheBuilder&& other) {
+  RemoveTemporaryFile();
 #define XNN_MOVE_MEMBER(x) x = std::move(other.x)
   XNN_MOVE_MEMBER(data_);
   XNN_MOVE_MEMBER(schema_);
@@ -240,22 +334,36 @@ WeightCacheBuilder& WeightCacheBuilder::operator=(WeightCacheBuilder&& other) {
   XNN_MOVE_MEMBER(first_write_done_);
   XNN_MOVE_MEMBER(fd_);
   XNN_MOVE_MEMBER(file_path_);
+  XNN_MOVE_MEMBER(temporary_path_);
+  XNN_MOVE_MEMBER(published_);
+  XNN_MOVE_MEMBER(last_build_step_copied_file_);
 #undef XNN_MOVE_MEMBER
+  other.temporary_path_.clear();
   return *this;
 }
 
+WeightCacheBuilder::~WeightCacheBuilder() { RemoveTemporaryFile(); }
+
+void WeightCacheBuilder::RemoveTemporaryFile() {
+  if (!temporary_path_.empty()) {
+    unlink(temporary_path_.c_str());
+    temporary_path_.clear();
+  }
+}
+
 bool WeightCacheBuilder::Start(const char* path) {
   XNNPACK_RETURN_CHECK(!IsStarted());
   file_path_ = path;
+  XNNPACK_RETURN_CHECK(!file_path_.empty(), "empty cache file path.");
 
   if (IsInMemoryCachePath(file_path_)) {
     fd_ = CreateInMemoryFileDescriptor("XNNPack in-memory weight cache");
   } else {
-    fd_ = FileDescriptor::Open(file_path_.c_str(), O_CREAT | O_TRUNC | O_RDWR,
-                               0644);
+    fd_ = CreateTemporaryFile(file_path_, temporary_path_);
   }
   XNNPACK_RETURN_CHECK(fd_.IsValid(), "could not open file ('%s'): %s.",
                        file_path_.c_str(), strerror(errno));
+  published_ = false;
 
   // Write data in the header, this will be overwritten in the `Finalize` call.
   // We explicitly set the header as invalid. If any error happens during
@@ -274,6 +382,12 @@ bool WeightCacheBuilder::Start(const char* path) {
 bool WeightCacheBuilder::StartBuildStep() {
   XNNPACK_RETURN_CHECK(IsStarted());
 
+  // Other processes may have mapped the published file.
+  last_build_step_copied_file_ = published_;
+  if (published_) {
+    XNNPACK_RETURN_CHECK(CopyPublishedFile());
+  }
+
   // Reload flatbuffer data.
   XNNPackCacheHeader header;
   fd_.SetPos(0);
@@ -345,7 +459,7 @@ bool WeightCacheBuilder::StopBuildStep() {
   is_build_step_ = false;
   if (fd_.GetPos() == build_segment_start_ && first_write_done_) {
     // Nothing was written to the file, we can exit early.
-    return true;
+    return Publish();
   }
 
   flatbuffers::FlatBufferBuilder builder;
@@ -387,12 +501,57 @@ bool WeightCacheBuilder::StopBuildStep() {
   XNNPACK_RETURN_CHECK(fd_.Write(&header, sizeof(header)),
                        "cannot write cache header to %s.", file_path_.c_str());
 
+  XNNPACK_RETURN_CHECK(Publish());
+
   TFLITE_LOG_PROD(tflite::TFLITE_LOG_VERBOSE,
                   "XNNPack weight cache: written to '%s'.", file_path_.c_str());
   first_write_done_ = true;
   return true;
 }
 
+bool WeightCacheBuilder::Publish() {
+  if (temporary_path_.empty()) {
+    return true;
+  }
+  XNNPACK_RETURN_CHECK(rename(temporary_path_.c_str(), file_path_.c_str()) == 0,
+                       "could not move '%s' to '%s': %s.",
+                       temporary_path_.c_str(), file_path_.c_str(),
+                       strerror(errno));
+  temporary_path_.clear();
+  published_ = true;
+  return true;
+}
+
+bool WeightCacheBuilder::CopyPublishedFile() {
+  std::string temporary_path;
+  FileDescriptor copy = CreateTemporaryFile(file_path_, temporary_path);
+  XNNPACK_RETURN_CHECK(copy.IsValid(), "could not copy '%s': %s.",
+                       file_path_.c_str(), strerror(errno));
+  ScopeGuard remove_on_fail([&] { unlink(temporary_path.c_str()); });
+
+  XNNPACK_RETURN_CHECK(fd_.SetPos(0) != -1,
+                       "could not move in the file to copy it: %s.",
+                       strerror(errno));
+  std::vector<char> buffer(1 << 20);
+  while (true) {
+    const auto bytes = read(fd_.Value(), buffer.data(), buffer.size());
+    XNNPACK_RETURN_CHECK(bytes != -1, "could not read '%s': %s.",
+                         file_path_.c_str(), strerror(errno));
+    if (bytes == 0) {
+      break;
+    }
+    XNNPACK_RETURN_CHECK(copy.Write(buffer.data(), bytes),
+                         "could not write '%s': %s.", temporary_path.c_str(),
+                         strerror(errno));
+  }
+
+  remove_on_fail.Deactivate();
+  fd_ = std::move(copy);
+  temporary_path_ = std::move(temporary_path);
+  published_ = false;
+  return true;
+}
+
 MMapWeightCacheProvider::MMapWeightCacheProvider(
     MMapWeightCacheProvider&& other) {
   *this = std::move(other);
@@ -411,6 +570,7 @@ MMapWeightCacheProvider& MMapWeightCacheProvider::operator=(
   swap(mmap_handles_, other.mmap_handles_);
   swap(mmap_buffer_base_offset_, other.mmap_buffer_base_offset_);
   swap(builder_, other.builder_);
+  swap(build_lock_, other.build_lock_);
   return *this;
 }
 
@@ -426,18 +586,43 @@ void MMapWeightCacheProvider::SetFilePath(const char* path) {
 }
 
 bool MMapWeightCacheProvider::LoadOrStartBuild(const char* path) {
-  if (!IsInMemoryCachePath(path) && Load(path)) {
-    TFLITE_LOG_PROD(tflite::TFLITE_LOG_VERBOSE,
-                    "XNNPack weight cache loaded from '%s'.", path);
-    return true;
-  } else if (StartBuild(path)) {
+  if (!IsInMemoryCachePath(path)) {
+    // The lock is held while checking the file and, if this builds it, until
+    // `FinishBuild`. It can only stay taken while another process builds.
+    if (!LockCacheFile(path, build_lock_)) {
+      if (!InMemoryFileDescriptorAvailable()) {
+        TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                        "XNNPack weight cache: '%s' is being built by another "
+                        "process.",
+                        path);
+        return false;
+      }
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_INFO,
+                      "XNNPack weight cache: '%s' is being built by another "
+                      "process, using an in-memory cache instead.",
+                      path);
+      return StartBuild(kInMemoryCachePath);
+    }
+    if (FileExists(path) && Load(path)) {
+      UnlockCacheFile(path, build_lock_);
+      TFLITE_LOG_PROD(tflite::TFLITE_LOG_VERBOSE,
+                      "XNNPack weight cache loaded from '%s'.", path);
+      return true;
+    }
+  }
+  if (StartBuild(path)) {
     TFLITE_LOG_PROD(tflite::TFLITE_LOG_VERBOSE,
                     "XNNPack weight cache build for '%s' started.", path);
     return true;
   }
+  UnlockCacheFile(path, build_lock_);
   return false;
 }
 
+void MMapWeightCacheProvider::FinishBuild() {
+  UnlockCacheFile(file_path_, build_lock_);
+}
+
 bool MMapWeightCacheProvider::StartBuild(const char* path) {
   SetFilePath(path);
   building_run_ = builder_.Start(path);
@@ -551,11 +736,13 @@ bool MMapWeightCacheProvider::LoadLastBuildStep() {
 
   // Map last data segment:
   // - either resize the last mmap handle;
-  // - or add a new mapping handle.
+  // - or add a new mapping handle, which is needed when the segment was
+  //   written to a copy of the file mapped by the last handle.
   {
     MMapHandle& last_mmap_handle = mmap_handles_.back();
     const int last_mmap_size = last_mmap_handle.size();
-    if (!last_mmap_handle.Resize(last_mmap_size +
+    if (builder_.LastBuildStepCopiedFile() ||
+        !last_mmap_handle.Resize(last_mmap_size +
                                  builder_.LastBuildStepSize())) {
       mmap_handles_.emplace_back();
       if (temporary_file_descriptor_.IsValid()) {
@@ -686,6 +873,7 @@ void MMapWeightCacheProvider::Release() {
   mmap_handles_.clear();
   mmap_buffer_base_offset_ = 0;
   builder_ = WeightCacheBuilder();
+  UnlockCacheFile(file_path_, build_lock_);
 }
 
 size_t MMapWeightCacheProvider::look_up(
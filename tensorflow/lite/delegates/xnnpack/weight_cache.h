@@ -168,10 +168,15 @@ class MMapHandle {
 //
 // WARNING: the interface in this file is still under experimentation and WILL
 // CHANGE. Do not rely on it.
+//
+// Unless it is in memory, the cache is written to a temporary file next to the
+// cache file path, which then replaces the cache file when a build step is
+// done. Other processes mapping the cache file only ever see complete files:
+// a new build step copies the last published file and writes to that copy.
 class WeightCacheBuilder {
  public:
   WeightCacheBuilder() = default;
-  ~WeightCacheBuilder() = default;
+  ~WeightCacheBuilder();
 
   // Non-copyable.
   WeightCacheBuilder(const WeightCacheBuilder&) = delete;
@@ -215,7 +220,8 @@ class WeightCacheBuilder {
   BufferLocation Append(PackIdentifier pack_id, const void* data,
                         uint64_t size);
 
-  // Writes the flatbuffer to disk.
+  // Writes the flatbuffer to disk and publishes the file at the path given to
+  // `Start`.
   [[nodiscard /*Writing the weight cache can fail.*/]]
   bool StopBuildStep();
 
@@ -235,6 +241,13 @@ class WeightCacheBuilder {
     return build_segment_size_;
   }
 
+  // Returns true if the last build step was written to a copy of the file
+  // published by the previous one.
+  [[nodiscard]]
+  bool LastBuildStepCopiedFile() const {
+    return last_build_step_copied_file_;
+  }
+
   // Returns the file descriptor.
   const FileDescriptor& GetFileDescriptor() const { return fd_; }
 
@@ -264,9 +277,27 @@ class WeightCacheBuilder {
   // cache. To ensure a smooth reloading, we need to ensure that the file header
   // is correct. This flag lets us know if that has happened.
   bool first_write_done_ = false;
+  // Renames the temporary file to `file_path_`.
+  [[nodiscard /*Renaming a file may fail.*/]]
+  bool Publish();
+
+  // Copies the published file to a new temporary file and continues writing
+  // to the copy.
+  [[nodiscard /*Copying a file may fail.*/]]
+  bool CopyPublishedFile();
+
+  // Removes the temporary file if it hasn't been published.
+  void RemoveTemporaryFile();
+
   // Temporary file descriptor to write the weights to disk immediately.
   FileDescriptor fd_;
   std::string file_path_;
+  // Path of the file `fd_` writes to until it is published, empty if `fd_`
+  // writes to `file_path_` or to memory.
+  std::string temporary_path_;
+  // True if the file `fd_` writes to was renamed to `file_path_`.
+  bool published_ = false;
+  bool last_build_step_copied_file_ = false;
 
   bool is_build_step_ = false;
 };
@@ -284,6 +315,13 @@ class WeightCacheBuilder {
 //  - Load the cache file.
 //  - Finalize the cache before calling the run functions of XNNPack (setup and
 //    reshape are ok).
+//
+// Several processes can share a cache file: the pages of the mapped file are
+// shared read-only between them. `LoadOrStartBuild` lets one process at a time
+// build a missing or outdated file, using `<file_path>.lock` as an advisory
+// lock, which is removed when the build is finished. While a build is in
+// progress, the other processes don't load the partial file and use a private
+// in-memory cache instead.
 class MMapWeightCacheProvider {
  public:
   MMapWeightCacheProvider() = default;
@@ -300,7 +338,8 @@ class MMapWeightCacheProvider {
   const std::string& GetFilePath() const { return file_path_; }
 
   // Tries to load the given file. If the file doesn't exist starts building the
-  // cache for it.
+  // cache for it, unless another process is building it, in which case this
+  // builds an in-memory cache when supported.
   [[nodiscard /*Loading a cache file may fail.*/]]
   bool LoadOrStartBuild(const char* file_path);
 
@@ -330,6 +369,13 @@ class MMapWeightCacheProvider {
   [[nodiscard /*Updating cache data may fail.*/]]
   bool StopBuildStep();
 
+  // Lets other processes load the cache file. They don't while this is
+  // building it, since more buffers may be added to it. Later build steps still
+  // update the file.
+  //
+  // Returns immediately if the build lock isn't held.
+  void FinishBuild();
+
   // Creates the tensor map.
   void MapTensorIdentifiers(
       const TfLiteTensor* tensors, size_t size,
@@ -451,6 +497,9 @@ class MMapWeightCacheProvider {
   // Used to build the cache.
   WeightCacheBuilder builder_;
 
+  // Holds the lock on `<file_path_>.lock` while this builds the cache file.
+  FileDescriptor build_lock_;
+
   // True if the current run is the one building the cache file.
   //
   // We cannot distinguish between a wrong/outdated cache and one that is not
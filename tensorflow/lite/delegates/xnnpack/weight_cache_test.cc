@@ -582,6 +582,78 @@ TEST(WeightCacheBuilderTest, MultipleStepBuild) {
   EXPECT_THAT(GetBufferData(buffer3), ElementsAreArray(payload3));
 }
 
+TEST(WeightCacheBuilderTest, PublishesCompleteFilesOnly) {
+  using std::size;
+
+  const std::string payload1 = "This is some data in the file.";
+  const PackIdentifier dummy_id1{1, 2, 3};
+  const std::string payload2 = "Other data in the file.";
+  const PackIdentifier dummy_id2{2, 3, 4};
+
+  const std::string cache_path = testing::TempDir() + "/published_cache";
+  std::remove(cache_path.c_str());
+
+  WeightCacheBuilder builder;
+  ASSERT_TRUE(builder.Start(cache_path.c_str()));
+  ASSERT_TRUE(builder.StartBuildStep());
+  {
+    void* buffer = builder.Reserve(size(payload1));
+    std::memcpy(buffer, payload1.c_str(), size(payload1));
+    builder.Append(dummy_id1, buffer, size(payload1));
+  }
+  // The file only appears once the build step is done.
+  EXPECT_FALSE(FileDescriptor::Open(cache_path.c_str(), O_RDONLY).IsValid());
+  ASSERT_TRUE(builder.StopBuildStep());
+  EXPECT_FALSE(builder.LastBuildStepCopiedFile());
+
+  MMapHandle first_file;
+  ASSERT_TRUE(first_file.Map(cache_path.c_str()));
+  const std::vector<uint8_t> first_file_data(
+      first_file.data(), first_file.data() + first_file.size());
+
+  ASSERT_TRUE(builder.StartBuildStep());
+  {
+    void* buffer = builder.Reserve(size(payload2));
+    std::memcpy(buffer, payload2.c_str(), size(payload2));
+    builder.Append(dummy_id2, buffer, size(payload2));
+  }
+  ASSERT_TRUE(builder.StopBuildStep());
+  EXPECT_TRUE(builder.LastBuildStepCopiedFile());
+
+  // The second step didn't modify the file published by the first one.
+  EXPECT_THAT(LightSpan<const uint8_t>(first_file.data(), first_file.size()),
+              ElementsAreArray(first_file_data));
+
+  MMapHandle second_file;
+  ASSERT_TRUE(second_file.Map(cache_path.c_str()));
+  const XNNPackCacheHeader& header =
+      *reinterpret_cast<const XNNPackCacheHeader*>(second_file.data());
+  ASSERT_EQ(header.version, XNNPackCacheHeader::kVersion);
+  const cache::schema::BufferList* const packed_weights =
+      cache::schema::GetBufferList(second_file.data() +
+                                   header.buffer_list_offset);
+  ASSERT_NE(packed_weights, nullptr);
+  ASSERT_NE(packed_weights->buffers(), nullptr);
+  EXPECT_EQ(packed_weights->buffers()->size(), 2);
+}
+
+TEST(WeightCacheBuilderTest, UnfinishedBuildStepIsNotPublished) {
+  using std::size;
+
+  const std::string payload = "This is some data in the file.";
+  const std::string cache_path = testing::TempDir() + "/unfinished_cache";
+  std::remove(cache_path.c_str());
+  {
+    WeightCacheBuilder builder;
+    ASSERT_TRUE(builder.Start(cache_path.c_str()));
+    ASSERT_TRUE(builder.StartBuildStep());
+    void* buffer = builder.Reserve(size(payload));
+    std::memcpy(buffer, payload.c_str(), size(payload));
+    builder.Append(PackIdentifier{1, 2, 3}, buffer, size(payload));
+  }
+  EXPECT_FALSE(FileDescriptor::Open(cache_path.c_str(), O_RDONLY).IsValid());
+}
+
 struct FakeContext {
   // Adds a new tensor and it's backing buffer to the context.
   //
@@ -1052,5 +1124,62 @@ TEST(MMapWeightCacheProviderTest, XnnpackCApiJourney) {
   }
 }
 
+TEST(MMapWeightCacheProviderTest, OnlyOneProviderBuildsACacheFile) {
+  if (!TfLiteXNNPackDelegateCanUseInMemoryWeightCacheProvider()) {
+    GTEST_SKIP() << "In-memory weight cache isn't enabled for this build or "
+                    "isn't supported by the current system, skipping test.";
+  }
+  const std::string cache_path = testing::TempDir() + "/shared_cache";
+  std::remove(cache_path.c_str());
+
+  char fake_buffer_pointer[2] = {0};
+  TfLiteTensor tensors[2];
+  std::unordered_map<size_t, size_t> tensor_buffer_identifiers;
+  for (int i = 0; i < 2; ++i) {
+    tensors[i].data.data = (void*)(fake_buffer_pointer + i);
+    tensor_buffer_identifiers[i] = i;
+  }
+  const xnn_weights_cache_look_up_key look_up_key{
+      .seed = 0xBA0BAB,
+      .kernel = tensors[0].data.data,
+      .bias = tensors[1].data.data};
+  const char packed_data[] = "abcdefghij";
+
+  MMapWeightCacheProvider building_provider;
+  ASSERT_TRUE(building_provider.LoadOrStartBuild(cache_path.c_str()));
+  EXPECT_EQ(building_provider.GetFilePath(), cache_path);
+  ASSERT_TRUE(building_provider.CanStartBuildStep());
+  building_provider.MapTensorIdentifiers(tensors, 2,
+                                         tensor_buffer_identifiers);
+  ASSERT_TRUE(building_provider.StartBuildStep());
+  xnn_weights_cache_t cache = &building_provider.GetCacheProvider();
+  const size_t offset = cache->look_up_or_insert(
+      cache, &look_up_key, (void*)packed_data, sizeof(packed_data));
+  ASSERT_TRUE(building_provider.StopBuildStep());
+
+  {
+    // The build may still add buffers to the published file. Lock files are
+    // opened for each provider, so this also applies to the providers of a
+    // process.
+    MMapWeightCacheProvider provider;
+    ASSERT_TRUE(provider.LoadOrStartBuild(cache_path.c_str()));
+    EXPECT_EQ(provider.GetFilePath(), kInMemoryCachePath);
+  }
+
+  building_provider.FinishBuild();
+  EXPECT_FALSE(
+      FileDescriptor::Open((cache_path + ".lock").c_str(), O_RDONLY).IsValid());
+
+  MMapWeightCacheProvider provider;
+  ASSERT_TRUE(provider.LoadOrStartBuild(cache_path.c_str()));
+  EXPECT_EQ(provider.GetFilePath(), cache_path);
+  EXPECT_FALSE(provider.CanStartBuildStep());
+  provider.MapTensorIdentifiers(tensors, 2, tensor_buffer_identifiers);
+  ASSERT_EQ(provider.LookUp(&look_up_key), offset);
+  EXPECT_THAT(LightSpan<const char>(provider.OffsetToAddr(offset),
+                                    sizeof(packed_data)),
+              ElementsAreArray(packed_data));
+}
+
 }  // namespace
 }  // namespace tflite::xnnpack
@@ -706,6 +706,13 @@ class Delegate {
 
   const TfLiteXNNPackDelegateOptions& options() const { return options_; }
 
+  // Lets other processes load the weight cache file once the runtimes of the
+  // delegated graph have been created, without waiting for an invocation.
+  void FinishWeightCacheBuild() {
+    std::lock_guard<std::mutex> lock(workspace_mutex_);
+    weight_cache_provider_.FinishBuild();
+  }
+
   int64_t GetXNNPackDelegateFlags() {
     if (enable_subgraph_reshaping()) {
       return kTfLiteDelegateFlagsPerOperatorProfiling |
@@ -1250,6 +1257,10 @@ class Subgraph {
                       Delegate* delegate) {
     std::lock_guard<std::mutex> lock(delegate->workspace_mutex_);
 
+    // The runtimes are created when the graph is delegated, so the weight cache
+    // file won't grow anymore and other processes can load it.
+    delegate->weight_cache_provider_.FinishBuild();
+
     bool any_pointers_changed = false;
     for (std::pair<int, void*> io_info : externals_) {
       const TfLiteTensor& tensor = context->tensors[io_info.first];
@@ -7729,6 +7740,14 @@ const TfLiteXNNPackDelegateOptions* TfLiteXNNPackDelegateGetOptions(
                ->options());
 }
 
+void TfLiteXNNPackDelegateFinishWeightCacheBuild(TfLiteDelegate* delegate) {
+  if (delegate == nullptr) {
+    return;
+  }
+  static_cast<::tflite::xnnpack::Delegate*>(delegate->data_)
+      ->FinishWeightCacheBuild();
+}
+
 int TfLiteXNNPackDelegateGetFlags(TfLiteDelegate* delegate) {
   if (delegate == nullptr) {
     return 0;
@@ -121,6 +121,15 @@ TFL_CAPI_EXPORT void* TfLiteXNNPackDelegateGetThreadPool(
 TFL_CAPI_EXPORT const TfLiteXNNPackDelegateOptions*
 TfLiteXNNPackDelegateGetOptions(TfLiteDelegate* delegate);
 
+// Lets other processes load the weight cache file that the delegate built
+// when it was applied to an interpreter. Otherwise, they wait for the first
+// invocation of the interpreter. Does nothing if the delegate did not build a
+// weight cache file.
+//
+// WARNING: This API is experimental and subject to change.
+TFL_CAPI_EXPORT void TfLiteXNNPackDelegateFinishWeightCacheBuild(
+    TfLiteDelegate* delegate);
+
 // Returns the flags used for an XNNPack delegate.
 // See documentation for TfLiteXNNPackDelegateOptions.flags.
 //
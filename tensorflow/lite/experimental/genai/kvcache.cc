@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/experimental/resource/cache_buffer.h"
+#include "tensorflow/lite/experimental/resource/paged_kv_cache.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/kernels/internal/runtime_shape.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
@@ -57,6 +58,14 @@ struct OpData {
   bool is_initialized;
   uint8_t* key_cache_ptr;
   uint8_t* value_cache_ptr;
+  // Number of positions in a block of the paged KV cache. If positive, keys
+  // and values are written to the paged KV cache shared with the SDPA op
+  // instead of the contiguous cache buffers, and the outputs are empty.
+  int block_size;
+  // Maximum number of blocks of the paged KV cache, 0 if unbounded.
+  int max_num_blocks;
+  // Not owned.
+  resource::PagedKVCache* paged_kv_cache;
 };
 
 void* KVCacheInit(TfLiteContext* context, const char* buffer, size_t length) {
@@ -72,9 +81,64 @@ void* KVCacheInit(TfLiteContext* context, const char* buffer, size_t length) {
   op_data->is_initialized = false;
   op_data->key_cache_ptr = nullptr;
   op_data->value_cache_ptr = nullptr;
+  op_data->block_size = 0;
+  op_data->max_num_blocks = 0;
+  op_data->paged_kv_cache = nullptr;
   return op_data;
 }
 
+// Sets up writing to the paged KV cache, which is created by the first KV cache
+// op of the subgraph. The outputs are [batch, 0, num_heads, head_dim], as the
+// SDPA op reads the keys and values from the paged KV cache.
+TfLiteStatus PreparePagedKVCache(TfLiteContext* context, TfLiteNode* node,
+                                 const TfLiteTensor* key) {
+  OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
+  TF_LITE_ENSURE(context, op_data->max_num_blocks >= 0);
+  TF_LITE_ENSURE(context, op_data->layer_index < op_data->num_layers);
+
+  resource::PagedKVCache::Options options;
+  options.num_layers = op_data->num_layers;
+  options.num_heads = SizeOfDimension(key, 2);
+  options.head_dim = SizeOfDimension(key, 3);
+  options.block_size = op_data->block_size;
+  options.max_num_blocks = op_data->max_num_blocks;
+
+  Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+  auto& resources = subgraph->resources();
+  resource::PagedKVCache* cache = nullptr;
+  if (resource::GetPagedKVCache(resources, &cache) != kTfLiteOk) {
+    TF_LITE_KERNEL_LOG(context, "Resource %d is not a paged KV cache.",
+                       resource::kPagedKVCacheResourceId);
+    return kTfLiteError;
+  }
+  if (cache == nullptr) {
+    cache = new resource::PagedKVCache(options);
+    resources.emplace(resource::kPagedKVCacheResourceId, cache);
+  }
+  // All KV cache ops of the model share the cache, so they must agree on its
+  // layout.
+  const resource::PagedKVCache::Options& cache_options = cache->options();
+  TF_LITE_ENSURE_EQ(context, cache_options.num_layers, options.num_layers);
+  TF_LITE_ENSURE_EQ(context, cache_options.num_heads, options.num_heads);
+  TF_LITE_ENSURE_EQ(context, cache_options.head_dim, options.head_dim);
+  TF_LITE_ENSURE_EQ(context, cache_options.block_size, options.block_size);
+  op_data->paged_kv_cache = cache;
+
+  TfLiteTensor* kfull;
+  TfLiteTensor* vfull;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kFullKeyTensor, &kfull));
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kFullValueTensor, &vfull));
+  kfull->type = kTfLiteFloat32;
+  vfull->type = kTfLiteFloat32;
+  TfLiteIntArray* kfull_dims = TfLiteIntArrayCopy(key->dims);
+  kfull_dims->data[1] = 0;
+  TfLiteIntArray* vfull_dims = TfLiteIntArrayCopy(kfull_dims);
+  TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, kfull, kfull_dims));
+  return context->ResizeTensor(context, vfull, vfull_dims);
+}
+
 TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
   TF_LITE_ENSURE_EQ(context, NumOutputs(node), 2);
@@ -96,6 +160,8 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
     op_data->layer_index =
         layer_index > 0 ? layer_index : kDefaultTransformerLayerId;
     op_data->first_slot_index = 0;
+    op_data->block_size = flexbuffer_map["kv_cache_block_size"].AsInt32();
+    op_data->max_num_blocks = flexbuffer_map["kv_cache_max_blocks"].AsInt32();
     op_data->is_initialized = true;
   }
 
@@ -121,6 +187,10 @@ TfLiteStatus KVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE(context, GetTensorShape(key).Dims(0) == 1);
   TF_LITE_ENSURE(context, HaveSameShapes(key, value));
 
+  if (op_data->block_size > 0) {
+    return PreparePagedKVCache(context, node, key);
+  }
+
   // Create the key and value caches. Currently statically sized.
   TfLiteTensor* kfull;
   TfLiteTensor* vfull;
@@ -245,6 +315,24 @@ TfLiteStatus KVCacheEval(TfLiteContext* context, TfLiteNode* node) {
                     GetOutputSafe(context, node, kFullValueTensor, &vfull));
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
 
+  if (op_data->paged_kv_cache != nullptr) {
+    // Writes the keys and values in place, without shifting the cache.
+    resource::PagedKVCache* cache = op_data->paged_kv_cache;
+    const int64_t first_position = position->data.i64[0];
+    if (cache->Write(cache->active_sequence(), op_data->layer_index,
+                     first_position, SizeOfDimension(key, 1),
+                     GetTensorData<float>(key),
+                     GetTensorData<float>(value)) != kTfLiteOk) {
+      TF_LITE_KERNEL_LOG(context,
+                         "Failed to write position %d of sequence %d to the "
+                         "paged KV cache.",
+                         static_cast<int>(first_position),
+                         cache->active_sequence());
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
   float* key_cache_ptr = op_data->key_cache_buffer->GetBuffer();
   float* value_cache_ptr = op_data->value_cache_buffer->GetBuffer();
   const int layer_index = op_data->layer_index;
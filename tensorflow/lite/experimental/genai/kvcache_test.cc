@@ -17,8 +17,10 @@ limitations under the License.
 #include <vector>
 
 #include <gtest/gtest.h>
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/experimental/resource/paged_kv_cache.h"
 #include "tensorflow/lite/kernels/test_util.h"
 #include "tensorflow/lite/schema/schema_generated.h"
 
@@ -30,13 +32,14 @@ static const int kDefaultMaxNumCacheEntries = 2048;
 class SimpleCacheOpModel : public SingleOpModel {
  public:
   SimpleCacheOpModel(const TensorData& pos_tensor, const TensorData& k_tensor,
-                     const TensorData& v_tensor) {
+                     const TensorData& v_tensor,
+                     const std::vector<uint8_t>& custom_options = {}) {
     pos_ = AddInput(pos_tensor);
     k_ = AddInput(k_tensor);
     v_ = AddInput(v_tensor);
     kfull_ = AddOutput(k_tensor.type);
     vfull_ = AddOutput(v_tensor.type);
-    SetCustomOp("KV_Cache", {}, ops::custom::Register_KV_CACHE);
+    SetCustomOp("KV_Cache", custom_options, ops::custom::Register_KV_CACHE);
 
     BuildInterpreter({GetShape(pos_), GetShape(k_), GetShape(v_)});
   }
@@ -69,6 +72,16 @@ class SimpleCacheOpModel : public SingleOpModel {
 
   TfLiteStatus ReAllocate() { return interpreter_->AllocateTensors(); }
 
+  std::vector<int> GetFullKShape() { return GetTensorShape(kfull_); }
+
+  resource::PagedKVCache* GetPagedKVCache() {
+    resource::PagedKVCache* cache = nullptr;
+    EXPECT_EQ(resource::GetPagedKVCache(
+                  interpreter_->primary_subgraph().resources(), &cache),
+              kTfLiteOk);
+    return cache;
+  }
+
  protected:
   int pos_;
   int k_;
@@ -237,5 +250,80 @@ TEST(SimpleCacheOp2Test, ShiftSlotsInCache) {
   ASSERT_EQ(m.Invoke(), kTfLiteError);
 }
 
+std::vector<uint8_t> PagedCacheOptions(int block_size, int num_layers,
+                                       int layer_index) {
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    fbb.Int("kv_cache_block_size", block_size);
+    fbb.Int("num_layers", num_layers);
+    fbb.Int("layer_index", layer_index);
+  });
+  fbb.Finish();
+  return fbb.GetBuffer();
+}
+
+// Returns the first element of the key of each position of a sequence.
+std::vector<float> ReadKeys(const resource::PagedKVCache& cache,
+                            int sequence_id, int layer) {
+  std::vector<const float*> key_blocks;
+  std::vector<const float*> value_blocks;
+  EXPECT_EQ(cache.GetBlocks(sequence_id, layer, key_blocks, value_blocks),
+            kTfLiteOk);
+  const int block_size = cache.options().block_size;
+  const int entry_size = cache.options().num_heads * cache.options().head_dim;
+  std::vector<float> keys;
+  for (int i = 0; i < cache.GetSequenceLength(sequence_id); ++i) {
+    keys.push_back(
+        key_blocks[i / block_size][(i % block_size) * entry_size]);
+  }
+  return keys;
+}
+
+TEST(PagedCacheOpTest, WritesToPagedKVCache) {
+  SimpleCacheOpModel m({TensorType_INT64, {3}},
+                       {TensorType_FLOAT32, {1, 3, 2, 3}},
+                       {TensorType_FLOAT32, {1, 3, 2, 3}},
+                       PagedCacheOptions(/*block_size=*/4, /*num_layers=*/2,
+                                         /*layer_index=*/1));
+  m.SetPosition({0, 1, 2});
+  m.SetKey({0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2});
+  m.SetValue(std::vector<float>(18, -1));
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  // The keys and values are only in the paged KV cache.
+  EXPECT_EQ(m.GetFullKShape(), std::vector<int>({1, 0, 2, 3}));
+  resource::PagedKVCache* cache = m.GetPagedKVCache();
+  ASSERT_NE(cache, nullptr);
+  EXPECT_EQ(cache->GetSequenceLength(0), 3);
+  EXPECT_EQ(ReadKeys(*cache, 0, /*layer=*/1), std::vector<float>({0, 1, 2}));
+
+  // Decodes across the block boundary, appending in place.
+  m.ResizeKey({1, 1, 2, 3});
+  m.ResizeValue({1, 1, 2, 3});
+  m.ResizePosition({1});
+  ASSERT_EQ(m.ReAllocate(), kTfLiteOk);
+  for (int position = 3; position < 5; ++position) {
+    m.SetPosition({position});
+    m.SetKey(std::vector<float>(6, position));
+    m.SetValue(std::vector<float>(6, -1));
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  }
+  EXPECT_EQ(ReadKeys(*cache, 0, /*layer=*/1),
+            std::vector<float>({0, 1, 2, 3, 4}));
+  EXPECT_EQ(cache->num_used_blocks(), 2);
+
+  // A forked sequence writes its own copy of the shared block.
+  ASSERT_EQ(cache->ForkSequence(0, 1), kTfLiteOk);
+  ASSERT_EQ(cache->SetActiveSequence(1), kTfLiteOk);
+  m.SetPosition({5});
+  m.SetKey(std::vector<float>(6, 50));
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+  EXPECT_EQ(ReadKeys(*cache, 0, /*layer=*/1),
+            std::vector<float>({0, 1, 2, 3, 4}));
+  EXPECT_EQ(ReadKeys(*cache, 1, /*layer=*/1),
+            std::vector<float>({0, 1, 2, 3, 4, 50}));
+  EXPECT_EQ(cache->num_used_blocks(), 3);
+}
+
 }  // namespace
 }  // namespace tflite
@@ -15,23 +15,21 @@ limitations under the License.
 
 #include <math.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <cstring>
 #include <limits>
+#include <vector>
 
 #include "flatbuffers/flexbuffers.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
-#include "tensorflow/lite/kernels/internal/common.h"
-#include "tensorflow/lite/kernels/internal/reference/add.h"
-#include "tensorflow/lite/kernels/internal/reference/batch_matmul.h"
-#include "tensorflow/lite/kernels/internal/reference/fully_connected.h"
-#include "tensorflow/lite/kernels/internal/reference/softmax.h"
-#include "tensorflow/lite/kernels/internal/reference/transpose.h"
-#include "tensorflow/lite/kernels/internal/runtime_shape.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/resource/paged_kv_cache.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/portable_tensor_utils.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
-#include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
 
 namespace tflite {
@@ -45,27 +43,203 @@ static const int kValueTensor = 2;
 static const int kAttentionMaskTensor = 3;
 static const int kOutputTensor = 0;
 
-static const int kNumTempTensors = 10;
-static const int kTransposeQueryTempTensorIndex = 0;
-static const int kTransposeKeyTempTensorIndex = 1;
-static const int kMatMul1TempTensorIndex = 2;
-static const int kAddTempTensorIndex = 3;
-static const int kTransposeValueTempTensorIndex = 4;
-static const int kMatMul2TempTensorIndex = 5;
-static const int kReshape1TempTensorIndex = 6;
-static const int kReshape2TempTensorIndex = 7;
-static const int kBroadcastKTempTensorIndex = 8;
-static const int kBroadcastVTempTensorIndex = 9;
+// Number of keys and values processed at a time. A block of keys and values is
+// reused from cache by all query rows of a query block.
+static const int kKeyValueBlockSize = 64;
+// Number of query rows processed against each block of keys and values.
+static const int kQueryBlockSize = 8;
 
 struct OpData {
   float scale;
-  int scratch_tensor_index;
+  // Whether keys and values are read from the paged KV cache written by the
+  // KV cache op, rather than from the key and value inputs.
+  bool paged_kv_cache;
+  // Layer of the paged KV cache to read.
+  int layer_index;
+  // Pointers to the blocks of keys and values of the current invocation.
+  std::vector<const float*> key_blocks;
+  std::vector<const float*> value_blocks;
+};
+
+// Inputs of the attention computation. Query and output are laid out as
+// [batch, query_seq_len, num_heads, head_dim]. Keys and values are read in
+// blocks of `kv_block_size` positions laid out as
+// [kv_block_size, num_kv_heads, head_dim], so that they can be read in place
+// from either the KV cache op outputs or the paged KV cache.
+struct AttentionParams {
+  const float* query;
+  // Block `i` of batch `b` is at index `b * num_kv_blocks + i`.
+  const float* const* key_blocks;
+  const float* const* value_blocks;
+  int kv_block_size;
+  int num_kv_blocks;
+  const float* mask;
+  float* output;
+  int batch_size;
+  int query_seq_len;
+  int kv_seq_len;
+  int num_heads;
+  int num_kv_heads;
+  int head_dim;
+  float scale;
+  // Strides of the attention mask broadcast to
+  // [batch, num_heads, query_seq_len, kv_seq_len]. Broadcast dimensions have
+  // stride 0.
+  int mask_strides[4];
+
+  int num_query_blocks() const {
+    return (query_seq_len + kQueryBlockSize - 1) / kQueryBlockSize;
+  }
+
+  // Number of independent units of work. Each unit computes one query block
+  // of one head.
+  int num_work_units() const {
+    return batch_size * num_heads * num_query_blocks();
+  }
+};
+
+// Computes the attention of query rows [query_begin, query_end) of `head` in
+// `batch`. Keys and values are streamed in blocks, and the softmax is computed
+// online: The running maximum and sum of each row rescale the partial output,
+// so the score matrix is never materialized. Query heads that share a key and
+// value head (MQA/GQA) read it in place rather than broadcasting it. Blocks of
+// keys and values end at page boundaries of the KV cache.
+void ComputeAttention(const AttentionParams& params, int batch, int head,
+                      int query_begin, int query_end) {
+  const int head_dim = params.head_dim;
+  const int kv_head = head / (params.num_heads / params.num_kv_heads);
+  const int query_row_stride = params.num_heads * head_dim;
+  const int kv_row_stride = params.num_kv_heads * head_dim;
+  const float* mask = params.mask + batch * params.mask_strides[0] +
+                      head * params.mask_strides[1];
+  const int mask_kv_stride = params.mask_strides[3];
+
+  const int num_rows = query_end - query_begin;
+  float row_max[kQueryBlockSize];
+  float row_sum[kQueryBlockSize];
+  float scores[kKeyValueBlockSize];
+  for (int r = 0; r < num_rows; ++r) {
+    row_max[r] = -std::numeric_limits<float>::infinity();
+    row_sum[r] = 0.0f;
+  }
+
+  auto query_row = [&](int r) {
+    return params.query +
+           ((batch * params.query_seq_len + query_begin + r) *
+                params.num_heads +
+            head) *
+               head_dim;
+  };
+  auto output_row = [&](int r) {
+    return params.output +
+           ((batch * params.query_seq_len + query_begin + r) *
+                params.num_heads +
+            head) *
+               head_dim;
+  };
+  for (int r = 0; r < num_rows; ++r) {
+    std::fill_n(output_row(r), head_dim, 0.0f);
+  }
+
+  int kv_begin = 0;
+  while (kv_begin < params.kv_seq_len) {
+    const int page = kv_begin / params.kv_block_size;
+    const int page_begin = page * params.kv_block_size;
+    const int kv_end = std::min({kv_begin + kKeyValueBlockSize,
+                                 page_begin + params.kv_block_size,
+                                 params.kv_seq_len});
+    // Keys and values of positions [page_begin, kv_end).
+    const float* key =
+        params.key_blocks[batch * params.num_kv_blocks + page] +
+        kv_head * head_dim;
+    const float* value =
+        params.value_blocks[batch * params.num_kv_blocks + page] +
+        kv_head * head_dim;
+    for (int r = 0; r < num_rows; ++r) {
+      const float* q = query_row(r);
+      const float* mask_row =
+          mask + (query_begin + r) * params.mask_strides[2];
+      float block_max = -std::numeric_limits<float>::infinity();
+      for (int s = kv_begin; s < kv_end; ++s) {
+        const float score =
+            tensor_utils::VectorVectorDotProduct(
+                q, key + (s - page_begin) * kv_row_stride, head_dim) *
+                params.scale +
+            mask_row[s * mask_kv_stride];
+        scores[s - kv_begin] = score;
+        block_max = std::max(block_max, score);
+      }
+      // Skips blocks which are fully masked out, e.g. by a causal mask.
+      if (block_max == -std::numeric_limits<float>::infinity()) {
+        continue;
+      }
+
+      float* out = output_row(r);
+      const float new_max = std::max(row_max[r], block_max);
+      if (new_max > row_max[r]) {
+        const float correction = expf(row_max[r] - new_max);
+        row_sum[r] *= correction;
+        for (int d = 0; d < head_dim; ++d) {
+          out[d] *= correction;
+        }
+        row_max[r] = new_max;
+      }
+      for (int s = kv_begin; s < kv_end; ++s) {
+        const float weight = expf(scores[s - kv_begin] - new_max);
+        row_sum[r] += weight;
+        const float* v = value + (s - page_begin) * kv_row_stride;
+        for (int d = 0; d < head_dim; ++d) {
+          out[d] += weight * v[d];
+        }
+      }
+    }
+    kv_begin = kv_end;
+  }
+
+  for (int r = 0; r < num_rows; ++r) {
+    // Rows whose keys are all masked out produce zeros.
+    if (row_sum[r] > 0.0f) {
+      const float inverse_sum = 1.0f / row_sum[r];
+      float* out = output_row(r);
+      for (int d = 0; d < head_dim; ++d) {
+        out[d] *= inverse_sum;
+      }
+    }
+  }
+}
+
+// Computes work units [unit_begin, unit_end). Consecutive units cover the query
+// blocks of the same head, so a thread keeps reusing its keys and values.
+void ComputeWorkUnits(const AttentionParams& params, int unit_begin,
+                      int unit_end) {
+  const int num_query_blocks = params.num_query_blocks();
+  for (int unit = unit_begin; unit < unit_end; ++unit) {
+    const int query_block = unit % num_query_blocks;
+    const int head = (unit / num_query_blocks) % params.num_heads;
+    const int batch = unit / num_query_blocks / params.num_heads;
+    const int query_begin = query_block * kQueryBlockSize;
+    const int query_end =
+        std::min(query_begin + kQueryBlockSize, params.query_seq_len);
+    ComputeAttention(params, batch, head, query_begin, query_end);
+  }
+}
+
+struct AttentionTask : cpu_backend_threadpool::Task {
+  AttentionTask(const AttentionParams& params, int unit_begin, int unit_end)
+      : params(params), unit_begin(unit_begin), unit_end(unit_end) {}
+
+  void Run() override { ComputeWorkUnits(params, unit_begin, unit_end); }
+
+  const AttentionParams& params;
+  const int unit_begin;
+  const int unit_end;
 };
 
 void* SDPAInit(TfLiteContext* context, const char* buffer, size_t length) {
   OpData* op_data = new OpData();
   op_data->scale = 0.0f;
-  context->AddTensors(context, kNumTempTensors, &op_data->scratch_tensor_index);
+  op_data->paged_kv_cache = false;
+  op_data->layer_index = 0;
   return op_data;
 }
 
@@ -86,272 +260,75 @@ TfLiteStatus SDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* mask_tensor;
   TF_LITE_ENSURE_OK(
       context, GetInputSafe(context, node, kAttentionMaskTensor, &mask_tensor));
+  TfLiteTensor* output_tensor;
+  TF_LITE_ENSURE_OK(
+      context, GetOutputSafe(context, node, kOutputTensor, &output_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(q_tensor), NumDimensions(k_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(k_tensor), NumDimensions(v_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(v_tensor),
                     NumDimensions(mask_tensor));
   TF_LITE_ENSURE_EQ(context, NumDimensions(mask_tensor), 4);
+  TF_LITE_ENSURE_TYPES_EQ(context, q_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_TYPES_EQ(context, k_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_TYPES_EQ(context, v_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_TYPES_EQ(context, mask_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_TYPES_EQ(context, output_tensor->type, kTfLiteFloat32);
+
+  // q: [batch, query_seq_len, num_heads, head_dim]
+  // k, v: [batch, kv_seq_len, num_kv_heads, head_dim]
+  for (int i = 0; i < 4; ++i) {
+    TF_LITE_ENSURE_EQ(context, SizeOfDimension(k_tensor, i),
+                      SizeOfDimension(v_tensor, i));
+  }
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(q_tensor, 0),
+                    SizeOfDimension(k_tensor, 0));
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(q_tensor, 3),
+                    SizeOfDimension(k_tensor, 3));
+  TF_LITE_ENSURE(context, SizeOfDimension(k_tensor, 2) > 0);
+  TF_LITE_ENSURE_EQ(
+      context, SizeOfDimension(q_tensor, 2) % SizeOfDimension(k_tensor, 2), 0);
 
   // Get custom op params
   const uint8_t* buffer =
       reinterpret_cast<const uint8_t*>(node->custom_initial_data);
   const size_t length = node->custom_initial_data_size;
-  auto flexbuffer_map = flexbuffers::GetRoot(buffer, length).AsMap();
-  float scale = flexbuffer_map["scale"].AsFloat();
-  op_data->scale = scale > 0.0f ? scale : 0.0f;
-
-  // If scale is not set, use sqrt(q_tensor->dims->data[3])
-  if (op_data->scale == 0.0f)
-    op_data->scale = 1 / sqrt(q_tensor->dims->data[3]);
-
-  TfLiteIntArrayFree(node->temporaries);
-  node->temporaries = TfLiteIntArrayCreate(kNumTempTensors);
-  bool mqa = k_tensor->dims->data[2] == 1;
-
-  // Temp tensor for Transposed Q;
-  {
-    node->temporaries->data[kTransposeQueryTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeQueryTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeQueryTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = q_tensor->dims->data[i];
-    }
-    // Swap middle two dimensions.
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = q_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Transposed K;
-  {
-    node->temporaries->data[kTransposeKeyTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeKeyTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeKeyTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = k_tensor->dims->data[i];
-    }
-    // Swap to middle two dimensions.
-    scratch_buffer_size->data[1] = k_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = k_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  TfLiteIntArray* add_broadcast_shape = nullptr;
-  // Temp tensor for Matmul1 output;
-  {
-    node->temporaries->data[kMatMul1TempTensorIndex] =
-        op_data->scratch_tensor_index + kMatMul1TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kMatMul1TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // mha/gqa: [permute_q[0], permute_q[1], permute_q[2], permute_k[2]]
-    int matmul_out_shape[4] = {q_tensor->dims->data[0], q_tensor->dims->data[2],
-                               q_tensor->dims->data[1],
-                               k_tensor->dims->data[1]};
-    for (int i = 0; i < 4; ++i) {
-      scratch_buffer_size->data[i] = matmul_out_shape[i];
-    }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-    // get dims from attention_mask, matmul1_out for add broadcast
-    CalculateShapeForBroadcast(context, mask_tensor, scratch_buffer,
-                               &add_broadcast_shape);
+  float scale = 0.0f;
+  if (buffer != nullptr && length > 0) {
+    auto flexbuffer_map = flexbuffers::GetRoot(buffer, length).AsMap();
+    scale = flexbuffer_map["scale"].AsFloat();
+    op_data->paged_kv_cache = flexbuffer_map["paged_kv_cache"].AsBool();
+    op_data->layer_index = flexbuffer_map["layer_index"].AsInt32();
   }
-
-  // Temp tensor for add output;
-  int add_out_shape[4];
-  {
-    node->temporaries->data[kAddTempTensorIndex] =
-        op_data->scratch_tensor_index + kAddTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                                /*index=*/kAddTempTensorIndex,
-                                                &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = add_broadcast_shape;
-    for (int i = 0; i < 4; ++i) {
-      add_out_shape[i] = scratch_buffer_size->data[i];
-    }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
+  if (op_data->paged_kv_cache) {
+    // Keys and values are [1, 0, num_kv_heads, head_dim] placeholders, and the
+    // sequence length is only known in Eval.
+    TF_LITE_ENSURE_EQ(context, SizeOfDimension(q_tensor, 0), 1);
+    TF_LITE_ENSURE(context, op_data->layer_index >= 0);
   }
 
-  // Temp tensor for Transposed V;
-  {
-    node->temporaries->data[kTransposeValueTempTensorIndex] =
-        op_data->scratch_tensor_index + kTransposeValueTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kTransposeValueTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // Swap to {0, 2, 3, 1} dimensions.
-    scratch_buffer_size->data[0] = v_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = v_tensor->dims->data[2];
-    scratch_buffer_size->data[2] = v_tensor->dims->data[3];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Matmul2 output;
-  {
-    node->temporaries->data[kMatMul2TempTensorIndex] =
-        op_data->scratch_tensor_index + kMatMul2TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kMatMul2TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-    // logits_out_shape = add_out_shape
-    // mha/gqa: [logits_out[0], logits_out[1], logits_out[2], permute_v[2]]
-    scratch_buffer_size->data[0] = add_out_shape[0];
-    scratch_buffer_size->data[1] = add_out_shape[1];
-    scratch_buffer_size->data[2] = add_out_shape[2];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[3];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
+  // The mask is broadcast to [batch, num_heads, query_seq_len, kv_seq_len].
+  // The paged KV cache may be shorter than the mask.
+  const int broadcast_mask_shape[4] = {
+      SizeOfDimension(q_tensor, 0), SizeOfDimension(q_tensor, 2),
+      SizeOfDimension(q_tensor, 1), SizeOfDimension(k_tensor, 1)};
+  const int num_checked_mask_dims = op_data->paged_kv_cache ? 3 : 4;
+  for (int i = 0; i < num_checked_mask_dims; ++i) {
+    const int dim = SizeOfDimension(mask_tensor, i);
+    TF_LITE_ENSURE(context, dim == 1 || dim == broadcast_mask_shape[i]);
   }
 
-  // Temp tensor for Reshape K / Transpose Q;
-  {
-    node->temporaries->data[kReshape1TempTensorIndex] =
-        op_data->scratch_tensor_index + kReshape1TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kReshape1TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size;
-    if (mqa)
-      scratch_buffer_size = TfLiteIntArrayCreate(2);
-    else
-      scratch_buffer_size = TfLiteIntArrayCreate(4);
-    if (mqa) {
-      scratch_buffer_size->data[0] = k_tensor->dims->data[1];
-      scratch_buffer_size->data[1] = k_tensor->dims->data[3];
-    } else {
-      scratch_buffer_size->data[0] = q_tensor->dims->data[0];
-      scratch_buffer_size->data[1] = q_tensor->dims->data[2];
-      scratch_buffer_size->data[2] = q_tensor->dims->data[3];
-      scratch_buffer_size->data[3] = q_tensor->dims->data[1];
-    }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
-
-  // Temp tensor for Reshape V / Add_out (softmax_out);
-  {
-    node->temporaries->data[kReshape2TempTensorIndex] =
-        op_data->scratch_tensor_index + kReshape2TempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(
-        context,
-        GetTemporarySafe(context, node,
-                         /*index=*/kReshape2TempTensorIndex, &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size;
-    if (mqa)
-      scratch_buffer_size = TfLiteIntArrayCreate(2);
-    else
-      scratch_buffer_size = TfLiteIntArrayCreate(4);
-    if (mqa) {
-      scratch_buffer_size->data[0] = v_tensor->dims->data[3];
-      scratch_buffer_size->data[1] = v_tensor->dims->data[1];
-    } else {
-      scratch_buffer_size->data[0] = add_out_shape[0];
-      scratch_buffer_size->data[1] = add_out_shape[1];
-      scratch_buffer_size->data[2] = add_out_shape[3];
-      scratch_buffer_size->data[3] = add_out_shape[2];
-    }
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
+  op_data->scale = scale > 0.0f ? scale : 0.0f;
 
-  // Temp tensor for Broadcast K
-  {
-    node->temporaries->data[kBroadcastKTempTensorIndex] =
-        op_data->scratch_tensor_index + kBroadcastKTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kBroadcastKTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-
-    scratch_buffer_size->data[0] = k_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];  // num_heads
-    scratch_buffer_size->data[2] = k_tensor->dims->data[1];
-    scratch_buffer_size->data[3] = k_tensor->dims->data[3];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
+  // If scale is not set, use sqrt(q_tensor->dims->data[3])
+  if (op_data->scale == 0.0f)
+    op_data->scale = 1 / sqrt(q_tensor->dims->data[3]);
 
-  // Temp tensor for Broadcast V
-  {
-    node->temporaries->data[kBroadcastVTempTensorIndex] =
-        op_data->scratch_tensor_index + kBroadcastVTempTensorIndex;
-    TfLiteTensor* scratch_buffer;
-    TF_LITE_ENSURE_OK(context,
-                      GetTemporarySafe(context, node,
-                                       /*index=*/kBroadcastVTempTensorIndex,
-                                       &scratch_buffer));
-    TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(4);
-
-    scratch_buffer_size->data[0] = v_tensor->dims->data[0];
-    scratch_buffer_size->data[1] = q_tensor->dims->data[2];  // num_heads
-    scratch_buffer_size->data[2] = v_tensor->dims->data[3];
-    scratch_buffer_size->data[3] = v_tensor->dims->data[1];
-
-    scratch_buffer->type = kTfLiteFloat32;
-    scratch_buffer->allocation_type = kTfLiteArenaRw;
-    TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
-                                                     scratch_buffer_size));
-  }
+  // The attention is computed without temporaries.
+  TfLiteIntArrayFree(node->temporaries);
+  node->temporaries = TfLiteIntArrayCreate(0);
 
-  return kTfLiteOk;
+  return context->ResizeTensor(context, output_tensor,
+                               TfLiteIntArrayCopy(q_tensor->dims));
 }
 
 void SDPAFree(TfLiteContext* context, void* buffer) {
@@ -360,7 +337,7 @@ void SDPAFree(TfLiteContext* context, void* buffer) {
 
 TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   /*
-  Simple implementation of Scaled Dot Product Attention.
+  Fused Scaled Dot Product Attention.
   Takes query_proj, key_proj, value_proj, mask tensors as inputs, and
   outputs the attention result.
 
@@ -368,296 +345,119 @@ TfLiteStatus SDPAEval(TfLiteContext* context, TfLiteNode* node) {
   Scale is computed using 1/sqrt(head_dim),
   head_dim = q[-1] = embedding_dim // num_q_heads
   Only support for FLOAT32 inputs for now.
-  Only support static tensors for now (k/v[1] = max sequence length)
+  Keys and values are either the full k/v inputs (k/v[1] = max sequence
+  length), or, with the `paged_kv_cache` option, the blocks of the paged KV
+  cache written by the KV cache op for `layer_index`.
   */
 
   const TfLiteTensor* query_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kQueryTensor, &query_tensor));
-  auto query_shape = GetTensorShape(query_tensor);
-  auto query_data = GetTensorData<float>(query_tensor);
   const TfLiteTensor* key_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kKeyTensor, &key_tensor));
-  auto key_shape = GetTensorShape(key_tensor);
-  auto key_data = GetTensorData<float>(key_tensor);
   const TfLiteTensor* value_tensor;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kValueTensor, &value_tensor));
-  auto value_shape = GetTensorShape(value_tensor);
-  auto value_data = GetTensorData<float>(value_tensor);
   const TfLiteTensor* attention_mask_tensor;
   TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, kAttentionMaskTensor,
                                           &attention_mask_tensor));
-  auto attention_mask_shape = GetTensorShape(attention_mask_tensor);
-  auto attention_mask_data = GetTensorData<float>(attention_mask_tensor);
   TfLiteTensor* output_tensor;
   TF_LITE_ENSURE_OK(
       context, GetOutputSafe(context, node, kOutputTensor, &output_tensor));
-  auto output_shape = GetTensorShape(output_tensor);
-  auto output_data = GetTensorData<float>(output_tensor);
-
-  // temporaries
-  TfLiteTensor* transpose_q_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeQueryTempTensorIndex,
-                       &transpose_q_out_tensor));
-  auto transpose_q_out_shape = GetTensorShape(transpose_q_out_tensor);
-  auto transpose_q_out_data = GetTensorData<float>(transpose_q_out_tensor);
-  TfLiteTensor* transpose_k_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeKeyTempTensorIndex,
-                       &transpose_k_out_tensor));
-  auto transpose_k_out_shape = GetTensorShape(transpose_k_out_tensor);
-  auto transpose_k_out_data = GetTensorData<float>(transpose_k_out_tensor);
-  TfLiteTensor* matmul1_out_tensor;
-  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                              /*index=*/kMatMul1TempTensorIndex,
-                                              &matmul1_out_tensor));
-  auto matmul1_out_shape = GetTensorShape(matmul1_out_tensor);
-  auto matmul1_out_data = GetTensorData<float>(matmul1_out_tensor);
-  TfLiteTensor* add_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context, GetTemporarySafe(context, node, /*index=*/kAddTempTensorIndex,
-                                &add_out_tensor));
-  auto add_out_shape = GetTensorShape(add_out_tensor);
-  auto add_out_data = GetTensorData<float>(add_out_tensor);
-  TfLiteTensor* transpose_v_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kTransposeValueTempTensorIndex,
-                       &transpose_v_out_tensor));
-  auto transpose_v_out_shape = GetTensorShape(transpose_v_out_tensor);
-  auto transpose_v_out_data = GetTensorData<float>(transpose_v_out_tensor);
-  TfLiteTensor* matmul2_out_tensor;
-  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
-                                              /*index=*/kMatMul2TempTensorIndex,
-                                              &matmul2_out_tensor));
-  auto matmul2_out_shape = GetTensorShape(matmul2_out_tensor);
-  auto matmul2_out_data = GetTensorData<float>(matmul2_out_tensor);
-  TfLiteTensor* reshape_k_or_q_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kReshape1TempTensorIndex,
-                       &reshape_k_or_q_out_tensor));
-  auto reshape_k_or_q_out_shape = GetTensorShape(reshape_k_or_q_out_tensor);
-  auto reshape_k_or_q_out_data =
-      GetTensorData<float>(reshape_k_or_q_out_tensor);
-  TfLiteTensor* reshape_v_or_add_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kReshape2TempTensorIndex,
-                       &reshape_v_or_add_out_tensor));
-  auto reshape_v_or_add_out_shape = GetTensorShape(reshape_v_or_add_out_tensor);
-  auto reshape_v_or_add_out_data =
-      GetTensorData<float>(reshape_v_or_add_out_tensor);
-  TfLiteTensor* broadcast_k_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kBroadcastKTempTensorIndex,
-                       &broadcast_k_out_tensor));
-  auto broadcast_k_out_shape = GetTensorShape(broadcast_k_out_tensor);
-  auto broadcast_k_out_data = GetTensorData<float>(broadcast_k_out_tensor);
-  TfLiteTensor* broadcast_v_out_tensor;
-  TF_LITE_ENSURE_OK(
-      context,
-      GetTemporarySafe(context, node, /*index=*/kBroadcastVTempTensorIndex,
-                       &broadcast_v_out_tensor));
-  auto broadcast_v_out_shape = GetTensorShape(broadcast_v_out_tensor);
-  auto broadcast_v_out_data = GetTensorData<float>(broadcast_v_out_tensor);
 
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
 
-  bool mqa = key_tensor->dims->data[2] == 1;
-  bool gqa = !mqa && (key_tensor->dims->data[2] != query_tensor->dims->data[2]);
-
-  // scale * q
-  float scale = op_data->scale;
-  int flat_size = query_shape.FlatSize();
-  float output_min = -std::numeric_limits<float>::infinity();
-  float output_max = std::numeric_limits<float>::infinity();
-  for (int i = 0; i < flat_size; ++i) {
-    query_tensor->data.f[i] = ActivationFunctionWithMinMax(
-        query_tensor->data.f[i] * scale, output_min, output_max);
-  }
-
-  // permute q {0, 2, 1, 3}
-  tflite::TransposeParams transpose_q_params;
-  transpose_q_params.perm_count = 4;
-  transpose_q_params.perm[0] = 0;
-  transpose_q_params.perm[1] = 2;
-  transpose_q_params.perm[2] = 1;
-  transpose_q_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_q_params, query_shape, query_data,
-                           transpose_q_out_shape, transpose_q_out_data);
-
-  // permute k {0, 2, 1, 3}
-  tflite::TransposeParams transpose_k_params;
-  transpose_k_params.perm_count = 4;
-  transpose_k_params.perm[0] = 0;
-  transpose_k_params.perm[1] = 2;
-  transpose_k_params.perm[2] = 1;
-  transpose_k_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_k_params, key_shape, key_data,
-                           transpose_k_out_shape, transpose_k_out_data);
-
-  // broadcast k to match num_heads
-  // broadcasting similar to torch.repeat_interleave
-  if (gqa) {
-    float* transpose_k_ptr = transpose_k_out_data;
-    float* broadcast_k_ptr = broadcast_k_out_data;
-    int num_elements =
-        transpose_k_out_shape.Dims(2) * transpose_k_out_shape.Dims(3);
-    int num_repeat =
-        broadcast_k_out_shape.Dims(1) / transpose_k_out_shape.Dims(1);
-    for (int i = 0; i < transpose_k_out_shape.Dims(0); ++i) {
-      for (int j = 0; j < transpose_k_out_shape.Dims(1); ++j) {
-        for (int k = 0; k < num_repeat; ++k) {
-          memcpy(broadcast_k_ptr, transpose_k_ptr,
-                 num_elements * sizeof(float));
-          broadcast_k_ptr += num_elements;
-        }
-        transpose_k_ptr += num_elements;
-      }
+  AttentionParams params;
+  params.query = GetTensorData<float>(query_tensor);
+  params.mask = GetTensorData<float>(attention_mask_tensor);
+  params.output = GetTensorData<float>(output_tensor);
+  params.batch_size = SizeOfDimension(query_tensor, 0);
+  params.query_seq_len = SizeOfDimension(query_tensor, 1);
+  params.num_heads = SizeOfDimension(query_tensor, 2);
+  params.head_dim = SizeOfDimension(query_tensor, 3);
+  params.num_kv_heads = SizeOfDimension(key_tensor, 2);
+  params.scale = op_data->scale;
+  if (op_data->paged_kv_cache) {
+    Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+    resource::PagedKVCache* cache = nullptr;
+    if (resource::GetPagedKVCache(subgraph->resources(), &cache) !=
+        kTfLiteOk) {
+      TF_LITE_KERNEL_LOG(context, "Resource %d is not a paged KV cache.",
+                         resource::kPagedKVCacheResourceId);
+      return kTfLiteError;
     }
-  }
-
-  // reshape k for MQA, or transpose q for MHA
-  if (mqa) {
-    TF_LITE_ENSURE_EQ(context, transpose_k_out_tensor->bytes,
-                      reshape_k_or_q_out_tensor->bytes);
-    memcpy(reshape_k_or_q_out_tensor->data.data,
-           transpose_k_out_tensor->data.data, transpose_k_out_tensor->bytes);
+    if (cache == nullptr) {
+      TF_LITE_KERNEL_LOG(context,
+                         "SDPA reads the paged KV cache, but no KV cache op "
+                         "has created it.");
+      return kTfLiteError;
+    }
+    TF_LITE_ENSURE_EQ(context, cache->options().num_heads,
+                      params.num_kv_heads);
+    TF_LITE_ENSURE_EQ(context, cache->options().head_dim, params.head_dim);
+    TF_LITE_ENSURE_OK(
+        context, cache->GetBlocks(cache->active_sequence(),
+                                  op_data->layer_index, op_data->key_blocks,
+                                  op_data->value_blocks));
+    params.kv_seq_len = cache->GetSequenceLength(cache->active_sequence());
+    params.kv_block_size = cache->options().block_size;
+    params.num_kv_blocks = op_data->key_blocks.size();
+    const int mask_kv_seq_len = SizeOfDimension(attention_mask_tensor, 3);
+    TF_LITE_ENSURE(context, mask_kv_seq_len == 1 ||
+                                mask_kv_seq_len >= params.kv_seq_len);
   } else {
-    // permute q2 {0, 1, 3, 2}
-    tflite::TransposeParams transpose_q2_params;
-    transpose_q2_params.perm_count = 4;
-    transpose_q2_params.perm[0] = 0;
-    transpose_q2_params.perm[1] = 1;
-    transpose_q2_params.perm[2] = 3;
-    transpose_q2_params.perm[3] = 2;
-    reference_ops::Transpose(transpose_q2_params, transpose_q_out_shape,
-                             transpose_q_out_data, reshape_k_or_q_out_shape,
-                             reshape_k_or_q_out_data);
+    // Each batch of the key and value inputs is a single block.
+    params.kv_seq_len = SizeOfDimension(key_tensor, 1);
+    params.kv_block_size = std::max(params.kv_seq_len, 1);
+    params.num_kv_blocks = 1;
+    op_data->key_blocks.clear();
+    op_data->value_blocks.clear();
+    const int batch_stride =
+        params.kv_seq_len * params.num_kv_heads * params.head_dim;
+    for (int b = 0; b < params.batch_size; ++b) {
+      op_data->key_blocks.push_back(GetTensorData<float>(key_tensor) +
+                                    b * batch_stride);
+      op_data->value_blocks.push_back(GetTensorData<float>(value_tensor) +
+                                      b * batch_stride);
+    }
   }
-
-  // mqa FC (q, squeezed_k)
-  // mha BMM(q, k) transpose_b = true
-  if (mqa) {
-    tflite::FullyConnectedParams fc_params;
-    fc_params.float_activation_min = output_min;
-    fc_params.float_activation_max = output_max;
-    reference_ops::FullyConnected(
-        fc_params, transpose_q_out_shape, transpose_q_out_data,
-        reshape_k_or_q_out_shape, reshape_k_or_q_out_data, RuntimeShape(),
-        nullptr, matmul1_out_shape, matmul1_out_data);
-  } else if (gqa) {
-    // pass rhs first (this is why we transpose q above)
-    reference_ops::BatchMatMul(
-        broadcast_k_out_shape, broadcast_k_out_data, reshape_k_or_q_out_shape,
-        reshape_k_or_q_out_data, matmul1_out_shape, matmul1_out_data);
-  } else {
-    reference_ops::BatchMatMul(
-        transpose_k_out_shape, transpose_k_out_data, reshape_k_or_q_out_shape,
-        reshape_k_or_q_out_data, matmul1_out_shape, matmul1_out_data);
+  params.key_blocks = op_data->key_blocks.data();
+  params.value_blocks = op_data->value_blocks.data();
+  int mask_stride = 1;
+  for (int i = 3; i >= 0; --i) {
+    const int dim = SizeOfDimension(attention_mask_tensor, i);
+    params.mask_strides[i] = dim == 1 ? 0 : mask_stride;
+    mask_stride *= dim;
   }
 
-  // add matmul_out + mask
-  tflite::ArithmeticParams add_params;
-  SetActivationParams(output_min, output_max, &add_params);
-  reference_ops::BroadcastAdd6DSlow(
-      add_params, attention_mask_shape, attention_mask_data, matmul1_out_shape,
-      matmul1_out_data, add_out_shape, add_out_data);
-
-  // softmax, can do in-place
-  tflite::SoftmaxParams softmax_params;
-  softmax_params.beta = 1.0f;
-  reference_ops::Softmax(softmax_params, add_out_shape, add_out_data,
-                         add_out_shape, add_out_data);
-
-  // permute v {0, 2, 3, 1}
-  tflite::TransposeParams transpose_v_params;
-  transpose_v_params.perm_count = 4;
-  transpose_v_params.perm[0] = 0;
-  transpose_v_params.perm[1] = 2;
-  transpose_v_params.perm[2] = 3;
-  transpose_v_params.perm[3] = 1;
-  reference_ops::Transpose(transpose_v_params, value_shape, value_data,
-                           transpose_v_out_shape, transpose_v_out_data);
-
-  // broadcast v to match num_heads
-  // broadcasting similar to torch.repeat_interleave
-  if (gqa) {
-    float* transpose_v_ptr = transpose_v_out_data;
-    float* broadcast_v_ptr = broadcast_v_out_data;
-    int num_elements =
-        transpose_v_out_shape.Dims(2) * transpose_v_out_shape.Dims(3);
-    int num_repeat =
-        broadcast_v_out_shape.Dims(1) / transpose_v_out_shape.Dims(1);
-    for (int i = 0; i < transpose_v_out_shape.Dims(0); ++i) {
-      for (int j = 0; j < transpose_v_out_shape.Dims(1); ++j) {
-        for (int k = 0; k < num_repeat; ++k) {
-          memcpy(broadcast_v_ptr, transpose_v_ptr,
-                 num_elements * sizeof(float));
-          broadcast_v_ptr += num_elements;
-        }
-        transpose_v_ptr += num_elements;
-      }
-    }
+  const int num_work_units = params.num_work_units();
+  if (num_work_units == 0 || params.kv_seq_len == 0) {
+    std::fill_n(params.output, NumElements(output_tensor), 0.0f);
+    return kTfLiteOk;
   }
 
-  // reshape v for MQA, or add_out (softmax_out)
-  if (mqa) {
-    TF_LITE_ENSURE_EQ(context, transpose_v_out_tensor->bytes,
-                      reshape_v_or_add_out_tensor->bytes);
-    memcpy(reshape_v_or_add_out_tensor->data.data,
-           transpose_v_out_tensor->data.data, transpose_v_out_tensor->bytes);
-  } else {
-    // permute softmax_out {0, 1, 3, 2}
-    tflite::TransposeParams transpose_softmax_out_params;
-    transpose_softmax_out_params.perm_count = 4;
-    transpose_softmax_out_params.perm[0] = 0;
-    transpose_softmax_out_params.perm[1] = 1;
-    transpose_softmax_out_params.perm[2] = 3;
-    transpose_softmax_out_params.perm[3] = 2;
-    reference_ops::Transpose(transpose_softmax_out_params, add_out_shape,
-                             add_out_data, reshape_v_or_add_out_shape,
-                             reshape_v_or_add_out_data);
+  // Distributes the query blocks of all heads over the threads.
+  CpuBackendContext* cpu_backend_context =
+      CpuBackendContext::GetFromContext(context);
+  const int thread_count =
+      std::max(1, std::min(cpu_backend_context->max_num_threads(),
+                           num_work_units));
+  if (thread_count == 1) {
+    ComputeWorkUnits(params, 0, num_work_units);
+    return kTfLiteOk;
   }
-
-  // mqa FC (softmax_out, squeezed_v)
-  // mha BMM(softmax_out, v) transpose_b = true
-  if (mqa) {
-    tflite::FullyConnectedParams fc_params;
-    fc_params.float_activation_min = output_min;
-    fc_params.float_activation_max = output_max;
-    reference_ops::FullyConnected(fc_params, add_out_shape, add_out_data,
-                                  reshape_v_or_add_out_shape,
-                                  reshape_v_or_add_out_data, RuntimeShape(),
-                                  nullptr, matmul2_out_shape, matmul2_out_data);
-  } else if (gqa) {
-    // pass rhs first (this is why we transpose add_out above)
-    reference_ops::BatchMatMul(
-        broadcast_v_out_shape, broadcast_v_out_data, reshape_v_or_add_out_shape,
-        reshape_v_or_add_out_data, matmul2_out_shape, matmul2_out_data);
-  } else {
-    reference_ops::BatchMatMul(
-        transpose_v_out_shape, transpose_v_out_data, reshape_v_or_add_out_shape,
-        reshape_v_or_add_out_data, matmul2_out_shape, matmul2_out_data);
+  std::vector<AttentionTask> tasks;
+  tasks.reserve(thread_count);
+  int unit_begin = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int unit_end = unit_begin + num_work_units / thread_count;
+    if (i < num_work_units % thread_count) unit_end++;
+    tasks.emplace_back(params, unit_begin, unit_end);
+    unit_begin = unit_end;
   }
-
-  // permute out {0, 2, 1, 3}
-  tflite::TransposeParams transpose_out_params;
-  transpose_out_params.perm_count = 4;
-  transpose_out_params.perm[0] = 0;
-  transpose_out_params.perm[1] = 2;
-  transpose_out_params.perm[2] = 1;
-  transpose_out_params.perm[3] = 3;
-  reference_ops::Transpose(transpose_out_params, matmul2_out_shape,
-                           matmul2_out_data, output_shape, output_data);
-
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
   return kTfLiteOk;
 }
 
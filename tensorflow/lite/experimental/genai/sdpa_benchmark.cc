@@ -0,0 +1,124 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks the SDPA op across sequence lengths, for decoding (one query row
+// attending to the whole KV cache) and prefill (causal self-attention).
+//
+// bazel run -c opt //tensorflow/lite/experimental/genai:sdpa_benchmark
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+constexpr int kNumHeads = 8;
+constexpr int kNumKVHeads = 2;
+constexpr int kHeadDim = 64;
+
+class SDPAOpModel : public SingleOpModel {
+ public:
+  SDPAOpModel(int query_seq_len, int kv_seq_len, int num_threads) {
+    const std::vector<int> query_shape = {1, query_seq_len, kNumHeads,
+                                          kHeadDim};
+    const std::vector<int> kv_shape = {1, kv_seq_len, kNumKVHeads, kHeadDim};
+    const std::vector<int> mask_shape = {1, 1, query_seq_len, kv_seq_len};
+    query_ = AddInput({TensorType_FLOAT32, query_shape});
+    key_ = AddInput({TensorType_FLOAT32, kv_shape});
+    value_ = AddInput({TensorType_FLOAT32, kv_shape});
+    mask_ = AddInput({TensorType_FLOAT32, mask_shape});
+    AddOutput({TensorType_FLOAT32, {}});
+
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() { fbb.Float("scale", 0.0f); });
+    fbb.Finish();
+    SetCustomOp("SDPA", fbb.GetBuffer(), ops::custom::Register_SDPA);
+    BuildInterpreter({query_shape, kv_shape, kv_shape, mask_shape},
+                     num_threads, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false);
+
+    PopulateTensor(query_, std::vector<float>(
+                               query_seq_len * kNumHeads * kHeadDim, 0.1f));
+    PopulateTensor(
+        key_, std::vector<float>(kv_seq_len * kNumKVHeads * kHeadDim, 0.2f));
+    PopulateTensor(
+        value_, std::vector<float>(kv_seq_len * kNumKVHeads * kHeadDim, 0.3f));
+    // Causal mask: query row `t` attends to the first
+    // `kv_seq_len - query_seq_len + t + 1` keys.
+    std::vector<float> mask(query_seq_len * kv_seq_len);
+    for (int t = 0; t < query_seq_len; ++t) {
+      for (int s = 0; s < kv_seq_len; ++s) {
+        mask[t * kv_seq_len + s] =
+            s <= kv_seq_len - query_seq_len + t
+                ? 0.0f
+                : -std::numeric_limits<float>::infinity();
+      }
+    }
+    PopulateTensor(mask_, mask);
+  }
+
+ private:
+  int query_;
+  int key_;
+  int value_;
+  int mask_;
+};
+
+void BM_SDPADecode(benchmark::State& state) {
+  const int kv_seq_len = state.range(0);
+  const int num_threads = state.range(1);
+  SDPAOpModel model(/*query_seq_len=*/1, kv_seq_len, num_threads);
+  for (auto _ : state) {
+    if (model.Invoke() != kTfLiteOk) {
+      state.SkipWithError("Failed to invoke SDPA.");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kv_seq_len);
+}
+
+void BM_SDPAPrefill(benchmark::State& state) {
+  const int seq_len = state.range(0);
+  const int num_threads = state.range(1);
+  SDPAOpModel model(seq_len, seq_len, num_threads);
+  for (auto _ : state) {
+    if (model.Invoke() != kTfLiteOk) {
+      state.SkipWithError("Failed to invoke SDPA.");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * seq_len);
+}
+
+BENCHMARK(BM_SDPADecode)
+    ->ArgNames({"kv_seq_len", "threads"})
+    ->ArgsProduct({{256, 1024, 4096, 16384}, {1, 4}});
+
+BENCHMARK(BM_SDPAPrefill)
+    ->ArgNames({"seq_len", "threads"})
+    ->ArgsProduct({{128, 512, 2048}, {1, 4}});
+
+}  // namespace
+}  // namespace tflite
+
+BENCHMARK_MAIN();
@@ -0,0 +1,383 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/experimental/resource/paged_kv_cache.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::Each;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+class SDPAOpModel : public SingleOpModel {
+ public:
+  // `query_shape` is [batch, query_seq_len, num_heads, head_dim] and
+  // `kv_shape` is [batch, kv_seq_len, num_kv_heads, head_dim]. With
+  // `paged_kv_cache`, keys and values of `layer_index` are read from the paged
+  // KV cache instead, and `kv_shape` is [1, 0, num_kv_heads, head_dim].
+  SDPAOpModel(const std::vector<int>& query_shape,
+              const std::vector<int>& kv_shape,
+              const std::vector<int>& mask_shape, float scale = 0.0f,
+              int num_threads = 1, bool paged_kv_cache = false,
+              int layer_index = 0) {
+    query_ = AddInput({TensorType_FLOAT32, query_shape});
+    key_ = AddInput({TensorType_FLOAT32, kv_shape});
+    value_ = AddInput({TensorType_FLOAT32, kv_shape});
+    mask_ = AddInput({TensorType_FLOAT32, mask_shape});
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() {
+      fbb.Float("scale", scale);
+      fbb.Bool("paged_kv_cache", paged_kv_cache);
+      fbb.Int("layer_index", layer_index);
+    });
+    fbb.Finish();
+    SetCustomOp("SDPA", fbb.GetBuffer(), ops::custom::Register_SDPA);
+    BuildInterpreter({query_shape, kv_shape, kv_shape, mask_shape},
+                     num_threads, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false);
+  }
+
+  // Adds the paged KV cache that the KV cache op would create.
+  resource::PagedKVCache* AddPagedKVCache(
+      const resource::PagedKVCache::Options& options) {
+    auto* cache = new resource::PagedKVCache(options);
+    interpreter_->primary_subgraph().resources().emplace(
+        resource::kPagedKVCacheResourceId, cache);
+    return cache;
+  }
+
+  void SetQuery(const std::vector<float>& data) {
+    PopulateTensor(query_, data);
+  }
+  void SetKey(const std::vector<float>& data) { PopulateTensor(key_, data); }
+  void SetValue(const std::vector<float>& data) {
+    PopulateTensor(value_, data);
+  }
+  void SetMask(const std::vector<float>& data) { PopulateTensor(mask_, data); }
+
+  std::vector<float> GetQuery() { return ExtractVector<float>(query_); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  int query_;
+  int key_;
+  int value_;
+  int mask_;
+  int output_;
+};
+
+std::vector<float> RandomVector(int size, std::mt19937& generator) {
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  std::vector<float> result(size);
+  for (float& x : result) {
+    x = distribution(generator);
+  }
+  return result;
+}
+
+int NumElements(const std::vector<int>& shape) {
+  int result = 1;
+  for (int dim : shape) {
+    result *= dim;
+  }
+  return result;
+}
+
+// Straightforward attention with a materialized score matrix. Query heads use
+// key and value head `head / (num_heads / num_kv_heads)`, like
+// `torch.repeat_interleave`.
+std::vector<float> ReferenceAttention(
+    const std::vector<int>& query_shape, const std::vector<int>& kv_shape,
+    const std::vector<int>& mask_shape, const std::vector<float>& query,
+    const std::vector<float>& key, const std::vector<float>& value,
+    const std::vector<float>& mask, float scale) {
+  const int batch_size = query_shape[0];
+  const int query_seq_len = query_shape[1];
+  const int num_heads = query_shape[2];
+  const int head_dim = query_shape[3];
+  const int kv_seq_len = kv_shape[1];
+  const int num_kv_heads = kv_shape[2];
+  auto mask_at = [&](int b, int h, int t, int s) {
+    const int indices[4] = {b, h, t, s};
+    int index = 0;
+    for (int i = 0; i < 4; ++i) {
+      index = index * mask_shape[i] + (mask_shape[i] == 1 ? 0 : indices[i]);
+    }
+    return mask[index];
+  };
+
+  std::vector<float> output(query.size(), 0.0f);
+  std::vector<float> scores(kv_seq_len);
+  for (int b = 0; b < batch_size; ++b) {
+    for (int h = 0; h < num_heads; ++h) {
+      const int kv_h = h / (num_heads / num_kv_heads);
+      for (int t = 0; t < query_seq_len; ++t) {
+        const float* q =
+            &query[((b * query_seq_len + t) * num_heads + h) * head_dim];
+        float max_score = -std::numeric_limits<float>::infinity();
+        for (int s = 0; s < kv_seq_len; ++s) {
+          const float* k =
+              &key[((b * kv_seq_len + s) * num_kv_heads + kv_h) * head_dim];
+          float dot = 0.0f;
+          for (int d = 0; d < head_dim; ++d) {
+            dot += q[d] * k[d];
+          }
+          scores[s] = dot * scale + mask_at(b, h, t, s);
+          max_score = std::max(max_score, scores[s]);
+        }
+        float sum = 0.0f;
+        for (int s = 0; s < kv_seq_len; ++s) {
+          scores[s] = std::exp(scores[s] - max_score);
+          sum += scores[s];
+        }
+        float* out =
+            &output[((b * query_seq_len + t) * num_heads + h) * head_dim];
+        for (int s = 0; s < kv_seq_len; ++s) {
+          const float* v =
+              &value[((b * kv_seq_len + s) * num_kv_heads + kv_h) * head_dim];
+          for (int d = 0; d < head_dim; ++d) {
+            out[d] += scores[s] / sum * v[d];
+          }
+        }
+      }
+    }
+  }
+  return output;
+}
+
+// Lower triangular mask where query row `t` attends to the first
+// `kv_seq_len - query_seq_len + t + 1` keys.
+std::vector<float> CausalMask(int query_seq_len, int kv_seq_len) {
+  std::vector<float> mask(query_seq_len * kv_seq_len);
+  for (int t = 0; t < query_seq_len; ++t) {
+    for (int s = 0; s < kv_seq_len; ++s) {
+      mask[t * kv_seq_len + s] = s <= kv_seq_len - query_seq_len + t
+                                     ? 0.0f
+                                     : -std::numeric_limits<float>::infinity();
+    }
+  }
+  return mask;
+}
+
+void TestAttention(const std::vector<int>& query_shape,
+                   const std::vector<int>& kv_shape,
+                   const std::vector<int>& mask_shape,
+                   const std::vector<float>& mask, int num_threads = 1) {
+  std::mt19937 generator(/*seed=*/42);
+  const std::vector<float> query =
+      RandomVector(NumElements(query_shape), generator);
+  const std::vector<float> key = RandomVector(NumElements(kv_shape), generator);
+  const std::vector<float> value =
+      RandomVector(NumElements(kv_shape), generator);
+  const float scale = 1.0f / std::sqrt(static_cast<float>(query_shape[3]));
+
+  SDPAOpModel model(query_shape, kv_shape, mask_shape, /*scale=*/0.0f,
+                    num_threads);
+  model.SetQuery(query);
+  model.SetKey(key);
+  model.SetValue(value);
+  model.SetMask(mask);
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_EQ(model.GetOutputShape(), query_shape);
+  EXPECT_THAT(model.GetOutput(),
+              Pointwise(FloatNear(1e-5),
+                        ReferenceAttention(query_shape, kv_shape, mask_shape,
+                                           query, key, value, mask, scale)));
+}
+
+TEST(SDPAOpTest, MultiHeadAttention) {
+  TestAttention(/*query_shape=*/{1, 4, 2, 8}, /*kv_shape=*/{1, 16, 2, 8},
+                /*mask_shape=*/{1, 1, 4, 16},
+                std::vector<float>(4 * 16, 0.0f));
+}
+
+TEST(SDPAOpTest, GroupedQueryAttention) {
+  TestAttention(/*query_shape=*/{1, 4, 4, 8}, /*kv_shape=*/{1, 16, 2, 8},
+                /*mask_shape=*/{1, 1, 4, 16}, CausalMask(4, 16));
+}
+
+TEST(SDPAOpTest, MultiQueryAttention) {
+  TestAttention(/*query_shape=*/{1, 4, 4, 8}, /*kv_shape=*/{1, 16, 1, 8},
+                /*mask_shape=*/{1, 1, 4, 16}, CausalMask(4, 16));
+}
+
+TEST(SDPAOpTest, Decode) {
+  TestAttention(/*query_shape=*/{1, 1, 8, 16}, /*kv_shape=*/{1, 200, 2, 16},
+                /*mask_shape=*/{1, 1, 1, 200}, CausalMask(1, 200));
+}
+
+TEST(SDPAOpTest, LongSequenceSpansBlocks) {
+  TestAttention(/*query_shape=*/{1, 21, 4, 16}, /*kv_shape=*/{1, 300, 2, 16},
+                /*mask_shape=*/{1, 1, 21, 300}, CausalMask(21, 300));
+}
+
+TEST(SDPAOpTest, Multithreaded) {
+  TestAttention(/*query_shape=*/{1, 21, 4, 16}, /*kv_shape=*/{1, 300, 2, 16},
+                /*mask_shape=*/{1, 1, 21, 300}, CausalMask(21, 300),
+                /*num_threads=*/4);
+}
+
+TEST(SDPAOpTest, BatchAndHeadMask) {
+  std::mt19937 generator(/*seed=*/7);
+  TestAttention(/*query_shape=*/{2, 3, 4, 8}, /*kv_shape=*/{2, 70, 2, 8},
+                /*mask_shape=*/{2, 4, 3, 70},
+                RandomVector(2 * 4 * 3 * 70, generator));
+}
+
+TEST(SDPAOpTest, FullyMaskedRowsAreZero) {
+  const std::vector<int> query_shape = {1, 2, 2, 4};
+  SDPAOpModel model(query_shape, /*kv_shape=*/{1, 8, 2, 4},
+                    /*mask_shape=*/{1, 1, 2, 8});
+  model.SetQuery(std::vector<float>(NumElements(query_shape), 1.0f));
+  model.SetKey(std::vector<float>(8 * 2 * 4, 1.0f));
+  model.SetValue(std::vector<float>(8 * 2 * 4, 1.0f));
+  model.SetMask(
+      std::vector<float>(2 * 8, -std::numeric_limits<float>::infinity()));
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_THAT(model.GetOutput(), Each(0.0f));
+}
+
+TEST(SDPAOpTest, DoesNotModifyInputs) {
+  const std::vector<int> query_shape = {1, 2, 2, 4};
+  SDPAOpModel model(query_shape, /*kv_shape=*/{1, 8, 2, 4},
+                    /*mask_shape=*/{1, 1, 2, 8}, /*scale=*/0.5f);
+  std::mt19937 generator(/*seed=*/1);
+  const std::vector<float> query =
+      RandomVector(NumElements(query_shape), generator);
+  model.SetQuery(query);
+  model.SetKey(RandomVector(8 * 2 * 4, generator));
+  model.SetValue(RandomVector(8 * 2 * 4, generator));
+  model.SetMask(std::vector<float>(2 * 8, 0.0f));
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  const std::vector<float> output = model.GetOutput();
+  EXPECT_EQ(model.GetQuery(), query);
+
+  // Invoking again produces the same result.
+  ASSERT_EQ(model.Invoke(), kTfLiteOk);
+  EXPECT_EQ(model.GetOutput(), output);
+}
+
+TEST(SDPAOpTest, PagedKVCacheMissing) {
+  SDPAOpModel model(/*query_shape=*/{1, 1, 2, 4}, /*kv_shape=*/{1, 0, 2, 4},
+                    /*mask_shape=*/{1, 1, 1, 16}, /*scale=*/0.0f,
+                    /*num_threads=*/1, /*paged_kv_cache=*/true);
+  EXPECT_EQ(model.Invoke(), kTfLiteError);
+}
+
+// Decodes many sequences which share a prompt through the paged KV cache, and
+// compares the attention of each with a contiguous copy of its keys and
+// values.
+TEST(SDPAOpTest, PagedKVCacheWithSharedPrefix) {
+  constexpr int kNumHeads = 4;
+  constexpr int kNumKVHeads = 2;
+  constexpr int kHeadDim = 8;
+  constexpr int kQuerySeqLen = 3;
+  constexpr int kMaxSeqLen = 160;
+  constexpr int kPromptLength = 37;
+  constexpr int kNumSequences = 8;
+  constexpr int kLayer = 1;
+  constexpr int kEntrySize = kNumKVHeads * kHeadDim;
+  const std::vector<int> query_shape = {1, kQuerySeqLen, kNumHeads, kHeadDim};
+  const std::vector<int> mask_shape = {1, 1, kQuerySeqLen, kMaxSeqLen};
+  SDPAOpModel model(query_shape, /*kv_shape=*/{1, 0, kNumKVHeads, kHeadDim},
+                    mask_shape, /*scale=*/0.0f, /*num_threads=*/2,
+                    /*paged_kv_cache=*/true, /*layer_index=*/kLayer);
+
+  resource::PagedKVCache::Options options;
+  options.num_layers = 2;
+  options.num_heads = kNumKVHeads;
+  options.head_dim = kHeadDim;
+  options.block_size = 16;
+  resource::PagedKVCache* cache = model.AddPagedKVCache(options);
+
+  // Keys and values of each sequence, as the contiguous reference reads them.
+  std::mt19937 generator(/*seed=*/3);
+  std::vector<std::vector<float>> keys(kNumSequences + 1);
+  std::vector<std::vector<float>> values(kNumSequences + 1);
+  auto append = [&](int sequence, int num_tokens) {
+    const int position = cache->GetSequenceLength(sequence);
+    const std::vector<float> key =
+        RandomVector(num_tokens * kEntrySize, generator);
+    const std::vector<float> value =
+        RandomVector(num_tokens * kEntrySize, generator);
+    // The other layer holds different data, which must not be read.
+    const std::vector<float> other =
+        RandomVector(num_tokens * kEntrySize, generator);
+    ASSERT_EQ(cache->Write(sequence, 1 - kLayer, position, num_tokens,
+                           other.data(), other.data()),
+              kTfLiteOk);
+    ASSERT_EQ(cache->Write(sequence, kLayer, position, num_tokens, key.data(),
+                           value.data()),
+              kTfLiteOk);
+    keys[sequence].insert(keys[sequence].end(), key.begin(), key.end());
+    values[sequence].insert(values[sequence].end(), value.begin(),
+                            value.end());
+  };
+  append(/*sequence=*/0, kPromptLength);
+  for (int i = 1; i <= kNumSequences; ++i) {
+    ASSERT_EQ(cache->ForkSequence(0, i), kTfLiteOk);
+    keys[i] = keys[0];
+    values[i] = values[0];
+    append(i, /*num_tokens=*/i * 11);
+  }
+
+  for (int i = 1; i <= kNumSequences; ++i) {
+    ASSERT_EQ(cache->SetActiveSequence(i), kTfLiteOk);
+    const int kv_seq_len = cache->GetSequenceLength(i);
+    const std::vector<float> query =
+        RandomVector(NumElements(query_shape), generator);
+    const std::vector<float> mask = CausalMask(kQuerySeqLen, kv_seq_len);
+    // Positions past the sequence length are not read.
+    std::vector<float> padded_mask(kQuerySeqLen * kMaxSeqLen,
+                                   std::numeric_limits<float>::quiet_NaN());
+    for (int t = 0; t < kQuerySeqLen; ++t) {
+      std::copy_n(&mask[t * kv_seq_len], kv_seq_len,
+                  &padded_mask[t * kMaxSeqLen]);
+    }
+    model.SetQuery(query);
+    model.SetMask(padded_mask);
+    ASSERT_EQ(model.Invoke(), kTfLiteOk);
+
+    const std::vector<int> kv_shape = {1, kv_seq_len, kNumKVHeads, kHeadDim};
+    EXPECT_THAT(
+        model.GetOutput(),
+        Pointwise(FloatNear(1e-5),
+                  ReferenceAttention(
+                      query_shape, kv_shape, {1, 1, kQuerySeqLen, kv_seq_len},
+                      query, keys[i], values[i], mask,
+                      1.0f / std::sqrt(static_cast<float>(kHeadDim)))));
+  }
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,255 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/resource/paged_kv_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/kernels/internal/compatibility.h"
+
+namespace tflite {
+namespace resource {
+
+PagedKVCache::PagedKVCache(const Options& options)
+    : options_(options),
+      layer_block_size_(static_cast<size_t>(options.block_size) *
+                        options.num_heads * options.head_dim) {
+  TFLITE_DCHECK_GT(options.block_size, 0);
+  sequences_[0] = Sequence();
+}
+
+size_t PagedKVCache::GetMemoryUsage() {
+  size_t num_allocated_blocks = 0;
+  for (const auto& block : blocks_) {
+    if (block != nullptr) {
+      ++num_allocated_blocks;
+    }
+  }
+  return num_allocated_blocks * options_.num_layers * 2 * layer_block_size_ *
+         sizeof(float);
+}
+
+TfLiteStatus PagedKVCache::CreateSequence(int sequence_id) {
+  if (sequences_.count(sequence_id) > 0) {
+    return kTfLiteError;
+  }
+  sequences_[sequence_id] = Sequence();
+  return kTfLiteOk;
+}
+
+TfLiteStatus PagedKVCache::ForkSequence(int parent_id, int child_id) {
+  auto parent = sequences_.find(parent_id);
+  if (parent == sequences_.end() || sequences_.count(child_id) > 0) {
+    return kTfLiteError;
+  }
+  for (int block : parent->second.block_table) {
+    ++ref_counts_[block];
+  }
+  Sequence child = parent->second;
+  sequences_[child_id] = std::move(child);
+  return kTfLiteOk;
+}
+
+TfLiteStatus PagedKVCache::RemoveSequence(int sequence_id) {
+  auto it = sequences_.find(sequence_id);
+  if (it == sequences_.end()) {
+    return kTfLiteError;
+  }
+  for (int block : it->second.block_table) {
+    ReleaseBlock(block);
+  }
+  sequences_.erase(it);
+  return kTfLiteOk;
+}
+
+TfLiteStatus PagedKVCache::TruncateSequence(int sequence_id, int num_tokens) {
+  auto it = sequences_.find(sequence_id);
+  if (it == sequences_.end() || num_tokens < 0) {
+    return kTfLiteError;
+  }
+  Sequence& sequence = it->second;
+  sequence.num_tokens = std::min(sequence.num_tokens, num_tokens);
+  const size_t num_blocks =
+      (sequence.num_tokens + options_.block_size - 1) / options_.block_size;
+  while (sequence.block_table.size() > num_blocks) {
+    ReleaseBlock(sequence.block_table.back());
+    sequence.block_table.pop_back();
+  }
+  return kTfLiteOk;
+}
+
+void PagedKVCache::Compact() {
+  for (int block : free_blocks_) {
+    blocks_[block].reset();
+  }
+}
+
+bool PagedKVCache::HasSequence(int sequence_id) const {
+  return sequences_.count(sequence_id) > 0;
+}
+
+int PagedKVCache::GetSequenceLength(int sequence_id) const {
+  auto it = sequences_.find(sequence_id);
+  return it == sequences_.end() ? -1 : it->second.num_tokens;
+}
+
+TfLiteStatus PagedKVCache::SetActiveSequence(int sequence_id) {
+  if (!HasSequence(sequence_id)) {
+    return kTfLiteError;
+  }
+  active_sequence_ = sequence_id;
+  return kTfLiteOk;
+}
+
+TfLiteStatus PagedKVCache::Write(int sequence_id, int layer, int position,
+                                 int num_tokens, const float* key,
+                                 const float* value) {
+  auto it = sequences_.find(sequence_id);
+  if (it == sequences_.end() || layer < 0 || layer >= options_.num_layers ||
+      position < 0 || num_tokens < 0) {
+    return kTfLiteError;
+  }
+  Sequence& sequence = it->second;
+  const size_t entry_size =
+      static_cast<size_t>(options_.num_heads) * options_.head_dim;
+  int written = 0;
+  while (written < num_tokens) {
+    const int block_index = (position + written) / options_.block_size;
+    const int block_offset = (position + written) % options_.block_size;
+    const int run =
+        std::min(num_tokens - written, options_.block_size - block_offset);
+    int block = -1;
+    TF_LITE_ENSURE_STATUS(GetWritableBlock(sequence, block_index, block));
+    memcpy(BlockData(block, layer, /*is_value=*/false) +
+               block_offset * entry_size,
+           key + written * entry_size, run * entry_size * sizeof(float));
+    memcpy(BlockData(block, layer, /*is_value=*/true) +
+               block_offset * entry_size,
+           value + written * entry_size, run * entry_size * sizeof(float));
+    written += run;
+  }
+  sequence.num_tokens = std::max(sequence.num_tokens, position + num_tokens);
+  return kTfLiteOk;
+}
+
+TfLiteStatus PagedKVCache::GetBlocks(
+    int sequence_id, int layer, std::vector<const float*>& key_blocks,
+    std::vector<const float*>& value_blocks) const {
+  auto it = sequences_.find(sequence_id);
+  if (it == sequences_.end() || layer < 0 || layer >= options_.num_layers) {
+    return kTfLiteError;
+  }
+  const Sequence& sequence = it->second;
+  const size_t num_blocks =
+      (sequence.num_tokens + options_.block_size - 1) / options_.block_size;
+  key_blocks.clear();
+  value_blocks.clear();
+  for (size_t i = 0; i < num_blocks; ++i) {
+    const int block = sequence.block_table[i];
+    key_blocks.push_back(BlockData(block, layer, /*is_value=*/false));
+    value_blocks.push_back(BlockData(block, layer, /*is_value=*/true));
+  }
+  return kTfLiteOk;
+}
+
+int PagedKVCache::num_used_blocks() const {
+  return ref_counts_.size() - free_blocks_.size();
+}
+
+TfLiteStatus PagedKVCache::GetWritableBlock(Sequence& sequence,
+                                            int block_index, int& block) {
+  while (static_cast<int>(sequence.block_table.size()) <= block_index) {
+    const int new_block = AllocateBlock();
+    if (new_block < 0) {
+      return kTfLiteError;
+    }
+    // Positions that have not been written yet read as zeros.
+    memset(blocks_[new_block].get(), 0,
+           options_.num_layers * 2 * layer_block_size_ * sizeof(float));
+    sequence.block_table.push_back(new_block);
+  }
+
+  block = sequence.block_table[block_index];
+  if (ref_counts_[block] > 1) {
+    // Copies the block shared with other sequences before it is modified.
+    const int new_block = AllocateBlock();
+    if (new_block < 0) {
+      return kTfLiteError;
+    }
+    memcpy(blocks_[new_block].get(), blocks_[block].get(),
+           options_.num_layers * 2 * layer_block_size_ * sizeof(float));
+    --ref_counts_[block];
+    sequence.block_table[block_index] = new_block;
+    block = new_block;
+  }
+  return kTfLiteOk;
+}
+
+int PagedKVCache::AllocateBlock() {
+  int block;
+  if (!free_blocks_.empty()) {
+    block = free_blocks_.back();
+    free_blocks_.pop_back();
+  } else if (options_.max_num_blocks == 0 ||
+             static_cast<int>(blocks_.size()) < options_.max_num_blocks) {
+    block = blocks_.size();
+    blocks_.emplace_back();
+    ref_counts_.push_back(0);
+  } else {
+    return -1;
+  }
+  if (blocks_[block] == nullptr) {
+    blocks_[block].reset(
+        new float[options_.num_layers * 2 * layer_block_size_]);
+  }
+  ref_counts_[block] = 1;
+  return block;
+}
+
+void PagedKVCache::ReleaseBlock(int block) {
+  TFLITE_DCHECK_GT(ref_counts_[block], 0);
+  if (--ref_counts_[block] == 0) {
+    free_blocks_.push_back(block);
+  }
+}
+
+float* PagedKVCache::BlockData(int block, int layer, bool is_value) const {
+  return blocks_[block].get() + (2 * layer + (is_value ? 1 : 0)) *
+                                    layer_block_size_;
+}
+
+TfLiteStatus GetPagedKVCache(ResourceMap& resources, PagedKVCache** cache) {
+  *cache = nullptr;
+  auto it = resources.find(kPagedKVCacheResourceId);
+  if (it == resources.end()) {
+    return kTfLiteOk;
+  }
+  if (it->second->GetKind() != ResourceKind::kPagedKVCache) {
+    return kTfLiteError;
+  }
+  *cache = static_cast<PagedKVCache*>(it->second.get());
+  return kTfLiteOk;
+}
+
+}  // namespace resource
+}  // namespace tflite
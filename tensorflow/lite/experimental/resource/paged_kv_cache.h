@@ -0,0 +1,168 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_KV_CACHE_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_KV_CACHE_H_
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+
+namespace tflite {
+namespace resource {
+
+/// WARNING: Experimental interface, subject to change.
+// A paged cache for the keys and values of transformer attention in
+// autoregressive decode. Unlike `CacheBuffer`, which reserves the maximum
+// sequence length up front, keys and values are stored in fixed-size blocks of
+// `block_size` positions that are allocated on demand from a shared pool. Each
+// sequence maps its positions to blocks through a block table, so memory grows
+// with the number of cached tokens, and many sequences can share one pool.
+//
+// Sequences can share blocks: `ForkSequence` makes a new sequence reference
+// the blocks of an existing one, e.g. for a common prompt prefix or for beams
+// in beam search. Shared blocks are copied before they are written
+// (copy-on-write).
+//
+// A block holds the keys and values of all layers, laid out as
+// [num_layers, 2 (key and value), block_size, num_heads, head_dim].
+//
+// The cache is not thread-safe.
+class PagedKVCache : public ResourceBase {
+ public:
+  struct Options {
+    int num_layers = 1;
+    // Number of key and value heads.
+    int num_heads = 1;
+    int head_dim = 1;
+    // Number of positions in a block.
+    int block_size = 16;
+    // Maximum number of blocks in the pool. 0 means unbounded.
+    int max_num_blocks = 0;
+  };
+
+  // Creates a cache with an empty sequence 0, which is the active sequence.
+  explicit PagedKVCache(const Options& options);
+  PagedKVCache(const PagedKVCache&) = delete;
+  PagedKVCache& operator=(const PagedKVCache&) = delete;
+
+  bool IsInitialized() override { return true; }
+
+  ResourceKind GetKind() const override { return ResourceKind::kPagedKVCache; }
+
+  // Returns the memory allocated for blocks in bytes, including free blocks
+  // that have not been released by `Compact`.
+  size_t GetMemoryUsage() override;
+
+  const Options& options() const { return options_; }
+
+  // Creates an empty sequence. Returns an error if it already exists.
+  TfLiteStatus CreateSequence(int sequence_id);
+
+  // Creates sequence `child_id` which shares the blocks, and therefore the
+  // cached keys and values, of `parent_id`.
+  TfLiteStatus ForkSequence(int parent_id, int child_id);
+
+  // Removes a sequence. Blocks no longer used by any sequence are returned to
+  // the pool.
+  TfLiteStatus RemoveSequence(int sequence_id);
+
+  // Drops the positions of a sequence from `num_tokens` on, e.g. to roll back
+  // rejected tokens. Blocks no longer used are returned to the pool.
+  TfLiteStatus TruncateSequence(int sequence_id, int num_tokens);
+
+  // Releases the memory of the blocks in the pool which are not used by any
+  // sequence. They are reallocated when needed.
+  void Compact();
+
+  bool HasSequence(int sequence_id) const;
+
+  // Returns the number of positions cached for a sequence, or -1 if it does
+  // not exist.
+  int GetSequenceLength(int sequence_id) const;
+
+  // The active sequence is read and written by the KV cache and SDPA ops.
+  TfLiteStatus SetActiveSequence(int sequence_id);
+  int active_sequence() const { return active_sequence_; }
+
+  // Writes the keys and values of `layer` for `num_tokens` consecutive
+  // positions starting at `position`. `key` and `value` are laid out as
+  // [num_tokens, num_heads, head_dim]. Allocates the blocks as needed, and
+  // copies blocks shared with other sequences before writing them. Returns an
+  // error if the pool is exhausted.
+  TfLiteStatus Write(int sequence_id, int layer, int position, int num_tokens,
+                     const float* key, const float* value);
+
+  // Returns the key and value blocks of `layer` which cover the positions of a
+  // sequence. Block `i` holds positions [i * block_size, (i + 1) * block_size)
+  // laid out as [block_size, num_heads, head_dim].
+  TfLiteStatus GetBlocks(int sequence_id, int layer,
+                         std::vector<const float*>& key_blocks,
+                         std::vector<const float*>& value_blocks) const;
+
+  // Number of blocks used by at least one sequence.
+  int num_used_blocks() const;
+  // Number of blocks in the pool which are not used by any sequence.
+  int num_free_blocks() const { return free_blocks_.size(); }
+
+ private:
+  struct Sequence {
+    // Maps block indices of the sequence to blocks in the pool.
+    std::vector<int> block_table;
+    int num_tokens = 0;
+  };
+
+  // Returns a block for position block `block_index` of `sequence` which is
+  // not shared with other sequences, allocating or copying it if needed.
+  TfLiteStatus GetWritableBlock(Sequence& sequence, int block_index,
+                                int& block);
+
+  // Returns a block from the pool with a reference count of 1, or -1 if the
+  // pool is exhausted.
+  int AllocateBlock();
+  void ReleaseBlock(int block);
+
+  // Returns the keys (`is_value` = false) or values of `layer` in `block`.
+  float* BlockData(int block, int layer, bool is_value) const;
+
+  const Options options_;
+  // Number of floats in a block of one layer's keys or values.
+  const size_t layer_block_size_;
+
+  // Storage of the blocks. Released blocks are nullptr.
+  std::vector<std::unique_ptr<float[]>> blocks_;
+  // Number of sequences referencing each block.
+  std::vector<int> ref_counts_;
+  std::vector<int> free_blocks_;
+
+  std::unordered_map<int, Sequence> sequences_;
+  int active_sequence_ = 0;
+};
+
+// Resource ID of the paged KV cache used by the genai ops.
+inline constexpr int kPagedKVCacheResourceId = 44;
+
+// Looks up the paged KV cache in `resources` and sets `*cache` to it, or to
+// nullptr if there is none. Returns an error if the resource with
+// `kPagedKVCacheResourceId` is not a paged KV cache.
+TfLiteStatus GetPagedKVCache(ResourceMap& resources, PagedKVCache** cache);
+
+}  // namespace resource
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_RESOURCE_PAGED_KV_CACHE_H_
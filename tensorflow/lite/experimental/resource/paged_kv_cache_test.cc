@@ -0,0 +1,309 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/resource/paged_kv_cache.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/experimental/resource/resource_base.h"
+
+namespace tflite {
+namespace resource {
+namespace {
+
+constexpr int kNumLayers = 2;
+constexpr int kNumHeads = 2;
+constexpr int kHeadDim = 4;
+constexpr int kEntrySize = kNumHeads * kHeadDim;
+
+PagedKVCache::Options GetOptions(int block_size, int max_num_blocks = 0) {
+  PagedKVCache::Options options;
+  options.num_layers = kNumLayers;
+  options.num_heads = kNumHeads;
+  options.head_dim = kHeadDim;
+  options.block_size = block_size;
+  options.max_num_blocks = max_num_blocks;
+  return options;
+}
+
+// Returns the keys (values are negated) of `num_tokens` positions from
+// `position` on, where every element of a position is `tag + position`.
+std::vector<float> Entries(int position, int num_tokens, float tag,
+                           bool is_value = false) {
+  std::vector<float> entries;
+  for (int t = 0; t < num_tokens; ++t) {
+    entries.insert(entries.end(), kEntrySize,
+                   (is_value ? -1.0f : 1.0f) * (tag + position + t));
+  }
+  return entries;
+}
+
+TfLiteStatus WriteAt(PagedKVCache& cache, int sequence_id, int layer,
+                     int position, int num_tokens, float tag) {
+  const std::vector<float> key = Entries(position, num_tokens, tag);
+  const std::vector<float> value =
+      Entries(position, num_tokens, tag, /*is_value=*/true);
+  return cache.Write(sequence_id, layer, position, num_tokens, key.data(),
+                     value.data());
+}
+
+TfLiteStatus Append(PagedKVCache& cache, int sequence_id, int layer,
+                    int num_tokens, float tag) {
+  return WriteAt(cache, sequence_id, layer,
+                 cache.GetSequenceLength(sequence_id), num_tokens, tag);
+}
+
+// Returns the first element of the key (or value) of every position of a
+// sequence, gathered through its blocks.
+std::vector<float> ReadFirstElements(const PagedKVCache& cache,
+                                     int sequence_id, int layer,
+                                     bool is_value = false) {
+  std::vector<const float*> key_blocks;
+  std::vector<const float*> value_blocks;
+  EXPECT_EQ(cache.GetBlocks(sequence_id, layer, key_blocks, value_blocks),
+            kTfLiteOk);
+  const std::vector<const float*>& blocks =
+      is_value ? value_blocks : key_blocks;
+  const int block_size = cache.options().block_size;
+  std::vector<float> result;
+  for (int position = 0; position < cache.GetSequenceLength(sequence_id);
+       ++position) {
+    result.push_back(blocks[position / block_size]
+                           [(position % block_size) * kEntrySize]);
+  }
+  return result;
+}
+
+std::vector<float> Expected(int num_tokens, float tag) {
+  std::vector<float> result;
+  for (int position = 0; position < num_tokens; ++position) {
+    result.push_back(tag + position);
+  }
+  return result;
+}
+
+TEST(PagedKVCacheTest, StartsWithEmptyActiveSequence) {
+  PagedKVCache cache(GetOptions(/*block_size=*/4));
+  EXPECT_TRUE(cache.IsInitialized());
+  EXPECT_TRUE(cache.HasSequence(0));
+  EXPECT_EQ(cache.active_sequence(), 0);
+  EXPECT_EQ(cache.GetSequenceLength(0), 0);
+  EXPECT_EQ(cache.GetSequenceLength(1), -1);
+  EXPECT_EQ(cache.GetMemoryUsage(), 0);
+}
+
+TEST(PagedKVCacheTest, WritesAcrossBlocks) {
+  PagedKVCache cache(GetOptions(/*block_size=*/4));
+  for (int layer = 0; layer < kNumLayers; ++layer) {
+    ASSERT_EQ(WriteAt(cache, 0, layer, /*position=*/0, /*num_tokens=*/6,
+                      layer * 100),
+              kTfLiteOk);
+  }
+  for (int layer = 0; layer < kNumLayers; ++layer) {
+    ASSERT_EQ(WriteAt(cache, 0, layer, /*position=*/6, /*num_tokens=*/1,
+                      layer * 100),
+              kTfLiteOk);
+  }
+
+  EXPECT_EQ(cache.GetSequenceLength(0), 7);
+  EXPECT_EQ(cache.num_used_blocks(), 2);
+  EXPECT_EQ(ReadFirstElements(cache, 0, 0), Expected(7, 0));
+  EXPECT_EQ(ReadFirstElements(cache, 0, 1), Expected(7, 100));
+  std::vector<float> values = ReadFirstElements(cache, 0, 1, /*is_value=*/true);
+  for (float& value : values) value = -value;
+  EXPECT_EQ(values, Expected(7, 100));
+}
+
+TEST(PagedKVCacheTest, ForkSharesPrefix) {
+  PagedKVCache cache(GetOptions(/*block_size=*/4));
+  ASSERT_EQ(Append(cache, 0, 0, /*num_tokens=*/8, 0), kTfLiteOk);
+  ASSERT_EQ(cache.num_used_blocks(), 2);
+
+  ASSERT_EQ(cache.ForkSequence(0, 1), kTfLiteOk);
+  EXPECT_EQ(cache.ForkSequence(0, 1), kTfLiteError);
+  EXPECT_EQ(cache.ForkSequence(2, 3), kTfLiteError);
+  // The prompt blocks are shared rather than copied.
+  EXPECT_EQ(cache.num_used_blocks(), 2);
+  EXPECT_EQ(ReadFirstElements(cache, 1, 0), Expected(8, 0));
+
+  // Both sequences append into new blocks of their own.
+  ASSERT_EQ(Append(cache, 0, 0, /*num_tokens=*/1, 0), kTfLiteOk);
+  ASSERT_EQ(Append(cache, 1, 0, /*num_tokens=*/1, 1000), kTfLiteOk);
+  EXPECT_EQ(cache.num_used_blocks(), 4);
+  std::vector<float> expected = Expected(8, 0);
+  expected.push_back(8);
+  EXPECT_EQ(ReadFirstElements(cache, 0, 0), expected);
+  expected.back() = 1008;
+  EXPECT_EQ(ReadFirstElements(cache, 1, 0), expected);
+}
+
+TEST(PagedKVCacheTest, CopiesSharedBlockOnWrite) {
+  PagedKVCache cache(GetOptions(/*block_size=*/4));
+  // The fork point is in the middle of the second block.
+  ASSERT_EQ(Append(cache, 0, 0, /*num_tokens=*/6, 0), kTfLiteOk);
+  ASSERT_EQ(cache.ForkSequence(0, 1), kTfLiteOk);
+
+  ASSERT_EQ(Append(cache, 1, 0, /*num_tokens=*/2, 1000), kTfLiteOk);
+  // Only the partially filled block is copied.
+  EXPECT_EQ(cache.num_used_blocks(), 3);
+
+  EXPECT_EQ(ReadFirstElements(cache, 0, 0), Expected(6, 0));
+  std::vector<float> expected = Expected(6, 0);
+  expected.push_back(1006);
+  expected.push_back(1007);
+  EXPECT_EQ(ReadFirstElements(cache, 1, 0), expected);
+
+  // The parent writes into its block, which is no longer shared.
+  ASSERT_EQ(Append(cache, 0, 0, /*num_tokens=*/1, 0), kTfLiteOk);
+  EXPECT_EQ(cache.num_used_blocks(), 3);
+  EXPECT_EQ(ReadFirstElements(cache, 0, 0), Expected(7, 0));
+  EXPECT_EQ(ReadFirstElements(cache, 1, 0), expected);
+}
+
+TEST(PagedKVCacheTest, RemoveAndTruncateFreeBlocks) {
+  PagedKVCache cache(GetOptions(/*block_size=*/4));
+  ASSERT_EQ(Append(cache, 0, 0, /*num_tokens=*/8, 0), kTfLiteOk);
+  ASSERT_EQ(cache.ForkSequence(0, 1), kTfLiteOk);
+  ASSERT_EQ(Append(cache, 1, 0, /*num_tokens=*/4, 0), kTfLiteOk);
+  EXPECT_EQ(cache.num_used_blocks(), 3);
+
+  // Rolls back the tokens appended to the fork.
+  ASSERT_EQ(cache.TruncateSequence(1, 5), kTfLiteOk);
+  EXPECT_EQ(cache.GetSequenceLength(1), 5);
+  EXPECT_EQ(cache.num_used_blocks(), 2);
+  EXPECT_EQ(cache.num_free_blocks(), 1);
+  EXPECT_EQ(ReadFirstElements(cache, 1, 0), Expected(5, 0));
+
+  // Shared blocks stay in use until the last sequence is removed.
+  ASSERT_EQ(cache.RemoveSequence(0), kTfLiteOk);
+  EXPECT_EQ(cache.num_used_blocks(), 2);
+  EXPECT_EQ(ReadFirstElements(cache, 1, 0), Expected(5, 0));
+  ASSERT_EQ(cache.RemoveSequence(1), kTfLiteOk);
+  EXPECT_EQ(cache.num_used_blocks(), 0);
+  EXPECT_EQ(cache.num_free_blocks(), 3);
+  EXPECT_EQ(cache.RemoveSequence(1), kTfLiteError);
+}
+
+TEST(PagedKVCacheTest, CompactReleasesFreeBlocks) {
+  PagedKVCache cache(GetOptions(/*block_size=*/4));
+  const size_t block_bytes = kNumLayers * 2 * 4 * kEntrySize * sizeof(float);
+  ASSERT_EQ(Append(cache, 0, 0, /*num_tokens=*/12, 0), kTfLiteOk);
+  EXPECT_EQ(cache.GetMemoryUsage(), 3 * block_bytes);
+
+  ASSERT_EQ(cache.TruncateSequence(0, 4), kTfLiteOk);
+  EXPECT_EQ(cache.GetMemoryUsage(), 3 * block_bytes);
+  cache.Compact();
+  EXPECT_EQ(cache.GetMemoryUsage(), block_bytes);
+  EXPECT_EQ(ReadFirstElements(cache, 0, 0), Expected(4, 0));
+
+  // Released blocks are reallocated when needed.
+  ASSERT_EQ(Append(cache, 0, 0, /*num_tokens=*/8, 0), kTfLiteOk);
+  EXPECT_EQ(cache.GetMemoryUsage(), 3 * block_bytes);
+  EXPECT_EQ(ReadFirstElements(cache, 0, 0), Expected(12, 0));
+}
+
+TEST(PagedKVCacheTest, FailsWhenPoolIsExhausted) {
+  PagedKVCache cache(GetOptions(/*block_size=*/4, /*max_num_blocks=*/2));
+  ASSERT_EQ(Append(cache, 0, 0, /*num_tokens=*/8, 0), kTfLiteOk);
+  EXPECT_EQ(Append(cache, 0, 0, /*num_tokens=*/1, 0), kTfLiteError);
+
+  // Freed blocks are reused.
+  ASSERT_EQ(cache.TruncateSequence(0, 4), kTfLiteOk);
+  EXPECT_EQ(Append(cache, 0, 0, /*num_tokens=*/4, 0), kTfLiteOk);
+  EXPECT_EQ(ReadFirstElements(cache, 0, 0), Expected(8, 0));
+}
+
+TEST(PagedKVCacheTest, ActiveSequence) {
+  PagedKVCache cache(GetOptions(/*block_size=*/4));
+  EXPECT_EQ(cache.SetActiveSequence(1), kTfLiteError);
+  ASSERT_EQ(cache.CreateSequence(1), kTfLiteOk);
+  EXPECT_EQ(cache.CreateSequence(1), kTfLiteError);
+  ASSERT_EQ(cache.SetActiveSequence(1), kTfLiteOk);
+  EXPECT_EQ(cache.active_sequence(), 1);
+}
+
+TEST(PagedKVCacheTest, ManyConcurrentSequences) {
+  constexpr int kBlockSize = 16;
+  constexpr int kMaxSequenceLength = 1024;
+  constexpr int kPromptLength = 40;
+  constexpr int kNumSequences = 64;
+  PagedKVCache cache(GetOptions(kBlockSize));
+  ASSERT_EQ(Append(cache, 0, 0, kPromptLength, 0), kTfLiteOk);
+
+  // Every sequence shares the prompt and decodes a different number of tokens,
+  // interleaved like a batch of concurrent requests.
+  for (int i = 1; i <= kNumSequences; ++i) {
+    ASSERT_EQ(cache.ForkSequence(0, i), kTfLiteOk);
+  }
+  for (int step = 0; step < kNumSequences; ++step) {
+    for (int i = step + 1; i <= kNumSequences; ++i) {
+      ASSERT_EQ(Append(cache, i, 0, /*num_tokens=*/1, 0), kTfLiteOk);
+    }
+  }
+  int num_tokens = 0;
+  for (int i = 1; i <= kNumSequences; ++i) {
+    ASSERT_EQ(cache.GetSequenceLength(i), kPromptLength + i);
+    EXPECT_EQ(ReadFirstElements(cache, i, 0), Expected(kPromptLength + i, 0));
+    num_tokens += kPromptLength + i;
+  }
+
+  // The cache uses less memory than the tokens it holds, because the prompt
+  // is shared, and much less than a contiguous cache of the maximum length
+  // per sequence.
+  const size_t entry_bytes = kNumLayers * 2 * kEntrySize * sizeof(float);
+  EXPECT_LT(cache.GetMemoryUsage(), num_tokens * entry_bytes);
+  EXPECT_LT(cache.GetMemoryUsage() * 10,
+            kNumSequences * kMaxSequenceLength * entry_bytes);
+
+  // Finished sequences return their blocks to the pool.
+  for (int i = 1; i <= kNumSequences; ++i) {
+    ASSERT_EQ(cache.RemoveSequence(i), kTfLiteOk);
+  }
+  EXPECT_EQ(cache.num_used_blocks(), (kPromptLength + kBlockSize - 1) /
+                                         kBlockSize);
+}
+
+class OtherResource : public ResourceBase {
+ public:
+  bool IsInitialized() override { return true; }
+};
+
+TEST(PagedKVCacheTest, GetPagedKVCache) {
+  ResourceMap resources;
+  PagedKVCache* cache = nullptr;
+  ASSERT_EQ(GetPagedKVCache(resources, &cache), kTfLiteOk);
+  EXPECT_EQ(cache, nullptr);
+
+  auto* paged_kv_cache = new PagedKVCache(GetOptions(/*block_size=*/4));
+  resources.emplace(kPagedKVCacheResourceId, paged_kv_cache);
+  ASSERT_EQ(GetPagedKVCache(resources, &cache), kTfLiteOk);
+  EXPECT_EQ(cache, paged_kv_cache);
+}
+
+TEST(PagedKVCacheTest, GetPagedKVCacheOfOtherKind) {
+  ResourceMap resources;
+  resources.emplace(kPagedKVCacheResourceId,
+                    std::make_unique<OtherResource>());
+  PagedKVCache* cache = nullptr;
+  EXPECT_EQ(GetPagedKVCache(resources, &cache), kTfLiteError);
+  EXPECT_EQ(cache, nullptr);
+}
+
+}  // namespace
+}  // namespace resource
+}  // namespace tflite
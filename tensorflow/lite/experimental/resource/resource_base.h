@@ -25,6 +25,10 @@ limitations under the License.
 namespace tflite {
 namespace resource {
 
+// Kinds of resources that are looked up with a checked downcast. TFLite is
+// built without RTTI, so resources report their kind themselves.
+enum class ResourceKind { kOther, kPagedKVCache };
+
 // ResourceBase is an abstract base class for resources.
 /// WARNING: Experimental interface, subject to change.
 class ResourceBase {
@@ -35,6 +39,9 @@ class ResourceBase {
   // Returns true if it is initialized.
   virtual bool IsInitialized() = 0;
 
+  // Returns the kind of the resource.
+  virtual ResourceKind GetKind() const { return ResourceKind::kOther; }
+
   virtual size_t GetMemoryUsage() {
     return 0;
   }  // TODO(b/242603814): Make it pure virtual.
@@ -19,8 +19,13 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 #define TENSORFLOW_LITE_INTERPRETER_OPTIONS_H_
 
+#include <memory>
+#include <utility>
+
 namespace tflite {
 
+class ArenaPlanCache;
+
 /// Options class for `Interpreter`.
 /// WARNING: This is an experimental API and subject to change.
 class InterpreterOptions {
@@ -103,12 +108,59 @@ class InterpreterOptions {
     return experimental_cache_constant_cast_op_;
   }
 
+  // Runs the nodes of a subgraph that do not depend on each other
+  // concurrently, on `num_threads` threads including the thread calling
+  // `Invoke`. Dependencies are derived from the tensor memory each node
+  // accesses, including memory reused by the arena planner, so results match
+  // sequential execution. The first invocation after tensors are (re)allocated
+  // runs sequentially, as do invocations with a profiler, and subgraphs with
+  // dynamic tensors or delegate buffer handles. Values less than 2 disable it.
+  //
+  // Each of these threads has its own CPU backend context for the kernels it
+  // runs, so multi-threaded kernels may use more threads in total than the
+  // interpreter's `num_threads`.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetParallelNodeExecutionThreads(int num_threads) {
+    experimental_parallel_node_execution_threads_ = num_threads;
+  }
+
+  // Returns the number of threads that run independent nodes concurrently, or
+  // a value less than 2 if nodes run sequentially.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  int GetParallelNodeExecutionThreads() const {
+    return experimental_parallel_node_execution_threads_;
+  }
+
+  // Makes the interpreter look up the layouts of its non-persistent tensor
+  // arenas in `plan_cache` instead of planning them, whenever all the tensors
+  // of a subgraph are allocated from scratch, e.g. when inputs are resized back
+  // to previous shapes, and add the layouts it computes to it. A cache can be
+  // shared by interpreters of the same model, and saved to a file next to the
+  // model to allocate tensors without planning in later runs, see
+  // `ArenaPlanCache`. Must be set before tensors are first allocated.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  void SetArenaPlanCache(std::shared_ptr<ArenaPlanCache> plan_cache) {
+    experimental_arena_plan_cache_ = std::move(plan_cache);
+  }
+
+  // Returns the cache of tensor arena layouts, or nullptr if there is none.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  const std::shared_ptr<ArenaPlanCache>& GetArenaPlanCache() const {
+    return experimental_arena_plan_cache_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_ = false;
   bool experimental_ensure_dynamic_tensors_are_released_ = false;
   int experimental_optimize_memory_for_large_tensors_ = 0;
   bool experimental_disable_delegate_clustering_ = false;
   bool experimental_cache_constant_cast_op_ = false;
+  int experimental_parallel_node_execution_threads_ = 0;
+  std::shared_ptr<ArenaPlanCache> experimental_arena_plan_cache_;
 };
 
 }  // namespace tflite
@@ -0,0 +1,209 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/interpreter_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/logger.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+
+InterpreterPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), entry_(other.entry_) {
+  other.pool_ = nullptr;
+  other.entry_ = nullptr;
+}
+
+InterpreterPool::Lease& InterpreterPool::Lease::operator=(
+    Lease&& other) noexcept {
+  if (this != &other) {
+    Reset();
+    std::swap(pool_, other.pool_);
+    std::swap(entry_, other.entry_);
+  }
+  return *this;
+}
+
+Interpreter* InterpreterPool::Lease::get() const {
+  return entry_ == nullptr ? nullptr : entry_->interpreter.get();
+}
+
+void InterpreterPool::Lease::Reset() {
+  if (entry_ != nullptr) {
+    pool_->Release(entry_);
+    pool_ = nullptr;
+    entry_ = nullptr;
+  }
+}
+
+InterpreterPool::InterpreterPool(const FlatBufferModel& model,
+                                 const OpResolver& op_resolver,
+                                 const Options& options)
+    : model_(model), op_resolver_(op_resolver), options_(options) {}
+
+std::unique_ptr<InterpreterPool> InterpreterPool::Create(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const Options& options) {
+  if (options.max_num_interpreters < 0 || options.num_threads < -1) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "Invalid interpreter pool options.");
+    return nullptr;
+  }
+  std::unique_ptr<InterpreterPool> pool(
+      new InterpreterPool(model, op_resolver, options));
+  if (options.use_xnnpack) {
+    pool->weights_cache_ = {TfLiteXNNPackDelegateWeightsCacheCreate(),
+                            TfLiteXNNPackDelegateWeightsCacheDelete};
+    if (pool->weights_cache_ == nullptr) {
+      TFLITE_LOG(TFLITE_LOG_ERROR, "Failed to create XNNPACK weights cache.");
+      return nullptr;
+    }
+  }
+
+  int num_initial_interpreters = std::max(options.num_initial_interpreters, 1);
+  if (options.max_num_interpreters > 0) {
+    num_initial_interpreters =
+        std::min(num_initial_interpreters, options.max_num_interpreters);
+  }
+  for (int i = 0; i < num_initial_interpreters; ++i) {
+    std::unique_ptr<Entry> entry = pool->CreateEntry();
+    if (entry == nullptr) {
+      return nullptr;
+    }
+    pool->idle_entries_.push_back(entry.get());
+    pool->entries_.push_back(std::move(entry));
+
+    // The first interpreter has packed all weights. Later interpreters find
+    // them in the cache, which keeps room for lookups only.
+    if (i == 0 && pool->weights_cache_ != nullptr &&
+        !TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(
+            pool->weights_cache_.get())) {
+      TFLITE_LOG(TFLITE_LOG_ERROR, "Failed to finalize XNNPACK weights cache.");
+      return nullptr;
+    }
+  }
+  return pool;
+}
+
+InterpreterPool::~InterpreterPool() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Interpreters are destroyed before the weights cache their delegates use.
+  entries_.clear();
+}
+
+InterpreterPool::Lease InterpreterPool::Acquire() {
+  return AcquireImpl(/*block=*/true);
+}
+
+InterpreterPool::Lease InterpreterPool::TryAcquire() {
+  return AcquireImpl(/*block=*/false);
+}
+
+int InterpreterPool::num_interpreters() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+int InterpreterPool::num_idle_interpreters() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_entries_.size();
+}
+
+InterpreterPool::Lease InterpreterPool::AcquireImpl(bool block) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    if (!idle_entries_.empty()) {
+      Entry* entry = idle_entries_.back();
+      idle_entries_.pop_back();
+      return Lease(this, entry);
+    }
+    const int num_entries = entries_.size() + num_pending_entries_;
+    if (options_.max_num_interpreters == 0 ||
+        num_entries < options_.max_num_interpreters) {
+      break;
+    }
+    if (!block) {
+      return Lease();
+    }
+    idle_entry_available_.wait(lock);
+  }
+
+  // Builds the interpreter without holding the lock, so that other requests
+  // can acquire and release interpreters meanwhile.
+  ++num_pending_entries_;
+  lock.unlock();
+  std::unique_ptr<Entry> entry = CreateEntry();
+  lock.lock();
+  --num_pending_entries_;
+  if (entry == nullptr) {
+    // Another request may create the interpreter instead.
+    idle_entry_available_.notify_one();
+    return Lease();
+  }
+  Entry* new_entry = entry.get();
+  entries_.push_back(std::move(entry));
+  return Lease(this, new_entry);
+}
+
+std::unique_ptr<InterpreterPool::Entry> InterpreterPool::CreateEntry() {
+  std::lock_guard<std::mutex> lock(create_mutex_);
+  auto entry = std::make_unique<Entry>();
+  InterpreterBuilder builder(model_, op_resolver_);
+  if (builder.SetNumThreads(options_.num_threads) != kTfLiteOk) {
+    return nullptr;
+  }
+  if (weights_cache_ != nullptr) {
+    TfLiteXNNPackDelegateOptions xnnpack_options =
+        TfLiteXNNPackDelegateOptionsDefault();
+    xnnpack_options.num_threads = options_.num_threads;
+    xnnpack_options.weights_cache = weights_cache_.get();
+    entry->delegate = {TfLiteXNNPackDelegateCreate(&xnnpack_options),
+                       TfLiteXNNPackDelegateDelete};
+    if (entry->delegate == nullptr) {
+      TFLITE_LOG(TFLITE_LOG_ERROR, "Failed to create XNNPACK delegate.");
+      return nullptr;
+    }
+    builder.AddDelegate(entry->delegate.get());
+  }
+  if (builder(&entry->interpreter) != kTfLiteOk ||
+      entry->interpreter == nullptr) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "Failed to build interpreter.");
+    return nullptr;
+  }
+  if (entry->interpreter->AllocateTensors() != kTfLiteOk) {
+    TFLITE_LOG(TFLITE_LOG_ERROR, "Failed to allocate tensors.");
+    return nullptr;
+  }
+  return entry;
+}
+
+void InterpreterPool::Release(Entry* entry) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_entries_.push_back(entry);
+  }
+  idle_entry_available_.notify_one();
+}
+
+}  // namespace tflite
@@ -0,0 +1,194 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+/// \file
+///
+/// A pool of interpreters for running one model on concurrent requests.
+#ifndef TENSORFLOW_LITE_INTERPRETER_POOL_H_
+#define TENSORFLOW_LITE_INTERPRETER_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+
+/// WARNING: Experimental interface, subject to change.
+///
+/// An interpreter runs one invocation at a time, so serving a model to
+/// concurrent requests requires one interpreter per in-flight request.
+/// `InterpreterPool` manages these interpreters as lightweight execution
+/// contexts of one model. They share everything that is immutable:
+///
+/// * The model and its weights, which every interpreter reads in place from
+///   the `FlatBufferModel`.
+/// * The op resolver.
+/// * With `Options::use_xnnpack`, the weights packed by XNNPACK, which are
+///   packed once into a cache shared by the delegates of all interpreters.
+///
+/// Each interpreter owns its activation arena and kernel state. The kernel
+/// state includes the data that the builtin kernels prepare from the weights
+/// outside of XNNPACK, e.g. the weights prepacked by ruy for fully connected
+/// and convolution ops, or the dequantized and transposed weights in the
+/// `user_data` of some kernels, which are therefore duplicated in every
+/// interpreter. Only the weights packed by XNNPACK are shared.
+/// Interpreters are created on demand, up to `Options::max_num_interpreters`,
+/// and are reused by later requests on any thread.
+///
+/// Example:
+///
+/// <pre><code>
+///   ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+///   InterpreterPool::Options options;
+///   options.max_num_interpreters = 8;
+///   std::unique_ptr<InterpreterPool> pool =
+///       InterpreterPool::Create(*model, resolver, options);
+///
+///   // On any thread:
+///   InterpreterPool::Lease interpreter = pool->Acquire();
+///   if (!interpreter) { /* handle the error */ }
+///   interpreter->typed_input_tensor<float>(0)[0] = x;
+///   interpreter->Invoke();
+///   // The interpreter returns to the pool when the lease is destroyed.
+/// </code></pre>
+///
+/// The model and the op resolver must outlive the pool. With `use_xnnpack`,
+/// prefer an op resolver without default delegates, such as
+/// `BuiltinOpResolverWithoutDefaultDelegates`, so that the default XNNPACK
+/// delegate does not pack the weights again for every interpreter.
+class InterpreterPool {
+  struct Entry;
+
+ public:
+  struct Options {
+    /// Maximum number of interpreters, i.e. of concurrent invocations. 0 means
+    /// unbounded. `Acquire` blocks while all interpreters are in use.
+    int max_num_interpreters = 0;
+    /// Number of interpreters created by `Create`, at least 1. They are
+    /// created before the pool is returned, so that the first requests do not
+    /// pay for it. The first interpreter also fills the packed weights cache.
+    int num_initial_interpreters = 1;
+    /// Number of threads used by each invocation.
+    int num_threads = 1;
+    /// Whether to apply the XNNPACK delegate, with packed weights shared by
+    /// all interpreters.
+    bool use_xnnpack = true;
+  };
+
+  /// Exclusive use of an interpreter of the pool, which is returned to the
+  /// pool when the lease is destroyed or reset.
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(Lease&& other) noexcept;
+    Lease& operator=(Lease&& other) noexcept;
+    ~Lease() { Reset(); }
+
+    /// Returns the interpreter, or nullptr if the lease is empty.
+    Interpreter* get() const;
+    Interpreter* operator->() const { return get(); }
+    Interpreter& operator*() const { return *get(); }
+    explicit operator bool() const { return entry_ != nullptr; }
+
+    /// Returns the interpreter to the pool.
+    void Reset();
+
+   private:
+    friend class InterpreterPool;
+    Lease(InterpreterPool* pool, Entry* entry) : pool_(pool), entry_(entry) {}
+
+    InterpreterPool* pool_ = nullptr;
+    Entry* entry_ = nullptr;
+  };
+
+  /// Creates a pool with `options.num_initial_interpreters` interpreters
+  /// whose tensors are allocated. Returns nullptr on error.
+  static std::unique_ptr<InterpreterPool> Create(
+      const FlatBufferModel& model, const OpResolver& op_resolver,
+      const Options& options);
+
+  /// All leases must have been returned.
+  ~InterpreterPool();
+
+  InterpreterPool(const InterpreterPool&) = delete;
+  InterpreterPool& operator=(const InterpreterPool&) = delete;
+
+  /// Returns an interpreter that is not in use, creating one if there is none
+  /// and the pool is not full. Otherwise, blocks until an interpreter is
+  /// returned. Returns an empty lease if creating an interpreter fails.
+  Lease Acquire();
+
+  /// Like `Acquire`, but returns an empty lease rather than blocking.
+  Lease TryAcquire();
+
+  /// Number of interpreters created by the pool.
+  int num_interpreters() const;
+
+  /// Number of interpreters that are not in use.
+  int num_idle_interpreters() const;
+
+ private:
+  struct Entry {
+    // The delegate must outlive the interpreter it is applied to, so it is
+    // destroyed last.
+    std::unique_ptr<TfLiteDelegate, void (*)(TfLiteDelegate*)> delegate{
+        nullptr, nullptr};
+    std::unique_ptr<Interpreter> interpreter;
+  };
+
+  InterpreterPool(const FlatBufferModel& model, const OpResolver& op_resolver,
+                  const Options& options);
+
+  // Returns an idle interpreter, or creates one if the pool is not full.
+  // Otherwise, returns an empty lease if `block` is false, or waits for an
+  // interpreter to be returned.
+  Lease AcquireImpl(bool block);
+
+  // Builds a new interpreter with allocated tensors. Returns nullptr on error.
+  std::unique_ptr<Entry> CreateEntry();
+
+  void Release(Entry* entry);
+
+  const FlatBufferModel& model_;
+  const OpResolver& op_resolver_;
+  const Options options_;
+
+  // Packed weights shared by the XNNPACK delegates of all interpreters.
+  std::unique_ptr<TfLiteXNNPackDelegateWeightsCache,
+                  void (*)(TfLiteXNNPackDelegateWeightsCache*)>
+      weights_cache_{nullptr, nullptr};
+
+  // Serializes building interpreters, which packs weights into the shared
+  // cache, without blocking `Release`.
+  std::mutex create_mutex_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable idle_entry_available_;
+  std::vector<std::unique_ptr<Entry>> entries_;
+  std::vector<Entry*> idle_entries_;
+  // Number of interpreters being created, which count towards
+  // `max_num_interpreters`.
+  int num_pending_entries_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_INTERPRETER_POOL_H_
@@ -0,0 +1,165 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/interpreter_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace {
+
+// The model computes `3 * input` for a [1, 8, 8, 3] float input.
+constexpr int kNumElements = 1 * 8 * 8 * 3;
+
+class InterpreterPoolTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    model_ =
+        FlatBufferModel::BuildFromFile("tensorflow/lite/testdata/add.bin");
+    ASSERT_NE(model_, nullptr);
+  }
+
+  InterpreterPool::Options GetOptions(int max_num_interpreters) {
+    InterpreterPool::Options options;
+    options.max_num_interpreters = max_num_interpreters;
+    options.use_xnnpack = GetParam();
+    return options;
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver_;
+};
+
+// Runs the model on `input` and checks the output.
+void InvokeAndCheck(Interpreter& interpreter, float input) {
+  float* input_data = interpreter.typed_input_tensor<float>(0);
+  for (int i = 0; i < kNumElements; ++i) {
+    input_data[i] = input + i;
+  }
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  const float* output_data = interpreter.typed_output_tensor<float>(0);
+  for (int i = 0; i < kNumElements; ++i) {
+    ASSERT_EQ(output_data[i], 3 * (input + i));
+  }
+}
+
+TEST_P(InterpreterPoolTest, CreatesInitialInterpreters) {
+  InterpreterPool::Options options = GetOptions(/*max_num_interpreters=*/4);
+  options.num_initial_interpreters = 2;
+  std::unique_ptr<InterpreterPool> pool =
+      InterpreterPool::Create(*model_, resolver_, options);
+  ASSERT_NE(pool, nullptr);
+  EXPECT_EQ(pool->num_interpreters(), 2);
+  EXPECT_EQ(pool->num_idle_interpreters(), 2);
+
+  InterpreterPool::Lease interpreter = pool->Acquire();
+  ASSERT_TRUE(interpreter);
+  EXPECT_EQ(pool->num_idle_interpreters(), 1);
+  InvokeAndCheck(*interpreter, 1.0f);
+  interpreter.Reset();
+  EXPECT_FALSE(interpreter);
+  EXPECT_EQ(pool->num_idle_interpreters(), 2);
+}
+
+TEST_P(InterpreterPoolTest, ReusesReturnedInterpreters) {
+  std::unique_ptr<InterpreterPool> pool =
+      InterpreterPool::Create(*model_, resolver_, GetOptions(0));
+  ASSERT_NE(pool, nullptr);
+  Interpreter* first;
+  {
+    InterpreterPool::Lease interpreter = pool->Acquire();
+    first = interpreter.get();
+  }
+  InterpreterPool::Lease interpreter = pool->Acquire();
+  EXPECT_EQ(interpreter.get(), first);
+  EXPECT_EQ(pool->num_interpreters(), 1);
+}
+
+TEST_P(InterpreterPoolTest, CreatesInterpretersUpToLimit) {
+  std::unique_ptr<InterpreterPool> pool = InterpreterPool::Create(
+      *model_, resolver_, GetOptions(/*max_num_interpreters=*/2));
+  ASSERT_NE(pool, nullptr);
+  InterpreterPool::Lease first = pool->Acquire();
+  InterpreterPool::Lease second = pool->Acquire();
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  EXPECT_NE(first.get(), second.get());
+  EXPECT_EQ(pool->num_interpreters(), 2);
+
+  // Leases are exclusive, so the full pool has no interpreter to lend.
+  EXPECT_FALSE(pool->TryAcquire());
+
+  // Interpreters of the pool run independently, each in its own arena.
+  InvokeAndCheck(*first, 1.0f);
+  InvokeAndCheck(*second, 100.0f);
+  EXPECT_NE(first->typed_output_tensor<float>(0),
+            second->typed_output_tensor<float>(0));
+
+  InterpreterPool::Lease moved = std::move(first);
+  EXPECT_FALSE(first);
+  moved.Reset();
+  EXPECT_TRUE(pool->TryAcquire());
+}
+
+TEST_P(InterpreterPoolTest, ConcurrentRequests) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumRequestsPerThread = 50;
+  constexpr int kMaxNumInterpreters = 3;
+  std::unique_ptr<InterpreterPool> pool = InterpreterPool::Create(
+      *model_, resolver_, GetOptions(kMaxNumInterpreters));
+  ASSERT_NE(pool, nullptr);
+
+  std::atomic<int> num_leased(0);
+  std::atomic<int> max_num_leased(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumRequestsPerThread; ++i) {
+        InterpreterPool::Lease interpreter = pool->Acquire();
+        ASSERT_TRUE(interpreter);
+        const int leased = ++num_leased;
+        int max_leased = max_num_leased.load();
+        while (leased > max_leased &&
+               !max_num_leased.compare_exchange_weak(max_leased, leased)) {
+        }
+        InvokeAndCheck(*interpreter, t * 1000 + i);
+        --num_leased;
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_LE(max_num_leased.load(), kMaxNumInterpreters);
+  EXPECT_LE(pool->num_interpreters(), kMaxNumInterpreters);
+  EXPECT_EQ(pool->num_idle_interpreters(), pool->num_interpreters());
+}
+
+INSTANTIATE_TEST_SUITE_P(InterpreterPoolTest, InterpreterPoolTest,
+                         ::testing::Bool());
+
+}  // namespace
+}  // namespace tflite
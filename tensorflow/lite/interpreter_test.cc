@@ -20,6 +20,8 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
 #include <map>
 #include <memory>
 #include <string>
@@ -2365,5 +2367,149 @@ TEST_F(InterpreterTest, SingleSignature_validate_get_tensor) {
       nullptr);
 }
 
+// Shared by the nodes of `GetDoubleOpRegistration`.
+struct DoubleOpState {
+  // If set, each node waits until another node has started, which only
+  // succeeds if they run concurrently.
+  std::atomic<bool> wait_for_other_node{false};
+  std::atomic<int> num_started{0};
+  std::atomic<bool> saw_other_node{true};
+};
+
+// Doubles its input. The init data is a `DoubleOpState*`.
+TfLiteRegistration GetDoubleOpRegistration() {
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.init = [](TfLiteContext*, const char* buffer, size_t) -> void* {
+    return *reinterpret_cast<DoubleOpState* const*>(buffer);
+  };
+  reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &input));
+    TfLiteTensor* output;
+    TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    auto* state = static_cast<DoubleOpState*>(node->user_data);
+    ++state->num_started;
+    if (state->wait_for_other_node) {
+      const auto deadline =
+          std::chrono::steady_clock::now() + std::chrono::seconds(10);
+      while (state->num_started < 2) {
+        if (std::chrono::steady_clock::now() > deadline) {
+          state->saw_other_node = false;
+          break;
+        }
+        std::this_thread::yield();
+      }
+    }
+    const TfLiteTensor* input;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &input));
+    TfLiteTensor* output;
+    TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+    for (int i = 0; i < NumElements(input); ++i) {
+      output->data.f[i] = 2 * input->data.f[i];
+    }
+    return kTfLiteOk;
+  };
+  return reg;
+}
+
+// Adds its two inputs.
+TfLiteRegistration GetAddOpRegistration() {
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &input));
+    TfLiteTensor* output;
+    TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input0;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 0, &input0));
+    const TfLiteTensor* input1;
+    TF_LITE_ENSURE_OK(context, GetInputSafe(context, node, 1, &input1));
+    TfLiteTensor* output;
+    TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, 0, &output));
+    for (int i = 0; i < NumElements(input0); ++i) {
+      output->data.f[i] = input0->data.f[i] + input1->data.f[i];
+    }
+    return kTfLiteOk;
+  };
+  return reg;
+}
+
+class ParallelNodeExecutionTest : public ::testing::Test {
+ protected:
+  // Builds `output = 2 * input + 2 * input`, where both doublings are
+  // independent.
+  void SetUp() override {
+    ASSERT_EQ(interpreter_.AddTensors(4), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetInputs({0}), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetOutputs({3}), kTfLiteOk);
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(
+                    i, kTfLiteFloat32, "", {3}, TfLiteQuantizationParams()),
+                kTfLiteOk);
+    }
+    DoubleOpState* state = &state_;
+    const char* init_data = reinterpret_cast<const char*>(&state);
+    ASSERT_EQ(interpreter_.AddNodeWithParameters(
+                  {0}, {1}, init_data, sizeof(state), nullptr, &double_op_),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_.AddNodeWithParameters(
+                  {0}, {2}, init_data, sizeof(state), nullptr, &double_op_),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_.AddNodeWithParameters({1, 2}, {3}, nullptr, 0,
+                                                 nullptr, &add_op_),
+              kTfLiteOk);
+
+    InterpreterOptions options;
+    options.SetParallelNodeExecutionThreads(2);
+    ASSERT_EQ(interpreter_.ApplyOptions(&options), kTfLiteOk);
+  }
+
+  void InvokeAndCheck(int size) {
+    float* input = interpreter_.typed_tensor<float>(0);
+    for (int i = 0; i < size; ++i) input[i] = i;
+    state_.num_started = 0;
+    ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+    const float* output = interpreter_.typed_tensor<float>(3);
+    for (int i = 0; i < size; ++i) {
+      EXPECT_EQ(output[i], 4 * i);
+    }
+  }
+
+  DoubleOpState state_;
+  TfLiteRegistration double_op_ = GetDoubleOpRegistration();
+  TfLiteRegistration add_op_ = GetAddOpRegistration();
+  Interpreter interpreter_;
+};
+
+TEST_F(ParallelNodeExecutionTest, RunsIndependentNodesConcurrently) {
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  // The first invocation runs sequentially.
+  InvokeAndCheck(3);
+
+  state_.wait_for_other_node = true;
+  for (int i = 0; i < 5; ++i) {
+    InvokeAndCheck(3);
+  }
+  EXPECT_TRUE(state_.saw_other_node);
+}
+
+TEST_F(ParallelNodeExecutionTest, ResizedInputs) {
+  for (int size : {3, 16, 5}) {
+    ASSERT_EQ(interpreter_.ResizeInputTensor(0, {size}), kTfLiteOk);
+    ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+    for (int i = 0; i < 3; ++i) {
+      InvokeAndCheck(size);
+    }
+  }
+}
+
 }  // namespace
 }  // namespace tflite
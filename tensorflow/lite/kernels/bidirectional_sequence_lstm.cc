@@ -1193,7 +1193,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           fw_output_gate_bias, fw_projection_weights, fw_projection_bias,
           &lstm_params,
           /*forward_sequence=*/true, time_major, /*output_offset=*/0,
-          fw_scratch_buffer, fw_activation_state, fw_cell_state, fw_output,
+          fw_scratch_buffer, /*input_projections=*/nullptr,
+          fw_activation_state, fw_cell_state, fw_output,
           /*recurrent_to_input_is_diag=*/false,
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
@@ -1218,8 +1219,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           bw_output_gate_bias, bw_projection_weights, bw_projection_bias,
           &lstm_params,
           /*forward_sequence=*/false, time_major, bw_output_offset,
-          bw_scratch_buffer, bw_activation_state, bw_cell_state,
-          actual_bw_output,
+          bw_scratch_buffer, /*input_projections=*/nullptr,
+          bw_activation_state, bw_cell_state, actual_bw_output,
           /*recurrent_to_input_is_diag=*/false,
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
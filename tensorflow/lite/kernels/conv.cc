@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/optimized/multithreaded_conv.h"
 #endif
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/block_sparse.h"
 #include "tensorflow/lite/kernels/internal/portable_tensor_utils.h"
 #include "tensorflow/lite/kernels/internal/reference/conv.h"
 #include "tensorflow/lite/kernels/internal/reference/integer_ops/conv.h"
@@ -118,6 +119,11 @@ struct OpData {
   bool is_hybrid_per_channel = false;
   bool compute_hybrid_row_sums = true;
 
+  // Whether the filter is sparse, in which case the convolution is a 1x1 one
+  // computed as a fully-connected layer over the pixels.
+  bool is_block_sparse = false;
+  optimized_ops::BlockSparseMatrix sparse_filter;
+
   // Number of convolution groups.
   int32_t groups = 1;
 
@@ -437,12 +443,37 @@ TfLiteStatus Prepare(KernelType kernel_type, TfLiteContext* context,
     }
   }
 
+  data->is_block_sparse = filter->sparsity != nullptr;
+  if (data->is_block_sparse) {
+    TF_LITE_ENSURE_MSG(
+        context,
+        (input_type == kTfLiteFloat32 && filter->type == kTfLiteFloat32) ||
+            (input_type == kTfLiteInt8 && filter->type == kTfLiteInt8),
+        "Sparse filters are only supported for float32 and int8 Conv2D.");
+    TF_LITE_ENSURE_MSG(
+        context,
+        data->groups == 1 && filter->dims->data[1] == 1 &&
+            filter->dims->data[2] == 1 && params->stride_height == 1 &&
+            params->stride_width == 1,
+        "Sparse filters are only supported for 1x1 Conv2D with unit strides.");
+    size_t filter_type_size;
+    TF_LITE_ENSURE_STATUS(
+        GetSizeOfType(context, filter->type, &filter_type_size));
+    TF_LITE_ENSURE_MSG(
+        context,
+        optimized_ops::GetBlockSparseMatrix(
+            *filter->sparsity, GetTensorShape(filter),
+            static_cast<int>(filter->bytes / filter_type_size),
+            &data->sparse_filter),
+        "Unsupported sparse Conv2D filter format.");
+  }
+
   // The multi-threaded kernel supports neither dilation nor hybrid kernels, and
   // is incompatible with mutable input filters that might change between evals.
   data->supports_multithreaded_kernel =
       (kernel_type == kMultithreadOptimized) &&
       (context->recommended_num_threads != 1) && !is_hybrid &&
-      (params->dilation_width_factor == 1) &&
+      !data->is_block_sparse && (params->dilation_width_factor == 1) &&
       (params->dilation_height_factor == 1) &&
       (filter->allocation_type != kTfLiteArenaRw) && !IsDynamicTensor(filter);
 
@@ -1027,6 +1058,39 @@ void EvalFloat(TfLiteContext* context, TfLiteNode* node,
   }
 }
 
+// Evaluates a 1x1 convolution with a sparse filter, as a fully-connected layer
+// applied to every pixel.
+TfLiteStatus EvalBlockSparse(TfLiteContext* context, TfLiteConvParams* params,
+                             OpData* data, const TfLiteTensor* input,
+                             const TfLiteTensor* filter,
+                             const TfLiteTensor* bias, TfLiteTensor* output) {
+  FullyConnectedParams op_params;
+  if (input->type == kTfLiteFloat32) {
+    CalculateActivationRange(params->activation,
+                             &op_params.float_activation_min,
+                             &op_params.float_activation_max);
+    optimized_ops::FullyConnectedBlockSparseWeight(
+        data->sparse_filter, op_params, GetTensorShape(input),
+        GetTensorData<float>(input), GetTensorData<float>(filter),
+        GetTensorData<float>(bias), GetTensorShape(output),
+        GetTensorData<float>(output),
+        CpuBackendContext::GetFromContext(context));
+  } else {
+    op_params.input_offset = -input->params.zero_point;
+    op_params.output_offset = output->params.zero_point;
+    op_params.quantized_activation_min = data->output_activation_min;
+    op_params.quantized_activation_max = data->output_activation_max;
+    optimized_ops::FullyConnectedBlockSparseWeight(
+        data->sparse_filter, op_params, GetTensorShape(input),
+        GetTensorData<int8_t>(input), GetTensorData<int8_t>(filter),
+        data->per_channel_output_multiplier.data(),
+        data->per_channel_output_shift.data(), GetTensorData<int32_t>(bias),
+        GetTensorShape(output), GetTensorData<int8_t>(output),
+        CpuBackendContext::GetFromContext(context));
+  }
+  return kTfLiteOk;
+}
+
 template <KernelType kernel_type>
 TfLiteStatus EvalHybridPerChannel(TfLiteContext* context, TfLiteNode* node,
                                   TfLiteConvParams* params, OpData* data,
@@ -1279,6 +1343,9 @@ TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node) {
   }
 
   TFLITE_DCHECK_EQ(input_type, input->type);
+  if (data->is_block_sparse) {
+    return EvalBlockSparse(context, params, data, input, filter, bias, output);
+  }
   switch (input_type) {  // Already know in/outtypes are same.
     case kTfLiteFloat32:
       if (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8 ||
@@ -150,6 +150,44 @@ const auto kKernelMap = new std::map<string, TfLiteRegistration*>({
     {"CblasOptimized", ops::builtin::Register_CONVOLUTION_CBLAS_OPT()},
 });
 
+// A 1x1 convolution with a float32 sparse filter.
+class SparseConvolutionOpModel : public SingleOpModel {
+ public:
+  SparseConvolutionOpModel(TfLiteRegistration* registration,
+                           const TensorData& input, const TensorData& filter,
+                           const std::vector<float>& filter_data,
+                           const TensorData& output) {
+    input_ = AddInput(input);
+    filter_ = AddConstSparseInput(filter, filter_data);
+    bias_ = AddInput({TensorType_FLOAT32, {filter.shape[0]}});
+    output_ = AddOutput(output);
+
+    SetBuiltinOp(BuiltinOperator_CONV_2D, BuiltinOptions_Conv2DOptions,
+                 CreateConv2DOptions(builder_, Padding_VALID,
+                                     /*stride_w=*/1, /*stride_h=*/1,
+                                     ActivationFunctionType_NONE)
+                     .Union());
+
+    resolver_ = std::make_unique<SingleOpResolver>(BuiltinOperator_CONV_2D,
+                                                   registration);
+    BuildInterpreter({GetShape(input_), GetShape(filter_), GetShape(bias_)},
+                     /*num_threads=*/-1, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false);
+  }
+
+  void SetBias(std::initializer_list<float> f) { PopulateTensor(bias_, f); }
+  void SetInput(std::initializer_list<float> data) {
+    PopulateTensor(input_, data);
+  }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int input_;
+  int filter_;
+  int bias_;
+  int output_;
+};
+
 class ConvolutionOpTest : public SingleOpTest {
  protected:
   const std::map<string, TfLiteRegistration*>& GetKernelMap() override {
@@ -475,6 +513,37 @@ TEST_P(ConvolutionOpTest, PointwiseFloat32) {
                                            }));
 }
 
+TEST_P(ConvolutionOpTest, SparsePointwiseFloat32) {
+  TensorData filter = {TensorType_FLOAT32, {4, 1, 1, 4}};
+  filter.traversal_order = {0, 1, 2, 3, 4, 5};
+  filter.format = {kTfLiteDimDense, kTfLiteDimDense, kTfLiteDimDense,
+                   kTfLiteDimSparseCSR};
+  filter.block_map = {0, 3};
+  filter.block_size = {2, 2};
+  SparseConvolutionOpModel m(GetRegistration(),
+                             {TensorType_FLOAT32, {1, 1, 2, 4}}, filter,
+                             {
+                                 1, 2, 0, 0,   // first filter
+                                 3, 4, 0, 0,   // second filter
+                                 0, 0, 1, 0,   // third filter
+                                 0, 0, 0, -1,  // fourth filter
+                             },
+                             {TensorType_FLOAT32, {}});
+
+  m.SetInput({
+      1, 2, 3, 4,   // first pixel
+      -1, 0, 1, 2,  // second pixel
+  });
+  m.SetBias({1, 2, 3, 4});
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                 6, 13, 6, 0,   // first pixel
+                                 0, -1, 4, 2,  // second pixel
+                             }));
+}
+
 // TODO(alanchiao): this passes locally, but fails on continuous build system.
 // Re-enable when root cause found.
 TEST_P(ConvolutionOpTest, DISABLED_PointwiseMultifilterFloat32) {
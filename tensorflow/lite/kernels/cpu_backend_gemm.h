@@ -206,8 +206,18 @@ void Gemm(const MatrixParams<LhsScalar>& lhs_params, const LhsScalar* lhs_data,
   ruy::profiler::ScopeLabel label("cpu_backend_gemm::Gemm");
   ValidateParams(lhs_params, rhs_params, dst_params, params);
 
-  // Currently, only Ruy backend supports get raw accumulator, so we use ruy
-  // only.
+#if !defined(TFLITE_WITH_RUY) && defined(TFLITE_X86_PLATFORM)
+  // Only ruy supports caching of pre-packed matrices, see above.
+  if (!context->use_caching() &&
+      detail::RawAccumulatorGemmImplX86<LhsScalar, RhsScalar,
+                                        quantization_flavor>::
+          TryRun(lhs_params, lhs_data, rhs_params, rhs_data, dst_params,
+                 dst_data, params, context)) {
+    return;
+  }
+#endif
+
+  // Otherwise, only Ruy backend supports get raw accumulator, so we use ruy.
   ruy::profiler::ScopeLabel label2("cpu_backend_gemm::Gemm: general GEMM");
   detail::GemmImplUsingRuy<LhsScalar, RhsScalar, int32_t, int32_t,
                            quantization_flavor>::Run(lhs_params, lhs_data,
@@ -0,0 +1,268 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TFLITE_WITH_RUY
+
+#include "tensorflow/lite/kernels/cpu_backend_gemm_amx.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/optimized/cpu_check.h"
+
+// The kernel is compiled regardless of the target flags and only runs on CPUs
+// that support AMX.
+#if defined(__x86_64__) && \
+    (defined(__clang__) ? __clang_major__ >= 12 : __GNUC__ >= 11)
+#define TFLITE_AMX_TARGET __attribute__((target("amx-tile,amx-int8")))
+#include <immintrin.h>
+#endif
+
+namespace tflite {
+namespace cpu_backend_gemm {
+namespace detail {
+
+#ifdef TFLITE_AMX_TARGET
+namespace {
+
+// All tiles have 16 rows of 64 bytes. TDPBSSD multiplies a 16x64 int8 tile
+// of the LHS by a 64x16 one of the RHS, stored as 16 rows of 16 columns of 4
+// consecutive depth levels, accumulating into a 16x16 int32 tile.
+constexpr int kTileRows = 16;
+constexpr int kTileDepth = 64;
+constexpr int kTileBytes = kTileRows * kTileDepth;
+// Each step multiplies 2x2 blocks of tiles.
+constexpr int kBlockSize = 2 * kTileRows;
+// With fewer destination columns, most of the tiles would be padding.
+constexpr int kMinDstCols = 8;
+
+// Tiles 0-3 accumulate, tiles 4-5 hold the LHS and 6-7 the RHS.
+struct TileConfig {
+  uint8_t palette_id = 1;
+  uint8_t start_row = 0;
+  uint8_t reserved[14] = {};
+  uint16_t colsb[16] = {};
+  uint8_t rows[16] = {};
+};
+
+bool HasAmxInt8() {
+  static const bool has_amx_int8 = DetectX86AmxInt8();
+  return has_amx_int8;
+}
+
+int RoundUp(int value, int multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+struct AmxGemm {
+  const int8_t* lhs_data;
+  const int8_t* rhs_packed;
+  int32_t* dst_data;
+  const int32_t* bias;
+  int32_t clamp_min;
+  int32_t clamp_max;
+  int rows;
+  int depth;
+  int cols;
+  int depth_chunks;
+};
+
+// Packs the RHS into tiles of 16 columns by 64 depth levels, zero-padded to
+// blocks of columns.
+void PackRhs(const int8_t* rhs_data, int depth, int cols, int depth_chunks,
+             int8_t* packed) {
+  const int padded_cols = RoundUp(cols, kBlockSize);
+  std::memset(packed, 0,
+              static_cast<size_t>(padded_cols) * depth_chunks * kTileDepth);
+  for (int col = 0; col < cols; ++col) {
+    const int8_t* src = rhs_data + static_cast<size_t>(col) * depth;
+    int8_t* tiles = packed + static_cast<size_t>(col / kTileRows) *
+                                 depth_chunks * kTileBytes;
+    const int col_in_tile = col % kTileRows;
+    for (int d = 0; d < depth; d += 4) {
+      int8_t* dst = tiles + (d / kTileDepth) * kTileBytes +
+                    (d % kTileDepth) / 4 * kTileDepth + col_in_tile * 4;
+      std::memcpy(dst, src + d, std::min(4, depth - d));
+    }
+  }
+}
+
+// Multiplies the LHS rows [row_begin, row_end), a multiple of kBlockSize
+// apart, by the whole RHS.
+TFLITE_AMX_TARGET void RunAmxGemm(const AmxGemm& gemm, int row_begin,
+                                  int row_end) {
+  const int padded_depth = gemm.depth_chunks * kTileDepth;
+  TileConfig config;
+  for (int t = 0; t < 8; ++t) {
+    config.rows[t] = kTileRows;
+    config.colsb[t] = kTileDepth;
+  }
+  _tile_loadconfig(&config);
+  // The LHS is read in place, its tiles spanning the end of a row into the
+  // next one, where the zero padding of the RHS cancels it. Rows whose tiles
+  // would reach past the end of the LHS are copied, zero-padded.
+  std::vector<int8_t> lhs_tail;
+  int32_t acc[4][kTileRows][kTileRows];
+  for (int row = row_begin; row < row_end; row += kBlockSize) {
+    const int8_t* lhs[2];
+    int lhs_stride;
+    const size_t lhs_size = static_cast<size_t>(gemm.rows) * gemm.depth;
+    if (static_cast<size_t>(row + kBlockSize - 1) * gemm.depth +
+            padded_depth <=
+        lhs_size) {
+      lhs[0] = gemm.lhs_data + static_cast<size_t>(row) * gemm.depth;
+      lhs_stride = gemm.depth;
+    } else {
+      lhs_tail.assign(static_cast<size_t>(kBlockSize) * padded_depth, 0);
+      for (int r = row; r < std::min(row + kBlockSize, gemm.rows); ++r) {
+        std::memcpy(lhs_tail.data() + static_cast<size_t>(r - row) *
+                                          padded_depth,
+                    gemm.lhs_data + static_cast<size_t>(r) * gemm.depth,
+                    gemm.depth);
+      }
+      lhs[0] = lhs_tail.data();
+      lhs_stride = padded_depth;
+    }
+    lhs[1] = lhs[0] + static_cast<size_t>(kTileRows) * lhs_stride;
+
+    for (int col = 0; col < gemm.cols; col += kBlockSize) {
+      const int8_t* rhs =
+          gemm.rhs_packed +
+          static_cast<size_t>(col / kTileRows) * gemm.depth_chunks * kTileBytes;
+      const int8_t* rhs_next =
+          rhs + static_cast<size_t>(gemm.depth_chunks) * kTileBytes;
+      _tile_zero(0);
+      _tile_zero(1);
+      _tile_zero(2);
+      _tile_zero(3);
+      for (int chunk = 0; chunk < gemm.depth_chunks; ++chunk) {
+        _tile_loadd(4, lhs[0] + chunk * kTileDepth, lhs_stride);
+        _tile_loadd(5, lhs[1] + chunk * kTileDepth, lhs_stride);
+        _tile_loadd(6, rhs + chunk * kTileBytes, kTileDepth);
+        _tile_loadd(7, rhs_next + chunk * kTileBytes, kTileDepth);
+        _tile_dpbssd(0, 4, 6);
+        _tile_dpbssd(1, 4, 7);
+        _tile_dpbssd(2, 5, 6);
+        _tile_dpbssd(3, 5, 7);
+      }
+      // Accumulator tile i holds LHS rows row + (i / 2) * 16 times RHS
+      // columns col + (i % 2) * 16, and is stored transposed in the
+      // column-major destination.
+      _tile_stored(0, acc[0], sizeof(acc[0][0]));
+      _tile_stored(1, acc[1], sizeof(acc[0][0]));
+      _tile_stored(2, acc[2], sizeof(acc[0][0]));
+      _tile_stored(3, acc[3], sizeof(acc[0][0]));
+      for (int i = 0; i < 4; ++i) {
+        const int tile_row = row + (i / 2) * kTileRows;
+        const int tile_col = col + (i % 2) * kTileRows;
+        const int tile_rows = std::min(kTileRows, gemm.rows - tile_row);
+        const int tile_cols = std::min(kTileRows, gemm.cols - tile_col);
+        for (int c = 0; c < tile_cols; ++c) {
+          int32_t* dst = gemm.dst_data +
+                         static_cast<size_t>(tile_col + c) * gemm.rows +
+                         tile_row;
+          for (int r = 0; r < tile_rows; ++r) {
+            int32_t value = acc[i][r][c];
+            if (gemm.bias) value += gemm.bias[tile_row + r];
+            dst[r] = std::min(std::max(value, gemm.clamp_min), gemm.clamp_max);
+          }
+        }
+      }
+    }
+  }
+  _tile_release();
+}
+
+struct AmxGemmTask : cpu_backend_threadpool::Task {
+  AmxGemmTask(const AmxGemm& gemm, int row_begin, int row_end)
+      : gemm(gemm), row_begin(row_begin), row_end(row_end) {}
+  void Run() override { RunAmxGemm(gemm, row_begin, row_end); }
+
+  const AmxGemm& gemm;
+  int row_begin;
+  int row_end;
+};
+
+}  // namespace
+#endif  // TFLITE_AMX_TARGET
+
+bool GemmImplUsingAmx::TryRun(const MatrixParams<int8_t>& lhs_params,
+                              const int8_t* lhs_data,
+                              const MatrixParams<int8_t>& rhs_params,
+                              const int8_t* rhs_data,
+                              const MatrixParams<int32_t>& dst_params,
+                              int32_t* dst_data, const int32_t* bias,
+                              int32_t clamp_min, int32_t clamp_max,
+                              CpuBackendContext* context) {
+#ifdef TFLITE_AMX_TARGET
+  if (lhs_params.order != Order::kRowMajor ||
+      rhs_params.order != Order::kColMajor ||
+      dst_params.order != Order::kColMajor || lhs_params.zero_point != 0 ||
+      rhs_params.zero_point != 0 || dst_params.zero_point != 0 ||
+      dst_params.cols < kMinDstCols || !HasAmxInt8()) {
+    return false;
+  }
+  AmxGemm gemm;
+  gemm.lhs_data = lhs_data;
+  gemm.dst_data = dst_data;
+  gemm.bias = bias;
+  gemm.clamp_min = clamp_min;
+  gemm.clamp_max = clamp_max;
+  gemm.rows = lhs_params.rows;
+  gemm.depth = lhs_params.cols;
+  gemm.cols = rhs_params.cols;
+  gemm.depth_chunks = RoundUp(gemm.depth, kTileDepth) / kTileDepth;
+  // Reused across calls, as the hybrid kernels run many GEMMs of similar
+  // sizes.
+  static thread_local std::vector<int8_t> rhs_packed;
+  rhs_packed.resize(static_cast<size_t>(RoundUp(gemm.cols, kBlockSize)) *
+                    gemm.depth_chunks * kTileDepth);
+  PackRhs(rhs_data, gemm.depth, gemm.cols, gemm.depth_chunks,
+          rhs_packed.data());
+  gemm.rhs_packed = rhs_packed.data();
+
+  // Threads get contiguous blocks of LHS rows, each streaming its part of the
+  // LHS once when the RHS has at most kBlockSize columns.
+  const int row_blocks = RoundUp(gemm.rows, kBlockSize) / kBlockSize;
+  const int thread_count = std::min(row_blocks, context->max_num_threads());
+  if (thread_count <= 1) {
+    RunAmxGemm(gemm, 0, row_blocks * kBlockSize);
+    return true;
+  }
+  std::vector<AmxGemmTask> tasks;
+  tasks.reserve(thread_count);
+  int row_begin = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    const int row_end = row_blocks * (i + 1) / thread_count * kBlockSize;
+    tasks.emplace_back(gemm, row_begin, row_end);
+    row_begin = row_end;
+  }
+  cpu_backend_threadpool::Execute(thread_count, tasks.data(), context);
+  return true;
+#else
+  return false;
+#endif  // TFLITE_AMX_TARGET
+}
+
+}  // namespace detail
+}  // namespace cpu_backend_gemm
+}  // namespace tflite
+
+#endif  // not TFLITE_WITH_RUY
@@ -0,0 +1,53 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_AMX_H_
+#define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_AMX_H_
+
+#ifndef TFLITE_WITH_RUY
+
+#include <cstdint>
+
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
+
+namespace tflite {
+namespace cpu_backend_gemm {
+namespace detail {
+
+// Computes the raw int32 accumulators of int8 GEMMs, as used by the hybrid
+// kernels, on the AMX tiles of x86 server CPUs.
+struct GemmImplUsingAmx {
+  // Returns false without writing to `dst_data` if the CPU or the OS doesn't
+  // support AMX, or if the GEMM isn't one this handles: only a row-major LHS
+  // and column-major RHS and destination, without zero points, with enough
+  // destination columns to fill the tiles.
+  static bool TryRun(const MatrixParams<int8_t>& lhs_params,
+                     const int8_t* lhs_data,
+                     const MatrixParams<int8_t>& rhs_params,
+                     const int8_t* rhs_data,
+                     const MatrixParams<int32_t>& dst_params,
+                     int32_t* dst_data, const int32_t* bias,
+                     int32_t clamp_min, int32_t clamp_max,
+                     CpuBackendContext* context);
+};
+
+}  // namespace detail
+}  // namespace cpu_backend_gemm
+}  // namespace tflite
+
+#endif  // not TFLITE_WITH_RUY
+
+#endif  // TENSORFLOW_LITE_KERNELS_CPU_BACKEND_GEMM_AMX_H_
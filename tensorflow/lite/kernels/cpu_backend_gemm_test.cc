@@ -632,6 +632,52 @@ TEST(CpuBackendGemmSimpleTestAgainstGolden, Int8Int16) {
       3, 5, 4, {19, 48, 77, 48, 149, 250, 76, 249, 422, 105, 350, 595});
 }
 
+void TestRawAccumulatorGemm(int rows, int depth, int cols, int num_threads) {
+  CpuBackendContext cpu_backend_context;
+  cpu_backend_context.SetMaxNumThreads(num_threads);
+  std::vector<std::int8_t> lhs_data;
+  std::vector<std::int8_t> rhs_data;
+  std::vector<std::int32_t> bias_data;
+  MakeDeterministicPseudoRandomVector(rows * depth, &lhs_data);
+  MakeDeterministicPseudoRandomVector(depth * cols, &rhs_data);
+  MakeDeterministicPseudoRandomVector(rows, &bias_data);
+
+  MatrixParams<std::int8_t> lhs_params;
+  lhs_params.order = cpu_backend_gemm::Order::kRowMajor;
+  lhs_params.rows = rows;
+  lhs_params.cols = depth;
+  MatrixParams<std::int8_t> rhs_params;
+  rhs_params.order = cpu_backend_gemm::Order::kColMajor;
+  rhs_params.rows = depth;
+  rhs_params.cols = cols;
+  MatrixParams<std::int32_t> dst_params;
+  dst_params.order = cpu_backend_gemm::Order::kColMajor;
+  dst_params.rows = rows;
+  dst_params.cols = cols;
+  GemmParams<std::int32_t, std::int32_t> params;
+  params.bias = bias_data.data();
+
+  std::vector<std::int32_t> dst_data(rows * cols);
+  std::vector<std::int32_t> expected(rows * cols);
+  Gemm(lhs_params, lhs_data.data(), rhs_params, rhs_data.data(), dst_params,
+       dst_data.data(), params, &cpu_backend_context);
+  ReferenceGemm(lhs_params, lhs_data.data(), rhs_params, rhs_data.data(),
+                dst_params, expected.data(), params, &cpu_backend_context);
+  EXPECT_EQ(dst_data, expected) << rows << "x" << depth << "x" << cols;
+}
+
+// On x86 CPUs with AMX, these GEMMs have enough columns to run on tiles, and
+// depths and numbers of rows that aren't multiples of the tile sizes.
+TEST(CpuBackendGemmRawAccumulatorTest, Int8) {
+  for (int num_threads : {1, 3}) {
+    TestRawAccumulatorGemm(1, 1, 1, num_threads);
+    TestRawAccumulatorGemm(7, 33, 9, num_threads);
+    TestRawAccumulatorGemm(32, 64, 16, num_threads);
+    TestRawAccumulatorGemm(100, 130, 35, num_threads);
+    TestRawAccumulatorGemm(257, 300, 64, num_threads);
+  }
+}
+
 template <typename tLhsScalar, typename tRhsScalar, typename tAccumScalar,
           typename tDstScalar>
 struct TypesTuple {
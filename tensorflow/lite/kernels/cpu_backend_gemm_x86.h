@@ -21,7 +21,10 @@ limitations under the License.
 // available on the given x86 platform.
 #ifndef TFLITE_WITH_RUY
 
+#include <cstdint>
+
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_gemm_amx.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_eigen.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_gemmlowp.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
@@ -97,6 +100,39 @@ struct GemmImplX86<std::int8_t, std::int8_t, std::int32_t, std::int8_t,
     : detail::GemmImplUsingRuy<std::int8_t, std::int8_t, std::int32_t,
                                std::int8_t, quantization_flavor> {};
 #endif  // not GEMMLOWP_NEON
+
+// Raw int32 accumulators, i.e. AccumScalar == DstScalar == int32, are
+// otherwise computed by ruy. Returns true if it computed them.
+template <typename LhsScalar, typename RhsScalar,
+          QuantizationFlavor quantization_flavor>
+struct RawAccumulatorGemmImplX86 {
+  static bool TryRun(
+      const MatrixParams<LhsScalar>& lhs_params, const LhsScalar* lhs_data,
+      const MatrixParams<RhsScalar>& rhs_params, const RhsScalar* rhs_data,
+      const MatrixParams<std::int32_t>& dst_params, std::int32_t* dst_data,
+      const GemmParams<std::int32_t, std::int32_t, quantization_flavor>& params,
+      CpuBackendContext* context) {
+    return false;
+  }
+};
+
+// int8 GEMMs, as used by the hybrid kernels, run on AMX tiles when the CPU
+// has them.
+template <QuantizationFlavor quantization_flavor>
+struct RawAccumulatorGemmImplX86<std::int8_t, std::int8_t,
+                                 quantization_flavor> {
+  static bool TryRun(
+      const MatrixParams<std::int8_t>& lhs_params, const std::int8_t* lhs_data,
+      const MatrixParams<std::int8_t>& rhs_params, const std::int8_t* rhs_data,
+      const MatrixParams<std::int32_t>& dst_params, std::int32_t* dst_data,
+      const GemmParams<std::int32_t, std::int32_t, quantization_flavor>& params,
+      CpuBackendContext* context) {
+    return GemmImplUsingAmx::TryRun(lhs_params, lhs_data, rhs_params, rhs_data,
+                                    dst_params, dst_data, params.bias,
+                                    params.clamp_min, params.clamp_max,
+                                    context);
+  }
+};
 }  // namespace detail
 }  // namespace cpu_backend_gemm
 }  // namespace tflite
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/optimized/fully_connected_4bit.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
+#include "tensorflow/lite/kernels/internal/optimized/sparse_ops/block_sparse.h"
 #include "tensorflow/lite/kernels/internal/optimized/sparse_ops/fully_connected.h"
 #include "tensorflow/lite/kernels/internal/quantization_util.h"
 #include "tensorflow/lite/kernels/internal/reference/fully_connected.h"
@@ -65,6 +66,15 @@ bool SupportedSparsityFormat(const TfLiteSparsity& sparsity) {
 static const int kDimMetadataSizeRandomSparse = 2;
 static const int kDimMetadataSizeBlockSparse = 3;
 
+// Whether the weights are made of 1 x `block_cols` blocks, which have
+// dedicated kernels.
+bool IsBlockSparse1xN(const TfLiteSparsity& sparsity, int block_cols) {
+  return sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
+         sparsity.block_map != nullptr && sparsity.block_map->size == 1 &&
+         sparsity.block_map->data[0] == 1 &&
+         sparsity.dim_metadata[2].dense_size == block_cols;
+}
+
 TfLiteStatus CreateLedgerTensor(const TfLiteSparsity* sparsity,
                                 TfLiteContext* context, TfLiteTensor* ledger) {
   TF_LITE_ENSURE(context, sparsity != nullptr);
@@ -157,6 +167,10 @@ struct OpData {
   bool compute_row_sums = false;
   // Only used for sparse hybrid fully connected kernels.
   bool ledger_initialized;
+  // Whether the float or int8 filter is in a block sparse format supported by
+  // `FullyConnectedBlockSparseWeight`, whose structure is read in Prepare.
+  bool is_block_sparse = false;
+  optimized_ops::BlockSparseMatrix block_sparse_filter;
   // Used for 4bit hybrid
   std::unique_ptr<optimized_4bit::OpData4Bit> op_data_4bit = nullptr;
   TfLiteType quantized_bias_type = kTfLiteNoType;
@@ -514,6 +528,17 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
        (filter->type == kTfLiteUInt8 || filter->type == kTfLiteInt8 ||
         filter->type == kTfLiteInt4));
   const bool is_sparse = filter->sparsity != nullptr;
+  data->is_block_sparse = false;
+  if (is_sparse && !is_hybrid &&
+      (filter->type == kTfLiteFloat32 || filter->type == kTfLiteInt8)) {
+    size_t filter_type_size;
+    TF_LITE_ENSURE_STATUS(
+        GetSizeOfType(context, filter->type, &filter_type_size));
+    data->is_block_sparse = optimized_ops::GetBlockSparseMatrix(
+        *filter->sparsity, GetTensorShape(filter),
+        static_cast<int>(filter->bytes / filter_type_size),
+        &data->block_sparse_filter);
+  }
   if (is_hybrid) {
     // Use optimized implementation for 4bit
     if (filter->type == kTfLiteInt4 && kernel_type == kGenericOptimized &&
@@ -1357,8 +1382,7 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
           }
           // Int4 support for sparse filter tensor is currently not supported
           TF_LITE_ENSURE(context, filter->type != kTfLiteInt4);
-          if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
-              sparsity.dim_metadata[2].dense_size == 16) {
+          if (IsBlockSparse1xN(sparsity, 16)) {
             // Block sparse with block size of 1x16.
             optimized_ops::FullyConnectedSparseWeight1x16(
                 sparsity, op_params, input_shape, GetTensorData<int8_t>(input),
@@ -1368,6 +1392,18 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                 GetTensorData<int32_t>(bias), output_shape,
                 GetTensorData<int8_t>(output),
                 CpuBackendContext::GetFromContext(context));
+          } else if (data->is_block_sparse) {
+            // Block sparse with any other block size, e.g. 4x4 or 8x1.
+            optimized_ops::FullyConnectedBlockSparseWeight(
+                data->block_sparse_filter, op_params, input_shape,
+                GetTensorData<int8_t>(input), GetTensorData<int8_t>(filter),
+                is_per_channel ? data->per_channel_output_multiplier.data()
+                               : nullptr,
+                is_per_channel ? data->per_channel_output_shift.data()
+                               : nullptr,
+                GetTensorData<int32_t>(bias), output_shape,
+                GetTensorData<int8_t>(output),
+                CpuBackendContext::GetFromContext(context));
           } else {
             TF_LITE_KERNEL_LOG(
                 context, "Unsupported sparse fully-connected weight format.");
@@ -1576,8 +1612,7 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             filter_shape, GetTensorData<float>(filter),  // Disable formatting
             bias_shape, GetTensorData<float>(bias),      // Disable formatting
             output_shape, GetTensorData<float>(output));
-      } else if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
-                 sparsity.dim_metadata[2].dense_size == 4) {
+      } else if (IsBlockSparse1xN(sparsity, 4)) {
         // Block sparse with block size of 1x4.
         optimized_ops::FullyConnectedSparseWeight1x4(
             sparsity, op_params,                         // Disable formatting
@@ -1586,6 +1621,14 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
             bias_shape, GetTensorData<float>(bias),      // Disable formatting
             output_shape, GetTensorData<float>(output),
             CpuBackendContext::GetFromContext(context));
+      } else if (data->is_block_sparse) {
+        // Block sparse with any other block size, e.g. 4x4 or 8x1.
+        optimized_ops::FullyConnectedBlockSparseWeight(
+            data->block_sparse_filter, op_params, input_shape,
+            GetTensorData<float>(input), GetTensorData<float>(filter),
+            GetTensorData<float>(bias), output_shape,
+            GetTensorData<float>(output),
+            CpuBackendContext::GetFromContext(context));
       } else {
         TF_LITE_KERNEL_LOG(context,
                            "Unsupported sparse fully-connected weight format.");
@@ -30,6 +30,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
 #include "tensorflow/lite/core/interpreter.h"
 #include "tensorflow/lite/kernels/test_util.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -2150,6 +2151,95 @@ TEST_P(SparseFullyConnectedOpTest, Simple1x4TestMultiThreadedMoreBatches) {
   }
 }
 
+TEST_P(SparseFullyConnectedOpTest, Simple4x4Test) {
+  std::initializer_list<float> weight_data = {
+      1,  2, 3, 4, 0, 0, 0,  0,   // u = 0
+      0,  1, 0, 1, 0, 0, 0,  0,   // u = 1
+      -1, 0, 0, 2, 0, 0, 0,  0,   // u = 2
+      1,  1, 1, 1, 0, 0, 0,  0,   // u = 3
+      0,  0, 0, 0, 2, 0, 0,  -1,  // u = 4
+      0,  0, 0, 0, 0, 1, 1,  0,   // u = 5
+      0,  0, 0, 0, 1, 0, -2, 0,   // u = 6
+      0,  0, 0, 0, 3, 1, 0,  1,   // u = 7
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {8, 8};
+  weight.traversal_order = {0, 1, 2, 3};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0, 1};
+  weight.block_size = {4, 4};
+  for (int num_threads = 1; num_threads <= 4; num_threads++) {
+    SparseFullyConnectedOpModel<float> m(
+        GetRegistration(),
+        /*units=*/8, /*batches=*/2,
+        /*input=*/{TensorType_FLOAT32, {2, 8}}, weight, weight_data,
+        /*output=*/{TensorType_FLOAT32},
+        /*bias_tensor_optional=*/false, /*num_threads=*/num_threads);
+    m.SetBias({1, 2, 3, 4, 5, 6, 7, 8});
+
+    m.SetInput({
+        1, 2, 3, 4, -1, -2, 3, 1,   // b = 0
+        4, 3, -2, 1, 2, 1, 0, -3,   // b = 1
+    });
+
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 8));
+    EXPECT_THAT(m.GetOutput(), ElementsAreArray({
+                                   31, 8, 10, 14, 2, 7, 0, 4,   // b = 0
+                                   9, 6, 1, 10, 12, 7, 9, 12,  // b = 1
+                               }));
+  }
+}
+
+TEST_P(SparseFullyConnectedOpTest, Simple8x1Test) {
+  std::initializer_list<float> weight_data = {
+      1,  0, 0, 2,   // u = 0
+      2,  0, 0, -1,  // u = 1
+      3,  0, 0, 1,   // u = 2
+      1,  0, 0, 0,   // u = 3
+      -1, 0, 0, 0,   // u = 4
+      0,  0, 0, 0,   // u = 5
+      0,  0, 0, 1,   // u = 6
+      4,  0, 0, 1,   // u = 7
+      0,  1, 0, 0,   // u = 8
+      0,  2, 0, 0,   // u = 9
+      0,  0, 0, 0,   // u = 10
+      0,  -1, 0, 0,  // u = 11
+      0,  0, 0, 0,   // u = 12
+      0,  0, 0, 0,   // u = 13
+      0,  0, 0, 0,   // u = 14
+      0,  3, 0, 0,   // u = 15
+  };
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {16, 4};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0};
+  weight.block_size = {8};
+  SparseFullyConnectedOpModel<float> m(GetRegistration(),
+                                       /*units=*/16, /*batches=*/2,
+                                       /*input=*/{TensorType_FLOAT32, {2, 4}},
+                                       weight, weight_data);
+  m.SetBias(std::vector<float>(16, 1));
+
+  m.SetInput({
+      1, 2, 3, 4,    // b = 0
+      -1, 1, 2, -2,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 16));
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray({
+                  10, 0, 8, 2, 0, 1, 5, 9, 3, 5, 1, 0, 1, 1, 1, 7,  // b = 0
+                  0,  1, 0, 0, 2, 1, 0, 0, 2, 3, 1, 0, 1, 1, 1, 4,  // b = 1
+              }));
+}
+
 TEST_P(SparseHybridFullyConnectedOpTest, SparseHybrid1x16Test) {
   std::initializer_list<float> weight_data = {
       /* 1st row */
@@ -2511,9 +2601,205 @@ TEST_P(SparseQuantizedFullyConnectedOpTest,
   EXPECT_THAT(m.GetOutput(), ElementsAre(11, 1, 25, 0, 1, 21));
 }
 
+TEST_P(SparseQuantizedFullyConnectedOpTest, Simple4x4Test) {
+  std::vector<float> weight_data = {
+      1,  2, 3, 4, 0, 0, 0,  0,   // u = 0
+      0,  1, 0, 1, 0, 0, 0,  0,   // u = 1
+      -1, 0, 0, 2, 0, 0, 0,  0,   // u = 2
+      1,  1, 1, 1, 0, 0, 0,  0,   // u = 3
+      0,  0, 0, 0, 2, 0, 0,  -1,  // u = 4
+      0,  0, 0, 0, 0, 1, 1,  0,   // u = 5
+      0,  0, 0, 0, 1, 0, -2, 0,   // u = 6
+      0,  0, 0, 0, 3, 1, 0,  1,   // u = 7
+  };
+  TensorData weight = {TensorType_INT8, {8, 8}, 0, 0, 1};
+  weight.traversal_order = {0, 1, 2, 3};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0, 1};
+  weight.block_size = {4, 4};
+  SparseQuantizedFullyConnectedOpModel m(
+      GetRegistration(),
+      /*units=*/8, /*batches=*/2,
+      /*input=*/{TensorType_INT8, {2, 8}, 0, 0, 1}, weight, weight_data,
+      /*output=*/{TensorType_INT8, {}, 0, 0, 1});
+
+  m.SetBias({1, 2, 3, 4, 5, 6, 7, 8});
+  m.SetInput({
+      1, 2, 3, 4, -1, -2, 3, 1,   // b = 0
+      4, 3, -2, 1, 2, 1, 0, -3,   // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 8));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(31, 8, 10, 14, 2, 7, 0, 4,    // b = 0
+                                         9, 6, 1, 10, 12, 7, 9, 12));  // b = 1
+}
+
+TEST_P(SparseQuantizedFullyConnectedOpTest, Simple8x1TestInputZeroPoint) {
+  std::vector<float> weight_data = {
+      1,  0, 0, 2,   // u = 0
+      2,  0, 0, -1,  // u = 1
+      3,  0, 0, 1,   // u = 2
+      1,  0, 0, 0,   // u = 3
+      -1, 0, 0, 0,   // u = 4
+      0,  0, 0, 0,   // u = 5
+      0,  0, 0, 1,   // u = 6
+      4,  0, 0, 1,   // u = 7
+      0,  1, 0, 0,   // u = 8
+      0,  2, 0, 0,   // u = 9
+      0,  0, 0, 0,   // u = 10
+      0,  -1, 0, 0,  // u = 11
+      0,  0, 0, 0,   // u = 12
+      0,  0, 0, 0,   // u = 13
+      0,  0, 0, 0,   // u = 14
+      0,  3, 0, 0,   // u = 15
+  };
+  TensorData weight = {TensorType_INT8, {16, 4}, 0, 0, 1};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {0};
+  weight.block_size = {8};
+  SparseQuantizedFullyConnectedOpModel m(
+      GetRegistration(),
+      /*units=*/16, /*batches=*/2,
+      /*input=*/{TensorType_INT8, {2, 4}, 0, 0, 1, 2}, weight, weight_data,
+      /*output=*/{TensorType_INT8, {}, 0, 0, 1});
+
+  m.SetBias(std::vector<float>(16, 1));
+  m.SetInput({
+      1, 2, 3, 4,    // b = 0
+      -1, 1, 2, -2,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 16));
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray({
+                  10, 0, 8, 2, 0, 1, 5, 9, 3, 5, 1, 0, 1, 1, 1, 7,  // b = 0
+                  0,  1, 0, 0, 2, 1, 0, 0, 2, 3, 1, 0, 1, 1, 1, 4,  // b = 1
+              }));
+}
+
+TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x4TestInputZeroPoint) {
+  std::vector<float> weight_data = {
+      1, 2, 3, 4,  0, 0, 0,  0,  // u = 0
+      0, 0, 0, 0,  -1, 2, 0, 1,  // u = 1
+      1, 1, 1, 1,  2, 0, -2, 1,  // u = 2
+  };
+  TensorData weight = {TensorType_INT8, {3, 8}, 0, 0, 1};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {1};
+  weight.block_size = {4};
+  SparseQuantizedFullyConnectedOpModel m(
+      GetRegistration(),
+      /*units=*/3, /*batches=*/2,
+      /*input=*/{TensorType_INT8, {2, 8}, 0, 0, 1, 3}, weight, weight_data,
+      /*output=*/{TensorType_INT8, {}, 0, 0, 1});
+
+  m.SetBias({1, 2, 3});
+  m.SetInput({
+      1, 2, 3, 4, -1, -2, 3, 1,  // b = 0
+      4, 3, -2, 1, 2, 1, 0, -3,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(31, 0, 6, 9, 0, 10));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     SparseQuantizedFullyConnectedOpTest, SparseQuantizedFullyConnectedOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMapNoPie)));
 
+// Run with --benchmark_filter=FullyConnectedFloat to compare the latency of
+// the sparse kernels for a range of block shapes and sparsity levels to that
+// of the dense kernel with the same shapes.
+void BM_SparseFullyConnectedFloat(benchmark::State& state) {
+  const int block_rows = state.range(0);
+  const int block_cols = state.range(1);
+  const int sparsity_percent = state.range(2);
+  const int batches = state.range(3);
+  constexpr int kUnits = 1024;
+  constexpr int kInputSize = 1024;
+  std::mt19937 random_engine(1);
+  std::uniform_int_distribution<int> percent(0, 99);
+  std::vector<float> weight_data(kUnits * kInputSize, 0.0f);
+  for (int row = 0; row < kUnits; row += block_rows) {
+    for (int col = 0; col < kInputSize; col += block_cols) {
+      if (percent(random_engine) < sparsity_percent) continue;
+      for (int r = 0; r < block_rows; ++r) {
+        for (int c = 0; c < block_cols; ++c) {
+          weight_data[(row + r) * kInputSize + col + c] = 0.01f;
+        }
+      }
+    }
+  }
+  TensorData weight = {};
+  weight.type = TensorType_FLOAT32;
+  weight.shape = {kUnits, kInputSize};
+  weight.traversal_order = {0, 1};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  if (block_rows > 1) {
+    weight.block_map.push_back(0);
+    weight.block_size.push_back(block_rows);
+  }
+  if (block_cols > 1) {
+    weight.block_map.push_back(1);
+    weight.block_size.push_back(block_cols);
+  }
+  for (size_t i = 0; i < weight.block_map.size(); ++i) {
+    weight.traversal_order.push_back(2 + i);
+  }
+  SparseFullyConnectedOpModel<float> m(
+      ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT(), kUnits, batches,
+      /*input=*/{TensorType_FLOAT32, {batches, kInputSize}}, weight,
+      weight_data);
+  m.SetBias(std::vector<float>(kUnits, 0.0f));
+  m.SetInput(std::vector<float>(batches * kInputSize, 1.0f));
+  for (auto _ : state) {
+    if (m.Invoke() != kTfLiteOk) {
+      state.SkipWithError("Invoke failed");
+      break;
+    }
+  }
+}
+
+void BM_DenseFullyConnectedFloat(benchmark::State& state) {
+  const int batches = state.range(0);
+  constexpr int kUnits = 1024;
+  constexpr int kInputSize = 1024;
+  FloatFullyConnectedOpModel m(
+      ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT(), kUnits, batches,
+      /*input=*/{TensorType_FLOAT32, {batches, kInputSize}});
+  m.SetWeights(std::vector<float>(kUnits * kInputSize, 0.01f));
+  m.SetBias(std::vector<float>(kUnits, 0.0f));
+  m.SetInput(std::vector<float>(batches * kInputSize, 1.0f));
+  for (auto _ : state) {
+    if (m.Invoke() != kTfLiteOk) {
+      state.SkipWithError("Invoke failed");
+      break;
+    }
+  }
+}
+
+BENCHMARK(BM_DenseFullyConnectedFloat)->ArgNames({"batches"})->Arg(1)->Arg(8);
+
+BENCHMARK(BM_SparseFullyConnectedFloat)
+    ->ArgNames({"block_rows", "block_cols", "sparsity", "batches"})
+    ->Apply([](benchmark::internal::Benchmark* benchmark) {
+      for (const auto& block : {std::make_pair(1, 4), std::make_pair(4, 4),
+                                std::make_pair(8, 1)}) {
+        for (int sparsity : {0, 50, 80, 90, 95}) {
+          for (int batches : {1, 8}) {
+            benchmark->Args({block.first, block.second, sparsity, batches});
+          }
+        }
+      }
+    });
+
 }  // namespace
 }  // namespace tflite
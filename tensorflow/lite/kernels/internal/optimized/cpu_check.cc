@@ -19,6 +19,19 @@ limitations under the License.
 #include <sys/auxv.h>
 #endif
 
+#if (defined __x86_64__ || defined __i386__) && \
+    (defined __GNUC__ || defined __clang__)
+#define TFLITE_X86_CPUID
+#include <cpuid.h>
+
+#include <cstdint>
+#endif
+
+#if defined TFLITE_X86_CPUID && defined __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace tflite {
 
 namespace {
@@ -37,6 +50,26 @@ bool DetectDotprodByLinuxAuxvMethod() {
 }
 #endif
 
+#ifdef TFLITE_X86_CPUID
+// Returns the state components the OS saves on context switches, or 0 if it
+// doesn't use XSAVE.
+uint64_t GetXcr0() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE)) {
+    return 0;
+  }
+  // xgetbv, encoded so that this file doesn't need -mxsave.
+  uint32_t xcr0_lo, xcr0_hi;
+  __asm__(".byte 0x0f, 0x01, 0xd0" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+  return (static_cast<uint64_t>(xcr0_hi) << 32) | xcr0_lo;
+}
+
+bool GetCpuidLeaf7(unsigned int* ebx, unsigned int* ecx, unsigned int* edx) {
+  unsigned int eax;
+  return __get_cpuid_count(7, 0, &eax, ebx, ecx, edx);
+}
+#endif
+
 }  // namespace
 
 bool DetectArmNeonDotprod() {
@@ -47,4 +80,44 @@ bool DetectArmNeonDotprod() {
 #endif
 }
 
+bool DetectX86Avx512Vnni() {
+#ifdef TFLITE_X86_CPUID
+  constexpr unsigned int kAvx512fBit = 1u << 16;     // In ebx.
+  constexpr unsigned int kAvx512bwBit = 1u << 30;    // In ebx.
+  constexpr unsigned int kAvx512VnniBit = 1u << 11;  // In ecx.
+  constexpr uint64_t kAvx512State = 0xe6;            // SSE to ZMM state.
+  unsigned int ebx, ecx, edx;
+  return GetCpuidLeaf7(&ebx, &ecx, &edx) && (ebx & kAvx512fBit) &&
+         (ebx & kAvx512bwBit) && (ecx & kAvx512VnniBit) &&
+         (GetXcr0() & kAvx512State) == kAvx512State;
+#else
+  return false;
+#endif
+}
+
+bool DetectX86AmxInt8() {
+#ifdef TFLITE_X86_CPUID
+  constexpr unsigned int kAmxTileBit = 1u << 24;  // In edx.
+  constexpr unsigned int kAmxInt8Bit = 1u << 25;  // In edx.
+  constexpr uint64_t kAmxState = 0x60000;         // XTILECFG and XTILEDATA.
+  unsigned int ebx, ecx, edx;
+  if (!GetCpuidLeaf7(&ebx, &ecx, &edx) || !(edx & kAmxTileBit) ||
+      !(edx & kAmxInt8Bit) || (GetXcr0() & kAmxState) != kAmxState) {
+    return false;
+  }
+#ifdef __linux__
+  // Linux only lets processes use the tile data registers once they asked for
+  // them. These are the values of ARCH_REQ_XCOMP_PERM and XFEATURE_XTILEDATA,
+  // which older headers don't define.
+  constexpr int kArchReqXcompPerm = 0x1023;
+  constexpr int kXfeatureXtiledata = 18;
+  return syscall(SYS_arch_prctl, kArchReqXcompPerm, kXfeatureXtiledata) == 0;
+#else
+  return true;
+#endif
+#else
+  return false;
+#endif
+}
+
 }  // namespace tflite
@@ -27,6 +27,15 @@ namespace tflite {
 // On other architectures, returns false unconditionally.
 bool DetectArmNeonDotprod();
 
+// On x86, returns true if the CPU and the OS support AVX-512 VNNI.
+// On other architectures, returns false unconditionally.
+bool DetectX86Avx512Vnni();
+
+// On x86, returns true if the CPU supports AMX int8 tiles and the OS lets
+// this process use them, requesting the permission on Linux.
+// On other architectures, returns false unconditionally.
+bool DetectX86AmxInt8();
+
 struct CpuFlags {
   bool neon_dotprod = false;
 };
@@ -0,0 +1,552 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_BLOCK_SPARSE_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_BLOCK_SPARSE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "ruy/profiler/instrumentation.h"  // from @ruy
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace optimized_ops {
+
+// A `rows` x `cols` weights matrix in the block compressed sparse row format.
+// Row block i has the non-zero `block_rows` x `block_cols` blocks k in
+// [block_segments[i], block_segments[i + 1]), in the column block
+// block_indices[k], whose values are stored row-major from
+// k * block_rows * block_cols in the weights data.
+struct BlockSparseMatrix {
+  int rows = 0;
+  int cols = 0;
+  int block_rows = 1;
+  int block_cols = 1;
+  int num_blocks = 0;
+  const int* block_segments = nullptr;
+  const int* block_indices = nullptr;
+};
+
+// Reads the block sparse format of weights whose first dimension is the output
+// depth and last dimension the accumulation depth, the others being 1, e.g.
+// fully-connected weights or 1x1 convolution filters. Blocks may span both
+// dimensions, as with the 1x4, 4x4 or 8x1 blocks of the converter. Returns
+// false if `sparsity` is in another format, or doesn't match the shape or the
+// `num_values` values of the weights.
+inline bool GetBlockSparseMatrix(const TfLiteSparsity& sparsity,
+                                 const RuntimeShape& weights_shape,
+                                 int num_values, BlockSparseMatrix* matrix) {
+  const int dims_count = weights_shape.DimensionsCount();
+  const int num_block_dims = sparsity.dim_metadata_size - dims_count;
+  const int block_map_size =
+      sparsity.block_map != nullptr ? sparsity.block_map->size : 0;
+  if (dims_count < 2 || num_block_dims < 0 || num_block_dims > 2 ||
+      block_map_size != num_block_dims || sparsity.traversal_order == nullptr ||
+      sparsity.traversal_order->size != sparsity.dim_metadata_size) {
+    return false;
+  }
+  // Only the traversal of the blocks in row-major order, with the accumulation
+  // depth as the only sparse dimension, is supported.
+  for (int i = 0; i < sparsity.dim_metadata_size; ++i) {
+    const TfLiteDimensionMetadata& metadata = sparsity.dim_metadata[i];
+    if (sparsity.traversal_order->data[i] != i) return false;
+    if (i == dims_count - 1) {
+      if (metadata.format != kTfLiteDimSparseCSR) return false;
+    } else if (metadata.format != kTfLiteDimDense) {
+      return false;
+    } else if (i > 0 && i < dims_count - 1 &&
+               (metadata.dense_size != 1 || weights_shape.Dims(i) != 1)) {
+      return false;
+    }
+  }
+
+  matrix->rows = weights_shape.Dims(0);
+  matrix->cols = weights_shape.Dims(dims_count - 1);
+  matrix->block_rows = 1;
+  matrix->block_cols = 1;
+  for (int i = 0; i < num_block_dims; ++i) {
+    const int blocked_dim = sparsity.block_map->data[i];
+    const int block_size = sparsity.dim_metadata[dims_count + i].dense_size;
+    if (blocked_dim == 0 && i == 0) {
+      matrix->block_rows = block_size;
+    } else if (blocked_dim == dims_count - 1 && i == num_block_dims - 1) {
+      matrix->block_cols = block_size;
+    } else {
+      return false;
+    }
+  }
+  if (matrix->block_rows <= 0 || matrix->block_cols <= 0 ||
+      matrix->rows % matrix->block_rows != 0 ||
+      matrix->cols % matrix->block_cols != 0) {
+    return false;
+  }
+  const int row_blocks = matrix->rows / matrix->block_rows;
+  const int col_blocks = matrix->cols / matrix->block_cols;
+  if (sparsity.dim_metadata[0].dense_size != row_blocks) return false;
+
+  const TfLiteIntArray* segments =
+      sparsity.dim_metadata[dims_count - 1].array_segments;
+  const TfLiteIntArray* indices =
+      sparsity.dim_metadata[dims_count - 1].array_indices;
+  if (segments == nullptr || indices == nullptr ||
+      segments->size != row_blocks + 1 || segments->data[0] != 0 ||
+      segments->data[row_blocks] != indices->size ||
+      static_cast<int64_t>(indices->size) * matrix->block_rows *
+              matrix->block_cols >
+          num_values) {
+    return false;
+  }
+  for (int i = 0; i < row_blocks; ++i) {
+    if (segments->data[i] > segments->data[i + 1]) return false;
+  }
+  for (int i = 0; i < indices->size; ++i) {
+    if (indices->data[i] < 0 || indices->data[i] >= col_blocks) return false;
+  }
+  matrix->num_blocks = indices->size;
+  matrix->block_segments = segments->data;
+  matrix->block_indices = indices->data;
+  return true;
+}
+
+// Adds the products of the blocks of row block `row_block` with `input` to
+// the `block_rows` values of `output`. The generic version handles any block
+// shape, one row at a time.
+inline void BlockSparseRowBlockMultiplyAccumulate(
+    const BlockSparseMatrix& matrix, int row_block, const float* input,
+    const float* weights_data, float* output) {
+  const int block_rows = matrix.block_rows;
+  const int block_cols = matrix.block_cols;
+  const int block_size = block_rows * block_cols;
+  const int block_start = matrix.block_segments[row_block];
+  const int block_end = matrix.block_segments[row_block + 1];
+  for (int r = 0; r < block_rows; ++r) {
+    float sum = 0.0f;
+    for (int k = block_start; k < block_end; ++k) {
+      const float* block_input = input + matrix.block_indices[k] * block_cols;
+      const float* row_weights = weights_data + k * block_size + r * block_cols;
+      for (int c = 0; c < block_cols; ++c) {
+        sum += row_weights[c] * block_input[c];
+      }
+    }
+    output[r] += sum;
+  }
+}
+
+// Same as above for a block shape known at compile time, which lets the
+// compiler unroll and vectorize the block.
+template <int kBlockRows, int kBlockCols>
+inline void BlockSparseRowBlockMultiplyAccumulate(
+    const BlockSparseMatrix& matrix, int row_block, const float* input,
+    const float* weights_data, float* output) {
+  constexpr int kBlockSize = kBlockRows * kBlockCols;
+  float sums[kBlockRows] = {};
+  for (int k = matrix.block_segments[row_block];
+       k < matrix.block_segments[row_block + 1]; ++k) {
+    const float* block_input = input + matrix.block_indices[k] * kBlockCols;
+    const float* block_weights = weights_data + k * kBlockSize;
+    for (int r = 0; r < kBlockRows; ++r) {
+      for (int c = 0; c < kBlockCols; ++c) {
+        sums[r] += block_weights[r * kBlockCols + c] * block_input[c];
+      }
+    }
+  }
+  for (int r = 0; r < kBlockRows; ++r) {
+    output[r] += sums[r];
+  }
+}
+
+#ifdef USE_NEON
+template <>
+inline void BlockSparseRowBlockMultiplyAccumulate<4, 4>(
+    const BlockSparseMatrix& matrix, int row_block, const float* input,
+    const float* weights_data, float* output) {
+  float32x4_t sums = vdupq_n_f32(0.0f);
+  for (int k = matrix.block_segments[row_block];
+       k < matrix.block_segments[row_block + 1]; ++k) {
+    const float32x4_t block_input =
+        vld1q_f32(input + matrix.block_indices[k] * 4);
+    // De-interleaving the row-major block gives its columns.
+    const float32x4x4_t columns = vld4q_f32(weights_data + k * 16);
+    sums = vmlaq_lane_f32(sums, columns.val[0], vget_low_f32(block_input), 0);
+    sums = vmlaq_lane_f32(sums, columns.val[1], vget_low_f32(block_input), 1);
+    sums = vmlaq_lane_f32(sums, columns.val[2], vget_high_f32(block_input), 0);
+    sums = vmlaq_lane_f32(sums, columns.val[3], vget_high_f32(block_input), 1);
+  }
+  vst1q_f32(output, vaddq_f32(vld1q_f32(output), sums));
+}
+
+template <>
+inline void BlockSparseRowBlockMultiplyAccumulate<8, 1>(
+    const BlockSparseMatrix& matrix, int row_block, const float* input,
+    const float* weights_data, float* output) {
+  float32x4_t sums_0 = vdupq_n_f32(0.0f);
+  float32x4_t sums_1 = vdupq_n_f32(0.0f);
+  for (int k = matrix.block_segments[row_block];
+       k < matrix.block_segments[row_block + 1]; ++k) {
+    const float block_input = input[matrix.block_indices[k]];
+    const float* block_weights = weights_data + k * 8;
+    sums_0 = vmlaq_n_f32(sums_0, vld1q_f32(block_weights), block_input);
+    sums_1 = vmlaq_n_f32(sums_1, vld1q_f32(block_weights + 4), block_input);
+  }
+  vst1q_f32(output, vaddq_f32(vld1q_f32(output), sums_0));
+  vst1q_f32(output + 4, vaddq_f32(vld1q_f32(output + 4), sums_1));
+}
+#endif  // USE_NEON
+
+// Computes the outputs of the batches in [batch_start, batch_end) for the row
+// blocks in [row_block_start, row_block_end).
+inline void BlockSparseFullyConnectedImpl(
+    const BlockSparseMatrix& matrix, const FullyConnectedParams& params,
+    const float* input_data, const float* weights_data, const float* bias_data,
+    float* output_data, int batch_start, int batch_end, int row_block_start,
+    int row_block_end) {
+  const int block_rows = matrix.block_rows;
+  const int block_cols = matrix.block_cols;
+  void (*multiply_accumulate)(const BlockSparseMatrix&, int, const float*,
+                              const float*, float*) =
+      BlockSparseRowBlockMultiplyAccumulate;
+  if (block_rows == 4 && block_cols == 4) {
+    multiply_accumulate = BlockSparseRowBlockMultiplyAccumulate<4, 4>;
+  } else if (block_rows == 8 && block_cols == 1) {
+    multiply_accumulate = BlockSparseRowBlockMultiplyAccumulate<8, 1>;
+  }
+  for (int b = batch_start; b < batch_end; ++b) {
+    const float* input = input_data + b * matrix.cols;
+    for (int row_block = row_block_start; row_block < row_block_end;
+         ++row_block) {
+      const int row_start = row_block * block_rows;
+      float* output = output_data + b * matrix.rows + row_start;
+      for (int r = 0; r < block_rows; ++r) {
+        output[r] = bias_data != nullptr ? bias_data[row_start + r] : 0.0f;
+      }
+      multiply_accumulate(matrix, row_block, input, weights_data, output);
+      for (int r = 0; r < block_rows; ++r) {
+        output[r] = ActivationFunctionWithMinMax(
+            output[r], params.float_activation_min,
+            params.float_activation_max);
+      }
+    }
+  }
+}
+
+// Requantizes the accumulator of output row `row` to int8 with either the per
+// channel multipliers and shifts, or those of `params`.
+inline int8_t BlockSparseRequantize(const FullyConnectedParams& params,
+                                    const int32_t* per_channel_multiplier,
+                                    const int32_t* per_channel_shift,
+                                    const int32_t* bias_data, int row,
+                                    int32_t acc) {
+  if (bias_data != nullptr) acc += bias_data[row];
+  acc = MultiplyByQuantizedMultiplier(
+      acc,
+      per_channel_multiplier != nullptr ? per_channel_multiplier[row]
+                                        : params.output_multiplier,
+      per_channel_shift != nullptr ? per_channel_shift[row]
+                                   : params.output_shift);
+  acc += params.output_offset;
+  acc = std::max(acc, params.quantized_activation_min);
+  acc = std::min(acc, params.quantized_activation_max);
+  return static_cast<int8_t>(acc);
+}
+
+// Returns the int32 sum of the products of row `r` of the blocks of row block
+// `row_block` with `input` offset by `input_offset`, for any block shape.
+inline int32_t BlockSparseRowMultiplyAccumulate(const BlockSparseMatrix& matrix,
+                                               int row_block, int r,
+                                               const int8_t* input,
+                                               int32_t input_offset,
+                                               const int8_t* weights_data) {
+  const int block_cols = matrix.block_cols;
+  const int block_size = matrix.block_rows * block_cols;
+  int32_t sum = 0;
+  for (int k = matrix.block_segments[row_block];
+       k < matrix.block_segments[row_block + 1]; ++k) {
+    const int8_t* block_input = input + matrix.block_indices[k] * block_cols;
+    const int8_t* row_weights = weights_data + k * block_size + r * block_cols;
+    for (int c = 0; c < block_cols; ++c) {
+      sum += row_weights[c] * (block_input[c] + input_offset);
+    }
+  }
+  return sum;
+}
+
+// Stores in `accumulators` the `kBlockRows` int32 sums of the products of the
+// blocks of row block `row_block` with `input` offset by `input_offset`.
+template <int kBlockRows, int kBlockCols>
+inline void BlockSparseRowBlockMultiplyAccumulate(
+    const BlockSparseMatrix& matrix, int row_block, const int8_t* input,
+    int32_t input_offset, const int8_t* weights_data, int32_t* accumulators) {
+  constexpr int kBlockSize = kBlockRows * kBlockCols;
+  int32_t sums[kBlockRows] = {};
+  for (int k = matrix.block_segments[row_block];
+       k < matrix.block_segments[row_block + 1]; ++k) {
+    const int8_t* block_input = input + matrix.block_indices[k] * kBlockCols;
+    const int8_t* block_weights = weights_data + k * kBlockSize;
+    for (int r = 0; r < kBlockRows; ++r) {
+      for (int c = 0; c < kBlockCols; ++c) {
+        sums[r] +=
+            block_weights[r * kBlockCols + c] * (block_input[c] + input_offset);
+      }
+    }
+  }
+  for (int r = 0; r < kBlockRows; ++r) {
+    accumulators[r] = sums[r];
+  }
+}
+
+#ifdef USE_NEON
+// Loads 4 int8 values, which may be unaligned, widened to int16 and offset by
+// `offset`.
+inline int16x4_t BlockSparseLoad4(const int8_t* data, int16x8_t offset) {
+  int32_t packed;
+  std::memcpy(&packed, data, sizeof(packed));
+  const int16x8_t values =
+      vmovl_s8(vreinterpret_s8_s32(vdup_n_s32(packed)));
+  return vget_low_s16(vaddq_s16(values, offset));
+}
+
+// Returns the sums of the lanes of `a`, `b`, `c` and `d`.
+inline int32x4_t BlockSparseReduce4(int32x4_t a, int32x4_t b, int32x4_t c,
+                                    int32x4_t d) {
+  const int32x2_t ab =
+      vpadd_s32(vpadd_s32(vget_low_s32(a), vget_high_s32(a)),
+                vpadd_s32(vget_low_s32(b), vget_high_s32(b)));
+  const int32x2_t cd =
+      vpadd_s32(vpadd_s32(vget_low_s32(c), vget_high_s32(c)),
+                vpadd_s32(vget_low_s32(d), vget_high_s32(d)));
+  return vcombine_s32(ab, cd);
+}
+
+template <>
+inline void BlockSparseRowBlockMultiplyAccumulate<4, 4>(
+    const BlockSparseMatrix& matrix, int row_block, const int8_t* input,
+    int32_t input_offset, const int8_t* weights_data, int32_t* accumulators) {
+  const int16x8_t offset = vdupq_n_s16(static_cast<int16_t>(input_offset));
+  int32x4_t sums_0 = vdupq_n_s32(0);
+  int32x4_t sums_1 = vdupq_n_s32(0);
+  int32x4_t sums_2 = vdupq_n_s32(0);
+  int32x4_t sums_3 = vdupq_n_s32(0);
+  for (int k = matrix.block_segments[row_block];
+       k < matrix.block_segments[row_block + 1]; ++k) {
+    const int16x4_t block_input =
+        BlockSparseLoad4(input + matrix.block_indices[k] * 4, offset);
+    const int8x16_t block_weights = vld1q_s8(weights_data + k * 16);
+    const int16x8_t rows_01 = vmovl_s8(vget_low_s8(block_weights));
+    const int16x8_t rows_23 = vmovl_s8(vget_high_s8(block_weights));
+    sums_0 = vmlal_s16(sums_0, vget_low_s16(rows_01), block_input);
+    sums_1 = vmlal_s16(sums_1, vget_high_s16(rows_01), block_input);
+    sums_2 = vmlal_s16(sums_2, vget_low_s16(rows_23), block_input);
+    sums_3 = vmlal_s16(sums_3, vget_high_s16(rows_23), block_input);
+  }
+  vst1q_s32(accumulators, BlockSparseReduce4(sums_0, sums_1, sums_2, sums_3));
+}
+
+template <>
+inline void BlockSparseRowBlockMultiplyAccumulate<8, 1>(
+    const BlockSparseMatrix& matrix, int row_block, const int8_t* input,
+    int32_t input_offset, const int8_t* weights_data, int32_t* accumulators) {
+  int32x4_t sums_0 = vdupq_n_s32(0);
+  int32x4_t sums_1 = vdupq_n_s32(0);
+  for (int k = matrix.block_segments[row_block];
+       k < matrix.block_segments[row_block + 1]; ++k) {
+    const int16_t block_input =
+        static_cast<int16_t>(input[matrix.block_indices[k]] + input_offset);
+    const int16x8_t block_weights = vmovl_s8(vld1_s8(weights_data + k * 8));
+    sums_0 = vmlal_n_s16(sums_0, vget_low_s16(block_weights), block_input);
+    sums_1 = vmlal_n_s16(sums_1, vget_high_s16(block_weights), block_input);
+  }
+  vst1q_s32(accumulators, sums_0);
+  vst1q_s32(accumulators + 4, sums_1);
+}
+
+template <>
+inline void BlockSparseRowBlockMultiplyAccumulate<1, 4>(
+    const BlockSparseMatrix& matrix, int row_block, const int8_t* input,
+    int32_t input_offset, const int8_t* weights_data, int32_t* accumulators) {
+  const int16x8_t offset = vdupq_n_s16(static_cast<int16_t>(input_offset));
+  const int16x8_t zero = vdupq_n_s16(0);
+  int32x4_t sums = vdupq_n_s32(0);
+  for (int k = matrix.block_segments[row_block];
+       k < matrix.block_segments[row_block + 1]; ++k) {
+    const int16x4_t block_input =
+        BlockSparseLoad4(input + matrix.block_indices[k] * 4, offset);
+    const int16x4_t block_weights =
+        BlockSparseLoad4(weights_data + k * 4, zero);
+    sums = vmlal_s16(sums, block_weights, block_input);
+  }
+  const int32x2_t sum = vpadd_s32(vget_low_s32(sums), vget_high_s32(sums));
+  accumulators[0] = vget_lane_s32(vpadd_s32(sum, sum), 0);
+}
+#endif  // USE_NEON
+
+// Same as above with int8 values and symmetric weights, requantized with either
+// the per channel multipliers and shifts, or those of `params`.
+inline void BlockSparseFullyConnectedImpl(
+    const BlockSparseMatrix& matrix, const FullyConnectedParams& params,
+    const int8_t* input_data, const int8_t* weights_data,
+    const int32_t* per_channel_multiplier, const int32_t* per_channel_shift,
+    const int32_t* bias_data, int8_t* output_data, int batch_start,
+    int batch_end, int row_block_start, int row_block_end) {
+  const int block_rows = matrix.block_rows;
+  const int block_cols = matrix.block_cols;
+  const int32_t input_offset = params.input_offset;
+  // The block shapes known at compile time have at most kMaxFixedBlockRows
+  // rows. Others are requantized one row at a time.
+  constexpr int kMaxFixedBlockRows = 8;
+  void (*multiply_accumulate)(const BlockSparseMatrix&, int, const int8_t*,
+                              int32_t, const int8_t*, int32_t*) = nullptr;
+  if (block_rows == 4 && block_cols == 4) {
+    multiply_accumulate = BlockSparseRowBlockMultiplyAccumulate<4, 4>;
+  } else if (block_rows == 8 && block_cols == 1) {
+    multiply_accumulate = BlockSparseRowBlockMultiplyAccumulate<8, 1>;
+  } else if (block_rows == 1 && block_cols == 4) {
+    multiply_accumulate = BlockSparseRowBlockMultiplyAccumulate<1, 4>;
+  }
+  int32_t accumulators[kMaxFixedBlockRows];
+  for (int b = batch_start; b < batch_end; ++b) {
+    const int8_t* input = input_data + b * matrix.cols;
+    for (int row_block = row_block_start; row_block < row_block_end;
+         ++row_block) {
+      const int row_start = row_block * block_rows;
+      int8_t* output = output_data + b * matrix.rows + row_start;
+      if (multiply_accumulate == nullptr) {
+        for (int r = 0; r < block_rows; ++r) {
+          output[r] = BlockSparseRequantize(
+              params, per_channel_multiplier, per_channel_shift, bias_data,
+              row_start + r,
+              BlockSparseRowMultiplyAccumulate(matrix, row_block, r, input,
+                                               input_offset, weights_data));
+        }
+        continue;
+      }
+      multiply_accumulate(matrix, row_block, input, input_offset,
+                          weights_data, accumulators);
+      for (int r = 0; r < block_rows; ++r) {
+        output[r] = BlockSparseRequantize(
+            params, per_channel_multiplier, per_channel_shift, bias_data,
+            row_start + r, accumulators[r]);
+      }
+    }
+  }
+}
+
+template <typename Kernel>
+struct BlockSparseFullyConnectedTask : cpu_backend_threadpool::Task {
+  BlockSparseFullyConnectedTask(const Kernel& kernel, int batch_start,
+                                int batch_end, int row_block_start,
+                                int row_block_end)
+      : kernel(kernel),
+        batch_start(batch_start),
+        batch_end(batch_end),
+        row_block_start(row_block_start),
+        row_block_end(row_block_end) {}
+
+  void Run() override {
+    kernel(batch_start, batch_end, row_block_start, row_block_end);
+  }
+
+ private:
+  const Kernel& kernel;
+  int batch_start;
+  int batch_end;
+  int row_block_start;
+  int row_block_end;
+};
+
+// Runs `kernel` on slices of the batches, or of the row blocks when there are
+// fewer batches than threads, as when a single vector is multiplied.
+template <typename Kernel>
+inline void RunBlockSparseFullyConnected(
+    const BlockSparseMatrix& matrix, int batches, const Kernel& kernel,
+    CpuBackendContext* cpu_backend_context) {
+  const int row_blocks = matrix.rows / matrix.block_rows;
+  const int max_threads = cpu_backend_context->max_num_threads();
+  const bool slice_batches = batches >= max_threads;
+  const int slices = slice_batches ? batches : row_blocks;
+  const int thread_count = std::max(1, std::min(slices, max_threads));
+  if (thread_count == 1) {
+    kernel(0, batches, 0, row_blocks);
+    return;
+  }
+  std::vector<BlockSparseFullyConnectedTask<Kernel>> tasks;
+  tasks.reserve(thread_count);
+  int slice_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int slice_end = slice_start + slices / thread_count;
+    if (i < slices % thread_count) slice_end++;
+    if (slice_batches) {
+      tasks.emplace_back(kernel, slice_start, slice_end, 0, row_blocks);
+    } else {
+      tasks.emplace_back(kernel, 0, batches, slice_start, slice_end);
+    }
+    slice_start = slice_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
+// Fully-connected layer with block sparse weights. The input and output are
+// flattened to [batches, matrix.cols] and [batches, matrix.rows].
+inline void FullyConnectedBlockSparseWeight(
+    const BlockSparseMatrix& matrix, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const float* input_data,
+    const float* weights_data, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("Block Sparse");
+  const int batches = output_shape.FlatSize() / matrix.rows;
+  TFLITE_DCHECK_EQ(input_shape.FlatSize(), batches * matrix.cols);
+  auto kernel = [&](int batch_start, int batch_end, int row_block_start,
+                    int row_block_end) {
+    BlockSparseFullyConnectedImpl(matrix, params, input_data, weights_data,
+                                  bias_data, output_data, batch_start,
+                                  batch_end, row_block_start, row_block_end);
+  };
+  RunBlockSparseFullyConnected(matrix, batches, kernel, cpu_backend_context);
+}
+
+inline void FullyConnectedBlockSparseWeight(
+    const BlockSparseMatrix& matrix, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const int8_t* weights_data, const int32_t* per_channel_multiplier,
+    const int32_t* per_channel_shift, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("Block Sparse");
+  const int batches = output_shape.FlatSize() / matrix.rows;
+  TFLITE_DCHECK_EQ(input_shape.FlatSize(), batches * matrix.cols);
+  auto kernel = [&](int batch_start, int batch_end, int row_block_start,
+                    int row_block_end) {
+    BlockSparseFullyConnectedImpl(
+        matrix, params, input_data, weights_data, per_channel_multiplier,
+        per_channel_shift, bias_data, output_data, batch_start, batch_end,
+        row_block_start, row_block_end);
+  };
+  RunBlockSparseFullyConnected(matrix, batches, kernel, cpu_backend_context);
+}
+
+}  // namespace optimized_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_SPARSE_OPS_BLOCK_SPARSE_H_
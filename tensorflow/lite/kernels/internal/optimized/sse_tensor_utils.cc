@@ -27,6 +27,15 @@ limitations under the License.
 #include "absl/base/prefetch.h"
 #endif
 
+// AVX-512 VNNI kernels are compiled regardless of the target flags and only
+// run on CPUs that support them.
+#if defined(__clang__) ? __clang_major__ >= 8 : __GNUC__ >= 9
+#define TFLITE_AVX512_VNNI_TARGET \
+  __attribute__((target("avx512f,avx512bw,avx512vnni")))
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
 #include <cstdint>
 
 #include "ruy/profiler/instrumentation.h"  // from @ruy
@@ -34,6 +43,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_gemm.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
+#include "tensorflow/lite/kernels/internal/optimized/cpu_check.h"
 
 namespace tflite {
 namespace tensor_utils {
@@ -293,12 +303,117 @@ void Avx2MatrixBatchVectorMultiplyAccumulateImpl(
 
 #endif  // __AVX2__
 
+#ifdef TFLITE_AVX512_VNNI_TARGET
+namespace {
+
+bool HasAvx512Vnni() {
+  static const bool has_avx512_vnni = DetectX86Avx512Vnni();
+  return has_avx512_vnni;
+}
+
+// Dot product of sixteen int8 vectors of 4 elements packed into a ZMM
+// register, accumulated into sixteen int32 scalars.
+// int32x16 + int8x4x16 · int8x4x16 => int32x16
+TFLITE_AVX512_VNNI_TARGET inline __m512i DotProdInt8x4x16(__m512i acc,
+                                                           __m512i a_8x64,
+                                                           __m512i b_8x64) {
+  // Transfer sign from 'a' to 'b', as _mm512_dpbusd_epi32 treats 'a' unsigned.
+  b_8x64 = _mm512_mask_sub_epi8(b_8x64, _mm512_movepi8_mask(a_8x64),
+                                _mm512_setzero_si512(), b_8x64);
+  return _mm512_dpbusd_epi32(acc, _mm512_abs_epi8(a_8x64), b_8x64);
+}
+
+TFLITE_AVX512_VNNI_TARGET
+void Avx512VnniMatrixBatchVectorMultiplyAccumulateImpl(
+    const int8_t* __restrict__ matrix, const int m_rows, const int m_cols,
+    const int8_t* __restrict__ vectors,
+    const float* __restrict__ scaling_factors, int n_batch,
+    float* __restrict__ result, const float* per_channel_scale,
+    const int32_t* input_offset, const int32_t* row_sums) {
+  // Masked loads read the last partial block of 64x 8-bit inputs as zeros,
+  // so that no scalar postamble is needed.
+  const std::intptr_t main_cols = m_cols & ~63;
+  const __mmask64 tail_mask =
+      m_cols & 63 ? ~uint64_t{0} >> (64 - (m_cols & 63)) : 0;
+  for (std::intptr_t batch = 0; batch < n_batch; ++batch) {
+    const float batch_scaling_factor = scaling_factors[batch];
+    const int32_t batch_offset = input_offset ? input_offset[batch] : 0;
+    std::intptr_t row = 0;
+    int32_t sums[4];
+    // Four rows at a time share the loads of the vector.
+    for (; row < m_rows; row += 4) {
+      const int rows = std::min<std::intptr_t>(4, m_rows - row);
+      const int8_t* __restrict__ row_ptr = matrix + row * m_cols;
+      __m512i dotprod[4] = {_mm512_setzero_si512(), _mm512_setzero_si512(),
+                            _mm512_setzero_si512(), _mm512_setzero_si512()};
+      std::intptr_t col = 0;
+      // A constant trip count keeps the accumulators in registers.
+      if (rows == 4) {
+        for (; col < main_cols; col += 64) {
+          const __m512i vec_8x64 = _mm512_loadu_si512(vectors + col);
+          for (int r = 0; r < 4; ++r) {
+            dotprod[r] = DotProdInt8x4x16(
+                dotprod[r], vec_8x64,
+                _mm512_loadu_si512(row_ptr + r * m_cols + col));
+          }
+        }
+      } else {
+        for (; col < main_cols; col += 64) {
+          const __m512i vec_8x64 = _mm512_loadu_si512(vectors + col);
+          for (int r = 0; r < rows; ++r) {
+            dotprod[r] = DotProdInt8x4x16(
+                dotprod[r], vec_8x64,
+                _mm512_loadu_si512(row_ptr + r * m_cols + col));
+          }
+        }
+      }
+      if (tail_mask) {
+        const __m512i vec_8x64 =
+            _mm512_maskz_loadu_epi8(tail_mask, vectors + col);
+        for (int r = 0; r < rows; ++r) {
+          dotprod[r] = DotProdInt8x4x16(
+              dotprod[r], vec_8x64,
+              _mm512_maskz_loadu_epi8(tail_mask, row_ptr + r * m_cols + col));
+        }
+      }
+      for (int r = 0; r < rows; ++r) {
+        sums[r] = _mm512_reduce_add_epi32(dotprod[r]);
+      }
+      for (int r = 0; r < rows; ++r) {
+        const float row_scale =
+            per_channel_scale
+                ? per_channel_scale[row + r] * batch_scaling_factor
+                : batch_scaling_factor;
+        int32_t sum = sums[r];
+        if (row_sums && batch_offset) {
+          sum -= batch_offset * row_sums[row + r];
+        }
+        *result += sum * row_scale;
+        ++result;
+      }
+    }  // for row
+
+    vectors += m_cols;
+  }  // for batch
+}
+
+}  // namespace
+#endif  // TFLITE_AVX512_VNNI_TARGET
+
 void SseMatrixBatchVectorMultiplyAccumulateImpl(
     const int8_t* __restrict__ matrix, const int m_rows, const int m_cols,
     const int8_t* __restrict__ vectors,
     const float* __restrict__ scaling_factors, int n_batch,
     float* __restrict__ result, const float* per_channel_scale,
     const int32_t* input_offset, const int32_t* row_sums) {
+#ifdef TFLITE_AVX512_VNNI_TARGET
+  if (HasAvx512Vnni()) {
+    Avx512VnniMatrixBatchVectorMultiplyAccumulateImpl(
+        matrix, m_rows, m_cols, vectors, scaling_factors, n_batch, result,
+        per_channel_scale, input_offset, row_sums);
+    return;
+  }
+#endif
 #ifdef __AVX2__
   Avx2MatrixBatchVectorMultiplyAccumulateImpl(
       matrix, m_rows, m_cols, vectors, scaling_factors, n_batch, result,
@@ -428,8 +543,15 @@ void SseMatrixBatchVectorMultiplyAccumulate(
     const int8_t* __restrict__ vectors,
     const float* __restrict__ scaling_factors, int n_batch, int32_t* scratch,
     float* __restrict__ result, CpuBackendContext* context) {
+  // With AVX-512 VNNI, a few vectors are multiplied faster directly than
+  // through a GEMM, which packs the whole matrix first.
+  bool use_gemv = false;
+#ifdef TFLITE_AVX512_VNNI_TARGET
+  constexpr int kMaxBatchForVnniGemv = 4;
+  use_gemv = n_batch <= kMaxBatchForVnniGemv && HasAvx512Vnni();
+#endif
   // TODO(b/183178387): Use a proper query to detect AVX/optimized paths.
-  if (m_rows % 4 == 0 && !context->PreferGemmlowpOnX86()) {
+  if (m_rows % 4 == 0 && !use_gemv && !context->PreferGemmlowpOnX86()) {
     const int32_t* bias = static_cast<const int32_t*>(nullptr);
     SseCpuBackendGemm(vectors, bias, matrix, n_batch, m_cols, m_rows,
                       /*output_zp=*/0, scratch, context);
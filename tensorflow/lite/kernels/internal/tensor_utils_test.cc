@@ -1229,6 +1229,37 @@ TEST(uKernels, PerChannelDotprodMatrixBatchVectorMultiplyAccumulateTest) {
   EXPECT_NEAR(1050930, results[150], 0.0001);
 }
 
+// The batch sizes take the GEMV and the GEMM paths, including the AVX-512
+// VNNI and AMX ones on CPUs that have them.
+TEST(uKernels, HybridMatrixBatchVectorMultiplyAccumulateBatchSizesTest) {
+  CpuBackendContext context;
+  constexpr int kRows = 36;
+  constexpr int kCols = 100;
+  for (int batch : {1, 4, 5, 8, 33}) {
+    MatrixVectorData data =
+        SetupMatrixVectorData(kRows, kCols, batch, /*negative=*/true);
+    // The sums and scale factors are small integers, so the results are
+    // exact.
+    std::vector<float> expected(kRows * batch);
+    for (int b = 0; b < batch; ++b) {
+      for (int r = 0; r < kRows; ++r) {
+        int32_t sum = 0;
+        for (int c = 0; c < kCols; ++c) {
+          sum += data.matrix[r * kCols + c] * data.vectors[b * kCols + c];
+        }
+        expected[b * kRows + r] = sum * data.scale_factors[b];
+      }
+    }
+    std::vector<int32_t> scratch(kRows * batch);
+    MatrixBatchVectorMultiplyAccumulate(
+        data.matrix.data(), kRows, kCols, data.vectors.data(),
+        data.scale_factors.data(), batch, scratch.data(), data.results.data(),
+        &context);
+    EXPECT_THAT(data.results, testing::ElementsAreArray(expected))
+        << "batch " << batch;
+  }
+}
+
 TEST(uKernels, DotprodMatrixBatchFourVectorMultiplyAccumulateDotprodTest) {
   ASSERT_THAT(TestDotprodMatrixBatchVectorMultiply(2, 16, 4),
               testing::ElementsAreArray(
@@ -2257,6 +2288,37 @@ BENCHMARK(BM_DotprodBatchFourMultiply)
     ->Args({16384, 16384, 1024, 1})
     ->Args({16384, 8192, 1024, 1});
 
+// Goes through the CpuBackendContext overload, as the hybrid fully connected
+// and LSTM kernels do, and so through GEMMs for larger batches.
+void BM_DotprodHybridMultiply(benchmark::State& state) {
+  const int rows = state.range(0);
+  const int cols = state.range(1);
+  const int batch = state.range(2);
+  tflite::tensor_utils::MatrixVectorData data =
+      tflite::tensor_utils::SetupMatrixVectorData(rows, cols, batch);
+  std::vector<int32_t> scratch(rows * batch);
+  tflite::CpuBackendContext context;
+  for (auto _ : state) {
+    tflite::tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        data.matrix.data(), data.rows, data.cols, data.vectors.data(),
+        data.scale_factors.data(), data.batch, scratch.data(),
+        &data.results[0], &context);
+    testing::DoNotOptimize(data.results[2]);
+  }
+}
+BENCHMARK(BM_DotprodHybridMultiply)
+    ->Args({1024, 1024, 1})
+    ->Args({1024, 1024, 4})
+    ->Args({1024, 1024, 8})
+    ->Args({1024, 1024, 16})
+    ->Args({1024, 1024, 64})
+    ->Args({2048, 2048, 1})
+    ->Args({2048, 2048, 8})
+    ->Args({2048, 2048, 64})
+    ->Args({2048, 2048, 256})
+    ->Args({4096, 4096, 1})
+    ->Args({4096, 4096, 64});
+
 void BM_DotprodSparseMultiply(benchmark::State& state) {
   const int rows = state.range(0);
   const int cols = state.range(1);
@@ -1929,7 +1929,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           projection_weights, projection_bias, params,
           /*forward_sequence=*/true,
           /*time_major=*/true,
-          /*output_offset=*/0, scratch_buffer, output_state, cell_state, output,
+          /*output_offset=*/0, scratch_buffer, /*input_projections=*/nullptr,
+          output_state, cell_state, output,
           /*recurrent_to_input_is_diag=*/false,
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
@@ -181,6 +181,8 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   cell_to_gate_weights      | n_cell               | y (peephole)
 //   gate_bias                 | n_cell               |
 //   layer_norm_coefficients   | n_cell               | y (layer norm)
+// Precomputed inputs:
+//   input_projection          | n_cell               | y
 // Output vector:
 //   gate                      | n_cell               |
 // Scalar parameters:
@@ -189,6 +191,9 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   activation                                 - activation to use.
 //   is_input_all_zeros, is_aux_input_all_zeros - if input vectors are all zero.
 //   use_layer_norm                             - if doing layer norm LSTM.
+//
+// If given, input_projection holds W_input * input + W_aux * aux_input, plus
+// the bias without layer norm, and input and aux_input are not used.
 inline void CalculateLstmGateFloat(
     const float* input, const float* input_to_gate_weights,
     const float* aux_input, const float* aux_input_to_gate_weights,
@@ -199,13 +204,16 @@ inline void CalculateLstmGateFloat(
     const int n_output, const int n_cell,
     const TfLiteFusedActivation activation, float* gate,
     const bool is_input_all_zeros, const bool is_aux_input_all_zeros,
-    float* output, bool recurrent_is_diag, CpuBackendContext* context) {
+    const float* input_projection, float* output, bool recurrent_is_diag,
+    CpuBackendContext* context) {
   const bool use_peephole = (cell_to_gate_weights != nullptr);
   const bool use_layer_norm = (layer_norm_coefficients != nullptr);
 
   // Initialize scratch buffers with bias for regular lstm or initialize with
   // zero for layer norm lstm.
-  if (use_layer_norm) {
+  if (input_projection != nullptr) {
+    std::copy_n(input_projection, n_cell * n_batch, gate);
+  } else if (use_layer_norm) {
     std::fill_n(gate, n_cell * n_batch, 0.0f);
   } else {
     tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
@@ -213,7 +221,7 @@ inline void CalculateLstmGateFloat(
   // For each batch and cell: compute input_weight * input.
   // Skip if input is all zeros.
   float* accumulation_buffer = gate;
-  if (!is_input_all_zeros) {
+  if (input_projection == nullptr && !is_input_all_zeros) {
     MatrixBatchVectorMultiplyAccumulate(input_to_gate_weights, input,
                                         accumulation_buffer, output, n_cell,
                                         n_input, n_batch, context);
@@ -221,7 +229,7 @@ inline void CalculateLstmGateFloat(
   }
   // For each batch and cell: compute aux_input_weight * aux_input.
   // Skip if auxiliary input is not available or all zeros.
-  if (!is_aux_input_all_zeros) {
+  if (input_projection == nullptr && !is_aux_input_all_zeros) {
     MatrixBatchVectorMultiplyAccumulate(aux_input_to_gate_weights, aux_input,
                                         accumulation_buffer, output, n_cell,
                                         n_aux_input, n_batch, context);
@@ -863,12 +871,20 @@ void CalculateLstmOutputInteger8x8_8(
 //   cell_layer_norm_coefficients_ptr   - optional
 //   output_layer_norm_coefficients_ptr - optional
 //
+// Input projections of size 'n_batch * n_cell', computed ahead:
+//   input_projections_ptr              - optional
+//
 // The pointers to the cell and output state and the output are updated.
 //
 // The pointers input_ptr, aux_input_ptr, and output_ptr point to data aligned
 // in batch_major order, and each step processes batch_size many inputs from
 // input_ptr, and updates batch_size many cell and output states.
 //
+// If given, input_projections_ptr points to the products of the input and
+// auxiliary input weights with the inputs, see CalculateLstmGateFloat, for the
+// input, forget, cell and output gates, input_projections_stride apart. The
+// inputs are not used then.
+//
 // The output_batch_dim is output.shape[-1], i.e. the outermost dimension of the
 // output tensor, and in most cases will be equal to n_output. It is usually not
 // when we want to store the LSTM output into a slice of the output tensor, e.g.
@@ -899,6 +915,7 @@ inline void LstmStepFloat(
     const float* input_gate_bias_ptr, const float* forget_gate_bias_ptr,
     const float* cell_gate_bias_ptr, const float* output_gate_bias_ptr,
     const float* projection_weights_ptr, const float* projection_bias_ptr,
+    const float* input_projections_ptr, int input_projections_stride,
     const TfLiteLSTMParams* params, int n_batch, int n_cell, int n_input,
     int n_aux_input, int n_output, int output_batch_leading_dim,
     float* output_state_ptr, float* cell_state_ptr, float* scratch0,
@@ -919,11 +936,21 @@ inline void LstmStepFloat(
   float* accumulation_scratch_buffer = scratch4;
 
   // Check if inputs are all zeros so we can skip some computations.
+  const bool use_input_projections = (input_projections_ptr != nullptr);
   const bool is_input_all_zeros =
+      !use_input_projections &&
       tensor_utils::IsZeroVector(input_ptr, n_batch * n_input);
   const bool is_aux_input_all_zeros =
       (aux_input_ptr == nullptr ||
-       tensor_utils::IsZeroVector(aux_input_ptr, n_batch * n_aux_input));
+       (!use_input_projections &&
+        tensor_utils::IsZeroVector(aux_input_ptr, n_batch * n_aux_input)));
+  const float* input_projection[4] = {};
+  if (use_input_projections) {
+    for (int gate = 0; gate < 4; ++gate) {
+      input_projection[gate] =
+          input_projections_ptr + gate * input_projections_stride;
+    }
+  }
 
   if (!use_cifg) {
     // Calculate the input gate. (If not CIFG.)
@@ -936,8 +963,8 @@ inline void LstmStepFloat(
         input_layer_norm_coefficients_ptr, input_gate_bias_ptr, n_batch,
         n_input, n_aux_input, n_output, n_cell,
         /*activation=*/kTfLiteActSigmoid, input_gate_scratch,
-        is_input_all_zeros, is_aux_input_all_zeros, accumulation_scratch_buffer,
-        recurrent_to_input_is_diag, context);
+        is_input_all_zeros, is_aux_input_all_zeros, input_projection[0],
+        accumulation_scratch_buffer, recurrent_to_input_is_diag, context);
   }
   // Calculate the forget gate.
   CalculateLstmGateFloat(
@@ -949,7 +976,7 @@ inline void LstmStepFloat(
       forget_layer_norm_coefficients_ptr, forget_gate_bias_ptr, n_batch,
       n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, forget_gate_scratch, is_input_all_zeros,
-      is_aux_input_all_zeros, accumulation_scratch_buffer,
+      is_aux_input_all_zeros, input_projection[1], accumulation_scratch_buffer,
       recurrent_to_forget_is_diag, context);
   // Calculate the cell update gate.
   CalculateLstmGateFloat(
@@ -961,7 +988,7 @@ inline void LstmStepFloat(
       /*cell_to_gate_weights=*/nullptr, cell_layer_norm_coefficients_ptr,
       cell_gate_bias_ptr, n_batch, n_input, n_aux_input, n_output, n_cell,
       params->activation, cell_gate_scratch, is_input_all_zeros,
-      is_aux_input_all_zeros, accumulation_scratch_buffer,
+      is_aux_input_all_zeros, input_projection[2], accumulation_scratch_buffer,
       recurrent_to_cell_is_diag, context);
   // Update the cell state.
   UpdateLstmCellFloat(n_batch, n_cell, cell_state_ptr, input_gate_scratch,
@@ -977,7 +1004,7 @@ inline void LstmStepFloat(
       output_layer_norm_coefficients_ptr, output_gate_bias_ptr, n_batch,
       n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, output_gate_scratch, is_input_all_zeros,
-      is_aux_input_all_zeros, accumulation_scratch_buffer,
+      is_aux_input_all_zeros, input_projection[3], accumulation_scratch_buffer,
       recurrent_to_output_is_diag, context);
   // Update the output state.
   CalculateLstmOutputFloat(n_batch, n_cell, n_output, cell_state_ptr,
@@ -1787,6 +1814,86 @@ inline void LstmStepInteger8x8_8(
   std::copy_n(output_state_ptr, n_batch * n_output, output_ptr);
 }
 
+// Computes the input projections of LstmStepFloat for many steps at once, one
+// matrix multiplication per gate instead of one per gate and step, as they
+// don't depend on the state. The projections of the rows of the input, in
+// the order of the steps, are computed into a buffer holding `capacity` rows
+// per gate whenever a step needs rows that are not in it.
+class InputProjectionsFloat {
+ public:
+  // The weights and biases are those of the input, forget, cell and output
+  // gates, without the input gate with CIFG. Without biases, for layer norm,
+  // the projections are the matrix products only.
+  InputProjectionsFloat(const float* input, int n_rows, int n_input,
+                        int n_cell, const float* const weights[4],
+                        const float* const biases[4], bool forward_sequence,
+                        float* buffer, int capacity)
+      : input_(input),
+        n_rows_(n_rows),
+        n_input_(n_input),
+        n_cell_(n_cell),
+        forward_sequence_(forward_sequence),
+        buffer_(buffer),
+        capacity_(capacity) {
+    std::copy_n(weights, 4, weights_);
+    std::copy_n(biases, 4, biases_);
+  }
+
+  // Distance between the projections of consecutive gates.
+  int stride() const { return capacity_ * n_cell_; }
+
+  // Returns the projections of rows [row, row + num_rows) of the input for
+  // the input gate, followed by those of the other gates stride() apart.
+  const float* Get(int row, int num_rows, CpuBackendContext* context) {
+    if (row < begin_ || row + num_rows > end_) {
+      if (forward_sequence_) {
+        begin_ = row;
+        end_ = std::min(n_rows_, row + capacity_);
+      } else {
+        end_ = row + num_rows;
+        begin_ = std::max(0, end_ - capacity_);
+      }
+      Compute(context);
+    }
+    return buffer_ + (row - begin_) * n_cell_;
+  }
+
+ private:
+  void Compute(CpuBackendContext* context) {
+    ruy::profiler::ScopeLabel label("LstmInputProjectionsFloat");
+    tflite::FullyConnectedParams params;
+    params.float_activation_min = std::numeric_limits<float>::lowest();
+    params.float_activation_max = std::numeric_limits<float>::max();
+    params.lhs_cacheable = true;
+    params.rhs_cacheable = false;
+    const int num_rows = end_ - begin_;
+    const RuntimeShape input_shape({num_rows, n_input_});
+    const RuntimeShape weights_shape({n_cell_, n_input_});
+    const RuntimeShape bias_shape({n_cell_});
+    const RuntimeShape output_shape({num_rows, n_cell_});
+    for (int gate = 0; gate < 4; ++gate) {
+      if (weights_[gate] == nullptr) continue;
+      optimized_ops::FullyConnected(
+          params, input_shape, input_ + begin_ * n_input_, weights_shape,
+          weights_[gate], bias_shape, biases_[gate], output_shape,
+          buffer_ + gate * stride(), context);
+    }
+  }
+
+  const float* input_;
+  const int n_rows_;
+  const int n_input_;
+  const int n_cell_;
+  const float* weights_[4];
+  const float* biases_[4];
+  const bool forward_sequence_;
+  float* buffer_;
+  const int capacity_;
+  // Rows of the input whose projections are in the buffer.
+  int begin_ = 0;
+  int end_ = 0;
+};
+
 }  // namespace
 
 // LINT.IfChange
@@ -1815,7 +1922,8 @@ TfLiteStatus EvalFloat(
     const TfLiteTensor* cell_gate_bias, const TfLiteTensor* output_gate_bias,
     const TfLiteTensor* projection_weights, const TfLiteTensor* projection_bias,
     const TfLiteLSTMParams* params, bool forward_sequence, bool time_major,
-    int output_offset, TfLiteTensor* scratch_buffer, TfLiteTensor* output_state,
+    int output_offset, TfLiteTensor* scratch_buffer,
+    TfLiteTensor* input_projections, TfLiteTensor* output_state,
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
@@ -1864,6 +1972,31 @@ TfLiteStatus EvalFloat(
     accumulation_scratch_buffer = scratch_buffer_ptr + 4 * n_cell * n_batch;
   }
 
+  // Each step needs the projections of one row of the input per batch in the
+  // time major layout, and of a single one otherwise.
+  const int rows_per_step = time_major ? n_batch : 1;
+  int input_projections_capacity = 0;
+  if (input_projections != nullptr && aux_input == nullptr) {
+    input_projections_capacity = input_projections->bytes / sizeof(float) /
+                                 (4 * n_cell) / rows_per_step * rows_per_step;
+  }
+  const bool use_layer_norm = (forget_layer_norm_coefficients != nullptr);
+  const float* const input_weights[4] = {
+      GetTensorData<float>(input_to_input_weights),
+      GetTensorData<float>(input_to_forget_weights),
+      GetTensorData<float>(input_to_cell_weights),
+      GetTensorData<float>(input_to_output_weights)};
+  const float* const gate_biases[4] = {
+      use_layer_norm ? nullptr : GetTensorData<float>(input_gate_bias),
+      use_layer_norm ? nullptr : GetTensorData<float>(forget_gate_bias),
+      use_layer_norm ? nullptr : GetTensorData<float>(cell_gate_bias),
+      use_layer_norm ? nullptr : GetTensorData<float>(output_gate_bias)};
+  InputProjectionsFloat input_projections_cache(
+      GetTensorData<float>(input), max_time * n_batch, n_input, n_cell,
+      input_weights, gate_biases, forward_sequence,
+      GetTensorData<float>(input_projections), input_projections_capacity);
+  const bool use_input_projections = (input_projections_capacity > 0);
+
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
   if (time_major) {
@@ -1881,6 +2014,10 @@ TfLiteStatus EvalFloat(
       }
       float* output_ptr =
           GetTensorData<float>(output) + t_rel * output_step + output_offset;
+      const float* input_projections_ptr =
+          use_input_projections
+              ? input_projections_cache.Get(t_rel * n_batch, n_batch, context)
+              : nullptr;
 
       LstmStepFloat(
           input_ptr, GetTensorData<float>(input_to_input_weights),
@@ -1907,8 +2044,9 @@ TfLiteStatus EvalFloat(
           GetTensorData<float>(cell_gate_bias),
           GetTensorData<float>(output_gate_bias),
           GetTensorData<float>(projection_weights),
-          GetTensorData<float>(projection_bias), params, n_batch, n_cell,
-          n_input, aux_input_size, n_output, output_batch_leading_dim,
+          GetTensorData<float>(projection_bias), input_projections_ptr,
+          input_projections_cache.stride(), params, n_batch, n_cell, n_input,
+          aux_input_size, n_output, output_batch_leading_dim,
           GetTensorData<float>(output_state), GetTensorData<float>(cell_state),
           input_gate_scratch, forget_gate_scratch, cell_gate_scratch,
           output_gate_scratch, accumulation_scratch_buffer, output_ptr,
@@ -1944,6 +2082,10 @@ TfLiteStatus EvalFloat(
         float* forget_gate_scratch_ptr = forget_gate_scratch + b * n_cell;
         float* cell_gate_scratch_ptr = cell_gate_scratch + b * n_cell;
         float* output_gate_scratch_ptr = output_gate_scratch + b * n_cell;
+        const float* input_projections_ptr =
+            use_input_projections
+                ? input_projections_cache.Get(time_offset, 1, context)
+                : nullptr;
 
         LstmStepFloat(
             input_ptr, GetTensorData<float>(input_to_input_weights),
@@ -1970,8 +2112,9 @@ TfLiteStatus EvalFloat(
             GetTensorData<float>(cell_gate_bias),
             GetTensorData<float>(output_gate_bias),
             GetTensorData<float>(projection_weights),
-            GetTensorData<float>(projection_bias), params, /*n_batch=*/1,
-            n_cell, n_input, aux_input_size, n_output, output_batch_leading_dim,
+            GetTensorData<float>(projection_bias), input_projections_ptr,
+            input_projections_cache.stride(), params, /*n_batch=*/1, n_cell,
+            n_input, aux_input_size, n_output, output_batch_leading_dim,
             output_state_ptr, cell_state_ptr, input_gate_scratch_ptr,
             forget_gate_scratch_ptr, cell_gate_scratch_ptr,
             output_gate_scratch_ptr, accumulation_scratch_buffer, output_ptr,
@@ -95,6 +95,11 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// If given, `input_projections` is a buffer for the products of the input
+// weights with the input, which are then computed for many time steps at once
+// rather than at each step. It holds the projections of as many rows of the
+// input as fit, for all 4 gates; a buffer too small for one step, or an
+// auxiliary input, disables this.
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -120,7 +125,8 @@ TfLiteStatus EvalFloat(
     const TfLiteTensor* cell_gate_bias, const TfLiteTensor* output_gate_bias,
     const TfLiteTensor* projection_weights, const TfLiteTensor* projection_bias,
     const TfLiteLSTMParams* params, bool forward_sequence, bool time_major,
-    int output_offset, TfLiteTensor* scratch_buffer, TfLiteTensor* output_state,
+    int output_offset, TfLiteTensor* scratch_buffer,
+    TfLiteTensor* input_projections, TfLiteTensor* output_state,
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
@@ -404,8 +404,17 @@ enum TemporaryTensor {
   kInputZeroPoints = 9,
   kOutputStateZeroPoints = 10,
   kRowSums = 11,
-  kNumTemporaryTensors = 12,
+  // Only used by float LSTMs, which have no other temporary than the scratch
+  // buffer, at kFloatInputProjections.
+  kInputProjections = 12,
+  kNumTemporaryTensors = 13,
 };
+constexpr int kNumHybridTemporaryTensors = kRowSums + 1;
+constexpr int kFloatInputProjections = 1;
+
+// Float LSTMs compute the input projections of up to this many time steps at
+// once, ahead of the steps.
+constexpr int kMaxInputProjectionSteps = 32;
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   auto* op_data = new OpData();
@@ -919,6 +928,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
           node->builtin_data);
   const bool time_major = params->time_major;
   const int n_batch = time_major ? input->dims->data[1] : input->dims->data[0];
+  const int max_time =
+      time_major ? input->dims->data[0] : input->dims->data[1];
   const int n_input = input->dims->data[2];
 
   const TfLiteTensor* input_to_output_weights;
@@ -985,10 +996,17 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   }
 
   TfLiteIntArrayFree(node->temporaries);
+  // With a single step, there is nothing to gain from computing the input
+  // projections ahead.
+  const bool use_input_projections =
+      !is_integer && max_time > 1 &&
+      !IsHybridOp(input, input_to_output_weights);
   if (IsHybridOp(input, input_to_output_weights)) {
-    node->temporaries = TfLiteIntArrayCreate(kNumTemporaryTensors);
+    node->temporaries = TfLiteIntArrayCreate(kNumHybridTemporaryTensors);
   } else if (is_integer) {
     node->temporaries = TfLiteIntArrayCreate(6);
+  } else if (use_input_projections) {
+    node->temporaries = TfLiteIntArrayCreate(2);
   } else {
     node->temporaries = TfLiteIntArrayCreate(1);
   }
@@ -1019,6 +1037,26 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                    scratch_buffer_size));
 
+  if (use_input_projections) {
+    node->temporaries->data[kFloatInputProjections] =
+        scratch_tensor_index + kInputProjections;
+    TfLiteTensor* input_projections;
+    TF_LITE_ENSURE_OK(context,
+                      GetTemporarySafe(context, node, kFloatInputProjections,
+                                       &input_projections));
+    input_projections->type = kTfLiteFloat32;
+    input_projections->allocation_type = kTfLiteArenaRw;
+    // Projections for the input, forget, cell and output gates of all the
+    // batches of the steps.
+    TfLiteIntArray* input_projections_size = TfLiteIntArrayCreate(2);
+    input_projections_size->data[0] =
+        std::min(max_time, kMaxInputProjectionSteps) * n_batch;
+    input_projections_size->data[1] = 4 * n_cell;
+    TF_LITE_ENSURE_OK(context,
+                      context->ResizeTensor(context, input_projections,
+                                            input_projections_size));
+  }
+
   if (IsHybridOp(input, input_to_output_weights)) {
     op_data->compute_row_sums = true;
     // Allocate temporary tensors to store quantized values of input,
@@ -1366,6 +1404,12 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       TfLiteTensor* scratch_buffer;
       TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, kScratchBuffer,
                                                   &scratch_buffer));
+      TfLiteTensor* input_projections = nullptr;
+      if (node->temporaries->size > kFloatInputProjections) {
+        TF_LITE_ENSURE_OK(
+            context, GetTemporarySafe(context, node, kFloatInputProjections,
+                                      &input_projections));
+      }
       return lstm_eval::EvalFloat(
           input, input_to_input_weights, input_to_forget_weights,
           input_to_cell_weights, input_to_output_weights,
@@ -1382,7 +1426,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           forget_gate_bias, cell_gate_bias, output_gate_bias,
           projection_weights, projection_bias, &lstm_params,
           /*forward_sequence=*/true, time_major,
-          /*output_offset=*/0, scratch_buffer, output_state, cell_state, output,
+          /*output_offset=*/0, scratch_buffer, input_projections, output_state,
+          cell_state, output,
           /*recurrent_to_input_is_diag=*/
           (recurrent_to_input_weights == nullptr ||
            recurrent_to_input_weights->dims->size == 1),
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 // Unit test for TFLite Sequential LSTM op.
 
+#include <memory>
+#include <random>
 #include <tuple>
 #include <vector>
 
@@ -422,6 +424,84 @@ TEST_P(NoCifgNoPeepholeNoProjectionNoClippingUnidirectionalLstmTest,
                 /*tolerance=*/0.0157651);
 }
 
+// Preparing a hybrid LSTM again for a longer sequence reallocates its
+// temporaries. The steps are computed in order, so the first steps of the
+// longer sequence still match the goldens.
+TEST_P(NoCifgNoPeepholeNoProjectionNoClippingUnidirectionalLstmTest,
+       HybridLstmReallocateForLongerSequence) {
+  const int n_batch = 1;
+  const int n_input = 2;
+  // n_cell and n_output have the same size when there is no projection.
+  const int n_cell = 4;
+  const int n_output = 4;
+  const int sequence_length = 3;
+
+  HybridUnidirectionalLSTMOpModel lstm(
+      n_batch, n_input, n_cell, n_output, sequence_length,
+      /*time_major=*/true, /*use_cifg=*/false, /*use_peephole=*/false,
+      /*use_projection_weights=*/false,
+      /*use_projection_bias=*/false, /*cell_clip=*/0.0, /*proj_clip=*/0.0,
+      {
+          {sequence_length, n_batch, n_input},  // input tensor
+
+          {n_cell, n_input},  // input_to_input_weight tensor
+          {n_cell, n_input},  // input_to_forget_weight tensor
+          {n_cell, n_input},  // input_to_cell_weight tensor
+          {n_cell, n_input},  // input_to_output_weight tensor
+
+          {n_cell, n_output},  // recurrent_to_input_weight tensor
+          {n_cell, n_output},  // recurrent_to_forget_weight tensor
+          {n_cell, n_output},  // recurrent_to_cell_weight tensor
+          {n_cell, n_output},  // recurrent_to_output_weight tensor
+
+          {0},  // cell_to_input_weight tensor
+          {0},  // cell_to_forget_weight tensor
+          {0},  // cell_to_output_weight tensor
+
+          {n_cell},  // input_gate_bias tensor
+          {n_cell},  // forget_gate_bias tensor
+          {n_cell},  // cell_gate_bias tensor
+          {n_cell},  // output_gate_bias tensor
+
+          {0, 0},  // projection_weight tensor
+          {0},     // projection_bias tensor
+
+          {n_batch, n_output},  // output_state tensor
+          {n_batch, n_cell},    // cell_state tensor
+      },
+      TensorType_INT8, GetParam());
+
+  lstm.SetInputToInputWeights(input_to_input_weights_);
+  lstm.SetInputToCellWeights(input_to_cell_weights_);
+  lstm.SetInputToForgetWeights(input_to_forget_weights_);
+  lstm.SetInputToOutputWeights(input_to_output_weights_);
+
+  lstm.SetInputGateBias(input_gate_bias_);
+  lstm.SetCellBias(cell_gate_bias_);
+  lstm.SetForgetGateBias(forget_gate_bias_);
+  lstm.SetOutputGateBias(output_gate_bias_);
+
+  lstm.SetRecurrentToInputWeights(recurrent_to_input_weights_);
+  lstm.SetRecurrentToCellWeights(recurrent_to_cell_weights_);
+  lstm.SetRecurrentToForgetWeights(recurrent_to_forget_weights_);
+  lstm.SetRecurrentToOutputWeights(recurrent_to_output_weights_);
+
+  ASSERT_EQ(lstm.ResizeInputAndAllocate({2 * sequence_length, n_batch,
+                                         n_input}),
+            kTfLiteOk);
+  const std::vector<float>& input = lstm_input_[0];
+  lstm.SetInput(0, input.data(), input.data() + input.size());
+  lstm.SetInput(input.size(), input.data(), input.data() + input.size());
+  ASSERT_EQ(lstm.Invoke(), kTfLiteOk);
+
+  const std::vector<float> output = lstm.GetOutput();
+  ASSERT_EQ(output.size(), 2 * lstm_golden_output_[0].size());
+  EXPECT_THAT(std::vector<float>(output.begin(),
+                                 output.begin() + output.size() / 2),
+              ElementsAreArray(
+                  ArrayFloatNear(lstm_golden_output_[0], 0.0157651)));
+}
+
 class CifgPeepholeNoProjectionNoClippingUnidirectionalLstmTest
     : public BaseUnidirectionalLstmTest {
   void SetUp() override {
@@ -3384,6 +3464,152 @@ TEST_P(IndyLSTMOpTest, CheckThatDiagAndNonDiagRecurrentWeightsAreEqual) {
               ElementsAreArray(ArrayFloatNear(lstm.GetOutput(), 1e-6)));
 }
 
+// Returns a float LSTM without CIFG, peephole, projection or clipping, whose
+// weights and biases only depend on its sizes.
+std::unique_ptr<UnidirectionalLSTMOpModel> CreateRandomLstm(
+    int n_batch, int n_input, int n_cell, int sequence_length,
+    bool time_major) {
+  const int n_output = n_cell;
+  auto lstm = std::make_unique<UnidirectionalLSTMOpModel>(
+      n_batch, n_input, n_cell, n_output, sequence_length, time_major,
+      /*use_cifg=*/false, /*use_peephole=*/false,
+      /*use_projection_weights=*/false, /*use_projection_bias=*/false,
+      /*cell_clip=*/0.0, /*proj_clip=*/0.0,
+      std::vector<std::vector<int>>{
+          time_major ? std::vector<int>{sequence_length, n_batch, n_input}
+                     : std::vector<int>{n_batch, sequence_length, n_input},
+
+          {n_cell, n_input},  // input_to_input_weight tensor
+          {n_cell, n_input},  // input_to_forget_weight tensor
+          {n_cell, n_input},  // input_to_cell_weight tensor
+          {n_cell, n_input},  // input_to_output_weight tensor
+
+          {n_cell, n_output},  // recurrent_to_input_weight tensor
+          {n_cell, n_output},  // recurrent_to_forget_weight tensor
+          {n_cell, n_output},  // recurrent_to_cell_weight tensor
+          {n_cell, n_output},  // recurrent_to_output_weight tensor
+
+          {0},  // cell_to_input_weight tensor
+          {0},  // cell_to_forget_weight tensor
+          {0},  // cell_to_output_weight tensor
+
+          {n_cell},  // input_gate_bias tensor
+          {n_cell},  // forget_gate_bias tensor
+          {n_cell},  // cell_gate_bias tensor
+          {n_cell},  // output_gate_bias tensor
+
+          {0, 0},  // projection_weight tensor
+          {0},     // projection_bias tensor
+
+          {n_batch, n_output},  // output_state tensor
+          {n_batch, n_cell},    // cell_state tensor
+      });
+  std::mt19937 random(n_input * n_cell);
+  std::uniform_real_distribution<float> distribution(-0.5f, 0.5f);
+  auto values = [&](int size) {
+    std::vector<float> result(size);
+    for (float& value : result) value = distribution(random);
+    return result;
+  };
+  lstm->SetInputToInputWeights(values(n_cell * n_input));
+  lstm->SetInputToForgetWeights(values(n_cell * n_input));
+  lstm->SetInputToCellWeights(values(n_cell * n_input));
+  lstm->SetInputToOutputWeights(values(n_cell * n_input));
+  lstm->SetRecurrentToInputWeights(values(n_cell * n_output));
+  lstm->SetRecurrentToForgetWeights(values(n_cell * n_output));
+  lstm->SetRecurrentToCellWeights(values(n_cell * n_output));
+  lstm->SetRecurrentToOutputWeights(values(n_cell * n_output));
+  lstm->SetInputGateBias(values(n_cell));
+  lstm->SetForgetGateBias(values(n_cell));
+  lstm->SetCellBias(values(n_cell));
+  lstm->SetOutputGateBias(values(n_cell));
+  return lstm;
+}
+
+class StreamingUnidirectionalLstmTest : public ::testing::TestWithParam<bool> {
+};
+
+// The state of the LSTM carries over from one invocation to the next, so that
+// a sequence can be fed as it arrives, one step at a time.
+TEST_P(StreamingUnidirectionalLstmTest, StepByStepMatchesWholeSequence) {
+  const bool time_major = GetParam();
+  const int n_batch = 2;
+  const int n_input = 3;
+  const int n_cell = 5;
+  // Longer than the number of steps whose input projections are computed at
+  // once.
+  const int sequence_length = 70;
+  std::unique_ptr<UnidirectionalLSTMOpModel> sequence_lstm = CreateRandomLstm(
+      n_batch, n_input, n_cell, sequence_length, time_major);
+  std::unique_ptr<UnidirectionalLSTMOpModel> step_lstm =
+      CreateRandomLstm(n_batch, n_input, n_cell, /*sequence_length=*/1,
+                       /*time_major=*/true);
+
+  // The input of each step, one row per batch.
+  std::mt19937 random(1);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  std::vector<float> input(sequence_length * n_batch * n_input);
+  for (float& value : input) value = distribution(random);
+  for (int t = 0; t < sequence_length; ++t) {
+    for (int b = 0; b < n_batch; ++b) {
+      const float* row = input.data() + (t * n_batch + b) * n_input;
+      const int offset = time_major ? t * n_batch + b : b * sequence_length + t;
+      sequence_lstm->SetInput(offset * n_input, row, row + n_input);
+    }
+  }
+  ASSERT_EQ(sequence_lstm->Invoke(), kTfLiteOk);
+  const std::vector<float> sequence_output = sequence_lstm->GetOutput();
+
+  for (int t = 0; t < sequence_length; ++t) {
+    const float* step_input = input.data() + t * n_batch * n_input;
+    step_lstm->SetInput(0, step_input, step_input + n_batch * n_input);
+    ASSERT_EQ(step_lstm->Invoke(), kTfLiteOk);
+    std::vector<float> expected;
+    for (int b = 0; b < n_batch; ++b) {
+      const int offset = time_major ? t * n_batch + b : b * sequence_length + t;
+      expected.insert(expected.end(),
+                      sequence_output.begin() + offset * n_cell,
+                      sequence_output.begin() + (offset + 1) * n_cell);
+    }
+    EXPECT_THAT(step_lstm->GetOutput(),
+                ElementsAreArray(ArrayFloatNear(expected, 1e-5)))
+        << "step " << t;
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(StreamingUnidirectionalLstmTest,
+                         StreamingUnidirectionalLstmTest,
+                         ::testing::Values(true, false));
+
+// Run with --benchmark_filter=BM_UnidirectionalLstm. The step_time counter is
+// the latency of a single step of the sequence.
+void BM_UnidirectionalLstmFloat(benchmark::State& state) {
+  const int n_batch = state.range(0);
+  const int n_input = state.range(1);
+  const int n_cell = state.range(2);
+  const int sequence_length = state.range(3);
+  std::unique_ptr<UnidirectionalLSTMOpModel> lstm = CreateRandomLstm(
+      n_batch, n_input, n_cell, sequence_length, /*time_major=*/true);
+  const std::vector<float> input(sequence_length * n_batch * n_input, 0.5f);
+  lstm->SetInput(0, input.data(), input.data() + input.size());
+  for (auto _ : state) {
+    if (lstm->Invoke() != kTfLiteOk) {
+      state.SkipWithError("Invoke failed");
+      break;
+    }
+  }
+  state.counters["step_time"] = benchmark::Counter(
+      sequence_length, benchmark::Counter::kIsIterationInvariantRate |
+                           benchmark::Counter::kInvert);
+}
+
+BENCHMARK(BM_UnidirectionalLstmFloat)
+    ->Args({1, 256, 256, 1})
+    ->Args({1, 256, 256, 64})
+    ->Args({4, 256, 256, 64})
+    ->Args({1, 512, 1024, 1})
+    ->Args({1, 512, 1024, 64});
+
 #define QUANTIZE_PARAMETER_TEST(test) \
   INSTANTIATE_TEST_SUITE_P(test, test, ::testing::ValuesIn({false, true}));
 
@@ -227,6 +227,13 @@ class UnidirectionalLSTMOpModel : public SingleOpModel {
 
   std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
 
+  // Resizes the input to `shape` and reallocates the tensors, which prepares
+  // the op again.
+  TfLiteStatus ResizeInputAndAllocate(const std::vector<int>& shape) {
+    TF_LITE_ENSURE_STATUS(interpreter_->ResizeInputTensor(input_, shape));
+    return interpreter_->AllocateTensors();
+  }
+
   int num_inputs() { return n_input_; }
   int num_outputs() { return n_output_; }
   int num_cells() { return n_cell_; }
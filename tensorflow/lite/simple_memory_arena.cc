@@ -284,6 +284,16 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::AllocateAt(
+    const std::vector<ArenaAllocWithUsageInterval>& allocs) {
+  for (const auto& alloc : allocs) {
+    if (alloc.size == 0) continue;
+    high_water_mark_ = std::max(high_water_mark_, alloc.offset + alloc.size);
+    active_allocs_.push_back(alloc);
+  }
+  std::sort(active_allocs_.begin(), active_allocs_.end());
+}
+
 TfLiteStatus SimpleMemoryArena::Commit(bool* arena_reallocated) {
   // Resize the arena to the high water mark (calculated by Allocate), retaining
   // old contents and alignment in the process. Since Alloc pointers are offset
@@ -142,6 +142,11 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Schedule memory allocations whose offsets were computed beforehand, e.g.
+  // by `Allocate` for the same sizes and usage intervals. They must not share
+  // memory with the active allocs while they are both in use.
+  void AllocateAt(const std::vector<ArenaAllocWithUsageInterval>& allocs);
+
   TfLiteStatus Commit(bool* arena_reallocated);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context,
@@ -0,0 +1,217 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/arena_plan_optimizer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/arena_plan_cache.h"
+#include "tensorflow/lite/simple_memory_arena.h"
+
+namespace tflite {
+namespace tools {
+namespace {
+
+using Alloc = ArenaAllocWithUsageInterval;
+
+size_t AlignTo(size_t alignment, size_t offset) {
+  return offset % alignment == 0 ? offset
+                                 : offset + (alignment - offset % alignment);
+}
+
+bool InUseTogether(const Alloc& a, const Alloc& b) {
+  return a.first_node <= b.last_node && b.first_node <= a.last_node;
+}
+
+size_t ArenaSize(const std::vector<Alloc>& allocs) {
+  size_t arena_size = 0;
+  for (const Alloc& alloc : allocs) {
+    arena_size = std::max(arena_size, alloc.offset + alloc.size);
+  }
+  return arena_size;
+}
+
+// Places allocations one at a time, given the ones placed before.
+class Placer {
+ public:
+  Placer(size_t alignment, bool best_fit)
+      : alignment_(alignment), best_fit_(best_fit) {}
+
+  // Returns the offset of `alloc`: the smallest gap between placed
+  // allocations in use at the same time that fits it if `best_fit_`, the first
+  // one otherwise, or the end of these allocations.
+  size_t FindOffset(const Alloc& alloc) const {
+    size_t best_offset = std::numeric_limits<size_t>::max();
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t current_offset = 0;
+    for (const Alloc& placed : placed_) {
+      if (!InUseTogether(alloc, placed)) continue;
+      const size_t aligned_offset = AlignTo(alignment_, current_offset);
+      if (aligned_offset + alloc.size <= placed.offset) {
+        if (!best_fit_) return aligned_offset;
+        if (placed.offset - aligned_offset < best_gap) {
+          best_offset = aligned_offset;
+          best_gap = placed.offset - aligned_offset;
+        }
+      }
+      current_offset = std::max(current_offset, placed.offset + placed.size);
+    }
+    if (best_offset != std::numeric_limits<size_t>::max()) return best_offset;
+    return AlignTo(alignment_, current_offset);
+  }
+
+  void Place(const Alloc& alloc) {
+    placed_.insert(std::upper_bound(placed_.begin(), placed_.end(), alloc),
+                   alloc);
+    arena_size_ = std::max(arena_size_, alloc.offset + alloc.size);
+  }
+
+  size_t arena_size() const { return arena_size_; }
+
+ private:
+  const size_t alignment_;
+  const bool best_fit_;
+  // Sorted by offset.
+  std::vector<Alloc> placed_;
+  size_t arena_size_ = 0;
+};
+
+// Places `allocs` in the order of `order`, except that the next allocation is
+// the one among the next `lookahead` that grows the arena the least.
+std::vector<Alloc> Place(const std::vector<Alloc>& allocs,
+                         std::vector<int> order, size_t alignment,
+                         bool best_fit, int lookahead) {
+  std::vector<Alloc> placed = allocs;
+  Placer placer(alignment, best_fit);
+  for (size_t next = 0; next < order.size(); ++next) {
+    size_t chosen = next;
+    size_t chosen_offset = placer.FindOffset(allocs[order[next]]);
+    size_t chosen_end = std::max(placer.arena_size(),
+                                 chosen_offset + allocs[order[next]].size);
+    const size_t window_end =
+        std::min(order.size(), next + std::max(lookahead, 1));
+    for (size_t i = next + 1; i < window_end; ++i) {
+      const Alloc& alloc = allocs[order[i]];
+      const size_t offset = placer.FindOffset(alloc);
+      const size_t end = std::max(placer.arena_size(), offset + alloc.size);
+      if (end < chosen_end) {
+        chosen = i;
+        chosen_offset = offset;
+        chosen_end = end;
+      }
+    }
+    // The skipped allocations keep their order.
+    std::rotate(order.begin() + next, order.begin() + chosen,
+                order.begin() + chosen + 1);
+    Alloc& alloc = placed[order[next]];
+    alloc.offset = chosen_offset;
+    placer.Place(alloc);
+  }
+  return placed;
+}
+
+// For every allocation, the largest total size of the allocations in use at
+// the same time at a node using it.
+std::vector<size_t> Breadths(const std::vector<Alloc>& allocs) {
+  // Nodes are renumbered to the distinct first nodes and last nodes, since the
+  // last node of tensors used until the end is the largest int32_t.
+  std::vector<int32_t> nodes;
+  for (const Alloc& alloc : allocs) {
+    nodes.push_back(alloc.first_node);
+    nodes.push_back(alloc.last_node);
+  }
+  std::sort(nodes.begin(), nodes.end());
+  nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+  auto index = [&nodes](int32_t node) -> size_t {
+    return std::lower_bound(nodes.begin(), nodes.end(), node) - nodes.begin();
+  };
+  std::vector<size_t> in_use(nodes.size(), 0);
+  for (const Alloc& alloc : allocs) {
+    for (size_t n = index(alloc.first_node); n <= index(alloc.last_node);
+         ++n) {
+      in_use[n] += alloc.size;
+    }
+  }
+  std::vector<size_t> breadths;
+  breadths.reserve(allocs.size());
+  for (const Alloc& alloc : allocs) {
+    breadths.push_back(
+        *std::max_element(in_use.begin() + index(alloc.first_node),
+                          in_use.begin() + index(alloc.last_node) + 1));
+  }
+  return breadths;
+}
+
+}  // namespace
+
+ArenaPlan OptimizeArenaPlan(const ArenaPlan& plan,
+                            const ArenaPlanOptimizerOptions& options) {
+  const std::vector<Alloc>& allocs = plan.allocs;
+  const std::vector<size_t> breadths = Breadths(allocs);
+  auto lifetime = [&allocs](int i) {
+    return static_cast<int64_t>(allocs[i].last_node) - allocs[i].first_node;
+  };
+  // Orders in which the heuristics place the allocations, ties being broken
+  // by the following criteria and then by tensor index.
+  const std::vector<std::function<bool(int, int)>> heuristics = {
+      // Greedy by size.
+      [&](int a, int b) {
+        if (allocs[a].size != allocs[b].size) {
+          return allocs[a].size > allocs[b].size;
+        }
+        return lifetime(a) > lifetime(b);
+      },
+      // Greedy by breadth: allocations in use when memory is the scarcest
+      // first.
+      [&](int a, int b) {
+        if (breadths[a] != breadths[b]) return breadths[a] > breadths[b];
+        return allocs[a].size > allocs[b].size;
+      },
+      // Longest lived first.
+      [&](int a, int b) {
+        if (lifetime(a) != lifetime(b)) return lifetime(a) > lifetime(b);
+        return allocs[a].size > allocs[b].size;
+      },
+  };
+
+  ArenaPlan best = plan;
+  best.arena_size = ArenaSize(plan.allocs);
+  for (const auto& heuristic : heuristics) {
+    std::vector<int> order(allocs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), heuristic);
+    for (bool best_fit : {true, false}) {
+      for (int lookahead : {1, options.lookahead}) {
+        std::vector<Alloc> placed =
+            Place(allocs, order, options.alignment, best_fit, lookahead);
+        const size_t arena_size = ArenaSize(placed);
+        if (arena_size < best.arena_size) {
+          best.allocs = std::move(placed);
+          best.arena_size = arena_size;
+        }
+      }
+    }
+  }
+  return best;
+}
+
+}  // namespace tools
+}  // namespace tflite
@@ -0,0 +1,47 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_ARENA_PLAN_OPTIMIZER_H_
+#define TENSORFLOW_LITE_TOOLS_ARENA_PLAN_OPTIMIZER_H_
+
+#include <cstddef>
+
+#include "tensorflow/lite/arena_plan_cache.h"
+
+namespace tflite {
+namespace tools {
+
+struct ArenaPlanOptimizerOptions {
+  // Offsets are multiples of `alignment`, which must be at least the tensor
+  // alignment of the interpreter using the plans.
+  size_t alignment = 64;
+  // Number of the next tensors, in the order of each heuristic, among which
+  // the one growing the arena the least is placed first.
+  int lookahead = 4;
+};
+
+// Computes the layout of the allocations of `plan` with heuristics that are
+// too slow to run on every allocation of tensors, e.g. greedy by size and
+// greedy by breadth with lookahead, and returns the one with the smallest
+// arena, or `plan` if none is smaller. `plan` must be valid.
+//
+// The runtime planner places tensors in a single best-fit pass in the order
+// of their sizes, which may leave unused gaps in the arena.
+ArenaPlan OptimizeArenaPlan(const ArenaPlan& plan,
+                            const ArenaPlanOptimizerOptions& options);
+
+}  // namespace tools
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_ARENA_PLAN_OPTIMIZER_H_
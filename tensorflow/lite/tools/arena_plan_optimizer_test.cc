@@ -0,0 +1,102 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/arena_plan_optimizer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/arena_plan_cache.h"
+#include "tensorflow/lite/simple_memory_arena.h"
+
+namespace tflite {
+namespace tools {
+namespace {
+
+// Returns a plan where no allocation shares memory with another one.
+ArenaPlan PlanWithoutReuse(const std::vector<size_t>& sizes,
+                           const std::vector<int32_t>& first_nodes,
+                           const std::vector<int32_t>& last_nodes,
+                           size_t alignment) {
+  ArenaPlan plan;
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    ArenaAllocWithUsageInterval alloc;
+    alloc.tensor = i;
+    alloc.offset = plan.arena_size;
+    alloc.size = sizes[i];
+    alloc.first_node = first_nodes[i];
+    alloc.last_node = last_nodes[i];
+    plan.allocs.push_back(alloc);
+    plan.arena_size += (sizes[i] + alignment - 1) / alignment * alignment;
+  }
+  return plan;
+}
+
+TEST(ArenaPlanOptimizerTest, ReusesMemory) {
+  // A chain of nodes, where node i reads tensor i and writes tensor i + 1.
+  ArenaPlan plan = PlanWithoutReuse({64, 32, 64, 32}, {0, 0, 1, 2},
+                                    {0, 1, 2, 3}, /*alignment=*/32);
+  ArenaPlanOptimizerOptions options;
+  options.alignment = 32;
+  ArenaPlan optimized = OptimizeArenaPlan(plan, options);
+  EXPECT_TRUE(IsValidArenaPlan(optimized));
+  // At most two tensors are in use at the same time.
+  EXPECT_EQ(optimized.arena_size, 96);
+}
+
+TEST(ArenaPlanOptimizerTest, ClosesGapsOfGreedyBySize) {
+  // Tensor 3 is used until the end of the graph. Placing the tensors in order
+  // of their sizes, as the runtime planner does, needs 128 bytes.
+  ArenaPlan plan = PlanWithoutReuse(
+      {48, 32, 32, 16, 48}, {0, 0, 1, 1, 2},
+      {0, 1, 2, std::numeric_limits<int32_t>::max(), 2}, /*alignment=*/16);
+  ArenaPlanOptimizerOptions options;
+  options.alignment = 16;
+  ArenaPlan optimized = OptimizeArenaPlan(plan, options);
+  EXPECT_TRUE(IsValidArenaPlan(optimized));
+  // Node 2 uses tensors 2, 3 and 4.
+  EXPECT_EQ(optimized.arena_size, 96);
+}
+
+TEST(ArenaPlanOptimizerTest, RandomPlans) {
+  std::mt19937 random(42);
+  for (int i = 0; i < 50; ++i) {
+    const int num_tensors = 1 + random() % 100;
+    std::vector<size_t> sizes;
+    std::vector<int32_t> first_nodes, last_nodes;
+    for (int t = 0; t < num_tensors; ++t) {
+      sizes.push_back(1 + random() % 1000);
+      first_nodes.push_back(random() % 50);
+      last_nodes.push_back(first_nodes.back() + random() % 10);
+    }
+    ArenaPlanOptimizerOptions options;
+    options.alignment = 1 << (random() % 7);
+    const ArenaPlan plan =
+        PlanWithoutReuse(sizes, first_nodes, last_nodes, options.alignment);
+    ArenaPlan optimized = OptimizeArenaPlan(plan, options);
+    EXPECT_TRUE(IsValidArenaPlan(optimized));
+    EXPECT_LE(optimized.arena_size, plan.arena_size);
+    for (const ArenaAllocWithUsageInterval& alloc : optimized.allocs) {
+      EXPECT_EQ(alloc.offset % options.alignment, 0);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace tools
+}  // namespace tflite
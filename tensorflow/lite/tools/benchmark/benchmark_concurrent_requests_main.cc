@@ -0,0 +1,218 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Measures the throughput of serving one model to concurrent requests, either
+// from an InterpreterPool or from one independently built interpreter per
+// request thread, and the memory used by each approach.
+//
+// bazel run -c opt \
+//   //tensorflow/lite/tools/benchmark:benchmark_concurrent_requests -- \
+//   --graph=/path/to/model.tflite --num_request_threads=8 [--use_pool=false]
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/interpreter_pool.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/profiling/memory_info.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+struct BenchmarkFlags {
+  std::string graph;
+  int32_t num_request_threads = 4;
+  int32_t max_num_interpreters = 0;
+  int32_t num_threads = 1;
+  bool use_pool = true;
+  bool use_xnnpack = true;
+  float duration_seconds = 10.0f;
+};
+
+// Fills the non-string inputs with zeros.
+void FillInputs(Interpreter& interpreter) {
+  for (int input : interpreter.inputs()) {
+    TfLiteTensor* tensor = interpreter.tensor(input);
+    if (tensor->type != kTfLiteString && tensor->data.raw != nullptr) {
+      std::memset(tensor->data.raw, 0, tensor->bytes);
+    }
+  }
+}
+
+// Runs requests on `num_request_threads` threads for `duration_seconds`.
+// `invoke` runs one request on the given thread and returns false on error.
+template <typename InvokeFn>
+int64_t RunRequests(const BenchmarkFlags& flags, InvokeFn invoke,
+                    std::atomic<bool>& failed) {
+  std::atomic<int64_t> num_requests(0);
+  const uint64_t end_micros =
+      profiling::time::NowMicros() +
+      static_cast<uint64_t>(flags.duration_seconds * 1e6);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < flags.num_request_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      while (!failed && profiling::time::NowMicros() < end_micros) {
+        if (!invoke(t)) {
+          failed = true;
+          return;
+        }
+        ++num_requests;
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  return num_requests;
+}
+
+int Run(const BenchmarkFlags& flags) {
+  std::unique_ptr<FlatBufferModel> model =
+      FlatBufferModel::BuildFromFile(flags.graph.c_str());
+  if (model == nullptr) {
+    TFLITE_LOG(ERROR) << "Failed to load model " << flags.graph;
+    return EXIT_FAILURE;
+  }
+  const profiling::memory::MemoryUsage initial_memory =
+      profiling::memory::GetMemoryUsage();
+
+  std::atomic<bool> failed(false);
+  int64_t num_requests = 0;
+  int num_interpreters = 0;
+  const uint64_t start_micros = profiling::time::NowMicros();
+  if (flags.use_pool) {
+    ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+    InterpreterPool::Options options;
+    options.max_num_interpreters = flags.max_num_interpreters > 0
+                                       ? flags.max_num_interpreters
+                                       : flags.num_request_threads;
+    options.num_threads = flags.num_threads;
+    options.use_xnnpack = flags.use_xnnpack;
+    std::unique_ptr<InterpreterPool> pool =
+        InterpreterPool::Create(*model, resolver, options);
+    if (pool == nullptr) {
+      TFLITE_LOG(ERROR) << "Failed to create interpreter pool.";
+      return EXIT_FAILURE;
+    }
+    num_requests = RunRequests(
+        flags,
+        [&](int) {
+          InterpreterPool::Lease interpreter = pool->Acquire();
+          if (!interpreter) return false;
+          FillInputs(*interpreter);
+          return interpreter->Invoke() == kTfLiteOk;
+        },
+        failed);
+    num_interpreters = pool->num_interpreters();
+  } else {
+    // Baseline: every request thread builds its own interpreter, which packs
+    // its own copy of the weights for XNNPACK.
+    ops::builtin::BuiltinOpResolver resolver;
+    ops::builtin::BuiltinOpResolverWithoutDefaultDelegates
+        resolver_without_xnnpack;
+    std::vector<std::unique_ptr<Interpreter>> interpreters(
+        flags.num_request_threads);
+    for (auto& interpreter : interpreters) {
+      InterpreterBuilder builder(
+          *model, flags.use_xnnpack
+                      ? static_cast<const OpResolver&>(resolver)
+                      : static_cast<const OpResolver&>(
+                            resolver_without_xnnpack));
+      builder.SetNumThreads(flags.num_threads);
+      if (builder(&interpreter) != kTfLiteOk || interpreter == nullptr ||
+          interpreter->AllocateTensors() != kTfLiteOk) {
+        TFLITE_LOG(ERROR) << "Failed to build interpreter.";
+        return EXIT_FAILURE;
+      }
+    }
+    num_requests = RunRequests(
+        flags,
+        [&](int t) {
+          FillInputs(*interpreters[t]);
+          return interpreters[t]->Invoke() == kTfLiteOk;
+        },
+        failed);
+    num_interpreters = interpreters.size();
+  }
+  const double elapsed_seconds =
+      (profiling::time::NowMicros() - start_micros) / 1e6;
+  if (failed) {
+    TFLITE_LOG(ERROR) << "Failed to invoke the model.";
+    return EXIT_FAILURE;
+  }
+
+  TFLITE_LOG(INFO) << "Mode: "
+                   << (flags.use_pool ? "interpreter pool"
+                                      : "one interpreter per thread");
+  TFLITE_LOG(INFO) << "Request threads: " << flags.num_request_threads
+                   << ", interpreters: " << num_interpreters;
+  TFLITE_LOG(INFO) << "Requests: " << num_requests << " in " << elapsed_seconds
+                   << " s, throughput: " << num_requests / elapsed_seconds
+                   << " requests/s";
+  if (profiling::memory::MemoryUsage::IsSupported()) {
+    TFLITE_LOG(INFO) << "Memory used by the interpreters: "
+                     << (profiling::memory::GetMemoryUsage() - initial_memory);
+  }
+  return EXIT_SUCCESS;
+}
+
+int Main(int argc, char** argv) {
+  BenchmarkFlags flags;
+  std::vector<Flag> flag_list = {
+      Flag::CreateFlag("graph", &flags.graph, "Path to the .tflite model.",
+                       Flag::kRequired),
+      Flag::CreateFlag("num_request_threads", &flags.num_request_threads,
+                       "Number of threads sending requests."),
+      Flag::CreateFlag("max_num_interpreters", &flags.max_num_interpreters,
+                       "Maximum number of interpreters of the pool. 0 means "
+                       "one per request thread."),
+      Flag::CreateFlag("num_threads", &flags.num_threads,
+                       "Number of threads used by each invocation."),
+      Flag::CreateFlag("use_pool", &flags.use_pool,
+                       "Serve from an interpreter pool, rather than from one "
+                       "interpreter per request thread."),
+      Flag::CreateFlag("use_xnnpack", &flags.use_xnnpack,
+                       "Apply the XNNPACK delegate."),
+      Flag::CreateFlag("duration_seconds", &flags.duration_seconds,
+                       "Duration of the benchmark."),
+  };
+  const bool parsed = Flags::Parse(&argc, const_cast<const char**>(argv),
+                                   flag_list);
+  if (!parsed || flags.num_request_threads <= 0) {
+    TFLITE_LOG(ERROR) << Flags::Usage(argv[0], flag_list);
+    return EXIT_FAILURE;
+  }
+  return Run(flags);
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
+
+int main(int argc, char** argv) { return tflite::benchmark::Main(argc, argv); }
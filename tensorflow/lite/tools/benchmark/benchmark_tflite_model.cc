@@ -41,6 +41,7 @@ limitations under the License.
 #include "ruy/profiler/profiler.h"  // from @ruy
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/lite/arena_plan_cache.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/kernels/register.h"
@@ -54,6 +55,7 @@ limitations under the License.
 #include "tensorflow/lite/optional_debug_tools.h"
 #include "tensorflow/lite/profiling/model_runtime_info.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
+#include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_params.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
@@ -611,6 +613,10 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("enable_builtin_cast_constant_cache",
                           BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("parallel_node_execution_threads",
+                          BenchmarkParam::Create<int32_t>(0));
+  default_params.AddParam("arena_plan_file",
+                          BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("output_filepath",
                           BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("output_proto_filepath",
@@ -720,6 +726,15 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "enable_builtin_cast_constant_cache", &params_,
           "Cache the output of the builtin cast operation when its input "
           "is a constant tensor."),
+      CreateFlag<int32_t>(
+          "parallel_node_execution_threads", &params_,
+          "Number of threads that run independent nodes of the model "
+          "concurrently. Values less than 2 run nodes sequentially."),
+      CreateFlag<std::string>(
+          "arena_plan_file", &params_,
+          "File with plans of the tensor arenas of the model. Tensors are "
+          "allocated with its plans if it exists, and the plans computed by "
+          "the run are saved to it."),
       CreateFlag<std::string>(
           "output_filepath", &params_,
           "File path to export outputs layer as binary data."),
@@ -806,6 +821,10 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Disable delegate clustering", verbose);
   LOG_BENCHMARK_PARAM(bool, "enable_builtin_cast_constant_cache",
                       "Constant CAST output cache", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "parallel_node_execution_threads",
+                      "Parallel node execution threads", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "arena_plan_file", "Arena plan file",
+                      verbose);
   LOG_BENCHMARK_PARAM(std::string, "output_filepath",
                       "File path to export outputs layer to", verbose);
   LOG_BENCHMARK_PARAM(std::string, "output_proto_filepath",
@@ -1035,6 +1054,23 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
       params_.Get<bool>("disable_delegate_clustering"));
   options.SetCacheConstantCastOp(
       params_.Get<bool>("enable_builtin_cast_constant_cache"));
+  options.SetParallelNodeExecutionThreads(
+      params_.Get<int32_t>("parallel_node_execution_threads"));
+  const std::string arena_plan_file =
+      params_.Get<std::string>("arena_plan_file");
+  if (!arena_plan_file.empty()) {
+    arena_plan_cache_ = std::make_shared<ArenaPlanCache>();
+    std::ifstream file(arena_plan_file, std::ios::binary);
+    if (file) {
+      std::stringstream data;
+      data << file.rdbuf();
+      if (!arena_plan_cache_->Deserialize(data.str())) {
+        TFLITE_LOG(WARN) << "Ignoring invalid arena plans in "
+                         << arena_plan_file;
+      }
+    }
+    options.SetArenaPlanCache(arena_plan_cache_);
+  }
 
   tflite::InterpreterBuilder builder(*model_, *resolver, &options);
   if (builder.SetNumThreads(num_threads) != kTfLiteOk) {
@@ -1234,10 +1270,15 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
     }
   }
 
+  const uint64_t allocate_start_us = profiling::time::NowMicros();
   if (interpreter_runner_->AllocateTensors() != kTfLiteOk) {
     TFLITE_LOG(ERROR) << "Failed to allocate tensors!";
     return kTfLiteError;
   }
+  const uint64_t allocate_us =
+      profiling::time::NowMicros() - allocate_start_us;
+  ReportTensorAllocation(allocate_us);
+
 
   AddOwnedListener(
       std::unique_ptr<BenchmarkListener>(new RuyProfileListener()));
@@ -1248,6 +1289,33 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
   return kTfLiteOk;
 }
 
+void BenchmarkTfLiteModel::ReportTensorAllocation(uint64_t allocate_us) {
+  size_t arena_size = 0;
+  size_t arena_persist_size = 0;
+  for (int i = 0; i < interpreter_->subgraphs_size(); ++i) {
+    Subgraph::SubgraphAllocInfo alloc_info;
+    interpreter_->subgraph(i)->GetMemoryAllocInfo(&alloc_info);
+    arena_size += alloc_info.arena_size;
+    arena_persist_size += alloc_info.arena_persist_size;
+  }
+  TFLITE_LOG(INFO) << "Allocating tensors took " << allocate_us / 1e3
+                   << " ms. Arena: " << arena_size
+                   << " bytes, persistent arena: " << arena_persist_size
+                   << " bytes.";
+  if (arena_plan_cache_ == nullptr) return;
+
+  const std::string arena_plan_file =
+      params_.Get<std::string>("arena_plan_file");
+  TFLITE_LOG(INFO) << "Arena plans: " << arena_plan_cache_->num_hits()
+                   << " from " << arena_plan_file << ", "
+                   << arena_plan_cache_->num_misses() << " computed.";
+  std::ofstream file(arena_plan_file, std::ios::binary | std::ios::trunc);
+  file << arena_plan_cache_->Serialize();
+  if (!file.flush()) {
+    TFLITE_LOG(WARN) << "Failed to save arena plans to " << arena_plan_file;
+  }
+}
+
 TfLiteStatus BenchmarkTfLiteModel::LoadModel() {
   std::string fd_or_graph_path = params_.Get<std::string>("graph");
   model_loader_ = tools::CreateModelLoaderFromPath(fd_or_graph_path);
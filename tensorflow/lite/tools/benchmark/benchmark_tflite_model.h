@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_TFLITE_MODEL_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <random>
@@ -24,6 +25,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/lite/arena_plan_cache.h"
 #include "tensorflow/lite/core/model.h"
 #include "tensorflow/lite/core/subgraph.h"
 #include "tensorflow/lite/profiling/profiler.h"
@@ -203,6 +205,10 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   utils::InputTensorData CreateRandomTensorData(
       const TfLiteTensor& t, const InputLayerInfo* layer_info);
 
+  // Logs the time `AllocateTensors` took and the size of the tensor arenas,
+  // and saves the arena plans if `arena_plan_file` is set.
+  void ReportTensorAllocation(uint64_t allocate_us);
+
   void AddOwnedListener(std::unique_ptr<BenchmarkListener> listener) {
     if (listener == nullptr) return;
     owned_listeners_.emplace_back(std::move(listener));
@@ -212,6 +218,8 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   std::vector<std::unique_ptr<BenchmarkListener>> owned_listeners_;
   std::mt19937 random_engine_;
   std::vector<Interpreter::TfLiteDelegatePtr> owned_delegates_;
+  // Plans of the tensor arenas, when `arena_plan_file` is set.
+  std::shared_ptr<ArenaPlanCache> arena_plan_cache_;
   // Always TFLITE_LOG the benchmark result.
   BenchmarkLoggingListener log_output_;
   std::unique_ptr<tools::ModelLoader> model_loader_;
@@ -0,0 +1,358 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Measures the time to first inference and the steady-state memory of several
+// processes serving one model with the XNNPACK delegate, which either pack the
+// weights privately or share an XNNPACK weight cache file.
+//
+// With `--background_packing`, a process that finds no cache file serves its
+// first requests with the builtin kernels, which use the weights of the model
+// as they are, while the XNNPACK interpreter is built on a background thread.
+// The requests then switch to the XNNPACK interpreter. See
+// `tflite::BackgroundPackedInterpreter`.
+//
+// bazel run -c opt \
+//   //tensorflow/lite/tools/benchmark:benchmark_weight_cache_sharing -- \
+//   --graph=/path/to/model.tflite --num_processes=4 \
+//   --weight_cache_file_path=/tmp/model.xnnpack_cache [--background_packing]
+//
+// Run it twice with a cache file to compare a cold start, where one process
+// builds the file, to a warm start, where all processes map it. PSS, which
+// splits shared pages between the processes mapping them, shows the memory
+// saved by sharing the file. It is only reported on Linux.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/background_packed_interpreter.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/profiling/memory_info.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+struct BenchmarkFlags {
+  std::string graph;
+  std::string weight_cache_file_path;
+  int32_t num_processes = 4;
+  int32_t num_threads = 1;
+  int32_t num_runs = 50;
+  bool background_packing = false;
+};
+
+// Measurements of one serving process, sent to the parent process.
+struct ProcessResult {
+  bool ok = false;
+  // Whether the first requests used the builtin kernels.
+  bool served_before_packing = false;
+  int64_t first_inference_us = 0;
+  // Time until the XNNPACK interpreter serves the requests.
+  int64_t packed_us = 0;
+  int64_t steady_state_inference_us = 0;
+  int64_t rss_kb = -1;
+  int64_t pss_kb = -1;
+};
+
+// An interpreter with its delegate, which must outlive it.
+struct Server {
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate{nullptr, TfLiteXNNPackDelegateDelete};
+  std::unique_ptr<Interpreter> interpreter;
+};
+
+std::unique_ptr<Server> CreateServer(const FlatBufferModel& model,
+                                     const OpResolver& resolver,
+                                     const BenchmarkFlags& flags,
+                                     bool use_xnnpack) {
+  auto server = std::make_unique<Server>();
+  InterpreterBuilder builder(model, resolver);
+  if (builder.SetNumThreads(flags.num_threads) != kTfLiteOk) {
+    return nullptr;
+  }
+  if (use_xnnpack) {
+    TfLiteXNNPackDelegateOptions options =
+        TfLiteXNNPackDelegateOptionsDefault();
+    options.num_threads = flags.num_threads;
+    if (!flags.weight_cache_file_path.empty()) {
+      options.weight_cache_file_path = flags.weight_cache_file_path.c_str();
+    }
+    server->delegate.reset(TfLiteXNNPackDelegateCreate(&options));
+    if (server->delegate == nullptr) {
+      return nullptr;
+    }
+    builder.AddDelegate(server->delegate.get());
+  }
+  if (builder(&server->interpreter) != kTfLiteOk ||
+      server->interpreter == nullptr ||
+      server->interpreter->AllocateTensors() != kTfLiteOk) {
+    return nullptr;
+  }
+  return server;
+}
+
+// Fills the non-string inputs with zeros and runs one inference.
+bool RunInference(Interpreter& interpreter) {
+  for (int input : interpreter.inputs()) {
+    TfLiteTensor* tensor = interpreter.tensor(input);
+    if (tensor->type != kTfLiteString && tensor->data.raw != nullptr) {
+      std::memset(tensor->data.raw, 0, tensor->bytes);
+    }
+  }
+  return interpreter.Invoke() == kTfLiteOk;
+}
+
+// Reads the resident and proportional set sizes of the process. PSS is only
+// available on Linux.
+void ReadMemoryUsage(ProcessResult& result) {
+  std::ifstream smaps("/proc/self/smaps_rollup");
+  std::string line;
+  while (std::getline(smaps, line)) {
+    std::istringstream fields(line);
+    std::string name;
+    int64_t value_kb;
+    if (!(fields >> name >> value_kb)) continue;
+    if (name == "Rss:") result.rss_kb = value_kb;
+    if (name == "Pss:") result.pss_kb = value_kb;
+  }
+  if (result.rss_kb < 0 && profiling::memory::MemoryUsage::IsSupported()) {
+    result.rss_kb = profiling::memory::GetMemoryUsage().mem_footprint_kb;
+  }
+}
+
+// Measures the steady-state latency of the XNNPACK interpreter.
+bool RunSteadyState(Interpreter& interpreter, const BenchmarkFlags& flags,
+                    ProcessResult& result) {
+  const int64_t steady_state_start_us = profiling::time::NowMicros();
+  for (int i = 0; i < flags.num_runs; ++i) {
+    if (!RunInference(interpreter)) {
+      TFLITE_LOG(ERROR) << "Failed to invoke the model.";
+      return false;
+    }
+  }
+  result.steady_state_inference_us =
+      (profiling::time::NowMicros() - steady_state_start_us) /
+      std::max(flags.num_runs, 1);
+  return true;
+}
+
+// Serves the requests with a `BackgroundPackedInterpreter`, until the XNNPACK
+// interpreter replaces the builtin one.
+ProcessResult ServeWithBackgroundPacking(const FlatBufferModel& model,
+                                         const OpResolver& resolver,
+                                         const BenchmarkFlags& flags,
+                                         int64_t start_us) {
+  ProcessResult result;
+  BackgroundPackedInterpreter::Options options;
+  options.weight_cache_file_path = flags.weight_cache_file_path;
+  options.num_threads = flags.num_threads;
+  std::unique_ptr<BackgroundPackedInterpreter> packed =
+      BackgroundPackedInterpreter::Create(model, resolver, options);
+  if (packed == nullptr) {
+    TFLITE_LOG(ERROR) << "Failed to build interpreter.";
+    return result;
+  }
+  result.served_before_packing = !packed->IsPacked();
+
+  bool ok = RunInference(*packed->Get());
+  result.first_inference_us = profiling::time::NowMicros() - start_us;
+  // Requests keep being served while the weights are packed.
+  while (ok && packed->IsPacking()) {
+    ok = RunInference(*packed->Get());
+  }
+  if (!ok || packed->WaitUntilPacked() != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Failed to serve the model.";
+    return result;
+  }
+  result.packed_us = profiling::time::NowMicros() - start_us;
+  result.ok = RunSteadyState(*packed->Get(), flags, result);
+  return result;
+}
+
+// Serves `flags.num_runs` requests after the first one, on the XNNPACK
+// interpreter. `start_us` is the time at which the process started.
+ProcessResult Serve(const BenchmarkFlags& flags, int64_t start_us) {
+  std::unique_ptr<FlatBufferModel> model =
+      FlatBufferModel::BuildFromFile(flags.graph.c_str());
+  if (model == nullptr) {
+    TFLITE_LOG(ERROR) << "Failed to load model " << flags.graph;
+    return ProcessResult();
+  }
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  if (flags.background_packing && !flags.weight_cache_file_path.empty()) {
+    return ServeWithBackgroundPacking(*model, resolver, flags, start_us);
+  }
+
+  ProcessResult result;
+  std::unique_ptr<Server> server =
+      CreateServer(*model, resolver, flags, /*use_xnnpack=*/true);
+  if (server == nullptr) {
+    TFLITE_LOG(ERROR) << "Failed to build interpreter.";
+    return result;
+  }
+  result.packed_us = profiling::time::NowMicros() - start_us;
+  if (!RunInference(*server->interpreter)) {
+    TFLITE_LOG(ERROR) << "Failed to serve the model.";
+    return result;
+  }
+  result.first_inference_us = profiling::time::NowMicros() - start_us;
+  result.ok = RunSteadyState(*server->interpreter, flags, result);
+  return result;
+}
+
+// Runs in a forked process. Memory is measured once all processes are serving
+// so that the pages they share are split between all of them.
+void RunProcess(const BenchmarkFlags& flags, int64_t start_us, int ready_fd,
+                int measure_fd, int result_fd) {
+  ProcessResult result = Serve(flags, start_us);
+  char byte = 0;
+  if (write(ready_fd, &byte, 1) != 1) result.ok = false;
+  // Returns when the parent closes the pipe.
+  while (read(measure_fd, &byte, 1) > 0) {
+  }
+  ReadMemoryUsage(result);
+  if (write(result_fd, &result, sizeof(result)) != sizeof(result)) {
+    _exit(EXIT_FAILURE);
+  }
+  _exit(EXIT_SUCCESS);
+}
+
+int Run(const BenchmarkFlags& flags) {
+  int ready_pipe[2], measure_pipe[2], result_pipe[2];
+  if (pipe(ready_pipe) != 0 || pipe(measure_pipe) != 0 ||
+      pipe(result_pipe) != 0) {
+    TFLITE_LOG(ERROR) << "Failed to create pipes: " << strerror(errno);
+    return EXIT_FAILURE;
+  }
+  std::vector<pid_t> children;
+  for (int p = 0; p < flags.num_processes; ++p) {
+    const int64_t start_us = profiling::time::NowMicros();
+    const pid_t pid = fork();
+    if (pid == 0) {
+      close(ready_pipe[0]);
+      close(measure_pipe[1]);
+      close(result_pipe[0]);
+      RunProcess(flags, start_us, ready_pipe[1], measure_pipe[0],
+                 result_pipe[1]);
+    }
+    if (pid < 0) {
+      TFLITE_LOG(ERROR) << "Failed to fork: " << strerror(errno);
+      break;
+    }
+    children.push_back(pid);
+  }
+  close(ready_pipe[1]);
+  close(measure_pipe[0]);
+  close(result_pipe[1]);
+
+  char byte;
+  for (size_t i = 0; i < children.size(); ++i) {
+    if (read(ready_pipe[0], &byte, 1) != 1) break;
+  }
+  close(measure_pipe[1]);
+
+  std::vector<ProcessResult> results;
+  ProcessResult result;
+  while (read(result_pipe[0], &result, sizeof(result)) == sizeof(result)) {
+    results.push_back(result);
+  }
+  bool ok = results.size() == static_cast<size_t>(flags.num_processes);
+  for (pid_t pid : children) {
+    int status = 0;
+    waitpid(pid, &status, 0);
+    ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+  }
+
+  int64_t total_rss_kb = 0, total_pss_kb = 0;
+  for (size_t p = 0; p < results.size(); ++p) {
+    const ProcessResult& r = results[p];
+    ok = ok && r.ok;
+    TFLITE_LOG(INFO) << "Process " << p << ": first inference after "
+                     << r.first_inference_us / 1000.0 << " ms"
+                     << (r.served_before_packing ? " (builtin kernels)" : "")
+                     << ", XNNPACK serving after " << r.packed_us / 1000.0
+                     << " ms, steady-state inference "
+                     << r.steady_state_inference_us << " us, RSS " << r.rss_kb
+                     << " KB, PSS " << r.pss_kb << " KB";
+    total_rss_kb += r.rss_kb;
+    total_pss_kb += r.pss_kb;
+  }
+  if (!ok) {
+    TFLITE_LOG(ERROR) << "Some processes failed.";
+    return EXIT_FAILURE;
+  }
+  TFLITE_LOG(INFO) << "Weight cache: "
+                   << (flags.weight_cache_file_path.empty()
+                           ? "none"
+                           : flags.weight_cache_file_path);
+  TFLITE_LOG(INFO) << "Total RSS: " << total_rss_kb
+                   << " KB, total PSS: " << total_pss_kb << " KB";
+  return EXIT_SUCCESS;
+}
+
+int Main(int argc, char** argv) {
+  BenchmarkFlags flags;
+  std::vector<Flag> flag_list = {
+      Flag::CreateFlag("graph", &flags.graph, "Path to the .tflite model.",
+                       Flag::kRequired),
+      Flag::CreateFlag("weight_cache_file_path", &flags.weight_cache_file_path,
+                       "XNNPACK weight cache file shared by the processes. "
+                       "Empty means that every process packs the weights in "
+                       "its own memory."),
+      Flag::CreateFlag("num_processes", &flags.num_processes,
+                       "Number of serving processes."),
+      Flag::CreateFlag("num_threads", &flags.num_threads,
+                       "Number of threads used by each invocation."),
+      Flag::CreateFlag("num_runs", &flags.num_runs,
+                       "Number of inferences measuring the steady-state "
+                       "latency."),
+      Flag::CreateFlag("background_packing", &flags.background_packing,
+                       "When the weight cache file is missing, serve with the "
+                       "builtin kernels while the weights are packed on a "
+                       "background thread."),
+  };
+  const bool parsed = Flags::Parse(&argc, const_cast<const char**>(argv),
+                                   flag_list);
+  if (!parsed || flags.num_processes <= 0) {
+    TFLITE_LOG(ERROR) << Flags::Usage(argv[0], flag_list);
+    return EXIT_FAILURE;
+  }
+  return Run(flags);
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
+
+int main(int argc, char** argv) { return tflite::benchmark::Main(argc, argv); }
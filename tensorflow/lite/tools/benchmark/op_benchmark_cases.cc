@@ -0,0 +1,497 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/op_benchmark_cases.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Quantization parameters of the int8 tensors. Those of the outputs of some
+// ops are fixed by their kernels.
+constexpr float kInputScale = 0.05f;
+constexpr int kInputZeroPoint = -5;
+constexpr float kOutputScale = 0.1f;
+constexpr int kOutputZeroPoint = 3;
+constexpr float kWeightScale = 0.01f;
+
+bool HasQuantizedActivations(QuantizationScheme scheme) {
+  return scheme == QuantizationScheme::kInt8 ||
+         scheme == QuantizationScheme::kInt8PerChannel;
+}
+
+bool HasQuantizedWeights(QuantizationScheme scheme) {
+  return scheme != QuantizationScheme::kFloat32;
+}
+
+std::string DimsName(const std::vector<int>& dims) {
+  std::string name;
+  for (int dim : dims) {
+    if (!name.empty()) name += "x";
+    name += std::to_string(dim);
+  }
+  return name;
+}
+
+std::string CaseName(BuiltinOperator op, QuantizationScheme scheme,
+                     const std::string& shapes) {
+  return std::string(EnumNameBuiltinOperator(op)) + "/" +
+         QuantizationSchemeName(scheme) + "/" + shapes;
+}
+
+template <typename T>
+T* NewBuiltinData() {
+  return static_cast<T*>(std::calloc(1, sizeof(T)));
+}
+
+int OutputSize(int input_size, int stride) {
+  return (input_size + stride - 1) / stride;
+}
+
+int AddActivationInput(OpBenchmarkModel* model, QuantizationScheme scheme,
+                       const std::vector<int>& dims) {
+  if (!HasQuantizedActivations(scheme)) {
+    return model->AddInput(kTfLiteFloat32, dims);
+  }
+  return model->AddInput(kTfLiteInt8, dims, {kInputScale}, {kInputZeroPoint});
+}
+
+int AddActivationOutput(OpBenchmarkModel* model, QuantizationScheme scheme,
+                        const std::vector<int>& dims,
+                        float scale = kOutputScale,
+                        int zero_point = kOutputZeroPoint) {
+  if (!HasQuantizedActivations(scheme)) {
+    return model->AddOutput(kTfLiteFloat32, dims);
+  }
+  return model->AddOutput(kTfLiteInt8, dims, {scale}, {zero_point});
+}
+
+std::vector<float> WeightScales(QuantizationScheme scheme, int channels) {
+  if (scheme == QuantizationScheme::kInt8) return {kWeightScale};
+  std::vector<float> scales(channels);
+  for (int i = 0; i < channels; ++i) {
+    scales[i] = kWeightScale * (1.0f + 0.01f * (i % 7));
+  }
+  return scales;
+}
+
+// Adds weights whose output channels are along `channel_dimension`.
+int AddWeights(OpBenchmarkModel* model, QuantizationScheme scheme,
+               const std::vector<int>& dims, int channel_dimension) {
+  if (!HasQuantizedWeights(scheme)) {
+    return model->AddConstant(kTfLiteFloat32, dims);
+  }
+  const std::vector<float> scales =
+      WeightScales(scheme, dims[channel_dimension]);
+  return model->AddConstant(kTfLiteInt8, dims, scales,
+                            std::vector<int>(scales.size(), 0),
+                            channel_dimension);
+}
+
+int AddBias(OpBenchmarkModel* model, QuantizationScheme scheme,
+            int channels) {
+  if (!HasQuantizedActivations(scheme)) {
+    return model->AddConstant(kTfLiteFloat32, {channels});
+  }
+  std::vector<float> scales = WeightScales(scheme, channels);
+  for (float& scale : scales) scale *= kInputScale;
+  return model->AddConstant(kTfLiteInt32, {channels}, scales,
+                            std::vector<int>(scales.size(), 0));
+}
+
+OpBenchmarkCase Conv2DCase(QuantizationScheme scheme,
+                           const std::vector<int>& input_dims, int kernel_size,
+                           int output_channels, int stride) {
+  const std::string shapes =
+      DimsName(input_dims) + "/" +
+      DimsName({kernel_size, kernel_size, output_channels}) + "s" +
+      std::to_string(stride);
+  return {CaseName(BuiltinOperator_CONV_2D, scheme, shapes),
+          [=](OpBenchmarkModel* model) {
+            const int input = AddActivationInput(model, scheme, input_dims);
+            const int filter = AddWeights(
+                model, scheme,
+                {output_channels, kernel_size, kernel_size, input_dims[3]},
+                /*channel_dimension=*/0);
+            const int bias = AddBias(model, scheme, output_channels);
+            const int output = AddActivationOutput(
+                model, scheme,
+                {input_dims[0], OutputSize(input_dims[1], stride),
+                 OutputSize(input_dims[2], stride), output_channels});
+            auto* params = NewBuiltinData<TfLiteConvParams>();
+            params->padding = kTfLitePaddingSame;
+            params->stride_width = stride;
+            params->stride_height = stride;
+            params->dilation_width_factor = 1;
+            params->dilation_height_factor = 1;
+            params->activation = kTfLiteActRelu;
+            return model->AddOp(BuiltinOperator_CONV_2D,
+                                {input, filter, bias}, {output}, params);
+          }};
+}
+
+OpBenchmarkCase DepthwiseConv2DCase(QuantizationScheme scheme,
+                                    const std::vector<int>& input_dims,
+                                    int kernel_size, int stride) {
+  const int channels = input_dims[3];
+  const std::string shapes = DimsName(input_dims) + "/" +
+                             DimsName({kernel_size, kernel_size}) + "s" +
+                             std::to_string(stride);
+  return {CaseName(BuiltinOperator_DEPTHWISE_CONV_2D, scheme, shapes),
+          [=](OpBenchmarkModel* model) {
+            const int input = AddActivationInput(model, scheme, input_dims);
+            const int filter = AddWeights(
+                model, scheme, {1, kernel_size, kernel_size, channels},
+                /*channel_dimension=*/3);
+            const int bias = AddBias(model, scheme, channels);
+            const int output = AddActivationOutput(
+                model, scheme,
+                {input_dims[0], OutputSize(input_dims[1], stride),
+                 OutputSize(input_dims[2], stride), channels});
+            auto* params = NewBuiltinData<TfLiteDepthwiseConvParams>();
+            params->padding = kTfLitePaddingSame;
+            params->stride_width = stride;
+            params->stride_height = stride;
+            params->depth_multiplier = 1;
+            params->dilation_width_factor = 1;
+            params->dilation_height_factor = 1;
+            params->activation = kTfLiteActRelu6;
+            return model->AddOp(BuiltinOperator_DEPTHWISE_CONV_2D,
+                                {input, filter, bias}, {output}, params);
+          }};
+}
+
+OpBenchmarkCase FullyConnectedCase(QuantizationScheme scheme, int batch,
+                                   int input_size, int output_size) {
+  return {CaseName(BuiltinOperator_FULLY_CONNECTED, scheme,
+                   DimsName({batch, input_size}) + "/" +
+                       std::to_string(output_size)),
+          [=](OpBenchmarkModel* model) {
+            const int input =
+                AddActivationInput(model, scheme, {batch, input_size});
+            const int weights =
+                AddWeights(model, scheme, {output_size, input_size},
+                           /*channel_dimension=*/0);
+            const int bias = AddBias(model, scheme, output_size);
+            const int output =
+                AddActivationOutput(model, scheme, {batch, output_size});
+            auto* params = NewBuiltinData<TfLiteFullyConnectedParams>();
+            params->activation = kTfLiteActNone;
+            params->weights_format = kTfLiteFullyConnectedWeightsFormatDefault;
+            return model->AddOp(BuiltinOperator_FULLY_CONNECTED,
+                                {input, weights, bias}, {output}, params);
+          }};
+}
+
+// Adds or multiplies a tensor of `dims` with one of `other_dims`, which is
+// broadcast if smaller.
+OpBenchmarkCase BinaryCase(BuiltinOperator op, QuantizationScheme scheme,
+                           const std::vector<int>& dims,
+                           const std::vector<int>& other_dims) {
+  return {CaseName(op, scheme, DimsName(dims) + "/" + DimsName(other_dims)),
+          [=](OpBenchmarkModel* model) {
+            const int input = AddActivationInput(model, scheme, dims);
+            const int other = AddActivationInput(model, scheme, other_dims);
+            const int output = AddActivationOutput(model, scheme, dims);
+            void* params;
+            if (op == BuiltinOperator_ADD) {
+              auto* add_params = NewBuiltinData<TfLiteAddParams>();
+              add_params->activation = kTfLiteActNone;
+              params = add_params;
+            } else {
+              auto* mul_params = NewBuiltinData<TfLiteMulParams>();
+              mul_params->activation = kTfLiteActNone;
+              params = mul_params;
+            }
+            return model->AddOp(op, {input, other}, {output}, params);
+          }};
+}
+
+OpBenchmarkCase SoftmaxCase(QuantizationScheme scheme,
+                            const std::vector<int>& dims) {
+  return {CaseName(BuiltinOperator_SOFTMAX, scheme, DimsName(dims)),
+          [=](OpBenchmarkModel* model) {
+            const int input = AddActivationInput(model, scheme, dims);
+            const int output = AddActivationOutput(model, scheme, dims,
+                                                   1.0f / 256, -128);
+            auto* params = NewBuiltinData<TfLiteSoftmaxParams>();
+            params->beta = 1.0f;
+            return model->AddOp(BuiltinOperator_SOFTMAX, {input}, {output},
+                                params);
+          }};
+}
+
+// Logistic and tanh, whose int8 outputs cover their ranges.
+OpBenchmarkCase ActivationCase(BuiltinOperator op, QuantizationScheme scheme,
+                               const std::vector<int>& dims) {
+  return {CaseName(op, scheme, DimsName(dims)),
+          [=](OpBenchmarkModel* model) {
+            const int input = AddActivationInput(model, scheme, dims);
+            const int output =
+                op == BuiltinOperator_LOGISTIC
+                    ? AddActivationOutput(model, scheme, dims, 1.0f / 256,
+                                          -128)
+                    : AddActivationOutput(model, scheme, dims, 1.0f / 128, 0);
+            return model->AddOp(op, {input}, {output}, nullptr);
+          }};
+}
+
+OpBenchmarkCase Pool2DCase(BuiltinOperator op, QuantizationScheme scheme,
+                           const std::vector<int>& input_dims,
+                           int filter_size, int stride) {
+  const std::string shapes = DimsName(input_dims) + "/" +
+                             DimsName({filter_size, filter_size}) + "s" +
+                             std::to_string(stride);
+  return {CaseName(op, scheme, shapes), [=](OpBenchmarkModel* model) {
+            const int input = AddActivationInput(model, scheme, input_dims);
+            // The quantized kernels don't rescale.
+            const int output = AddActivationOutput(
+                model, scheme,
+                {input_dims[0], (input_dims[1] - filter_size) / stride + 1,
+                 (input_dims[2] - filter_size) / stride + 1, input_dims[3]},
+                kInputScale, kInputZeroPoint);
+            auto* params = NewBuiltinData<TfLitePoolParams>();
+            params->padding = kTfLitePaddingValid;
+            params->stride_width = stride;
+            params->stride_height = stride;
+            params->filter_width = filter_size;
+            params->filter_height = filter_size;
+            params->activation = kTfLiteActNone;
+            return model->AddOp(op, {input}, {output}, params);
+          }};
+}
+
+// Averages over the spatial dimensions of an NHWC tensor.
+OpBenchmarkCase MeanCase(QuantizationScheme scheme,
+                         const std::vector<int>& input_dims) {
+  return {CaseName(BuiltinOperator_MEAN, scheme, DimsName(input_dims)),
+          [=](OpBenchmarkModel* model) {
+            const int input = AddActivationInput(model, scheme, input_dims);
+            const int axis = model->AddInt32Constant({1, 2});
+            const int output = AddActivationOutput(
+                model, scheme, {input_dims[0], 1, 1, input_dims[3]});
+            auto* params = NewBuiltinData<TfLiteReducerParams>();
+            params->keep_dims = true;
+            return model->AddOp(BuiltinOperator_MEAN, {input, axis},
+                                {output}, params);
+          }};
+}
+
+}  // namespace
+
+const char* QuantizationSchemeName(QuantizationScheme scheme) {
+  switch (scheme) {
+    case QuantizationScheme::kFloat32:
+      return "float32";
+    case QuantizationScheme::kInt8:
+      return "int8";
+    case QuantizationScheme::kInt8PerChannel:
+      return "int8_per_channel";
+    case QuantizationScheme::kHybrid:
+      return "hybrid";
+  }
+  return "unknown";
+}
+
+OpBenchmarkModel::OpBenchmarkModel(const OpResolver& resolver)
+    : resolver_(resolver), interpreter_(std::make_unique<Interpreter>()) {}
+
+int OpBenchmarkModel::AddTensor(TfLiteType type, const std::vector<int>& dims,
+                                const std::vector<float>& scales,
+                                const std::vector<int>& zero_points,
+                                int quantized_dimension, const char* buffer,
+                                size_t bytes) {
+  int index;
+  interpreter_->AddTensors(1, &index);
+  TfLiteQuantization quantization = {kTfLiteNoQuantization, nullptr};
+  if (!scales.empty()) {
+    auto* affine = static_cast<TfLiteAffineQuantization*>(
+        std::malloc(sizeof(TfLiteAffineQuantization)));
+    affine->scale = TfLiteFloatArrayCreate(static_cast<int>(scales.size()));
+    affine->zero_point =
+        TfLiteIntArrayCreate(static_cast<int>(zero_points.size()));
+    std::copy(scales.begin(), scales.end(), affine->scale->data);
+    std::copy(zero_points.begin(), zero_points.end(),
+              affine->zero_point->data);
+    affine->quantized_dimension = quantized_dimension;
+    quantization = {kTfLiteAffineQuantization, affine};
+  }
+  const std::string name = "tensor" + std::to_string(index);
+  if (buffer != nullptr) {
+    interpreter_->SetTensorParametersReadOnly(index, type, name.c_str(), dims,
+                                              quantization, buffer, bytes);
+  } else {
+    interpreter_->SetTensorParametersReadWrite(index, type, name.c_str(), dims,
+                                               quantization);
+  }
+  return index;
+}
+
+int OpBenchmarkModel::AddInput(TfLiteType type, const std::vector<int>& dims,
+                               const std::vector<float>& scales,
+                               const std::vector<int>& zero_points,
+                               int quantized_dimension) {
+  const int index = AddTensor(type, dims, scales, zero_points,
+                              quantized_dimension, nullptr, 0);
+  inputs_.push_back(index);
+  return index;
+}
+
+int OpBenchmarkModel::AddConstant(TfLiteType type,
+                                  const std::vector<int>& dims,
+                                  const std::vector<float>& scales,
+                                  const std::vector<int>& zero_points,
+                                  int quantized_dimension) {
+  size_t num_elements = 1;
+  for (int dim : dims) num_elements *= dim;
+  size_t bytes = 0;
+  TfLiteStatus status = GetSizeOfType(nullptr, type, &bytes);
+  if (status != kTfLiteOk) return -1;
+  bytes *= num_elements;
+  buffers_.push_back(std::make_unique<char[]>(bytes));
+  char* buffer = buffers_.back().get();
+  FillRandom(type, num_elements, buffer);
+  return AddTensor(type, dims, scales, zero_points, quantized_dimension,
+                   buffer, bytes);
+}
+
+int OpBenchmarkModel::AddInt32Constant(const std::vector<int32_t>& values) {
+  const size_t bytes = values.size() * sizeof(int32_t);
+  buffers_.push_back(std::make_unique<char[]>(bytes));
+  char* buffer = buffers_.back().get();
+  std::memcpy(buffer, values.data(), bytes);
+  return AddTensor(kTfLiteInt32, {static_cast<int>(values.size())},
+                   /*scales=*/{}, /*zero_points=*/{},
+                   /*quantized_dimension=*/0, buffer, bytes);
+}
+
+int OpBenchmarkModel::AddOutput(TfLiteType type, const std::vector<int>& dims,
+                                const std::vector<float>& scales,
+                                const std::vector<int>& zero_points) {
+  const int index = AddTensor(type, dims, scales, zero_points,
+                              /*quantized_dimension=*/0, nullptr, 0);
+  outputs_.push_back(index);
+  return index;
+}
+
+TfLiteStatus OpBenchmarkModel::AddOp(BuiltinOperator op,
+                                     const std::vector<int>& inputs,
+                                     const std::vector<int>& outputs,
+                                     void* builtin_data) {
+  const TfLiteRegistration* registration = resolver_.FindOp(op, 1);
+  if (registration == nullptr) {
+    std::free(builtin_data);
+    return kTfLiteError;
+  }
+  return interpreter_->AddNodeWithParameters(inputs, outputs, nullptr, 0,
+                                             builtin_data, registration);
+}
+
+TfLiteStatus OpBenchmarkModel::Prepare(int num_threads) {
+  TF_LITE_ENSURE_STATUS(interpreter_->SetInputs(inputs_));
+  TF_LITE_ENSURE_STATUS(interpreter_->SetOutputs(outputs_));
+  TF_LITE_ENSURE_STATUS(interpreter_->SetNumThreads(num_threads));
+  TF_LITE_ENSURE_STATUS(interpreter_->AllocateTensors());
+  for (int input : inputs_) {
+    TfLiteTensor* tensor = interpreter_->tensor(input);
+    size_t element_size = 0;
+    TF_LITE_ENSURE_STATUS(GetSizeOfType(nullptr, tensor->type, &element_size));
+    FillRandom(tensor->type, tensor->bytes / element_size, tensor->data.raw);
+  }
+  return kTfLiteOk;
+}
+
+void OpBenchmarkModel::FillRandom(TfLiteType type, size_t num_elements,
+                                  char* data) {
+  for (size_t i = 0; i < num_elements; ++i) {
+    random_state_ = random_state_ * 1664525u + 1013904223u;
+    // Uniform in [0, 1).
+    const float value = (random_state_ >> 8) / static_cast<float>(1 << 24);
+    switch (type) {
+      case kTfLiteFloat32:
+        reinterpret_cast<float*>(data)[i] = 2 * value - 1;
+        break;
+      case kTfLiteInt8:
+        reinterpret_cast<int8_t*>(data)[i] =
+            static_cast<int8_t>(static_cast<int>(value * 255) - 127);
+        break;
+      case kTfLiteInt32:
+        reinterpret_cast<int32_t*>(data)[i] =
+            static_cast<int32_t>(value * 2000) - 1000;
+        break;
+      default:
+        reinterpret_cast<uint8_t*>(data)[i] = static_cast<uint8_t>(value * 256);
+        break;
+    }
+  }
+}
+
+std::vector<OpBenchmarkCase> GetOpBenchmarkCases() {
+  using Scheme = QuantizationScheme;
+  const Scheme all_schemes[] = {Scheme::kFloat32, Scheme::kInt8,
+                                Scheme::kInt8PerChannel, Scheme::kHybrid};
+  const Scheme activation_schemes[] = {Scheme::kFloat32, Scheme::kInt8};
+
+  std::vector<OpBenchmarkCase> cases;
+  for (Scheme scheme : all_schemes) {
+    cases.push_back(Conv2DCase(scheme, {1, 112, 112, 3}, 3, 32, 2));
+    cases.push_back(Conv2DCase(scheme, {1, 56, 56, 64}, 3, 64, 1));
+    cases.push_back(Conv2DCase(scheme, {1, 28, 28, 128}, 1, 256, 1));
+    cases.push_back(Conv2DCase(scheme, {1, 7, 7, 512}, 3, 512, 1));
+    cases.push_back(DepthwiseConv2DCase(scheme, {1, 112, 112, 32}, 3, 1));
+    cases.push_back(DepthwiseConv2DCase(scheme, {1, 14, 14, 512}, 3, 2));
+    cases.push_back(FullyConnectedCase(scheme, 1, 1024, 1000));
+    cases.push_back(FullyConnectedCase(scheme, 8, 512, 512));
+    cases.push_back(FullyConnectedCase(scheme, 1, 2048, 2048));
+  }
+  for (Scheme scheme : activation_schemes) {
+    for (BuiltinOperator op : {BuiltinOperator_ADD, BuiltinOperator_MUL}) {
+      cases.push_back(BinaryCase(op, scheme, {1, 56, 56, 64}, {1, 56, 56, 64}));
+      cases.push_back(BinaryCase(op, scheme, {1, 56, 56, 64}, {1, 1, 1, 64}));
+    }
+    cases.push_back(SoftmaxCase(scheme, {1, 1000}));
+    cases.push_back(SoftmaxCase(scheme, {1, 8, 128, 128}));
+    for (BuiltinOperator op :
+         {BuiltinOperator_LOGISTIC, BuiltinOperator_TANH}) {
+      cases.push_back(ActivationCase(op, scheme, {1, 56, 56, 64}));
+    }
+    for (BuiltinOperator op :
+         {BuiltinOperator_AVERAGE_POOL_2D, BuiltinOperator_MAX_POOL_2D}) {
+      cases.push_back(Pool2DCase(op, scheme, {1, 112, 112, 64}, 2, 2));
+      cases.push_back(Pool2DCase(op, scheme, {1, 7, 7, 1024}, 7, 1));
+    }
+    cases.push_back(MeanCase(scheme, {1, 7, 7, 1024}));
+  }
+  return cases;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,109 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_BENCHMARK_CASES_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_BENCHMARK_CASES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace benchmark {
+
+// How the tensors of a benchmark case are quantized.
+enum class QuantizationScheme {
+  kFloat32,
+  // int8 activations and weights, with a scale per tensor.
+  kInt8,
+  // int8 activations, and weights with a scale per output channel.
+  kInt8PerChannel,
+  // float activations, and int8 weights with a scale per output channel.
+  kHybrid,
+};
+
+const char* QuantizationSchemeName(QuantizationScheme scheme);
+
+// A graph of a single builtin op, with constant weights and pseudo-random
+// inputs.
+class OpBenchmarkModel {
+ public:
+  explicit OpBenchmarkModel(const OpResolver& resolver);
+
+  // Adds an input of the graph, or a constant filled with pseudo-random
+  // values. Quantized tensors are given `scales` and `zero_points`, more than
+  // one scale being along `quantized_dimension`.
+  int AddInput(TfLiteType type, const std::vector<int>& dims,
+               const std::vector<float>& scales = {},
+               const std::vector<int>& zero_points = {},
+               int quantized_dimension = 0);
+  int AddConstant(TfLiteType type, const std::vector<int>& dims,
+                  const std::vector<float>& scales = {},
+                  const std::vector<int>& zero_points = {},
+                  int quantized_dimension = 0);
+  int AddInt32Constant(const std::vector<int32_t>& values);
+  int AddOutput(TfLiteType type, const std::vector<int>& dims,
+                const std::vector<float>& scales = {},
+                const std::vector<int>& zero_points = {});
+
+  // Adds the op, taking ownership of `builtin_data`, which must be allocated
+  // with malloc.
+  TfLiteStatus AddOp(BuiltinOperator op, const std::vector<int>& inputs,
+                     const std::vector<int>& outputs, void* builtin_data);
+
+  // Allocates the tensors and fills the inputs.
+  TfLiteStatus Prepare(int num_threads);
+
+  Interpreter* interpreter() { return interpreter_.get(); }
+
+ private:
+  int AddTensor(TfLiteType type, const std::vector<int>& dims,
+                const std::vector<float>& scales,
+                const std::vector<int>& zero_points, int quantized_dimension,
+                const char* buffer, size_t bytes);
+  void FillRandom(TfLiteType type, size_t num_elements, char* data);
+
+  const OpResolver& resolver_;
+  // Constant tensor data, which must outlive the interpreter.
+  std::vector<std::unique_ptr<char[]>> buffers_;
+  std::unique_ptr<Interpreter> interpreter_;
+  std::vector<int> inputs_;
+  std::vector<int> outputs_;
+  uint32_t random_state_ = 1;
+};
+
+struct OpBenchmarkCase {
+  // Unique name of the case, made of the op, the quantization scheme and the
+  // shapes, e.g. "CONV_2D/int8_per_channel/1x56x56x64/3x3x64".
+  std::string name;
+  std::function<TfLiteStatus(OpBenchmarkModel*)> build;
+};
+
+// Returns the cases of the representative shapes of common builtin ops, for
+// all the quantization schemes they support.
+std::vector<OpBenchmarkCase> GetOpBenchmarkCases();
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_BENCHMARK_CASES_H_
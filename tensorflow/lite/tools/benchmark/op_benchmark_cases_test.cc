@@ -0,0 +1,45 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/benchmark/op_benchmark_cases.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/kernels/register.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+TEST(OpBenchmarkCasesTest, AllCasesRun) {
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  std::set<std::string> names;
+  for (const OpBenchmarkCase& op_case : GetOpBenchmarkCases()) {
+    SCOPED_TRACE(op_case.name);
+    EXPECT_TRUE(names.insert(op_case.name).second);
+    OpBenchmarkModel model(resolver);
+    ASSERT_EQ(op_case.build(&model), kTfLiteOk);
+    ASSERT_EQ(model.Prepare(/*num_threads=*/1), kTfLiteOk);
+    ASSERT_EQ(model.interpreter()->Invoke(), kTfLiteOk);
+  }
+  EXPECT_FALSE(names.empty());
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,221 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/op_benchmark_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+constexpr char kResultsHeader[] =
+    "name,count,mean_us,median_us,stddev_us,min_us,max_us,num_outliers";
+constexpr int kNumResultsFields = 8;
+
+// Scales the median absolute deviation to estimate the standard deviation of
+// normally distributed samples.
+constexpr double kMadToStddev = 1.4826;
+
+double Median(std::vector<double> values) {
+  if (values.empty()) return 0;
+  const size_t middle = values.size() / 2;
+  std::nth_element(values.begin(), values.begin() + middle, values.end());
+  const double upper = values[middle];
+  if (values.size() % 2 == 1) return upper;
+  const double lower =
+      *std::max_element(values.begin(), values.begin() + middle);
+  return (lower + upper) / 2;
+}
+
+// Evaluates the continued fraction of the incomplete beta function by the
+// modified Lentz's method.
+double BetaContinuedFraction(double a, double b, double x) {
+  constexpr int kMaxIterations = 300;
+  constexpr double kEpsilon = 1e-15;
+  constexpr double kTiny = 1e-300;
+  auto guard = [](double value) {
+    return std::fabs(value) < kTiny ? kTiny : value;
+  };
+  double c = 1;
+  double d = 1 / guard(1 - (a + b) * x / (a + 1));
+  double result = d;
+  for (int m = 1; m <= kMaxIterations; ++m) {
+    const double even = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+    d = 1 / guard(1 + even * d);
+    c = guard(1 + even / c);
+    result *= d * c;
+    const double odd =
+        -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+    d = 1 / guard(1 + odd * d);
+    c = guard(1 + odd / c);
+    const double delta = d * c;
+    result *= delta;
+    if (std::fabs(delta - 1) < kEpsilon) break;
+  }
+  return result;
+}
+
+bool ParseDouble(const std::string& text, double* value) {
+  char* end = nullptr;
+  *value = std::strtod(text.c_str(), &end);
+  return !text.empty() && *end == '\0';
+}
+
+bool ParseInt(const std::string& text, int* value) {
+  char* end = nullptr;
+  *value = static_cast<int>(std::strtol(text.c_str(), &end, 10));
+  return !text.empty() && *end == '\0';
+}
+
+}  // namespace
+
+SampleStats ComputeSampleStats(std::vector<double> samples,
+                               double max_deviations) {
+  SampleStats stats;
+  if (samples.empty()) return stats;
+  const double median = Median(samples);
+  std::vector<double> deviations;
+  deviations.reserve(samples.size());
+  for (double sample : samples) {
+    deviations.push_back(std::fabs(sample - median));
+  }
+  const double max_deviation =
+      max_deviations * kMadToStddev * Median(std::move(deviations));
+  // When most samples are equal, the deviation is 0 and nothing is rejected.
+  if (max_deviation > 0) {
+    const size_t num_samples = samples.size();
+    samples.erase(std::remove_if(samples.begin(), samples.end(),
+                                 [&](double sample) {
+                                   return std::fabs(sample - median) >
+                                          max_deviation;
+                                 }),
+                  samples.end());
+    stats.num_outliers = num_samples - samples.size();
+  }
+
+  stats.count = samples.size();
+  double sum = 0;
+  for (double sample : samples) sum += sample;
+  stats.mean = sum / stats.count;
+  double squared_error = 0;
+  for (double sample : samples) {
+    squared_error += (sample - stats.mean) * (sample - stats.mean);
+  }
+  stats.stddev =
+      stats.count > 1 ? std::sqrt(squared_error / (stats.count - 1)) : 0;
+  stats.median = Median(samples);
+  const auto min_max = std::minmax_element(samples.begin(), samples.end());
+  stats.min = *min_max.first;
+  stats.max = *min_max.second;
+  return stats;
+}
+
+double RegularizedIncompleteBeta(double a, double b, double x) {
+  if (x <= 0) return 0;
+  if (x >= 1) return 1;
+  const double front =
+      std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) +
+               a * std::log(x) + b * std::log(1 - x));
+  // The continued fraction converges quickly on this side of the mean of the
+  // beta distribution, and the other side follows by symmetry.
+  if (x < (a + 1) / (a + b + 2)) {
+    return front * BetaContinuedFraction(a, b, x) / a;
+  }
+  return 1 - front * BetaContinuedFraction(b, a, 1 - x) / b;
+}
+
+SampleComparison CompareSampleStats(const SampleStats& baseline,
+                                    const SampleStats& candidate) {
+  SampleComparison comparison;
+  if (baseline.mean > 0) {
+    comparison.relative_change =
+        (candidate.mean - baseline.mean) / baseline.mean;
+  }
+  if (baseline.count < 2 || candidate.count < 2) return comparison;
+
+  const double baseline_variance =
+      baseline.stddev * baseline.stddev / baseline.count;
+  const double candidate_variance =
+      candidate.stddev * candidate.stddev / candidate.count;
+  const double variance = baseline_variance + candidate_variance;
+  if (variance == 0) {
+    comparison.p_value = baseline.mean == candidate.mean ? 1 : 0;
+    return comparison;
+  }
+  const double t = (candidate.mean - baseline.mean) / std::sqrt(variance);
+  // Welch-Satterthwaite degrees of freedom.
+  const double degrees_of_freedom =
+      variance * variance /
+      (baseline_variance * baseline_variance / (baseline.count - 1) +
+       candidate_variance * candidate_variance / (candidate.count - 1));
+  comparison.p_value = RegularizedIncompleteBeta(
+      degrees_of_freedom / 2, 0.5,
+      degrees_of_freedom / (degrees_of_freedom + t * t));
+  return comparison;
+}
+
+std::string SerializeOpBenchmarkResults(
+    const std::vector<OpBenchmarkResult>& results) {
+  std::ostringstream stream;
+  stream << kResultsHeader << "\n" << std::fixed << std::setprecision(3);
+  for (const OpBenchmarkResult& result : results) {
+    const SampleStats& stats = result.stats;
+    stream << result.name << "," << stats.count << "," << stats.mean << ","
+           << stats.median << "," << stats.stddev << "," << stats.min << ","
+           << stats.max << "," << stats.num_outliers << "\n";
+  }
+  return stream.str();
+}
+
+bool ParseOpBenchmarkResults(const std::string& data,
+                             std::vector<OpBenchmarkResult>* results) {
+  std::istringstream stream(data);
+  std::string line;
+  if (!std::getline(stream, line) || line != kResultsHeader) return false;
+  while (std::getline(stream, line)) {
+    if (line.empty()) continue;
+    std::vector<std::string> fields;
+    std::istringstream line_stream(line);
+    for (std::string field; std::getline(line_stream, field, ',');) {
+      fields.push_back(field);
+    }
+    if (fields.size() != kNumResultsFields) return false;
+    OpBenchmarkResult result;
+    result.name = fields[0];
+    SampleStats& stats = result.stats;
+    if (!ParseInt(fields[1], &stats.count) ||
+        !ParseDouble(fields[2], &stats.mean) ||
+        !ParseDouble(fields[3], &stats.median) ||
+        !ParseDouble(fields[4], &stats.stddev) ||
+        !ParseDouble(fields[5], &stats.min) ||
+        !ParseDouble(fields[6], &stats.max) ||
+        !ParseInt(fields[7], &stats.num_outliers)) {
+      return false;
+    }
+    results->push_back(std::move(result));
+  }
+  return true;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
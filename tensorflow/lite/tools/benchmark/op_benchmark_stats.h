@@ -0,0 +1,72 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_BENCHMARK_STATS_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_BENCHMARK_STATS_H_
+
+#include <string>
+#include <vector>
+
+namespace tflite {
+namespace benchmark {
+
+// Summary of the latencies of one benchmark case, in microseconds.
+struct SampleStats {
+  int count = 0;
+  double mean = 0;
+  double median = 0;
+  double stddev = 0;
+  double min = 0;
+  double max = 0;
+  // Number of samples left out of the above as outliers.
+  int num_outliers = 0;
+};
+
+// Summarizes `samples`, leaving out those further than `max_deviations` times
+// the median absolute deviation, scaled to estimate the standard deviation,
+// from the median. Unlike the mean and standard deviation, these aren't
+// skewed by the occasional runs that get preempted or miss the caches.
+SampleStats ComputeSampleStats(std::vector<double> samples,
+                               double max_deviations);
+
+struct SampleComparison {
+  // Change of the mean from the baseline to the candidate, relative to the
+  // baseline: positive when the candidate is slower.
+  double relative_change = 0;
+  // Two-sided p-value of Welch's t-test that the means are equal.
+  double p_value = 1;
+};
+
+SampleComparison CompareSampleStats(const SampleStats& baseline,
+                                    const SampleStats& candidate);
+
+// Returns the regularized incomplete beta function I_x(a, b).
+double RegularizedIncompleteBeta(double a, double b, double x);
+
+struct OpBenchmarkResult {
+  std::string name;
+  SampleStats stats;
+};
+
+// Results are stored as CSV, with a header line and one line per case.
+std::string SerializeOpBenchmarkResults(
+    const std::vector<OpBenchmarkResult>& results);
+bool ParseOpBenchmarkResults(const std::string& data,
+                             std::vector<OpBenchmarkResult>* results);
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_OP_BENCHMARK_STATS_H_
@@ -0,0 +1,97 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/benchmark/op_benchmark_stats.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+TEST(OpBenchmarkStatsTest, RejectsOutliers) {
+  const SampleStats stats = ComputeSampleStats(
+      {10, 11, 9, 10, 12, 10, 9, 11, 100}, /*max_deviations=*/5);
+  EXPECT_EQ(stats.count, 8);
+  EXPECT_EQ(stats.num_outliers, 1);
+  EXPECT_DOUBLE_EQ(stats.mean, 10.25);
+  EXPECT_DOUBLE_EQ(stats.median, 10);
+  EXPECT_DOUBLE_EQ(stats.min, 9);
+  EXPECT_DOUBLE_EQ(stats.max, 12);
+}
+
+TEST(OpBenchmarkStatsTest, KeepsEqualSamples) {
+  const SampleStats stats =
+      ComputeSampleStats({5, 5, 5, 5, 6}, /*max_deviations=*/5);
+  EXPECT_EQ(stats.count, 5);
+  EXPECT_EQ(stats.num_outliers, 0);
+  EXPECT_DOUBLE_EQ(stats.median, 5);
+}
+
+TEST(OpBenchmarkStatsTest, RegularizedIncompleteBeta) {
+  EXPECT_DOUBLE_EQ(RegularizedIncompleteBeta(2, 3, 0), 0);
+  EXPECT_DOUBLE_EQ(RegularizedIncompleteBeta(2, 3, 1), 1);
+  // I_x(1, 1) = x and I_x(2, 1) = x^2.
+  EXPECT_NEAR(RegularizedIncompleteBeta(1, 1, 0.3), 0.3, 1e-12);
+  EXPECT_NEAR(RegularizedIncompleteBeta(2, 1, 0.7), 0.49, 1e-12);
+  EXPECT_NEAR(RegularizedIncompleteBeta(5, 0.5, 0.8),
+              1 - RegularizedIncompleteBeta(0.5, 5, 0.2), 1e-12);
+}
+
+TEST(OpBenchmarkStatsTest, ComparesMeans) {
+  SampleStats baseline;
+  baseline.count = 11;
+  baseline.mean = 100;
+  baseline.stddev = 10;
+  SampleStats candidate = baseline;
+  EXPECT_DOUBLE_EQ(CompareSampleStats(baseline, candidate).p_value, 1);
+
+  // t = 2 with 20 degrees of freedom.
+  candidate.mean = 100 + 20 * std::sqrt(2.0 / 11);
+  const SampleComparison comparison = CompareSampleStats(baseline, candidate);
+  EXPECT_NEAR(comparison.p_value, 0.0593, 1e-4);
+  EXPECT_NEAR(comparison.relative_change, 0.0853, 1e-4);
+
+  candidate.mean = 150;
+  EXPECT_LT(CompareSampleStats(baseline, candidate).p_value, 1e-6);
+}
+
+TEST(OpBenchmarkStatsTest, SerializesResults) {
+  std::vector<OpBenchmarkResult> results(2);
+  results[0].name = "CONV_2D/float32/1x8x8x4";
+  results[0].stats = ComputeSampleStats({1, 2, 3}, /*max_deviations=*/5);
+  results[1].name = "ADD/int8/1x8";
+  results[1].stats = ComputeSampleStats({4.5, 5.5}, /*max_deviations=*/5);
+
+  std::vector<OpBenchmarkResult> parsed;
+  ASSERT_TRUE(
+      ParseOpBenchmarkResults(SerializeOpBenchmarkResults(results), &parsed));
+  ASSERT_EQ(parsed.size(), 2);
+  EXPECT_EQ(parsed[0].name, results[0].name);
+  EXPECT_EQ(parsed[0].stats.count, 3);
+  EXPECT_DOUBLE_EQ(parsed[0].stats.mean, 2);
+  EXPECT_DOUBLE_EQ(parsed[0].stats.stddev, 1);
+  EXPECT_EQ(parsed[1].name, results[1].name);
+  EXPECT_DOUBLE_EQ(parsed[1].stats.median, 5);
+
+  EXPECT_FALSE(ParseOpBenchmarkResults("name,count\nADD,1\n", &parsed));
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
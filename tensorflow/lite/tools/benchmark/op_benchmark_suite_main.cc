@@ -0,0 +1,219 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Measures the latency of single op graphs of the builtin kernels, for
+// representative shapes and quantization schemes, to track their performance
+// across builds.
+//
+// Run the cases whose name contains a filter and save the results:
+//   bazel run -c opt //tensorflow/lite/tools/benchmark:op_benchmark_suite -- \
+//     --filter=CONV_2D/int8 --output=/tmp/baseline.csv
+//
+// Compare the results of two builds, failing on significant regressions:
+//   bazel run -c opt //tensorflow/lite/tools/benchmark:op_benchmark_suite -- \
+//     --baseline=/tmp/baseline.csv --candidate=/tmp/candidate.csv
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/benchmark/op_benchmark_cases.h"
+#include "tensorflow/lite/tools/benchmark/op_benchmark_stats.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+struct SuiteFlags {
+  std::string filter;
+  std::string output;
+  std::string baseline;
+  std::string candidate;
+  bool list = false;
+  int32_t num_threads = 1;
+  int32_t warmup_runs = 5;
+  int32_t num_runs = 50;
+  float max_deviations = 5.0f;
+  float max_p_value = 0.01f;
+  float min_relative_change = 0.03f;
+};
+
+bool ReadResults(const std::string& path,
+                 std::vector<OpBenchmarkResult>* results) {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream data;
+  data << file.rdbuf();
+  if (!file || !ParseOpBenchmarkResults(data.str(), results)) {
+    TFLITE_LOG(ERROR) << "Failed to read benchmark results from " << path;
+    return false;
+  }
+  return true;
+}
+
+// Runs the cases matching the filter, or lists them.
+int RunCases(const SuiteFlags& flags) {
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  std::vector<OpBenchmarkResult> results;
+  for (const OpBenchmarkCase& op_case : GetOpBenchmarkCases()) {
+    if (op_case.name.find(flags.filter) == std::string::npos) continue;
+    if (flags.list) {
+      std::printf("%s\n", op_case.name.c_str());
+      continue;
+    }
+    OpBenchmarkModel model(resolver);
+    if (op_case.build(&model) != kTfLiteOk ||
+        model.Prepare(flags.num_threads) != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to build " << op_case.name;
+      return EXIT_FAILURE;
+    }
+    Interpreter* interpreter = model.interpreter();
+    std::vector<double> samples;
+    samples.reserve(flags.num_runs);
+    for (int run = 0; run < flags.warmup_runs + flags.num_runs; ++run) {
+      const uint64_t start = profiling::time::NowMicros();
+      if (interpreter->Invoke() != kTfLiteOk) {
+        TFLITE_LOG(ERROR) << "Failed to invoke " << op_case.name;
+        return EXIT_FAILURE;
+      }
+      if (run >= flags.warmup_runs) {
+        samples.push_back(profiling::time::NowMicros() - start);
+      }
+    }
+    OpBenchmarkResult result;
+    result.name = op_case.name;
+    result.stats = ComputeSampleStats(samples, flags.max_deviations);
+    TFLITE_LOG(INFO) << result.name << ": median " << result.stats.median
+                     << " us, mean " << result.stats.mean << " us, stddev "
+                     << result.stats.stddev << " us, "
+                     << result.stats.num_outliers << " outliers";
+    results.push_back(result);
+  }
+  if (flags.list) return EXIT_SUCCESS;
+
+  const std::string serialized = SerializeOpBenchmarkResults(results);
+  if (flags.output.empty()) {
+    std::printf("%s", serialized.c_str());
+    return EXIT_SUCCESS;
+  }
+  std::ofstream output_file(flags.output, std::ios::binary | std::ios::trunc);
+  output_file << serialized;
+  if (!output_file.flush()) {
+    TFLITE_LOG(ERROR) << "Failed to write results to " << flags.output;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+// Compares the cases of the candidate results to those of the baseline ones,
+// and fails if any is significantly slower.
+int CompareResults(const SuiteFlags& flags) {
+  std::vector<OpBenchmarkResult> baseline_results;
+  std::vector<OpBenchmarkResult> candidate_results;
+  if (!ReadResults(flags.baseline, &baseline_results) ||
+      !ReadResults(flags.candidate, &candidate_results)) {
+    return EXIT_FAILURE;
+  }
+  std::map<std::string, SampleStats> baseline;
+  for (const OpBenchmarkResult& result : baseline_results) {
+    baseline[result.name] = result.stats;
+  }
+
+  int num_regressions = 0;
+  std::printf("%-60s %12s %12s %9s %9s\n", "case", "baseline_us",
+              "candidate_us", "change", "p_value");
+  for (const OpBenchmarkResult& candidate : candidate_results) {
+    if (candidate.name.find(flags.filter) == std::string::npos) continue;
+    const auto it = baseline.find(candidate.name);
+    if (it == baseline.end()) continue;
+    const SampleComparison comparison =
+        CompareSampleStats(it->second, candidate.stats);
+    const bool significant = comparison.p_value < flags.max_p_value &&
+                             std::abs(comparison.relative_change) >=
+                                 flags.min_relative_change;
+    const char* verdict = "";
+    if (significant) {
+      verdict = comparison.relative_change > 0 ? "REGRESSION" : "improvement";
+      if (comparison.relative_change > 0) ++num_regressions;
+    }
+    std::printf("%-60s %12.1f %12.1f %+8.1f%% %9.2g %s\n",
+                candidate.name.c_str(), it->second.mean, candidate.stats.mean,
+                100 * comparison.relative_change, comparison.p_value, verdict);
+  }
+  if (num_regressions > 0) {
+    TFLITE_LOG(ERROR) << num_regressions << " significant regressions.";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+int Main(int argc, char** argv) {
+  SuiteFlags flags;
+  std::vector<Flag> flag_list = {
+      Flag::CreateFlag("filter", &flags.filter,
+                       "Only the cases whose name contains this."),
+      Flag::CreateFlag("output", &flags.output,
+                       "CSV file to write the results to, instead of the "
+                       "standard output."),
+      Flag::CreateFlag("list", &flags.list,
+                       "Only list the names of the cases."),
+      Flag::CreateFlag("num_threads", &flags.num_threads,
+                       "Number of threads of the kernels."),
+      Flag::CreateFlag("warmup_runs", &flags.warmup_runs,
+                       "Runs of each case before the measured ones."),
+      Flag::CreateFlag("num_runs", &flags.num_runs,
+                       "Measured runs of each case."),
+      Flag::CreateFlag("max_deviations", &flags.max_deviations,
+                       "Runs further from the median than this many times "
+                       "the median absolute deviation are outliers."),
+      Flag::CreateFlag("baseline", &flags.baseline,
+                       "Results to compare the candidate ones to, instead of "
+                       "running the cases."),
+      Flag::CreateFlag("candidate", &flags.candidate,
+                       "Results to compare to the baseline ones."),
+      Flag::CreateFlag("max_p_value", &flags.max_p_value,
+                       "Largest p-value of a significant change."),
+      Flag::CreateFlag("min_relative_change", &flags.min_relative_change,
+                       "Smallest relative change of the mean latency that "
+                       "is reported as a regression or improvement."),
+  };
+  if (!Flags::Parse(&argc, const_cast<const char**>(argv), flag_list) ||
+      flags.baseline.empty() != flags.candidate.empty() ||
+      flags.num_runs <= 0 || flags.warmup_runs < 0) {
+    TFLITE_LOG(ERROR) << Flags::Usage(argv[0], flag_list);
+    return EXIT_FAILURE;
+  }
+  if (!flags.baseline.empty()) return CompareResults(flags);
+  return RunCases(flags);
+}
+
+}  // namespace
+}  // namespace benchmark
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  return tflite::benchmark::Main(argc, argv);
+}
@@ -0,0 +1,97 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Replaces the tensor arena plans saved by an interpreter, e.g. with the
+// `arena_plan_file` flag of benchmark_model, by tighter ones.
+//
+// bazel run -c opt //tensorflow/lite/tools:optimize_arena_plans -- \
+//   --input=/path/to/model.tflite.arena_plans \
+//   --output=/path/to/model.tflite.arena_plans
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/arena_plan_cache.h"
+#include "tensorflow/lite/tools/arena_plan_optimizer.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace tools {
+namespace {
+
+int Main(int argc, char** argv) {
+  std::string input;
+  std::string output;
+  int32_t lookahead = ArenaPlanOptimizerOptions().lookahead;
+  std::vector<Flag> flag_list = {
+      Flag::CreateFlag("input", &input, "File with the plans to optimize.",
+                       Flag::kRequired),
+      Flag::CreateFlag("output", &output,
+                       "File to write the optimized plans to.",
+                       Flag::kRequired),
+      Flag::CreateFlag("lookahead", &lookahead,
+                       "Number of tensors among which the one growing the "
+                       "arena the least is placed next."),
+  };
+  if (!Flags::Parse(&argc, const_cast<const char**>(argv), flag_list)) {
+    TFLITE_LOG(ERROR) << Flags::Usage(argv[0], flag_list);
+    return EXIT_FAILURE;
+  }
+
+  std::ifstream input_file(input, std::ios::binary);
+  std::stringstream data;
+  data << input_file.rdbuf();
+  ArenaPlanCache plans(std::numeric_limits<int>::max());
+  if (!input_file || !plans.Deserialize(data.str())) {
+    TFLITE_LOG(ERROR) << "Failed to read arena plans from " << input;
+    return EXIT_FAILURE;
+  }
+
+  ArenaPlanOptimizerOptions options;
+  options.alignment = kDefaultTensorAlignment;
+  options.lookahead = lookahead;
+  ArenaPlanCache optimized_plans(std::numeric_limits<int>::max());
+  // Least recently used first, to keep the order of the plans.
+  std::vector<ArenaPlan> all_plans = plans.GetPlans();
+  for (auto it = all_plans.rbegin(); it != all_plans.rend(); ++it) {
+    ArenaPlan optimized = OptimizeArenaPlan(*it, options);
+    TFLITE_LOG(INFO) << "Subgraph " << it->subgraph_index << ", "
+                     << it->allocs.size() << " tensors: " << it->arena_size
+                     << " -> " << optimized.arena_size << " bytes";
+    optimized_plans.Insert(std::move(optimized));
+  }
+
+  std::ofstream output_file(output, std::ios::binary | std::ios::trunc);
+  output_file << optimized_plans.Serialize();
+  if (!output_file.flush()) {
+    TFLITE_LOG(ERROR) << "Failed to write arena plans to " << output;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+}  // namespace tools
+}  // namespace tflite
+
+int main(int argc, char** argv) { return tflite::tools::Main(argc, argv); }
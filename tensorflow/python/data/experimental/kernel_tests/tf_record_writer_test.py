@@ -17,6 +17,7 @@ import os
 
 from absl.testing import parameterized
 
+from tensorflow.python.data.experimental.ops import global_shuffle_op
 from tensorflow.python.data.experimental.ops import grouping
 from tensorflow.python.data.experimental.ops import writers
 from tensorflow.python.data.kernel_tests import test_base
@@ -25,6 +26,7 @@ from tensorflow.python.data.ops import readers
 from tensorflow.python.eager import def_function
 from tensorflow.python.framework import combinations
 from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
 from tensorflow.python.lib.io import python_io
 from tensorflow.python.lib.io import tf_record
 from tensorflow.python.ops import string_ops
@@ -84,6 +86,30 @@ class TFRecordWriterTest(test_base.DatasetTestBase, parameterized.TestCase):
         tf_record.tf_record_iterator(self._outputFilename(), options=options)):
       self.assertAllEqual(self._record(i), r)
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testWriteIndex(self):
+    input_dataset = readers.TFRecordDataset([self._createFile()])
+    self.evaluate(
+        writers.TFRecordWriter(self._outputFilename(),
+                               write_index=True).write(input_dataset))
+    self.assertTrue(os.path.exists(self._outputFilename() + ".index"))
+
+    dataset = readers.TFRecordDataset([self._outputFilename()])
+    dataset = global_shuffle_op._global_shuffle(dataset, seed=42)
+    output = self.getDatasetOutput(dataset, requires_initialization=True)
+    self.assertCountEqual(output,
+                          [self._record(i) for i in range(self._num_records)])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testWriteIndexOfCompressedFile(self):
+    input_dataset = readers.TFRecordDataset([self._createFile()])
+    with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                "only write an index for uncompressed files"):
+      self.evaluate(
+          writers.TFRecordWriter(
+              self._outputFilename(), compression_type="GZIP",
+              write_index=True).write(input_dataset))
+
   @combinations.generate(test_base.default_test_combinations())
   def testFailDataset(self):
     with self.assertRaises(TypeError):
@@ -71,7 +71,7 @@ class TFRecordWriter:
   ```
   """
 
-  def __init__(self, filename, compression_type=None):
+  def __init__(self, filename, compression_type=None, write_index=False):
     """Initializes a `TFRecordWriter`.
 
     Args:
@@ -79,6 +79,10 @@ class TFRecordWriter:
       compression_type: (Optional.) a string indicating what type of compression
         to use when writing the file. See `tf.io.TFRecordCompressionType` for
         what types of compression are available. Defaults to `None`.
+      write_index: (Optional.) If `True`, also writes the record offsets to
+        `<filename>.index`, which lets `tf.data.TFRecordDataset` read the file
+        with random access, e.g. for `global_shuffle`. Only supported for
+        uncompressed files. Defaults to `False`.
     """
     self._filename = ops.convert_to_tensor(
         filename, dtypes.string, name="filename")
@@ -87,6 +91,7 @@ class TFRecordWriter:
         compression_type,
         argument_default="",
         argument_dtype=dtypes.string)
+    self._write_index = write_index
 
   def write(self, dataset):
     """Writes a dataset to a TFRecord file.
@@ -122,5 +127,11 @@ class TFRecordWriter:
           f"types {dataset_ops.get_legacy_output_types(dataset)}.")
     # pylint: disable=protected-access
     dataset = dataset._apply_debug_options()
+    if self._write_index:
+      return gen_experimental_dataset_ops.dataset_to_tf_record(
+          dataset._variant_tensor,
+          self._filename,
+          self._compression_type,
+          write_index=True)
     return gen_experimental_dataset_ops.dataset_to_tf_record(
         dataset._variant_tensor, self._filename, self._compression_type)
@@ -45,12 +45,17 @@ class AutotuneAlgorithm(enum.Enum):
 
   STAGE_BASED: In each optimization step, this algorithm chooses the worst
   bottleneck parameter and increases its value by 1.
+
+  LEARNED_COST: Similar to STAGE_BASED but corrects the stage times with
+  per-node cost curves fitted from the observed processing times, and jointly
+  tunes parallelism and buffer sizes under both the CPU and RAM budgets.
   """
   DEFAULT = 0
   HILL_CLIMB = 1
   GRADIENT_DESCENT = 2
   MAX_PARALLELISM = 3
   STAGE_BASED = 4
+  LEARNED_COST = 5
 
   @classmethod
   def _to_proto(cls, obj):
@@ -64,9 +69,12 @@ class AutotuneAlgorithm(enum.Enum):
       return model_pb2.AutotuneAlgorithm.MAX_PARALLELISM
     if obj == cls.STAGE_BASED:
       return model_pb2.AutotuneAlgorithm.STAGE_BASED
+    if obj == cls.LEARNED_COST:
+      return model_pb2.AutotuneAlgorithm.LEARNED_COST
     raise ValueError(
         f"Invalid `obj.` Supported values include `DEFAULT`, `HILL_CLIMB` "
-        f"`GRADIENT_DESCENT`, and `STAGE_BASED`. Got {obj.name}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED` and `LEARNED_COST`. "
+        f"Got {obj.name}.")
 
   @classmethod
   def _from_proto(cls, pb):
@@ -80,9 +88,11 @@ class AutotuneAlgorithm(enum.Enum):
       return cls.MAX_PARALLELISM
     if pb == model_pb2.AutotuneAlgorithm.STAGE_BASED:
       return cls.STAGE_BASED
+    if pb == model_pb2.AutotuneAlgorithm.LEARNED_COST:
+      return cls.LEARNED_COST
     raise ValueError(
         f"Invalid `pb.` Supported values include `DEFAULT`, `HILL_CLIMB`, "
-        f"`GRADIENT_DESCENT` and `STAGE_BASED`. Got {pb}.")
+        f"`GRADIENT_DESCENT`, `STAGE_BASED` and `LEARNED_COST`. Got {pb}.")
 
 
 @tf_export("data.experimental.AutoShardPolicy")